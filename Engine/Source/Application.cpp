@@ -14,6 +14,7 @@
 #include "CommandList.h"
 #include "DeviceManager.h"
 #include "InputState.h"
+#include "LoadTelemetry.h"
 #include "Profile.h"
 #include "Renderer.h"
 #include "RenderThread.h"
@@ -266,6 +267,9 @@ void Application::Initialize()
 
 	// User-defined initialization
 	OnInit();
+
+	// Report on the loads OnInit kicked off, once they've all finished
+	LOAD_TELEMETRY_REPORT();
 }
 
 
@@ -0,0 +1,728 @@
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+// Author: David Elder
+//
+
+// Built without the precompiled header, so that tools can share it
+
+#include "BCDecoder.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define KODIAK_TARGET_SSSE3
+#else
+#include <cpuid.h>
+#define KODIAK_TARGET_SSSE3 __attribute__((target("ssse3")))
+#endif
+#include <tmmintrin.h>
+
+
+using namespace Kodiak;
+using namespace std;
+
+
+namespace
+{
+
+// Interpolated BC1-BC5 palette entries use truncating integer division, (2 * a + b) / 3 and friends, like
+// the common reference decoders.  GPUs are allowed to round differently, by up to a few units.
+
+void Expand565(uint16_t color, uint8_t* rgba)
+{
+	const uint32_t r = (color >> 11) & 0x1F;
+	const uint32_t g = (color >> 5) & 0x3F;
+	const uint32_t b = color & 0x1F;
+	rgba[0] = static_cast<uint8_t>((r << 3) | (r >> 2));
+	rgba[1] = static_cast<uint8_t>((g << 2) | (g >> 4));
+	rgba[2] = static_cast<uint8_t>((b << 3) | (b >> 2));
+}
+
+
+// Four RGBA colors.  BC1 blocks with color0 <= color1 have three colors and transparent black; BC2 and
+// BC3 blocks always have four colors, with alpha left at 0 so the alpha block can be OR'd in.
+void BuildColorPalette(const uint8_t* block, bool isBC1, uint8_t palette[16])
+{
+	const uint16_t color0 = static_cast<uint16_t>(block[0] | (block[1] << 8));
+	const uint16_t color1 = static_cast<uint16_t>(block[2] | (block[3] << 8));
+
+	Expand565(color0, palette);
+	Expand565(color1, palette + 4);
+
+	const uint8_t opaque = isBC1 ? 0xFF : 0x00;
+	palette[3] = palette[7] = palette[11] = opaque;
+
+	if (!isBC1 || color0 > color1)
+	{
+		for (uint32_t c = 0; c < 3; ++c)
+		{
+			palette[8 + c] = static_cast<uint8_t>((2 * palette[c] + palette[4 + c]) / 3);
+			palette[12 + c] = static_cast<uint8_t>((palette[c] + 2 * palette[4 + c]) / 3);
+		}
+		palette[15] = opaque;
+	}
+	else
+	{
+		for (uint32_t c = 0; c < 3; ++c)
+		{
+			palette[8 + c] = static_cast<uint8_t>((palette[c] + palette[4 + c]) / 2);
+		}
+		palette[12] = palette[13] = palette[14] = palette[15] = 0;
+	}
+}
+
+
+// Eight values, from a BC3 alpha block or a BC4/BC5 channel block
+void BuildAlphaPalette(const uint8_t* block, uint8_t palette[8])
+{
+	const uint32_t alpha0 = block[0];
+	const uint32_t alpha1 = block[1];
+	palette[0] = static_cast<uint8_t>(alpha0);
+	palette[1] = static_cast<uint8_t>(alpha1);
+
+	if (alpha0 > alpha1)
+	{
+		for (uint32_t i = 1; i < 7; ++i)
+		{
+			palette[i + 1] = static_cast<uint8_t>(((7 - i) * alpha0 + i * alpha1) / 7);
+		}
+	}
+	else
+	{
+		for (uint32_t i = 1; i < 5; ++i)
+		{
+			palette[i + 1] = static_cast<uint8_t>(((5 - i) * alpha0 + i * alpha1) / 5);
+		}
+		palette[6] = 0;
+		palette[7] = 0xFF;
+	}
+}
+
+
+uint64_t LoadAlphaIndices(const uint8_t* block)
+{
+	uint64_t indices = 0;
+	for (uint32_t i = 0; i < 6; ++i)
+	{
+		indices |= static_cast<uint64_t>(block[2 + i]) << (8 * i);
+	}
+	return indices;
+}
+
+
+uint32_t LoadColorIndices(const uint8_t* block)
+{
+	return block[4] | (block[5] << 8) | (block[6] << 16) | (static_cast<uint32_t>(block[7]) << 24);
+}
+
+
+// Scalar decoders, for CPUs without SSSE3
+
+void DecodeColorScalar(const uint8_t* block, bool isBC1, uint8_t* pixels)
+{
+	uint8_t palette[16];
+	BuildColorPalette(block, isBC1, palette);
+
+	const uint32_t indices = LoadColorIndices(block);
+	for (uint32_t i = 0; i < 16; ++i)
+	{
+		memcpy(pixels + 4 * i, palette + 4 * ((indices >> (2 * i)) & 3), 4);
+	}
+}
+
+
+void DecodeAlphaScalar(const uint8_t* block, uint8_t* pixels, uint32_t channel)
+{
+	uint8_t palette[8];
+	BuildAlphaPalette(block, palette);
+
+	const uint64_t indices = LoadAlphaIndices(block);
+	for (uint32_t i = 0; i < 16; ++i)
+	{
+		pixels[4 * i + channel] = palette[(indices >> (3 * i)) & 7];
+	}
+}
+
+
+void DecodeBlockScalar(BCFormat format, const uint8_t* block, uint8_t* pixels)
+{
+	switch (format)
+	{
+	case BCFormat::BC1:
+		DecodeColorScalar(block, true, pixels);
+		break;
+
+	case BCFormat::BC2:
+		DecodeColorScalar(block + 8, false, pixels);
+		for (uint32_t i = 0; i < 16; ++i)
+		{
+			const uint32_t alpha = (block[i / 2] >> (4 * (i & 1))) & 0xF;
+			pixels[4 * i + 3] = static_cast<uint8_t>(alpha * 17);
+		}
+		break;
+
+	case BCFormat::BC3:
+		DecodeColorScalar(block + 8, false, pixels);
+		DecodeAlphaScalar(block, pixels, 3);
+		break;
+
+	case BCFormat::BC4:
+	case BCFormat::BC5:
+		for (uint32_t i = 0; i < 16; ++i)
+		{
+			pixels[4 * i + 0] = 0;
+			pixels[4 * i + 1] = 0;
+			pixels[4 * i + 2] = 0;
+			pixels[4 * i + 3] = 0xFF;
+		}
+		DecodeAlphaScalar(block, pixels, 0);
+		if (format == BCFormat::BC5)
+		{
+			DecodeAlphaScalar(block + 8, pixels, 1);
+		}
+		break;
+
+	default:
+		assert(false);
+		break;
+	}
+}
+
+
+// SSSE3 decoders.  Each row of four pixels is one 16-byte shuffle of the block's palette.
+
+struct ShuffleTables
+{
+	ShuffleTables()
+	{
+		// A byte of 2-bit color indices selects four RGBA palette entries
+		for (uint32_t bits = 0; bits < 256; ++bits)
+		{
+			for (uint32_t pixel = 0; pixel < 4; ++pixel)
+			{
+				const uint32_t index = (bits >> (2 * pixel)) & 3;
+				for (uint32_t c = 0; c < 4; ++c)
+				{
+					colorRow[bits][4 * pixel + c] = static_cast<uint8_t>(4 * index + c);
+				}
+			}
+		}
+
+		// Twelve bits of 3-bit alpha indices become four index bytes
+		for (uint32_t bits = 0; bits < 4096; ++bits)
+		{
+			uint32_t value = 0;
+			for (uint32_t pixel = 0; pixel < 4; ++pixel)
+			{
+				value |= ((bits >> (3 * pixel)) & 7) << (8 * pixel);
+			}
+			alphaIndices[bits] = value;
+		}
+
+		// Moves one row's worth of per-pixel bytes into a given channel of four RGBA pixels
+		for (uint32_t row = 0; row < 4; ++row)
+		{
+			for (uint32_t channel = 0; channel < 4; ++channel)
+			{
+				for (uint32_t i = 0; i < 16; ++i)
+				{
+					spread[row][channel][i] = (i % 4 == channel) ? static_cast<uint8_t>(4 * row + i / 4) : 0x80;
+				}
+			}
+		}
+	}
+
+	alignas(16) uint8_t colorRow[256][16];
+	alignas(16) uint8_t spread[4][4][16];
+	uint32_t alphaIndices[4096];
+};
+
+
+const ShuffleTables& GetShuffleTables()
+{
+	static const ShuffleTables tables;
+	return tables;
+}
+
+
+KODIAK_TARGET_SSSE3 __m128i LoadRowShuffle(const uint8_t* mask)
+{
+	return _mm_load_si128(reinterpret_cast<const __m128i*>(mask));
+}
+
+
+// One 128-bit register holding the 16 pixel values of a BC3 alpha or BC4/BC5 channel block
+KODIAK_TARGET_SSSE3 __m128i DecodeAlphaValuesSSSE3(const uint8_t* block, const ShuffleTables& tables)
+{
+	uint8_t palette[8];
+	BuildAlphaPalette(block, palette);
+
+	const uint64_t indices = LoadAlphaIndices(block);
+	const __m128i indexBytes = _mm_setr_epi32(
+		static_cast<int>(tables.alphaIndices[indices & 0xFFF]),
+		static_cast<int>(tables.alphaIndices[(indices >> 12) & 0xFFF]),
+		static_cast<int>(tables.alphaIndices[(indices >> 24) & 0xFFF]),
+		static_cast<int>(tables.alphaIndices[(indices >> 36) & 0xFFF]));
+
+	__m128i paletteVector;
+	memcpy(&paletteVector, palette, 8);
+	paletteVector = _mm_loadl_epi64(&paletteVector);
+
+	return _mm_shuffle_epi8(paletteVector, indexBytes);
+}
+
+
+KODIAK_TARGET_SSSE3 void DecodeBlockSSSE3(BCFormat format, const uint8_t* block, uint8_t* dest, size_t destPitch)
+{
+	const auto& tables = GetShuffleTables();
+
+	if (format == BCFormat::BC4 || format == BCFormat::BC5)
+	{
+		const __m128i red = DecodeAlphaValuesSSSE3(block, tables);
+		const __m128i green = (format == BCFormat::BC5) ? DecodeAlphaValuesSSSE3(block + 8, tables) : _mm_setzero_si128();
+		const __m128i opaque = _mm_set1_epi32(static_cast<int>(0xFF000000));
+
+		for (uint32_t row = 0; row < 4; ++row)
+		{
+			__m128i pixels = _mm_or_si128(opaque, _mm_shuffle_epi8(red, LoadRowShuffle(tables.spread[row][0])));
+			pixels = _mm_or_si128(pixels, _mm_shuffle_epi8(green, LoadRowShuffle(tables.spread[row][1])));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dest + row * destPitch), pixels);
+		}
+		return;
+	}
+
+	const uint8_t* colorBlock = (format == BCFormat::BC1) ? block : block + 8;
+
+	uint8_t palette[16];
+	BuildColorPalette(colorBlock, format == BCFormat::BC1, palette);
+	const __m128i paletteVector = _mm_loadu_si128(reinterpret_cast<const __m128i*>(palette));
+
+	__m128i alpha = _mm_setzero_si128();
+	if (format == BCFormat::BC2)
+	{
+		// Sixteen 4-bit values, low nibble first, scaled by 17 to fill the byte
+		const __m128i packed = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(block));
+		const __m128i nibbleMask = _mm_set1_epi8(0x0F);
+		const __m128i low = _mm_and_si128(packed, nibbleMask);
+		const __m128i high = _mm_and_si128(_mm_srli_epi16(packed, 4), nibbleMask);
+		const __m128i values = _mm_unpacklo_epi8(low, high);
+		alpha = _mm_or_si128(values, _mm_slli_epi16(values, 4));
+	}
+	else if (format == BCFormat::BC3)
+	{
+		alpha = DecodeAlphaValuesSSSE3(block, tables);
+	}
+
+	for (uint32_t row = 0; row < 4; ++row)
+	{
+		__m128i pixels = _mm_shuffle_epi8(paletteVector, LoadRowShuffle(tables.colorRow[colorBlock[4 + row]]));
+		if (format != BCFormat::BC1)
+		{
+			pixels = _mm_or_si128(pixels, _mm_shuffle_epi8(alpha, LoadRowShuffle(tables.spread[row][3])));
+		}
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dest + row * destPitch), pixels);
+	}
+}
+
+
+bool DetectSSSE3()
+{
+#if defined(_MSC_VER)
+	int info[4];
+	__cpuid(info, 1);
+	return (info[2] & (1 << 9)) != 0;
+#else
+	unsigned int eax, ebx, ecx, edx;
+	return __get_cpuid(1, &eax, &ebx, &ecx, &edx) && (ecx & bit_SSSE3) != 0;
+#endif
+}
+
+
+const bool g_hasSSSE3 = DetectSSSE3();
+
+
+// BC7
+
+struct BC7ModeInfo
+{
+	uint8_t subsets;
+	uint8_t partitionBits;
+	uint8_t rotationBits;
+	uint8_t indexSelectionBits;
+	uint8_t colorBits;
+	uint8_t alphaBits;
+	uint8_t endpointPBits;
+	uint8_t sharedPBits;
+	uint8_t indexBits;
+	uint8_t secondaryIndexBits;
+};
+
+
+const BC7ModeInfo g_bc7Modes[8] =
+{
+	{ 3, 4, 0, 0, 4, 0, 1, 0, 3, 0 },
+	{ 2, 6, 0, 0, 6, 0, 0, 1, 3, 0 },
+	{ 3, 6, 0, 0, 5, 0, 0, 0, 2, 0 },
+	{ 2, 6, 0, 0, 7, 0, 1, 0, 2, 0 },
+	{ 1, 0, 2, 1, 5, 6, 0, 0, 2, 3 },
+	{ 1, 0, 2, 0, 7, 8, 0, 0, 2, 2 },
+	{ 1, 0, 0, 0, 7, 7, 1, 0, 4, 0 },
+	{ 2, 6, 0, 0, 5, 5, 1, 0, 2, 0 }
+};
+
+
+// Bit i is set if pixel i belongs to subset 1
+const uint16_t g_bc7Partitions2[64] =
+{
+	0xCCCC, 0x8888, 0xEEEE, 0xECC8, 0xC880, 0xFEEC, 0xFEC8, 0xEC80,
+	0xC800, 0xFFEC, 0xFE80, 0xE800, 0xFFE8, 0xFF00, 0xFFF0, 0xF000,
+	0xF710, 0x008E, 0x7100, 0x08CE, 0x008C, 0x7310, 0x3100, 0x8CCE,
+	0x088C, 0x3110, 0x6666, 0x366C, 0x17E8, 0x0FF0, 0x718E, 0x399C,
+	0xAAAA, 0xF0F0, 0x5A5A, 0x33CC, 0x3C3C, 0x55AA, 0x9696, 0xA55A,
+	0x73CE, 0x13C8, 0x324C, 0x3BDC, 0x6996, 0xC33C, 0x9966, 0x0660,
+	0x0272, 0x04E4, 0x4E40, 0x2720, 0xC936, 0x936C, 0x39C6, 0x639C,
+	0x9336, 0x9CC6, 0x817E, 0xE718, 0xCCF0, 0x0FCC, 0x7744, 0xEE22
+};
+
+
+// Two bits per pixel, pixel 0 in the low bits
+const uint32_t g_bc7Partitions3[64] =
+{
+	0xAA685050, 0x6A5A5040, 0x5A5A4200, 0x5450A0A8, 0xA5A50000, 0xA0A05050, 0x5555A0A0, 0x5A5A5050,
+	0xAA550000, 0xAA555500, 0xAAAA5500, 0x90909090, 0x94949494, 0xA4A4A4A4, 0xA9A59450, 0x2A0A4250,
+	0xA5945040, 0x0A425054, 0xA5A5A500, 0x55A0A0A0, 0xA8A85454, 0x6A6A4040, 0xA4A45000, 0x1A1A0500,
+	0x0050A4A4, 0xAAA59090, 0x14696914, 0x69691400, 0xA08585A0, 0xAA821414, 0x50A4A450, 0x6A5A0200,
+	0xA9A58000, 0x5090A0A8, 0xA8A09050, 0x24242424, 0x00AA5500, 0x24924924, 0x24499224, 0x50A50A50,
+	0x500AA550, 0xAAAA4444, 0x66660000, 0xA5A0A5A0, 0x50A050A0, 0x69286928, 0x44AAAA44, 0x66666600,
+	0xAA444444, 0x54A854A8, 0x95809580, 0x96969600, 0xA85454A8, 0x80959580, 0xAA141414, 0x96960000,
+	0xAAAA1414, 0xA05050A0, 0xA0A5A5A0, 0x96000000, 0x40804080, 0xA9A8A9A8, 0xAAAAAA44, 0x2A4A5254
+};
+
+
+// Pixel whose index has an implied leading zero, for subset 1 of two, and subsets 1 and 2 of three
+const uint8_t g_bc7Anchors2[64] =
+{
+	15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15,
+	15,  2,  8,  2,  2,  8,  8, 15,  2,  8,  2,  2,  8,  8,  2,  2,
+	15, 15,  6,  8,  2,  8, 15, 15,  2,  8,  2,  2,  2, 15, 15,  6,
+	 6,  2,  6,  8, 15, 15,  2,  2, 15, 15, 15, 15, 15,  2,  2, 15
+};
+
+
+const uint8_t g_bc7Anchors3a[64] =
+{
+	 3,  3, 15, 15,  8,  3, 15, 15,  8,  8,  6,  6,  6,  5,  3,  3,
+	 3,  3,  8, 15,  3,  3,  6, 10,  5,  8,  8,  6,  8,  5, 15, 15,
+	 8, 15,  3,  5,  6, 10,  8, 15, 15,  3, 15,  5, 15, 15, 15, 15,
+	 3, 15,  5,  5,  5,  8,  5, 10,  5, 10,  8, 13, 15, 12,  3,  3
+};
+
+
+const uint8_t g_bc7Anchors3b[64] =
+{
+	15,  8,  8,  3, 15, 15,  3,  8, 15, 15, 15, 15, 15, 15, 15,  8,
+	15,  8, 15,  3, 15,  8, 15,  8,  3, 15,  6, 10, 15, 15, 10,  8,
+	15,  3, 15, 10, 10,  8,  9, 10,  6, 15,  8, 15,  3,  6,  6,  8,
+	15,  3, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15,  3, 15, 15,  8
+};
+
+
+const uint8_t g_bc7Weights2[4] = { 0, 21, 43, 64 };
+const uint8_t g_bc7Weights3[8] = { 0, 9, 18, 27, 37, 46, 55, 64 };
+const uint8_t g_bc7Weights4[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+
+class BC7BitReader
+{
+public:
+	explicit BC7BitReader(const uint8_t* block)
+	{
+		memcpy(&m_low, block, 8);
+		memcpy(&m_high, block + 8, 8);
+	}
+
+	uint32_t Read(uint32_t count)
+	{
+		uint64_t bits;
+		if (m_position >= 64)
+		{
+			bits = m_high >> (m_position - 64);
+		}
+		else if (m_position == 0 || m_position + count <= 64)
+		{
+			bits = m_low >> m_position;
+		}
+		else
+		{
+			bits = (m_low >> m_position) | (m_high << (64 - m_position));
+		}
+		m_position += count;
+		return static_cast<uint32_t>(bits) & ((1u << count) - 1);
+	}
+
+private:
+	uint64_t m_low{ 0 };
+	uint64_t m_high{ 0 };
+	uint32_t m_position{ 0 };
+};
+
+
+uint8_t BC7Interpolate(uint32_t e0, uint32_t e1, uint32_t index, uint32_t indexBits)
+{
+	const uint8_t* weights = (indexBits == 2) ? g_bc7Weights2 : (indexBits == 3) ? g_bc7Weights3 : g_bc7Weights4;
+	const uint32_t weight = weights[index];
+	return static_cast<uint8_t>(((64 - weight) * e0 + weight * e1 + 32) >> 6);
+}
+
+
+void DecodeBC7Block(const uint8_t* block, uint8_t* pixels)
+{
+	if (block[0] == 0)
+	{
+		// Reserved mode
+		memset(pixels, 0, 64);
+		return;
+	}
+
+	uint32_t mode = 0;
+	while ((block[0] & (1 << mode)) == 0)
+	{
+		++mode;
+	}
+	const auto& info = g_bc7Modes[mode];
+
+	BC7BitReader reader(block);
+	reader.Read(mode + 1);
+
+	const uint32_t partition = reader.Read(info.partitionBits);
+	const uint32_t rotation = reader.Read(info.rotationBits);
+	const uint32_t indexSelection = reader.Read(info.indexSelectionBits);
+
+	// endpoints[subset][endpoint][channel]
+	uint8_t endpoints[3][2][4] = {};
+	for (uint32_t c = 0; c < 3; ++c)
+	{
+		for (uint32_t s = 0; s < info.subsets; ++s)
+		{
+			endpoints[s][0][c] = static_cast<uint8_t>(reader.Read(info.colorBits));
+			endpoints[s][1][c] = static_cast<uint8_t>(reader.Read(info.colorBits));
+		}
+	}
+	for (uint32_t s = 0; s < info.subsets && info.alphaBits; ++s)
+	{
+		endpoints[s][0][3] = static_cast<uint8_t>(reader.Read(info.alphaBits));
+		endpoints[s][1][3] = static_cast<uint8_t>(reader.Read(info.alphaBits));
+	}
+
+	uint32_t colorBits = info.colorBits;
+	uint32_t alphaBits = info.alphaBits;
+	if (info.endpointPBits || info.sharedPBits)
+	{
+		uint32_t pBits[3][2];
+		for (uint32_t s = 0; s < info.subsets; ++s)
+		{
+			pBits[s][0] = reader.Read(1);
+			pBits[s][1] = info.sharedPBits ? pBits[s][0] : reader.Read(1);
+		}
+
+		const uint32_t channels = info.alphaBits ? 4 : 3;
+		for (uint32_t s = 0; s < info.subsets; ++s)
+		{
+			for (uint32_t e = 0; e < 2; ++e)
+			{
+				for (uint32_t c = 0; c < channels; ++c)
+				{
+					endpoints[s][e][c] = static_cast<uint8_t>((endpoints[s][e][c] << 1) | pBits[s][e]);
+				}
+			}
+		}
+		++colorBits;
+		alphaBits += info.alphaBits ? 1 : 0;
+	}
+
+	// Widen to 8 bits by replicating the high bits
+	for (uint32_t s = 0; s < info.subsets; ++s)
+	{
+		for (uint32_t e = 0; e < 2; ++e)
+		{
+			for (uint32_t c = 0; c < 3; ++c)
+			{
+				const uint32_t value = endpoints[s][e][c] << (8 - colorBits);
+				endpoints[s][e][c] = static_cast<uint8_t>(value | (value >> colorBits));
+			}
+			if (alphaBits)
+			{
+				const uint32_t value = endpoints[s][e][3] << (8 - alphaBits);
+				endpoints[s][e][3] = static_cast<uint8_t>(value | (value >> alphaBits));
+			}
+			else
+			{
+				endpoints[s][e][3] = 0xFF;
+			}
+		}
+	}
+
+	uint32_t subsetOf[16] = {};
+	uint32_t anchor1 = 16;
+	uint32_t anchor2 = 16;
+	if (info.subsets == 2)
+	{
+		for (uint32_t i = 0; i < 16; ++i)
+		{
+			subsetOf[i] = (g_bc7Partitions2[partition] >> i) & 1;
+		}
+		anchor1 = g_bc7Anchors2[partition];
+	}
+	else if (info.subsets == 3)
+	{
+		for (uint32_t i = 0; i < 16; ++i)
+		{
+			subsetOf[i] = (g_bc7Partitions3[partition] >> (2 * i)) & 3;
+		}
+		anchor1 = g_bc7Anchors3a[partition];
+		anchor2 = g_bc7Anchors3b[partition];
+	}
+
+	uint32_t indices[16];
+	for (uint32_t i = 0; i < 16; ++i)
+	{
+		const bool isAnchor = (i == 0 || i == anchor1 || i == anchor2);
+		indices[i] = reader.Read(info.indexBits - (isAnchor ? 1 : 0));
+	}
+
+	uint32_t secondaryIndices[16] = {};
+	for (uint32_t i = 0; i < 16 && info.secondaryIndexBits; ++i)
+	{
+		secondaryIndices[i] = reader.Read(info.secondaryIndexBits - (i == 0 ? 1 : 0));
+	}
+
+	for (uint32_t i = 0; i < 16; ++i)
+	{
+		const auto& e = endpoints[subsetOf[i]];
+
+		uint32_t colorIndex = indices[i];
+		uint32_t colorIndexBits = info.indexBits;
+		uint32_t alphaIndex = indices[i];
+		uint32_t alphaIndexBits = info.indexBits;
+		if (info.secondaryIndexBits)
+		{
+			if (indexSelection)
+			{
+				colorIndex = secondaryIndices[i];
+				colorIndexBits = info.secondaryIndexBits;
+			}
+			else
+			{
+				alphaIndex = secondaryIndices[i];
+				alphaIndexBits = info.secondaryIndexBits;
+			}
+		}
+
+		uint8_t* pixel = pixels + 4 * i;
+		for (uint32_t c = 0; c < 3; ++c)
+		{
+			pixel[c] = BC7Interpolate(e[0][c], e[1][c], colorIndex, colorIndexBits);
+		}
+		pixel[3] = BC7Interpolate(e[0][3], e[1][3], alphaIndex, alphaIndexBits);
+
+		if (rotation)
+		{
+			swap(pixel[3], pixel[rotation - 1]);
+		}
+	}
+}
+
+
+void DecodeBlock(BCFormat format, const uint8_t* block, uint8_t* dest, size_t destPitch)
+{
+	if (format != BCFormat::BC7 && g_hasSSSE3)
+	{
+		DecodeBlockSSSE3(format, block, dest, destPitch);
+		return;
+	}
+
+	uint8_t pixels[64];
+	if (format == BCFormat::BC7)
+	{
+		DecodeBC7Block(block, pixels);
+	}
+	else
+	{
+		DecodeBlockScalar(format, block, pixels);
+	}
+
+	for (uint32_t row = 0; row < 4; ++row)
+	{
+		memcpy(dest + row * destPitch, pixels + 16 * row, 16);
+	}
+}
+
+} // anonymous namespace
+
+
+namespace Kodiak
+{
+
+size_t GetBCBlockBytes(BCFormat format)
+{
+	return (format == BCFormat::BC1 || format == BCFormat::BC4) ? 8 : 16;
+}
+
+
+void DecodeBCBlock(BCFormat format, const uint8_t* block, uint8_t* dest, size_t destPitch)
+{
+	DecodeBlock(format, block, dest, destPitch);
+}
+
+
+void DecodeBCBlockRows(BCFormat format, const uint8_t* src, size_t srcRowBytes, uint32_t width, uint32_t height,
+	uint32_t firstBlockRow, uint32_t blockRowCount, uint8_t* dest, size_t destPitch)
+{
+	const size_t blockBytes = GetBCBlockBytes(format);
+	const uint32_t blocksWide = (width + 3) / 4;
+	const uint32_t blocksHigh = (height + 3) / 4;
+	const uint32_t lastBlockRow = min(firstBlockRow + blockRowCount, blocksHigh);
+
+	for (uint32_t blockY = firstBlockRow; blockY < lastBlockRow; ++blockY)
+	{
+		const uint8_t* srcRow = src + blockY * srcRowBytes;
+		uint8_t* destRow = dest + 4 * blockY * destPitch;
+		const uint32_t rows = min<uint32_t>(4, height - 4 * blockY);
+
+		for (uint32_t blockX = 0; blockX < blocksWide; ++blockX)
+		{
+			const uint8_t* block = srcRow + blockX * blockBytes;
+			uint8_t* destBlock = destRow + 16 * blockX;
+			const uint32_t columns = min<uint32_t>(4, width - 4 * blockX);
+
+			if (rows == 4 && columns == 4)
+			{
+				DecodeBlock(format, block, destBlock, destPitch);
+				continue;
+			}
+
+			// Clipped at the surface edge
+			uint8_t pixels[64];
+			DecodeBlock(format, block, pixels, 16);
+			for (uint32_t row = 0; row < rows; ++row)
+			{
+				memcpy(destBlock + row * destPitch, pixels + 16 * row, 4 * columns);
+			}
+		}
+	}
+}
+
+
+bool IsBCDecoderVectorized()
+{
+	return g_hasSSSE3;
+}
+
+} // namespace Kodiak
\ No newline at end of file
@@ -0,0 +1,48 @@
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+// Author: David Elder
+//
+
+#pragma once
+
+// CPU decoding of block-compressed (BC1-BC5, BC7) textures to RGBA8, for tools and validation that
+// need the pixels without a GPU.  BC1-BC5 use SSSE3 shuffles when the CPU has them; BC7 is decoded
+// per block.  This header and BCDecoder.cpp only depend on the standard library and the SSE intrinsics.
+
+#include <cstddef>
+#include <cstdint>
+
+namespace Kodiak
+{
+
+enum class BCFormat
+{
+	BC1,	// RGB with 1-bit alpha
+	BC2,	// RGB with explicit 4-bit alpha
+	BC3,	// RGB with interpolated alpha
+	BC4,	// R, decoded as (r, 0, 0, 255)
+	BC5,	// RG, decoded as (r, g, 0, 255)
+	BC7
+};
+
+
+// Size of a 4x4 block
+size_t GetBCBlockBytes(BCFormat format);
+
+// Decodes one block to 4x4 RGBA8 pixels, with dest rows destPitch bytes apart
+void DecodeBCBlock(BCFormat format, const uint8_t* block, uint8_t* dest, size_t destPitch);
+
+// Decodes the block rows [firstBlockRow, firstBlockRow + blockRowCount) of a width x height surface.
+// Source block rows are srcRowBytes apart, and dest holds the whole surface as RGBA8.  Partial blocks at
+// the right and bottom edges are clipped.  Disjoint ranges of block rows can be decoded concurrently.
+void DecodeBCBlockRows(BCFormat format, const uint8_t* src, size_t srcRowBytes, uint32_t width, uint32_t height,
+	uint32_t firstBlockRow, uint32_t blockRowCount, uint8_t* dest, size_t destPitch);
+
+// True if BC1-BC5 decode with SSSE3 on this CPU
+bool IsBCDecoderVectorized();
+
+} // namespace Kodiak
\ No newline at end of file
@@ -0,0 +1,171 @@
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+// Author: David Elder
+//
+
+#include "Stdafx.h"
+
+#include "BindlessDescriptorHeap12.h"
+
+#include "CommandListManager12.h"
+#include "DeviceManager12.h"
+
+
+using namespace Kodiak;
+using namespace std;
+using namespace Microsoft::WRL;
+
+
+namespace
+{
+
+// Tier 1 hardware can only see this many SRVs from a shader stage
+const uint32_t s_maxTier1Descriptors = 128;
+
+atomic<uint64_t> s_nextDescriptorKey{ 0 };
+
+} // anonymous namespace
+
+
+void BindlessDescriptorHeap::Create(uint32_t numDescriptors)
+{
+	assert(!m_heap);
+	assert(numDescriptors > 1);
+
+	D3D12_FEATURE_DATA_D3D12_OPTIONS featureData = {};
+	if (SUCCEEDED(g_device->CheckFeatureSupport(D3D12_FEATURE_D3D12_OPTIONS, &featureData, sizeof(featureData))) &&
+		featureData.ResourceBindingTier == D3D12_RESOURCE_BINDING_TIER_1 &&
+		numDescriptors > s_maxTier1Descriptors)
+	{
+		LOG_WARNING << "Resource binding tier 1, limiting the bindless heap to " << s_maxTier1Descriptors << " descriptors";
+		numDescriptors = s_maxTier1Descriptors;
+	}
+
+	D3D12_DESCRIPTOR_HEAP_DESC heapDesc = {};
+	heapDesc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV;
+	heapDesc.NumDescriptors = numDescriptors;
+	heapDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE;
+	heapDesc.NodeMask = 1;
+	ThrowIfFailed(g_device->CreateDescriptorHeap(&heapDesc, IID_PPV_ARGS(&m_heap)));
+	m_heap->SetName(L"Bindless descriptor heap");
+
+	m_cpuStart = m_heap->GetCPUDescriptorHandleForHeapStart();
+	m_gpuStart = m_heap->GetGPUDescriptorHandleForHeapStart();
+	m_descriptorSize = g_device->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+	m_capacity = numDescriptors;
+
+	m_allocator = make_unique<DescriptorIndexAllocator>(numDescriptors - 1);
+
+	// Reads through the null SRV return zero
+	D3D12_SHADER_RESOURCE_VIEW_DESC nullDesc = {};
+	nullDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+	nullDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D;
+	nullDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
+	nullDesc.Texture2D.MipLevels = 1;
+	g_device->CreateShaderResourceView(nullptr, &nullDesc, GetCpuHandle(kNullIndex));
+}
+
+
+uint32_t BindlessDescriptorHeap::Acquire(uint64_t key, D3D12_CPU_DESCRIPTOR_HANDLE srv)
+{
+	lock_guard<mutex> CS(m_mutex);
+
+	assert(m_allocator);
+
+	bool isNew = false;
+	const uint32_t slot = m_allocator->Acquire(key, isNew);
+	if (slot == DescriptorIndexAllocator::kInvalidIndex)
+	{
+		if (m_failedCount++ == 0)
+		{
+			LOG_ERROR << "Bindless descriptor heap is full (" << m_capacity << " descriptors), using the null SRV";
+		}
+		return kNullIndex;
+	}
+
+	const uint32_t index = slot + 1;
+	if (isNew)
+	{
+		g_device->CopyDescriptorsSimple(1, GetCpuHandle(index), srv, D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+		m_peakUsed = max(m_peakUsed, m_allocator->GetNumUsed());
+	}
+
+	return index;
+}
+
+
+void BindlessDescriptorHeap::Release(uint64_t key)
+{
+	lock_guard<mutex> CS(m_mutex);
+
+	m_allocator->Release(key);
+}
+
+
+void BindlessDescriptorHeap::RetireReleased()
+{
+	auto& commandListManager = CommandListManager::GetInstance();
+
+	lock_guard<mutex> CS(m_mutex);
+
+	if (!m_allocator)
+	{
+		return;
+	}
+
+	m_allocator->Reclaim([&commandListManager](uint64_t fenceValue)
+	{
+		return commandListManager.IsFenceComplete(fenceValue);
+	});
+
+	if (m_allocator->HasReleased())
+	{
+		m_allocator->RetireReleased(commandListManager.IncrementFence());
+	}
+}
+
+
+void BindlessDescriptorHeap::LogStats()
+{
+	lock_guard<mutex> CS(m_mutex);
+
+	if (m_peakUsed == 0)
+	{
+		return;
+	}
+
+	LOG_INFO << "Bindless descriptors: " << m_peakUsed << " of " << (m_capacity - 1) << " in use at peak";
+	if (m_failedCount > 0)
+	{
+		LOG_WARNING << "Bindless descriptor heap was full for " << m_failedCount << " requests";
+	}
+}
+
+
+D3D12_CPU_DESCRIPTOR_HANDLE BindlessDescriptorHeap::GetCpuHandle(uint32_t index) const
+{
+	D3D12_CPU_DESCRIPTOR_HANDLE handle = m_cpuStart;
+	handle.ptr += static_cast<size_t>(index) * m_descriptorSize;
+	return handle;
+}
+
+
+BindlessDescriptor::BindlessDescriptor(D3D12_CPU_DESCRIPTOR_HANDLE srv)
+	: m_key(++s_nextDescriptorKey)
+{
+	m_index = BindlessDescriptorHeap::GetInstance().Acquire(m_key, srv);
+}
+
+
+BindlessDescriptor::~BindlessDescriptor()
+{
+	// The null SRV isn't reference counted
+	if (m_index != BindlessDescriptorHeap::kNullIndex)
+	{
+		BindlessDescriptorHeap::GetInstance().Release(m_key);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,85 @@
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+// Author: David Elder
+//
+
+#pragma once
+
+#include "DescriptorIndexAllocator.h"
+
+namespace Kodiak
+{
+
+// One shader-visible heap, created at startup, that bindless effects index into with descriptor indices from their
+// material constants.  Each key's SRV is copied in the first time it is acquired, and its slot is shared until the
+// last reference is released.  Frames in flight may be reading a slot, so it is never rewritten: a view that changes
+// needs a new key, and the old slot is reused once the GPU has finished the frame that released it.  Slot 0 holds a
+// null SRV, which is handed out if the heap fills up.
+class BindlessDescriptorHeap
+{
+public:
+	static const uint32_t kNullIndex = 0;
+
+	static BindlessDescriptorHeap& GetInstance()
+	{
+		static BindlessDescriptorHeap instance;
+		return instance;
+	}
+
+	void Create(uint32_t numDescriptors);
+
+	uint32_t Acquire(uint64_t key, D3D12_CPU_DESCRIPTOR_HANDLE srv);
+	void Release(uint64_t key);
+
+	// Call after the frame's command lists are submitted, so slots released during it are reused only after them
+	void RetireReleased();
+
+	ID3D12DescriptorHeap* GetHeap() const { return m_heap.Get(); }
+	D3D12_GPU_DESCRIPTOR_HANDLE GetGpuStart() const { return m_gpuStart; }
+	uint32_t GetCapacity() const { return m_capacity; }
+
+	void LogStats();
+
+private:
+	D3D12_CPU_DESCRIPTOR_HANDLE GetCpuHandle(uint32_t index) const;
+
+private:
+	std::mutex										m_mutex;
+
+	Microsoft::WRL::ComPtr<ID3D12DescriptorHeap>	m_heap;
+	D3D12_CPU_DESCRIPTOR_HANDLE						m_cpuStart{ 0 };
+	D3D12_GPU_DESCRIPTOR_HANDLE						m_gpuStart{ 0 };
+	uint32_t										m_descriptorSize{ 0 };
+	uint32_t										m_capacity{ 0 };
+
+	// Allocates slots 1 and up, since slot 0 is the null SRV
+	std::unique_ptr<DescriptorIndexAllocator>		m_allocator;
+
+	uint32_t										m_peakUsed{ 0 };
+	uint32_t										m_failedCount{ 0 };
+};
+
+
+// Holds a slot of its own in the bindless heap, with a copy of the SRV as it was when created, while it's alive.
+// Share one through shared_ptr, and create another when the view changes.
+class BindlessDescriptor
+{
+public:
+	explicit BindlessDescriptor(D3D12_CPU_DESCRIPTOR_HANDLE srv);
+	~BindlessDescriptor();
+
+	BindlessDescriptor(const BindlessDescriptor&) = delete;
+	BindlessDescriptor& operator=(const BindlessDescriptor&) = delete;
+
+	uint32_t GetIndex() const { return m_index; }
+
+private:
+	const uint64_t						m_key;
+	uint32_t							m_index{ BindlessDescriptorHeap::kNullIndex };
+};
+
+} // namespace Kodiak
\ No newline at end of file
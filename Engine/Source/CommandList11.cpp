@@ -65,6 +65,30 @@ void CommandList::CopyCounter(GpuBuffer& dest, size_t destOffset, StructuredBuff
 }
 
 
+void CommandList::InitializeBuffer(ID3D11Buffer* dest, const void* data, size_t numBytes, size_t destOffset)
+{
+	ComPtr<ID3D11Buffer> staging;
+
+	D3D11_BUFFER_DESC desc{};
+
+	desc.ByteWidth = static_cast<UINT>(numBytes);
+	desc.BindFlags = 0;
+	desc.Usage = D3D11_USAGE_IMMUTABLE;
+	desc.MiscFlags = 0;
+
+	D3D11_SUBRESOURCE_DATA initData;
+	initData.pSysMem = data;
+	initData.SysMemPitch = 0;
+	initData.SysMemSlicePitch = 0;
+
+	ThrowIfFailed(g_device->CreateBuffer(&desc, &initData, &staging));
+
+	auto& commandList = CommandList::Begin();
+	commandList.m_context->CopySubresourceRegion(dest, 0, static_cast<UINT>(destOffset), 0, 0, staging.Get(), 0, nullptr);
+	commandList.CloseAndExecute(true);
+}
+
+
 void CommandList::InitializeTextureArraySlice(GpuResource& dest, UINT sliceIndex, GpuResource& src)
 {
 	auto& commandList = CommandList::Begin();
@@ -82,6 +82,7 @@ public:
 
 	void CopyCounter(GpuBuffer& dest, size_t destOffset, StructuredBuffer& src);
 
+	static void InitializeBuffer(ID3D11Buffer* dest, const void* data, size_t numBytes, size_t destOffset = 0);
 	static void InitializeTextureArraySlice(GpuResource& dest, UINT sliceIndex, GpuResource& src);
 
 	void WriteBuffer(GpuResource& dest, size_t destOffset, const void* data, size_t numBytes);
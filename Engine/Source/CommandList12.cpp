@@ -134,7 +134,7 @@ void CommandList::InitializeTexture(GpuResource& dest, UINT numSubresources, D3D
 }
 
 
-void CommandList::InitializeBuffer(GpuResource& dest, const void* bufferData, size_t numBytes)
+void CommandList::InitializeBuffer(GpuResource& dest, const void* bufferData, size_t numBytes, size_t destOffset)
 {
 	ID3D12Resource* uploadBuffer = nullptr;
 
@@ -170,12 +170,14 @@ void CommandList::InitializeBuffer(GpuResource& dest, const void* bufferData, si
 
 	void* destAddress = nullptr;
 	uploadBuffer->Map(0, nullptr, &destAddress);
-	SIMDMemCopy(destAddress, bufferData, Math::DivideByMultiple(numBytes, 16));
+	// Sources can be sub-ranges of a file or of the geometry pool's inputs, so they aren't necessarily
+	// 16 byte aligned like SIMDMemCopy needs
+	memcpy(destAddress, bufferData, numBytes);
 	uploadBuffer->Unmap(0, nullptr);
 
 	// copy data to the intermediate upload heap and then schedule a copy from the upload heap to the default texture
 	commandList.TransitionResource(dest, ResourceState::CopyDest, true);
-	commandList.m_commandList->CopyResource(dest.GetResource(), uploadBuffer);
+	commandList.m_commandList->CopyBufferRegion(dest.GetResource(), destOffset, uploadBuffer, 0, numBytes);
 	commandList.TransitionResource(dest, ResourceState::GenericRead, true);
 
 	// Execute the command list and wait for it to finish so we can release the upload buffer
@@ -223,6 +225,9 @@ void CommandList::InitializeTextureArraySlice(GpuResource& dest, UINT sliceIndex
 		commandList.m_commandList->CopyTextureRegion(&destCopyLocation, 0, 0, 0, &srcCopyLocation, nullptr);
 	}
 
+	// Texture arrays are sampled like any other texture, so leave them readable
+	commandList.TransitionResource(dest, ResourceState::GenericRead, true);
+
 	commandList.Finish();
 }
 
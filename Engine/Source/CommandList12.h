@@ -96,7 +96,7 @@ public:
 	void ResetCounter(StructuredBuffer& Buf, uint32_t Value = 0);
 
 	static void InitializeTexture(GpuResource& dest, UINT numSubresources, D3D12_SUBRESOURCE_DATA subData[]);
-	static void InitializeBuffer(GpuResource& dest, const void* data, size_t numBytes);
+	static void InitializeBuffer(GpuResource& dest, const void* data, size_t numBytes, size_t destOffset = 0);
 	static void InitializeTextureArraySlice(GpuResource& dest, UINT sliceIndex, GpuResource& src);
 
 	void WriteBuffer(GpuResource& dest, size_t destOffset, const void* data, size_t numBytes);
@@ -203,6 +203,7 @@ public:
 	void SetConstants(UINT rootIndex, DWParam x, DWParam y, DWParam z);
 	void SetConstants(UINT rootIndex, DWParam x, DWParam y, DWParam z, DWParam w);
 	void SetConstantBuffer(uint32_t rootIndex, const ConstantBuffer& cbuffer);
+	void SetConstantBuffer(uint32_t rootIndex, D3D12_GPU_VIRTUAL_ADDRESS cbv);
 
 	byte* MapConstants(ConstantBuffer& cbuffer);
 	void UnmapConstants(const ConstantBuffer& cbuffer) {}
@@ -216,6 +217,7 @@ public:
 
 	void SetDynamicDescriptor(uint32_t rootIndex, uint32_t offset, D3D12_CPU_DESCRIPTOR_HANDLE handle);
 	void SetDynamicDescriptors(uint32_t rootIndex, uint32_t offset, uint32_t count, const D3D12_CPU_DESCRIPTOR_HANDLE handles[]);
+	void SetDescriptorTable(uint32_t rootIndex, D3D12_GPU_DESCRIPTOR_HANDLE firstHandle);
 
 	void Draw(uint32_t vertexCount, uint32_t vertexStartOffset = 0);
 	void DrawIndexed(uint32_t indexCount, uint32_t startIndexLocation = 0, int32_t BaseVertexLocation = 0);
@@ -382,7 +384,10 @@ inline void GraphicsCommandList::SetDynamicDescriptors(uint32_t rootIndex, uint3
 
 inline void GraphicsCommandList::SetRootSignature(const RootSignature& rootSig)
 {
-	if(rootSig.GetSignature() == m_currentGraphicsRootSignature)
+	const bool changed = rootSig.GetSignature() != m_currentGraphicsRootSignature;
+	RootSignature::RecordBind(changed);
+
+	if(!changed)
 	{
 		return;
 	}
@@ -394,6 +399,18 @@ inline void GraphicsCommandList::SetRootSignature(const RootSignature& rootSig)
 }
 
 
+inline void GraphicsCommandList::SetConstantBuffer(uint32_t rootIndex, D3D12_GPU_VIRTUAL_ADDRESS cbv)
+{
+	m_commandList->SetGraphicsRootConstantBufferView(rootIndex, cbv);
+}
+
+
+inline void GraphicsCommandList::SetDescriptorTable(uint32_t rootIndex, D3D12_GPU_DESCRIPTOR_HANDLE firstHandle)
+{
+	m_commandList->SetGraphicsRootDescriptorTable(rootIndex, firstHandle);
+}
+
+
 inline void GraphicsCommandList::SetStencilRef(uint32_t stencilRef)
 {
 	m_commandList->OMSetStencilRef(stencilRef);
@@ -453,7 +470,10 @@ inline void GraphicsCommandList::DrawIndirect(GpuBuffer& argumentBuffer, size_t
 
 inline void ComputeCommandList::SetRootSignature(const RootSignature& rootSig)
 {
-	if (rootSig.GetSignature() == m_currentComputeRootSignature)
+	const bool changed = rootSig.GetSignature() != m_currentComputeRootSignature;
+	RootSignature::RecordBind(changed);
+
+	if (!changed)
 	{
 		return;
 	}
@@ -30,7 +30,8 @@ void ComputeConstantBuffer::SetDataImmediate(size_t sizeInBytes, const byte* dat
 }
 
 
-void ComputeConstantBuffer::CreateRenderThreadData(shared_ptr<RenderThread::ComputeData> computeData, const ShaderReflection::CBVLayout& cbv)
+void ComputeConstantBuffer::CreateRenderThreadData(shared_ptr<RenderThread::ComputeData> computeData, const ShaderReflection::CBVLayout& cbv,
+	const vector<ShaderReflection::Parameter<1>>& parameters)
 {
 	m_renderThreadData = computeData;
 
@@ -40,4 +41,54 @@ void ComputeConstantBuffer::CreateRenderThreadData(shared_ptr<RenderThread::Comp
 	{
 		m_binding = computeData->cbufferData + cbv.byteOffset;
 	}
+
+	m_members.clear();
+	m_validatedMembers = nullptr;
+	m_rejectedMembers = nullptr;
+
+	for (const auto& parameter : parameters)
+	{
+		if (parameter.cbvShaderRegister[0] == cbv.shaderRegister)
+		{
+			ShaderReflection::CBVMember member;
+			member.name = parameter.name;
+			member.byteOffset = parameter.byteOffset[0];
+			member.sizeInBytes = parameter.sizeInBytes;
+			m_members.push_back(member);
+		}
+	}
+}
+
+
+void ComputeConstantBuffer::SetConstantsImmediate(const byte* data, size_t sizeInBytes,
+	const ShaderReflection::ConstantStructMember* members, size_t numMembers)
+{
+	// Kernel isn't set up yet
+	if (m_binding == nullptr)
+	{
+		return;
+	}
+
+	if (members != m_validatedMembers)
+	{
+		// Only log a mismatch once
+		if (members == m_rejectedMembers)
+		{
+			return;
+		}
+
+		if (!ShaderReflection::ValidateConstantLayout(m_name, m_size, m_members, sizeInBytes, members, numMembers))
+		{
+			m_rejectedMembers = members;
+			return;
+		}
+		m_validatedMembers = members;
+	}
+
+	memcpy(m_binding, data, sizeInBytes);
+
+	if (auto computeData = m_renderThreadData.lock())
+	{
+		computeData->cbufferDirty = true;
+	}
 }
\ No newline at end of file
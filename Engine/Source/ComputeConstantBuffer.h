@@ -27,13 +27,32 @@ public:
 
 	void SetDataImmediate(size_t sizeInBytes, const byte* data);
 
-	void CreateRenderThreadData(std::shared_ptr<RenderThread::ComputeData> computeData, const ShaderReflection::CBVLayout& cbv);
+	// Sets the whole cbuffer from a struct that mirrors it, in one copy.  The struct is checked against the
+	// reflected cbuffer the first time each members table is used, and nothing is written if they don't match.
+	template <typename T, size_t N>
+	void SetConstantsImmediate(const T& constants, const ShaderReflection::ConstantStructMember(&members)[N])
+	{
+		static_assert(std::is_trivially_copyable<T>::value, "Constants are copied with memcpy");
+		SetConstantsImmediate(reinterpret_cast<const byte*>(&constants), sizeof(T), members, N);
+	}
+
+	void CreateRenderThreadData(std::shared_ptr<RenderThread::ComputeData> computeData, const ShaderReflection::CBVLayout& cbv,
+		const std::vector<ShaderReflection::Parameter<1>>& parameters);
+
+private:
+	void SetConstantsImmediate(const byte* data, size_t sizeInBytes, const ShaderReflection::ConstantStructMember* members,
+		size_t numMembers);
 
 private:
 	const std::string	m_name;
 
 	size_t				m_size{ kInvalid };
 
+	// Reflected variables, and the last members tables that did and didn't match them
+	std::vector<ShaderReflection::CBVMember>			m_members;
+	const ShaderReflection::ConstantStructMember*		m_validatedMembers{ nullptr };
+	const ShaderReflection::ConstantStructMember*		m_rejectedMembers{ nullptr };
+
 	// Render thread data
 	std::weak_ptr<RenderThread::ComputeData>	m_renderThreadData;
 	byte*										m_binding{ nullptr };
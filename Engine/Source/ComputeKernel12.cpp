@@ -44,54 +44,24 @@ void ComputeKernel::SetComputeShaderPath(const string& path, bool immediate)
 }
 
 
-shared_ptr<ComputeConstantBuffer> ComputeKernel::GetConstantBuffer(const string& name)
+shared_ptr<ComputeConstantBuffer> ComputeKernel::GetConstantBuffer(ParamId id)
 {
 	lock_guard<mutex> CS(m_constantBufferLock);
-
-	auto it = m_constantBuffers.find(name);
-	if (end(m_constantBuffers) != it)
-	{
-		return it->second;
-	}
-
-	auto constantBuffer = make_shared<ComputeConstantBuffer>(name);
-	m_constantBuffers[name] = constantBuffer;
-
-	return constantBuffer;
+	return m_constantBuffers.FindOrCreate(id);
 }
 
 
-shared_ptr<ComputeParameter> ComputeKernel::GetParameter(const string& name)
+shared_ptr<ComputeParameter> ComputeKernel::GetParameter(ParamId id)
 {
 	lock_guard<mutex> CS(m_parameterLock);
-
-	auto it = m_parameters.find(name);
-	if (end(m_parameters) != it)
-	{
-		return it->second;
-	}
-
-	auto parameter = make_shared<ComputeParameter>(name);
-	m_parameters[name] = parameter;
-
-	return parameter;
+	return m_parameters.FindOrCreate(id);
 }
 
 
-shared_ptr<ComputeResource> ComputeKernel::GetResource(const string& name)
+shared_ptr<ComputeResource> ComputeKernel::GetResource(ParamId id)
 {
 	lock_guard<mutex> CS(m_resourceLock);
-
-	auto it = m_resources.find(name);
-	if (end(m_resources) != it)
-	{
-		return it->second;
-	}
-
-	auto resource = make_shared<ComputeResource>(name);
-	m_resources[name] = resource;
-
-	return resource;
+	return m_resources.FindOrCreate(id);
 }
 
 
@@ -323,7 +293,7 @@ void ComputeKernel::SetupKernel()
 	for (const auto& cbv : shaderSig.cbvTable)
 	{
 		auto computeConstantBuffer = GetConstantBuffer(cbv.name);
-		computeConstantBuffer->CreateRenderThreadData(m_renderThreadData, cbv);
+		computeConstantBuffer->CreateRenderThreadData(m_renderThreadData, cbv, shaderSig.parameters);
 	}
 
 	// Parameters
@@ -9,6 +9,7 @@
 
 #pragma once
 
+#include "ParamId.h"
 #include "Shader.h"
 
 #include "GpuBuffer12.h"
@@ -39,9 +40,9 @@ public:
 
 	void SetComputeShaderPath(const std::string& path, bool immediate = false);
 
-	std::shared_ptr<ComputeConstantBuffer> GetConstantBuffer(const std::string& name);
-	std::shared_ptr<ComputeParameter> GetParameter(const std::string& name);
-	std::shared_ptr<ComputeResource> GetResource(const std::string& name);
+	std::shared_ptr<ComputeConstantBuffer> GetConstantBuffer(ParamId id);
+	std::shared_ptr<ComputeParameter> GetParameter(ParamId id);
+	std::shared_ptr<ComputeResource> GetResource(ParamId id);
 
 	void Dispatch(ComputeCommandList& commandList, size_t groupCountX = 1, size_t groupCountY = 1, size_t groupCountZ = 1);
 	void Dispatch1D(ComputeCommandList& commandList, size_t threadCountX, size_t groupSizeX = 64);
@@ -62,13 +63,13 @@ private:
 	std::shared_ptr<ComputeShader>		m_computeShader;
 	
 	std::mutex														m_constantBufferLock;
-	std::map<std::string, std::shared_ptr<ComputeConstantBuffer>>	m_constantBuffers;
+	ParamIdMap<ComputeConstantBuffer>								m_constantBuffers;
 
 	std::mutex													m_parameterLock;
-	std::map<std::string, std::shared_ptr<ComputeParameter>>	m_parameters;
+	ParamIdMap<ComputeParameter>								m_parameters;
 
 	std::mutex													m_resourceLock;
-	std::map<std::string, std::shared_ptr<ComputeResource>>		m_resources;
+	ParamIdMap<ComputeResource>									m_resources;
 
 	// Render thread data
 	std::shared_ptr<RenderThread::ComputeData>	m_renderThreadData;
@@ -0,0 +1,84 @@
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+// Author: David Elder
+//
+
+#include "Stdafx.h"
+
+#include "ComputeKernelPermutations.h"
+
+
+using namespace Kodiak;
+using namespace std;
+
+
+namespace
+{
+
+atomic<uint32_t> s_declaredCount{ 0 };
+atomic<uint32_t> s_createdCount{ 0 };
+atomic<uint64_t> s_createMicroseconds{ 0 };
+
+} // anonymous namespace
+
+
+ComputeKernelPermutations::ComputeKernelPermutations(const string& name, uint32_t numPermutations, uint32_t numInstances,
+	PathFunction getPath)
+	: m_name(name)
+	, m_numPermutations(numPermutations)
+	, m_numInstances(numInstances)
+	, m_getPath(move(getPath))
+	, m_kernels(numPermutations * numInstances)
+{
+	s_declaredCount += numPermutations * numInstances;
+}
+
+
+void ComputeKernelPermutations::Request(uint32_t key, uint32_t instance)
+{
+	if (Find(key, instance))
+	{
+		return;
+	}
+
+	// Set up outside the lock, so the render thread's lookups don't wait on the load
+	const auto startTime = chrono::high_resolution_clock::now();
+
+	const bool immediate = true;
+	auto kernel = make_unique<ComputeKernel>(m_name);
+	kernel->SetComputeShaderPath(m_getPath(key), immediate);
+
+	const auto elapsed = chrono::high_resolution_clock::now() - startTime;
+	s_createMicroseconds += chrono::duration_cast<chrono::microseconds>(elapsed).count();
+	++s_createdCount;
+
+	lock_guard<mutex> CS(m_kernelLock);
+	m_kernels[key * m_numInstances + instance] = move(kernel);
+}
+
+
+ComputeKernel* ComputeKernelPermutations::Find(uint32_t key, uint32_t instance)
+{
+	assert(key < m_numPermutations);
+	assert(instance < m_numInstances);
+
+	lock_guard<mutex> CS(m_kernelLock);
+	return m_kernels[key * m_numInstances + instance].get();
+}
+
+
+void ComputeKernelPermutations::LogStats()
+{
+	const uint32_t declaredCount = s_declaredCount;
+	if (declaredCount == 0)
+	{
+		return;
+	}
+
+	LOG_INFO << "Compute kernel permutations: " << s_createdCount.load() << " of " << declaredCount << " created on demand in "
+		<< (s_createMicroseconds.load() / 1000.0) << " ms";
+}
\ No newline at end of file
@@ -0,0 +1,53 @@
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+// Author: David Elder
+//
+
+#pragma once
+
+#include "ComputeKernel.h"
+#include "ShaderPermutation.h"
+
+namespace Kodiak
+{
+
+// The compute kernels for every permutation of a shader, created the first time each one is requested.  Each
+// permutation can have several instances, with their own constants and resource bindings, so it can be dispatched
+// more than once per frame.  Instances of a permutation share the loaded shader and its reflection, and the root
+// signature and PSO caches hand them the same D3D objects.
+//
+// Kernels are requested on the main thread, for the settings about to be used, since creating one loads its shader
+// and compiles its PSO.  The render thread only looks them up.
+class ComputeKernelPermutations
+{
+public:
+	// Returns the .cso path for a permutation key
+	typedef std::function<std::string(uint32_t key)> PathFunction;
+
+	ComputeKernelPermutations(const std::string& name, uint32_t numPermutations, uint32_t numInstances, PathFunction getPath);
+
+	// Creates the kernel for key and instance if it doesn't exist yet, loading its shader immediately.  Main thread.
+	void Request(uint32_t key, uint32_t instance = 0);
+
+	// Returns the kernel for key and instance, or null if it hasn't been requested.  Never loads anything.
+	ComputeKernel* Find(uint32_t key, uint32_t instance = 0);
+
+	// Logs how many kernels were created and how long they took, against creating every permutation up front
+	static void LogStats();
+
+private:
+	const std::string		m_name;
+	const uint32_t			m_numPermutations;
+	const uint32_t			m_numInstances;
+	const PathFunction		m_getPath;
+
+	// Indexed by key * m_numInstances + instance, null until requested
+	std::mutex									m_kernelLock;
+	std::vector<std::unique_ptr<ComputeKernel>>	m_kernels;
+};
+
+} // namespace Kodiak
\ No newline at end of file
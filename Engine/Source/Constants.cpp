@@ -7,7 +7,7 @@
 // Author: David Elder
 //
 
-#include "Stdafx.h"
+// Built without the precompiled header, so that tools can share it
 
 #include "Constants.h"
 
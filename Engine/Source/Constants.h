@@ -9,4 +9,6 @@
 
 #pragma once
 
+#include <cstdint>
+
 extern const uint32_t kInvalid;
@@ -0,0 +1,237 @@
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+// Author: David Elder
+//
+
+#pragma once
+
+// Cooked model format (.kmdl), written offline by the ModelCooker tool.  Every table is stored the
+// way the runtime loader consumes it, and every reference is a byte offset from the start of the
+// file, so a mapped file is used in place with no parsing or pointer fix-ups.
+//
+// Shared with the cooker, so this header only depends on the standard library.
+
+#include "Meshlet.h"
+#include "VertexQuantization.h"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace Kodiak
+{
+
+namespace CookedModel
+{
+
+const uint32_t kMagic = 0x4C444D4Bu;	// "KMDL"
+const uint32_t kVersion = 2;
+const uint32_t kSectionAlignment = 16;
+
+// Header flags
+const uint32_t kFlagQuantizedVertices = 1 << 0;	// Vertices are QuantizedVertex
+
+
+// A range of the file, relative to its start
+struct Section
+{
+	uint32_t offset;
+	uint32_t size;
+};
+
+
+struct Header
+{
+	uint32_t	magic;
+	uint32_t	version;
+	uint32_t	fileSize;
+	uint32_t	meshCount;
+	uint32_t	materialCount;
+	uint32_t	vertexStride;
+	uint32_t	indexSize;		// Bytes per index
+	uint32_t	flags;
+
+	float		boundsMin[4];
+	float		boundsMax[4];
+
+	Section		meshes;			// Mesh[meshCount]
+	Section		materials;		// Material[materialCount]
+	Section		strings;		// NUL-terminated strings, referenced by offset
+	Section		vertexData;
+	Section		indexData;
+	Section		meshlets;		// Meshlet[], a run per mesh
+};
+
+
+// One draw's worth of geometry, ready to hand to DrawIndexed.  With quantized vertices, the bounds
+// are also the ones the positions were quantized to.  The mesh's meshlets, if it has any, cover its
+// index range, in the unquantized object space.
+struct Mesh
+{
+	float		boundsMin[4];
+	float		boundsMax[4];
+	uint32_t	materialIndex;
+	uint32_t	indexCount;
+	uint32_t	startIndex;
+	int32_t		baseVertex;
+	uint32_t	firstMeshlet;
+	uint32_t	meshletCount;
+};
+
+
+enum TextureSlot
+{
+	kDiffuse,
+	kSpecular,
+	kSpecularFallback,
+	kNormal,
+	kNormalFallback,
+
+	kNumTextureSlots
+};
+
+
+// Texture paths are resolved by the cooker; the runtime only checks which of them exist
+struct Material
+{
+	uint32_t	name;							// String offset
+	uint32_t	texturePaths[kNumTextureSlots];	// String offsets
+	uint32_t	padding[2];
+};
+
+
+static_assert(sizeof(Header) == 112, "CookedModel::Header layout changed");
+static_assert(sizeof(Mesh) == 56, "CookedModel::Mesh layout changed");
+static_assert(sizeof(Meshlet) == 56, "Meshlet layout changed, bump kVersion");
+static_assert(sizeof(Material) == 32, "CookedModel::Material layout changed");
+
+
+template <typename T>
+inline const T* GetTable(const uint8_t* fileData, const Section& section)
+{
+	return reinterpret_cast<const T*>(fileData + section.offset);
+}
+
+
+inline const char* GetString(const uint8_t* fileData, uint32_t offset)
+{
+	return reinterpret_cast<const char*>(fileData + offset);
+}
+
+
+namespace Detail
+{
+
+inline bool IsSectionValid(const Section& section, size_t fileSize)
+{
+	return (section.offset % kSectionAlignment) == 0 &&
+		static_cast<uint64_t>(section.offset) + section.size <= fileSize;
+}
+
+inline bool IsStringValid(const Header& header, uint32_t offset)
+{
+	return offset >= header.strings.offset && offset < header.strings.offset + header.strings.size;
+}
+
+} // namespace Detail
+
+
+// Checks that the header is current and that every table, string and mesh range lies within the
+// file, so nothing read through GetTable or GetString can go out of bounds
+inline bool Validate(const uint8_t* fileData, size_t fileSize)
+{
+	using namespace Detail;
+
+	if (!fileData || fileSize < sizeof(Header))
+	{
+		return false;
+	}
+
+	const auto& header = *reinterpret_cast<const Header*>(fileData);
+	if (header.magic != kMagic || header.version != kVersion || header.fileSize != fileSize)
+	{
+		return false;
+	}
+
+	if (!IsSectionValid(header.meshes, fileSize) || !IsSectionValid(header.materials, fileSize) ||
+		!IsSectionValid(header.strings, fileSize) || !IsSectionValid(header.vertexData, fileSize) ||
+		!IsSectionValid(header.indexData, fileSize) || !IsSectionValid(header.meshlets, fileSize))
+	{
+		return false;
+	}
+
+	if (header.meshes.size != header.meshCount * sizeof(Mesh) ||
+		header.materials.size != header.materialCount * sizeof(Material) ||
+		header.vertexStride == 0 || (header.vertexData.size % header.vertexStride) != 0 ||
+		header.indexSize != sizeof(uint16_t) || (header.indexData.size % header.indexSize) != 0 ||
+		(header.meshlets.size % sizeof(Meshlet)) != 0)
+	{
+		return false;
+	}
+
+	if ((header.flags & ~kFlagQuantizedVertices) != 0 ||
+		((header.flags & kFlagQuantizedVertices) && header.vertexStride != sizeof(QuantizedVertex)))
+	{
+		return false;
+	}
+
+	// The string table ends in a terminator, so every string in it does
+	if (header.strings.size == 0 || fileData[header.strings.offset + header.strings.size - 1] != 0)
+	{
+		return false;
+	}
+
+	const auto* materials = GetTable<Material>(fileData, header.materials);
+	for (uint32_t i = 0; i < header.materialCount; ++i)
+	{
+		if (!IsStringValid(header, materials[i].name))
+		{
+			return false;
+		}
+		for (uint32_t slot = 0; slot < kNumTextureSlots; ++slot)
+		{
+			if (!IsStringValid(header, materials[i].texturePaths[slot]))
+			{
+				return false;
+			}
+		}
+	}
+
+	const uint64_t numIndices = header.indexData.size / header.indexSize;
+	const int64_t numVertices = header.vertexData.size / header.vertexStride;
+
+	const uint64_t numMeshlets = header.meshlets.size / sizeof(Meshlet);
+
+	const auto* meshes = GetTable<Mesh>(fileData, header.meshes);
+	const auto* meshlets = GetTable<Meshlet>(fileData, header.meshlets);
+	for (uint32_t i = 0; i < header.meshCount; ++i)
+	{
+		const auto& mesh = meshes[i];
+		if (mesh.materialIndex >= header.materialCount ||
+			static_cast<uint64_t>(mesh.startIndex) + mesh.indexCount > numIndices ||
+			mesh.baseVertex < 0 || mesh.baseVertex > numVertices ||
+			static_cast<uint64_t>(mesh.firstMeshlet) + mesh.meshletCount > numMeshlets)
+		{
+			return false;
+		}
+
+		// Culling hands out index ranges from the meshlets, so they have to stay within the mesh
+		for (uint32_t j = 0; j < mesh.meshletCount; ++j)
+		{
+			const auto& meshlet = meshlets[mesh.firstMeshlet + j];
+			if (static_cast<uint64_t>(meshlet.startIndex) + 3ull * meshlet.triangleCount > mesh.indexCount)
+			{
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+} // namespace CookedModel
+
+} // namespace Kodiak
\ No newline at end of file
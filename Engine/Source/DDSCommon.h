@@ -12,12 +12,13 @@
 
 #include "dds.h"
 #include "DXGIUtility.h"
+#include "TextureStreaming.h"
 #include "Utility.h"
 
 namespace DDS
 {
 
-HRESULT LoadTextureDataFromFile(const std::wstring& filename, std::unique_ptr<uint8_t[]>& ddsData, DirectX::DDS_HEADER** header, uint8_t** bitData, 
+inline HRESULT LoadTextureDataFromFile(const std::wstring& filename, std::unique_ptr<uint8_t[]>& ddsData, DirectX::DDS_HEADER** header, uint8_t** bitData, 
 	size_t* bitSize)
 {
 	using namespace Kodiak;
@@ -140,7 +141,7 @@ HRESULT LoadTextureDataFromFile(const std::wstring& filename, std::unique_ptr<ui
 //--------------------------------------------------------------------------------------
 // Get surface information for a particular format
 //--------------------------------------------------------------------------------------
-void GetSurfaceInfo(size_t width, size_t height, DXGI_FORMAT fmt, size_t* outNumBytes, size_t* outRowBytes, size_t* outNumRows)
+inline void GetSurfaceInfo(size_t width, size_t height, DXGI_FORMAT fmt, size_t* outNumBytes, size_t* outRowBytes, size_t* outNumRows)
 {
 	size_t numBytes = 0;
 	size_t rowBytes = 0;
@@ -268,7 +269,7 @@ void GetSurfaceInfo(size_t width, size_t height, DXGI_FORMAT fmt, size_t* outNum
 //--------------------------------------------------------------------------------------
 #define ISBITMASK( r,g,b,a ) ( ddpf.RBitMask == r && ddpf.GBitMask == g && ddpf.BBitMask == b && ddpf.ABitMask == a )
 
-DXGI_FORMAT GetDXGIFormat(const DirectX::DDS_PIXELFORMAT& ddpf)
+inline DXGI_FORMAT GetDXGIFormat(const DirectX::DDS_PIXELFORMAT& ddpf)
 {
 	if (ddpf.flags & DDS_RGB)
 	{
@@ -480,7 +481,7 @@ DXGI_FORMAT GetDXGIFormat(const DirectX::DDS_PIXELFORMAT& ddpf)
 
 
 //--------------------------------------------------------------------------------------
-DXGI_FORMAT MakeSRGB(DXGI_FORMAT format)
+inline DXGI_FORMAT MakeSRGB(DXGI_FORMAT format)
 {
 	switch (format)
 	{
@@ -510,4 +511,25 @@ DXGI_FORMAT MakeSRGB(DXGI_FORMAT format)
 	}
 }
 
+
+//--------------------------------------------------------------------------------------
+// The error the DDS loaders return for a ParseDDSHeader or ParseDDSLayout result
+inline HRESULT GetParseResultHRESULT(Kodiak::DDSParseResult result)
+{
+	switch (result)
+	{
+	case Kodiak::DDSParseResult::Success:
+		return S_OK;
+
+	case Kodiak::DDSParseResult::NotSupported:
+		return HRESULT_FROM_WIN32(ERROR_NOT_SUPPORTED);
+
+	case Kodiak::DDSParseResult::Truncated:
+		return HRESULT_FROM_WIN32(ERROR_HANDLE_EOF);
+
+	default:
+		return HRESULT_FROM_WIN32(ERROR_INVALID_DATA);
+	}
+}
+
 } // namespace DDS
\ No newline at end of file
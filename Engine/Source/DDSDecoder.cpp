@@ -0,0 +1,131 @@
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+// Author: David Elder
+//
+
+#include "Stdafx.h"
+
+#include "DDSDecoder.h"
+
+#include "DDSCommon.h"
+#include "TextureStreaming.h"
+
+
+using namespace Kodiak;
+using namespace DirectX;
+using namespace std;
+
+
+namespace
+{
+
+// Block rows handed to each task.  A 4096 wide BC7 surface is 16KB of blocks per row.
+const uint32_t s_blockRowsPerTask = 8;
+
+const char* s_bcFormatNames[] = { "BC1", "BC2", "BC3", "BC4", "BC5", "BC7" };
+
+} // anonymous namespace
+
+
+namespace Kodiak
+{
+
+bool GetBCFormat(DXGI_FORMAT format, BCFormat& bcFormat)
+{
+	switch (format)
+	{
+	case DXGI_FORMAT_BC1_TYPELESS:
+	case DXGI_FORMAT_BC1_UNORM:
+	case DXGI_FORMAT_BC1_UNORM_SRGB:
+		bcFormat = BCFormat::BC1;
+		return true;
+
+	case DXGI_FORMAT_BC2_TYPELESS:
+	case DXGI_FORMAT_BC2_UNORM:
+	case DXGI_FORMAT_BC2_UNORM_SRGB:
+		bcFormat = BCFormat::BC2;
+		return true;
+
+	case DXGI_FORMAT_BC3_TYPELESS:
+	case DXGI_FORMAT_BC3_UNORM:
+	case DXGI_FORMAT_BC3_UNORM_SRGB:
+		bcFormat = BCFormat::BC3;
+		return true;
+
+	case DXGI_FORMAT_BC4_TYPELESS:
+	case DXGI_FORMAT_BC4_UNORM:
+		bcFormat = BCFormat::BC4;
+		return true;
+
+	case DXGI_FORMAT_BC5_TYPELESS:
+	case DXGI_FORMAT_BC5_UNORM:
+		bcFormat = BCFormat::BC5;
+		return true;
+
+	case DXGI_FORMAT_BC7_TYPELESS:
+	case DXGI_FORMAT_BC7_UNORM:
+	case DXGI_FORMAT_BC7_UNORM_SRGB:
+		bcFormat = BCFormat::BC7;
+		return true;
+
+	default:
+		return false;
+	}
+}
+
+
+HRESULT DecodeDDSSubresource(const uint8_t* ddsData, size_t ddsDataSize, uint32_t arraySlice, uint32_t mip,
+	uint32_t& width, uint32_t& height, vector<uint8_t>& pixels)
+{
+	DDSLayout layout;
+	HRESULT hr = DDS::GetParseResultHRESULT(ParseDDSLayout(ddsData, ddsDataSize, layout));
+	if (FAILED(hr))
+	{
+		return hr;
+	}
+
+	BCFormat bcFormat;
+	if (!GetBCFormat(static_cast<DXGI_FORMAT>(layout.format), bcFormat) || layout.dimension == DDS_DIMENSION_TEXTURE3D)
+	{
+		return HRESULT_FROM_WIN32(ERROR_NOT_SUPPORTED);
+	}
+
+	// Cube maps count each face as an array slice
+	if (arraySlice >= layout.arraySize || mip >= layout.mipCount)
+	{
+		return E_INVALIDARG;
+	}
+
+	const auto& subresource = layout.GetSubresource(arraySlice, mip);
+	width = subresource.width;
+	height = subresource.height;
+
+	const auto startTime = chrono::high_resolution_clock::now();
+
+	pixels.resize(4 * static_cast<size_t>(width) * height);
+
+	const uint8_t* blocks = ddsData + subresource.dataOffset;
+	const size_t destPitch = 4 * static_cast<size_t>(width);
+	const uint32_t blockRows = (height + 3) / 4;
+	const uint32_t taskCount = (blockRows + s_blockRowsPerTask - 1) / s_blockRowsPerTask;
+
+	concurrency::parallel_for(uint32_t(0), taskCount, [&](uint32_t task)
+	{
+		DecodeBCBlockRows(bcFormat, blocks, subresource.rowBytes, width, height, task * s_blockRowsPerTask, s_blockRowsPerTask,
+			pixels.data(), destPitch);
+	});
+
+	const chrono::duration<double, milli> elapsed = chrono::high_resolution_clock::now() - startTime;
+	const double megapixels = static_cast<double>(width) * height / 1000000.0;
+	LOG_INFO << "Decoded " << width << "x" << height << " " << s_bcFormatNames[static_cast<uint32_t>(bcFormat)]
+		<< " in " << elapsed.count() << " ms (" << (elapsed.count() > 0.0 ? 1000.0 * megapixels / elapsed.count() : 0.0) << " megapixels/sec"
+		<< (IsBCDecoderVectorized() ? ", SSSE3)" : ")");
+
+	return S_OK;
+}
+
+} // namespace Kodiak
\ No newline at end of file
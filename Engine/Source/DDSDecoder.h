@@ -0,0 +1,29 @@
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+// Author: David Elder
+//
+
+#pragma once
+
+// Decodes block-compressed DDS subresources to RGBA8 on the CPU, for tools, CPU-side processing and
+// validating the GPU's decode.
+
+#include "BCDecoder.h"
+
+namespace Kodiak
+{
+
+// Maps a DXGI format to the block format the CPU decoder handles.  sRGB variants decode to the stored
+// (still sRGB-encoded) values; signed BC4/BC5 and BC6H are not handled.
+bool GetBCFormat(DXGI_FORMAT format, BCFormat& bcFormat);
+
+// Decodes one mip of one array slice of an in-memory DDS file to tightly packed RGBA8 pixels, splitting
+// the block rows across worker threads.  Volume textures are not handled.
+HRESULT DecodeDDSSubresource(const uint8_t* ddsData, size_t ddsDataSize, uint32_t arraySlice, uint32_t mip,
+	uint32_t& width, uint32_t& height, std::vector<uint8_t>& pixels);
+
+} // namespace Kodiak
\ No newline at end of file
@@ -0,0 +1,160 @@
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+// Author: David Elder
+//
+
+#include "Stdafx.h"
+
+#include "DDSMipGenerator.h"
+
+#include "DDSCommon.h"
+#include "TextureStreaming.h"
+
+
+using namespace Kodiak;
+using namespace DirectX;
+using namespace std;
+
+
+namespace
+{
+
+// Destination rows handed to each task
+const uint32_t s_rowsPerTask = 16;
+
+const char* s_mipFormatNames[] = { "RGBA8", "RGBA8 sRGB", "RGBA16F" };
+
+} // anonymous namespace
+
+
+namespace Kodiak
+{
+
+bool GetMipFormat(DXGI_FORMAT format, bool forceSRGB, MipFormat& mipFormat)
+{
+	if (forceSRGB)
+	{
+		format = DDS::MakeSRGB(format);
+	}
+
+	switch (format)
+	{
+	case DXGI_FORMAT_R8G8B8A8_UNORM:
+	case DXGI_FORMAT_B8G8R8A8_UNORM:
+		mipFormat = MipFormat::RGBA8;
+		return true;
+
+	case DXGI_FORMAT_R8G8B8A8_UNORM_SRGB:
+	case DXGI_FORMAT_B8G8R8A8_UNORM_SRGB:
+		mipFormat = MipFormat::RGBA8_sRGB;
+		return true;
+
+	case DXGI_FORMAT_R16G16B16A16_FLOAT:
+		mipFormat = MipFormat::RGBA16F;
+		return true;
+
+	default:
+		return false;
+	}
+}
+
+
+HRESULT GenerateDDSMipChain(const uint8_t* ddsData, size_t ddsDataSize, bool forceSRGB, MipFilter filter,
+	unique_ptr<uint8_t[]>& mippedData, size_t& mippedDataSize)
+{
+	DDSLayout layout;
+	HRESULT hr = DDS::GetParseResultHRESULT(ParseDDSLayout(ddsData, ddsDataSize, layout));
+	if (FAILED(hr))
+	{
+		return hr;
+	}
+
+	MipFormat mipFormat;
+	if (layout.mipCount != 1 || layout.dimension != DDS_DIMENSION_TEXTURE2D || !GetMipFormat(static_cast<DXGI_FORMAT>(layout.format), forceSRGB, mipFormat))
+	{
+		return HRESULT_FROM_WIN32(ERROR_NOT_SUPPORTED);
+	}
+
+	const auto startTime = chrono::high_resolution_clock::now();
+
+	const size_t pixelBytes = GetMipFormatPixelBytes(mipFormat);
+	const uint32_t mipCount = GetFullMipCount(layout.width, layout.height);
+
+	// Every slice gets the same chain, so its size and the offset of each level only need computing once
+	vector<size_t> mipOffsets(mipCount);
+	size_t chainBytes = 0;
+	for (uint32_t mip = 0; mip < mipCount; ++mip)
+	{
+		mipOffsets[mip] = chainBytes;
+		const size_t width = max<uint32_t>(1, layout.width >> mip);
+		const size_t height = max<uint32_t>(1, layout.height >> mip);
+		chainBytes += width * height * pixelBytes;
+	}
+
+	// Headers, including the DX10 extension if there is one, come before the first subresource
+	const size_t headerBytes = layout.subresources[0].dataOffset;
+	mippedDataSize = headerBytes + chainBytes * layout.arraySize;
+	mippedData.reset(new uint8_t[mippedDataSize]);
+
+	memcpy(mippedData.get(), ddsData, headerBytes);
+	auto header = reinterpret_cast<DDS_HEADER*>(mippedData.get() + sizeof(uint32_t));
+	header->mipMapCount = mipCount;
+	header->flags |= DDS_HEADER_FLAGS_MIPMAP;
+	header->caps |= DDS_SURFACE_FLAGS_MIPMAP;
+
+	for (uint32_t slice = 0; slice < layout.arraySize; ++slice)
+	{
+		uint8_t* chain = mippedData.get() + headerBytes + slice * chainBytes;
+
+		const auto& topLevel = layout.GetSubresource(slice, 0);
+		memcpy(chain, ddsData + topLevel.dataOffset, topLevel.sliceBytes);
+
+		for (uint32_t mip = 1; mip < mipCount; ++mip)
+		{
+			const uint32_t srcWidth = max<uint32_t>(1, layout.width >> (mip - 1));
+			const uint32_t srcHeight = max<uint32_t>(1, layout.height >> (mip - 1));
+			const uint32_t destWidth = max<uint32_t>(1, srcWidth / 2);
+			const uint32_t destHeight = max<uint32_t>(1, srcHeight / 2);
+
+			const uint8_t* src = chain + mipOffsets[mip - 1];
+			uint8_t* dest = chain + mipOffsets[mip];
+			const uint32_t taskCount = (destHeight + s_rowsPerTask - 1) / s_rowsPerTask;
+
+			concurrency::parallel_for(uint32_t(0), taskCount, [&](uint32_t task)
+			{
+				GenerateMipRows(mipFormat, filter, src, srcWidth, srcHeight, srcWidth * pixelBytes, dest, destWidth * pixelBytes,
+					task * s_rowsPerTask, s_rowsPerTask);
+			});
+		}
+	}
+
+	const chrono::duration<double, milli> elapsed = chrono::high_resolution_clock::now() - startTime;
+	const double megapixels = static_cast<double>(layout.width) * layout.height * layout.arraySize / 1000000.0;
+	LOG_INFO << "Generated " << (mipCount - 1) << " mips for " << layout.width << "x" << layout.height << " "
+		<< s_mipFormatNames[static_cast<uint32_t>(mipFormat)] << " (" << layout.arraySize << " slices) with a "
+		<< (filter == MipFilter::Box ? "box" : "Kaiser") << " filter in " << elapsed.count() << " ms ("
+		<< (megapixels > 0.0 ? elapsed.count() / megapixels : 0.0) << " ms per megapixel)";
+
+	return S_OK;
+}
+
+
+bool GenerateMissingDDSMips(unique_ptr<uint8_t[]>& ddsData, size_t& ddsDataSize, bool forceSRGB)
+{
+	unique_ptr<uint8_t[]> mippedData;
+	size_t mippedDataSize = 0;
+	if (FAILED(GenerateDDSMipChain(ddsData.get(), ddsDataSize, forceSRGB, MipFilter::Kaiser, mippedData, mippedDataSize)))
+	{
+		return false;
+	}
+
+	ddsData = move(mippedData);
+	ddsDataSize = mippedDataSize;
+	return true;
+}
+
+} // namespace Kodiak
\ No newline at end of file
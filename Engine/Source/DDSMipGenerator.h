@@ -0,0 +1,33 @@
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+// Author: David Elder
+//
+
+#pragma once
+
+// Builds the missing mip chain of DDS files that ship with a single level, so they aren't sampled at
+// full resolution in the distance.
+
+#include "MipGenerator.h"
+
+namespace Kodiak
+{
+
+// Maps a DXGI format to the generator's format.  R8G8B8A8 and B8G8R8A8 (UNORM and sRGB) and
+// R16G16B16A16_FLOAT are handled.  forceSRGB matches the loaders, treating UNORM data as sRGB.
+bool GetMipFormat(DXGI_FORMAT format, bool forceSRGB, MipFormat& mipFormat);
+
+// Writes a copy of a single-mip 2D (or cube) DDS file with every array slice's full mip chain.  The
+// headers are kept, other than the mip count.  Each level's rows are split across worker threads.
+HRESULT GenerateDDSMipChain(const uint8_t* ddsData, size_t ddsDataSize, bool forceSRGB, MipFilter filter,
+	std::unique_ptr<uint8_t[]>& mippedData, size_t& mippedDataSize);
+
+// Used by the texture loaders.  If the file has a single mip in a format GenerateDDSMipChain handles,
+// replaces ddsData with the full chain and returns true.
+bool GenerateMissingDDSMips(std::unique_ptr<uint8_t[]>& ddsData, size_t& ddsDataSize, bool forceSRGB);
+
+} // namespace Kodiak
\ No newline at end of file
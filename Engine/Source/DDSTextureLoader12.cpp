@@ -14,6 +14,7 @@
 
 #include "CommandList12.h"
 #include "DDSCommon.h"
+#include "TextureStreaming.h"
 #include "Utility.h"
 
 #include <locale>
@@ -700,4 +701,62 @@ HRESULT CreateDDSTextureFromFile(
 	return hr;
 }
 
+
+HRESULT CreateDDSTextureFromLayout(
+	ID3D12Device* d3dDevice,
+	const uint8_t* ddsData,
+	const DDSLayout& layout,
+	uint32_t firstMip,
+	bool forceSRGB,
+	ID3D12Resource** texture,
+	D3D12_CPU_DESCRIPTOR_HANDLE textureView)
+{
+	if (texture)
+	{
+		*texture = nullptr;
+	}
+
+	if (!d3dDevice || !ddsData || !texture || firstMip >= layout.mipCount)
+	{
+		return E_INVALIDARG;
+	}
+
+	const uint32_t mipCount = layout.mipCount - firstMip;
+	const UINT subresourceCount = mipCount * layout.arraySize;
+
+	std::unique_ptr<D3D12_SUBRESOURCE_DATA[]> initData(new (std::nothrow) D3D12_SUBRESOURCE_DATA[subresourceCount]);
+	if (!initData)
+	{
+		return E_OUTOFMEMORY;
+	}
+
+	UINT index = 0;
+	for (uint32_t slice = 0; slice < layout.arraySize; ++slice)
+	{
+		for (uint32_t mip = firstMip; mip < layout.mipCount; ++mip)
+		{
+			const auto& subresource = layout.GetSubresource(slice, mip);
+			initData[index].pData = ddsData + subresource.dataOffset;
+			initData[index].RowPitch = static_cast<LONG_PTR>(subresource.rowBytes);
+			initData[index].SlicePitch = static_cast<LONG_PTR>(subresource.sliceBytes);
+			++index;
+		}
+	}
+
+	const auto& topMip = layout.GetSubresource(0, firstMip);
+
+	HRESULT hr = CreateD3DResources(d3dDevice, layout.dimension, topMip.width, topMip.height, topMip.depth,
+		mipCount, layout.arraySize, static_cast<DXGI_FORMAT>(layout.format), forceSRGB, layout.isCubeMap, initData.get(), texture, textureView);
+
+	if (SUCCEEDED(hr))
+	{
+		(*texture)->SetName(L"DDSTextureLoader");
+
+		GpuResource DestTexture(*texture, D3D12_RESOURCE_STATE_COMMON);
+		CommandList::InitializeTexture(DestTexture, subresourceCount, initData.get());
+	}
+
+	return hr;
+}
+
 } // namespace Kodiak
\ No newline at end of file
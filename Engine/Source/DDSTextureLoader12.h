@@ -13,6 +13,10 @@
 namespace Kodiak
 {
 
+// Forward declarations
+struct DDSLayout;
+
+
 enum DDS_ALPHA_MODE
 {
 	DDS_ALPHA_MODE_UNKNOWN = 0,
@@ -42,4 +46,15 @@ HRESULT __cdecl CreateDDSTextureFromFile(ID3D12Device* d3dDevice,
 	DDS_ALPHA_MODE* alphaMode = nullptr);
 
 
+// Creates a texture holding only the mip range [firstMip, mipCount) of a DDS file that has already been
+// parsed with ParseDDSLayout.  Used by the mip streamer to upload the texture in stages.
+HRESULT __cdecl CreateDDSTextureFromLayout(ID3D12Device* d3dDevice,
+	const uint8_t* ddsData,
+	const DDSLayout& layout,
+	uint32_t firstMip,
+	bool forceSRGB,
+	ID3D12Resource** texture,
+	D3D12_CPU_DESCRIPTOR_HANDLE textureView);
+
+
 } // namespace Kodiak
\ No newline at end of file
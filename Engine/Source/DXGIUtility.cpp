@@ -18,10 +18,34 @@ DXGI_FORMAT ConvertToDXGI(Kodiak::ColorFormat format)
 {
 	switch (format)
 	{
+	case Kodiak::ColorFormat::BC1_UNorm:
+		return DXGI_FORMAT_BC1_UNORM;
+	case Kodiak::ColorFormat::BC1_UNorm_sRGB:
+		return DXGI_FORMAT_BC1_UNORM_SRGB;
+	case Kodiak::ColorFormat::BC2_UNorm:
+		return DXGI_FORMAT_BC2_UNORM;
+	case Kodiak::ColorFormat::BC2_UNorm_sRGB:
+		return DXGI_FORMAT_BC2_UNORM_SRGB;
+	case Kodiak::ColorFormat::BC3_UNorm:
+		return DXGI_FORMAT_BC3_UNORM;
 	case Kodiak::ColorFormat::BC3_UNorm_sRGB:
 		return DXGI_FORMAT_BC3_UNORM_SRGB;
+	case Kodiak::ColorFormat::BC4_UNorm:
+		return DXGI_FORMAT_BC4_UNORM;
+	case Kodiak::ColorFormat::BC5_UNorm:
+		return DXGI_FORMAT_BC5_UNORM;
+	case Kodiak::ColorFormat::BC7_UNorm:
+		return DXGI_FORMAT_BC7_UNORM;
+	case Kodiak::ColorFormat::BC7_UNorm_sRGB:
+		return DXGI_FORMAT_BC7_UNORM_SRGB;
 	case Kodiak::ColorFormat::R8G8B8A8:
 		return DXGI_FORMAT_R8G8B8A8_UNORM;
+	case Kodiak::ColorFormat::R8G8B8A8_sRGB:
+		return DXGI_FORMAT_R8G8B8A8_UNORM_SRGB;
+	case Kodiak::ColorFormat::B8G8R8A8_UNorm:
+		return DXGI_FORMAT_B8G8R8A8_UNORM;
+	case Kodiak::ColorFormat::B8G8R8A8_UNorm_sRGB:
+		return DXGI_FORMAT_B8G8R8A8_UNORM_SRGB;
 	case Kodiak::ColorFormat::R8_UNorm:
 		return DXGI_FORMAT_R8_UNORM;
 	case Kodiak::ColorFormat::R8_UInt:
@@ -43,6 +67,58 @@ DXGI_FORMAT ConvertToDXGI(Kodiak::ColorFormat format)
 }
 
 
+Kodiak::ColorFormat ConvertFromDXGI(DXGI_FORMAT format)
+{
+	switch (format)
+	{
+	case DXGI_FORMAT_BC1_UNORM:
+		return Kodiak::ColorFormat::BC1_UNorm;
+	case DXGI_FORMAT_BC1_UNORM_SRGB:
+		return Kodiak::ColorFormat::BC1_UNorm_sRGB;
+	case DXGI_FORMAT_BC2_UNORM:
+		return Kodiak::ColorFormat::BC2_UNorm;
+	case DXGI_FORMAT_BC2_UNORM_SRGB:
+		return Kodiak::ColorFormat::BC2_UNorm_sRGB;
+	case DXGI_FORMAT_BC3_UNORM:
+		return Kodiak::ColorFormat::BC3_UNorm;
+	case DXGI_FORMAT_BC3_UNORM_SRGB:
+		return Kodiak::ColorFormat::BC3_UNorm_sRGB;
+	case DXGI_FORMAT_BC4_UNORM:
+		return Kodiak::ColorFormat::BC4_UNorm;
+	case DXGI_FORMAT_BC5_UNORM:
+		return Kodiak::ColorFormat::BC5_UNorm;
+	case DXGI_FORMAT_BC7_UNORM:
+		return Kodiak::ColorFormat::BC7_UNorm;
+	case DXGI_FORMAT_BC7_UNORM_SRGB:
+		return Kodiak::ColorFormat::BC7_UNorm_sRGB;
+	case DXGI_FORMAT_R8G8B8A8_UNORM:
+		return Kodiak::ColorFormat::R8G8B8A8;
+	case DXGI_FORMAT_R8G8B8A8_UNORM_SRGB:
+		return Kodiak::ColorFormat::R8G8B8A8_sRGB;
+	case DXGI_FORMAT_B8G8R8A8_UNORM:
+		return Kodiak::ColorFormat::B8G8R8A8_UNorm;
+	case DXGI_FORMAT_B8G8R8A8_UNORM_SRGB:
+		return Kodiak::ColorFormat::B8G8R8A8_UNorm_sRGB;
+	case DXGI_FORMAT_R8_UNORM:
+		return Kodiak::ColorFormat::R8_UNorm;
+	case DXGI_FORMAT_R8_UINT:
+		return Kodiak::ColorFormat::R8_UInt;
+	case DXGI_FORMAT_R10G10B10A2_UNORM:
+		return Kodiak::ColorFormat::R10G10B10A2_UNorm;
+	case DXGI_FORMAT_R11G11B10_FLOAT:
+		return Kodiak::ColorFormat::R11G11B10_Float;
+	case DXGI_FORMAT_R16_FLOAT:
+		return Kodiak::ColorFormat::R16_Float;
+	case DXGI_FORMAT_R32_FLOAT:
+		return Kodiak::ColorFormat::R32_Float;
+	case DXGI_FORMAT_R32_UINT:
+		return Kodiak::ColorFormat::R32_UInt;
+	default:
+		return Kodiak::ColorFormat::Unknown;
+	}
+}
+
+
 DXGI_FORMAT ConvertToDXGI(Kodiak::DepthFormat format)
 {
 	switch (format)
@@ -17,6 +17,9 @@ namespace DXGIUtility
 DXGI_FORMAT ConvertToDXGI(Kodiak::ColorFormat format);
 DXGI_FORMAT ConvertToDXGI(Kodiak::DepthFormat format);
 
+// Returns ColorFormat::Unknown for formats without a ColorFormat
+Kodiak::ColorFormat ConvertFromDXGI(DXGI_FORMAT format);
+
 DXGI_FORMAT GetBaseFormat(DXGI_FORMAT defaultFormat);
 DXGI_FORMAT GetUAVFormat(DXGI_FORMAT defaultFormat);
 DXGI_FORMAT GetDSVFormat(DXGI_FORMAT defaultFormat);
@@ -34,6 +34,42 @@ void SetDefaultBaseEffect(shared_ptr<Effect> effect) { s_defaultBaseEffect = eff
 void SetDefaultDepthEffect(shared_ptr<Effect> effect) { s_defaultDepthEffect = effect; }
 void SetDefaultShadowEffect(shared_ptr<Effect> effect) { s_defaultShadowEffect = effect; }
 
+static shared_ptr<Effect> s_defaultQuantizedBaseEffect;
+static shared_ptr<Effect> s_defaultQuantizedDepthEffect;
+static shared_ptr<Effect> s_defaultQuantizedShadowEffect;
+
+shared_ptr<Effect> GetDefaultQuantizedBaseEffect() { return s_defaultQuantizedBaseEffect; }
+shared_ptr<Effect> GetDefaultQuantizedDepthEffect() { return s_defaultQuantizedDepthEffect; }
+shared_ptr<Effect> GetDefaultQuantizedShadowEffect() { return s_defaultQuantizedShadowEffect; }
+
+void SetDefaultQuantizedBaseEffect(shared_ptr<Effect> effect) { s_defaultQuantizedBaseEffect = effect; }
+void SetDefaultQuantizedDepthEffect(shared_ptr<Effect> effect) { s_defaultQuantizedDepthEffect = effect; }
+void SetDefaultQuantizedShadowEffect(shared_ptr<Effect> effect) { s_defaultQuantizedShadowEffect = effect; }
+
+static shared_ptr<Effect> s_defaultPackedBaseEffect;
+static shared_ptr<Effect> s_defaultPackedDepthEffect;
+static shared_ptr<Effect> s_defaultPackedShadowEffect;
+
+shared_ptr<Effect> GetDefaultPackedBaseEffect() { return s_defaultPackedBaseEffect; }
+shared_ptr<Effect> GetDefaultPackedDepthEffect() { return s_defaultPackedDepthEffect; }
+shared_ptr<Effect> GetDefaultPackedShadowEffect() { return s_defaultPackedShadowEffect; }
+
+void SetDefaultPackedBaseEffect(shared_ptr<Effect> effect) { s_defaultPackedBaseEffect = effect; }
+void SetDefaultPackedDepthEffect(shared_ptr<Effect> effect) { s_defaultPackedDepthEffect = effect; }
+void SetDefaultPackedShadowEffect(shared_ptr<Effect> effect) { s_defaultPackedShadowEffect = effect; }
+
+static shared_ptr<Effect> s_defaultQuantizedPackedBaseEffect;
+static shared_ptr<Effect> s_defaultQuantizedPackedDepthEffect;
+static shared_ptr<Effect> s_defaultQuantizedPackedShadowEffect;
+
+shared_ptr<Effect> GetDefaultQuantizedPackedBaseEffect() { return s_defaultQuantizedPackedBaseEffect; }
+shared_ptr<Effect> GetDefaultQuantizedPackedDepthEffect() { return s_defaultQuantizedPackedDepthEffect; }
+shared_ptr<Effect> GetDefaultQuantizedPackedShadowEffect() { return s_defaultQuantizedPackedShadowEffect; }
+
+void SetDefaultQuantizedPackedBaseEffect(shared_ptr<Effect> effect) { s_defaultQuantizedPackedBaseEffect = effect; }
+void SetDefaultQuantizedPackedDepthEffect(shared_ptr<Effect> effect) { s_defaultQuantizedPackedDepthEffect = effect; }
+void SetDefaultQuantizedPackedShadowEffect(shared_ptr<Effect> effect) { s_defaultQuantizedPackedShadowEffect = effect; }
+
 
 // Default render passes
 static shared_ptr<RenderPass> s_defaultBasePass;
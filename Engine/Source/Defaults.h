@@ -26,6 +26,32 @@ void SetDefaultBaseEffect(std::shared_ptr<Effect> effect);
 void SetDefaultDepthEffect(std::shared_ptr<Effect> effect);
 void SetDefaultShadowEffect(std::shared_ptr<Effect> effect);
 
+// Variants for models with quantized vertices (see VertexQuantization.h)
+std::shared_ptr<Effect> GetDefaultQuantizedBaseEffect();
+std::shared_ptr<Effect> GetDefaultQuantizedDepthEffect();
+std::shared_ptr<Effect> GetDefaultQuantizedShadowEffect();
+
+void SetDefaultQuantizedBaseEffect(std::shared_ptr<Effect> effect);
+void SetDefaultQuantizedDepthEffect(std::shared_ptr<Effect> effect);
+void SetDefaultQuantizedShadowEffect(std::shared_ptr<Effect> effect);
+
+// Variants that sample texture arrays, for models loaded with packed textures (see TexturePacking.h)
+std::shared_ptr<Effect> GetDefaultPackedBaseEffect();
+std::shared_ptr<Effect> GetDefaultPackedDepthEffect();
+std::shared_ptr<Effect> GetDefaultPackedShadowEffect();
+
+void SetDefaultPackedBaseEffect(std::shared_ptr<Effect> effect);
+void SetDefaultPackedDepthEffect(std::shared_ptr<Effect> effect);
+void SetDefaultPackedShadowEffect(std::shared_ptr<Effect> effect);
+
+std::shared_ptr<Effect> GetDefaultQuantizedPackedBaseEffect();
+std::shared_ptr<Effect> GetDefaultQuantizedPackedDepthEffect();
+std::shared_ptr<Effect> GetDefaultQuantizedPackedShadowEffect();
+
+void SetDefaultQuantizedPackedBaseEffect(std::shared_ptr<Effect> effect);
+void SetDefaultQuantizedPackedDepthEffect(std::shared_ptr<Effect> effect);
+void SetDefaultQuantizedPackedShadowEffect(std::shared_ptr<Effect> effect);
+
 
 // Default render passes
 std::shared_ptr<RenderPass> GetDefaultBasePass();
@@ -0,0 +1,93 @@
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+// Author: David Elder
+//
+
+// Built without the precompiled header, so that tools can share it
+
+#include "DescriptorIndexAllocator.h"
+
+#include <cassert>
+
+
+using namespace Kodiak;
+using namespace std;
+
+
+DescriptorIndexAllocator::DescriptorIndexAllocator(uint32_t capacity)
+	: m_capacity(capacity)
+{}
+
+
+uint32_t DescriptorIndexAllocator::Acquire(uint64_t key, bool& isNew)
+{
+	auto it = m_slots.find(key);
+	if (it != m_slots.end())
+	{
+		++it->second.refCount;
+		isNew = false;
+		return it->second.index;
+	}
+
+	uint32_t index = kInvalidIndex;
+	if (!m_freeIndices.empty())
+	{
+		index = m_freeIndices.back();
+		m_freeIndices.pop_back();
+	}
+	else if (m_nextUnused < m_capacity)
+	{
+		index = m_nextUnused++;
+	}
+	else
+	{
+		isNew = false;
+		return kInvalidIndex;
+	}
+
+	m_slots.emplace(key, Slot{ index, 1 });
+	isNew = true;
+	return index;
+}
+
+
+void DescriptorIndexAllocator::Release(uint64_t key)
+{
+	auto it = m_slots.find(key);
+	assert(it != m_slots.end());
+	if (it == m_slots.end())
+	{
+		return;
+	}
+
+	if (--it->second.refCount == 0)
+	{
+		m_released.push_back(it->second.index);
+		m_slots.erase(it);
+	}
+}
+
+
+uint32_t DescriptorIndexAllocator::Find(uint64_t key) const
+{
+	auto it = m_slots.find(key);
+	return (it != m_slots.end()) ? it->second.index : kInvalidIndex;
+}
+
+
+void DescriptorIndexAllocator::RetireReleased(uint64_t fenceValue)
+{
+	// Reclaim walks the retired slots in order, so the fence values can't go backwards
+	assert(fenceValue >= m_lastRetireFence);
+	m_lastRetireFence = fenceValue;
+
+	for (auto index : m_released)
+	{
+		m_retired.emplace_back(fenceValue, index);
+	}
+	m_released.clear();
+}
\ No newline at end of file
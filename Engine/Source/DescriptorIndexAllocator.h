@@ -0,0 +1,83 @@
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+// Author: David Elder
+//
+
+#pragma once
+
+// Hands out slots in a fixed-size descriptor heap, one per key.  Keys are reference counted, but the bindless heap
+// acquires each one only once: a slot is never rewritten, so every BindlessDescriptor takes a fresh key, and users
+// of a view share the descriptor itself.  When the last reference is released the slot is queued, since draws
+// already recorded may still read it.  RetireReleased tags the queued slots with a fence value once that work
+// has been submitted, and Reclaim frees them after the GPU passes it.
+//
+// Not thread safe.  This header and DescriptorIndexAllocator.cpp only depend on the standard library.
+
+#include <cstdint>
+#include <deque>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace Kodiak
+{
+
+class DescriptorIndexAllocator
+{
+public:
+	static const uint32_t kInvalidIndex = ~0u;
+
+	explicit DescriptorIndexAllocator(uint32_t capacity);
+
+	// Returns the slot for key, allocating one on its first reference.  isNew is set when the caller has to
+	// fill in the descriptor, which is always the case for keys that are only acquired once.  Returns kInvalidIndex if every slot is taken.
+	uint32_t Acquire(uint64_t key, bool& isNew);
+
+	// Drops a reference taken by Acquire
+	void Release(uint64_t key);
+
+	// Returns the slot for key, or kInvalidIndex if it has no references
+	uint32_t Find(uint64_t key) const;
+
+	// Tags the slots released since the last call with fenceValue.  Call once all the work recorded before
+	// those releases has been submitted, with a fence signaled after it.
+	void RetireReleased(uint64_t fenceValue);
+	bool HasReleased() const { return !m_released.empty(); }
+
+	// Frees the retired slots whose fence has completed
+	template <typename TIsFenceComplete>
+	void Reclaim(TIsFenceComplete isFenceComplete)
+	{
+		while (!m_retired.empty() && isFenceComplete(m_retired.front().first))
+		{
+			m_freeIndices.push_back(m_retired.front().second);
+			m_retired.pop_front();
+		}
+	}
+
+	uint32_t GetCapacity() const { return m_capacity; }
+	uint32_t GetNumUsed() const { return static_cast<uint32_t>(m_slots.size()); }
+	uint32_t GetNumPending() const { return static_cast<uint32_t>(m_released.size() + m_retired.size()); }
+
+private:
+	struct Slot
+	{
+		uint32_t	index;
+		uint32_t	refCount;
+	};
+
+	const uint32_t									m_capacity;
+	uint32_t										m_nextUnused{ 0 };
+
+	std::unordered_map<uint64_t, Slot>				m_slots;
+	std::vector<uint32_t>							m_freeIndices;
+	std::vector<uint32_t>							m_released;
+	std::deque<std::pair<uint64_t, uint32_t>>		m_retired;
+	uint64_t										m_lastRetireFence{ 0 };
+};
+
+} // namespace Kodiak
\ No newline at end of file
@@ -0,0 +1,124 @@
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+// Author: David Elder
+//
+
+#pragma once
+
+// Remembers where descriptor tables were copied in a shader-visible heap, keyed by the CPU handles that were
+// staged for them, so a table that is staged again with the same handles can be rebound instead of re-copied.
+// Only the handles whose bits are set in the assigned bitmap take part, since unassigned slots aren't copied.
+//
+// The offsets are only good for one heap, so the map isn't scoped to a frame.  Each command list's
+// DynamicDescriptorHeap owns one, and clears it whenever it retires the heap the offsets point into: when the
+// command list is finished, and when the heap fills up partway through it.
+//
+// THandle is anything with a ptr member, like D3D12_CPU_DESCRIPTOR_HANDLE.  This header only depends on the
+// standard library.
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace Kodiak
+{
+
+template <typename THandle>
+class DescriptorTableMap
+{
+public:
+	static const uint32_t kNotFound = ~0u;
+
+	// FNV-1a over the assigned bitmap and the assigned handles
+	static uint64_t Hash(const THandle* handles, uint32_t assignedBitMap)
+	{
+		uint64_t hash = 14695981039346656037ULL;
+		hash = HashValue(assignedBitMap, hash);
+
+		for (uint32_t i = 0; i < 32 && (assignedBitMap >> i) != 0; ++i)
+		{
+			if (assignedBitMap & (1u << i))
+			{
+				hash = HashValue(static_cast<uint64_t>(handles[i].ptr), hash);
+			}
+		}
+		return hash;
+	}
+
+	// Returns the heap offset of an earlier copy of the same table, or kNotFound
+	uint32_t Find(uint64_t hash, const THandle* handles, uint32_t assignedBitMap) const
+	{
+		auto it = m_entries.find(hash);
+		if (it == m_entries.end() || !Matches(it->second, handles, assignedBitMap))
+		{
+			return kNotFound;
+		}
+		return it->second.heapOffset;
+	}
+
+	// Replaces any entry with the same hash, so a collision only costs a copy
+	void Insert(uint64_t hash, const THandle* handles, uint32_t assignedBitMap, uint32_t heapOffset)
+	{
+		auto& entry = m_entries[hash];
+		entry.heapOffset = heapOffset;
+		entry.assignedBitMap = assignedBitMap;
+		entry.handles.clear();
+
+		for (uint32_t i = 0; i < 32 && (assignedBitMap >> i) != 0; ++i)
+		{
+			if (assignedBitMap & (1u << i))
+			{
+				entry.handles.push_back(static_cast<uint64_t>(handles[i].ptr));
+			}
+		}
+	}
+
+	// Call when the heap the offsets refer to is retired, before anything is inserted for the next one
+	void Clear() { m_entries.clear(); }
+
+	size_t GetSize() const { return m_entries.size(); }
+
+private:
+	struct Entry
+	{
+		uint32_t				heapOffset{ 0 };
+		uint32_t				assignedBitMap{ 0 };
+		std::vector<uint64_t>	handles;
+	};
+
+	static uint64_t HashValue(uint64_t value, uint64_t hash)
+	{
+		for (uint32_t i = 0; i < 8; ++i)
+		{
+			hash = (hash ^ ((value >> (i * 8)) & 0xFF)) * 1099511628211ULL;
+		}
+		return hash;
+	}
+
+	static bool Matches(const Entry& entry, const THandle* handles, uint32_t assignedBitMap)
+	{
+		if (entry.assignedBitMap != assignedBitMap)
+		{
+			return false;
+		}
+
+		size_t index = 0;
+		for (uint32_t i = 0; i < 32 && (assignedBitMap >> i) != 0; ++i)
+		{
+			if ((assignedBitMap & (1u << i)) && entry.handles[index++] != static_cast<uint64_t>(handles[i].ptr))
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	std::unordered_map<uint64_t, Entry> m_entries;
+};
+
+} // namespace Kodiak
\ No newline at end of file
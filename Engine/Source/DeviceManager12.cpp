@@ -11,14 +11,18 @@
 
 #include "DeviceManager12.h"
 
+#include "BindlessDescriptorHeap12.h"
 #include "CommandList12.h"
 #include "CommandListManager12.h"
 #include "CommandSignature12.h"
 #include "DXGIUtility.h"
+#include "DynamicDescriptorHeap12.h"
 #include "Format.h"
+#include "PSOCache.h"
 #include "Renderer.h"
 #include "RenderEnums12.h"
 #include "RenderUtils.h"
+#include "RootSignature12.h"
 #include "Shader.h"
 
 
@@ -28,6 +32,8 @@ using namespace std;
 
 
 static uint32_t g_currentFrame = 0;
+static uint64_t g_presentCount = 0;
+static const uint32_t kNumBindlessDescriptors = 4096;
 
 namespace Kodiak
 {
@@ -79,6 +85,13 @@ void DeviceManager::Finalize()
 {
 	// Wait until all previous GPU work is complete.
 	CommandListManager::GetInstance().IdleGpu();
+
+	PSO::WaitForPendingCompiles();
+	PSO::SavePersistentCache();
+	PSO::LogCompileStats();
+	RootSignature::LogStats(g_presentCount);
+	DynamicDescriptorHeap::LogStats(g_presentCount);
+	BindlessDescriptorHeap::GetInstance().LogStats();
 }
 
 
@@ -96,12 +109,16 @@ void DeviceManager::Present(shared_ptr<ColorBuffer> presentSource, bool bHDRPres
 	}
 
 	commandList.CloseAndExecute();
+
+	// Everything recorded this frame is submitted, so bindless slots released during it can be queued for reuse
+	BindlessDescriptorHeap::GetInstance().RetireReleased();
 	
 	// TODO: better vsync logic here
 	m_swapChain->Present(1, 0);
 
 	// Switch to the next frame & back buffer
 	g_currentFrame = (g_currentFrame + 1) % SWAP_CHAIN_BUFFER_COUNT;
+	++g_presentCount;
 }
 
 
@@ -217,9 +234,28 @@ void DeviceManager::CreateDeviceResources()
 
 	g_device = m_device.Get();
 
+	// Pipelines compiled on an earlier run are only reused on the same adapter and driver
+	if (bestAdapter)
+	{
+		DXGI_ADAPTER_DESC1 adapterDesc;
+		bestAdapter->GetDesc1(&adapterDesc);
+
+		LARGE_INTEGER driverVersion{};
+		bestAdapter->CheckInterfaceSupport(__uuidof(IDXGIDevice), &driverVersion);
+
+		PSOCacheDeviceId deviceId;
+		deviceId.vendorId = adapterDesc.VendorId;
+		deviceId.deviceId = adapterDesc.DeviceId;
+		deviceId.driverVersion = static_cast<uint64_t>(driverVersion.QuadPart);
+		PSO::LoadPersistentCache(deviceId);
+	}
+
 	// Initialize the command list manager
 	CommandListManager::GetInstance().Create(m_device.Get());
 
+	// Shared by every bindless material for the lifetime of the device
+	BindlessDescriptorHeap::GetInstance().Create(kNumBindlessDescriptors);
+
 	// Initalize graphics state for present
 	CreatePresentState();
 
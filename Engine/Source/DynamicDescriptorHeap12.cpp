@@ -42,6 +42,16 @@ namespace Kodiak
 } // namespace Kodiak
 
 
+namespace
+{
+
+atomic<uint64_t> s_tablesCopied{ 0 };
+atomic<uint64_t> s_tablesReused{ 0 };
+atomic<uint64_t> s_descriptorsSaved{ 0 };
+
+} // anonymous namespace
+
+
 DynamicDescriptorHeap::DynamicDescriptorHeap(CommandList& owner) : m_owningCommandList(owner) {}
 
 
@@ -89,6 +99,20 @@ uint32_t DynamicDescriptorHeap::GetDescriptorSize()
 }
 
 
+void DynamicDescriptorHeap::LogStats(uint64_t frameCount)
+{
+	const uint64_t tablesCopied = s_tablesCopied.load();
+	const uint64_t tablesReused = s_tablesReused.load();
+	if (frameCount == 0 || tablesCopied + tablesReused == 0)
+	{
+		return;
+	}
+
+	LOG_INFO << "Descriptor tables per frame: " << (tablesCopied / frameCount) << " copied, " << (tablesReused / frameCount)
+		<< " rebound from earlier copies (" << (s_descriptorsSaved.load() / frameCount) << " descriptor copies saved)";
+}
+
+
 ID3D12DescriptorHeap* DynamicDescriptorHeap::RequestDescriptorHeap()
 {
 	lock_guard<mutex> LockGuard(s_mutex);
@@ -143,6 +167,7 @@ void DynamicDescriptorHeap::RetireCurrentHeap()
 	m_retiredHeaps.push_back(m_currentHeapPtr);
 	m_currentHeapPtr = nullptr;
 	m_currentOffset = 0;
+	m_tableMap.Clear();
 }
 
 
@@ -196,8 +221,36 @@ uint32_t DynamicDescriptorHeap::DescriptorHandleCache::ComputeStagedSize()
 }
 
 
+void DynamicDescriptorHeap::DescriptorHandleCache::BindCachedTables(const TableMap& tableMap, DescriptorHandle heapStart,
+	ID3D12GraphicsCommandList* cmdList, void (STDMETHODCALLTYPE ID3D12GraphicsCommandList::*SetFunc)(UINT, D3D12_GPU_DESCRIPTOR_HANDLE))
+{
+	const uint32_t kDescriptorSize = DynamicDescriptorHeap::GetDescriptorSize();
+
+	uint32_t rootIndex;
+	uint32_t staleParams = staleRootParamsBitMap;
+	while (_BitScanForward((unsigned long*)&rootIndex, staleParams))
+	{
+		staleParams ^= (1 << rootIndex);
+
+		const DescriptorTableCache& rootDescTable = rootDescriptorTable[rootIndex];
+		const uint32_t assignedHandles = rootDescTable.assignedHandlesBitMap;
+
+		const uint64_t hash = TableMap::Hash(rootDescTable.tableStart, assignedHandles);
+		const uint32_t heapOffset = tableMap.Find(hash, rootDescTable.tableStart, assignedHandles);
+		if (heapOffset != TableMap::kNotFound)
+		{
+			(cmdList->*SetFunc)(rootIndex, (heapStart + heapOffset * kDescriptorSize).GetGpuHandle());
+			staleRootParamsBitMap ^= (1 << rootIndex);
+
+			++s_tablesReused;
+			s_descriptorsSaved += __popcnt(assignedHandles);
+		}
+	}
+}
+
+
 void DynamicDescriptorHeap::DescriptorHandleCache::CopyAndBindStaleTables(
-	DescriptorHandle destHandleStart, ID3D12GraphicsCommandList* cmdList,
+	DescriptorHandle destHandleStart, uint32_t heapOffset, TableMap& tableMap, ID3D12GraphicsCommandList* cmdList,
 	void (STDMETHODCALLTYPE ID3D12GraphicsCommandList::*SetFunc)(UINT, D3D12_GPU_DESCRIPTOR_HANDLE))
 {
 	uint32_t staleParamCount = 0;
@@ -247,6 +300,11 @@ void DynamicDescriptorHeap::DescriptorHandleCache::CopyAndBindStaleTables(
 
 		DescriptorTableCache& rootDescTable = rootDescriptorTable[rootIndex];
 
+		const uint64_t hash = TableMap::Hash(rootDescTable.tableStart, rootDescTable.assignedHandlesBitMap);
+		tableMap.Insert(hash, rootDescTable.tableStart, rootDescTable.assignedHandlesBitMap, heapOffset);
+		heapOffset += tableSize[i];
+		++s_tablesCopied;
+
 		D3D12_CPU_DESCRIPTOR_HANDLE* srcHandles = rootDescTable.tableStart;
 		uint64_t setHandles = (uint64_t)rootDescTable.assignedHandlesBitMap;
 		D3D12_CPU_DESCRIPTOR_HANDLE curDest = destHandleStart.GetCpuHandle();
@@ -370,15 +428,31 @@ void DynamicDescriptorHeap::DescriptorHandleCache::ParseRootSignature(const Root
 void DynamicDescriptorHeap::CopyAndBindStagedTables(DescriptorHandleCache& handleCache, ID3D12GraphicsCommandList* cmdList,
 	void (STDMETHODCALLTYPE ID3D12GraphicsCommandList::*SetFunc)(UINT, D3D12_GPU_DESCRIPTOR_HANDLE))
 {
+	// Tables already copied to the current heap with the same handles only need to be rebound
+	if (m_currentHeapPtr != nullptr)
+	{
+		m_owningCommandList.SetDescriptorHeap(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV, m_currentHeapPtr);
+
+		handleCache.BindCachedTables(m_tableMap, m_firstDescriptor, cmdList, SetFunc);
+		if (handleCache.staleRootParamsBitMap == 0)
+		{
+			return;
+		}
+	}
+
 	uint32_t neededSize = handleCache.ComputeStagedSize();
 	if(!HasSpace(neededSize))
 	{
 		RetireCurrentHeap();
 		UnbindAllValid();
+
+		// Every valid table is stale again, and needs room in the new heap
+		neededSize = handleCache.ComputeStagedSize();
 	}
 
 	// This can trigger the creation of a new heap
 	m_owningCommandList.SetDescriptorHeap(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV, GetHeapPointer());
 
-	handleCache.CopyAndBindStaleTables(Allocate(neededSize), cmdList, SetFunc);
+	const uint32_t heapOffset = m_currentOffset;
+	handleCache.CopyAndBindStaleTables(Allocate(neededSize), heapOffset, m_tableMap, cmdList, SetFunc);
 }
\ No newline at end of file
@@ -11,6 +11,7 @@
 #pragma once
 
 #include "DescriptorHeap12.h"
+#include "DescriptorTableMap.h"
 #include "RootSignature12.h"
 
 namespace Kodiak
@@ -21,7 +22,9 @@ class CommandList;
 
 // This class is a linear allocation system for dynamically generated descriptor tables.  It internally caches
 // CPU descriptor handles so that when not enough space is available in the current heap, necessary descriptors
-// can be re-copied to the new heap.
+// can be re-copied to the new heap.  Tables staged with the same handles as one already copied to the current
+// heap are rebound to that copy.  This assumes CPU descriptors aren't rewritten in place while a command list
+// is being recorded.
 class DynamicDescriptorHeap
 {
 public:
@@ -75,7 +78,12 @@ public:
 
 	static uint32_t GetDescriptorSize();
 
+	// Logs how many table copies were saved by rebinding earlier copies, averaged over frameCount frames
+	static void LogStats(uint64_t frameCount);
+
 private:
+	typedef DescriptorTableMap<D3D12_CPU_DESCRIPTOR_HANDLE> TableMap;
+
 	// Static methods
 	static ID3D12DescriptorHeap* RequestDescriptorHeap();
 	static void DiscardDescriptorHeaps(uint64_t fenceValueForReset, const std::vector<ID3D12DescriptorHeap*>& usedHeaps);
@@ -115,6 +123,9 @@ private:
 	DescriptorHandle m_firstDescriptor;
 	std::vector<ID3D12DescriptorHeap*> m_retiredHeaps;
 
+	// Tables copied to the current heap, cleared when it's retired
+	TableMap m_tableMap;
+
 	// Describes a descriptor table entry:  a region of the handle cache and which handles have been set
 	struct DescriptorTableCache
 	{
@@ -139,8 +150,10 @@ private:
 		static const uint32_t kMaxNumDescriptorTables = 16;
 
 		uint32_t ComputeStagedSize();
-		void CopyAndBindStaleTables(DescriptorHandle destHandleStart, ID3D12GraphicsCommandList* cmdList,
+		void BindCachedTables(const TableMap& tableMap, DescriptorHandle heapStart, ID3D12GraphicsCommandList* cmdList,
 			void (STDMETHODCALLTYPE ID3D12GraphicsCommandList::*SetFunc)(UINT, D3D12_GPU_DESCRIPTOR_HANDLE));
+		void CopyAndBindStaleTables(DescriptorHandle destHandleStart, uint32_t heapOffset, TableMap& tableMap,
+			ID3D12GraphicsCommandList* cmdList, void (STDMETHODCALLTYPE ID3D12GraphicsCommandList::*SetFunc)(UINT, D3D12_GPU_DESCRIPTOR_HANDLE));
 
 		DescriptorTableCache rootDescriptorTable[kMaxNumDescriptorTables];
 		D3D12_CPU_DESCRIPTOR_HANDLE handleCache[kMaxNumDescriptors];
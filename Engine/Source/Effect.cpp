@@ -14,11 +14,39 @@
 #include "Material.h"
 #include "RenderEnums.h"
 
+#include <concurrent_queue.h>
+
 
 using namespace Kodiak;
+using namespace Concurrency;
 using namespace std;
 
 
+namespace
+{
+
+// Effects finalized on worker threads, waiting for Renderer::Update to run their callbacks
+concurrent_queue<shared_ptr<BaseEffect>> s_finalizedEffects;
+
+atomic<uint32_t> s_finalizeStallCount{ 0 };
+
+
+template <class TShader>
+void AddShaderLoad(vector<task<void>>& shaderLoads, TShader* shader)
+{
+	if (shader)
+	{
+		// Post-load callbacks only run for loads that succeed, so an effect with a missing shader is
+		// never finalized, and its materials never draw
+		task_completion_event<void> loaded;
+		shader->AddPostLoadCallback([loaded]() { loaded.set(); });
+		shaderLoads.push_back(task<void>(loaded));
+	}
+}
+
+} // anonymous namespace
+
+
 BaseEffect::BaseEffect()
 {
 	m_topology = PrimitiveTopologyType::Triangle;
@@ -113,4 +141,103 @@ void BaseEffect::SetRenderTargetFormats(uint32_t numRTVs, const ColorFormat* col
 	m_depthFormat = depthFormat;
 	m_msaaCount = msaaCount;
 	m_msaaQuality = msaaQuality;
+}
+
+
+void BaseEffect::Finalize()
+{
+	if (m_isFinalized) return;
+
+	unique_lock<mutex> CS(m_finalizeMutex, try_to_lock);
+	if (!CS.owns_lock())
+	{
+		RecordFinalizeStall();
+		CS.lock();
+	}
+
+	if (m_isFinalized) return;
+
+	DoFinalize();
+
+	{
+		lock_guard<mutex> callbackLock(m_callbackMutex);
+		m_isFinalized = true;
+
+		if (m_finalizedCallbacks.empty())
+		{
+			return;
+		}
+	}
+
+	// Hand the callbacks to the main thread
+	s_finalizedEffects.push(shared_from_this());
+}
+
+
+void BaseEffect::FinalizeAsync()
+{
+	// Materials set their effect from the model loader's parallel_for, so several threads can get here at once
+	if (m_isFinalized || m_finalizeStarted.exchange(true)) return;
+
+	vector<task<void>> shaderLoads;
+	AddShaderLoad(shaderLoads, m_vertexShader.get());
+	AddShaderLoad(shaderLoads, m_hullShader.get());
+	AddShaderLoad(shaderLoads, m_domainShader.get());
+	AddShaderLoad(shaderLoads, m_geometryShader.get());
+	AddShaderLoad(shaderLoads, m_pixelShader.get());
+
+	auto allLoaded = shaderLoads.empty() ? task_from_result() : when_all(begin(shaderLoads), end(shaderLoads));
+
+	auto thisEffect = shared_from_this();
+	allLoaded.then([thisEffect]() { thisEffect->Finalize(); });
+}
+
+
+void BaseEffect::AddFinalizedCallback(function<void()> callback)
+{
+	{
+		lock_guard<mutex> CS(m_callbackMutex);
+		if (!m_isFinalized)
+		{
+			m_finalizedCallbacks.push_back(callback);
+			return;
+		}
+	}
+
+	callback();
+}
+
+
+void BaseEffect::DispatchFinalizedCallbacks()
+{
+	shared_ptr<BaseEffect> effect;
+	while (s_finalizedEffects.try_pop(effect))
+	{
+		vector<function<void()>> callbacks;
+		{
+			lock_guard<mutex> CS(effect->m_callbackMutex);
+			swap(callbacks, effect->m_finalizedCallbacks);
+		}
+
+		for (auto& callback : callbacks)
+		{
+			callback();
+		}
+	}
+}
+
+
+void BaseEffect::LogFinalizeStats()
+{
+	const uint32_t stallCount = s_finalizeStallCount.load();
+	if (stallCount > 0)
+	{
+		LOG_WARNING << stallCount << " effect finalizes blocked on shader loads or another thread's finalize";
+	}
+}
+
+
+void BaseEffect::RecordFinalizeStall()
+{
+	++s_finalizeStallCount;
 }
\ No newline at end of file
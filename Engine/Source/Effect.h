@@ -53,10 +53,31 @@ public:
 	void SetRenderTargetFormats(uint32_t numRTVs, const ColorFormat* colorFormats, DepthFormat depthFormat, uint32_t msaaCount = 1,
 		uint32_t msaaQuality = 0);
 
-	// Finalize, doing any additional work after data fields are assigned
-	virtual void Finalize() {}
+	// Finalize, doing any additional work after data fields are assigned.  Blocks until the shaders have
+	// loaded, or until a FinalizeAsync already under way has finished.
+	void Finalize();
 	bool IsFinalized() const { return m_isFinalized; }
 
+	// Finalizes on a worker thread once the shaders have loaded, so no thread waits on them.  Safe to call
+	// from any thread; only the first call starts the finalize.
+	void FinalizeAsync();
+
+	// Runs the callback on the main thread once the effect is finalized, or right away if it already is
+	void AddFinalizedCallback(std::function<void()> callback);
+
+	// Runs the callbacks of effects finalized on worker threads since the last call.  Called on the main
+	// thread by Renderer::Update.
+	static void DispatchFinalizedCallbacks();
+
+	// Logs how many times a thread blocked in Finalize
+	static void LogFinalizeStats();
+
+protected:
+	// Implement this in subclasses
+	virtual void DoFinalize() {}
+
+	// Counts a Finalize that had to block on a shader load or on another thread's finalize
+	static void RecordFinalizeStall();
 
 protected:
 	std::string							m_name;
@@ -73,7 +94,11 @@ protected:
 	DepthStencilStateDesc				m_depthStencilStateDesc;
 	RasterizerStateDesc					m_rasterizerStateDesc;
 
-	bool								m_isFinalized{ false };
+	std::atomic<bool>					m_isFinalized{ false };
+	std::mutex							m_finalizeMutex;
+	std::atomic<bool>					m_finalizeStarted{ false };
+	std::mutex							m_callbackMutex;
+	std::vector<std::function<void()>>	m_finalizedCallbacks;
 
 	// Miscellaneous fields (mostly for DX12)
 	uint32_t							m_sampleMask{ 0xFFFFFFFFu };
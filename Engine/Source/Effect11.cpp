@@ -26,10 +26,8 @@ Effect::Effect() : BaseEffect() {}
 Effect::Effect(const string& name) : BaseEffect(name) {}
 
 
-void Effect::Finalize()
+void Effect::DoFinalize()
 {
-	if (m_isFinalized) return;
-
 	TryWaitShader(m_vertexShader.get());
 	TryWaitShader(m_hullShader.get());
 	TryWaitShader(m_domainShader.get());
@@ -38,8 +36,6 @@ void Effect::Finalize()
 
 	BuildEffectSignature();
 	BuildPSO();
-	
-	m_isFinalized = true;
 }
 
 
@@ -253,8 +249,10 @@ void Effect::ProcessShaderBindings(IShader* shader)
 
 void Effect::TryWaitShader(IShader* shader)
 {
-	if (shader)
+	// Loaded shaders are skipped, so only a real wait is counted as a stall
+	if (shader && !shader->IsReady())
 	{
+		RecordFinalizeStall();
 		shader->Wait();
 	}
 }
\ No newline at end of file
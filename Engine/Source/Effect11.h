@@ -32,8 +32,6 @@ public:
 	const Signature& GetSignature() const { return m_signature; }
 	std::shared_ptr<GraphicsPSO> GetPSO() { return m_pso; }
 
-	void Finalize() override;
-
 	struct Signature
 	{
 		// Per-view and per-object CBV bindings
@@ -58,6 +56,9 @@ public:
 		std::map<std::string, ShaderReflection::Sampler<5>>			samplers;
 	};
 
+protected:
+	void DoFinalize() override;
+
 private:
 	void BuildEffectSignature();
 	void BuildPSO();
@@ -11,6 +11,7 @@
 
 #include "Effect.h"
 
+#include "BindlessDescriptorHeap12.h"
 #include "InputLayout12.h"
 #include "Material.h"
 #include "RenderEnums.h"
@@ -53,10 +54,8 @@ Effect::Effect() : BaseEffect() {}
 Effect::Effect(const string& name) : BaseEffect(name) {}
 
 
-void Effect::Finalize()
+void Effect::DoFinalize()
 {
-	if (m_isFinalized) return;
-
 	TryWaitShader(m_vertexShader.get());
 	TryWaitShader(m_hullShader.get());
 	TryWaitShader(m_domainShader.get());
@@ -65,8 +64,6 @@ void Effect::Finalize()
 
 	BuildEffectSignature();
 	BuildPSO();
-
-	m_isFinalized = true;
 }
 
 
@@ -78,6 +75,10 @@ void Effect::BuildEffectSignature()
 	m_signature.perViewDataIndex = kInvalid;
 	m_signature.perObjectDataIndex = kInvalid;
 	m_signature.cbvPerMaterialDataSize = 0;
+	m_signature.bindlessRootIndex = kInvalid;
+	m_signature.rootCbvs.clear();
+
+	m_bindlessSrvRegister = GetBindlessSrvRegister();
 
 	// Create the root signature.  We'll populate the root parameters as we go through the shaders.
 	CreateRootSignature();
@@ -90,6 +91,17 @@ void Effect::BuildEffectSignature()
 	ProcessShaderBindings(rootIndex, m_geometryShader.get());
 	ProcessShaderBindings(rootIndex, m_pixelShader.get());
 
+	// One table over the whole bindless heap, shared by every stage
+	if (m_bindlessSrvRegister != kInvalid)
+	{
+		m_signature.bindlessRootIndex = rootIndex;
+
+		auto& rootParam = (*m_rootSig)[rootIndex++];
+		rootParam.InitAsDescriptorTable(1);
+		rootParam.SetTableRange(0, D3D12_DESCRIPTOR_RANGE_TYPE_SRV, m_bindlessSrvRegister,
+			BindlessDescriptorHeap::GetInstance().GetCapacity(), GetBindlessTextureSpace());
+	}
+
 	// Patch the constant buffer offsets 
 	// (number of bytes from the start of the uber-cbuffer for each sub-buffer)
 	uint32_t currentOffset = 0;
@@ -111,6 +123,11 @@ void Effect::BuildEffectSignature()
 		}
 	}
 
+	for (auto& rootCbv : m_signature.rootCbvs)
+	{
+		rootCbv.byteOffset = m_signature.cbvBindings[rootCbv.shaderIndex][rootCbv.cbvIndex].byteOffset;
+	}
+
 	// Patch the parameter offsets
 	// (number of bytes from the start of the uber-cbuffer for each sub-buffer)
 	for (auto& parameter : m_signature.parameters)
@@ -166,7 +183,8 @@ void Effect::BuildPSO()
 	m_pso->SetGeometryShader(m_geometryShader.get());
 	m_pso->SetPixelShader(m_pixelShader.get());
 
-	m_pso->Finalize();
+	// Materials skip their draws until the PSO is ready, rather than stalling the frame on the compile
+	m_pso->FinalizeAsync();
 }
 
 
@@ -178,6 +196,17 @@ inline bool IsValidSize(uint32_t size)
 	return (size != 0) && (size != kInvalid);
 }
 
+
+inline uint32_t GetNumMaterialRootParameters(const ShaderReflection::Signature& sig, bool bindless)
+{
+	// Bindless effects bind each material cbuffer directly, rather than through a table per stage
+	if (bindless)
+	{
+		return static_cast<uint32_t>(sig.cbvTable.size());
+	}
+	return (sig.numMaterialDescriptors > 0) ? 1 : 0;
+}
+
 } // anonymous namespace
 
 
@@ -185,14 +214,14 @@ void Effect::CreateRootSignature()
 {
 	uint32_t numRootParameters = 0;
 	uint32_t numRootSamplers = 0;
+	const bool bindless = (m_bindlessSrvRegister != kInvalid);
 	bool usePerViewData = false;
 	bool usePerObjectData = false;
 
 	if (m_vertexShader)
 	{
 		const auto& sig = m_vertexShader->GetSignature();
-		auto vsDescriptors = sig.numMaterialDescriptors;
-		numRootParameters += (vsDescriptors > 0) ? 1 : 0;
+		numRootParameters += GetNumMaterialRootParameters(sig, bindless);
 		numRootSamplers += sig.numSamplers;
 
 		usePerViewData = usePerViewData || IsValidSize(sig.cbvPerViewData.sizeInBytes);
@@ -202,8 +231,7 @@ void Effect::CreateRootSignature()
 	if (m_hullShader)
 	{
 		const auto& sig = m_hullShader->GetSignature();
-		auto hsDescriptors = sig.numMaterialDescriptors;
-		numRootParameters += (hsDescriptors > 0) ? 1 : 0;
+		numRootParameters += GetNumMaterialRootParameters(sig, bindless);
 		numRootSamplers += sig.numSamplers;
 
 		usePerViewData = usePerViewData || IsValidSize(sig.cbvPerViewData.sizeInBytes);
@@ -213,8 +241,7 @@ void Effect::CreateRootSignature()
 	if (m_domainShader)
 	{
 		const auto& sig = m_domainShader->GetSignature();
-		auto dsDescriptors = sig.numMaterialDescriptors;
-		numRootParameters += (dsDescriptors > 0) ? 1 : 0;
+		numRootParameters += GetNumMaterialRootParameters(sig, bindless);
 		numRootSamplers += sig.numSamplers;
 
 		usePerViewData = usePerViewData || IsValidSize(sig.cbvPerViewData.sizeInBytes);
@@ -224,8 +251,7 @@ void Effect::CreateRootSignature()
 	if (m_geometryShader)
 	{
 		const auto& sig = m_geometryShader->GetSignature();
-		auto gsDescriptors = sig.numMaterialDescriptors;
-		numRootParameters += (gsDescriptors > 0) ? 1 : 0;
+		numRootParameters += GetNumMaterialRootParameters(sig, bindless);
 		numRootSamplers += sig.numSamplers;
 
 		usePerViewData = usePerViewData || IsValidSize(sig.cbvPerViewData.sizeInBytes);
@@ -235,8 +261,7 @@ void Effect::CreateRootSignature()
 	if (m_pixelShader)
 	{
 		const auto& sig = m_pixelShader->GetSignature();
-		auto psDescriptors = sig.numMaterialDescriptors;
-		numRootParameters += (psDescriptors > 0) ? 1 : 0;
+		numRootParameters += GetNumMaterialRootParameters(sig, bindless);
 		numRootSamplers += sig.numSamplers;
 
 		usePerViewData = usePerViewData || IsValidSize(sig.cbvPerViewData.sizeInBytes);
@@ -253,6 +278,11 @@ void Effect::CreateRootSignature()
 		numRootParameters++;
 	}
 
+	if (bindless)
+	{
+		numRootParameters++;
+	}
+
 	m_rootSig = make_shared<RootSignature>(numRootParameters, numRootSamplers);
 }
 
@@ -322,8 +352,37 @@ void Effect::ProcessShaderBindings(uint32_t& rootIndex, IShader* shader)
 		}
 	}
 
-	// Setup descriptor tables
-	if (shaderSig.numMaterialDescriptors > 0)
+	// Bindless effects bind their material cbuffers as root CBVs.  Only one CBV_SRV_UAV heap can be bound at a time,
+	// so they can't mix in SRV or UAV tables from the dynamic descriptor heap.
+	if (m_bindlessSrvRegister != kInvalid)
+	{
+		if (!shaderSig.srvTable.empty() || !shaderSig.uavTable.empty())
+		{
+			LOG_ERROR << "Effect " << m_name << " uses bindless textures, and can't also bind SRV or UAV tables";
+			assert(false);
+		}
+
+		m_signature.cbvBindings[shaderIndex] = shaderSig.cbvTable;
+
+		const uint32_t numCbvs = static_cast<uint32_t>(m_signature.cbvBindings[shaderIndex].size());
+		for (uint32_t i = 0; i < numCbvs; ++i)
+		{
+			auto& cbv = m_signature.cbvBindings[shaderIndex][i];
+
+			Signature::RootCBV rootCbv;
+			rootCbv.rootIndex = rootIndex;
+			rootCbv.shaderIndex = shaderIndex;
+			rootCbv.cbvIndex = i;
+			m_signature.rootCbvs.push_back(rootCbv);
+
+			rootSig[rootIndex++].InitAsConstantBuffer(cbv.shaderRegister, s_shaderVisibility[shaderIndex]);
+
+			// Still gets a CPU descriptor, so instances copy their parent the same way as other materials
+			cbv.binding.tableIndex = m_signature.totalDescriptors++;
+			cbv.binding.tableSlot = kInvalid;
+		}
+	}
+	else if (shaderSig.numMaterialDescriptors > 0)
 	{
 		// Count ranges
 		uint32_t numRanges = 0;
@@ -476,10 +535,34 @@ void Effect::ProcessShaderBindings(uint32_t& rootIndex, IShader* shader)
 }
 
 
+uint32_t Effect::GetBindlessSrvRegister() const
+{
+	uint32_t bindlessSrvRegister = kInvalid;
+
+	const IShader* shaders[] = { m_vertexShader.get(), m_hullShader.get(), m_domainShader.get(), m_geometryShader.get(), m_pixelShader.get() };
+	for (const auto shader : shaders)
+	{
+		if (!shader || shader->GetSignature().bindlessSrvRegister == kInvalid)
+		{
+			continue;
+		}
+
+		// Every stage shares the one table, so they have to agree on the register
+		const auto shaderRegister = shader->GetSignature().bindlessSrvRegister;
+		assert(bindlessSrvRegister == kInvalid || bindlessSrvRegister == shaderRegister);
+		bindlessSrvRegister = shaderRegister;
+	}
+
+	return bindlessSrvRegister;
+}
+
+
 void Effect::TryWaitShader(IShader* shader)
 {
-	if (shader)
+	// Loaded shaders are skipped, so only a real wait is counted as a stall
+	if (shader && !shader->IsReady())
 	{
+		RecordFinalizeStall();
 		shader->Wait();
 	}
 }
@@ -34,8 +34,6 @@ public:
 	std::shared_ptr<GraphicsPSO> GetPSO() { return m_pso; }
 	std::shared_ptr<RootSignature> GetRootSignature() { return m_rootSig; }
 
-	void Finalize() override;
-
 	struct Signature
 	{
 		// Per-view and per-object CBV bindings
@@ -53,6 +51,18 @@ public:
 		// Root parameters
 		std::vector<ShaderReflection::DescriptorRange> rootParameters;
 
+		// Bindless effects bind their material cbuffers as root CBVs, and index textures through one table over
+		// the bindless heap, so their draws don't stage any descriptors
+		struct RootCBV
+		{
+			uint32_t	rootIndex{ kInvalid };
+			uint32_t	shaderIndex{ kInvalid };
+			uint32_t	cbvIndex{ kInvalid };	// Into cbvBindings[shaderIndex]
+			uint32_t	byteOffset{ kInvalid };
+		};
+		uint32_t				bindlessRootIndex{ kInvalid };
+		std::vector<RootCBV>	rootCbvs;
+
 		// Mapping data
 		std::map<std::string, ShaderReflection::Parameter<5>>		parameters;
 		std::array<std::vector<ShaderReflection::CBVLayout>, 5>		cbvBindings;
@@ -61,6 +71,9 @@ public:
 		// TODO samplers
 	};
 
+protected:
+	void DoFinalize() override;
+
 private:
 	void BuildEffectSignature();
 	void BuildPSO();
@@ -68,6 +81,7 @@ private:
 	void CreateRootSignature();
 	void ProcessShaderBindings(uint32_t& rootIndex, IShader* shader);
 	void TryWaitShader(IShader* shader);
+	uint32_t GetBindlessSrvRegister() const;
 	D3D12_ROOT_SIGNATURE_FLAGS GetRootSignatureFlags();
 
 private:
@@ -75,6 +89,9 @@ private:
 	std::shared_ptr<GraphicsPSO>	m_pso;
 
 	Signature						m_signature;
+
+	// Register of the bindless texture array, if any of the shaders declare it
+	uint32_t						m_bindlessSrvRegister{ kInvalid };
 };
 
 } // namespace Kodiak
\ No newline at end of file
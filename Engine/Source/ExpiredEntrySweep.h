@@ -0,0 +1,74 @@
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+// Author: David Elder
+//
+
+#pragma once
+
+// Incremental sweep of expired weak references out of an unordered map, a fixed number of hash buckets per
+// call.  Collecting only needs read access to the map, so the caller can hold a shared lock for it and take
+// the exclusive lock just to erase, and only when something expired.  This header only depends on the
+// standard library.
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+namespace Kodiak
+{
+
+// Appends the keys of expired entries in up to maxBuckets buckets, starting at cursor, and advances cursor
+// past them.  The cursor wraps, and restarts at 0 if the map was rehashed to fewer buckets.
+template <class TMap>
+void CollectExpired(const TMap& map, size_t& cursor, size_t maxBuckets, std::vector<typename TMap::key_type>& expiredKeys)
+{
+	const size_t bucketCount = map.bucket_count();
+	if (map.empty() || bucketCount == 0)
+	{
+		return;
+	}
+
+	if (cursor >= bucketCount)
+	{
+		cursor = 0;
+	}
+
+	const size_t numBuckets = std::min(maxBuckets, bucketCount);
+	for (size_t i = 0; i < numBuckets; ++i)
+	{
+		for (auto it = map.begin(cursor); it != map.end(cursor); ++it)
+		{
+			if (it->second.expired())
+			{
+				expiredKeys.push_back(it->first);
+			}
+		}
+
+		cursor = (cursor + 1) % bucketCount;
+	}
+}
+
+
+// Erases the collected keys whose entries are still expired, since the map may have changed since they were
+// collected.  Erasing never rehashes, so a sweep cursor stays meaningful.  Returns the number erased.
+template <class TMap>
+size_t EraseExpired(TMap& map, const std::vector<typename TMap::key_type>& expiredKeys)
+{
+	size_t numErased = 0;
+	for (const auto& key : expiredKeys)
+	{
+		auto it = map.find(key);
+		if (it != map.end() && it->second.expired())
+		{
+			map.erase(it);
+			++numErased;
+		}
+	}
+	return numErased;
+}
+
+} // namespace Kodiak
\ No newline at end of file
@@ -15,8 +15,20 @@ namespace Kodiak
 enum class ColorFormat
 {
 	Unknown,
+	BC1_UNorm,
+	BC1_UNorm_sRGB,
+	BC2_UNorm,
+	BC2_UNorm_sRGB,
+	BC3_UNorm,
 	BC3_UNorm_sRGB,
+	BC4_UNorm,
+	BC5_UNorm,
+	BC7_UNorm,
+	BC7_UNorm_sRGB,
 	R8G8B8A8,
+	R8G8B8A8_sRGB,
+	B8G8R8A8_UNorm,
+	B8G8R8A8_UNorm_sRGB,
 	R8_UNorm,
 	R8_UInt,
 	R10G10B10A2_UNorm,
@@ -0,0 +1,267 @@
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+// Author: David Elder
+//
+
+#include "Stdafx.h"
+
+#include "GeometryPool.h"
+
+#include "CommandList.h"
+#include "IndexBuffer.h"
+#include "RenderEnums.h"
+#include "VertexBuffer.h"
+
+
+using namespace Kodiak;
+using namespace std;
+
+
+namespace
+{
+
+// Default buffer sizes.  Anything bigger gets a buffer of its own size.
+const size_t kVertexPageBytes = 32 * 1024 * 1024;
+const size_t kIndexPageBytes = 8 * 1024 * 1024;
+
+const size_t kInvalidOffset = ~size_t(0);
+
+
+// First-fit allocator over a range of elements.  Free ranges are kept sorted by offset and merged with
+// their neighbours.
+class RangeAllocator
+{
+public:
+	explicit RangeAllocator(size_t size)
+	{
+		m_freeRanges[0] = size;
+	}
+
+	size_t Allocate(size_t size)
+	{
+		for (auto it = begin(m_freeRanges); it != end(m_freeRanges); ++it)
+		{
+			if (it->second >= size)
+			{
+				const size_t offset = it->first;
+				const size_t remaining = it->second - size;
+
+				m_freeRanges.erase(it);
+				if (remaining > 0)
+				{
+					m_freeRanges[offset + size] = remaining;
+				}
+
+				m_usedSize += size;
+				++m_allocationCount;
+				return offset;
+			}
+		}
+		return kInvalidOffset;
+	}
+
+	void Free(size_t offset, size_t size)
+	{
+		m_usedSize -= size;
+		--m_allocationCount;
+
+		auto next = m_freeRanges.lower_bound(offset);
+		if (next != end(m_freeRanges) && offset + size == next->first)
+		{
+			size += next->second;
+			next = m_freeRanges.erase(next);
+		}
+
+		if (next != begin(m_freeRanges))
+		{
+			auto previous = prev(next);
+			if (previous->first + previous->second == offset)
+			{
+				previous->second += size;
+				return;
+			}
+		}
+
+		m_freeRanges[offset] = size;
+	}
+
+	size_t GetUsedSize() const { return m_usedSize; }
+	size_t GetAllocationCount() const { return m_allocationCount; }
+
+private:
+	map<size_t, size_t>	m_freeRanges;
+	size_t				m_usedSize{ 0 };
+	size_t				m_allocationCount{ 0 };
+};
+
+} // anonymous namespace
+
+
+namespace Kodiak
+{
+
+// One shared buffer.  Vertex pages hold a single stride; index pages hold 16-bit indices.
+struct GeometryAllocation::Page
+{
+	Page(size_t elementSize, size_t capacity)
+		: elementSize(elementSize)
+		, capacity(capacity)
+		, ranges(capacity)
+	{}
+
+	shared_ptr<VertexBuffer>	vertexBuffer;
+	shared_ptr<IndexBuffer>		indexBuffer;
+	size_t						elementSize;
+	size_t						capacity;		// In elements
+
+	// Allocations free themselves without the pool lock, so the page has its own
+	mutex						rangeMutex;
+	RangeAllocator				ranges;
+};
+
+
+GeometryAllocation::~GeometryAllocation()
+{
+	if (m_vertexPage)
+	{
+		lock_guard<mutex> lock(m_vertexPage->rangeMutex);
+		m_vertexPage->ranges.Free(baseVertex, vertexCount);
+	}
+
+	if (m_indexPage)
+	{
+		lock_guard<mutex> lock(m_indexPage->rangeMutex);
+		m_indexPage->ranges.Free(startIndex, indexCount);
+	}
+}
+
+
+GeometryPool& GeometryPool::GetInstance()
+{
+	static GeometryPool instance;
+	return instance;
+}
+
+
+shared_ptr<GeometryAllocation> GeometryPool::Allocate(const void* vertexData, size_t vertexStride, size_t vertexCount,
+	const uint16_t* indexData, size_t indexCount)
+{
+	assert(vertexStride > 0 && vertexCount > 0 && indexCount > 0);
+
+	auto allocation = make_shared<GeometryAllocation>();
+
+	size_t vertexOffset = 0;
+	size_t indexOffset = 0;
+
+	{
+		lock_guard<mutex> lock(m_mutex);
+
+		allocation->m_vertexPage = FindPage(m_vertexPages, vertexStride, vertexCount, vertexOffset);
+		allocation->m_indexPage = FindPage(m_indexPages, sizeof(uint16_t), indexCount, indexOffset);
+	}
+
+	allocation->vertexBuffer = allocation->m_vertexPage->vertexBuffer;
+	allocation->indexBuffer = allocation->m_indexPage->indexBuffer;
+	allocation->baseVertex = static_cast<uint32_t>(vertexOffset);
+	allocation->startIndex = static_cast<uint32_t>(indexOffset);
+	allocation->vertexCount = static_cast<uint32_t>(vertexCount);
+	allocation->indexCount = static_cast<uint32_t>(indexCount);
+
+	// The ranges are ours now, so the copies don't need the lock
+#if defined(DX12)
+	CommandList::InitializeBuffer(*allocation->vertexBuffer, vertexData, vertexCount * vertexStride, vertexOffset * vertexStride);
+	CommandList::InitializeBuffer(*allocation->indexBuffer, indexData, indexCount * sizeof(uint16_t), indexOffset * sizeof(uint16_t));
+#elif defined(DX11)
+	CommandList::InitializeBuffer(allocation->vertexBuffer->vertexBuffer.Get(), vertexData, vertexCount * vertexStride, vertexOffset * vertexStride);
+	CommandList::InitializeBuffer(allocation->indexBuffer->indexBuffer.Get(), indexData, indexCount * sizeof(uint16_t), indexOffset * sizeof(uint16_t));
+#endif
+
+	return allocation;
+}
+
+
+GeometryPoolStats GeometryPool::GetStats()
+{
+	lock_guard<mutex> lock(m_mutex);
+
+	GeometryPoolStats stats;
+	stats.vertexBufferCount = m_vertexPages.size();
+	stats.indexBufferCount = m_indexPages.size();
+
+	for (const auto& pages : { &m_vertexPages, &m_indexPages })
+	{
+		for (const auto& page : *pages)
+		{
+			lock_guard<mutex> rangeLock(page->rangeMutex);
+			stats.capacityBytes += page->capacity * page->elementSize;
+			stats.usedBytes += page->ranges.GetUsedSize() * page->elementSize;
+		}
+	}
+
+	// Every allocation holds exactly one vertex range
+	for (const auto& page : m_vertexPages)
+	{
+		lock_guard<mutex> rangeLock(page->rangeMutex);
+		stats.allocationCount += page->ranges.GetAllocationCount();
+	}
+
+	return stats;
+}
+
+
+void GeometryPool::Shutdown()
+{
+	lock_guard<mutex> lock(m_mutex);
+
+	m_vertexPages.clear();
+	m_indexPages.clear();
+}
+
+
+shared_ptr<GeometryAllocation::Page> GeometryPool::FindPage(vector<shared_ptr<GeometryAllocation::Page>>& pages,
+	size_t elementSize, size_t elementCount, size_t& offset)
+{
+	const bool isIndexPage = (&pages == &m_indexPages);
+
+	for (auto& page : pages)
+	{
+		if (page->elementSize != elementSize)
+		{
+			continue;
+		}
+
+		lock_guard<mutex> rangeLock(page->rangeMutex);
+		offset = page->ranges.Allocate(elementCount);
+		if (offset != kInvalidOffset)
+		{
+			return page;
+		}
+	}
+
+	// No room, so add a buffer
+	const size_t pageBytes = isIndexPage ? kIndexPageBytes : kVertexPageBytes;
+	const size_t capacity = max<size_t>(pageBytes / elementSize, elementCount);
+
+	auto page = make_shared<GeometryAllocation::Page>(elementSize, capacity);
+	if (isIndexPage)
+	{
+		IndexBufferData16 data(nullptr, capacity * sizeof(uint16_t));
+		page->indexBuffer = IndexBuffer::Create(data, Usage::Default);
+	}
+	else
+	{
+		VertexBufferDataRaw data(nullptr, elementSize, capacity * elementSize);
+		page->vertexBuffer = VertexBuffer::Create(data, Usage::Default);
+	}
+
+	offset = page->ranges.Allocate(elementCount);
+	pages.push_back(page);
+
+	return page;
+}
+
+} // namespace Kodiak
\ No newline at end of file
@@ -0,0 +1,83 @@
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+// Author: David Elder
+//
+
+#pragma once
+
+// Large vertex and index buffers shared by every loaded model.  Models sub-allocate their geometry from
+// them instead of creating a buffer pair each, so draws from different models can reuse the same VB/IB
+// bindings.  Vertices of each stride get their own buffers; indices are 16-bit and relative to the
+// allocation's first vertex, so they are copied unchanged.
+
+namespace Kodiak
+{
+
+// Forward declarations
+class IndexBuffer;
+class VertexBuffer;
+
+
+class GeometryAllocation
+{
+	friend class GeometryPool;
+
+public:
+	~GeometryAllocation();
+
+	std::shared_ptr<VertexBuffer>	vertexBuffer;
+	std::shared_ptr<IndexBuffer>	indexBuffer;
+	uint32_t						baseVertex{ 0 };	// Add to the model's base vertex offsets
+	uint32_t						startIndex{ 0 };	// Add to the model's start indices
+	uint32_t						vertexCount{ 0 };
+	uint32_t						indexCount{ 0 };
+
+private:
+	struct Page;
+	std::shared_ptr<Page>			m_vertexPage;
+	std::shared_ptr<Page>			m_indexPage;
+};
+
+
+struct GeometryPoolStats
+{
+	size_t vertexBufferCount{ 0 };
+	size_t indexBufferCount{ 0 };
+	size_t allocationCount{ 0 };
+	size_t capacityBytes{ 0 };	// GPU memory held by the pool's buffers
+	size_t usedBytes{ 0 };		// Of that, bytes allocated to models
+};
+
+
+class GeometryPool
+{
+public:
+	static GeometryPool& GetInstance();
+
+	// Copies the vertices and indices into the pool.  Ranges are returned to the pool when the allocation
+	// is destroyed, so keep it alive until the GPU has finished drawing from it.
+	std::shared_ptr<GeometryAllocation> Allocate(const void* vertexData, size_t vertexStride, size_t vertexCount,
+		const uint16_t* indexData, size_t indexCount);
+
+	GeometryPoolStats GetStats();
+
+	// Drops the pool's references to its buffers.  Outstanding allocations keep theirs alive.
+	void Shutdown();
+
+private:
+	GeometryPool() = default;
+
+	std::shared_ptr<GeometryAllocation::Page> FindPage(std::vector<std::shared_ptr<GeometryAllocation::Page>>& pages,
+		size_t elementSize, size_t elementCount, size_t& offset);
+
+private:
+	std::mutex m_mutex;
+	std::vector<std::shared_ptr<GeometryAllocation::Page>>	m_vertexPages;
+	std::vector<std::shared_ptr<GeometryAllocation::Page>>	m_indexPages;
+};
+
+} // namespace Kodiak
\ No newline at end of file
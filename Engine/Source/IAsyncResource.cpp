@@ -7,7 +7,7 @@
 // Author: David Elder
 //
 
-#include "Stdafx.h"
+// Built without the precompiled header, so that tools can share it
 
 #include "IAsyncResource.h"
 
@@ -24,15 +24,23 @@ IAsyncResource::IAsyncResource()
 
 void IAsyncResource::AcquireThreadResult(future<void>&& threadResult)
 {
-	m_threadResult = move(threadResult);
+	lock_guard<mutex> CS(m_mutex);
+	m_threadResult = threadResult.share();
 }
 
 
 void IAsyncResource::Wait()
 {
-	if (m_threadResult.valid())
+	// Wait on a copy, so the lock isn't held while the load runs
+	shared_future<void> threadResult;
 	{
-		m_threadResult.get();
+		lock_guard<mutex> CS(m_mutex);
+		threadResult = m_threadResult;
+	}
+
+	if (threadResult.valid())
+	{
+		threadResult.get();
 	}
 }
 
@@ -52,23 +60,67 @@ bool IAsyncResource::IsLoadFinished() const
 
 void IAsyncResource::AddPostLoadCallback(function<void()> callback)
 {
-	LoadState curState = m_loadState;
-	if (curState == LoadState::LoadSucceeded)
 	{
-		callback();
+		// ExecutePostLoadCallbacks takes the lock after the state is final, so a callback pushed here is
+		// never missed
+		lock_guard<mutex> CS(m_mutex);
+
+		LoadState curState = m_loadState;
+		if (curState == LoadState::LoadFailed)
+		{
+			return;
+		}
+		else if (curState != LoadState::LoadSucceeded)
+		{
+			m_callbacks.push_back(move(callback));
+			return;
+		}
 	}
-	else if (curState != LoadState::LoadFailed)
+
+	callback();
+}
+
+
+void IAsyncResource::AddLoadFinishedCallback(function<void(bool)> callback)
+{
 	{
-		m_callbacks.push_back(callback);
+		// Post-load callbacks still waiting to run must see the resource first
+		lock_guard<mutex> CS(m_mutex);
+
+		if (!IsLoadFinished() || !m_callbacks.empty() || !m_finishedCallbacks.empty())
+		{
+			m_finishedCallbacks.push_back(move(callback));
+			return;
+		}
 	}
+
+	callback(IsReady());
 }
 
 
 void IAsyncResource::ExecutePostLoadCallbacks()
 {
-	for (auto& callback : m_callbacks)
+	const bool succeeded = IsReady();
+
+	// Run the callbacks outside the lock, since they may add more
+	vector<function<void()>> callbacks;
+	vector<function<void(bool)>> finishedCallbacks;
+	{
+		lock_guard<mutex> CS(m_mutex);
+		swap(callbacks, m_callbacks);
+		swap(finishedCallbacks, m_finishedCallbacks);
+	}
+
+	if (succeeded)
+	{
+		for (auto& callback : callbacks)
+		{
+			callback();
+		}
+	}
+
+	for (auto& callback : finishedCallbacks)
 	{
-		callback();
+		callback(succeeded);
 	}
-	m_callbacks.clear();
 }
\ No newline at end of file
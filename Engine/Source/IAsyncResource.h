@@ -9,11 +9,21 @@
 
 #pragma once
 
+// Loads run on loader threads, and the callbacks can be added from any thread.  This header and
+// IAsyncResource.cpp only depend on the standard library.
+
+#include "LoadTelemetry.h"
+
+#include <functional>
+#include <future>
+#include <memory>
+
 namespace Kodiak
 {
 
 // Forward declarations
 enum class LoadState;
+class LoadNode;
 
 
 class IAsyncResource
@@ -26,6 +36,9 @@ public:
 	virtual bool DoLoad() = 0;
 
 	void AcquireThreadResult(std::future<void>&& threadResult);
+
+	// Blocks until the load has finished, and rethrows anything it threw.  Any number of threads can wait,
+	// any number of times.
 	void Wait();
 
 	void SetResourcePath(const std::string& path) { m_resourcePath = path; }
@@ -35,14 +48,41 @@ public:
 	bool IsLoadFinished() const;
 	LoadState GetLoadState() const { return m_loadState; }
 
+	// Called once the load has succeeded.  Runs right away on the calling thread if it already has, otherwise
+	// on the main thread from ExecutePostLoadCallbacks.
 	void AddPostLoadCallback(std::function<void()> callback);
+
+	// Called once the load has finished, successfully or not, after any post-load callbacks
+	void AddLoadFinishedCallback(std::function<void(bool)> callback);
+
+	// Called on the main thread by ResourceLoader::Update, once the load state is final
 	void ExecutePostLoadCallbacks();
 
+	// Load graph hints.  Resources that can act on them (e.g. streaming textures) override these.
+	virtual void SetLoadPriority(float /*priority*/) {}
+	virtual void CancelLoad() {}
+
+#if LOAD_TELEMETRY
+	LoadRecord& GetLoadRecord() { return m_loadRecord; }
+#endif
+
 protected:
+	friend class LoadNode;
+
 	std::string							m_resourcePath;
-	std::future<void>					m_threadResult;
 	std::atomic<LoadState>				m_loadState;
+
+	// Guards the thread result and the callback lists
+	std::mutex							m_mutex;
+	std::shared_future<void>			m_threadResult;
 	std::vector<std::function<void()>>	m_callbacks;
+	std::vector<std::function<void(bool)>>	m_finishedCallbacks;
+
+	std::weak_ptr<LoadNode>				m_loadNode;
+
+#if LOAD_TELEMETRY
+	LoadRecord							m_loadRecord;
+#endif
 };
 
 } // namespace Kodiak
\ No newline at end of file
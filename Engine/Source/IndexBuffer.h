@@ -63,17 +63,22 @@ public:
 	}
 
 
+	// With null data, the buffer is created uninitialized
 	IndexBufferData16(const byte* data, size_t sizeInBytes)
 	{
 		m_id = s_baseId++;
 
 		m_numElements = sizeInBytes / sizeof(uint16_t);
-		m_data = (uint16_t*)_aligned_malloc(sizeof(uint16_t) * m_numElements, 16);
 
-		assert(m_data);
-		if (m_data)
+		if (data)
 		{
-			memcpy(m_data, data, sizeInBytes);
+			m_data = (uint16_t*)_aligned_malloc(sizeof(uint16_t) * m_numElements, 16);
+
+			assert(m_data);
+			if (m_data)
+			{
+				memcpy(m_data, data, sizeInBytes);
+			}
 		}
 	}
 
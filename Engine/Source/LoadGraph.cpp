@@ -0,0 +1,280 @@
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+// Author: David Elder
+//
+
+#include "Stdafx.h"
+
+#include "LoadGraph.h"
+
+#include "IAsyncResource.h"
+#include "LoaderEnums.h"
+
+
+using namespace Kodiak;
+using namespace std;
+
+
+namespace
+{
+
+bool IsFinishedState(LoadState state)
+{
+	return (state == LoadState::LoadSucceeded) || (state == LoadState::LoadFailed) || (state == LoadState::LoadCanceled);
+}
+
+} // anonymous namespace
+
+
+LoadNode::LoadNode(const string& name)
+	: m_name(name)
+	, m_loadState(LoadState::Loading)
+{
+	m_future = m_promise.get_future().share();
+}
+
+
+shared_ptr<LoadNode> LoadNode::Track(shared_ptr<IAsyncResource> resource)
+{
+	assert(resource);
+
+	auto node = resource->m_loadNode.lock();
+	if (node && !node->IsCanceled())
+	{
+		return node;
+	}
+
+	node = make_shared<LoadNode>(resource->GetResourcePath());
+	node->m_resource = resource;
+	resource->m_loadNode = node;
+
+	weak_ptr<LoadNode> weakNode = node;
+	resource->AddLoadFinishedCallback([weakNode](bool succeeded)
+	{
+		if (auto node = weakNode.lock())
+		{
+			node->FinishWork(succeeded);
+		}
+	});
+
+	return node;
+}
+
+
+bool LoadNode::IsLoadFinished() const
+{
+	return IsFinishedState(m_loadState);
+}
+
+
+bool LoadNode::IsCanceled() const
+{
+	return m_loadState == LoadState::LoadCanceled;
+}
+
+
+void LoadNode::AddDependency(shared_ptr<LoadNode> dependency)
+{
+	assert(dependency);
+	assert(dependency.get() != this);
+
+	{
+		lock_guard<mutex> CS(m_mutex);
+		assert_msg(m_workPending, "Dependencies must be added before FinishWork");
+
+		m_dependencies.push_back(dependency);
+		++m_pendingDependencies;
+	}
+
+	// The dependency may already be done, in which case it won't call back
+	LoadState state = dependency->AttachParent(shared_from_this());
+	if (IsFinishedState(state))
+	{
+		OnDependencyFinished(state);
+	}
+}
+
+
+void LoadNode::FinishWork(bool succeeded)
+{
+	LoadState result = LoadState::Loading;
+	{
+		lock_guard<mutex> CS(m_mutex);
+		if (IsFinishedState(m_loadState) || !m_workPending)
+		{
+			return;
+		}
+
+		m_workPending = false;
+		m_failed = m_failed || !succeeded;
+
+		if (m_pendingDependencies == 0)
+		{
+			result = m_failed ? LoadState::LoadFailed : LoadState::LoadSucceeded;
+		}
+	}
+
+	if (result != LoadState::Loading)
+	{
+		Finish(result);
+	}
+}
+
+
+void LoadNode::AddCompletionCallback(function<void(LoadState)> callback)
+{
+	{
+		lock_guard<mutex> CS(m_mutex);
+		if (!IsFinishedState(m_loadState))
+		{
+			m_callbacks.push_back(callback);
+			return;
+		}
+	}
+
+	callback(m_loadState);
+}
+
+
+void LoadNode::SetPriority(float priority)
+{
+	m_priority = priority;
+
+	if (m_resource)
+	{
+		m_resource->SetLoadPriority(priority);
+	}
+
+	vector<shared_ptr<LoadNode>> dependencies;
+	{
+		lock_guard<mutex> CS(m_mutex);
+		dependencies = m_dependencies;
+	}
+
+	for (auto& dependency : dependencies)
+	{
+		dependency->SetPriority(priority);
+	}
+}
+
+
+void LoadNode::Cancel()
+{
+	vector<shared_ptr<LoadNode>> dependencies;
+	{
+		lock_guard<mutex> CS(m_mutex);
+		if (IsFinishedState(m_loadState))
+		{
+			return;
+		}
+		dependencies = m_dependencies;
+	}
+
+	if (m_resource)
+	{
+		m_resource->CancelLoad();
+	}
+
+	Finish(LoadState::LoadCanceled);
+
+	// Only cancel the parts of the subtree nobody else is waiting on
+	for (auto& dependency : dependencies)
+	{
+		if (!dependency->HasLiveParent())
+		{
+			dependency->Cancel();
+		}
+	}
+}
+
+
+LoadState LoadNode::AttachParent(weak_ptr<LoadNode> parent)
+{
+	lock_guard<mutex> CS(m_mutex);
+
+	if (!IsFinishedState(m_loadState))
+	{
+		m_parents.push_back(parent);
+	}
+	return m_loadState;
+}
+
+
+bool LoadNode::HasLiveParent()
+{
+	lock_guard<mutex> CS(m_mutex);
+
+	for (const auto& weakParent : m_parents)
+	{
+		auto parent = weakParent.lock();
+		if (parent && !parent->IsLoadFinished())
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+
+void LoadNode::OnDependencyFinished(LoadState state)
+{
+	LoadState result = LoadState::Loading;
+	{
+		lock_guard<mutex> CS(m_mutex);
+		if (IsFinishedState(m_loadState))
+		{
+			return;
+		}
+
+		assert(m_pendingDependencies > 0);
+		--m_pendingDependencies;
+		m_failed = m_failed || (state == LoadState::LoadFailed);
+
+		if (!m_workPending && m_pendingDependencies == 0)
+		{
+			result = m_failed ? LoadState::LoadFailed : LoadState::LoadSucceeded;
+		}
+	}
+
+	if (result != LoadState::Loading)
+	{
+		Finish(result);
+	}
+}
+
+
+void LoadNode::Finish(LoadState state)
+{
+	vector<weak_ptr<LoadNode>> parents;
+	vector<function<void(LoadState)>> callbacks;
+	{
+		lock_guard<mutex> CS(m_mutex);
+		if (IsFinishedState(m_loadState))
+		{
+			return;
+		}
+
+		m_loadState = state;
+		swap(parents, m_parents);
+		swap(callbacks, m_callbacks);
+	}
+
+	m_promise.set_value(state);
+
+	for (auto& callback : callbacks)
+	{
+		callback(state);
+	}
+
+	for (auto& weakParent : parents)
+	{
+		if (auto parent = weakParent.lock())
+		{
+			parent->OnDependencyFinished(state);
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,88 @@
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+// Author: David Elder
+//
+
+#pragma once
+
+namespace Kodiak
+{
+
+// Forward declarations
+class IAsyncResource;
+enum class LoadState;
+
+
+// A node in an asset load graph.  Leaves track a single IAsyncResource; interior nodes (materials,
+// models) declare the nodes they depend on.  A node finishes once its own work is done and all of its
+// dependencies have finished, and fails if any of them failed.  Canceled dependencies don't hold up
+// or fail their parents.
+//
+// Nodes are created and wired up on the main thread, where ResourceLoader::Update also completes
+// the leaves.
+class LoadNode : public std::enable_shared_from_this<LoadNode>
+{
+public:
+	explicit LoadNode(const std::string& name);
+
+	// Returns the leaf tracking resource, creating it on first use
+	static std::shared_ptr<LoadNode> Track(std::shared_ptr<IAsyncResource> resource);
+
+	const std::string& GetName() const { return m_name; }
+	LoadState GetLoadState() const { return m_loadState; }
+	bool IsLoadFinished() const;
+	bool IsCanceled() const;
+
+	// Dependencies must all be added before FinishWork is called
+	void AddDependency(std::shared_ptr<LoadNode> dependency);
+	const std::vector<std::shared_ptr<LoadNode>>& GetDependencies() const { return m_dependencies; }
+
+	// Marks this node's own work as done.  Interior nodes call this once their dependencies are declared.
+	void FinishWork(bool succeeded = true);
+
+	// Resolves to LoadSucceeded, LoadFailed or LoadCanceled
+	std::shared_future<LoadState> GetFuture() const { return m_future; }
+
+	// Runs when the node finishes, or immediately if it already has
+	void AddCompletionCallback(std::function<void(LoadState)> callback);
+
+	// Applies to the whole subtree.  Texture leaves hand it to the mip streamer, so e.g. materials
+	// visible to the camera stream their detail in first.  Shared nodes keep the last value set.
+	void SetPriority(float priority);
+	float GetPriority() const { return m_priority; }
+
+	// Cancels this node along with any dependency that no unfinished node still needs.  Reads that
+	// are already in flight complete, but their results no longer count.
+	void Cancel();
+
+private:
+	LoadState AttachParent(std::weak_ptr<LoadNode> parent);
+	bool HasLiveParent();
+	void OnDependencyFinished(LoadState state);
+	void Finish(LoadState state);
+
+private:
+	const std::string						m_name;
+	std::atomic<LoadState>					m_loadState;
+	std::atomic<float>						m_priority{ 0.0f };
+
+	std::mutex								m_mutex;
+	std::vector<std::shared_ptr<LoadNode>>	m_dependencies;
+	std::vector<std::weak_ptr<LoadNode>>	m_parents;
+	uint32_t								m_pendingDependencies{ 0 };
+	bool									m_workPending{ true };
+	bool									m_failed{ false };
+	std::vector<std::function<void(LoadState)>>	m_callbacks;
+
+	// Leaves only
+	std::shared_ptr<IAsyncResource>			m_resource;
+
+	std::promise<LoadState>					m_promise;
+	std::shared_future<LoadState>			m_future;
+};
+
+} // namespace Kodiak
\ No newline at end of file
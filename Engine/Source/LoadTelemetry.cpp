@@ -0,0 +1,284 @@
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+// Author: David Elder
+//
+
+#include "Stdafx.h"
+
+#include "LoadTelemetry.h"
+
+#include "Paths.h"
+
+#include <iomanip>
+
+
+using namespace Kodiak;
+using namespace std;
+
+
+namespace
+{
+
+const char* s_phaseNames[] = { "queue", "io", "parse", "process", "upload" };
+
+const double s_bytesPerMegabyte = 1024.0 * 1024.0;
+
+
+string EscapeJson(const string& str)
+{
+	string ret;
+	ret.reserve(str.size());
+
+	for (char c : str)
+	{
+		switch (c)
+		{
+		case '"':	ret += "\\\""; break;
+		case '\\':	ret += "\\\\"; break;
+		case '\n':	ret += "\\n"; break;
+		case '\t':	ret += "\\t"; break;
+		default:	ret += c; break;
+		}
+	}
+	return ret;
+}
+
+
+string ThreadIdToString(thread::id id)
+{
+	ostringstream stream;
+	stream << id;
+	return stream.str();
+}
+
+
+// Time from the first load starting (or being queued) to the last one finishing
+double ComputeWallSeconds(const vector<LoadRecord>& records)
+{
+	if (records.empty())
+	{
+		return 0.0;
+	}
+
+	auto firstTime = (LoadRecord::Clock::time_point::max)();
+	auto lastTime = (LoadRecord::Clock::time_point::min)();
+
+	for (const auto& record : records)
+	{
+		auto startTime = (record.queuedTime != LoadRecord::Clock::time_point()) ? record.queuedTime : record.startTime;
+		firstTime = std::min<LoadRecord::Clock::time_point>(firstTime, startTime);
+		lastTime = std::max<LoadRecord::Clock::time_point>(lastTime, record.endTime);
+	}
+
+	chrono::duration<double> elapsed = lastTime - firstTime;
+	return elapsed.count();
+}
+
+} // anonymous namespace
+
+
+void LoadTelemetry::OnQueued(LoadRecord& record)
+{
+	if (!m_enabled)
+	{
+		return;
+	}
+
+	record.active = true;
+	record.queuedTime = LoadRecord::Clock::now();
+	++m_outstandingLoads;
+}
+
+
+void LoadTelemetry::BeginLoad(LoadRecord& record, const string& path)
+{
+	if (!record.active)
+	{
+		// Synchronous loads skip the queue
+		if (!m_enabled)
+		{
+			return;
+		}
+		record.active = true;
+		++m_outstandingLoads;
+	}
+
+	record.path = path;
+	record.threadId = this_thread::get_id();
+	record.startTime = LoadRecord::Clock::now();
+
+	if (record.queuedTime != LoadRecord::Clock::time_point())
+	{
+		chrono::duration<double, milli> queueTime = record.startTime - record.queuedTime;
+		record.phaseMilliseconds[static_cast<size_t>(LoadPhase::Queue)] = queueTime.count();
+	}
+}
+
+
+void LoadTelemetry::EndLoad(LoadRecord& record, bool succeeded)
+{
+	if (!record.active)
+	{
+		return;
+	}
+
+	record.endTime = LoadRecord::Clock::now();
+	record.succeeded = succeeded;
+	record.active = false;
+
+	chrono::duration<double, milli> totalTime = record.endTime - record.startTime;
+	record.totalMilliseconds = totalTime.count() + record.phaseMilliseconds[static_cast<size_t>(LoadPhase::Queue)];
+
+	{
+		lock_guard<mutex> CS(m_mutex);
+		m_records.push_back(record);
+	}
+
+	if (--m_outstandingLoads == 0 && m_reportRequested.exchange(false))
+	{
+		EmitReport();
+	}
+}
+
+
+vector<LoadRecord> LoadTelemetry::GetRecords() const
+{
+	lock_guard<mutex> CS(m_mutex);
+	return m_records;
+}
+
+
+void LoadTelemetry::Reset()
+{
+	lock_guard<mutex> CS(m_mutex);
+	m_records.clear();
+}
+
+
+string LoadTelemetry::BuildJsonReport() const
+{
+	auto records = GetRecords();
+
+	uint64_t totalBytes = 0;
+	for (const auto& record : records)
+	{
+		totalBytes += record.bytesRead;
+	}
+	const double wallSeconds = ComputeWallSeconds(records);
+
+	ostringstream json;
+	json << fixed << setprecision(3);
+
+	json << "{\n";
+	json << "\t\"assetCount\": " << records.size() << ",\n";
+	json << "\t\"totalBytes\": " << totalBytes << ",\n";
+	json << "\t\"wallSeconds\": " << wallSeconds << ",\n";
+	json << "\t\"megabytesPerSecond\": " << ((wallSeconds > 0.0) ? (totalBytes / s_bytesPerMegabyte) / wallSeconds : 0.0) << ",\n";
+	json << "\t\"assets\": [\n";
+
+	for (size_t i = 0; i < records.size(); ++i)
+	{
+		const auto& record = records[i];
+
+		json << "\t\t{ \"path\": \"" << EscapeJson(record.path) << "\"";
+		json << ", \"succeeded\": " << (record.succeeded ? "true" : "false");
+		json << ", \"thread\": \"" << ThreadIdToString(record.threadId) << "\"";
+		json << ", \"bytes\": " << record.bytesRead;
+		json << ", \"totalMs\": " << record.totalMilliseconds;
+		for (size_t phase = 0; phase < static_cast<size_t>(LoadPhase::NumPhases); ++phase)
+		{
+			json << ", \"" << s_phaseNames[phase] << "Ms\": " << record.phaseMilliseconds[phase];
+		}
+		json << " }" << ((i + 1 < records.size()) ? ",\n" : "\n");
+	}
+
+	json << "\t]\n";
+	json << "}\n";
+
+	return json.str();
+}
+
+
+string LoadTelemetry::BuildSummary(size_t slowestCount) const
+{
+	auto records = GetRecords();
+
+	uint64_t totalBytes = 0;
+	array<double, static_cast<size_t>(LoadPhase::NumPhases)> phaseTotals{};
+	for (const auto& record : records)
+	{
+		totalBytes += record.bytesRead;
+		for (size_t phase = 0; phase < phaseTotals.size(); ++phase)
+		{
+			phaseTotals[phase] += record.phaseMilliseconds[phase];
+		}
+	}
+	const double wallSeconds = ComputeWallSeconds(records);
+	const double totalMegabytes = totalBytes / s_bytesPerMegabyte;
+
+	ostringstream summary;
+	summary << fixed << setprecision(2);
+
+	summary << "Load report: " << records.size() << " assets, " << totalMegabytes << " MB in " << wallSeconds << " s";
+	summary << " (" << ((wallSeconds > 0.0) ? totalMegabytes / wallSeconds : 0.0) << " MB/s)\n";
+	summary << "  Summed over all threads:";
+	for (size_t phase = 0; phase < phaseTotals.size(); ++phase)
+	{
+		summary << " " << s_phaseNames[phase] << " " << phaseTotals[phase] << " ms";
+	}
+	summary << "\n";
+
+	slowestCount = std::min<size_t>(slowestCount, records.size());
+	partial_sort(begin(records), begin(records) + slowestCount, end(records),
+		[](const LoadRecord& a, const LoadRecord& b) { return a.totalMilliseconds > b.totalMilliseconds; });
+
+	summary << "  Slowest " << slowestCount << ":\n";
+	for (size_t i = 0; i < slowestCount; ++i)
+	{
+		const auto& record = records[i];
+
+		summary << "    " << setw(9) << record.totalMilliseconds << " ms";
+		for (size_t phase = 0; phase < phaseTotals.size(); ++phase)
+		{
+			summary << "  " << s_phaseNames[phase] << " " << record.phaseMilliseconds[phase];
+		}
+		summary << "  " << (record.bytesRead / s_bytesPerMegabyte) << " MB";
+		summary << "  thread " << ThreadIdToString(record.threadId);
+		summary << "  " << record.path << (record.succeeded ? "" : " (failed)") << "\n";
+	}
+
+	return summary.str();
+}
+
+
+void LoadTelemetry::EmitReport(size_t slowestCount) const
+{
+	LOG_INFO << BuildSummary(slowestCount);
+
+	string fullPath = Paths::GetInstance().LogDir() + "LoadReport.json";
+	ofstream file(fullPath, ios::out | ios::trunc);
+	if (file)
+	{
+		file << BuildJsonReport();
+	}
+	else
+	{
+		LOG_WARNING << "Failed to write load report to " << fullPath;
+	}
+}
+
+
+void LoadTelemetry::RequestReport()
+{
+	m_reportRequested = true;
+
+	// Nothing in flight, so there's nothing to wait for
+	if (m_outstandingLoads == 0 && m_reportRequested.exchange(false))
+	{
+		EmitReport();
+	}
+}
\ No newline at end of file
@@ -0,0 +1,162 @@
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+// Author: David Elder
+//
+
+#pragma once
+
+// Per-asset load timings.  Compiled in with profiling by default; define LOAD_TELEMETRY=0 or 1 to
+// override.  When compiled out the macros below expand to nothing, and IAsyncResource carries no
+// record.
+
+#if !defined(LOAD_TELEMETRY)
+#if defined(PROFILING) && (PROFILING == 1)
+#define LOAD_TELEMETRY 1
+#else
+#define LOAD_TELEMETRY 0
+#endif
+#endif
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace Kodiak
+{
+
+enum class LoadPhase
+{
+	Queue,		// Waiting for a loader thread
+	IO,			// Reading from disk
+	Parse,		// Header parsing, shader reflection
+	Process,	// CPU work on loaded data, such as generating missing mips
+	Upload,		// Creating device objects and copying data to them
+
+	NumPhases
+};
+
+
+struct LoadRecord
+{
+	typedef std::chrono::high_resolution_clock Clock;
+
+	std::string		path;
+	std::array<double, static_cast<size_t>(LoadPhase::NumPhases)> phaseMilliseconds{};
+	double			totalMilliseconds{ 0.0 };
+	uint64_t		bytesRead{ 0 };
+	std::thread::id	threadId;
+	bool			succeeded{ false };
+
+	// Set while the load is being recorded
+	bool			active{ false };
+
+	Clock::time_point	queuedTime;
+	Clock::time_point	startTime;
+	Clock::time_point	endTime;
+};
+
+
+// Adds the time until it goes out of scope to one phase of a load
+class LoadPhaseTimer
+{
+public:
+	LoadPhaseTimer(LoadRecord& record, LoadPhase phase)
+		: m_record(record)
+		, m_phase(phase)
+	{
+		if (m_record.active)
+		{
+			m_startTime = LoadRecord::Clock::now();
+		}
+	}
+
+	~LoadPhaseTimer()
+	{
+		if (m_record.active)
+		{
+			std::chrono::duration<double, std::milli> elapsed = LoadRecord::Clock::now() - m_startTime;
+			m_record.phaseMilliseconds[static_cast<size_t>(m_phase)] += elapsed.count();
+		}
+	}
+
+private:
+	LoadRecord&						m_record;
+	const LoadPhase					m_phase;
+	LoadRecord::Clock::time_point	m_startTime;
+};
+
+
+class LoadTelemetry
+{
+public:
+	static LoadTelemetry& GetInstance()
+	{
+		static LoadTelemetry instance;
+		return instance;
+	}
+
+	// Runtime switch, on top of the LOAD_TELEMETRY compile-time one
+	bool IsEnabled() const { return m_enabled; }
+	void SetEnabled(bool enabled) { m_enabled = enabled; }
+
+	// Called by the ResourceLoader around each load
+	void OnQueued(LoadRecord& record);
+	void BeginLoad(LoadRecord& record, const std::string& path);
+	void EndLoad(LoadRecord& record, bool succeeded);
+
+	std::vector<LoadRecord> GetRecords() const;
+	void Reset();
+
+	std::string BuildJsonReport() const;
+	std::string BuildSummary(size_t slowestCount = 10) const;
+
+	// Logs the summary and writes the JSON report to the log directory
+	void EmitReport(size_t slowestCount = 10) const;
+
+	// Emits the report as soon as every load started so far has finished
+	void RequestReport();
+
+private:
+	LoadTelemetry() = default;
+
+private:
+	std::atomic<bool>		m_enabled{ true };
+	std::atomic<uint32_t>	m_outstandingLoads{ 0 };
+	std::atomic<bool>		m_reportRequested{ false };
+
+	mutable std::mutex		m_mutex;
+	std::vector<LoadRecord>	m_records;
+};
+
+} // namespace Kodiak
+
+
+#if LOAD_TELEMETRY
+
+#define LOAD_TELEMETRY_QUEUED(resource) ::Kodiak::LoadTelemetry::GetInstance().OnQueued((resource).GetLoadRecord())
+#define LOAD_TELEMETRY_BEGIN(resource) ::Kodiak::LoadTelemetry::GetInstance().BeginLoad((resource).GetLoadRecord(), (resource).GetResourcePath())
+#define LOAD_TELEMETRY_END(resource) ::Kodiak::LoadTelemetry::GetInstance().EndLoad((resource).GetLoadRecord(), (resource).IsReady())
+#define LOAD_TELEMETRY_REPORT() ::Kodiak::LoadTelemetry::GetInstance().RequestReport()
+
+// For use inside IAsyncResource subclasses.  One LOAD_PHASE per scope.
+#define LOAD_PHASE(phase) ::Kodiak::LoadPhaseTimer _loadPhaseTimer(m_loadRecord, phase)
+#define LOAD_BYTES(bytes) m_loadRecord.bytesRead += (bytes)
+
+#else
+
+#define LOAD_TELEMETRY_QUEUED(resource) __noop
+#define LOAD_TELEMETRY_BEGIN(resource) __noop
+#define LOAD_TELEMETRY_END(resource) __noop
+#define LOAD_TELEMETRY_REPORT() __noop
+#define LOAD_PHASE(phase) __noop
+#define LOAD_BYTES(bytes) __noop
+
+#endif
\ No newline at end of file
@@ -17,7 +17,8 @@ enum class LoadState
 	LoadNotStarted,
 	Loading,
 	LoadFailed,
-	LoadSucceeded
+	LoadSucceeded,
+	LoadCanceled	// Load graph nodes only
 };
 
 } // namespace Kodiak
\ No newline at end of file
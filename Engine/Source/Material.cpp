@@ -19,6 +19,7 @@ using namespace std;
 static const uint32_t	s_perViewConstantsSlot = 0;
 static const uint32_t	s_perObjectConstantsSlot = 1;
 static const uint32_t	s_perMaterialConstantsSlot = 2;
+static const uint32_t	s_bindlessTextureSpace = 1;
 static const string		s_perViewConstantsName{ "PerViewConstants" };
 static const string		s_perObjectConstantsName{ "PerObjectConstants" };
 static const string		s_perMaterialConstantsName{ "PerMaterialConstants" };
@@ -29,6 +30,7 @@ namespace Kodiak
 uint32_t GetPerViewConstantsSlot() { return s_perViewConstantsSlot; }
 uint32_t GetPerObjectConstantsSlot() { return s_perObjectConstantsSlot; }
 uint32_t GetPerMaterialConstantsSlot() { return s_perMaterialConstantsSlot; }
+uint32_t GetBindlessTextureSpace() { return s_bindlessTextureSpace; }
 const string& GetPerViewConstantsName() { return s_perViewConstantsName; }
 const string& GetPerObjectConstantsName() {	return s_perObjectConstantsName; }
 const string& GetPerMaterialConstantsName() { return s_perMaterialConstantsName; }
@@ -16,6 +16,7 @@ namespace Kodiak
 uint32_t GetPerViewConstantsSlot();
 uint32_t GetPerObjectConstantsSlot();
 uint32_t GetPerMaterialConstantsSlot();
+uint32_t GetBindlessTextureSpace();
 const std::string& GetPerViewConstantsName();
 const std::string& GetPerObjectConstantsName();
 const std::string& GetPerMaterialConstantsName();
@@ -40,78 +40,102 @@ Material::Material(const string& name)
 void Material::SetEffect(shared_ptr<Effect> effect)
 {
 	assert(effect);
-	assert(effect->IsFinalized());
 
 	m_effect = effect;
 
-	CreateRenderThreadData();
+	// A new effect replaces everything an instance would have copied from its parent
+	{
+		lock_guard<recursive_mutex> CS(m_instanceLock);
+		m_parent.reset();
+		m_sharesParent = false;
+	}
+
+	if (effect->IsFinalized())
+	{
+		m_effectPending = false;
+		CreateRenderThreadData();
+		return;
+	}
+
+	// Meshes can take the render thread data now, but draws skip it until the effect is finalized and
+	// the data is set up
+	m_effectPending = true;
+	auto materialData = make_shared<RenderThread::MaterialData>();
+	materialData->renderPass = m_renderPass;
+	materialData->isEffectReady = false;
+	atomic_store(&m_renderThreadData, materialData);
+
+	weak_ptr<Material> weakThis = shared_from_this();
+	effect->AddFinalizedCallback([weakThis, materialData]()
+	{
+		// Skip it if the effect was replaced in the meantime
+		auto thisMaterial = weakThis.lock();
+		if (thisMaterial && thisMaterial->GetRenderThreadData() == materialData)
+		{
+			// The render thread may be checking the placeholder meshes hold, so the real data is set up off to
+			// the side, and only handed to it by the same command that marks the effect ready
+			auto readyData = make_shared<RenderThread::MaterialData>();
+			thisMaterial->SetupRenderThreadData(readyData);
+			atomic_store(&thisMaterial->m_renderThreadData, readyData);
+			thisMaterial->m_effectPending = false;
+
+			EnqueueRenderCommand([materialData, readyData]()
+			{
+				materialData->parent = readyData;
+				materialData->isEffectReady = true;
+			});
+		}
+	});
+
+	effect->FinalizeAsync();
 }
 
 
 void Material::SetRenderPass(shared_ptr<RenderPass> pass)
 {
 	m_renderPass = pass;
-	if (m_renderThreadData)
+	if (auto materialData = GetRenderThreadData())
 	{
-		m_renderThreadData->renderPass = pass;
+		materialData->renderPass = pass;
 	}
 }
 
 
-shared_ptr<MaterialParameter> Material::GetParameter(const string& name)
+shared_ptr<MaterialParameter> Material::GetParameter(ParamId id)
 {
-	lock_guard<mutex> CS(m_parameterLock);
+	CopyOnWrite();
 
-	auto it = m_parameters.find(name);
-	if (end(m_parameters) != it)
-	{
-		return it->second;
-	}
-
-	auto parameter = make_shared<MaterialParameter>(name);
-	m_parameters[name] = parameter;
-
-	return parameter;
+	lock_guard<mutex> CS(m_parameterLock);
+	return m_parameters.FindOrCreate(id);
 }
 
 
-shared_ptr<MaterialResource> Material::GetResource(const string& name)
+shared_ptr<MaterialResource> Material::GetResource(ParamId id)
 {
-	lock_guard<mutex> CS(m_resourceLock);
-
-	auto it = m_resources.find(name);
-	if (end(m_resources) != it)
-	{
-		return it->second;
-	}
-
-	auto resource = make_shared<MaterialResource>(name);
-	m_resources[name] = resource;
+	CopyOnWrite();
 
-	return resource;
+	lock_guard<mutex> CS(m_resourceLock);
+	return m_resources.FindOrCreate(id);
 }
 
 
-shared_ptr<MaterialConstantBuffer> Material::GetConstantBuffer(const string& name)
+shared_ptr<MaterialConstantBuffer> Material::GetConstantBuffer(ParamId id)
 {
-	lock_guard<mutex> CR(m_constantBufferLock);
-
-	auto it = m_constantBuffers.find(name);
-	if (end(m_constantBuffers) != it)
-	{
-		return it->second;
-	}
+	CopyOnWrite();
 
-	auto cbuffer = make_shared<MaterialConstantBuffer>(name);
-	m_constantBuffers[name] = cbuffer;
-
-	return cbuffer;
+	lock_guard<mutex> CR(m_constantBufferLock);
+	return m_constantBuffers.FindOrCreate(id);
 }
 
 
 void Material::SetResource(const string& name, shared_ptr<Texture> texture)
 {
-	m_textures[name] = texture;
+	CopyOnWrite();
+
+	{
+		lock_guard<mutex> CS(m_textureLock);
+		m_textures[name] = texture;
+	}
 
 	auto resource = GetResource(name);
 	resource->SetSRV(*texture);
@@ -130,6 +154,78 @@ shared_ptr<Material> Material::Clone()
 }
 
 
+shared_ptr<Material> Material::CreateInstance()
+{
+	shared_ptr<Material> parent;
+	{
+		lock_guard<recursive_mutex> CS(m_instanceLock);
+
+		// An instance that hasn't been written to has no data of its own, so share its parent instead
+		parent = m_parent ? m_parent : shared_from_this();
+	}
+
+	auto parentData = parent->GetRenderThreadData();
+	assert(parentData);
+
+	// Until the parent is set up there's nothing to share
+	if (parent->m_effectPending)
+	{
+		return Clone();
+	}
+
+	auto instance = make_shared<Material>(m_name);
+	instance->m_effect = parent->m_effect;
+	instance->m_renderPass = m_renderPass;
+	instance->m_parent = parent;
+	instance->m_sharesParent = true;
+
+	instance->m_renderThreadData = make_shared<RenderThread::MaterialData>();
+	instance->m_renderThreadData->renderPass = m_renderPass;
+	instance->m_renderThreadData->parent = parentData;
+
+	return instance;
+}
+
+
+void Material::CopyOnWrite()
+{
+	if (!m_sharesParent)
+	{
+		return;
+	}
+
+	// Other threads wait here until the copy is done.  The Get* calls made while setting up land back
+	// here on this thread, and return since m_parent is already cleared.
+	lock_guard<recursive_mutex> CS(m_instanceLock);
+
+	auto parent = move(m_parent);
+	if (!parent)
+	{
+		return;
+	}
+
+	{
+		lock_guard<mutex> parentCS(parent->m_textureLock);
+		lock_guard<mutex> CS(m_textureLock);
+		m_textures = parent->m_textures;
+	}
+
+	// Meshes hold the shared data, and the render thread is drawing with it, so this instance's own data
+	// is set up off to the side.  The render thread only sees it once the command below swaps it in.
+	auto sharedData = GetRenderThreadData();
+	auto ownData = make_shared<RenderThread::MaterialData>();
+	SetupRenderThreadData(ownData);
+	atomic_store(&m_renderThreadData, ownData);
+
+	EnqueueRenderCommand([sharedData, ownData]()
+	{
+		sharedData->SwapInOwnData(ownData);
+	});
+
+	m_sharesParent = false;
+}
+
+
 // Helper functions for setting up render-thread material data
 namespace
 {
@@ -152,7 +248,7 @@ void SetupCBuffer(RenderThread::MaterialData& materialData, size_t cbufferSizeIn
 
 
 void SetupBinding(Material* material, RenderThread::MaterialData::CBufferBinding& binding, ID3D11Buffer* d3dBuffer, 
-	const vector<ShaderReflection::CBVLayout>& effectCBuffers, uint32_t index)
+	byte* baseDestination, const vector<ShaderReflection::CBVLayout>& effectCBuffers, uint32_t index)
 {
 	uint32_t minSlot = D3D11_COMMONSHADER_CONSTANT_BUFFER_API_SLOT_COUNT;
 	uint32_t numBuffers = static_cast<uint32_t>(effectCBuffers.size());
@@ -170,9 +266,6 @@ void SetupBinding(Material* material, RenderThread::MaterialData::CBufferBinding
 			minSlot = min(minSlot, effectCBuffer.shaderRegister);
 		}
 
-		auto materialData = material->GetRenderThreadData();
-		byte* baseDestination = materialData->cbufferData;
-
 		// Fill out the cbuffer binding record
 		for (const auto& effectCBuffer : effectCBuffers)
 		{
@@ -201,21 +294,28 @@ void SetupShaderCBufferBindings(Material* material, RenderThread::MaterialData&
 	const auto& effectCBuffers = effectSig.cbvBindings[index];
 
 	auto d3dBuffer = materialData.cbuffer->constantBuffer.Get();
-	SetupBinding(material, binding, d3dBuffer, effectCBuffers, index);
+	SetupBinding(material, binding, d3dBuffer, materialData.cbufferData, effectCBuffers, index);
 }
 
 } // anonymous namespace
 
 
 void Material::CreateRenderThreadData()
+{
+	auto materialData = make_shared<RenderThread::MaterialData>();
+	SetupRenderThreadData(materialData);
+	atomic_store(&m_renderThreadData, materialData);
+}
+
+
+void Material::SetupRenderThreadData(const shared_ptr<RenderThread::MaterialData>& renderThreadData)
 {
 	const auto& effectSig = m_effect->GetSignature();
 
-	m_renderThreadData = make_shared<RenderThread::MaterialData>();
-	m_renderThreadData->renderPass = m_renderPass;
-	m_renderThreadData->pso = m_effect->GetPSO();
+	auto& materialData = *renderThreadData;
 
-	auto& materialData = *m_renderThreadData;
+	materialData.renderPass = m_renderPass;
+	materialData.pso = m_effect->GetPSO();
 
 	// Setup the DX11 cbuffer and bindings per shader stage
 	materialData.cbufferSize = effectSig.cbvPerMaterialDataSize;
@@ -228,6 +328,31 @@ void Material::CreateRenderThreadData()
 		SetupShaderCBufferBindings(this, materialData, effectSig, ShaderType::Hull);
 		SetupShaderCBufferBindings(this, materialData, effectSig, ShaderType::Geometry);
 		SetupShaderCBufferBindings(this, materialData, effectSig, ShaderType::Pixel);
+
+		// Record the variables in each cbuffer, for validating SetConstantsImmediate
+		for (const auto& parameter : effectSig.parameters)
+		{
+			for (uint32_t i = 0; i < 5; ++i)
+			{
+				if (parameter.second.byteOffset[i] == kInvalid)
+				{
+					continue;
+				}
+
+				for (const auto& cbv : effectSig.cbvBindings[i])
+				{
+					if (cbv.shaderRegister == parameter.second.cbvShaderRegister[i])
+					{
+						ShaderReflection::CBVMember member;
+						member.name = parameter.second.name;
+						member.byteOffset = parameter.second.byteOffset[i] - cbv.byteOffset;
+						member.sizeInBytes = parameter.second.sizeInBytes;
+						GetConstantBuffer(cbv.name)->AddMember(member);
+						break;
+					}
+				}
+			}
+		}
 	}
 	
 	// Table bindings
@@ -242,7 +367,7 @@ void Material::CreateRenderThreadData()
 			layout.resources.reserve(layout.numItems);
 			layout.resources.insert(layout.resources.end(), layout.numItems, nullptr);
 
-			m_renderThreadData->srvTables[i].layouts.push_back(layout);
+			materialData.srvTables[i].layouts.push_back(layout);
 		}
 
 		// UAV tables
@@ -254,7 +379,7 @@ void Material::CreateRenderThreadData()
 			layout.resources.reserve(layout.numItems);
 			layout.resources.insert(layout.resources.end(), layout.numItems, nullptr);
 
-			m_renderThreadData->uavTables[i].layouts.push_back(layout);
+			materialData.uavTables[i].layouts.push_back(layout);
 		}
 
 		// Sampler tables
@@ -266,7 +391,7 @@ void Material::CreateRenderThreadData()
 			layout.resources.reserve(layout.numItems);
 			layout.resources.insert(layout.resources.end(), layout.numItems, nullptr);
 
-			m_renderThreadData->samplerTables[i].layouts.push_back(layout);
+			materialData.samplerTables[i].layouts.push_back(layout);
 		}
 	}
 	
@@ -274,21 +399,21 @@ void Material::CreateRenderThreadData()
 	for (const auto& parameter : effectSig.parameters)
 	{
 		auto materialParameter = GetParameter(parameter.second.name);
-		materialParameter->CreateRenderThreadData(m_renderThreadData, parameter.second);
+		materialParameter->CreateRenderThreadData(renderThreadData, parameter.second);
 	}
 
 	// Resource SRVs
 	for (const auto& resource : effectSig.srvs)
 	{
 		auto materialResource = GetResource(resource.second.name);
-		materialResource->CreateRenderThreadData(m_renderThreadData, resource.second);
+		materialResource->CreateRenderThreadData(renderThreadData, resource.second);
 	}
 
 	// Resource UAVs
 	for (const auto& uav : effectSig.uavs)
 	{
 		auto materialUAV = GetResource(uav.second.name);
-		materialUAV->CreateRenderThreadData(m_renderThreadData, uav.second);
+		materialUAV->CreateRenderThreadData(renderThreadData, uav.second);
 	}
 
 	// TODO: Samplers
@@ -297,6 +422,17 @@ void Material::CreateRenderThreadData()
 
 void RenderThread::MaterialData::Update(GraphicsCommandList& commandList)
 {
+	if (!isEffectReady)
+	{
+		return;
+	}
+
+	if (parent)
+	{
+		parent->Update(commandList);
+		return;
+	}
+
 	if (cbufferDirty && cbufferSize > 0)
 	{
 		auto dest = commandList.MapConstants(*cbuffer);
@@ -310,6 +446,12 @@ void RenderThread::MaterialData::Update(GraphicsCommandList& commandList)
 
 void RenderThread::MaterialData::Commit(GraphicsCommandList& commandList)
 {
+	if (parent)
+	{
+		parent->Commit(commandList);
+		return;
+	}
+
 	// Set the PSO for this material
 	commandList.SetPipelineState(*pso);
 
@@ -409,4 +551,35 @@ void RenderThread::MaterialData::Commit(GraphicsCommandList& commandList)
 	{
 		commandList.SetPixelShaderResources(layout.shaderRegister, layout.numItems, &layout.resources[0]);
 	}
+}
+
+
+void RenderThread::MaterialData::SwapInOwnData(shared_ptr<MaterialData> ownData)
+{
+	// The tables have the same layouts, since both were set up from the same effect
+	if (ownData->cbufferSize > 0)
+	{
+		memcpy(ownData->cbufferData, parent->cbufferData, ownData->cbufferSize);
+		ownData->cbufferDirty = true;
+	}
+
+	for (uint32_t i = 0; i < 5; ++i)
+	{
+		for (size_t j = 0; j < ownData->srvTables[i].layouts.size(); ++j)
+		{
+			ownData->srvTables[i].layouts[j].resources = parent->srvTables[i].layouts[j].resources;
+		}
+
+		for (size_t j = 0; j < ownData->uavTables[i].layouts.size(); ++j)
+		{
+			ownData->uavTables[i].layouts[j].resources = parent->uavTables[i].layouts[j].resources;
+		}
+
+		for (size_t j = 0; j < ownData->samplerTables[i].layouts.size(); ++j)
+		{
+			ownData->samplerTables[i].layouts[j].resources = parent->samplerTables[i].layouts[j].resources;
+		}
+	}
+
+	parent = move(ownData);
 }
\ No newline at end of file
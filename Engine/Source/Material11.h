@@ -9,6 +9,7 @@
 
 #pragma once
 
+#include "ParamId.h"
 #include <ppltasks.h>
 
 namespace Kodiak
@@ -44,21 +45,32 @@ public:
 	void SetName(const std::string& name) { m_name = name; }
 	const std::string& GetName() const { return m_name; }
 
+	// An effect that isn't finalized yet is finalized in the background, and the material is set up once
+	// it is.  Until then its draws are skipped.
 	void SetEffect(std::shared_ptr<Effect> effect);
 	void SetRenderPass(std::shared_ptr<RenderPass> pass);
 
-	std::shared_ptr<MaterialParameter> GetParameter(const std::string& name);
-	std::shared_ptr<MaterialResource> GetResource(const std::string& name);
-	std::shared_ptr<MaterialConstantBuffer> GetConstantBuffer(const std::string& name);
+	std::shared_ptr<MaterialParameter> GetParameter(ParamId id);
+	std::shared_ptr<MaterialResource> GetResource(ParamId id);
+	std::shared_ptr<MaterialConstantBuffer> GetConstantBuffer(ParamId id);
 
 	void SetResource(const std::string& name, std::shared_ptr<Texture> texture);
 
-	std::shared_ptr<RenderThread::MaterialData> GetRenderThreadData() { return m_renderThreadData; }
+	// Safe to call from any thread, while the effect's finalized callback replaces the data
+	std::shared_ptr<RenderThread::MaterialData> GetRenderThreadData() const { return std::atomic_load(&m_renderThreadData); }
 
+	// Copies the effect and render pass, but none of the parameter values
 	std::shared_ptr<Material> Clone();
 
+	// Returns a material that draws with this one's parameters and resources, without a cbuffer of its
+	// own, until one of its parameters, resources or cbuffers is first requested.  It then takes a copy
+	// of this material's current state, and no longer follows changes to it.
+	std::shared_ptr<Material> CreateInstance();
+
 private:
+	void CopyOnWrite();
 	void CreateRenderThreadData();
+	void SetupRenderThreadData(const std::shared_ptr<RenderThread::MaterialData>& renderThreadData);
 
 private:
 	std::string						m_name;
@@ -67,17 +79,28 @@ private:
 	std::shared_ptr<RenderPass>		m_renderPass;
 
 	std::mutex													m_parameterLock;
-	std::map<std::string, std::shared_ptr<MaterialParameter>>	m_parameters;
+	ParamIdMap<MaterialParameter>								m_parameters;
 
 	std::mutex													m_resourceLock;
-	std::map<std::string, std::shared_ptr<MaterialResource>>	m_resources;
+	ParamIdMap<MaterialResource>								m_resources;
 
 	std::mutex														m_constantBufferLock;
-	std::map<std::string, std::shared_ptr<MaterialConstantBuffer>>	m_constantBuffers;
+	ParamIdMap<MaterialConstantBuffer>								m_constantBuffers;
 
+	// SetResource runs on loader threads while instances copy the textures
+	std::mutex													m_textureLock;
 	std::map<std::string, std::shared_ptr<Texture>>				m_textures;
 
+	// Only replaced through std::atomic_store, once the new data is set up
 	std::shared_ptr<RenderThread::MaterialData>					m_renderThreadData;
+
+	// Set while waiting on the effect to be finalized
+	std::atomic<bool>											m_effectPending{ false };
+
+	// Set on instances until their first write
+	std::recursive_mutex										m_instanceLock;
+	std::shared_ptr<Material>									m_parent;
+	std::atomic<bool>											m_sharesParent{ false };
 };
 
 
@@ -93,10 +116,24 @@ struct MaterialData
 
 	void Update(GraphicsCommandList& commandList);
 	void Commit(GraphicsCommandList& commandList);
-	bool IsReady() { return true; }
+	bool IsReady() { return isEffectReady; }
+	bool IsPipelineReady() { return isEffectReady; }
+
+	// Runs on the render thread, once an instance's own data is set up.  Copies the parent's current constants
+	// and tables into it, and draws through this data go to it from then on.
+	void SwapInOwnData(std::shared_ptr<MaterialData> ownData);
+
+	// Draws go to this data when it's set.  Instances start out on their parent's, and move to their own after
+	// their first write (see Material::CopyOnWrite).  Materials waiting on their effect move to the data set up
+	// once it's finalized (see Material::SetEffect).
+	std::shared_ptr<MaterialData>	parent;
+
+	// Cleared while the material waits on its effect, since none of the data below is set up yet
+	bool							isEffectReady{ true };
 
-	// Render pass
+	// Render pass.  Read it through GetRenderPass, which follows parent.
 	std::shared_ptr<RenderPass>		renderPass;
+	const std::shared_ptr<RenderPass>& GetRenderPass() const { return parent ? parent->GetRenderPass() : renderPass; }
 
 	// PSO
 	std::shared_ptr<GraphicsPSO>	pso;
@@ -11,14 +11,18 @@
 
 #include "Material.h"
 
+#include "BindlessDescriptorHeap12.h"
 #include "Effect.h"
 #include "CommandList12.h"
 #include "MaterialConstantBuffer.h"
 #include "MaterialParameter.h"
 #include "MaterialResource12.h"
+#include "Renderer.h"
 #include "RenderPass.h"
 #include "RootSignature12.h"
 #include "Texture.h"
+#include "TextureResource.h"
+#include "TextureStreamer.h"
 
 
 using namespace Kodiak;
@@ -37,100 +41,225 @@ Material::Material(const string& name)
 void Material::SetEffect(shared_ptr<Effect> effect)
 {
 	assert(effect);
-	assert(effect->IsFinalized());
 
 	m_effect = effect;
 
-	CreateRenderThreadData();
+	// A new effect replaces everything an instance would have copied from its parent
+	{
+		lock_guard<recursive_mutex> CS(m_instanceLock);
+		m_parent.reset();
+		m_sharesParent = false;
+	}
+
+	if (effect->IsFinalized())
+	{
+		m_effectPending = false;
+		CreateRenderThreadData();
+		return;
+	}
+
+	// Meshes can take the render thread data now, but draws skip it until the effect is finalized and
+	// the data is set up
+	m_effectPending = true;
+	auto materialData = make_shared<RenderThread::MaterialData>();
+	materialData->renderPass = m_renderPass;
+	materialData->isEffectReady = false;
+	atomic_store(&m_renderThreadData, materialData);
+
+	weak_ptr<Material> weakThis = shared_from_this();
+	effect->AddFinalizedCallback([weakThis, materialData]()
+	{
+		// Skip it if the effect was replaced in the meantime
+		auto thisMaterial = weakThis.lock();
+		if (thisMaterial && thisMaterial->GetRenderThreadData() == materialData)
+		{
+			// The render thread may be checking the placeholder meshes hold, so the real data is set up off to
+			// the side, and only handed to it by the same command that marks the effect ready.  Textures set on
+			// loader threads either land before the setup lists them, or see the effect ready afterwards.
+			auto readyData = make_shared<RenderThread::MaterialData>();
+			{
+				lock_guard<recursive_mutex> CS(thisMaterial->m_textureLock);
+				thisMaterial->SetupRenderThreadData(readyData);
+				atomic_store(&thisMaterial->m_renderThreadData, readyData);
+				thisMaterial->m_effectPending = false;
+			}
+
+			EnqueueRenderCommand([materialData, readyData]()
+			{
+				materialData->parent = readyData;
+				materialData->isEffectReady = true;
+			});
+		}
+	});
+
+	effect->FinalizeAsync();
 }
 
 
 void Material::SetRenderPass(shared_ptr<RenderPass> pass)
 {
 	m_renderPass = pass;
-	if (m_renderThreadData)
+	if (auto materialData = GetRenderThreadData())
 	{
-		m_renderThreadData->renderPass = pass;
+		materialData->renderPass = pass;
 	}
 }
 
 
-shared_ptr<MaterialParameter> Material::GetParameter(const string& name)
+shared_ptr<MaterialParameter> Material::GetParameter(ParamId id)
 {
+	CopyOnWrite();
+
 	lock_guard<mutex> CS(m_parameterLock);
+	return m_parameters.FindOrCreate(id);
+}
 
-	auto it = m_parameters.find(name);
-	if (end(m_parameters) != it)
-	{
-		return it->second;
-	}
 
-	auto parameter = make_shared<MaterialParameter>(name);
-	m_parameters[name] = parameter;
+shared_ptr<MaterialResource> Material::GetResource(ParamId id)
+{
+	CopyOnWrite();
 
-	return parameter;
+	lock_guard<mutex> CS(m_resourceLock);
+	return m_resources.FindOrCreate(id);
 }
 
 
-shared_ptr<MaterialResource> Material::GetResource(const string& name)
+shared_ptr<MaterialConstantBuffer> Material::GetConstantBuffer(ParamId id)
 {
-	lock_guard<mutex> CS(m_resourceLock);
+	CopyOnWrite();
+
+	lock_guard<mutex> CS(m_constantBufferLock);
+	return m_constantBuffers.FindOrCreate(id);
+}
+
 
-	auto it = m_resources.find(name);
-	if (end(m_resources) != it)
+void Material::SetResource(const string& name, shared_ptr<Texture> texture)
+{
+	CopyOnWrite();
+
+	lock_guard<recursive_mutex> CS(m_textureLock);
+
+	m_textures[name] = texture;
+
+	if (IsBindless())
 	{
-		return it->second;
+		SetBindlessTexture(name, *texture);
 	}
+	else
+	{
+		auto resource = GetResource(name);
+		resource->SetSRV(*texture);
+	}
+
+	UpdateRenderThreadTextures();
+}
 
-	auto resource = make_shared<MaterialResource>(name);
-	m_resources[name] = resource;
 
-	return resource;
+shared_ptr<Material> Material::Clone()
+{
+	auto clone = make_shared<Material>();
+
+	clone->SetName(m_name);
+	clone->SetEffect(m_effect);
+	clone->SetRenderPass(m_renderPass);
+
+	return clone;
 }
 
 
-shared_ptr<MaterialConstantBuffer> Material::GetConstantBuffer(const string& name)
+shared_ptr<Material> Material::CreateInstance()
 {
-	lock_guard<mutex> CS(m_constantBufferLock);
+	shared_ptr<Material> parent;
+	{
+		lock_guard<recursive_mutex> CS(m_instanceLock);
+
+		// An instance that hasn't been written to has no data of its own, so share its parent instead
+		parent = m_parent ? m_parent : shared_from_this();
+	}
+
+	auto parentData = parent->GetRenderThreadData();
+	assert(parentData);
 
-	auto it = m_constantBuffers.find(name);
-	if (end(m_constantBuffers) != it)
+	// Until the parent is set up there's nothing to share
+	if (parent->m_effectPending)
 	{
-		return it->second;
+		return Clone();
 	}
 
-	auto cbuffer = make_shared<MaterialConstantBuffer>(name);
-	m_constantBuffers[name] = cbuffer;
+	auto instance = make_shared<Material>(m_name);
+	instance->m_effect = parent->m_effect;
+	instance->m_renderPass = m_renderPass;
+	instance->m_parent = parent;
+	instance->m_sharesParent = true;
+
+	instance->m_renderThreadData = make_shared<RenderThread::MaterialData>();
+	instance->m_renderThreadData->renderPass = m_renderPass;
+	instance->m_renderThreadData->parent = parentData;
 
-	return cbuffer;
+	return instance;
 }
 
 
-void Material::SetResource(const string& name, shared_ptr<Texture> texture)
+void Material::CopyOnWrite()
 {
-	m_textures[name] = texture;
+	if (!m_sharesParent)
+	{
+		return;
+	}
 
-	auto resource = GetResource(name);
-	resource->SetSRV(*texture);
-}
+	// Other threads wait here until the copy is done.  The Get* calls made while setting up land back
+	// here on this thread, and return since m_parent is already cleared.
+	lock_guard<recursive_mutex> CS(m_instanceLock);
 
+	auto parent = move(m_parent);
+	if (!parent)
+	{
+		return;
+	}
 
-shared_ptr<Material> Material::Clone()
-{
-	auto clone = make_shared<Material>();
+	// Copied first, so the setup below lists the parent's textures for the streamer
+	{
+		lock_guard<recursive_mutex> parentCS(parent->m_textureLock);
+		lock_guard<recursive_mutex> CS(m_textureLock);
+		m_textures = parent->m_textures;
+	}
 
-	clone->SetName(m_name);
-	clone->SetEffect(m_effect);
-	clone->SetRenderPass(m_renderPass);
+	// Meshes hold the shared data, and the render thread is drawing with it, so this instance's own data
+	// is set up off to the side.  The render thread only sees it once the command below swaps it in.
+	auto sharedData = GetRenderThreadData();
+	auto ownData = make_shared<RenderThread::MaterialData>();
+	SetupRenderThreadData(ownData);
+	atomic_store(&m_renderThreadData, ownData);
 
-	return clone;
+	vector<pair<uint32_t, D3D12_CPU_DESCRIPTOR_HANDLE>> cbvHandles;
+	for (const auto& cbvs : m_effect->GetSignature().cbvBindings)
+	{
+		for (const auto& cbv : cbvs)
+		{
+			cbvHandles.emplace_back(cbv.binding.tableIndex, ownData->cpuHandles[cbv.binding.tableIndex]);
+		}
+	}
+
+	EnqueueRenderCommand([sharedData, ownData, cbvHandles]()
+	{
+		sharedData->SwapInOwnData(ownData, cbvHandles);
+	});
+
+	m_sharesParent = false;
 }
 
 
 void Material::CreateRenderThreadData()
 {
-	m_renderThreadData = make_shared<RenderThread::MaterialData>();
-	RenderThread::MaterialData& materialData = *m_renderThreadData;
+	auto materialData = make_shared<RenderThread::MaterialData>();
+	SetupRenderThreadData(materialData);
+	atomic_store(&m_renderThreadData, materialData);
+}
+
+
+void Material::SetupRenderThreadData(const shared_ptr<RenderThread::MaterialData>& renderThreadData)
+{
+	RenderThread::MaterialData& materialData = *renderThreadData;
 
 	materialData.renderPass = m_renderPass;
 	materialData.pso = m_effect->GetPSO();
@@ -146,6 +275,12 @@ void Material::CreateRenderThreadData()
 	// Copy the root parameters from the effect
 	materialData.rootParameters = effectSig.rootParameters;
 
+	materialData.bindlessRootIndex = effectSig.bindlessRootIndex;
+	for (const auto& rootCbv : effectSig.rootCbvs)
+	{
+		materialData.rootCBVs.emplace_back(rootCbv.rootIndex, rootCbv.byteOffset);
+	}
+
 	// Setup constant buffers
 	materialData.constantDataSize = effectSig.cbvPerMaterialDataSize;
 	if (materialData.constantDataSize)
@@ -170,30 +305,193 @@ void Material::CreateRenderThreadData()
 				}
 			}
 		}
+
+		// Record the variables in each cbuffer, for validating SetConstantsImmediate
+		for (const auto& parameter : effectSig.parameters)
+		{
+			for (uint32_t i = 0; i < 5; ++i)
+			{
+				if (parameter.second.byteOffset[i] == kInvalid)
+				{
+					continue;
+				}
+
+				for (const auto& cbv : effectSig.cbvBindings[i])
+				{
+					if (cbv.shaderRegister == parameter.second.cbvShaderRegister[i])
+					{
+						ShaderReflection::CBVMember member;
+						member.name = parameter.second.name;
+						member.byteOffset = parameter.second.byteOffset[i] - cbv.byteOffset;
+						member.sizeInBytes = parameter.second.sizeInBytes;
+						GetConstantBuffer(cbv.name)->AddMember(member);
+						break;
+					}
+				}
+			}
+		}
 	}
 
 	// Parameters
 	for (const auto& parameter : effectSig.parameters)
 	{
 		auto materialParameter = GetParameter(parameter.second.name);
-		materialParameter->CreateRenderThreadData(m_renderThreadData, parameter.second);
+		materialParameter->CreateRenderThreadData(renderThreadData, parameter.second);
 	}
 
 	// Resource SRVs
 	for (const auto& resource : effectSig.srvs)
 	{
 		auto materialResource = GetResource(resource.second.name);
-		materialResource->CreateRenderThreadData(m_renderThreadData, resource.second);
+		materialResource->CreateRenderThreadData(renderThreadData, resource.second);
 	}
 
 	// Resource UAVs
 	for (const auto& uav : effectSig.uavs)
 	{
 		auto materialUAV = GetResource(uav.second.name);
-		materialUAV->CreateRenderThreadData(m_renderThreadData, uav.second);
+		materialUAV->CreateRenderThreadData(renderThreadData, uav.second);
 	}
 
 	// TODO: Samplers
+
+	// Textures set before the effect was ready, or copied from a parent, get their bindless indices now
+	lock_guard<recursive_mutex> CS(m_textureLock);
+
+	m_bindlessDescriptors.clear();
+	if (effectSig.bindlessRootIndex != kInvalid)
+	{
+		for (const auto& texture : m_textures)
+		{
+			SetBindlessTexture(texture.first, *texture.second);
+		}
+	}
+
+	materialData.textures = GetTextureResources();
+	materialData.bindlessDescriptors = GetBindlessDescriptors();
+}
+
+
+vector<shared_ptr<TextureResource>> Material::GetTextureResources() const
+{
+	lock_guard<recursive_mutex> CS(m_textureLock);
+
+	vector<shared_ptr<TextureResource>> textures;
+	textures.reserve(m_textures.size());
+
+	for (const auto& texture : m_textures)
+	{
+		if (auto resource = texture.second->GetResource())
+		{
+			textures.push_back(resource);
+		}
+	}
+
+	return textures;
+}
+
+
+bool Material::IsBindless() const
+{
+	return m_effect && !m_effectPending && (m_effect->GetSignature().bindlessRootIndex != kInvalid);
+}
+
+
+void Material::SetBindlessTexture(const string& name, Texture& texture)
+{
+	// Texture must be fully loaded at this point
+	assert(texture.IsReady());
+
+	const string indexName = name + "Index";
+
+	const auto& parameters = m_effect->GetSignature().parameters;
+	if (parameters.find(indexName) == end(parameters))
+	{
+		LOG_WARNING << "Material " << m_name << " has no " << indexName << " parameter for bindless texture " << name;
+		return;
+	}
+
+	auto resource = texture.GetResource();
+	auto descriptor = resource->GetBindlessDescriptor();
+	{
+		lock_guard<recursive_mutex> CS(m_textureLock);
+		m_bindlessDescriptors[name] = descriptor;
+	}
+
+	GetParameter(indexName)->SetValue(descriptor->GetIndex());
+
+	// Streaming gives the texture a new view, in a new slot
+	weak_ptr<Material> weakThis = shared_from_this();
+	const TextureResource* changedResource = resource.get();
+	resource->AddViewChangedCallback(this, [weakThis, changedResource]()
+	{
+		auto thisMaterial = weakThis.lock();
+		return thisMaterial && thisMaterial->OnTextureViewChanged(changedResource);
+	});
+}
+
+
+bool Material::OnTextureViewChanged(const TextureResource* resource)
+{
+	if (!IsBindless())
+	{
+		return false;
+	}
+
+	lock_guard<recursive_mutex> CS(m_textureLock);
+
+	bool isUsed = false;
+	for (auto& descriptor : m_bindlessDescriptors)
+	{
+		auto texture = m_textures.find(descriptor.first);
+		if (texture == end(m_textures) || texture->second->GetResource().get() != resource)
+		{
+			continue;
+		}
+
+		descriptor.second = texture->second->GetResource()->GetBindlessDescriptor();
+		GetParameter(descriptor.first + "Index")->SetValue(descriptor.second->GetIndex());
+		isUsed = true;
+	}
+
+	if (isUsed)
+	{
+		UpdateRenderThreadTextures();
+	}
+
+	return isUsed;
+}
+
+
+void Material::UpdateRenderThreadTextures()
+{
+	if (auto materialData = GetRenderThreadData())
+	{
+		// Queued after the index parameters, so the slots they replace stay alive until draws stop using them
+		auto textures = GetTextureResources();
+		auto bindlessDescriptors = GetBindlessDescriptors();
+		EnqueueRenderCommand([materialData, textures, bindlessDescriptors]()
+		{
+			materialData->textures = textures;
+			materialData->bindlessDescriptors = bindlessDescriptors;
+		});
+	}
+}
+
+
+vector<shared_ptr<BindlessDescriptor>> Material::GetBindlessDescriptors() const
+{
+	lock_guard<recursive_mutex> CS(m_textureLock);
+
+	vector<shared_ptr<BindlessDescriptor>> descriptors;
+	descriptors.reserve(m_bindlessDescriptors.size());
+
+	for (const auto& descriptor : m_bindlessDescriptors)
+	{
+		descriptors.push_back(descriptor.second);
+	}
+
+	return descriptors;
 }
 
 
@@ -203,9 +501,36 @@ void RenderThread::MaterialData::Update(GraphicsCommandList& commandList)
 
 void RenderThread::MaterialData::Commit(GraphicsCommandList& commandList)
 {
+	if (parent)
+	{
+		parent->Commit(commandList);
+		return;
+	}
+
 	commandList.SetRootSignature(*rootSignature);
 	commandList.SetPipelineState(*pso);
 
+	const uint64_t frame = TextureStreamer::GetInstance().GetCurrentFrame();
+	for (const auto& texture : textures)
+	{
+		texture->MarkUsed(frame);
+	}
+
+	// Bindless materials bind their cbuffers and the bindless heap directly, without staging any descriptors
+	if (bindlessRootIndex != kInvalid)
+	{
+		auto& bindlessHeap = BindlessDescriptorHeap::GetInstance();
+		commandList.SetDescriptorHeap(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV, bindlessHeap.GetHeap());
+		commandList.SetDescriptorTable(bindlessRootIndex, bindlessHeap.GetGpuStart());
+
+		const auto gpuAddress = cbuffer.GetGpuVirtualAddress();
+		for (const auto& rootCbv : rootCBVs)
+		{
+			commandList.SetConstantBuffer(rootCbv.first, gpuAddress + rootCbv.second);
+		}
+		return;
+	}
+
 	const uint32_t numParams = static_cast<uint32_t>(rootParameters.size());
 	// TODO: hack, skipping first 2 slots (per-view and per-object data)
 	uint32_t rootIndex = kInvalid;
@@ -233,8 +558,40 @@ void RenderThread::MaterialData::Commit(GraphicsCommandList& commandList)
 }
 
 
+bool RenderThread::MaterialData::IsPipelineReady()
+{
+	if (!isEffectReady)
+	{
+		return false;
+	}
+
+	if (parent)
+	{
+		return parent->IsPipelineReady();
+	}
+
+	if (pso->IsReady())
+	{
+		return true;
+	}
+
+	PSO::RecordSkippedDraw();
+	return false;
+}
+
+
 bool RenderThread::MaterialData::IsReady()
 {
+	if (!isEffectReady)
+	{
+		return false;
+	}
+
+	if (parent)
+	{
+		return parent->IsReady();
+	}
+
 	// TODO: hack, skipping first 2 slots (per-view and per-object data)
 	const uint32_t numParams = static_cast<uint32_t>(cpuHandles.size());
 	for (uint32_t i = 2; i < numParams; ++i)
@@ -245,4 +602,23 @@ bool RenderThread::MaterialData::IsReady()
 		}
 	}
 	return true;
+}
+
+
+void RenderThread::MaterialData::SwapInOwnData(shared_ptr<MaterialData> ownData,
+	const vector<pair<uint32_t, D3D12_CPU_DESCRIPTOR_HANDLE>>& cbvHandles)
+{
+	// Inherit the parent's resources and constants, but keep the CBVs pointing at the instance's own cbuffer
+	ownData->cpuHandles = parent->cpuHandles;
+	for (const auto& cbv : cbvHandles)
+	{
+		ownData->cpuHandles[cbv.first] = cbv.second;
+	}
+
+	if (ownData->constantDataSize)
+	{
+		memcpy(ownData->cbufferData, parent->cbufferData, ownData->constantDataSize);
+	}
+
+	parent = move(ownData);
 }
\ No newline at end of file
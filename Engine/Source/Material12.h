@@ -10,6 +10,7 @@
 #pragma once
 
 #include "GpuBuffer12.h"
+#include "ParamId.h"
 #include "ShaderReflection.h"
 #include <ppltasks.h>
 
@@ -17,6 +18,7 @@ namespace Kodiak
 {
 
 // Forward declarations
+class BindlessDescriptor;
 class Effect;
 class GraphicsCommandList;
 class GraphicsPSO;
@@ -26,6 +28,7 @@ class MaterialResource;
 class RenderPass;
 class RootSignature;
 class Texture;
+class TextureResource;
 struct ShaderConstantBufferDesc;
 
 namespace RenderThread
@@ -44,21 +47,42 @@ public:
 	void SetName(const std::string& name) { m_name = name; }
 	const std::string& GetName() const { return m_name; }
 
+	// An effect that isn't finalized yet is finalized in the background, and the material is set up once
+	// it is.  Until then its draws are skipped.
 	void SetEffect(std::shared_ptr<Effect> effect);
 	void SetRenderPass(std::shared_ptr<RenderPass> pass);
 
-	std::shared_ptr<MaterialParameter> GetParameter(const std::string& name);
-	std::shared_ptr<MaterialResource> GetResource(const std::string& name);
-	std::shared_ptr<MaterialConstantBuffer> GetConstantBuffer(const std::string& name);
+	std::shared_ptr<MaterialParameter> GetParameter(ParamId id);
+	std::shared_ptr<MaterialResource> GetResource(ParamId id);
+	std::shared_ptr<MaterialConstantBuffer> GetConstantBuffer(ParamId id);
 
+	// With a bindless effect, the texture's index in the bindless heap is written to the uint parameter named
+	// name + "Index" instead
 	void SetResource(const std::string& name, std::shared_ptr<Texture> texture);
 
-	std::shared_ptr<RenderThread::MaterialData> GetRenderThreadData() { return m_renderThreadData; }
+	// Safe to call from any thread, while the effect's finalized callback replaces the data
+	std::shared_ptr<RenderThread::MaterialData> GetRenderThreadData() const { return std::atomic_load(&m_renderThreadData); }
 
+	// Copies the effect and render pass, but none of the parameter values
 	std::shared_ptr<Material> Clone();
 
+	// Returns a material that draws with this one's parameters and resources, without a cbuffer or
+	// descriptors of its own, until one of its parameters, resources or cbuffers is first requested.
+	// It then takes a copy of this material's current state, and no longer follows changes to it.
+	std::shared_ptr<Material> CreateInstance();
+
 private:
+	void CopyOnWrite();
 	void CreateRenderThreadData();
+	void SetupRenderThreadData(const std::shared_ptr<RenderThread::MaterialData>& renderThreadData);
+	std::vector<std::shared_ptr<TextureResource>> GetTextureResources() const;
+	bool IsBindless() const;
+	void SetBindlessTexture(const std::string& name, Texture& texture);
+	std::vector<std::shared_ptr<BindlessDescriptor>> GetBindlessDescriptors() const;
+	void UpdateRenderThreadTextures();
+
+	// Main thread, once streamed mips are committed.  Returns false if the material no longer uses the texture.
+	bool OnTextureViewChanged(const TextureResource* resource);
 
 private:
 	std::string						m_name;
@@ -67,17 +91,30 @@ private:
 	std::shared_ptr<RenderPass>		m_renderPass;
 
 	std::mutex													m_parameterLock;
-	std::map<std::string, std::shared_ptr<MaterialParameter>>	m_parameters;
+	ParamIdMap<MaterialParameter>								m_parameters;
 
 	std::mutex													m_resourceLock;
-	std::map<std::string, std::shared_ptr<MaterialResource>>	m_resources;
+	ParamIdMap<MaterialResource>								m_resources;
 
 	std::mutex														m_constantBufferLock;
-	std::map<std::string, std::shared_ptr<MaterialConstantBuffer>>	m_constantBuffers;
+	ParamIdMap<MaterialConstantBuffer>								m_constantBuffers;
 
+	// SetResource runs on loader threads while the main thread sets up the render thread data.  Recursive,
+	// since the setup lists the textures through the same helpers.
+	mutable std::recursive_mutex								m_textureLock;
 	std::map<std::string, std::shared_ptr<Texture>>				m_textures;
+	std::map<std::string, std::shared_ptr<BindlessDescriptor>>	m_bindlessDescriptors;
 
+	// Only replaced through std::atomic_store, once the new data is set up
 	std::shared_ptr<RenderThread::MaterialData>					m_renderThreadData;
+
+	// Set while waiting on the effect to be finalized
+	std::atomic<bool>											m_effectPending{ false };
+
+	// Set on instances until their first write
+	std::recursive_mutex										m_instanceLock;
+	std::shared_ptr<Material>									m_parent;
+	std::atomic<bool>											m_sharesParent{ false };
 };
 
 
@@ -89,9 +126,24 @@ struct MaterialData
 	void Update(GraphicsCommandList& commandList);
 	void Commit(GraphicsCommandList& commandList);
 	bool IsReady();
+	bool IsPipelineReady();
+
+	// Runs on the render thread, once an instance's own data is set up.  Copies the parent's current resources
+	// and constants into it, and draws through this data go to it from then on.
+	void SwapInOwnData(std::shared_ptr<MaterialData> ownData,
+		const std::vector<std::pair<uint32_t, D3D12_CPU_DESCRIPTOR_HANDLE>>& cbvHandles);
 
-	// Render pass
+	// Draws go to this data when it's set.  Instances start out on their parent's, and move to their own after
+	// their first write (see Material::CopyOnWrite).  Materials waiting on their effect move to the data set up
+	// once it's finalized (see Material::SetEffect).
+	std::shared_ptr<MaterialData>	parent;
+
+	// Cleared while the material waits on its effect, since none of the data below is set up yet
+	bool							isEffectReady{ true };
+
+	// Render pass.  Read it through GetRenderPass, which follows parent.
 	std::shared_ptr<RenderPass>		renderPass;
+	const std::shared_ptr<RenderPass>& GetRenderPass() const { return parent ? parent->GetRenderPass() : renderPass; }
 
 	// PSO
 	std::shared_ptr<GraphicsPSO>	pso;
@@ -104,11 +156,21 @@ struct MaterialData
 
 	// Root parameters
 	std::vector<ShaderReflection::DescriptorRange> rootParameters;
+
+	// Bindless effects only, with the cbuffers as (root index, byte offset) pairs
+	uint32_t										bindlessRootIndex{ kInvalid };
+	std::vector<std::pair<uint32_t, uint32_t>>		rootCBVs;
 	
 	// Constant buffer
 	MappedConstantBuffer			cbuffer;
 	uint32_t						constantDataSize{ 0 };
 	byte*							cbufferData{ nullptr };
+
+	// Stamped with the frame on each commit, for the texture streamer's LRU eviction
+	std::vector<std::shared_ptr<TextureResource>>	textures;
+
+	// Keeps the bindless heap slots that the cbuffer's texture indices refer to
+	std::vector<std::shared_ptr<BindlessDescriptor>>	bindlessDescriptors;
 };
 
 } // namespace RenderThread
@@ -47,4 +47,47 @@ void MaterialConstantBuffer::CreateRenderThreadData(uint32_t index, size_t sizeI
 
 	assert(m_bindings[index] == nullptr);
 	m_bindings[index] = destination;
+}
+
+
+void MaterialConstantBuffer::AddMember(const ShaderReflection::CBVMember& member)
+{
+	for (const auto& existing : m_members)
+	{
+		if (existing.name == member.name)
+		{
+			assert(existing.byteOffset == member.byteOffset && existing.sizeInBytes == member.sizeInBytes);
+			return;
+		}
+	}
+	m_members.push_back(member);
+}
+
+
+void MaterialConstantBuffer::SetConstantsImmediate(const byte* data, size_t sizeInBytes,
+	const ShaderReflection::ConstantStructMember* members, size_t numMembers)
+{
+	// Effect isn't set yet
+	if (m_size == kInvalid)
+	{
+		return;
+	}
+
+	if (members != m_validatedMembers)
+	{
+		// Only log a mismatch once
+		if (members == m_rejectedMembers)
+		{
+			return;
+		}
+
+		if (!ShaderReflection::ValidateConstantLayout(m_name, m_size, m_members, sizeInBytes, members, numMembers))
+		{
+			m_rejectedMembers = members;
+			return;
+		}
+		m_validatedMembers = members;
+	}
+
+	SetDataImmediate(sizeInBytes, data);
 }
\ No newline at end of file
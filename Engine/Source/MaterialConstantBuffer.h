@@ -23,13 +23,35 @@ public:
 
 	void SetDataImmediate(size_t sizeInBytes, const byte* data);
 
+	// Sets the whole cbuffer from a struct that mirrors it, in one copy per shader stage.  The struct is checked
+	// against the reflected cbuffer the first time each members table is used, and nothing is written if they
+	// don't match.
+	template <typename T, size_t N>
+	void SetConstantsImmediate(const T& constants, const ShaderReflection::ConstantStructMember(&members)[N])
+	{
+		static_assert(std::is_trivially_copyable<T>::value, "Constants are copied with memcpy");
+		SetConstantsImmediate(reinterpret_cast<const byte*>(&constants), sizeof(T), members, N);
+	}
+
 	void CreateRenderThreadData(uint32_t index, size_t sizeInBytes, byte* destination);
 
+	// Stages that share the cbuffer report the same variables, which are only recorded once
+	void AddMember(const ShaderReflection::CBVMember& member);
+
+private:
+	void SetConstantsImmediate(const byte* data, size_t sizeInBytes, const ShaderReflection::ConstantStructMember* members,
+		size_t numMembers);
+
 private:
 	const std::string	m_name;
 
 	size_t				m_size{ kInvalid };
 
+	// Reflected variables, and the last members tables that did and didn't match them
+	std::vector<ShaderReflection::CBVMember>			m_members;
+	const ShaderReflection::ConstantStructMember*		m_validatedMembers{ nullptr };
+	const ShaderReflection::ConstantStructMember*		m_rejectedMembers{ nullptr };
+
 	// Render thread data
 	std::array<byte*, 5>						m_bindings;
 };
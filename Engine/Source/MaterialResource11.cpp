@@ -153,7 +153,9 @@ void MaterialResource::CreateRenderThreadData(shared_ptr<RenderThread::MaterialD
 
 	m_renderThreadData = materialData;
 
-	DispatchToRenderThread(m_srv.Get(), false);
+	// The material data is new and the render thread doesn't have it yet, so write it directly.  This
+	// also lets materials be set up off the main thread.
+	DispatchToRenderThread(m_srv.Get(), true);
 }
 
 
@@ -172,7 +174,8 @@ void MaterialResource::CreateRenderThreadData(shared_ptr<RenderThread::MaterialD
 
 	m_renderThreadData = materialData;
 
-	DispatchToRenderThread(m_uav.Get(), false);
+	// New material data, as above
+	DispatchToRenderThread(m_uav.Get(), true);
 }
 
 
@@ -157,7 +157,9 @@ void MaterialResource::CreateRenderThreadData(std::shared_ptr<RenderThread::Mate
 
 	m_renderThreadData = materialData;
 
-	DispatchToRenderThread(m_cpuHandle, false);
+	// The material data is new and the render thread doesn't have it yet, so write it directly.  This
+	// also lets materials be set up off the main thread.
+	DispatchToRenderThread(m_cpuHandle, true);
 }
 
 
@@ -176,7 +178,8 @@ void MaterialResource::CreateRenderThreadData(std::shared_ptr<RenderThread::Mate
 
 	m_renderThreadData = materialData;
 
-	DispatchToRenderThread(m_cpuHandle, false);
+	// New material data, as above
+	DispatchToRenderThread(m_cpuHandle, true);
 }
 
 
@@ -0,0 +1,542 @@
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+// Author: David Elder
+//
+
+// Built without the precompiled header, so that the cooker can share it
+
+#include "MeshOptimizer.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+
+using namespace Kodiak;
+using namespace std;
+
+
+namespace
+{
+
+const uint32_t kInvalidTriangle = ~0u;
+
+
+// Simulates a FIFO cache with timestamps.  A vertex is in the cache if fewer than cacheSize misses
+// have happened since it was loaded; bumping the timestamp by cacheSize + 1 flushes the cache.
+class FifoCache
+{
+public:
+	FifoCache(size_t vertexCount, uint32_t cacheSize)
+		: m_timestamps(vertexCount, 0)
+		, m_cacheSize(cacheSize)
+		, m_timestamp(cacheSize + 1)
+	{}
+
+	uint32_t AddTriangle(const uint16_t* triangle)
+	{
+		uint32_t misses = 0;
+		for (uint32_t i = 0; i < 3; ++i)
+		{
+			uint32_t& vertexTimestamp = m_timestamps[triangle[i]];
+			if (m_timestamp - vertexTimestamp > m_cacheSize)
+			{
+				vertexTimestamp = m_timestamp++;
+				++misses;
+			}
+		}
+		return misses;
+	}
+
+	void Flush() { m_timestamp += m_cacheSize + 1; }
+
+private:
+	vector<uint32_t>	m_timestamps;
+	uint32_t			m_cacheSize;
+	uint32_t			m_timestamp;
+};
+
+
+// Forsyth's scoring parameters, from "Linear-Speed Vertex Cache Optimisation"
+const uint32_t kForsythCacheSize = 32;
+const uint32_t kForsythMaxValence = 32;
+const float kCacheDecayPower = 1.5f;
+const float kLastTriangleScore = 0.75f;
+const float kValenceBoostScale = 2.0f;
+const float kValenceBoostPower = 0.5f;
+
+
+class ForsythScores
+{
+public:
+	ForsythScores()
+	{
+		for (uint32_t i = 0; i < kForsythCacheSize; ++i)
+		{
+			if (i < 3)
+			{
+				// The last triangle's vertices get a fixed score, so the next triangle doesn't just
+				// continue the strip
+				m_cacheScores[i] = kLastTriangleScore;
+			}
+			else
+			{
+				const float scaler = 1.0f / (kForsythCacheSize - 3);
+				m_cacheScores[i] = powf(1.0f - (i - 3) * scaler, kCacheDecayPower);
+			}
+		}
+
+		m_valenceScores[0] = 0.0f;
+		for (uint32_t i = 1; i < kForsythMaxValence; ++i)
+		{
+			// Boost vertices with few triangles left, to finish them off and avoid isolated triangles
+			m_valenceScores[i] = kValenceBoostScale * powf(static_cast<float>(i), -kValenceBoostPower);
+		}
+	}
+
+	float GetVertexScore(int32_t cachePosition, uint32_t remainingTriangles) const
+	{
+		if (remainingTriangles == 0)
+		{
+			return -1.0f;
+		}
+
+		float score = cachePosition >= 0 ? m_cacheScores[cachePosition] : 0.0f;
+		score += m_valenceScores[min(remainingTriangles, kForsythMaxValence - 1)];
+		return score;
+	}
+
+private:
+	float m_cacheScores[kForsythCacheSize];
+	float m_valenceScores[kForsythMaxValence];
+};
+
+
+struct Float3
+{
+	float x, y, z;
+};
+
+Float3 operator+(const Float3& a, const Float3& b) { return{ a.x + b.x, a.y + b.y, a.z + b.z }; }
+Float3 operator-(const Float3& a, const Float3& b) { return{ a.x - b.x, a.y - b.y, a.z - b.z }; }
+Float3 operator*(const Float3& a, float s) { return{ a.x * s, a.y * s, a.z * s }; }
+float Dot(const Float3& a, const Float3& b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+Float3 Cross(const Float3& a, const Float3& b) { return{ a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x }; }
+
+
+Float3 ReadPosition(const uint8_t* positions, size_t positionStride, uint16_t index)
+{
+	Float3 position;
+	memcpy(&position, positions + index * positionStride, sizeof(position));
+	return position;
+}
+
+
+// Splits the triangle list into clusters that can be drawn in any order.  Hard boundaries are where the
+// cache-optimized order already starts over, i.e. a triangle misses on all three vertices.  Hard clusters
+// are then split further as long as each piece stays within threshold times the cluster's ACMR.
+vector<size_t> GenerateClusters(const uint16_t* indices, size_t triangleCount, size_t vertexCount, float threshold)
+{
+	FifoCache cache(vertexCount, kVertexCacheSize);
+
+	vector<size_t> hardBoundaries;
+	for (size_t i = 0; i < triangleCount; ++i)
+	{
+		if (cache.AddTriangle(indices + i * 3) == 3)
+		{
+			hardBoundaries.push_back(i);
+		}
+	}
+	hardBoundaries.push_back(triangleCount);
+
+	vector<size_t> clusters;
+	for (size_t c = 0; c + 1 < hardBoundaries.size(); ++c)
+	{
+		const size_t start = hardBoundaries[c];
+		const size_t end = hardBoundaries[c + 1];
+
+		cache.Flush();
+		uint32_t clusterMisses = 0;
+		for (size_t i = start; i < end; ++i)
+		{
+			clusterMisses += cache.AddTriangle(indices + i * 3);
+		}
+		const float clusterThreshold = threshold * static_cast<float>(clusterMisses) / static_cast<float>(end - start);
+
+		const size_t firstCluster = clusters.size();
+		clusters.push_back(start);
+
+		// Start a new cluster as soon as the running ACMR reaches the target
+		cache.Flush();
+		uint32_t runningMisses = 0;
+		uint32_t runningTriangles = 0;
+		for (size_t i = start; i < end; ++i)
+		{
+			runningMisses += cache.AddTriangle(indices + i * 3);
+			++runningTriangles;
+
+			if (static_cast<float>(runningMisses) <= clusterThreshold * runningTriangles)
+			{
+				clusters.push_back(i + 1);
+				cache.Flush();
+				runningMisses = 0;
+				runningTriangles = 0;
+			}
+		}
+
+		// The last piece is usually a handful of triangles with a poor ACMR, so merge it into the one
+		// before.  This also drops a boundary at 'end', which the next hard cluster adds itself.
+		if (clusters.size() - firstCluster > 1)
+		{
+			clusters.pop_back();
+		}
+	}
+
+	return clusters;
+}
+
+} // anonymous namespace
+
+
+namespace Kodiak
+{
+
+VertexCacheStats AnalyzeVertexCache(const uint16_t* indices, size_t indexCount, size_t vertexCount, uint32_t cacheSize)
+{
+	VertexCacheStats stats;
+	stats.triangleCount = indexCount / 3;
+
+	FifoCache cache(vertexCount, cacheSize);
+	vector<bool> referenced(vertexCount, false);
+
+	for (size_t i = 0; i < stats.triangleCount; ++i)
+	{
+		const uint16_t* triangle = indices + i * 3;
+		stats.cacheMisses += cache.AddTriangle(triangle);
+
+		for (uint32_t j = 0; j < 3; ++j)
+		{
+			assert(triangle[j] < vertexCount);
+			if (!referenced[triangle[j]])
+			{
+				referenced[triangle[j]] = true;
+				++stats.vertexCount;
+			}
+		}
+	}
+
+	if (stats.triangleCount > 0)
+	{
+		stats.acmr = static_cast<float>(stats.cacheMisses) / static_cast<float>(stats.triangleCount);
+		stats.atvr = static_cast<float>(stats.cacheMisses) / static_cast<float>(stats.vertexCount);
+	}
+
+	return stats;
+}
+
+
+void AccumulateVertexCacheStats(VertexCacheStats& total, const VertexCacheStats& stats)
+{
+	total.triangleCount += stats.triangleCount;
+	total.vertexCount += stats.vertexCount;
+	total.cacheMisses += stats.cacheMisses;
+
+	if (total.triangleCount > 0)
+	{
+		total.acmr = static_cast<float>(total.cacheMisses) / static_cast<float>(total.triangleCount);
+		total.atvr = static_cast<float>(total.cacheMisses) / static_cast<float>(total.vertexCount);
+	}
+}
+
+
+void OptimizeVertexCache(uint16_t* indices, size_t indexCount, size_t vertexCount)
+{
+	const size_t triangleCount = indexCount / 3;
+	if (triangleCount == 0)
+	{
+		return;
+	}
+
+	static const ForsythScores scores;
+
+	// Triangle adjacency per vertex.  Each vertex's list is kept partitioned so that its first
+	// remainingTriangles entries are the triangles that haven't been emitted yet.
+	vector<uint32_t> remainingTriangles(vertexCount, 0);
+	for (size_t i = 0; i < triangleCount * 3; ++i)
+	{
+		assert(indices[i] < vertexCount);
+		++remainingTriangles[indices[i]];
+	}
+
+	vector<uint32_t> adjacencyOffsets(vertexCount + 1, 0);
+	for (size_t i = 0; i < vertexCount; ++i)
+	{
+		adjacencyOffsets[i + 1] = adjacencyOffsets[i] + remainingTriangles[i];
+	}
+
+	vector<uint32_t> adjacency(triangleCount * 3);
+	{
+		vector<uint32_t> fill(begin(adjacencyOffsets), end(adjacencyOffsets) - 1);
+		for (size_t i = 0; i < triangleCount * 3; ++i)
+		{
+			adjacency[fill[indices[i]]++] = static_cast<uint32_t>(i / 3);
+		}
+	}
+
+	vector<int32_t> cachePositions(vertexCount, -1);
+	vector<float> vertexScores(vertexCount);
+	for (size_t i = 0; i < vertexCount; ++i)
+	{
+		vertexScores[i] = scores.GetVertexScore(-1, remainingTriangles[i]);
+	}
+
+	vector<float> triangleScores(triangleCount);
+	vector<bool> emitted(triangleCount, false);
+
+	uint32_t bestTriangle = 0;
+	for (size_t i = 0; i < triangleCount; ++i)
+	{
+		const uint16_t* triangle = indices + i * 3;
+		triangleScores[i] = vertexScores[triangle[0]] + vertexScores[triangle[1]] + vertexScores[triangle[2]];
+		if (triangleScores[i] > triangleScores[bestTriangle])
+		{
+			bestTriangle = static_cast<uint32_t>(i);
+		}
+	}
+
+	// LRU cache, with room for a triangle's worth of vertices pushed past the end
+	uint16_t cache[kForsythCacheSize + 3];
+	uint32_t cacheCount = 0;
+
+	vector<uint16_t> output;
+	output.reserve(triangleCount * 3);
+
+	size_t scanPosition = 0;
+
+	while (output.size() < triangleCount * 3)
+	{
+		if (bestTriangle == kInvalidTriangle)
+		{
+			// Nothing in the cache has triangles left, so pick up from the first triangle that hasn't been emitted
+			while (emitted[scanPosition])
+			{
+				++scanPosition;
+			}
+			bestTriangle = static_cast<uint32_t>(scanPosition);
+		}
+
+		const uint16_t* triangle = indices + bestTriangle * 3;
+		output.insert(end(output), triangle, triangle + 3);
+		emitted[bestTriangle] = true;
+
+		// Remove the triangle from its vertices' adjacency
+		for (uint32_t i = 0; i < 3; ++i)
+		{
+			const uint16_t vertex = triangle[i];
+			uint32_t* vertexAdjacency = adjacency.data() + adjacencyOffsets[vertex];
+			const uint32_t count = remainingTriangles[vertex];
+
+			auto it = find(vertexAdjacency, vertexAdjacency + count, bestTriangle);
+			assert(it != vertexAdjacency + count);
+			swap(*it, vertexAdjacency[count - 1]);
+			--remainingTriangles[vertex];
+		}
+
+		// Move the triangle's vertices to the front of the cache
+		uint16_t newCache[kForsythCacheSize + 3];
+		uint32_t newCacheCount = 0;
+		for (uint32_t i = 0; i < 3; ++i)
+		{
+			// Degenerate triangles repeat a vertex
+			if (find(newCache, newCache + newCacheCount, triangle[i]) == newCache + newCacheCount)
+			{
+				newCache[newCacheCount++] = triangle[i];
+			}
+		}
+		for (uint32_t i = 0; i < cacheCount; ++i)
+		{
+			const uint16_t vertex = cache[i];
+			if (vertex != triangle[0] && vertex != triangle[1] && vertex != triangle[2])
+			{
+				newCache[newCacheCount++] = vertex;
+			}
+		}
+
+		// Rescore everything in the cache, including the vertices that just dropped out
+		for (uint32_t i = 0; i < newCacheCount; ++i)
+		{
+			const uint16_t vertex = newCache[i];
+			cachePositions[vertex] = i < kForsythCacheSize ? static_cast<int32_t>(i) : -1;
+			vertexScores[vertex] = scores.GetVertexScore(cachePositions[vertex], remainingTriangles[vertex]);
+		}
+
+		bestTriangle = kInvalidTriangle;
+		float bestScore = -1.0f;
+		for (uint32_t i = 0; i < newCacheCount; ++i)
+		{
+			const uint16_t vertex = newCache[i];
+			const uint32_t* vertexAdjacency = adjacency.data() + adjacencyOffsets[vertex];
+
+			for (uint32_t j = 0; j < remainingTriangles[vertex]; ++j)
+			{
+				const uint32_t candidate = vertexAdjacency[j];
+				const uint16_t* candidateTriangle = indices + candidate * 3;
+
+				const float score = vertexScores[candidateTriangle[0]] + vertexScores[candidateTriangle[1]] + vertexScores[candidateTriangle[2]];
+				triangleScores[candidate] = score;
+				if (score > bestScore)
+				{
+					bestScore = score;
+					bestTriangle = candidate;
+				}
+			}
+		}
+
+		cacheCount = min(newCacheCount, kForsythCacheSize);
+		memcpy(cache, newCache, cacheCount * sizeof(uint16_t));
+	}
+
+	memcpy(indices, output.data(), output.size() * sizeof(uint16_t));
+}
+
+
+void OptimizeOverdraw(uint16_t* indices, size_t indexCount, const uint8_t* positions, size_t positionStride,
+	size_t vertexCount, float threshold)
+{
+	const size_t triangleCount = indexCount / 3;
+	if (triangleCount == 0)
+	{
+		return;
+	}
+
+	vector<size_t> clusters = GenerateClusters(indices, triangleCount, vertexCount, threshold);
+	const size_t clusterCount = clusters.size();
+	clusters.push_back(triangleCount);
+
+	// Area-weighted centroid and normal for each cluster, and for the whole mesh
+	vector<Float3> clusterCentroids(clusterCount, Float3{ 0.0f, 0.0f, 0.0f });
+	vector<Float3> clusterNormals(clusterCount, Float3{ 0.0f, 0.0f, 0.0f });
+	vector<float> clusterAreas(clusterCount, 0.0f);
+
+	Float3 meshCentroid{ 0.0f, 0.0f, 0.0f };
+	float meshArea = 0.0f;
+
+	for (size_t c = 0; c < clusterCount; ++c)
+	{
+		for (size_t i = clusters[c]; i < clusters[c + 1]; ++i)
+		{
+			const uint16_t* triangle = indices + i * 3;
+			const Float3 p0 = ReadPosition(positions, positionStride, triangle[0]);
+			const Float3 p1 = ReadPosition(positions, positionStride, triangle[1]);
+			const Float3 p2 = ReadPosition(positions, positionStride, triangle[2]);
+
+			const Float3 normal = Cross(p1 - p0, p2 - p0);
+			const float area = sqrtf(Dot(normal, normal));
+			const Float3 centroid = (p0 + p1 + p2) * (1.0f / 3.0f);
+
+			clusterCentroids[c] = clusterCentroids[c] + centroid * area;
+			clusterNormals[c] = clusterNormals[c] + normal;
+			clusterAreas[c] += area;
+		}
+
+		meshCentroid = meshCentroid + clusterCentroids[c];
+		meshArea += clusterAreas[c];
+	}
+
+	if (meshArea > 0.0f)
+	{
+		meshCentroid = meshCentroid * (1.0f / meshArea);
+	}
+
+	// Clusters facing away from the middle of the mesh tend to occlude the rest, so draw them first
+	vector<float> sortKeys(clusterCount, 0.0f);
+	for (size_t c = 0; c < clusterCount; ++c)
+	{
+		const float normalLength = sqrtf(Dot(clusterNormals[c], clusterNormals[c]));
+		if (clusterAreas[c] > 0.0f && normalLength > 0.0f)
+		{
+			const Float3 centroid = clusterCentroids[c] * (1.0f / clusterAreas[c]);
+			sortKeys[c] = Dot(centroid - meshCentroid, clusterNormals[c]) / normalLength;
+		}
+	}
+
+	vector<size_t> order(clusterCount);
+	for (size_t c = 0; c < clusterCount; ++c)
+	{
+		order[c] = c;
+	}
+	stable_sort(begin(order), end(order), [&sortKeys](size_t a, size_t b) { return sortKeys[a] > sortKeys[b]; });
+
+	vector<uint16_t> output;
+	output.reserve(triangleCount * 3);
+	for (size_t c : order)
+	{
+		output.insert(end(output), indices + clusters[c] * 3, indices + clusters[c + 1] * 3);
+	}
+
+	memcpy(indices, output.data(), output.size() * sizeof(uint16_t));
+}
+
+
+void OptimizeVertexFetch(uint16_t* indices, size_t indexCount, uint8_t* vertexData, size_t vertexStride,
+	size_t vertexCount)
+{
+	const uint32_t kUnused = ~0u;
+
+	vector<uint32_t> remap(vertexCount, kUnused);
+	uint32_t nextVertex = 0;
+
+	for (size_t i = 0; i < indexCount; ++i)
+	{
+		assert(indices[i] < vertexCount);
+		uint32_t& newIndex = remap[indices[i]];
+		if (newIndex == kUnused)
+		{
+			newIndex = nextVertex++;
+		}
+		indices[i] = static_cast<uint16_t>(newIndex);
+	}
+
+	for (auto& newIndex : remap)
+	{
+		if (newIndex == kUnused)
+		{
+			newIndex = nextVertex++;
+		}
+	}
+
+	vector<uint8_t> original(vertexData, vertexData + vertexCount * vertexStride);
+	for (size_t i = 0; i < vertexCount; ++i)
+	{
+		memcpy(vertexData + remap[i] * vertexStride, original.data() + i * vertexStride, vertexStride);
+	}
+}
+
+
+MeshOptimizeResult OptimizeMesh(uint16_t* indices, size_t indexCount, uint8_t* vertexData, size_t vertexStride,
+	size_t vertexCount, size_t positionOffset)
+{
+	MeshOptimizeResult result;
+	result.before = AnalyzeVertexCache(indices, indexCount, vertexCount);
+
+	OptimizeVertexCache(indices, indexCount, vertexCount);
+
+	if (positionOffset != kNoPositionOffset)
+	{
+		OptimizeOverdraw(indices, indexCount, vertexData + positionOffset, vertexStride, vertexCount);
+	}
+
+	// Last, since it moves the positions the overdraw pass reads
+	OptimizeVertexFetch(indices, indexCount, vertexData, vertexStride, vertexCount);
+
+	result.after = AnalyzeVertexCache(indices, indexCount, vertexCount);
+	return result;
+}
+
+} // namespace Kodiak
\ No newline at end of file
@@ -0,0 +1,72 @@
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+// Author: David Elder
+//
+
+#pragma once
+
+// Triangle and vertex reordering for indexed triangle lists.  Shared with the ModelCooker tool, so
+// this header and MeshOptimizer.cpp only depend on the standard library.
+//
+// All functions work on one mesh at a time: indices are 16-bit and relative to the mesh's first
+// vertex, and vertexCount is the number of vertices the mesh owns.
+
+#include <cstddef>
+#include <cstdint>
+
+namespace Kodiak
+{
+
+// FIFO cache size used to measure meshes.  Small enough to be pessimistic on current hardware.
+const uint32_t kVertexCacheSize = 16;
+
+
+struct VertexCacheStats
+{
+	float acmr{ 0.0f };		// Average cache miss ratio, vertex shader invocations per triangle
+	float atvr{ 0.0f };		// Average transformed vertex ratio, invocations per referenced vertex
+	size_t triangleCount{ 0 };
+	size_t vertexCount{ 0 };	// Distinct vertices referenced
+	size_t cacheMisses{ 0 };
+};
+
+VertexCacheStats AnalyzeVertexCache(const uint16_t* indices, size_t indexCount, size_t vertexCount,
+	uint32_t cacheSize = kVertexCacheSize);
+
+// Accumulates stats over several meshes, weighting by triangles and vertices
+void AccumulateVertexCacheStats(VertexCacheStats& total, const VertexCacheStats& stats);
+
+
+// Reorders triangles for post-transform cache locality, using Tom Forsyth's linear-speed algorithm
+void OptimizeVertexCache(uint16_t* indices, size_t indexCount, size_t vertexCount);
+
+// Reorders the clusters of a cache-optimized index buffer so that outward facing clusters draw first,
+// reducing overdraw.  Clusters are split wherever that costs at most threshold times the ACMR.
+// positions points at the first vertex's float3 position; consecutive positions are positionStride apart.
+void OptimizeOverdraw(uint16_t* indices, size_t indexCount, const uint8_t* positions, size_t positionStride,
+	size_t vertexCount, float threshold = 1.05f);
+
+// Reorders vertices in the order the indices first use them, and remaps the indices to match.
+// Vertices the indices don't reference are moved to the end.
+void OptimizeVertexFetch(uint16_t* indices, size_t indexCount, uint8_t* vertexData, size_t vertexStride,
+	size_t vertexCount);
+
+
+// Runs the three passes above in order.  positionOffset is the byte offset of a float3 position within
+// each vertex; pass kNoPositionOffset to skip the overdraw pass.
+const size_t kNoPositionOffset = ~size_t(0);
+
+struct MeshOptimizeResult
+{
+	VertexCacheStats before;
+	VertexCacheStats after;
+};
+
+MeshOptimizeResult OptimizeMesh(uint16_t* indices, size_t indexCount, uint8_t* vertexData, size_t vertexStride,
+	size_t vertexCount, size_t positionOffset);
+
+} // namespace Kodiak
\ No newline at end of file
@@ -0,0 +1,496 @@
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+// Author: David Elder
+//
+
+// Built without the precompiled header, so that tools can share it
+
+#include "Meshlet.h"
+
+#include <cassert>
+#include <cmath>
+#include <cstring>
+
+
+using namespace Kodiak;
+using namespace std;
+
+
+namespace
+{
+
+const uint32_t kInvalidTriangle = ~0u;
+const uint32_t kNoMeshlet = ~0u;
+
+
+struct Float3
+{
+	float x, y, z;
+};
+
+Float3 operator+(const Float3& a, const Float3& b) { return{ a.x + b.x, a.y + b.y, a.z + b.z }; }
+Float3 operator-(const Float3& a, const Float3& b) { return{ a.x - b.x, a.y - b.y, a.z - b.z }; }
+Float3 operator*(const Float3& a, float s) { return{ a.x * s, a.y * s, a.z * s }; }
+float Dot(const Float3& a, const Float3& b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+Float3 Cross(const Float3& a, const Float3& b) { return{ a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x }; }
+float Length(const Float3& a) { return sqrtf(Dot(a, a)); }
+
+
+Float3 ReadPosition(const uint8_t* positions, size_t positionStride, uint16_t index)
+{
+	Float3 position;
+	memcpy(&position, positions + index * positionStride, sizeof(position));
+	return position;
+}
+
+
+void WriteFloat3(float* dest, const Float3& value)
+{
+	dest[0] = value.x;
+	dest[1] = value.y;
+	dest[2] = value.z;
+}
+
+
+// Tracks the meshlet being built.  Vertices are marked with the id of the meshlet that holds them, so
+// starting a new meshlet doesn't need to clear anything.
+class MeshletBuilder
+{
+public:
+	explicit MeshletBuilder(size_t vertexCount)
+		: m_vertexMeshlet(vertexCount, kNoMeshlet)
+	{
+		m_vertices.reserve(kMaxMeshletVertices);
+	}
+
+	// Vertices the triangle would add to the meshlet
+	uint32_t CountNewVertices(const uint16_t* triangle) const
+	{
+		uint32_t count = 0;
+		for (uint32_t i = 0; i < 3; ++i)
+		{
+			const uint16_t vertex = triangle[i];
+			const bool repeated = (i > 0 && vertex == triangle[0]) || (i > 1 && vertex == triangle[1]);
+			if (m_vertexMeshlet[vertex] != m_id && !repeated)
+			{
+				++count;
+			}
+		}
+		return count;
+	}
+
+	bool Fits(const uint16_t* triangle) const
+	{
+		return m_triangleCount < kMaxMeshletTriangles &&
+			m_vertices.size() + CountNewVertices(triangle) <= kMaxMeshletVertices;
+	}
+
+	void AddTriangle(const uint16_t* triangle)
+	{
+		for (uint32_t i = 0; i < 3; ++i)
+		{
+			if (m_vertexMeshlet[triangle[i]] != m_id)
+			{
+				m_vertexMeshlet[triangle[i]] = m_id;
+				m_vertices.push_back(triangle[i]);
+			}
+		}
+		++m_triangleCount;
+	}
+
+	void Reset()
+	{
+		++m_id;
+		m_vertices.clear();
+		m_triangleCount = 0;
+	}
+
+	const vector<uint16_t>& GetVertices() const { return m_vertices; }
+	uint32_t GetTriangleCount() const { return m_triangleCount; }
+
+private:
+	vector<uint32_t>	m_vertexMeshlet;
+	vector<uint16_t>	m_vertices;
+	uint32_t			m_id{ 0 };
+	uint32_t			m_triangleCount{ 0 };
+};
+
+
+// Ritter's bounding sphere: start from the two points farthest apart along a rough diameter, then grow
+// the sphere to take in any point left outside
+void ComputeBoundingSphere(const Float3* points, size_t pointCount, Float3& center, float& radius)
+{
+	auto farthestFrom = [points, pointCount](const Float3& origin)
+	{
+		size_t farthest = 0;
+		float farthestDistance = -1.0f;
+		for (size_t i = 0; i < pointCount; ++i)
+		{
+			const Float3 delta = points[i] - origin;
+			const float distance = Dot(delta, delta);
+			if (distance > farthestDistance)
+			{
+				farthest = i;
+				farthestDistance = distance;
+			}
+		}
+		return points[farthest];
+	};
+
+	const Float3 a = farthestFrom(points[0]);
+	const Float3 b = farthestFrom(a);
+
+	center = (a + b) * 0.5f;
+	radius = Length(b - a) * 0.5f;
+
+	for (size_t i = 0; i < pointCount; ++i)
+	{
+		const float distance = Length(points[i] - center);
+		if (distance > radius)
+		{
+			const float newRadius = (radius + distance) * 0.5f;
+			center = center + (points[i] - center) * ((newRadius - radius) / distance);
+			radius = newRadius;
+		}
+	}
+}
+
+
+void ComputeMeshletBounds(Meshlet& meshlet, const uint16_t* indices, const vector<uint16_t>& vertices,
+	const uint8_t* positions, size_t positionStride)
+{
+	Float3 points[kMaxMeshletVertices];
+	for (size_t i = 0; i < vertices.size(); ++i)
+	{
+		points[i] = ReadPosition(positions, positionStride, vertices[i]);
+	}
+
+	Float3 center;
+	float radius;
+	ComputeBoundingSphere(points, vertices.size(), center, radius);
+
+	WriteFloat3(meshlet.center, center);
+	meshlet.radius = radius;
+
+	// Normal cone.  Degenerate triangles never rasterize, so they don't constrain it.
+	Float3 normals[kMaxMeshletTriangles];
+	Float3 corners[kMaxMeshletTriangles];
+	uint32_t normalCount = 0;
+	Float3 axis{ 0.0f, 0.0f, 0.0f };
+
+	const uint16_t* triangle = indices + meshlet.startIndex;
+	for (uint32_t i = 0; i < meshlet.triangleCount; ++i, triangle += 3)
+	{
+		const Float3 p0 = ReadPosition(positions, positionStride, triangle[0]);
+		const Float3 p1 = ReadPosition(positions, positionStride, triangle[1]);
+		const Float3 p2 = ReadPosition(positions, positionStride, triangle[2]);
+
+		const Float3 normal = Cross(p1 - p0, p2 - p0);
+		const float length = Length(normal);
+		if (length > 0.0f)
+		{
+			normals[normalCount] = normal * (1.0f / length);
+			corners[normalCount] = p0;
+			axis = axis + normals[normalCount];
+			++normalCount;
+		}
+	}
+
+	WriteFloat3(meshlet.coneApex, center);
+	WriteFloat3(meshlet.coneAxis, Float3{ 0.0f, 0.0f, 0.0f });
+	meshlet.coneCutoff = kNoConeCutoff;
+
+	const float axisLength = Length(axis);
+	if (normalCount == 0 || axisLength < 1e-6f)
+	{
+		return;
+	}
+	axis = axis * (1.0f / axisLength);
+
+	float minDot = 1.0f;
+	for (uint32_t i = 0; i < normalCount; ++i)
+	{
+		minDot = fminf(minDot, Dot(normals[i], axis));
+	}
+
+	// Some triangle faces sideways or backwards relative to the others
+	if (minDot <= 0.0f)
+	{
+		return;
+	}
+
+	// Slide the apex back along the axis until it is behind every triangle's plane.  Any camera that sees
+	// the apex from within the complement of the normal cone is then behind every triangle too.
+	float apexDistance = 0.0f;
+	for (uint32_t i = 0; i < normalCount; ++i)
+	{
+		const float distance = Dot(center - corners[i], normals[i]) / Dot(axis, normals[i]);
+		apexDistance = fmaxf(apexDistance, distance);
+	}
+
+	WriteFloat3(meshlet.coneApex, center - axis * apexDistance);
+	WriteFloat3(meshlet.coneAxis, axis);
+	meshlet.coneCutoff = sqrtf(1.0f - minDot * minDot);
+}
+
+} // anonymous namespace
+
+
+namespace Kodiak
+{
+
+vector<Meshlet> BuildMeshlets(uint16_t* indices, size_t indexCount, const uint8_t* positions,
+	size_t positionStride, size_t vertexCount)
+{
+	const size_t triangleCount = indexCount / 3;
+
+	vector<Meshlet> meshlets;
+	if (triangleCount == 0)
+	{
+		return meshlets;
+	}
+
+	// Triangles using each vertex
+	vector<uint32_t> adjacencyOffsets(vertexCount + 1, 0);
+	for (size_t i = 0; i < triangleCount * 3; ++i)
+	{
+		assert(indices[i] < vertexCount);
+		++adjacencyOffsets[indices[i] + 1];
+	}
+	for (size_t i = 0; i < vertexCount; ++i)
+	{
+		adjacencyOffsets[i + 1] += adjacencyOffsets[i];
+	}
+
+	vector<uint32_t> adjacency(triangleCount * 3);
+	{
+		vector<uint32_t> fill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+		for (size_t i = 0; i < triangleCount * 3; ++i)
+		{
+			adjacency[fill[indices[i]]++] = static_cast<uint32_t>(i / 3);
+		}
+	}
+
+	vector<bool> emitted(triangleCount, false);
+	vector<uint16_t> reordered;
+	reordered.reserve(triangleCount * 3);
+
+	MeshletBuilder builder(vertexCount);
+	size_t nextSeed = 0;
+
+	auto finishMeshlet = [&]()
+	{
+		Meshlet meshlet;
+		meshlet.startIndex = static_cast<uint32_t>(reordered.size() - builder.GetTriangleCount() * 3);
+		meshlet.triangleCount = builder.GetTriangleCount();
+		meshlet.vertexCount = static_cast<uint32_t>(builder.GetVertices().size());
+		ComputeMeshletBounds(meshlet, reordered.data(), builder.GetVertices(), positions, positionStride);
+
+		meshlets.push_back(meshlet);
+		builder.Reset();
+	};
+
+	for (size_t emittedCount = 0; emittedCount < triangleCount; ++emittedCount)
+	{
+		// Grow through the meshlet's own vertices, preferring triangles that add the fewest new ones.
+		// Ties go to the earliest triangle, keeping the cache-optimized order.
+		uint32_t best = kInvalidTriangle;
+		uint32_t bestNewVertices = 4;
+		for (uint16_t vertex : builder.GetVertices())
+		{
+			for (uint32_t i = adjacencyOffsets[vertex]; i < adjacencyOffsets[vertex + 1]; ++i)
+			{
+				const uint32_t candidate = adjacency[i];
+				if (emitted[candidate])
+				{
+					continue;
+				}
+
+				const uint32_t newVertices = builder.CountNewVertices(indices + candidate * 3);
+				if (newVertices < bestNewVertices || (newVertices == bestNewVertices && candidate < best))
+				{
+					best = candidate;
+					bestNewVertices = newVertices;
+				}
+			}
+		}
+
+		// Start a new meshlet when this one is full or has run out of connected triangles
+		if (best == kInvalidTriangle || !builder.Fits(indices + best * 3))
+		{
+			if (builder.GetTriangleCount() > 0)
+			{
+				finishMeshlet();
+			}
+
+			while (emitted[nextSeed])
+			{
+				++nextSeed;
+			}
+			best = static_cast<uint32_t>(nextSeed);
+		}
+
+		const uint16_t* triangle = indices + best * 3;
+		builder.AddTriangle(triangle);
+		reordered.insert(reordered.end(), triangle, triangle + 3);
+		emitted[best] = true;
+	}
+
+	finishMeshlet();
+
+	memcpy(indices, reordered.data(), reordered.size() * sizeof(uint16_t));
+	return meshlets;
+}
+
+
+MeshletCullView MakeMeshletCullView(const float objectToClip[4][4], const float objectSpaceCameraPosition[3])
+{
+	MeshletCullView view;
+	view.planeCount = 0;
+	view.backfaceCulling = true;
+	memcpy(view.cameraPosition, objectSpaceCameraPosition, sizeof(view.cameraPosition));
+
+	// Clip space column j is dot((x, y, z, 1), column j of the matrix).  Each plane is a combination of
+	// the w column with one of the others: -w <= x <= w, -w <= y <= w, 0 <= z <= w.
+	auto column = [objectToClip](uint32_t j, float* out)
+	{
+		for (uint32_t i = 0; i < 4; ++i)
+		{
+			out[i] = objectToClip[i][j];
+		}
+	};
+
+	float x[4], y[4], z[4], w[4];
+	column(0, x);
+	column(1, y);
+	column(2, z);
+	column(3, w);
+
+	const float signs[6] = { 1.0f, -1.0f, 1.0f, -1.0f, 1.0f, -1.0f };
+	const float* axes[6] = { x, x, y, y, z, z };
+	const float weights[6] = { 1.0f, 1.0f, 1.0f, 1.0f, 0.0f, 1.0f };
+
+	for (uint32_t p = 0; p < 6; ++p)
+	{
+		float plane[4];
+		for (uint32_t i = 0; i < 4; ++i)
+		{
+			plane[i] = weights[p] * w[i] + signs[p] * axes[p][i];
+		}
+
+		// Infinite far planes have no normal
+		const float length = sqrtf(plane[0] * plane[0] + plane[1] * plane[1] + plane[2] * plane[2]);
+		if (length < 1e-6f)
+		{
+			continue;
+		}
+
+		for (uint32_t i = 0; i < 4; ++i)
+		{
+			view.planes[view.planeCount][i] = plane[i] / length;
+		}
+		++view.planeCount;
+	}
+
+	return view;
+}
+
+
+void AccumulateMeshletCullStats(MeshletCullStats& total, const MeshletCullStats& stats)
+{
+	total.meshletCount += stats.meshletCount;
+	total.triangleCount += stats.triangleCount;
+	total.frustumCulledMeshlets += stats.frustumCulledMeshlets;
+	total.frustumCulledTriangles += stats.frustumCulledTriangles;
+	total.backfaceCulledMeshlets += stats.backfaceCulledMeshlets;
+	total.backfaceCulledTriangles += stats.backfaceCulledTriangles;
+	total.rangeCount += stats.rangeCount;
+}
+
+
+size_t CullMeshlets(const Meshlet* meshlets, size_t meshletCount, const MeshletCullView& view,
+	vector<MeshletIndexRange>& ranges, MeshletCullStats* stats)
+{
+	MeshletCullStats localStats;
+	const size_t firstRange = ranges.size();
+	const Float3 cameraPosition{ view.cameraPosition[0], view.cameraPosition[1], view.cameraPosition[2] };
+
+	for (size_t i = 0; i < meshletCount; ++i)
+	{
+		const auto& meshlet = meshlets[i];
+
+		localStats.meshletCount++;
+		localStats.triangleCount += meshlet.triangleCount;
+
+		bool outside = false;
+		for (uint32_t p = 0; p < view.planeCount && !outside; ++p)
+		{
+			const float* plane = view.planes[p];
+			const float distance = plane[0] * meshlet.center[0] + plane[1] * meshlet.center[1] +
+				plane[2] * meshlet.center[2] + plane[3];
+			outside = distance < -meshlet.radius;
+		}
+
+		if (outside)
+		{
+			localStats.frustumCulledMeshlets++;
+			localStats.frustumCulledTriangles += meshlet.triangleCount;
+			continue;
+		}
+
+		if (view.backfaceCulling && meshlet.coneCutoff <= 1.0f)
+		{
+			const Float3 apex{ meshlet.coneApex[0], meshlet.coneApex[1], meshlet.coneApex[2] };
+			const Float3 axis{ meshlet.coneAxis[0], meshlet.coneAxis[1], meshlet.coneAxis[2] };
+			const Float3 toApex = apex - cameraPosition;
+			const float distance = Length(toApex);
+
+			if (distance > 0.0f && Dot(toApex, axis) >= meshlet.coneCutoff * distance)
+			{
+				localStats.backfaceCulledMeshlets++;
+				localStats.backfaceCulledTriangles += meshlet.triangleCount;
+				continue;
+			}
+		}
+
+		const uint32_t indexCount = meshlet.triangleCount * 3;
+		if (ranges.size() > firstRange && ranges.back().startIndex + ranges.back().indexCount == meshlet.startIndex)
+		{
+			ranges.back().indexCount += indexCount;
+		}
+		else
+		{
+			ranges.push_back({ meshlet.startIndex, indexCount });
+		}
+	}
+
+	const size_t rangeCount = ranges.size() - firstRange;
+	localStats.rangeCount = rangeCount;
+
+	if (stats)
+	{
+		AccumulateMeshletCullStats(*stats, localStats);
+	}
+
+	return rangeCount;
+}
+
+
+void MakeDrawIndexedArguments(const MeshletIndexRange* ranges, size_t rangeCount, uint32_t meshStartIndex,
+	int32_t meshBaseVertex, DrawIndexedArguments* arguments)
+{
+	for (size_t i = 0; i < rangeCount; ++i)
+	{
+		arguments[i].indexCountPerInstance = ranges[i].indexCount;
+		arguments[i].instanceCount = 1;
+		arguments[i].startIndexLocation = meshStartIndex + ranges[i].startIndex;
+		arguments[i].baseVertexLocation = meshBaseVertex;
+		arguments[i].startInstanceLocation = 0;
+	}
+}
+
+} // namespace Kodiak
\ No newline at end of file
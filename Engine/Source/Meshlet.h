@@ -0,0 +1,117 @@
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+// Author: David Elder
+//
+
+#pragma once
+
+// Splits meshes into small clusters of triangles (meshlets) and culls them on the CPU.  This header and
+// Meshlet.cpp only depend on the standard library, so tools and tests can build them outside the engine.
+//
+// Meshlets don't have their own index buffer: building them reorders the mesh's indices so that each
+// meshlet's triangles are contiguous, and culling produces ranges of that same index buffer.  Like the
+// MeshOptimizer functions, indices are 16-bit and relative to the mesh's first vertex.
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Kodiak
+{
+
+const uint32_t kMaxMeshletVertices = 64;
+const uint32_t kMaxMeshletTriangles = 124;
+
+// coneCutoff value for meshlets whose triangles face too many ways to ever be backface culled
+const float kNoConeCutoff = 2.0f;
+
+
+struct Meshlet
+{
+	// Bounding sphere
+	float		center[3];
+	float		radius;
+
+	// Normal cone.  Every triangle faces away from cameras for which
+	// dot(normalize(coneApex - cameraPosition), coneAxis) >= coneCutoff.
+	float		coneApex[3];
+	float		coneCutoff;
+	float		coneAxis[3];
+
+	uint32_t	startIndex;		// Relative to the mesh's first index
+	uint32_t	triangleCount;
+	uint32_t	vertexCount;	// Distinct vertices, for stats
+};
+
+
+// Reorders the mesh's triangles into meshlets of at most kMaxMeshletVertices vertices and
+// kMaxMeshletTriangles triangles, growing each meshlet through shared vertices so that it stays compact.
+// Run it after OptimizeVertexCache; triangle order is otherwise kept where possible.
+// positions points at the first vertex's float3 position; consecutive positions are positionStride apart.
+// Counter-clockwise triangles, seen from a right-handed view, are front facing.
+std::vector<Meshlet> BuildMeshlets(uint16_t* indices, size_t indexCount, const uint8_t* positions,
+	size_t positionStride, size_t vertexCount);
+
+
+// Frustum planes and eye position, in the same space as the meshlets
+struct MeshletCullView
+{
+	float planes[6][4];		// ax + by + cz + d >= 0 inside, with (a, b, c) normalized
+	uint32_t planeCount;
+	float cameraPosition[3];
+	bool backfaceCulling;	// Turn off for mirroring transforms or two-sided materials
+};
+
+// objectToClip is row-major and transforms row vectors (i.e. an XMFLOAT4X4 of the model-view-projection
+// matrix), with clip space depth in [0, w].  Planes are in object space, so the meshlets don't need to
+// be transformed.  A projection with an infinite far plane yields five planes.
+MeshletCullView MakeMeshletCullView(const float objectToClip[4][4], const float objectSpaceCameraPosition[3]);
+
+
+// A run of surviving triangles, relative to the mesh's first index
+struct MeshletIndexRange
+{
+	uint32_t startIndex;
+	uint32_t indexCount;
+};
+
+
+// Same layout as D3D12_DRAW_INDEXED_ARGUMENTS, for ExecuteIndirect
+struct DrawIndexedArguments
+{
+	uint32_t	indexCountPerInstance;
+	uint32_t	instanceCount;
+	uint32_t	startIndexLocation;
+	int32_t		baseVertexLocation;
+	uint32_t	startInstanceLocation;
+};
+
+
+struct MeshletCullStats
+{
+	size_t meshletCount{ 0 };
+	size_t triangleCount{ 0 };
+	size_t frustumCulledMeshlets{ 0 };
+	size_t frustumCulledTriangles{ 0 };
+	size_t backfaceCulledMeshlets{ 0 };
+	size_t backfaceCulledTriangles{ 0 };
+	size_t rangeCount{ 0 };		// Draws needed for the survivors
+};
+
+void AccumulateMeshletCullStats(MeshletCullStats& total, const MeshletCullStats& stats);
+
+
+// Tests each meshlet against the view and appends the survivors to ranges, merging neighbours that are
+// adjacent in the index buffer.  Returns the number of ranges appended.  stats may be null.
+size_t CullMeshlets(const Meshlet* meshlets, size_t meshletCount, const MeshletCullView& view,
+	std::vector<MeshletIndexRange>& ranges, MeshletCullStats* stats);
+
+// Converts ranges of a mesh into indirect draw records
+void MakeDrawIndexedArguments(const MeshletIndexRange* ranges, size_t rangeCount, uint32_t meshStartIndex,
+	int32_t meshBaseVertex, DrawIndexedArguments* arguments);
+
+} // namespace Kodiak
\ No newline at end of file
@@ -0,0 +1,573 @@
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+// Author: David Elder
+//
+
+// Built without the precompiled header, so that tools can share it
+
+#include "MipGenerator.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define KODIAK_TARGET_F16C
+#else
+#include <cpuid.h>
+#define KODIAK_TARGET_F16C __attribute__((target("f16c")))
+#endif
+#include <immintrin.h>
+
+
+using namespace Kodiak;
+using namespace std;
+
+
+namespace
+{
+
+// Kaiser filter parameters, as used by most texture tools
+const float s_kaiserAlpha = 4.0f;
+const float s_kaiserWidth = 3.0f;
+
+// Source taps for a 2x reduction.  Destination texel x is centered between source texels 2x and 2x + 1,
+// and takes source texels 2x - 5 through 2x + 6.
+const int32_t s_kaiserTaps = 12;
+const int32_t s_kaiserFirstTap = -5;
+
+
+float BesselI0(float x)
+{
+	float sum = 1.0f;
+	float term = 1.0f;
+	for (int32_t k = 1; k < 32; ++k)
+	{
+		const float factor = x / (2.0f * k);
+		term *= factor * factor;
+		sum += term;
+		if (term < sum * 1e-8f)
+		{
+			break;
+		}
+	}
+	return sum;
+}
+
+
+float Sinc(float x)
+{
+	const float pi = 3.14159265358979f;
+	return (fabsf(x) < 1e-6f) ? 1.0f : sinf(pi * x) / (pi * x);
+}
+
+
+struct MipTables
+{
+	MipTables()
+	{
+		for (uint32_t i = 0; i < 256; ++i)
+		{
+			const double c = i / 255.0;
+			srgbToLinear[i] = static_cast<float>((c <= 0.04045) ? c / 12.92 : pow((c + 0.055) / 1.055, 2.4));
+		}
+
+		for (uint32_t i = 0; i < 65536; ++i)
+		{
+			const double l = i / 65535.0;
+			const double s = (l <= 0.0031308) ? l * 12.92 : 1.055 * pow(l, 1.0 / 2.4) - 0.055;
+			linearToSRGB[i] = static_cast<uint8_t>(s * 255.0 + 0.5);
+		}
+
+		float sum = 0.0f;
+		for (int32_t k = 0; k < s_kaiserTaps; ++k)
+		{
+			// Offset from the destination texel center, in destination texels
+			const float t = (k + s_kaiserFirstTap - 0.5f) * 0.5f;
+			const float window = t / s_kaiserWidth;
+			const float kaiser = BesselI0(s_kaiserAlpha * sqrtf(max(0.0f, 1.0f - window * window))) / BesselI0(s_kaiserAlpha);
+			kaiserWeights[k] = Sinc(t) * kaiser;
+			sum += kaiserWeights[k];
+		}
+		for (int32_t k = 0; k < s_kaiserTaps; ++k)
+		{
+			kaiserWeights[k] /= sum;
+		}
+	}
+
+	float srgbToLinear[256];
+	uint8_t linearToSRGB[65536];
+	float kaiserWeights[s_kaiserTaps];
+};
+
+
+const MipTables& GetMipTables()
+{
+	static const MipTables tables;
+	return tables;
+}
+
+
+float HalfToFloat(uint16_t half)
+{
+	const uint32_t sign = static_cast<uint32_t>(half & 0x8000) << 16;
+	const uint32_t exponent = (half >> 10) & 0x1F;
+	uint32_t mantissa = half & 0x3FF;
+
+	uint32_t bits;
+	if (exponent == 0x1F)
+	{
+		bits = sign | 0x7F800000 | (mantissa << 13);
+	}
+	else if (exponent != 0)
+	{
+		bits = sign | ((exponent + 112) << 23) | (mantissa << 13);
+	}
+	else if (mantissa == 0)
+	{
+		bits = sign;
+	}
+	else
+	{
+		// Denormal, renormalize it
+		uint32_t floatExponent = 113;
+		while ((mantissa & 0x400) == 0)
+		{
+			mantissa <<= 1;
+			--floatExponent;
+		}
+		bits = sign | (floatExponent << 23) | ((mantissa & 0x3FF) << 13);
+	}
+
+	float value;
+	memcpy(&value, &bits, 4);
+	return value;
+}
+
+
+// Rounds to nearest even
+uint16_t FloatToHalf(float value)
+{
+	uint32_t bits;
+	memcpy(&bits, &value, 4);
+
+	const uint32_t sign = (bits >> 16) & 0x8000;
+	const uint32_t magnitude = bits & 0x7FFFFFFF;
+
+	if (magnitude >= 0x7F800000)
+	{
+		// Inf or NaN
+		return static_cast<uint16_t>(sign | 0x7C00 | ((magnitude > 0x7F800000) ? 0x200 : 0));
+	}
+	if (magnitude >= 0x477FF000)
+	{
+		// Rounds past the largest half
+		return static_cast<uint16_t>(sign | 0x7C00);
+	}
+	if (magnitude >= 0x38800000)
+	{
+		return static_cast<uint16_t>(sign | ((magnitude + 0xC8000FFF + ((magnitude >> 13) & 1)) >> 13));
+	}
+	if (magnitude < 0x33000000)
+	{
+		// Rounds to zero
+		return static_cast<uint16_t>(sign);
+	}
+
+	// Denormal
+	const uint32_t shift = 126 - (magnitude >> 23);
+	const uint32_t mantissa = (magnitude & 0x7FFFFF) | 0x800000;
+	const uint32_t remainder = mantissa & ((1u << shift) - 1);
+	const uint32_t halfway = 1u << (shift - 1);
+	uint32_t result = mantissa >> shift;
+	if (remainder > halfway || (remainder == halfway && (result & 1)))
+	{
+		++result;
+	}
+	return static_cast<uint16_t>(sign | result);
+}
+
+
+bool DetectF16C()
+{
+#if defined(_MSC_VER)
+	int info[4];
+	__cpuid(info, 1);
+	const uint32_t ecx = static_cast<uint32_t>(info[2]);
+#else
+	unsigned int eax, ebx, ecx, edx;
+	if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+	{
+		return false;
+	}
+#endif
+
+	// F16C uses the AVX register state, which the OS has to have enabled (OSXSAVE, AVX and F16C bits)
+	const uint32_t required = (1u << 27) | (1u << 28) | (1u << 29);
+	if ((ecx & required) != required)
+	{
+		return false;
+	}
+
+#if defined(_MSC_VER)
+	return (_xgetbv(0) & 6) == 6;
+#else
+	uint32_t xcrLow, xcrHigh;
+	__asm__("xgetbv" : "=a"(xcrLow), "=d"(xcrHigh) : "c"(0));
+	return (xcrLow & 6) == 6;
+#endif
+}
+
+
+const bool g_hasF16C = DetectF16C();
+
+
+KODIAK_TARGET_F16C void LoadRowF16C(const uint8_t* src, uint32_t width, float* dest)
+{
+	for (uint32_t x = 0; x < width; ++x)
+	{
+		const __m128i half = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(src + 8 * x));
+		_mm_storeu_ps(dest + 4 * x, _mm_cvtph_ps(half));
+	}
+}
+
+
+KODIAK_TARGET_F16C void StoreRowF16C(const float* src, uint32_t width, uint8_t* dest)
+{
+	for (uint32_t x = 0; x < width; ++x)
+	{
+		const __m128i half = _mm_cvtps_ph(_mm_loadu_ps(src + 4 * x), 0);	// Round to nearest even
+		_mm_storel_epi64(reinterpret_cast<__m128i*>(dest + 8 * x), half);
+	}
+}
+
+
+// Rows are converted to linear float RGBA, one __m128 per texel, for the filters
+
+void LoadRow(MipFormat format, const uint8_t* src, uint32_t width, float* dest, const MipTables& tables)
+{
+	switch (format)
+	{
+	case MipFormat::RGBA8:
+	{
+		const __m128 scale = _mm_set1_ps(1.0f / 255.0f);
+		const __m128i zero = _mm_setzero_si128();
+		for (uint32_t x = 0; x < width; ++x)
+		{
+			int32_t texel;
+			memcpy(&texel, src + 4 * x, 4);
+			const __m128i value = _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(texel), zero), zero);
+			_mm_storeu_ps(dest + 4 * x, _mm_mul_ps(_mm_cvtepi32_ps(value), scale));
+		}
+		break;
+	}
+
+	case MipFormat::RGBA8_sRGB:
+		for (uint32_t x = 0; x < width; ++x)
+		{
+			const uint8_t* texel = src + 4 * x;
+			_mm_storeu_ps(dest + 4 * x, _mm_setr_ps(tables.srgbToLinear[texel[0]], tables.srgbToLinear[texel[1]],
+				tables.srgbToLinear[texel[2]], texel[3] * (1.0f / 255.0f)));
+		}
+		break;
+
+	case MipFormat::RGBA16F:
+		if (g_hasF16C)
+		{
+			LoadRowF16C(src, width, dest);
+			break;
+		}
+		for (uint32_t i = 0; i < 4 * width; ++i)
+		{
+			uint16_t half;
+			memcpy(&half, src + 2 * i, 2);
+			dest[i] = HalfToFloat(half);
+		}
+		break;
+	}
+}
+
+
+void StoreRow(MipFormat format, const float* src, uint32_t width, uint8_t* dest, const MipTables& tables)
+{
+	switch (format)
+	{
+	case MipFormat::RGBA8:
+	{
+		const __m128 zero = _mm_setzero_ps();
+		const __m128 one = _mm_set1_ps(1.0f);
+		const __m128 scale = _mm_set1_ps(255.0f);
+		for (uint32_t x = 0; x < width; ++x)
+		{
+			const __m128 value = _mm_mul_ps(_mm_min_ps(_mm_max_ps(_mm_loadu_ps(src + 4 * x), zero), one), scale);
+			const __m128i words = _mm_packs_epi32(_mm_cvtps_epi32(value), _mm_setzero_si128());
+			const int32_t texel = _mm_cvtsi128_si32(_mm_packus_epi16(words, words));
+			memcpy(dest + 4 * x, &texel, 4);
+		}
+		break;
+	}
+
+	case MipFormat::RGBA8_sRGB:
+	{
+		const __m128 zero = _mm_setzero_ps();
+		const __m128 one = _mm_set1_ps(1.0f);
+		const __m128 scale = _mm_setr_ps(65535.0f, 65535.0f, 65535.0f, 255.0f);
+		for (uint32_t x = 0; x < width; ++x)
+		{
+			const __m128 value = _mm_mul_ps(_mm_min_ps(_mm_max_ps(_mm_loadu_ps(src + 4 * x), zero), one), scale);
+			alignas(16) int32_t quantized[4];
+			_mm_store_si128(reinterpret_cast<__m128i*>(quantized), _mm_cvtps_epi32(value));
+
+			uint8_t* texel = dest + 4 * x;
+			texel[0] = tables.linearToSRGB[quantized[0]];
+			texel[1] = tables.linearToSRGB[quantized[1]];
+			texel[2] = tables.linearToSRGB[quantized[2]];
+			texel[3] = static_cast<uint8_t>(quantized[3]);
+		}
+		break;
+	}
+
+	case MipFormat::RGBA16F:
+		if (g_hasF16C)
+		{
+			StoreRowF16C(src, width, dest);
+			break;
+		}
+		for (uint32_t i = 0; i < 4 * width; ++i)
+		{
+			const uint16_t half = FloatToHalf(src[i]);
+			memcpy(dest + 2 * i, &half, 2);
+		}
+		break;
+	}
+}
+
+
+// 8-bit linear box filter, kept in integers: (a + b + c + d + 2) / 4 per channel
+void BoxFilterRowRGBA8(const uint8_t* row0, const uint8_t* row1, uint32_t srcWidth, uint8_t* dest, uint32_t destWidth)
+{
+	uint32_t x = 0;
+
+	if (srcWidth >= 2)
+	{
+		const __m128i zero = _mm_setzero_si128();
+		const __m128i bias = _mm_set1_epi16(2);
+
+		// Four destination texels from eight source texels on each row
+		for (; x + 4 <= destWidth; x += 4)
+		{
+			const __m128i top0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row0 + 8 * x));
+			const __m128i top1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row0 + 8 * x + 16));
+			const __m128i bottom0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row1 + 8 * x));
+			const __m128i bottom1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row1 + 8 * x + 16));
+
+			// Column sums, two source texels per register
+			const __m128i sum01 = _mm_add_epi16(_mm_unpacklo_epi8(top0, zero), _mm_unpacklo_epi8(bottom0, zero));
+			const __m128i sum23 = _mm_add_epi16(_mm_unpackhi_epi8(top0, zero), _mm_unpackhi_epi8(bottom0, zero));
+			const __m128i sum45 = _mm_add_epi16(_mm_unpacklo_epi8(top1, zero), _mm_unpacklo_epi8(bottom1, zero));
+			const __m128i sum67 = _mm_add_epi16(_mm_unpackhi_epi8(top1, zero), _mm_unpackhi_epi8(bottom1, zero));
+
+			// Pair up neighbouring columns
+			__m128i low = _mm_add_epi16(_mm_unpacklo_epi64(sum01, sum23), _mm_unpackhi_epi64(sum01, sum23));
+			__m128i high = _mm_add_epi16(_mm_unpacklo_epi64(sum45, sum67), _mm_unpackhi_epi64(sum45, sum67));
+			low = _mm_srli_epi16(_mm_add_epi16(low, bias), 2);
+			high = _mm_srli_epi16(_mm_add_epi16(high, bias), 2);
+
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dest + 4 * x), _mm_packus_epi16(low, high));
+		}
+	}
+
+	for (; x < destWidth; ++x)
+	{
+		const uint32_t x0 = 2 * x;
+		const uint32_t x1 = min(x0 + 1, srcWidth - 1);
+		for (uint32_t c = 0; c < 4; ++c)
+		{
+			const uint32_t sum = row0[4 * x0 + c] + row0[4 * x1 + c] + row1[4 * x0 + c] + row1[4 * x1 + c];
+			dest[4 * x + c] = static_cast<uint8_t>((sum + 2) >> 2);
+		}
+	}
+}
+
+
+void BoxFilterRowFloat(const float* row0, const float* row1, uint32_t srcWidth, float* dest, uint32_t destWidth)
+{
+	const __m128 quarter = _mm_set1_ps(0.25f);
+	for (uint32_t x = 0; x < destWidth; ++x)
+	{
+		const uint32_t x0 = 2 * x;
+		const uint32_t x1 = min(x0 + 1, srcWidth - 1);
+		const __m128 top = _mm_add_ps(_mm_loadu_ps(row0 + 4 * x0), _mm_loadu_ps(row0 + 4 * x1));
+		const __m128 bottom = _mm_add_ps(_mm_loadu_ps(row1 + 4 * x0), _mm_loadu_ps(row1 + 4 * x1));
+		_mm_storeu_ps(dest + 4 * x, _mm_mul_ps(_mm_add_ps(top, bottom), quarter));
+	}
+}
+
+
+void KaiserFilterRow(const float* src, uint32_t srcWidth, float* dest, uint32_t destWidth, const __m128* weights)
+{
+	const int32_t lastTexel = static_cast<int32_t>(srcWidth) - 1;
+	for (uint32_t x = 0; x < destWidth; ++x)
+	{
+		const int32_t first = 2 * static_cast<int32_t>(x) + s_kaiserFirstTap;
+
+		__m128 sum = _mm_setzero_ps();
+		if (first >= 0 && first + s_kaiserTaps - 1 <= lastTexel)
+		{
+			for (int32_t k = 0; k < s_kaiserTaps; ++k)
+			{
+				sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(src + 4 * (first + k)), weights[k]));
+			}
+		}
+		else
+		{
+			// Clamp at the edges
+			for (int32_t k = 0; k < s_kaiserTaps; ++k)
+			{
+				const int32_t texel = min(max(first + k, 0), lastTexel);
+				sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(src + 4 * texel), weights[k]));
+			}
+		}
+		_mm_storeu_ps(dest + 4 * x, sum);
+	}
+}
+
+
+void GenerateBoxRows(MipFormat format, const uint8_t* src, uint32_t srcWidth, uint32_t srcHeight, size_t srcPitch,
+	uint8_t* dest, size_t destPitch, uint32_t destWidth, uint32_t firstRow, uint32_t lastRow, const MipTables& tables)
+{
+	if (format == MipFormat::RGBA8)
+	{
+		for (uint32_t y = firstRow; y < lastRow; ++y)
+		{
+			const uint32_t y0 = 2 * y;
+			const uint32_t y1 = min(y0 + 1, srcHeight - 1);
+			BoxFilterRowRGBA8(src + y0 * srcPitch, src + y1 * srcPitch, srcWidth, dest + y * destPitch, destWidth);
+		}
+		return;
+	}
+
+	vector<float> row0(4 * srcWidth);
+	vector<float> row1(4 * srcWidth);
+	vector<float> filtered(4 * destWidth);
+
+	for (uint32_t y = firstRow; y < lastRow; ++y)
+	{
+		const uint32_t y0 = 2 * y;
+		const uint32_t y1 = min(y0 + 1, srcHeight - 1);
+		LoadRow(format, src + y0 * srcPitch, srcWidth, row0.data(), tables);
+		LoadRow(format, src + y1 * srcPitch, srcWidth, row1.data(), tables);
+		BoxFilterRowFloat(row0.data(), row1.data(), srcWidth, filtered.data(), destWidth);
+		StoreRow(format, filtered.data(), destWidth, dest + y * destPitch, tables);
+	}
+}
+
+
+void GenerateKaiserRows(MipFormat format, const uint8_t* src, uint32_t srcWidth, uint32_t srcHeight, size_t srcPitch,
+	uint8_t* dest, size_t destPitch, uint32_t destWidth, uint32_t firstRow, uint32_t lastRow, const MipTables& tables)
+{
+	const int32_t lastSrcRow = static_cast<int32_t>(srcHeight) - 1;
+
+	__m128 weights[s_kaiserTaps];
+	for (int32_t k = 0; k < s_kaiserTaps; ++k)
+	{
+		weights[k] = _mm_set1_ps(tables.kaiserWeights[k]);
+	}
+
+	// Source rows are filtered horizontally once each, into a ring that holds the taps of one destination row
+	const int32_t ringSize = 16;
+	static_assert(s_kaiserTaps <= ringSize, "Kaiser ring is too small");
+
+	vector<float> row(4 * srcWidth);
+	vector<float> ring(4 * destWidth * ringSize);
+	int32_t nextSrcRow = max(2 * static_cast<int32_t>(firstRow) + s_kaiserFirstTap, 0);
+
+	vector<float> filtered(4 * destWidth);
+	for (uint32_t y = firstRow; y < lastRow; ++y)
+	{
+		const int32_t endSrcRow = min(2 * static_cast<int32_t>(y) + s_kaiserFirstTap + s_kaiserTaps - 1, lastSrcRow) + 1;
+		for (; nextSrcRow < endSrcRow; ++nextSrcRow)
+		{
+			LoadRow(format, src + nextSrcRow * srcPitch, srcWidth, row.data(), tables);
+			KaiserFilterRow(row.data(), srcWidth, ring.data() + 4 * destWidth * (nextSrcRow % ringSize), destWidth, weights);
+		}
+
+		const float* rows[s_kaiserTaps];
+		for (int32_t k = 0; k < s_kaiserTaps; ++k)
+		{
+			const int32_t srcY = min(max(2 * static_cast<int32_t>(y) + s_kaiserFirstTap + k, 0), lastSrcRow);
+			rows[k] = ring.data() + 4 * destWidth * (srcY % ringSize);
+		}
+
+		for (uint32_t x = 0; x < destWidth; ++x)
+		{
+			__m128 sum = _mm_setzero_ps();
+			for (int32_t k = 0; k < s_kaiserTaps; ++k)
+			{
+				sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(rows[k] + 4 * x), weights[k]));
+			}
+			_mm_storeu_ps(filtered.data() + 4 * x, sum);
+		}
+
+		StoreRow(format, filtered.data(), destWidth, dest + y * destPitch, tables);
+	}
+}
+
+} // anonymous namespace
+
+
+namespace Kodiak
+{
+
+size_t GetMipFormatPixelBytes(MipFormat format)
+{
+	return (format == MipFormat::RGBA16F) ? 8 : 4;
+}
+
+
+uint32_t GetFullMipCount(uint32_t width, uint32_t height)
+{
+	uint32_t count = 1;
+	while (width > 1 || height > 1)
+	{
+		width = max<uint32_t>(1, width / 2);
+		height = max<uint32_t>(1, height / 2);
+		++count;
+	}
+	return count;
+}
+
+
+void GenerateMipRows(MipFormat format, MipFilter filter, const uint8_t* src, uint32_t srcWidth, uint32_t srcHeight, size_t srcPitch,
+	uint8_t* dest, size_t destPitch, uint32_t firstRow, uint32_t rowCount)
+{
+	assert(srcWidth > 0 && srcHeight > 0);
+
+	const uint32_t destWidth = max<uint32_t>(1, srcWidth / 2);
+	const uint32_t destHeight = max<uint32_t>(1, srcHeight / 2);
+	const uint32_t lastRow = min(firstRow + rowCount, destHeight);
+	if (firstRow >= lastRow)
+	{
+		return;
+	}
+
+	const auto& tables = GetMipTables();
+
+	if (filter == MipFilter::Box)
+	{
+		GenerateBoxRows(format, src, srcWidth, srcHeight, srcPitch, dest, destPitch, destWidth, firstRow, lastRow, tables);
+	}
+	else
+	{
+		GenerateKaiserRows(format, src, srcWidth, srcHeight, srcPitch, dest, destPitch, destWidth, firstRow, lastRow, tables);
+	}
+}
+
+} // namespace Kodiak
\ No newline at end of file
@@ -0,0 +1,48 @@
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+// Author: David Elder
+//
+
+#pragma once
+
+// CPU mip generation for uncompressed 4-channel textures.  Each level is filtered from the one above it,
+// sRGB color channels are filtered in linear space, and alpha is always linear.  Half floats convert
+// with F16C when the CPU has it.  This header and MipGenerator.cpp only depend on the standard library
+// and the SSE intrinsics.
+
+#include <cstddef>
+#include <cstdint>
+
+namespace Kodiak
+{
+
+enum class MipFormat
+{
+	RGBA8,			// Also BGRA8, the filters don't care about channel order
+	RGBA8_sRGB,
+	RGBA16F
+};
+
+
+enum class MipFilter
+{
+	Box,			// 2x2 average
+	Kaiser			// Kaiser-windowed sinc, 3 texels wide at the destination, sharper than Box
+};
+
+
+size_t GetMipFormatPixelBytes(MipFormat format);
+
+// Number of levels in a full chain, down to 1x1
+uint32_t GetFullMipCount(uint32_t width, uint32_t height);
+
+// Writes the rows [firstRow, firstRow + rowCount) of the level below src, which is max(1, srcWidth / 2) by
+// max(1, srcHeight / 2).  Disjoint ranges of rows can be generated concurrently.
+void GenerateMipRows(MipFormat format, MipFilter filter, const uint8_t* src, uint32_t srcWidth, uint32_t srcHeight, size_t srcPitch,
+	uint8_t* dest, size_t destPitch, uint32_t firstRow, uint32_t rowCount);
+
+} // namespace Kodiak
\ No newline at end of file
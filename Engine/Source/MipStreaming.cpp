@@ -0,0 +1,167 @@
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+// Author: David Elder
+//
+
+// Built without the precompiled header, so that tools can share it
+
+#include "MipStreaming.h"
+
+#include <cfloat>
+#include <cmath>
+#include <numeric>
+
+
+using namespace Kodiak;
+using namespace std;
+
+
+namespace Kodiak
+{
+
+uint32_t ComputeDesiredMip(float distance, float fullDetailDistance, uint32_t mipCount)
+{
+	if (mipCount <= 1 || distance <= fullDetailDistance || fullDetailDistance <= 0.0f)
+	{
+		return 0;
+	}
+
+	uint32_t mip = static_cast<uint32_t>(floorf(log2f(distance / fullDetailDistance)));
+	return std::min<uint32_t>(mip, mipCount - 1);
+}
+
+
+size_t MipStreamingScheduler::ComputeResidentBytes(const vector<MipStreamingState>& states)
+{
+	size_t numBytes = 0;
+	for (const auto& state : states)
+	{
+		numBytes += state.residentBytes[state.residentMip];
+	}
+	return numBytes;
+}
+
+
+vector<MipStreamingDecision> MipStreamingScheduler::Schedule(vector<MipStreamingState>& states) const
+{
+	vector<MipStreamingDecision> decisions;
+
+	// Visit textures from highest to lowest priority.  The sort is stable so that equal priorities
+	// stream in registration order, which keeps the schedule deterministic.
+	vector<size_t> order(states.size());
+	iota(begin(order), end(order), 0);
+	stable_sort(begin(order), end(order), [&states](size_t a, size_t b)
+	{
+		return states[a].priority > states[b].priority;
+	});
+
+	vector<int32_t> decisionIndex(states.size(), -1);
+	auto recordDecision = [&decisions, &decisionIndex, &states](size_t stateIndex)
+	{
+		const auto& state = states[stateIndex];
+		if (decisionIndex[stateIndex] == -1)
+		{
+			decisionIndex[stateIndex] = static_cast<int32_t>(decisions.size());
+			decisions.push_back({ state.id, state.residentMip });
+		}
+		else
+		{
+			decisions[decisionIndex[stateIndex]].newResidentMip = state.residentMip;
+		}
+	};
+
+	size_t residentBytes = ComputeResidentBytes(states);
+	vector<bool> evicted(states.size(), false);
+	size_t evictCursor = order.size();
+
+	// Drops one stage from the lowest-priority texture that still has detail to give up, as long as its
+	// priority is strictly below the given limit.  Returns false when nothing could be evicted.
+	auto evictOneStage = [&](size_t minOrderIndex, float priorityLimit)
+	{
+		while (evictCursor > minOrderIndex)
+		{
+			size_t victimIndex = order[evictCursor - 1];
+			auto& victim = states[victimIndex];
+
+			if (victim.priority >= priorityLimit)
+			{
+				return false;
+			}
+
+			if (victim.residentMip >= victim.minDetailMip)
+			{
+				--evictCursor;
+				continue;
+			}
+
+			uint32_t victimMip = std::min<uint32_t>(victim.residentMip + m_mipsPerStage, victim.minDetailMip);
+			residentBytes -= victim.residentBytes[victim.residentMip] - victim.residentBytes[victimMip];
+			victim.residentMip = victimMip;
+			evicted[victimIndex] = true;
+			recordDecision(victimIndex);
+			return true;
+		}
+		return false;
+	};
+
+	uint32_t numStreams = 0;
+	for (size_t n = 0; n < order.size() && numStreams < m_maxStreamsPerUpdate; ++n)
+	{
+		size_t stateIndex = order[n];
+		auto& state = states[stateIndex];
+
+		if (evicted[stateIndex] || state.residentMip <= state.desiredMip)
+		{
+			continue;
+		}
+
+		uint32_t targetMip = (state.residentMip > state.desiredMip + m_mipsPerStage)
+			? state.residentMip - m_mipsPerStage
+			: state.desiredMip;
+		size_t cost = state.residentBytes[targetMip] - state.residentBytes[state.residentMip];
+
+		if (residentBytes + cost > m_memoryBudget)
+		{
+			// Only evict if doing so actually makes enough room, otherwise the freed memory would
+			// just be picked up by a lower priority texture later in this pass
+			size_t shortfall = residentBytes + cost - m_memoryBudget;
+			size_t reclaimable = 0;
+			for (size_t k = evictCursor; k > n + 1 && reclaimable < shortfall; --k)
+			{
+				const auto& victim = states[order[k - 1]];
+				if (victim.priority >= state.priority)
+				{
+					break;
+				}
+				if (victim.residentMip < victim.minDetailMip)
+				{
+					reclaimable += victim.residentBytes[victim.residentMip] - victim.residentBytes[victim.minDetailMip];
+				}
+			}
+
+			if (reclaimable < shortfall)
+			{
+				continue;
+			}
+
+			// Make room by taking detail away from less important textures
+			while (residentBytes + cost > m_memoryBudget && evictOneStage(n + 1, state.priority)) {}
+		}
+
+		residentBytes += cost;
+		state.residentMip = targetMip;
+		recordDecision(stateIndex);
+		++numStreams;
+	}
+
+	// The budget may have shrunk since the last pass, so trim until we fit again
+	while (residentBytes > m_memoryBudget && evictOneStage(0, FLT_MAX)) {}
+
+	return decisions;
+}
+
+} // namespace Kodiak
\ No newline at end of file
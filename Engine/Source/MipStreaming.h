@@ -0,0 +1,74 @@
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+// Author: David Elder
+//
+
+#pragma once
+
+// Mip-range selection for texture streaming.  This header and MipStreaming.cpp only depend on the standard
+// library, so the scheduler can be run against a simulated budget without a GPU.
+
+#include "TextureResidency.h"
+
+#include <algorithm>
+
+namespace Kodiak
+{
+
+// Maps a viewer distance to the most detailed mip worth keeping resident.  Full detail is requested
+// inside fullDetailDistance, and one mip is dropped each time the distance doubles beyond it.
+uint32_t ComputeDesiredMip(float distance, float fullDetailDistance, uint32_t mipCount);
+
+
+// Streaming state of a single texture, as seen by the scheduler
+struct MipStreamingState
+{
+	uint64_t	id{ 0 };
+	float		priority{ 0.0f };
+	uint32_t	residentMip{ 0 };		// Most detailed mip currently resident
+	uint32_t	desiredMip{ 0 };		// Most detailed mip the texture wants
+	uint32_t	minDetailMip{ 0 };		// Coarsest stage, which is never evicted
+
+	// residentBytes[m] is the memory footprint when mip m is the most detailed resident mip
+	std::array<size_t, kMaxStreamingMips> residentBytes;
+};
+
+
+struct MipStreamingDecision
+{
+	uint64_t	id;
+	uint32_t	newResidentMip;
+};
+
+
+// Decides which textures stream in (or give up) mip levels, in priority order, such that the total
+// resident size stays below a memory budget.
+class MipStreamingScheduler
+{
+public:
+	void SetMemoryBudget(size_t bytes) { m_memoryBudget = bytes; }
+	size_t GetMemoryBudget() const { return m_memoryBudget; }
+
+	void SetMipsPerStage(uint32_t mips) { m_mipsPerStage = std::max<uint32_t>(1, mips); }
+	uint32_t GetMipsPerStage() const { return m_mipsPerStage; }
+
+	void SetMaxStreamsPerUpdate(uint32_t count) { m_maxStreamsPerUpdate = count; }
+	uint32_t GetMaxStreamsPerUpdate() const { return m_maxStreamsPerUpdate; }
+
+	// Runs one scheduling pass.  The residentMip of each state is updated to reflect the returned
+	// decisions, so repeated calls simulate streaming converging over several frames.
+	std::vector<MipStreamingDecision> Schedule(std::vector<MipStreamingState>& states) const;
+
+	static size_t ComputeResidentBytes(const std::vector<MipStreamingState>& states);
+
+private:
+	size_t		m_memoryBudget{ 256 * 1024 * 1024 };
+	uint32_t	m_mipsPerStage{ 1 };
+	uint32_t	m_maxStreamsPerUpdate{ 8 };
+};
+
+} // namespace Kodiak
\ No newline at end of file
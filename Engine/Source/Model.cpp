@@ -15,6 +15,8 @@
 #include "ConstantBuffer.h"
 #include "Defaults.h"
 #include "IndexBuffer.h"
+#include "LoadGraph.h"
+#include "LoaderEnums.h"
 #include "Material.h"
 #include "Paths.h"
 #include "Profile.h"
@@ -40,6 +42,8 @@ void RenderThread::StaticModelData::UpdateConstants(GraphicsCommandList& command
 			StaticMeshPerObjectData perObjectData;
 			
 			perObjectData.matrix = matrix * mesh->matrix;
+			perObjectData.positionScale = mesh->positionScale;
+			perObjectData.positionBias = mesh->positionBias;
 
 			auto dest = commandList.MapConstants(*mesh->perObjectConstants);
 			memcpy(dest, &perObjectData, sizeof(perObjectData));
@@ -55,6 +59,8 @@ void RenderThread::StaticModelData::UpdateConstants(GraphicsCommandList& command
 
 StaticMesh::StaticMesh()
 	: m_matrix(kIdentity)
+	, m_positionScale(kOne)
+	, m_positionBias(kZero)
 {
 	CreateRenderThreadData();
 }
@@ -106,15 +112,53 @@ void StaticMesh::ConcatenateMatrix(const Matrix4& matrix)
 }
 
 
+void StaticMesh::SetPositionDequantization(const Vector3& scale, const Vector3& bias)
+{
+	m_positionScale = scale;
+	m_positionBias = bias;
+
+	DirectX::XMFLOAT3 scaleNonAligned;
+	DirectX::XMFLOAT3 biasNonAligned;
+	DirectX::XMStoreFloat3(&scaleNonAligned, scale);
+	DirectX::XMStoreFloat3(&biasNonAligned, bias);
+
+	auto staticMeshData = m_renderThreadData;
+	EnqueueRenderCommand([staticMeshData, scaleNonAligned, biasNonAligned]()
+	{
+		staticMeshData->positionScale = Vector3(DirectX::XMLoadFloat3(&scaleNonAligned));
+		staticMeshData->positionBias = Vector3(DirectX::XMLoadFloat3(&biasNonAligned));
+		staticMeshData->isDirty = true;
+	});
+}
+
+
+void StaticMesh::SetMeshlets(shared_ptr<const vector<Meshlet>> meshlets)
+{
+	m_meshlets = meshlets;
+
+	auto staticMeshData = m_renderThreadData;
+	EnqueueRenderCommand([staticMeshData, meshlets]()
+	{
+		staticMeshData->meshlets = meshlets;
+		staticMeshData->visibleRanges.clear();
+	});
+}
+
+
 shared_ptr<StaticMesh> StaticMesh::Clone()
 {
 	auto clone = make_shared<StaticMesh>();
 	clone->SetMatrix(m_matrix);
+	clone->SetPositionDequantization(m_positionScale, m_positionBias);
+	if (m_meshlets)
+	{
+		clone->SetMeshlets(m_meshlets);
+	}
 
 	for (const auto& part : m_meshParts)
 	{
 		StaticMeshPart partCopy = part;
-		partCopy.material = part.material->Clone();
+		partCopy.material = part.material->CreateInstance();
 		clone->AddMeshPart(partCopy);
 	}
 
@@ -126,6 +170,8 @@ void StaticMesh::CreateRenderThreadData()
 {
 	m_renderThreadData = make_shared<RenderThread::StaticMeshData>();
 	m_renderThreadData->matrix = m_matrix;
+	m_renderThreadData->positionScale = m_positionScale;
+	m_renderThreadData->positionBias = m_positionBias;
 	
 	m_renderThreadData->perObjectConstants = make_shared<ConstantBuffer>();
 	m_renderThreadData->perObjectConstants->Create(sizeof(RenderThread::StaticMeshPerObjectData), Usage::Dynamic);
@@ -149,6 +195,9 @@ void StaticModel::AddMesh(shared_ptr<StaticMesh> mesh)
 	EnqueueRenderCommand([staticModelData, staticMeshData]()
 	{
 		staticModelData->meshes.emplace_back(staticMeshData);
+
+		// The new mesh's materials haven't been tracked, so go back to checking each one
+		staticModelData->isResident = false;
 	});
 }
 
@@ -173,6 +222,49 @@ void StaticModel::SetMatrix(const Matrix4& matrix)
 }
 
 
+void StaticModel::SetGeometry(shared_ptr<GeometryAllocation> geometry)
+{
+	m_geometry = geometry;
+
+	auto staticModelData = m_renderThreadData;
+	EnqueueRenderCommand([staticModelData, geometry]()
+	{
+		staticModelData->geometry = geometry;
+	});
+}
+
+
+void StaticModel::SetLoadNode(shared_ptr<LoadNode> node)
+{
+	m_loadNode = node;
+
+	// Once everything has loaded, draws can stop checking each material
+	auto staticModelData = m_renderThreadData;
+	node->AddCompletionCallback([staticModelData](LoadState state)
+	{
+		if (state == LoadState::LoadSucceeded)
+		{
+			EnqueueRenderCommand([staticModelData]()
+			{
+				staticModelData->isResident = true;
+			});
+		}
+	});
+}
+
+
+shared_future<LoadState> StaticModel::GetResidentFuture() const
+{
+	return m_loadNode ? m_loadNode->GetFuture() : shared_future<LoadState>();
+}
+
+
+bool StaticModel::IsFullyResident() const
+{
+	return m_loadNode && m_loadNode->GetLoadState() == LoadState::LoadSucceeded;
+}
+
+
 void StaticModel::CreateRenderThreadData()
 {
 	const auto numMeshes = m_meshes.size();
@@ -412,6 +504,7 @@ enum class ModelFormat : uint32_t
 {
 	None,
 	H3D,
+	Cooked,
 
 	NumFormats
 };
@@ -420,12 +513,13 @@ const string s_formatString[] =
 {
 	"none",
 	"h3d",
+	"kmdl",
 };
 
 } // Anonymous namespace
 
 
-std::shared_ptr<StaticModel> LoadModel(const string& path)
+std::shared_ptr<StaticModel> LoadModel(const string& path, const ModelLoadDesc& desc)
 {
 	ModelFormat format = ModelFormat::None;
 
@@ -451,7 +545,11 @@ std::shared_ptr<StaticModel> LoadModel(const string& path)
 			switch (format)
 			{
 			case ModelFormat::H3D:
-				return LoadModelH3D(fullPath);
+				return LoadModelH3D(fullPath, desc);
+				break;
+
+			case ModelFormat::Cooked:
+				return LoadModelCooked(fullPath, desc);
 				break;
 			}
 		}
@@ -9,6 +9,8 @@
 
 #pragma once
 
+#include "Meshlet.h"
+
 #include <ppltasks.h>
 #include <unordered_set>
 
@@ -17,12 +19,15 @@ namespace Kodiak
 
 // Forward declarations
 class ConstantBuffer;
+class GeometryAllocation;
 class GraphicsCommandList;
 class IndexBuffer;
+class LoadNode;
 class Material;
 class Scene;
 class VertexBuffer;
 
+enum class LoadState;
 enum class PrimitiveTopology;
 
 
@@ -46,15 +51,24 @@ struct StaticMeshData
 {
 	std::vector<StaticMeshPartData>		meshParts;
 	Math::Matrix4						matrix;
+	Math::Vector3						positionScale;
+	Math::Vector3						positionBias;
 
 	std::shared_ptr<ConstantBuffer>		perObjectConstants;
 	bool								isDirty{ true };
+
+	// Meshlets cover the index range shared by all the mesh parts.  Scene::CullMeshlets culls them against
+	// the camera, leaving the index ranges to draw this frame, relative to the parts' startIndex.
+	std::shared_ptr<const std::vector<Meshlet>>	meshlets;
+	std::vector<MeshletIndexRange>				visibleRanges;
 };
 
 
 struct StaticMeshPerObjectData
 {
 	Math::Matrix4 matrix;
+	Math::Vector3 positionScale;
+	Math::Vector3 positionBias;
 };
 
 
@@ -65,6 +79,12 @@ struct StaticModelData
 
 	bool											isDirty{ true };
 
+	// Set once every material is known to be ready, so draws can skip the per-part checks
+	bool											isResident{ false };
+
+	// Keeps the model's range of the shared geometry buffers from being reused while it's still drawn
+	std::shared_ptr<GeometryAllocation>				geometry;
+
 	void UpdateConstants(GraphicsCommandList& commandList);
 };
 
@@ -101,11 +121,19 @@ public:
 	void ConcatenateMatrix(const Math::Matrix4& matrix);
 	const Math::Matrix4& GetMatrix() const { return m_matrix; }
 
+	// Meshes with quantized vertices (see VertexQuantization.h) decode positions as position * scale + bias
+	void SetPositionDequantization(const Math::Vector3& scale, const Math::Vector3& bias);
+
+	// Meshlets built over the mesh parts' shared index range (see Meshlet.h), so the scene can cull
+	// the parts of the mesh that the camera can't see.  Shadow passes still draw the whole mesh.
+	void SetMeshlets(std::shared_ptr<const std::vector<Meshlet>> meshlets);
+
 	std::shared_ptr<Material> GetMaterial(uint32_t meshPartIndex)
 	{
 		return m_meshParts[meshPartIndex].material;
 	}
 
+	// The clone's mesh parts use instances of this mesh's materials (see Material::CreateInstance)
 	std::shared_ptr<StaticMesh> Clone();
 
 private:
@@ -114,6 +142,9 @@ private:
 private:
 	std::vector<StaticMeshPart>	m_meshParts;
 	Math::Matrix4				m_matrix;
+	Math::Vector3				m_positionScale;
+	Math::Vector3				m_positionBias;
+	std::shared_ptr<const std::vector<Meshlet>>	m_meshlets;
 
 	std::shared_ptr<RenderThread::StaticMeshData>	m_renderThreadData;
 };
@@ -133,6 +164,17 @@ public:
 	void SetMatrix(const Math::Matrix4& matrix);
 	const Math::Matrix4& GetMatrix() const { return m_matrix; }
 
+	// The model's vertices and indices in the GeometryPool, which the mesh parts draw from
+	void SetGeometry(std::shared_ptr<GeometryAllocation> geometry);
+
+	// Load tracking.  Loaders hand the model the root of its load graph; the model is fully
+	// resident once every texture, material and buffer under it has loaded.  Use the node to
+	// prioritize or cancel parts of the load.
+	void SetLoadNode(std::shared_ptr<LoadNode> node);
+	std::shared_ptr<LoadNode> GetLoadNode() { return m_loadNode; }
+	std::shared_future<LoadState> GetResidentFuture() const;
+	bool IsFullyResident() const;
+
 private:
 	void CreateRenderThreadData();
 
@@ -140,6 +182,8 @@ private:
 	std::mutex									m_meshMutex;
 	std::vector<std::shared_ptr<StaticMesh>>	m_meshes;
 	Math::Matrix4								m_matrix;
+	std::shared_ptr<LoadNode>					m_loadNode;
+	std::shared_ptr<GeometryAllocation>			m_geometry;
 
 	std::shared_ptr<RenderThread::StaticModelData>	m_renderThreadData;
 };
@@ -161,7 +205,24 @@ struct BoxMeshDesc
 std::shared_ptr<StaticMesh> MakeBoxMesh(const BoxMeshDesc& desc);
 
 // Loaders
-std::shared_ptr<StaticModel> LoadModel(const std::string& path);
-std::shared_ptr<StaticModel> LoadModelH3D(const std::string& fullPath);
+struct ModelLoadDesc
+{
+	// Reorder H3D meshes for the vertex cache at load time.  Cooked models are optimized offline.
+	bool optimizeMeshes{ false };
+
+	// Convert H3D vertices to QuantizedVertex.  Needs the quantized default effects.
+	bool quantizeVertices{ false };
+
+	// Cull meshes per meshlet, with Scene::CullMeshlets.  H3D meshes are split into meshlets at load time,
+	// and cooked models use the meshlets the cooker stored.
+	bool buildMeshlets{ false };
+
+	// Pack same-format, same-size textures into texture arrays.  Needs the packed default effects.
+	bool packTextures{ false };
+};
+
+std::shared_ptr<StaticModel> LoadModel(const std::string& path, const ModelLoadDesc& desc = ModelLoadDesc());
+std::shared_ptr<StaticModel> LoadModelH3D(const std::string& fullPath, const ModelLoadDesc& desc = ModelLoadDesc());
+std::shared_ptr<StaticModel> LoadModelCooked(const std::string& fullPath, const ModelLoadDesc& desc = ModelLoadDesc());
 
 } // namespace Kodiak
\ No newline at end of file
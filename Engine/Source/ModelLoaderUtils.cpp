@@ -0,0 +1,563 @@
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+// Author: David Elder
+//
+
+#include "Stdafx.h"
+
+#include "ModelLoaderUtils.h"
+
+#include "CommandList.h"
+#include "DDSCommon.h"
+#include "Defaults.h"
+#include "Filesystem.h"
+#include "LoadGraph.h"
+#include "Material.h"
+#include "MaterialParameter.h"
+#include "MaterialResource.h"
+#include "Texture.h"
+#include "TexturePacking.h"
+#include "TextureResource.h"
+#include "TextureStreaming.h"
+
+
+using namespace Kodiak;
+using namespace Math;
+using namespace std;
+
+
+namespace
+{
+
+enum TextureSlot
+{
+	kDiffuse,
+	kSpecular,
+	kNormal,
+
+	kNumTextureSlots
+};
+
+
+const char* const kDefaultTexturePaths[kNumTextureSlots] = { "default.DDS", "default_specular.DDS", "default_normal.DDS" };
+const char* const kTextureNames[kNumTextureSlots] = { "texDiffuse", "texSpecular", "texNormal" };
+
+const uint32_t kNotPacked = ~0u;
+
+
+// Returns the first of the paths that exists, or the default texture's path
+string ResolveTexturePath(const string& path, const string& fallbackPath, TextureSlot slot)
+{
+	auto& filesystem = Filesystem::GetInstance();
+	if (filesystem.IsRegularFile(path))
+	{
+		return path;
+	}
+	else if (!fallbackPath.empty() && filesystem.IsRegularFile(fallbackPath))
+	{
+		return fallbackPath;
+	}
+	return kDefaultTexturePaths[slot];
+}
+
+
+struct MaterialEffects
+{
+	shared_ptr<Effect> base;
+	shared_ptr<Effect> depth;
+	shared_ptr<Effect> shadow;
+};
+
+
+// Safe to call from worker threads.  Parameters set before the effect are only stored on the
+// material, and SetEffect copies them into the new render thread data without enqueuing anything.
+// The render pass is set first too, since the effect's finalized callback can set up the render
+// thread data on the main thread while this is still running.
+ModelMaterialSet CreateMaterialSet(const MaterialEffects& effects, const DirectX::XMUINT3* textureSlices)
+{
+	ModelMaterialSet materials;
+
+	// Setup opaque base-pass material
+	auto opaqueMaterial = materials.opaque = make_shared<Material>();
+
+	// TODO move this stuff to per-view data
+	using namespace DirectX;
+	opaqueMaterial->GetParameter("sunDirection")->SetValue(Vector3(0.336f, 0.924f, -0.183f));
+	opaqueMaterial->GetParameter("sunColor")->SetValue(Vector3(4.0f, 4.0f, 4.0f));
+	opaqueMaterial->GetParameter("ambientColor")->SetValue(Vector3(0.1f, 0.1f, 0.1f));
+	opaqueMaterial->GetParameter("shadowTexelSize")->SetValue(1.0f / 2048.0f);
+
+	// Setup depth and shadow materials
+	auto depthMaterial = materials.depth = make_shared<Material>();
+	auto shadowMaterial = materials.shadow = make_shared<Material>();
+
+	if (textureSlices)
+	{
+		opaqueMaterial->GetParameter("textureSlices")->SetValue(*textureSlices);
+		depthMaterial->GetParameter("textureSlices")->SetValue(*textureSlices);
+		shadowMaterial->GetParameter("textureSlices")->SetValue(*textureSlices);
+	}
+
+	opaqueMaterial->SetRenderPass(GetDefaultBasePass());
+	opaqueMaterial->SetEffect(effects.base);
+
+	depthMaterial->SetRenderPass(GetDefaultDepthPass());
+	depthMaterial->SetEffect(effects.depth);
+
+	shadowMaterial->SetRenderPass(GetDefaultShadowPass());
+	shadowMaterial->SetEffect(effects.shadow);
+
+	return materials;
+}
+
+
+// Reads just the DDS headers.  Returns false for textures that can't be a slice of a 2D texture array.
+bool ReadPackInput(const TextureLoadRequest& request, TexturePackInput& input)
+{
+	const string fullPath = Filesystem::GetInstance().GetFullPath(request.path);
+
+	ifstream file(fullPath, ios::binary | ios::ate);
+	if (!file)
+	{
+		return false;
+	}
+
+	const size_t fileSize = static_cast<size_t>(file.tellg());
+	const size_t headerSize = min(fileSize, kMaxDDSHeaderBytes);
+
+	uint8_t header[kMaxDDSHeaderBytes];
+	file.seekg(0);
+	file.read(reinterpret_cast<char*>(header), headerSize);
+
+	DDSLayout layout;
+	if (!file || ParseDDSHeader(header, headerSize, fileSize, layout) != DDSParseResult::Success)
+	{
+		return false;
+	}
+
+	if (layout.dimension != kDDSDimensionTexture2D || layout.arraySize != 1 || layout.isCubeMap)
+	{
+		return false;
+	}
+
+	// The DDS loaders pick the sRGB variant, so the array has to match it for the copies
+	const auto layoutFormat = static_cast<DXGI_FORMAT>(layout.format);
+	const DXGI_FORMAT format = request.isSRGB ? DDS::MakeSRGB(layoutFormat) : layoutFormat;
+	if (DXGIUtility::ConvertFromDXGI(format) == ColorFormat::Unknown)
+	{
+		return false;
+	}
+
+	input.format = static_cast<uint32_t>(format);
+	input.width = layout.width;
+	input.height = layout.height;
+	input.mipCount = layout.mipCount;
+	return true;
+}
+
+
+// Which materials sample texture arrays, and where their textures go
+struct TextureArrayPlan
+{
+	vector<bool>				packedMaterials;
+	vector<uint32_t>			requestInputs;		// Pack input of each texture request, or kNotPacked
+	vector<TexturePackInput>	inputs;
+	TexturePackLayout			layout;
+};
+
+
+TextureArrayPlan PlanTextureArrays(const vector<TextureLoadRequest>& requests, const vector<array<size_t, kNumTextureSlots>>& textureIndices)
+{
+	const size_t requestCount = requests.size();
+	const size_t materialCount = textureIndices.size();
+
+	vector<TexturePackInput> requestInputs(requestCount);
+	vector<uint8_t> packable(requestCount, 0);
+
+	concurrency::parallel_for(size_t(0), requestCount, [&](size_t i)
+	{
+		packable[i] = ReadPackInput(requests[i], requestInputs[i]) ? 1 : 0;
+	});
+
+	TextureArrayPlan plan;
+	plan.packedMaterials.resize(materialCount, false);
+	plan.requestInputs.resize(requestCount, kNotPacked);
+
+	// A material is packed only if all of its textures can be.  Inputs are numbered in request order,
+	// which follows the material order, so the layout only depends on the model.
+	for (size_t i = 0; i < materialCount; ++i)
+	{
+		const auto& indices = textureIndices[i];
+		plan.packedMaterials[i] = packable[indices[kDiffuse]] && packable[indices[kSpecular]] && packable[indices[kNormal]];
+	}
+
+	for (size_t i = 0; i < materialCount; ++i)
+	{
+		if (!plan.packedMaterials[i])
+		{
+			continue;
+		}
+
+		for (auto requestIndex : textureIndices[i])
+		{
+			if (plan.requestInputs[requestIndex] == kNotPacked)
+			{
+				plan.requestInputs[requestIndex] = static_cast<uint32_t>(requestIndex);
+			}
+		}
+	}
+
+	for (size_t i = 0; i < requestCount; ++i)
+	{
+		if (plan.requestInputs[i] != kNotPacked)
+		{
+			plan.requestInputs[i] = static_cast<uint32_t>(plan.inputs.size());
+			plan.inputs.push_back(requestInputs[i]);
+		}
+	}
+
+	plan.layout = PackTextureArrays(plan.inputs);
+	return plan;
+}
+
+
+// A texture array waiting on its slices.  Only touched on the main thread.
+struct PendingTextureArray
+{
+	shared_ptr<Texture>							texture;
+	uint32_t									pendingSlices{ 0 };
+	vector<pair<shared_ptr<Material>, string>>	bindings;
+};
+
+
+// Identifies the SRVs a base pass draw binds.  Arrays get their own range of ids.
+uint32_t GetDescriptorTableId(map<array<uint32_t, kNumTextureSlots>, uint32_t>& tableIds, const array<uint32_t, kNumTextureSlots>& views)
+{
+	auto it = tableIds.find(views);
+	if (it == end(tableIds))
+	{
+		it = tableIds.emplace(views, static_cast<uint32_t>(tableIds.size())).first;
+	}
+	return it->second;
+}
+
+} // anonymous namespace
+
+
+ModelMaterialBuilder::ModelMaterialBuilder(bool quantizedVertices, bool packTextures)
+	: m_quantizedVertices(quantizedVertices)
+	, m_packTextures(packTextures)
+{
+	if (m_packTextures && !SupportsPackedTextures(m_quantizedVertices))
+	{
+		LOG_WARNING << "Can't pack textures into arrays, the packed default effects aren't set";
+		m_packTextures = false;
+	}
+
+	// Packed defaults are copied into arrays, so they need their whole mip chain
+	auto defaultTextures = Texture::LoadBatch(
+	{
+		{ kDefaultTexturePaths[kDiffuse], true, !m_packTextures },
+		{ kDefaultTexturePaths[kSpecular], true, !m_packTextures },
+		{ kDefaultTexturePaths[kNormal], false, !m_packTextures }
+	});
+	m_defaultDiffuse = defaultTextures[kDiffuse];
+	m_defaultSpecular = defaultTextures[kSpecular];
+	m_defaultNormal = defaultTextures[kNormal];
+}
+
+
+bool ModelMaterialBuilder::SupportsQuantizedVertices()
+{
+	return GetDefaultQuantizedBaseEffect() && GetDefaultQuantizedDepthEffect() && GetDefaultQuantizedShadowEffect();
+}
+
+
+bool ModelMaterialBuilder::SupportsPackedTextures(bool quantizedVertices)
+{
+	if (quantizedVertices)
+	{
+		return GetDefaultQuantizedPackedBaseEffect() && GetDefaultQuantizedPackedDepthEffect() && GetDefaultQuantizedPackedShadowEffect();
+	}
+	return GetDefaultPackedBaseEffect() && GetDefaultPackedDepthEffect() && GetDefaultPackedShadowEffect();
+}
+
+
+vector<ModelMaterialSet> ModelMaterialBuilder::Build(const vector<ModelMaterialDesc>& descs, LoadNode& modelNode, const vector<uint32_t>& drawMaterials)
+{
+	const auto startTime = chrono::high_resolution_clock::now();
+
+	const size_t materialCount = descs.size();
+	vector<ModelMaterialSet> materials(materialCount);
+	vector<array<string, kNumTextureSlots>> texturePaths(materialCount);
+
+	// Checking for texture files doesn't involve the render thread
+	concurrency::parallel_for(size_t(0), materialCount, [&](size_t i)
+	{
+		const auto& desc = descs[i];
+
+		auto& paths = texturePaths[i];
+		paths[kDiffuse] = ResolveTexturePath(desc.diffusePath, string(), kDiffuse);
+		paths[kSpecular] = ResolveTexturePath(desc.specularPath, desc.specularFallbackPath, kSpecular);
+		paths[kNormal] = ResolveTexturePath(desc.normalPath, desc.normalFallbackPath, kNormal);
+	});
+
+	// Every distinct texture is requested once
+	vector<TextureLoadRequest> requests;
+	unordered_map<string, size_t> requestIndices;
+	vector<array<size_t, kNumTextureSlots>> textureIndices(materialCount);
+
+	for (size_t i = 0; i < materialCount; ++i)
+	{
+		for (uint32_t slot = 0; slot < kNumTextureSlots; ++slot)
+		{
+			const auto& path = texturePaths[i][slot];
+
+			auto it = requestIndices.find(path);
+			if (it == end(requestIndices))
+			{
+				it = requestIndices.emplace(path, requests.size()).first;
+				requests.push_back({ path, slot != kNormal });
+			}
+			textureIndices[i][slot] = it->second;
+		}
+	}
+
+	TextureArrayPlan plan;
+	if (m_packTextures)
+	{
+		plan = PlanTextureArrays(requests, textureIndices);
+
+		for (size_t i = 0; i < requests.size(); ++i)
+		{
+			requests[i].allowStreaming = (plan.requestInputs[i] == kNotPacked);
+		}
+	}
+	else
+	{
+		plan.packedMaterials.resize(materialCount, false);
+		plan.requestInputs.resize(requests.size(), kNotPacked);
+	}
+
+	MaterialEffects effects;
+	effects.base = m_quantizedVertices ? GetDefaultQuantizedBaseEffect() : GetDefaultBaseEffect();
+	effects.depth = m_quantizedVertices ? GetDefaultQuantizedDepthEffect() : GetDefaultDepthEffect();
+	effects.shadow = m_quantizedVertices ? GetDefaultQuantizedShadowEffect() : GetDefaultShadowEffect();
+
+	MaterialEffects packedEffects;
+	if (m_packTextures)
+	{
+		packedEffects.base = m_quantizedVertices ? GetDefaultQuantizedPackedBaseEffect() : GetDefaultPackedBaseEffect();
+		packedEffects.depth = m_quantizedVertices ? GetDefaultQuantizedPackedDepthEffect() : GetDefaultPackedDepthEffect();
+		packedEffects.shadow = m_quantizedVertices ? GetDefaultQuantizedPackedShadowEffect() : GetDefaultPackedShadowEffect();
+	}
+
+	// Creating the materials doesn't involve the render thread either
+	concurrency::parallel_for(size_t(0), materialCount, [&](size_t i)
+	{
+		if (!plan.packedMaterials[i])
+		{
+			materials[i] = CreateMaterialSet(effects, nullptr);
+			return;
+		}
+
+		const auto& indices = textureIndices[i];
+		DirectX::XMUINT3 textureSlices(
+			plan.layout.placements[plan.requestInputs[indices[kDiffuse]]].slice,
+			plan.layout.placements[plan.requestInputs[indices[kSpecular]]].slice,
+			plan.layout.placements[plan.requestInputs[indices[kNormal]]].slice);
+
+		materials[i] = CreateMaterialSet(packedEffects, &textureSlices);
+	});
+
+	// Request every distinct texture in one batch
+	auto textures = Texture::LoadBatch(requests);
+
+	// Arrays are empty until their slices have been copied in, so materials only bind them after that
+	vector<shared_ptr<PendingTextureArray>> textureArrays;
+	vector<shared_ptr<LoadNode>> arrayNodes;
+	for (size_t i = 0; i < plan.layout.arrays.size(); ++i)
+	{
+		const auto& arrayDesc = plan.layout.arrays[i];
+		const string arrayName = modelNode.GetName() + " texture array " + to_string(i);
+
+		auto textureArray = make_shared<PendingTextureArray>();
+		textureArray->texture = Texture::CreateArray(
+			arrayName,
+			arrayDesc.width,
+			arrayDesc.height,
+			static_cast<uint32_t>(arrayDesc.inputs.size()),
+			arrayDesc.mipCount,
+			DXGIUtility::ConvertFromDXGI(static_cast<DXGI_FORMAT>(arrayDesc.format)));
+		textureArray->pendingSlices = static_cast<uint32_t>(arrayDesc.inputs.size());
+		textureArrays.push_back(textureArray);
+
+		arrayNodes.push_back(make_shared<LoadNode>(arrayName));
+	}
+
+	// Slices of textures that have loaded already are copied right away, so the bindings go in first
+	for (size_t i = 0; i < materialCount; ++i)
+	{
+		if (!plan.packedMaterials[i])
+		{
+			continue;
+		}
+
+		for (uint32_t slot = 0; slot < kNumTextureSlots; ++slot)
+		{
+			auto& textureArray = textureArrays[plan.layout.placements[plan.requestInputs[textureIndices[i][slot]]].arrayIndex];
+
+			textureArray->bindings.emplace_back(materials[i].opaque, kTextureNames[slot]);
+			if (slot == kDiffuse)
+			{
+				textureArray->bindings.emplace_back(materials[i].depth, kTextureNames[slot]);
+				textureArray->bindings.emplace_back(materials[i].shadow, kTextureNames[slot]);
+			}
+		}
+	}
+
+	for (size_t i = 0; i < requests.size(); ++i)
+	{
+		const auto inputIndex = plan.requestInputs[i];
+		if (inputIndex == kNotPacked)
+		{
+			continue;
+		}
+
+		const auto& placement = plan.layout.placements[inputIndex];
+		auto textureArray = textureArrays[placement.arrayIndex];
+		auto texture = textures[i];
+		const uint32_t slice = placement.slice;
+		const string path = requests[i].path;
+
+		texture->GetResource()->AddLoadFinishedCallback([textureArray, texture, slice, path](bool succeeded)
+		{
+			auto resource = texture->GetResource();
+			if (succeeded && !resource->IsStreamed())
+			{
+				CommandList::InitializeTextureArraySlice(*textureArray->texture->GetResource(), slice, *resource);
+			}
+			else
+			{
+				// Loaded by someone else with streaming on, or not at all
+				LOG_WARNING << "Texture " << path << " couldn't be copied into slice " << slice << " of its texture array";
+			}
+
+			if (--textureArray->pendingSlices == 0)
+			{
+				for (auto& binding : textureArray->bindings)
+				{
+					binding.first->SetResource(binding.second, textureArray->texture);
+				}
+				textureArray->bindings.clear();
+			}
+		});
+
+		// Tracked after adding the callback, so a new texture node only finishes once the slice is in
+		arrayNodes[placement.arrayIndex]->AddDependency(texture->GetLoadNode());
+	}
+
+	for (auto& arrayNode : arrayNodes)
+	{
+		arrayNode->FinishWork();
+	}
+
+	// Binding textures may enqueue render commands, so it stays on this thread
+	for (size_t i = 0; i < materialCount; ++i)
+	{
+		auto opaqueMaterial = materials[i].opaque;
+		auto depthMaterial = materials[i].depth;
+		auto shadowMaterial = materials[i].shadow;
+
+		auto materialNode = make_shared<LoadNode>(descs[i].name);
+
+		if (plan.packedMaterials[i])
+		{
+			// Array nodes finish after the arrays have been bound to the materials
+			for (uint32_t slot = 0; slot < kNumTextureSlots; ++slot)
+			{
+				materialNode->AddDependency(arrayNodes[plan.layout.placements[plan.requestInputs[textureIndices[i][slot]]].arrayIndex]);
+			}
+
+			materialNode->FinishWork();
+			modelNode.AddDependency(materialNode);
+			continue;
+		}
+
+		auto diffuseTexture = textures[textureIndices[i][kDiffuse]];
+		diffuseTexture->AddPostLoadCallback([opaqueMaterial, depthMaterial, shadowMaterial, diffuseTexture]()
+		{
+			opaqueMaterial->SetResource("texDiffuse", diffuseTexture);
+			depthMaterial->SetResource("texDiffuse", diffuseTexture);
+			shadowMaterial->SetResource("texDiffuse", diffuseTexture);
+		});
+
+		auto specularTexture = textures[textureIndices[i][kSpecular]];
+		specularTexture->AddPostLoadCallback([opaqueMaterial, specularTexture]()
+		{
+			opaqueMaterial->SetResource("texSpecular", specularTexture);
+		});
+
+		auto normalTexture = textures[textureIndices[i][kNormal]];
+		normalTexture->AddPostLoadCallback([opaqueMaterial, normalTexture]()
+		{
+			opaqueMaterial->SetResource("texNormal", normalTexture);
+		});
+
+		// Texture nodes finish after the callbacks above have bound them to the materials
+		materialNode->AddDependency(diffuseTexture->GetLoadNode());
+		materialNode->AddDependency(specularTexture->GetLoadNode());
+		materialNode->AddDependency(normalTexture->GetLoadNode());
+		materialNode->FinishWork();
+
+		modelNode.AddDependency(materialNode);
+	}
+
+	const chrono::duration<double, milli> elapsed = chrono::high_resolution_clock::now() - startTime;
+	LOG_INFO << "Set up " << materialCount << " materials (" << (3 * materialCount) << " Material objects, "
+		<< requests.size() << " distinct textures) in " << elapsed.count() << " ms";
+
+	if (m_packTextures)
+	{
+		// Base pass SRV table changes, drawing each mesh once in order, with and without the arrays
+		map<array<uint32_t, kNumTextureSlots>, uint32_t> tableIds;
+		vector<uint32_t> unpackedTables;
+		vector<uint32_t> packedTables;
+
+		const size_t drawCount = drawMaterials.empty() ? materialCount : drawMaterials.size();
+		for (size_t draw = 0; draw < drawCount; ++draw)
+		{
+			const size_t i = drawMaterials.empty() ? draw : drawMaterials[draw];
+			const auto& indices = textureIndices[i];
+
+			array<uint32_t, kNumTextureSlots> views;
+			for (uint32_t slot = 0; slot < kNumTextureSlots; ++slot)
+			{
+				views[slot] = static_cast<uint32_t>(indices[slot]);
+			}
+			unpackedTables.push_back(GetDescriptorTableId(tableIds, views));
+
+			if (plan.packedMaterials[i])
+			{
+				for (uint32_t slot = 0; slot < kNumTextureSlots; ++slot)
+				{
+					const auto arrayIndex = plan.layout.placements[plan.requestInputs[indices[slot]]].arrayIndex;
+					views[slot] = static_cast<uint32_t>(requests.size()) + arrayIndex;
+				}
+			}
+			packedTables.push_back(GetDescriptorTableId(tableIds, views));
+		}
+
+		const auto packedMaterialCount = count(begin(plan.packedMaterials), end(plan.packedMaterials), true);
+
+		LOG_INFO << "Packed " << plan.inputs.size() << " of " << requests.size() << " textures into " << plan.layout.arrays.size()
+			<< " texture arrays, for " << packedMaterialCount << " of " << materialCount << " materials.  Base pass descriptor table updates per frame: "
+			<< CountDescriptorTableUpdates(unpackedTables) << " -> " << CountDescriptorTableUpdates(packedTables);
+	}
+
+	return materials;
+}
\ No newline at end of file
@@ -0,0 +1,73 @@
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+// Author: David Elder
+//
+
+#pragma once
+
+namespace Kodiak
+{
+
+// Forward declarations
+class LoadNode;
+class Material;
+class Texture;
+
+
+// Texture paths for one material of a model.  A fallback path is tried when the primary file doesn't exist.
+struct ModelMaterialDesc
+{
+	std::string name;
+	std::string diffusePath;
+	std::string specularPath;
+	std::string specularFallbackPath;
+	std::string normalPath;
+	std::string normalFallbackPath;
+};
+
+
+// The materials a model material expands into, one per render pass
+struct ModelMaterialSet
+{
+	std::shared_ptr<Material> opaque;
+	std::shared_ptr<Material> depth;
+	std::shared_ptr<Material> shadow;
+};
+
+
+// Builds the base pass, depth and shadow materials for the model loaders
+class ModelMaterialBuilder
+{
+public:
+	// With packTextures, materials whose textures can all go into texture arrays sample shared arrays
+	// instead, and select their slices through the textureSlices constant.  Packed textures are loaded
+	// with their whole mip chain and don't stream.
+	explicit ModelMaterialBuilder(bool quantizedVertices = false, bool packTextures = false);
+
+	// True if the application has set up effects for quantized vertices
+	static bool SupportsQuantizedVertices();
+
+	// True if the application has set up texture array effects for the vertex layout
+	static bool SupportsPackedTextures(bool quantizedVertices);
+
+	// Builds a set per desc, in order, and adds a load graph node for each material's textures under
+	// modelNode.  The materials are set up on worker threads and their textures requested from the
+	// loader in one batch; call it from the main thread.  drawMaterials lists the material of each
+	// mesh, and is only used to report the descriptor table updates saved by packing.
+	std::vector<ModelMaterialSet> Build(const std::vector<ModelMaterialDesc>& descs, LoadNode& modelNode,
+		const std::vector<uint32_t>& drawMaterials = std::vector<uint32_t>());
+
+private:
+	bool m_quantizedVertices;
+	bool m_packTextures;
+
+	std::shared_ptr<Texture> m_defaultDiffuse;
+	std::shared_ptr<Texture> m_defaultSpecular;
+	std::shared_ptr<Texture> m_defaultNormal;
+};
+
+} // namespace Kodiak
\ No newline at end of file
@@ -0,0 +1,214 @@
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+// Author: David Elder
+//
+
+#include "Stdafx.h"
+
+#include "Model.h"
+
+#include "CookedModel.h"
+#include "GeometryPool.h"
+#include "IndexBuffer.h"
+#include "LoadGraph.h"
+#include "Material.h"
+#include "ModelLoaderUtils.h"
+#include "RenderEnums.h"
+#include "VertexBuffer.h"
+
+
+using namespace Kodiak;
+using namespace Math;
+using namespace std;
+
+
+namespace
+{
+
+// Read-only view of a whole file
+class MappedFile
+{
+public:
+	explicit MappedFile(const string& path)
+	{
+		m_file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+		if (m_file == INVALID_HANDLE_VALUE)
+		{
+			return;
+		}
+
+		LARGE_INTEGER fileSize{};
+		if (!GetFileSizeEx(m_file, &fileSize) || fileSize.QuadPart == 0)
+		{
+			return;
+		}
+
+		m_mapping = CreateFileMappingA(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (!m_mapping)
+		{
+			return;
+		}
+
+		m_data = reinterpret_cast<const uint8_t*>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+		if (m_data)
+		{
+			m_size = static_cast<size_t>(fileSize.QuadPart);
+		}
+	}
+
+	~MappedFile()
+	{
+		if (m_data)
+		{
+			UnmapViewOfFile(m_data);
+		}
+		if (m_mapping)
+		{
+			CloseHandle(m_mapping);
+		}
+		if (m_file != INVALID_HANDLE_VALUE)
+		{
+			CloseHandle(m_file);
+		}
+	}
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	const uint8_t* GetData() const { return m_data; }
+	size_t GetSize() const { return m_size; }
+
+private:
+	HANDLE			m_file{ INVALID_HANDLE_VALUE };
+	HANDLE			m_mapping{ nullptr };
+	const uint8_t*	m_data{ nullptr };
+	size_t			m_size{ 0 };
+};
+
+} // anonymous namespace
+
+
+namespace Kodiak
+{
+
+shared_ptr<StaticModel> LoadModelCooked(const string& fullPath, const ModelLoadDesc& desc)
+{
+	const auto startTime = chrono::high_resolution_clock::now();
+
+	MappedFile file(fullPath);
+	if (!CookedModel::Validate(file.GetData(), file.GetSize()))
+	{
+		LOG_WARNING << "Failed to load cooked model " << fullPath << ", the file is missing, out of date or corrupt";
+		return nullptr;
+	}
+
+	const uint8_t* data = file.GetData();
+	const auto& header = *reinterpret_cast<const CookedModel::Header*>(data);
+
+	const bool quantized = (header.flags & CookedModel::kFlagQuantizedVertices) != 0;
+	if (quantized && !ModelMaterialBuilder::SupportsQuantizedVertices())
+	{
+		LOG_WARNING << "Failed to load cooked model " << fullPath << ", it has quantized vertices but the quantized default effects aren't set";
+		return nullptr;
+	}
+
+	const auto* meshes = CookedModel::GetTable<CookedModel::Mesh>(data, header.meshes);
+	const auto* materials = CookedModel::GetTable<CookedModel::Material>(data, header.materials);
+	const auto* meshlets = CookedModel::GetTable<Meshlet>(data, header.meshlets);
+
+	// Vertex and index data are copied into the shared buffers exactly as cooked, with no per-element work
+	auto geometry = GeometryPool::GetInstance().Allocate(
+		data + header.vertexData.offset,
+		header.vertexStride,
+		header.vertexData.size / header.vertexStride,
+		reinterpret_cast<const uint16_t*>(data + header.indexData.offset),
+		header.indexData.size / sizeof(uint16_t));
+
+	const auto vbuffer = geometry->vertexBuffer;
+	const auto ibuffer = geometry->indexBuffer;
+
+	// Create model
+	auto model = make_shared<StaticModel>();
+	model->SetGeometry(geometry);
+
+	// Textures and materials
+	ModelMaterialBuilder materialBuilder(quantized, desc.packTextures);
+	vector<ModelMaterialDesc> materialDescs(header.materialCount);
+
+	auto modelNode = make_shared<LoadNode>(fullPath);
+
+	for (uint32_t i = 0; i < header.materialCount; ++i)
+	{
+		const auto& material = materials[i];
+
+		auto& materialDesc = materialDescs[i];
+		materialDesc.name = CookedModel::GetString(data, material.name);
+		materialDesc.diffusePath = CookedModel::GetString(data, material.texturePaths[CookedModel::kDiffuse]);
+		materialDesc.specularPath = CookedModel::GetString(data, material.texturePaths[CookedModel::kSpecular]);
+		materialDesc.specularFallbackPath = CookedModel::GetString(data, material.texturePaths[CookedModel::kSpecularFallback]);
+		materialDesc.normalPath = CookedModel::GetString(data, material.texturePaths[CookedModel::kNormal]);
+		materialDesc.normalFallbackPath = CookedModel::GetString(data, material.texturePaths[CookedModel::kNormalFallback]);
+	}
+
+	vector<uint32_t> drawMaterials(header.meshCount);
+	for (uint32_t i = 0; i < header.meshCount; ++i)
+	{
+		drawMaterials[i] = meshes[i].materialIndex;
+	}
+
+	auto materialSets = materialBuilder.Build(materialDescs, *modelNode, drawMaterials);
+
+	// Create meshes, with a part per render pass
+	for (uint32_t i = 0; i < header.meshCount; ++i)
+	{
+		const auto& cookedMesh = meshes[i];
+		const auto& materialSet = materialSets[cookedMesh.materialIndex];
+
+		auto mesh = make_shared<StaticMesh>();
+
+		for (const auto& material : { materialSet.opaque, materialSet.depth, materialSet.shadow })
+		{
+			StaticMeshPart part{
+				vbuffer,
+				ibuffer,
+				material,
+				PrimitiveTopology::TriangleList,
+				cookedMesh.indexCount,
+				geometry->startIndex + cookedMesh.startIndex,
+				static_cast<int32_t>(geometry->baseVertex) + cookedMesh.baseVertex };
+			mesh->AddMeshPart(part);
+		}
+
+		if (quantized)
+		{
+			const auto& boundsMin = cookedMesh.boundsMin;
+			const auto& boundsMax = cookedMesh.boundsMax;
+			mesh->SetPositionDequantization(
+				Vector3(boundsMax[0] - boundsMin[0], boundsMax[1] - boundsMin[1], boundsMax[2] - boundsMin[2]),
+				Vector3(boundsMin[0], boundsMin[1], boundsMin[2]));
+		}
+
+		if (desc.buildMeshlets && cookedMesh.meshletCount > 0)
+		{
+			const auto* first = meshlets + cookedMesh.firstMeshlet;
+			mesh->SetMeshlets(make_shared<const vector<Meshlet>>(first, first + cookedMesh.meshletCount));
+		}
+
+		model->AddMesh(mesh);
+	}
+
+	modelNode->FinishWork();
+	model->SetLoadNode(modelNode);
+
+	const chrono::duration<double, milli> elapsed = chrono::high_resolution_clock::now() - startTime;
+	LOG_INFO << "Loaded " << fullPath << " in " << elapsed.count() << " ms (" << header.materialCount << " materials, "
+		<< header.meshCount << " meshes), textures still loading";
+
+	return model;
+}
+
+} // namespace Kodiak
\ No newline at end of file
@@ -12,15 +12,16 @@
 #include "Model.h"
 
 #include "BinaryReader.h"
-#include "Defaults.h"
-#include "Filesystem.h"
+#include "GeometryPool.h"
 #include "IndexBuffer.h"
+#include "LoadGraph.h"
 #include "Material.h"
-#include "MaterialParameter.h"
-#include "MaterialResource.h"
+#include "Meshlet.h"
+#include "MeshOptimizer.h"
+#include "ModelLoaderUtils.h"
 #include "RenderEnums.h"
-#include "Texture.h"
 #include "VertexBuffer.h"
+#include "VertexQuantization.h"
 
 
 using namespace Kodiak;
@@ -243,28 +244,170 @@ string BuildTexturePath(const string& basePath)
 	return ret;
 }
 
-shared_ptr<Texture> LoadTexture(const string& path, bool isSrgb, shared_ptr<Texture> defaultTexture)
+
+// Reorders each mesh's triangles and vertices in place.  Meshes own disjoint ranges of both buffers.
+void OptimizeMeshes(const vector<H3D::Mesh>& meshes, vector<byte>& vertexData, vector<byte>& indexData, const string& fullPath)
 {
-	auto& filesystem = Filesystem::GetInstance();
-	if (filesystem.IsRegularFile(path))
+	VertexCacheStats totalBefore;
+	VertexCacheStats totalAfter;
+
+	for (const auto& mesh : meshes)
 	{
-		return Texture::Load(path, isSrgb);
+		const auto& position = mesh.attrib[H3D::attrib_position];
+		const bool hasPositions = position.format == H3D::attrib_format_float && position.components >= 3;
+
+		auto result = OptimizeMesh(
+			reinterpret_cast<uint16_t*>(indexData.data() + mesh.indexDataByteOffset),
+			mesh.indexCount,
+			vertexData.data() + mesh.vertexDataByteOffset,
+			mesh.vertexStride,
+			mesh.vertexCount,
+			hasPositions ? position.offset : kNoPositionOffset);
+
+		AccumulateVertexCacheStats(totalBefore, result.before);
+		AccumulateVertexCacheStats(totalAfter, result.after);
 	}
-	return defaultTexture;
+
+	LOG_INFO << "Optimized meshes in " << fullPath << ": ACMR " << totalBefore.acmr << " -> " << totalAfter.acmr
+		<< ", ATVR " << totalBefore.atvr << " -> " << totalAfter.atvr;
 }
 
-shared_ptr<Texture> LoadTexture2(const string& path, const string& path2, bool isSrgb, shared_ptr<Texture> defaultTexture)
+
+// Splits each mesh into meshlets, reordering its triangles in place.  Meshes without float positions
+// are left whole.
+vector<shared_ptr<const vector<Meshlet>>> BuildMeshMeshlets(const vector<H3D::Mesh>& meshes, const byte* vertexData,
+	vector<byte>& indexData, const string& fullPath)
 {
-	auto& filesystem = Filesystem::GetInstance();
-	if (filesystem.IsRegularFile(path))
+	vector<shared_ptr<const vector<Meshlet>>> meshMeshlets(meshes.size());
+
+	size_t meshletCount = 0;
+	size_t triangleCount = 0;
+	size_t vertexCount = 0;
+
+	for (size_t i = 0; i < meshes.size(); ++i)
+	{
+		const auto& mesh = meshes[i];
+		const auto& position = mesh.attrib[H3D::attrib_position];
+		if (position.format != H3D::attrib_format_float || position.components < 3)
+		{
+			continue;
+		}
+
+		auto meshlets = BuildMeshlets(
+			reinterpret_cast<uint16_t*>(indexData.data() + mesh.indexDataByteOffset),
+			mesh.indexCount,
+			vertexData + mesh.vertexDataByteOffset + position.offset,
+			mesh.vertexStride,
+			mesh.vertexCount);
+
+		for (const auto& meshlet : meshlets)
+		{
+			triangleCount += meshlet.triangleCount;
+			vertexCount += meshlet.vertexCount;
+		}
+		meshletCount += meshlets.size();
+
+		meshMeshlets[i] = make_shared<const vector<Meshlet>>(move(meshlets));
+	}
+
+	if (meshletCount > 0)
 	{
-		return Texture::Load(path, isSrgb);
+		LOG_INFO << "Built " << meshletCount << " meshlets for " << fullPath << ", averaging "
+			<< (triangleCount / meshletCount) << " triangles and " << (vertexCount / meshletCount) << " vertices";
 	}
-	else if (filesystem.IsRegularFile(path2))
+
+	return meshMeshlets;
+}
+
+
+// Quantization needs float positions, texcoords, normals, tangents and bitangents
+bool GetFloatVertexLayout(const H3D::Mesh& mesh, FloatVertexLayout& layout)
+{
+	const uint32_t attribs[] = { H3D::attrib_position, H3D::attrib_texcoord0, H3D::attrib_normal, H3D::attrib_tangent, H3D::attrib_bitangent };
+	const uint16_t minComponents[] = { 3, 2, 3, 3, 3 };
+
+	for (uint32_t i = 0; i < _countof(attribs); ++i)
 	{
-		return Texture::Load(path2, isSrgb);
+		const auto& attrib = mesh.attrib[attribs[i]];
+		if ((mesh.attribsEnabled & (1 << attribs[i])) == 0 || attrib.format != H3D::attrib_format_float ||
+			attrib.components < minComponents[i])
+		{
+			return false;
+		}
 	}
-	return defaultTexture;
+
+	layout.stride = mesh.vertexStride;
+	layout.position = mesh.attrib[H3D::attrib_position].offset;
+	layout.texcoord = mesh.attrib[H3D::attrib_texcoord0].offset;
+	layout.normal = mesh.attrib[H3D::attrib_normal].offset;
+	layout.tangent = mesh.attrib[H3D::attrib_tangent].offset;
+	layout.bitangent = mesh.attrib[H3D::attrib_bitangent].offset;
+	return true;
+}
+
+
+// Converts every mesh's vertices, quantizing positions to the mesh's own bounds.  Returns false, leaving
+// the model unquantized, if any mesh has attributes that can't be converted.
+bool QuantizeMeshes(const vector<H3D::Mesh>& meshes, const byte* vertexData, size_t vertexDataSize,
+	vector<QuantizedVertex>& quantizedVertexData, vector<QuantizationBounds>& meshBounds, const string& fullPath)
+{
+	const size_t vertexStride = meshes[0].vertexStride;
+	const size_t vertexCount = vertexDataSize / vertexStride;
+
+	vector<FloatVertexLayout> layouts(meshes.size());
+	for (size_t i = 0; i < meshes.size(); ++i)
+	{
+		const auto& mesh = meshes[i];
+		if (!GetFloatVertexLayout(mesh, layouts[i]) ||
+			static_cast<uint64_t>(mesh.vertexDataByteOffset) + static_cast<uint64_t>(mesh.vertexCount) * vertexStride > vertexDataSize)
+		{
+			LOG_WARNING << "Can't quantize vertices in " << fullPath << ", mesh " << i << " has an unsupported vertex layout";
+			return false;
+		}
+	}
+
+	quantizedVertexData.assign(vertexCount, QuantizedVertex{});
+	meshBounds.resize(meshes.size());
+
+	for (size_t i = 0; i < meshes.size(); ++i)
+	{
+		const auto& mesh = meshes[i];
+		const byte* meshVertices = vertexData + mesh.vertexDataByteOffset;
+
+		meshBounds[i] = ComputePositionBounds(meshVertices, layouts[i], mesh.vertexCount);
+		QuantizeVertices(meshVertices, layouts[i], mesh.vertexCount, meshBounds[i],
+			quantizedVertexData.data() + mesh.vertexDataByteOffset / vertexStride);
+	}
+
+	const size_t quantizedSize = vertexCount * sizeof(QuantizedVertex);
+	LOG_INFO << "Quantized vertices in " << fullPath << ": " << vertexDataSize << " -> " << quantizedSize << " bytes ("
+		<< (100 * quantizedSize / vertexDataSize) << "% of the original), vertex fetch "
+		<< vertexStride << " -> " << sizeof(QuantizedVertex) << " bytes per vertex";
+
+	return true;
+}
+
+
+// Reports what sharing the geometry buffers saves over the old per-model buffers: a VB/IB pair plus a
+// depth-only pair that the draws never bound.  The pool may have added pages of its own for the model, which
+// are counted against that.
+void LogGeometryStats(const H3D::Header& header, const GeometryPoolStats& statsBefore, const string& fullPath)
+{
+	const size_t perModelBufferCount = 4;
+
+	const size_t skippedBytes = header.vertexDataByteSizeDepth + header.indexDataByteSize;
+	const auto stats = GeometryPool::GetInstance().GetStats();
+
+	const size_t bufferCountBefore = statsBefore.vertexBufferCount + statsBefore.indexBufferCount;
+	const size_t bufferCount = stats.vertexBufferCount + stats.indexBufferCount;
+	const size_t createdBuffers = (bufferCount > bufferCountBefore) ? (bufferCount - bufferCountBefore) : 0;
+	const size_t savedBuffers = (createdBuffers < perModelBufferCount) ? (perModelBufferCount - createdBuffers) : 0;
+
+	LOG_INFO << "Pooled geometry for " << fullPath << ": skipped " << skippedBytes
+		<< " bytes of unused depth-only vertex and index data and " << savedBuffers << " of "
+		<< perModelBufferCount << " buffer creations.  Pool now holds "
+		<< stats.allocationCount << " models in " << bufferCount
+		<< " buffers (" << stats.usedBytes << " of " << stats.capacityBytes << " bytes used)";
 }
 
 } // anonymous namespace
@@ -273,8 +416,10 @@ shared_ptr<Texture> LoadTexture2(const string& path, const string& path2, bool i
 namespace Kodiak
 {
 
-shared_ptr<StaticModel> LoadModelH3D(const string& fullPath)
+shared_ptr<StaticModel> LoadModelH3D(const string& fullPath, const ModelLoadDesc& desc)
 {
+	const auto startTime = chrono::high_resolution_clock::now();
+
 	BinaryReader reader(fullPath);
 
 	H3D::Header header;
@@ -297,102 +442,117 @@ shared_ptr<StaticModel> LoadModelH3D(const string& fullPath)
 	}
 
 	auto vertexStride = meshes[0].vertexStride;
-	auto vertexStrideDepth = meshes[0].vertexStrideDepth;
 
-	// Vertex buffer
 	const byte* vb_data = reader.ReadArray<byte>(header.vertexDataByteSize);
-	VertexBufferDataRaw vbData{ vb_data, vertexStride, header.vertexDataByteSize };
-	auto vbuffer = VertexBuffer::Create(vbData, Usage::Immutable);
-
-	// Index buffer
 	const byte* ib_data = reader.ReadArray<byte>(header.indexDataByteSize);
-	IndexBufferData16 ibData{ ib_data, header.indexDataByteSize };
-	auto ibuffer = IndexBuffer::Create(ibData, Usage::Immutable);
 
-	// Vertex buffer (depth)
-	const byte* vb_data_depth = reader.ReadArray<byte>(header.vertexDataByteSizeDepth);
-	VertexBufferDataRaw vbDataDepth{ vb_data_depth, vertexStrideDepth, header.vertexDataByteSizeDepth };
-	auto vbufferDepth = VertexBuffer::Create(vbDataDepth, Usage::Immutable);
+	// Cooked models are optimized offline, this is for loading H3D files directly
+	vector<byte> optimizedVertexData;
+	vector<byte> optimizedIndexData;
+	if (desc.optimizeMeshes)
+	{
+		optimizedVertexData.assign(vb_data, vb_data + header.vertexDataByteSize);
+		optimizedIndexData.assign(ib_data, ib_data + header.indexDataByteSize);
+		OptimizeMeshes(meshes, optimizedVertexData, optimizedIndexData, fullPath);
+
+		vb_data = optimizedVertexData.data();
+		ib_data = optimizedIndexData.data();
+	}
+
+	// Meshlets are built from float positions, before quantization, and reorder the triangles
+	vector<shared_ptr<const vector<Meshlet>>> meshMeshlets;
+	if (desc.buildMeshlets)
+	{
+		if (optimizedIndexData.empty())
+		{
+			optimizedIndexData.assign(ib_data, ib_data + header.indexDataByteSize);
+			ib_data = optimizedIndexData.data();
+		}
+		meshMeshlets = BuildMeshMeshlets(meshes, vb_data, optimizedIndexData, fullPath);
+	}
+
+	size_t vertexBufferStride = vertexStride;
+	size_t vertexBufferSize = header.vertexDataByteSize;
+
+	vector<QuantizedVertex> quantizedVertexData;
+	vector<QuantizationBounds> meshBounds;
+	bool quantized = false;
+	if (desc.quantizeVertices)
+	{
+		if (ModelMaterialBuilder::SupportsQuantizedVertices())
+		{
+			quantized = QuantizeMeshes(meshes, vb_data, header.vertexDataByteSize, quantizedVertexData, meshBounds, fullPath);
+		}
+		else
+		{
+			LOG_WARNING << "Can't quantize vertices in " << fullPath << ", the quantized default effects aren't set";
+		}
+	}
+
+	if (quantized)
+	{
+		vb_data = reinterpret_cast<const byte*>(quantizedVertexData.data());
+		vertexBufferStride = sizeof(QuantizedVertex);
+		vertexBufferSize = quantizedVertexData.size() * sizeof(QuantizedVertex);
+	}
+
+	// Geometry goes into the shared buffers.  The file's depth-only vertices and indices follow, but the
+	// depth parts draw from the main buffers, so they are never read.
+	auto& geometryPool = GeometryPool::GetInstance();
+	const auto poolStatsBefore = geometryPool.GetStats();
+	auto geometry = geometryPool.Allocate(
+		vb_data,
+		vertexBufferStride,
+		vertexBufferSize / vertexBufferStride,
+		reinterpret_cast<const uint16_t*>(ib_data),
+		header.indexDataByteSize / sizeof(uint16_t));
+
+	const auto vbuffer = geometry->vertexBuffer;
+	const auto ibuffer = geometry->indexBuffer;
 
-	// Index buffer (depth)
-	const byte* ib_data_depth = reader.ReadArray<byte>(header.indexDataByteSize);
-	IndexBufferData16 ibDataDepth{ ib_data_depth, header.indexDataByteSize };
-	auto ibufferDepth = IndexBuffer::Create(ibDataDepth, Usage::Immutable);
+	LogGeometryStats(header, poolStatsBefore, fullPath);
 
 	// Create model
 	auto model = make_shared<StaticModel>();
+	model->SetGeometry(geometry);
 
 	bool asyncLoad = false;
 
 	// Textures and materials
-	shared_ptr<Texture> defDiffuse = Texture::Load("default.DDS", true);
-	shared_ptr<Texture> defSpecular = Texture::Load("default_specular.DDS", true);
-	shared_ptr<Texture> defNormal = Texture::Load("default_normal.DDS", false);
+	ModelMaterialBuilder materialBuilder(quantized, desc.packTextures);
 
 	vector<shared_ptr<Material>> opaqueMaterials(header.materialCount);
 	vector<shared_ptr<Material>> shadowMaterials(header.materialCount);
 	vector<shared_ptr<Material>> depthMaterials(header.materialCount);
 
+	// Load graph.  The model waits on one node per H3D material, each of which waits on its textures.
+	// Effects and buffers are created synchronously above, so they are resident already.
+	auto modelNode = make_shared<LoadNode>(fullPath);
+
+	vector<ModelMaterialDesc> materialDescs(header.materialCount);
 	for (uint32_t i = 0; i < header.materialCount; ++i)
 	{
-		// Setup opaque base-pass material
-		auto opaqueMaterial = opaqueMaterials[i] = make_shared<Material>();
-		opaqueMaterial->SetEffect(GetDefaultBaseEffect());
-		opaqueMaterial->SetRenderPass(GetDefaultBasePass());
-
-		// Diffuse texture
-		string diffusePath = BuildTexturePath(materials[i].texDiffusePath);
-		auto diffuseTexture = LoadTexture(diffusePath, true, defDiffuse);
-		diffuseTexture->AddPostLoadCallback([opaqueMaterial, diffuseTexture]()
-		{
-			opaqueMaterial->SetResource("texDiffuse", diffuseTexture);
-		});
-
-		// Specular texture
-		string specularPath1 = BuildTexturePath(materials[i].texSpecularPath);
-		string specularPath2 = BuildTexturePath(materials[i].texDiffusePath + "_specular");
-		auto specularTexture = LoadTexture2(specularPath1, specularPath2, true, defSpecular);
-		specularTexture->AddPostLoadCallback([opaqueMaterial, specularTexture]()
-		{
-			opaqueMaterial->SetResource("texSpecular", specularTexture);
-		});
-		
-		// Normal texture
-		string normalPath1 = BuildTexturePath(materials[i].texNormalPath);
-		string normalPath2 = BuildTexturePath(materials[i].texDiffusePath + "_normal");
-		auto normalTexture = LoadTexture2(normalPath1, normalPath2, false, defNormal);
-		normalTexture->AddPostLoadCallback([opaqueMaterial, normalTexture]()
-		{
-			opaqueMaterial->SetResource("texNormal", normalTexture);
-		});
-
-
-		// TODO move this stuff to per-view data
-		using namespace DirectX;
-		opaqueMaterial->GetParameter("sunDirection")->SetValue(Vector3(0.336f, 0.924f, -0.183f));
-		opaqueMaterial->GetParameter("sunColor")->SetValue(Vector3(4.0f, 4.0f, 4.0f));
-		opaqueMaterial->GetParameter("ambientColor")->SetValue(Vector3(0.1f, 0.1f, 0.1f));
-		opaqueMaterial->GetParameter("shadowTexelSize")->SetValue(1.0f / 2048.0f);
+		auto& materialDesc = materialDescs[i];
+		materialDesc.name = materials[i].name;
+		materialDesc.diffusePath = BuildTexturePath(materials[i].texDiffusePath);
+		materialDesc.specularPath = BuildTexturePath(materials[i].texSpecularPath);
+		materialDesc.specularFallbackPath = BuildTexturePath(materials[i].texDiffusePath + "_specular");
+		materialDesc.normalPath = BuildTexturePath(materials[i].texNormalPath);
+		materialDesc.normalFallbackPath = BuildTexturePath(materials[i].texDiffusePath + "_normal");
+	}
 
-		// Setup depth material
-		auto depthMaterial = depthMaterials[i] = make_shared<Material>();
-		depthMaterial->SetEffect(GetDefaultDepthEffect());
-		depthMaterial->SetRenderPass(GetDefaultDepthPass());
+	vector<uint32_t> drawMaterials(header.meshCount);
+	for (uint32_t i = 0; i < header.meshCount; ++i)
+	{
+		drawMaterials[i] = meshes[i].materialIndex;
+	}
 
-		diffuseTexture->AddPostLoadCallback([depthMaterial, diffuseTexture]()
-		{
-			depthMaterial->SetResource("texDiffuse", diffuseTexture);
-		});
-		
-		// Setup shadow material
-		auto shadowMaterial = shadowMaterials[i] = make_shared<Material>();
-		shadowMaterial->SetEffect(GetDefaultShadowEffect());
-		shadowMaterial->SetRenderPass(GetDefaultShadowPass());
-
-		diffuseTexture->AddPostLoadCallback([shadowMaterial, diffuseTexture]()
-		{
-			shadowMaterial->SetResource("texDiffuse", diffuseTexture);
-		});
+	auto materialSets = materialBuilder.Build(materialDescs, *modelNode, drawMaterials);
+	for (uint32_t i = 0; i < header.materialCount; ++i)
+	{
+		opaqueMaterials[i] = materialSets[i].opaque;
+		depthMaterials[i] = materialSets[i].depth;
+		shadowMaterials[i] = materialSets[i].shadow;
 	}
 
 	// Create meshes
@@ -400,6 +560,9 @@ shared_ptr<StaticModel> LoadModelH3D(const string& fullPath)
 	{
 		const auto& h3dMesh = meshes[i];
 
+		const uint32_t startIndex = geometry->startIndex + h3dMesh.indexDataByteOffset / sizeof(uint16_t);
+		const int32_t baseVertex = static_cast<int32_t>(geometry->baseVertex + h3dMesh.vertexDataByteOffset / vertexStride);
+
 		auto mesh = make_shared<StaticMesh>();
 
 		// Opaque mesh part
@@ -409,8 +572,8 @@ shared_ptr<StaticModel> LoadModelH3D(const string& fullPath)
 			opaqueMaterials[h3dMesh.materialIndex],
 			PrimitiveTopology::TriangleList, 
 			h3dMesh.indexCount, 
-			h3dMesh.indexDataByteOffset / sizeof(uint16_t),
-			static_cast<int32_t>(h3dMesh.vertexDataByteOffset / vertexStride)};
+			startIndex,
+			baseVertex };
 		mesh->AddMeshPart(opaquePart);
 
 		// Depth-only mesh part
@@ -420,8 +583,8 @@ shared_ptr<StaticModel> LoadModelH3D(const string& fullPath)
 			depthMaterials[h3dMesh.materialIndex],
 			PrimitiveTopology::TriangleList,
 			h3dMesh.indexCount,
-			h3dMesh.indexDataByteOffset / sizeof(uint16_t),
-			static_cast<int32_t>(h3dMesh.vertexDataByteOffset / vertexStride)};
+			startIndex,
+			baseVertex };
 		mesh->AddMeshPart(depthPart);
 
 		// Shadow mesh part
@@ -431,13 +594,33 @@ shared_ptr<StaticModel> LoadModelH3D(const string& fullPath)
 			shadowMaterials[h3dMesh.materialIndex],
 			PrimitiveTopology::TriangleList,
 			h3dMesh.indexCount,
-			h3dMesh.indexDataByteOffset / sizeof(uint16_t),
-			static_cast<int32_t>(h3dMesh.vertexDataByteOffset / vertexStride) };
+			startIndex,
+			baseVertex };
 		mesh->AddMeshPart(shadowPart);
 
+		if (quantized)
+		{
+			const auto& bounds = meshBounds[i];
+			mesh->SetPositionDequantization(
+				Vector3(bounds.max[0] - bounds.min[0], bounds.max[1] - bounds.min[1], bounds.max[2] - bounds.min[2]),
+				Vector3(bounds.min[0], bounds.min[1], bounds.min[2]));
+		}
+
+		if (!meshMeshlets.empty() && meshMeshlets[i])
+		{
+			mesh->SetMeshlets(meshMeshlets[i]);
+		}
+
 		model->AddMesh(mesh);
 	}
 
+	modelNode->FinishWork();
+	model->SetLoadNode(modelNode);
+
+	const chrono::duration<double, milli> elapsed = chrono::high_resolution_clock::now() - startTime;
+	LOG_INFO << "Loaded " << fullPath << " in " << elapsed.count() << " ms (" << header.materialCount << " materials, "
+		<< header.meshCount << " meshes), textures still loading";
+
 	return model;
 }
 
@@ -0,0 +1,226 @@
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+// Author: David Elder
+//
+
+// Built without the precompiled header, so that tools can share it
+
+#include "PSOCache.h"
+
+#include <cstring>
+
+
+using namespace Kodiak;
+using namespace std;
+
+
+namespace
+{
+
+const uint32_t s_magic = 0x4353504B; // 'KPSC'
+
+// Followed by entryCount entries, each a uint64_t key, a uint64_t blob size and the blob.  The checksum
+// covers everything after the header.
+struct FileHeader
+{
+	uint32_t	magic;
+	uint32_t	version;
+	uint32_t	vendorId;
+	uint32_t	deviceId;
+	uint64_t	driverVersion;
+	uint64_t	entryCount;
+	uint64_t	checksum;
+};
+
+
+template <typename T>
+void Append(vector<uint8_t>& data, const T& value)
+{
+	const auto bytes = reinterpret_cast<const uint8_t*>(&value);
+	data.insert(data.end(), bytes, bytes + sizeof(T));
+}
+
+
+template <typename T>
+bool Read(const uint8_t*& cursor, const uint8_t* end, T& value)
+{
+	if (static_cast<size_t>(end - cursor) < sizeof(T))
+	{
+		return false;
+	}
+	memcpy(&value, cursor, sizeof(T));
+	cursor += sizeof(T);
+	return true;
+}
+
+} // anonymous namespace
+
+
+namespace Kodiak
+{
+
+uint64_t HashPSOBytes(const void* data, size_t size, uint64_t hash)
+{
+	const auto bytes = reinterpret_cast<const uint8_t*>(data);
+	for (size_t i = 0; i < size; ++i)
+	{
+		hash ^= bytes[i];
+		hash *= 1099511628211ULL;
+	}
+	return hash;
+}
+
+
+bool PSOCache::Deserialize(const uint8_t* data, size_t dataSize)
+{
+	lock_guard<mutex> CS(m_mutex);
+
+	m_entries.clear();
+	m_stats.loadedEntries = 0;
+	m_modified = false;
+
+	const uint8_t* cursor = data;
+	const uint8_t* end = data + dataSize;
+
+	FileHeader header;
+	if (!data || !Read(cursor, end, header))
+	{
+		return false;
+	}
+
+	if (header.magic != s_magic ||
+		header.version != kFormatVersion ||
+		header.vendorId != m_deviceId.vendorId ||
+		header.deviceId != m_deviceId.deviceId ||
+		header.driverVersion != m_deviceId.driverVersion ||
+		header.checksum != HashPSOBytes(cursor, end - cursor))
+	{
+		return false;
+	}
+
+	for (uint64_t i = 0; i < header.entryCount; ++i)
+	{
+		uint64_t key = 0;
+		uint64_t blobSize = 0;
+		if (!Read(cursor, end, key) || !Read(cursor, end, blobSize) || static_cast<uint64_t>(end - cursor) < blobSize)
+		{
+			m_entries.clear();
+			return false;
+		}
+
+		auto& entry = m_entries[key];
+		entry.blob.assign(cursor, cursor + blobSize);
+		cursor += blobSize;
+	}
+
+	m_stats.loadedEntries = m_entries.size();
+	return true;
+}
+
+
+void PSOCache::Serialize(vector<uint8_t>& data) const
+{
+	lock_guard<mutex> CS(m_mutex);
+
+	data.resize(sizeof(FileHeader));
+
+	uint64_t entryCount = 0;
+	for (const auto& keyEntry : m_entries)
+	{
+		if (!keyEntry.second.used)
+		{
+			continue;
+		}
+
+		Append(data, keyEntry.first);
+		Append(data, static_cast<uint64_t>(keyEntry.second.blob.size()));
+		data.insert(data.end(), keyEntry.second.blob.begin(), keyEntry.second.blob.end());
+		++entryCount;
+	}
+
+	FileHeader header;
+	header.magic = s_magic;
+	header.version = kFormatVersion;
+	header.vendorId = m_deviceId.vendorId;
+	header.deviceId = m_deviceId.deviceId;
+	header.driverVersion = m_deviceId.driverVersion;
+	header.entryCount = entryCount;
+	header.checksum = HashPSOBytes(data.data() + sizeof(FileHeader), data.size() - sizeof(FileHeader));
+	memcpy(data.data(), &header, sizeof(FileHeader));
+}
+
+
+bool PSOCache::Find(uint64_t key, vector<uint8_t>& blob)
+{
+	lock_guard<mutex> CS(m_mutex);
+
+	auto it = m_entries.find(key);
+	if (it == m_entries.end())
+	{
+		++m_stats.misses;
+		return false;
+	}
+
+	++m_stats.hits;
+	it->second.used = true;
+	blob = it->second.blob;
+	return true;
+}
+
+
+void PSOCache::Store(uint64_t key, const void* blob, size_t blobSize)
+{
+	lock_guard<mutex> CS(m_mutex);
+
+	auto& entry = m_entries[key];
+	const auto bytes = reinterpret_cast<const uint8_t*>(blob);
+	entry.blob.assign(bytes, bytes + blobSize);
+	entry.used = true;
+	m_modified = true;
+}
+
+
+void PSOCache::Reject(uint64_t key)
+{
+	lock_guard<mutex> CS(m_mutex);
+
+	if (m_entries.erase(key) > 0)
+	{
+		++m_stats.rejected;
+		m_modified = true;
+	}
+}
+
+
+bool PSOCache::IsDirty() const
+{
+	lock_guard<mutex> CS(m_mutex);
+
+	if (m_modified)
+	{
+		return true;
+	}
+
+	// Unused entries are pruned on save
+	for (const auto& keyEntry : m_entries)
+	{
+		if (!keyEntry.second.used)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+
+PSOCacheStats PSOCache::GetStats() const
+{
+	lock_guard<mutex> CS(m_mutex);
+	return m_stats;
+}
+
+} // namespace Kodiak
\ No newline at end of file
@@ -0,0 +1,92 @@
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+// Author: David Elder
+//
+
+#pragma once
+
+// Persistent cache of compiled pipeline state blobs, keyed by a hash of everything that goes into the
+// pipeline, shader bytecode included.  The file is stamped with a format version and the adapter and
+// driver it was written on, and is ignored if any of those change.  This header and PSOCache.cpp only
+// depend on the standard library, so the file format and lookups can be exercised without a GPU.
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace Kodiak
+{
+
+const uint64_t kPSOHashSeed = 14695981039346656037ULL;
+
+// 64-bit FNV-1a, stable across runs and builds
+uint64_t HashPSOBytes(const void* data, size_t size, uint64_t hash = kPSOHashSeed);
+
+
+// Blobs only load on the adapter and driver they were compiled with
+struct PSOCacheDeviceId
+{
+	uint32_t	vendorId{ 0 };
+	uint32_t	deviceId{ 0 };
+	uint64_t	driverVersion{ 0 };
+};
+
+
+struct PSOCacheStats
+{
+	uint32_t	hits{ 0 };
+	uint32_t	misses{ 0 };
+	uint32_t	rejected{ 0 };		// Found, but the driver refused the blob
+	size_t		loadedEntries{ 0 };	// Read from the file at startup
+};
+
+
+class PSOCache
+{
+public:
+	// Bump when the file layout or the way keys are built changes
+	static const uint32_t kFormatVersion = 1;
+
+	void SetDeviceId(const PSOCacheDeviceId& deviceId) { m_deviceId = deviceId; }
+
+	// Replaces the contents with a serialized cache.  Returns false, leaving the cache empty, if the data
+	// is truncated or corrupt, or was written by another format version, adapter or driver.
+	bool Deserialize(const uint8_t* data, size_t dataSize);
+
+	// Only entries found or stored since Deserialize are written, so blobs for pipelines that no longer
+	// exist (after a shader edit, say) are dropped.
+	void Serialize(std::vector<uint8_t>& data) const;
+
+	// Copies out the blob for key, if there is one
+	bool Find(uint64_t key, std::vector<uint8_t>& blob);
+	void Store(uint64_t key, const void* blob, size_t blobSize);
+
+	// For blobs the driver refused, which are replaced by Store once the pipeline has been recompiled
+	void Reject(uint64_t key);
+
+	// True if Serialize would write something different from what was loaded
+	bool IsDirty() const;
+
+	PSOCacheStats GetStats() const;
+
+private:
+	struct Entry
+	{
+		std::vector<uint8_t>	blob;
+		bool					used{ false };
+	};
+
+	mutable std::mutex						m_mutex;
+	PSOCacheDeviceId						m_deviceId;
+	std::unordered_map<uint64_t, Entry>		m_entries;
+	PSOCacheStats							m_stats;
+	bool									m_modified{ false };
+};
+
+} // namespace Kodiak
\ No newline at end of file
@@ -0,0 +1,41 @@
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+// Author: David Elder
+//
+
+// Built without the precompiled header, so that tools can share it
+
+#include "ParamId.h"
+
+#include <cassert>
+#include <mutex>
+#include <unordered_map>
+
+
+using namespace Kodiak;
+using namespace std;
+
+
+const char* ParamId::Intern(uint64_t hash, const string& name)
+{
+	// Nodes never move, so the strings stay put as the table grows
+	static mutex s_mutex;
+	static unordered_map<uint64_t, string> s_names;
+
+	lock_guard<mutex> CS(s_mutex);
+
+	auto it = s_names.find(hash);
+	if (it == s_names.end())
+	{
+		it = s_names.emplace(hash, name).first;
+	}
+
+	// Two names with the same hash would share every lookup
+	assert(it->second == name);
+
+	return it->second.c_str();
+}
\ No newline at end of file
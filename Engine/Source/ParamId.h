@@ -0,0 +1,105 @@
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+// Author: David Elder
+//
+
+#pragma once
+
+// Names of material and compute kernel parameters, resources and constant buffers, identified by a 64-bit
+// FNV-1a hash so lookups compare integers instead of strings.  A string literal is hashed at compile time
+// and keeps a pointer to its own characters.  Any other string, including a writable char array, is
+// interned, so every ParamId can hand back its name.  This header and ParamId.cpp only depend on the
+// standard library.
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace Kodiak
+{
+
+class ParamId
+{
+public:
+	// The name is kept by pointer, so this is for string literals, and other const arrays that live as long
+	// as the program.  Only the characters before the first null are hashed.
+	template <size_t N>
+	constexpr ParamId(const char(&name)[N])
+		: m_hash(Hash(name, Length(name, N)))
+		, m_name(name)
+	{}
+
+	// Writable buffers can change or go away, so they're interned like any other string
+	template <size_t N>
+	ParamId(char(&name)[N])
+		: ParamId(std::string(name, Length(name, N)))
+	{}
+
+	ParamId(const std::string& name)
+		: m_hash(Hash(name.c_str(), name.size()))
+		, m_name(Intern(m_hash, name))
+	{}
+
+	constexpr uint64_t GetHash() const { return m_hash; }
+	constexpr const char* GetName() const { return m_name; }
+
+	constexpr bool operator==(const ParamId& other) const { return m_hash == other.m_hash; }
+	constexpr bool operator!=(const ParamId& other) const { return m_hash != other.m_hash; }
+
+	static constexpr uint64_t Hash(const char* name, size_t length, uint64_t hash = 14695981039346656037ULL)
+	{
+		return length == 0 ? hash : Hash(name + 1, length - 1, (hash ^ static_cast<uint8_t>(*name)) * 1099511628211ULL);
+	}
+
+	// Characters before the first null, or maxLength if there isn't one
+	static constexpr size_t Length(const char* name, size_t maxLength)
+	{
+		return (maxLength == 0 || *name == '\0') ? 0 : 1 + Length(name + 1, maxLength - 1);
+	}
+
+private:
+	// Returns a copy of name that lives as long as the program
+	static const char* Intern(uint64_t hash, const std::string& name);
+
+	uint64_t	m_hash;
+	const char*	m_name;
+};
+
+
+// Flat map from ParamId to named objects, sorted by hash.  Entries are only added the first time a name is
+// looked up, so lookups are a binary search over contiguous memory.  Not thread safe.
+template <typename T>
+class ParamIdMap
+{
+public:
+	// Creates the entry from id's name if there isn't one yet
+	std::shared_ptr<T> FindOrCreate(ParamId id)
+	{
+		const uint64_t hash = id.GetHash();
+		auto it = std::lower_bound(m_entries.begin(), m_entries.end(), hash,
+			[](const Entry& entry, uint64_t value) { return entry.first < value; });
+
+		if (it != m_entries.end() && it->first == hash)
+		{
+			return it->second;
+		}
+
+		auto value = std::make_shared<T>(id.GetName());
+		m_entries.insert(it, Entry(hash, value));
+		return value;
+	}
+
+private:
+	typedef std::pair<uint64_t, std::shared_ptr<T>> Entry;
+	std::vector<Entry> m_entries;
+};
+
+} // namespace Kodiak
\ No newline at end of file
@@ -12,27 +12,107 @@
 
 #include "PipelineState12.h"
 
+#include "BinaryReader.h"
 #include "DeviceManager12.h"
 #include "DXGIUtility.h"
 #include "Format.h"
 #include "InputLayout12.h"
+#include "Paths.h"
+#include "PSOCache.h"
 #include "RenderEnums12.h"
 #include "RenderUtils.h"
 #include "RootSignature12.h"
 #include "Shader.h"
 #include "ShaderResource12.h"
 
+#include <condition_variable>
+
 
 using namespace Kodiak;
 using namespace std;
 using namespace Microsoft::WRL;
 
 
+namespace Kodiak
+{
+
+// The pipeline is published through pso once it has compiled, so readers never need a lock.  If it fails,
+// result is written before failed is set.  Both are set under publishLock, so threads blocked on another
+// thread's compile can sleep on published instead of spinning.
+struct PSOSlot
+{
+	atomic<ID3D12PipelineState*>	pso{ nullptr };
+	atomic<bool>					failed{ false };
+	HRESULT							result{ S_OK };
+	ComPtr<ID3D12PipelineState>		owner;
+
+	mutex							publishLock;
+	condition_variable				published;
+};
+
+} // namespace Kodiak
+
+
 namespace
 {
 
-	map<size_t, ComPtr<ID3D12PipelineState>> s_graphicsPSOHashMap;
-	map<size_t, ComPtr<ID3D12PipelineState>> s_computePSOHashMap;
+	// PSO slots keyed by HashState.  Split into shards with a lock each, so threads finalizing different
+	// PSOs rarely contend.
+	class ShardedPSOMap
+	{
+	public:
+		// Creates the slot if nobody has asked for this state before, in which case the caller compiles it
+		shared_ptr<PSOSlot> FindOrAdd(size_t hash, bool& created)
+		{
+			auto& shard = m_shards[(hash ^ (hash >> 16)) % kNumShards];
+
+			lock_guard<mutex> CS(shard.lock);
+			auto& slot = shard.slots[hash];
+			created = (slot == nullptr);
+			if (created)
+			{
+				slot = make_shared<PSOSlot>();
+			}
+			return slot;
+		}
+
+		void Clear()
+		{
+			for (auto& shard : m_shards)
+			{
+				lock_guard<mutex> CS(shard.lock);
+				shard.slots.clear();
+			}
+		}
+
+	private:
+		static const size_t kNumShards = 16;
+
+		struct alignas(64) Shard
+		{
+			mutex lock;
+			unordered_map<size_t, shared_ptr<PSOSlot>> slots;
+		};
+		array<Shard, kNumShards> m_shards;
+	};
+
+	ShardedPSOMap s_graphicsPSOMap;
+	ShardedPSOMap s_computePSOMap;
+
+	// Counters for LogCompileStats
+	atomic<uint32_t> s_asyncCompileCount{ 0 };
+	atomic<uint32_t> s_pendingCompileCount{ 0 };
+	atomic<uint32_t> s_failedCompileCount{ 0 };
+	atomic<uint32_t> s_syncWaitCount{ 0 };
+	atomic<uint64_t> s_skippedDrawCount{ 0 };
+	atomic<uint64_t> s_compileLatencyMicroseconds{ 0 };
+	atomic<uint64_t> s_maxCompileLatencyMicroseconds{ 0 };
+
+	// Compiled pipelines from previous runs, keyed by PersistentKey
+	PSOCache s_persistentCache;
+	bool s_persistentCacheLoaded{ false };
+	atomic<uint32_t> s_createdPSOCount{ 0 };
+	atomic<uint64_t> s_createMicroseconds{ 0 };
 
 	struct CD3D12_SHADER_BYTECODE : public D3D12_SHADER_BYTECODE
 	{
@@ -49,6 +129,225 @@ namespace
 		operator const D3D12_SHADER_BYTECODE&() const { return *this; }
 	};
 
+
+	string GetPersistentCachePath()
+	{
+		return Paths::GetInstance().BinaryDir() + "\\PSOCache12.bin";
+	}
+
+
+	uint64_t HashBytecode(const D3D12_SHADER_BYTECODE& bytecode, uint64_t hash)
+	{
+		hash = HashPSOBytes(&bytecode.BytecodeLength, sizeof(bytecode.BytecodeLength), hash);
+		return HashPSOBytes(bytecode.pShaderBytecode, bytecode.BytecodeLength, hash);
+	}
+
+
+	// HashState works on the raw desc, pointers included, which is fine within a run but not across runs.
+	// These hash what the pointers refer to instead.
+	uint64_t PersistentKey(const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc, const RootSignature& rootSignature)
+	{
+		// Stream output isn't exposed by GraphicsPSO
+		assert(desc.StreamOutput.NumEntries == 0);
+
+		D3D12_GRAPHICS_PIPELINE_STATE_DESC stableDesc;
+		memcpy(&stableDesc, &desc, sizeof(stableDesc));
+		stableDesc.pRootSignature = nullptr;
+		stableDesc.VS.pShaderBytecode = nullptr;
+		stableDesc.PS.pShaderBytecode = nullptr;
+		stableDesc.DS.pShaderBytecode = nullptr;
+		stableDesc.HS.pShaderBytecode = nullptr;
+		stableDesc.GS.pShaderBytecode = nullptr;
+		stableDesc.StreamOutput.pSODeclaration = nullptr;
+		stableDesc.StreamOutput.pBufferStrides = nullptr;
+		stableDesc.InputLayout.pInputElementDescs = nullptr;
+		stableDesc.CachedPSO.pCachedBlob = nullptr;
+		stableDesc.CachedPSO.CachedBlobSizeInBytes = 0;
+
+		uint64_t hash = HashPSOBytes(&stableDesc, sizeof(stableDesc));
+
+		const uint64_t rootSignatureHash = rootSignature.GetBlobHash();
+		hash = HashPSOBytes(&rootSignatureHash, sizeof(rootSignatureHash), hash);
+
+		hash = HashBytecode(desc.VS, hash);
+		hash = HashBytecode(desc.PS, hash);
+		hash = HashBytecode(desc.DS, hash);
+		hash = HashBytecode(desc.HS, hash);
+		hash = HashBytecode(desc.GS, hash);
+
+		for (uint32_t i = 0; i < desc.InputLayout.NumElements; ++i)
+		{
+			const auto& element = desc.InputLayout.pInputElementDescs[i];
+			hash = HashPSOBytes(element.SemanticName, strlen(element.SemanticName) + 1, hash);
+			hash = HashPSOBytes(&element.SemanticIndex, sizeof(element.SemanticIndex), hash);
+			hash = HashPSOBytes(&element.Format, sizeof(element.Format), hash);
+			hash = HashPSOBytes(&element.InputSlot, sizeof(element.InputSlot), hash);
+			hash = HashPSOBytes(&element.AlignedByteOffset, sizeof(element.AlignedByteOffset), hash);
+			hash = HashPSOBytes(&element.InputSlotClass, sizeof(element.InputSlotClass), hash);
+			hash = HashPSOBytes(&element.InstanceDataStepRate, sizeof(element.InstanceDataStepRate), hash);
+		}
+
+		return hash;
+	}
+
+
+	uint64_t PersistentKey(const D3D12_COMPUTE_PIPELINE_STATE_DESC& desc, const RootSignature& rootSignature)
+	{
+		D3D12_COMPUTE_PIPELINE_STATE_DESC stableDesc;
+		memcpy(&stableDesc, &desc, sizeof(stableDesc));
+		stableDesc.pRootSignature = nullptr;
+		stableDesc.CS.pShaderBytecode = nullptr;
+		stableDesc.CachedPSO.pCachedBlob = nullptr;
+		stableDesc.CachedPSO.CachedBlobSizeInBytes = 0;
+
+		uint64_t hash = HashPSOBytes(&stableDesc, sizeof(stableDesc));
+
+		const uint64_t rootSignatureHash = rootSignature.GetBlobHash();
+		hash = HashPSOBytes(&rootSignatureHash, sizeof(rootSignatureHash), hash);
+
+		return HashBytecode(desc.CS, hash);
+	}
+
+
+	// Creates the pipeline from its cached blob if there is one, otherwise compiles it and caches the blob
+	template <typename TDesc, typename TCreateFunc>
+	HRESULT CreatePipelineState(TDesc& desc, uint64_t persistentKey, TCreateFunc createFunc, ID3D12PipelineState** ppso)
+	{
+		const auto startTime = chrono::high_resolution_clock::now();
+
+		ID3D12PipelineState* pso = nullptr;
+
+		vector<uint8_t> cachedBlob;
+		if (s_persistentCache.Find(persistentKey, cachedBlob))
+		{
+			desc.CachedPSO.pCachedBlob = cachedBlob.data();
+			desc.CachedPSO.CachedBlobSizeInBytes = cachedBlob.size();
+
+			// Fails with D3D12_ERROR_DRIVER_VERSION_MISMATCH or D3D12_ERROR_ADAPTER_NOT_FOUND if the blob is
+			// stale in a way the file's driver version didn't catch
+			if (FAILED(createFunc(desc, &pso)))
+			{
+				s_persistentCache.Reject(persistentKey);
+				pso = nullptr;
+			}
+
+			desc.CachedPSO.pCachedBlob = nullptr;
+			desc.CachedPSO.CachedBlobSizeInBytes = 0;
+		}
+
+		if (pso == nullptr)
+		{
+			HRESULT hr = createFunc(desc, &pso);
+			if (FAILED(hr))
+			{
+				return hr;
+			}
+
+			ComPtr<ID3DBlob> blob;
+			if (SUCCEEDED(pso->GetCachedBlob(&blob)))
+			{
+				s_persistentCache.Store(persistentKey, blob->GetBufferPointer(), blob->GetBufferSize());
+			}
+		}
+
+		const auto elapsed = chrono::high_resolution_clock::now() - startTime;
+		s_createMicroseconds += chrono::duration_cast<chrono::microseconds>(elapsed).count();
+		++s_createdPSOCount;
+
+		*ppso = pso;
+		return S_OK;
+	}
+
+
+	HRESULT CreateGraphicsPipelineState(D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc, uint64_t persistentKey,
+		ID3D12PipelineState** ppso)
+	{
+		return CreatePipelineState(desc, persistentKey,
+			[](const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc, ID3D12PipelineState** pso)
+		{
+			return g_device->CreateGraphicsPipelineState(&desc, IID_PPV_ARGS(pso));
+		},
+			ppso);
+	}
+
+
+	// Takes ownership of pso.  A null pso marks the slot as failed, so nobody waits on it forever.
+	void PublishSlot(PSOSlot& slot, ID3D12PipelineState* pso, HRESULT hr)
+	{
+		{
+			lock_guard<mutex> CS(slot.publishLock);
+
+			if (pso == nullptr)
+			{
+				++s_failedCompileCount;
+				slot.result = FAILED(hr) ? hr : E_FAIL;
+				slot.failed = true;
+			}
+			else
+			{
+				slot.owner.Attach(pso);
+				slot.pso = pso;
+			}
+		}
+
+		slot.published.notify_all();
+	}
+
+
+	// For a slot another thread is compiling.  Returns the error if that compile failed.
+	HRESULT WaitForSlot(PSOSlot& slot)
+	{
+		if (slot.pso.load() != nullptr)
+		{
+			return S_OK;
+		}
+
+		++s_syncWaitCount;
+
+		unique_lock<mutex> CS(slot.publishLock);
+		slot.published.wait(CS, [&slot] { return slot.pso.load() != nullptr || slot.failed; });
+
+		return slot.failed ? slot.result : S_OK;
+	}
+
+
+	void RecordCompileLatency(chrono::high_resolution_clock::duration latency)
+	{
+		const uint64_t microseconds = chrono::duration_cast<chrono::microseconds>(latency).count();
+		s_compileLatencyMicroseconds += microseconds;
+
+		uint64_t prevMax = s_maxCompileLatencyMicroseconds.load();
+		while (microseconds > prevMax && !s_maxCompileLatencyMicroseconds.compare_exchange_weak(prevMax, microseconds))
+		{
+		}
+	}
+
+
+	// Everything a background compile needs, copied so the GraphicsPSO and its shaders can go away first
+	struct GraphicsCompileJob
+	{
+		D3D12_GRAPHICS_PIPELINE_STATE_DESC		desc;
+		uint64_t								persistentKey{ 0 };
+		ComPtr<ID3D12RootSignature>				rootSignature;
+		array<vector<uint8_t>, 5>				byteCode;
+		vector<D3D12_INPUT_ELEMENT_DESC>		inputElements;
+		vector<string>							semanticNames;
+		chrono::high_resolution_clock::time_point requestTime;
+	};
+
+
+	void CopyByteCode(D3D12_SHADER_BYTECODE& shader, vector<uint8_t>& storage)
+	{
+		if (shader.pShaderBytecode == nullptr)
+		{
+			return;
+		}
+
+		const auto bytes = reinterpret_cast<const uint8_t*>(shader.pShaderBytecode);
+		storage.assign(bytes, bytes + shader.BytecodeLength);
+		shader.pShaderBytecode = storage.data();
+	}
+
 } // anonymous namespace
 
 
@@ -158,8 +457,120 @@ DepthStencilStateDesc::DepthStencilStateDesc(bool enable, bool writeEnable)
 
 void PSO::DestroyAll()
 {
-	s_graphicsPSOHashMap.clear();
-	s_computePSOHashMap.clear();
+	s_graphicsPSOMap.Clear();
+	s_computePSOMap.Clear();
+}
+
+
+void PSO::LoadPersistentCache(const PSOCacheDeviceId& deviceId)
+{
+	s_persistentCache.SetDeviceId(deviceId);
+	s_persistentCacheLoaded = true;
+
+	const string fullPath = GetPersistentCachePath();
+
+	unique_ptr<uint8_t[]> data;
+	size_t dataSize = 0;
+	if (FAILED(BinaryReader::ReadEntireFile(fullPath, data, &dataSize)))
+	{
+		LOG_INFO << "No PSO cache at " << fullPath << ", pipelines will be compiled";
+		return;
+	}
+
+	if (s_persistentCache.Deserialize(data.get(), dataSize))
+	{
+		LOG_INFO << "Loaded " << s_persistentCache.GetStats().loadedEntries << " cached PSOs from " << fullPath;
+	}
+	else
+	{
+		LOG_INFO << "Ignoring PSO cache " << fullPath << ", it was written by another build, adapter or driver, or is corrupt";
+	}
+}
+
+
+void PSO::WaitForPendingCompiles()
+{
+	while (s_pendingCompileCount.load() > 0)
+	{
+		this_thread::yield();
+	}
+}
+
+
+void PSO::SavePersistentCache()
+{
+	if (!s_persistentCacheLoaded)
+	{
+		return;
+	}
+
+	const auto stats = s_persistentCache.GetStats();
+	LOG_INFO << "Created " << s_createdPSOCount.load() << " PSOs in " << (s_createMicroseconds.load() / 1000.0) << " ms, "
+		<< (stats.loadedEntries > 0 ? "warm" : "cold") << " (" << (stats.hits - stats.rejected) << " from the PSO cache, "
+		<< (stats.misses + stats.rejected) << " compiled)";
+
+	if (!s_persistentCache.IsDirty())
+	{
+		return;
+	}
+
+	vector<uint8_t> data;
+	s_persistentCache.Serialize(data);
+
+	const string fullPath = GetPersistentCachePath();
+	ofstream file(fullPath, ios::out | ios::trunc | ios::binary);
+	if (file)
+	{
+		file.write(reinterpret_cast<const char*>(data.data()), data.size());
+	}
+	else
+	{
+		LOG_WARNING << "Failed to write PSO cache to " << fullPath;
+	}
+}
+
+
+void PSO::LogCompileStats()
+{
+	const uint32_t asyncCompileCount = s_asyncCompileCount.load();
+	if (asyncCompileCount > 0)
+	{
+		LOG_INFO << asyncCompileCount << " PSOs compiled in the background (hitches avoided), "
+			<< s_skippedDrawCount.load() << " draws skipped while they compiled, latency "
+			<< (s_compileLatencyMicroseconds.load() / 1000.0 / asyncCompileCount) << " ms average, "
+			<< (s_maxCompileLatencyMicroseconds.load() / 1000.0) << " ms max";
+	}
+
+	const uint32_t syncWaitCount = s_syncWaitCount.load();
+	if (syncWaitCount > 0)
+	{
+		LOG_INFO << syncWaitCount << " PSO finalizes waited on another thread's compile";
+	}
+
+	const uint32_t failedCompileCount = s_failedCompileCount.load();
+	if (failedCompileCount > 0)
+	{
+		LOG_WARNING << failedCompileCount << " PSOs failed to compile";
+	}
+}
+
+
+void PSO::RecordSkippedDraw()
+{
+	++s_skippedDrawCount;
+}
+
+
+ID3D12PipelineState* PSO::GetPipelineStateObject() const
+{
+	assert(m_slot);
+	return m_slot->pso.load();
+}
+
+
+bool PSO::IsReady() const
+{
+	return m_slot && m_slot->pso.load() != nullptr;
 }
 
 
@@ -343,7 +754,7 @@ void GraphicsPSO::SetHullShader(HullShader* hullShader)
 }
 
 
-void GraphicsPSO::Finalize()
+size_t GraphicsPSO::PrepareForFinalize()
 {
 	// Make sure the root signature is finalized first
 	m_psoDesc.pRootSignature = m_rootSignature->GetSignature();
@@ -354,38 +765,87 @@ void GraphicsPSO::Finalize()
 	HashCode = HashStateArray(m_inputLayouts.get(), m_psoDesc.InputLayout.NumElements, HashCode);
 	m_psoDesc.InputLayout.pInputElementDescs = m_inputLayouts.get();
 
-	ID3D12PipelineState** PSORef = nullptr;
-	bool firstCompile = false;
-	{
-		static mutex s_HashMapMutex;
-		lock_guard<mutex> CS(s_HashMapMutex);
-		auto iter = s_graphicsPSOHashMap.find(HashCode);
+	return HashCode;
+}
 
-		// Reserve space so the next inquiry will find that someone got here first.
-		if (iter == s_graphicsPSOHashMap.end())
-		{
-			firstCompile = true;
-			PSORef = s_graphicsPSOHashMap[HashCode].GetAddressOf();
-		}
-		else
-		{
-			PSORef = iter->second.GetAddressOf();
-		}
-	}
+
+void GraphicsPSO::Finalize()
+{
+	const size_t HashCode = PrepareForFinalize();
+
+	bool firstCompile = false;
+	m_slot = s_graphicsPSOMap.FindOrAdd(HashCode, firstCompile);
 
 	if (firstCompile)
 	{
-		ThrowIfFailed(g_device->CreateGraphicsPipelineState(&m_psoDesc, IID_PPV_ARGS(&m_pso)));
-		s_graphicsPSOHashMap[HashCode].Attach(m_pso);
+		ID3D12PipelineState* pso = nullptr;
+		HRESULT hr = CreateGraphicsPipelineState(m_psoDesc, PersistentKey(m_psoDesc, *m_rootSignature), &pso);
+		PublishSlot(*m_slot, pso, hr);
+		ThrowIfFailed(hr);
 	}
 	else
 	{
-		while (*PSORef == nullptr)
+		ThrowIfFailed(WaitForSlot(*m_slot));
+	}
+}
+
+
+void GraphicsPSO::FinalizeAsync()
+{
+	const size_t HashCode = PrepareForFinalize();
+
+	bool firstCompile = false;
+	m_slot = s_graphicsPSOMap.FindOrAdd(HashCode, firstCompile);
+
+	// Already compiled, or being compiled by whoever got here first
+	if (!firstCompile)
+	{
+		return;
+	}
+
+	auto job = make_shared<GraphicsCompileJob>();
+	job->desc = m_psoDesc;
+	job->persistentKey = PersistentKey(m_psoDesc, *m_rootSignature);
+	job->rootSignature = m_psoDesc.pRootSignature;
+	job->requestTime = chrono::high_resolution_clock::now();
+
+	CopyByteCode(job->desc.VS, job->byteCode[0]);
+	CopyByteCode(job->desc.PS, job->byteCode[1]);
+	CopyByteCode(job->desc.DS, job->byteCode[2]);
+	CopyByteCode(job->desc.HS, job->byteCode[3]);
+	CopyByteCode(job->desc.GS, job->byteCode[4]);
+
+	const uint32_t numElements = m_psoDesc.InputLayout.NumElements;
+	if (numElements > 0)
+	{
+		job->inputElements.assign(m_inputLayouts.get(), m_inputLayouts.get() + numElements);
+		job->semanticNames.reserve(numElements);
+		for (auto& element : job->inputElements)
 		{
-			this_thread::yield();
+			job->semanticNames.push_back(element.SemanticName);
+			element.SemanticName = job->semanticNames.back().c_str();
 		}
-		m_pso = *PSORef;
+		job->desc.InputLayout.pInputElementDescs = job->inputElements.data();
 	}
+
+	++s_asyncCompileCount;
+	++s_pendingCompileCount;
+
+	auto slot = m_slot;
+	concurrency::create_task([job, slot]()
+	{
+		ID3D12PipelineState* pso = nullptr;
+		HRESULT hr = CreateGraphicsPipelineState(job->desc, job->persistentKey, &pso);
+		if (FAILED(hr))
+		{
+			LOG_ERROR << "Failed to compile PSO in the background, hr = 0x" << hex << hr;
+		}
+
+		PublishSlot(*slot, pso, hr);
+		RecordCompileLatency(chrono::high_resolution_clock::now() - job->requestTime);
+
+		--s_pendingCompileCount;
+	});
 }
 
 
@@ -414,36 +874,23 @@ void ComputePSO::Finalize()
 
 	size_t HashCode = HashState(&m_psoDesc);
 
-	ID3D12PipelineState** PSORef = nullptr;
 	bool firstCompile = false;
-	{
-		static mutex s_HashMapMutex;
-		lock_guard<mutex> CS(s_HashMapMutex);
-		auto iter = s_computePSOHashMap.find(HashCode);
-
-		// Reserve space so the next inquiry will find that someone got here first.
-		if (iter == s_computePSOHashMap.end())
-		{
-			firstCompile = true;
-			PSORef = s_computePSOHashMap[HashCode].GetAddressOf();
-		}
-		else
-		{
-			PSORef = iter->second.GetAddressOf();
-		}
-	}
+	m_slot = s_computePSOMap.FindOrAdd(HashCode, firstCompile);
 
 	if (firstCompile)
 	{
-		ThrowIfFailed(g_device->CreateComputePipelineState(&m_psoDesc, IID_PPV_ARGS(&m_pso)));
-		s_computePSOHashMap[HashCode].Attach(m_pso);
+		ID3D12PipelineState* pso = nullptr;
+		HRESULT hr = CreatePipelineState(m_psoDesc, PersistentKey(m_psoDesc, *m_rootSignature),
+			[](const D3D12_COMPUTE_PIPELINE_STATE_DESC& desc, ID3D12PipelineState** pso)
+		{
+			return g_device->CreateComputePipelineState(&desc, IID_PPV_ARGS(pso));
+		},
+			&pso);
+		PublishSlot(*m_slot, pso, hr);
+		ThrowIfFailed(hr);
 	}
 	else
 	{
-		while (*PSORef == nullptr)
-		{
-			this_thread::yield();
-		}
-		m_pso = *PSORef;
+		ThrowIfFailed(WaitForSlot(*m_slot));
 	}
 }
\ No newline at end of file
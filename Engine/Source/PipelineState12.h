@@ -23,6 +23,8 @@ class InputLayout;
 class PixelShader;
 class RootSignature;
 class VertexShader;
+struct PSOCacheDeviceId;
+struct PSOSlot;
 enum class Blend;
 enum class BlendOp;
 enum class ColorFormat;
@@ -120,6 +122,20 @@ public:
 
 	static void DestroyAll();
 
+	// Pipelines compiled on earlier runs are created from their cached blobs.  Load before creating any
+	// PSOs, and save at shutdown, which also logs how long pipeline creation took.
+	static void LoadPersistentCache(const PSOCacheDeviceId& deviceId);
+	static void SavePersistentCache();
+
+	// Blocks until every background compile started by FinalizeAsync has finished.  Call before saving the
+	// cache, so their pipelines are in it, and before the device is released.
+	static void WaitForPendingCompiles();
+
+	// Logs how many pipelines were compiled off the calling thread, the draws skipped while they were
+	// compiling, and how long they took from request to ready
+	static void LogCompileStats();
+	static void RecordSkippedDraw();
+
 	void SetRootSignature(const RootSignature& bindMappings)
 	{
 		m_rootSignature = &bindMappings;
@@ -131,11 +147,17 @@ public:
 		return *m_rootSignature;
 	}
 
-	ID3D12PipelineState* GetPipelineStateObject() const { return m_pso; }
+	ID3D12PipelineState* GetPipelineStateObject() const;
+
+	// False until the pipeline has finished compiling.  Only PSOs finalized with FinalizeAsync can be
+	// used before they're ready, and draws with them should be skipped until then.
+	bool IsReady() const;
 
 protected:
-	const RootSignature* m_rootSignature;
-	ID3D12PipelineState* m_pso;
+	const RootSignature*		m_rootSignature;
+
+	// Shared by every PSO with the same state
+	std::shared_ptr<PSOSlot>	m_slot;
 };
 
 
@@ -164,8 +186,15 @@ public:
 	void SetGeometryShader(GeometryShader* geometryShader);
 	void SetPixelShader(PixelShader* pixelShader);
 
+	// Throws if the pipeline fails to compile, here or on the thread that was already compiling it
 	void Finalize();
 
+	// Compiles on a worker thread and returns immediately.  Check IsReady before using the PSO.
+	void FinalizeAsync();
+
+private:
+	size_t PrepareForFinalize();
+
 private:
 	D3D12_GRAPHICS_PIPELINE_STATE_DESC m_psoDesc;
 	std::shared_ptr<const D3D12_INPUT_ELEMENT_DESC> m_inputLayouts;
@@ -13,6 +13,7 @@
 #include "PostProcessing.h"
 
 #include "CommandList.h"
+#include "ComputeConstantBuffer.h"
 #include "ComputeParameter.h"
 #include "ComputeResource.h"
 #include "DeviceManager.h"
@@ -28,6 +29,62 @@ using namespace std;
 using namespace DirectX;
 
 
+namespace
+{
+
+// Mirrors the cbuffer in ToneMapCS.hlsl.  The debug luminance shaders declare the same cbuffer without
+// g_ToeStrength.
+struct ToneMapConstants
+{
+	XMFLOAT2	rcpBufferDim;
+	float		bloomStrength;
+	float		toeStrength;
+};
+
+const ShaderReflection::ConstantStructMember s_toneMapMembers[] =
+{
+	{ "g_RcpBufferDim",		offsetof(ToneMapConstants, rcpBufferDim),	sizeof(ToneMapConstants::rcpBufferDim) },
+	{ "g_BloomStrength",	offsetof(ToneMapConstants, bloomStrength),	sizeof(ToneMapConstants::bloomStrength) },
+	{ "g_ToeStrength",		offsetof(ToneMapConstants, toeStrength),	sizeof(ToneMapConstants::toeStrength) }
+};
+
+
+// Mirrors the cbuffer in BloomExtractAndDownsampleHdrCS.hlsl and BloomExtractAndDownsampleLdrCS.hlsl
+struct BloomExtractConstants
+{
+	XMFLOAT2	inverseOutputSize;
+	float		bloomThreshold;
+};
+
+const ShaderReflection::ConstantStructMember s_bloomExtractMembers[] =
+{
+	{ "g_inverseOutputSize",	offsetof(BloomExtractConstants, inverseOutputSize),	sizeof(BloomExtractConstants::inverseOutputSize) },
+	{ "g_bloomThreshold",		offsetof(BloomExtractConstants, bloomThreshold),	sizeof(BloomExtractConstants::bloomThreshold) }
+};
+
+
+// Mirrors the cbuffer in AdaptExposureCS.hlsl
+struct AdaptExposureConstants
+{
+	float		targetLuminance;
+	float		adaptationRate;
+	float		minExposure;
+	float		maxExposure;
+	float		pixelCount;
+};
+
+const ShaderReflection::ConstantStructMember s_adaptExposureMembers[] =
+{
+	{ "TargetLuminance",	offsetof(AdaptExposureConstants, targetLuminance),	sizeof(AdaptExposureConstants::targetLuminance) },
+	{ "AdaptationRate",		offsetof(AdaptExposureConstants, adaptationRate),	sizeof(AdaptExposureConstants::adaptationRate) },
+	{ "MinExposure",		offsetof(AdaptExposureConstants, minExposure),		sizeof(AdaptExposureConstants::minExposure) },
+	{ "MaxExposure",		offsetof(AdaptExposureConstants, maxExposure),		sizeof(AdaptExposureConstants::maxExposure) },
+	{ "PixelCount",			offsetof(AdaptExposureConstants, pixelCount),		sizeof(AdaptExposureConstants::pixelCount) }
+};
+
+} // anonymous namespace
+
+
 PostProcessing::PostProcessing()
 	: SceneColorBuffer(m_sceneColorBuffer)
 	, PostEffectsBuffer(m_postEffectsBuffer)
@@ -238,9 +295,11 @@ void PostProcessing::ProcessHDR(ComputeCommandList& commandList)
 	float toeStrength = m_toeStrength < 1e-6f ? 1e32f : 1.0f / m_toeStrength;
 
 	// Set constants
-	computeKernel.GetParameter("g_RcpBufferDim")->SetValueImmediate(XMFLOAT2(1.0f / m_sceneColorBuffer->GetWidth(), 1.0f / m_sceneColorBuffer->GetHeight()));
-	computeKernel.GetParameter("g_BloomStrength")->SetValueImmediate(m_bloomStrength);
-	computeKernel.GetParameter("g_ToeStrength")->SetValueImmediate(toeStrength);
+	ToneMapConstants constants;
+	constants.rcpBufferDim = XMFLOAT2(1.0f / m_sceneColorBuffer->GetWidth(), 1.0f / m_sceneColorBuffer->GetHeight());
+	constants.bloomStrength = m_bloomStrength;
+	constants.toeStrength = toeStrength;
+	computeKernel.GetConstantBuffer("ConstantBuffer")->SetConstantsImmediate(constants, s_toneMapMembers);
 
 	// Separate out LDR result from its perceived luminance
 	if (DeviceManager::GetInstance().SupportsTypedUAVLoad_R11G11B10_FLOAT())
@@ -295,8 +354,10 @@ void PostProcessing::GenerateBloom(ComputeCommandList& commandList)
 	const float invBloomWidth = 1.0f / static_cast<float>(m_bloomWidth);
 	const float invBloomHeight = 1.0f / static_cast<float>(m_bloomHeight);
 
-	computeKernel.GetParameter("g_inverseOutputSize")->SetValueImmediate(XMFLOAT2(invBloomWidth, invBloomHeight));
-	computeKernel.GetParameter("g_bloomThreshold")->SetValueImmediate(m_bloomThreshold);
+	BloomExtractConstants constants;
+	constants.inverseOutputSize = XMFLOAT2(invBloomWidth, invBloomHeight);
+	constants.bloomThreshold = m_bloomThreshold;
+	computeKernel.GetConstantBuffer("cb0")->SetConstantsImmediate(constants, s_bloomExtractMembers);
 
 	commandList.TransitionResource(m_bloomUAV1[0], ResourceState::UnorderedAccess);
 	commandList.TransitionResource(m_lumaLR, ResourceState::UnorderedAccess);
@@ -454,11 +515,13 @@ void PostProcessing::UpdateExposure(ComputeCommandList& commandList)
 	m_adaptExposureCs.GetResource("Histogram")->SetSRVImmediate(m_histogram);
 	m_adaptExposureCs.GetResource("Exposure")->SetUAVImmediate(m_exposureBuffer);
 
-	m_adaptExposureCs.GetParameter("TargetLuminance")->SetValueImmediate(m_targetLuminance);
-	m_adaptExposureCs.GetParameter("AdaptationRate")->SetValueImmediate(m_adaptationRate);
-	m_adaptExposureCs.GetParameter("MinExposure")->SetValueImmediate(m_minExposure);
-	m_adaptExposureCs.GetParameter("MaxExposure")->SetValueImmediate(m_maxExposure);
-	m_adaptExposureCs.GetParameter("PixelCount")->SetValueImmediate(static_cast<float>(m_bloomWidth * m_bloomHeight));
+	AdaptExposureConstants constants;
+	constants.targetLuminance = m_targetLuminance;
+	constants.adaptationRate = m_adaptationRate;
+	constants.minExposure = m_minExposure;
+	constants.maxExposure = m_maxExposure;
+	constants.pixelCount = static_cast<float>(m_bloomWidth * m_bloomHeight);
+	m_adaptExposureCs.GetConstantBuffer("cb0")->SetConstantsImmediate(constants, s_adaptExposureMembers);
 
 	m_adaptExposureCs.Dispatch(commandList);
 	m_adaptExposureCs.UnbindUAVs(commandList);
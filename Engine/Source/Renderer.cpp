@@ -14,8 +14,10 @@
 #include "ColorBuffer.h"
 #include "CommandList.h"
 #include "CommandListManager.h"
+#include "ComputeKernelPermutations.h"
 #include "DepthBuffer.h"
 #include "DeviceManager.h"
+#include "Effect.h"
 #include "Format.h"
 #include "IndexBuffer.h"
 #include "Model.h"
@@ -24,7 +26,9 @@
 #include "ResourceLoader.h"
 #include "SamplerManager.h"
 #include "Scene.h"
+#include "ShaderReflectionCache.h"
 #include "TextureResource.h"
+#include "TextureStreamer.h"
 
 using namespace Kodiak;
 using namespace Microsoft::WRL;
@@ -82,6 +86,10 @@ void Renderer::Finalize()
 	
 	SamplerManager::GetInstance().Shutdown();
 
+	ShaderReflection::LogSignatureCacheStats();
+	BaseEffect::LogFinalizeStats();
+	ComputeKernelPermutations::LogStats();
+
 	DeviceManager::GetInstance().Finalize();
 }
 
@@ -115,6 +123,10 @@ void Renderer::EnqueueRenderCommand(function<void()>&& command)
 void Renderer::Update()
 {
 	ResourceLoader::GetInstance().Update();
+	TextureStreamer::GetInstance().Update();
+
+	// Sets up the materials that were waiting on effects finalized by worker threads
+	BaseEffect::DispatchFinalizedCallbacks();
 }
 
 
@@ -9,4 +9,47 @@
 
 #include "Stdafx.h"
 
-#include "ResourceLoader.h"
\ No newline at end of file
+#include "ResourceLoader.h"
+
+
+using namespace Kodiak;
+using namespace std;
+
+
+void ResourceLoader::Update()
+{
+	// Drain the loads finished by the loader threads since last frame
+	shared_ptr<IAsyncResource> resource;
+	while (m_completionQueue.try_pop(resource))
+	{
+		// Failed loads still run their load-finished callbacks, so dependents aren't left waiting
+		resource->ExecutePostLoadCallbacks();
+
+		const auto& path = resource->GetResourcePath();
+
+		unique_lock<shared_mutex> CS(m_mutex);
+		m_pendingQueue.erase(path);
+		m_readyQueue[path] = resource;
+	}
+
+	SweepExpired();
+}
+
+
+void ResourceLoader::SweepExpired()
+{
+	// Look for expired entries in a fixed slice of the ready queue, picking up where last frame's sweep
+	// stopped.  Loads and lookups can carry on meanwhile, and the exclusive lock is only taken when there's
+	// something to erase.
+	{
+		shared_lock<shared_mutex> CS(m_mutex);
+		CollectExpired(m_readyQueue, m_sweepBucket, m_sweepBucketsPerFrame, m_expiredPaths);
+	}
+
+	if (!m_expiredPaths.empty())
+	{
+		unique_lock<shared_mutex> CS(m_mutex);
+		EraseExpired(m_readyQueue, m_expiredPaths);
+		m_expiredPaths.clear();
+	}
+}
\ No newline at end of file
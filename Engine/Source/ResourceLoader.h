@@ -9,9 +9,12 @@
 
 #pragma once
 
+#include "ExpiredEntrySweep.h"
 #include "Filesystem.h"
 #include "IAsyncResource.h"
 
+#include <concurrent_queue.h>
+
 namespace Kodiak
 {
 
@@ -59,7 +62,9 @@ public:
 		}
 		else
 		{
+			LOAD_TELEMETRY_BEGIN(*resource);
 			resource->DoLoad();
+			LOAD_TELEMETRY_END(*resource);
 
 			std::unique_lock<std::shared_mutex> CS(m_mutex);
 			m_readyQueue[path] = resource;
@@ -91,7 +96,9 @@ public:
 		resource = make_shared<TResource>(std::forward<U>(u)...);
 		resource->SetResourcePath(path);
 
+		LOAD_TELEMETRY_BEGIN(*resource);
 		resource->DoLoad();
+		LOAD_TELEMETRY_END(*resource);
 		{
 			std::unique_lock<std::shared_mutex> CS(m_mutex);
 			m_readyQueue[path] = resource;
@@ -101,82 +108,168 @@ public:
 	}
 
 
-	void Update()
+	// Like Load, for many resources at once.  The lookups and the queueing each take the loader's lock
+	// once for the whole batch, and requests for the same path share one resource.  create(i) makes the
+	// resource for paths[i] when it isn't already loaded or pending.  Paths that don't exist yield null.
+	template<class TResource, class TCreate>
+	std::vector<std::shared_ptr<TResource>> LoadBatch(const std::vector<std::string>& paths, TCreate&& create)
 	{
-		std::unique_lock<std::shared_mutex> CS(m_mutex);
+		std::vector<std::shared_ptr<TResource>> resources(paths.size());
+		std::vector<size_t> missing;
 
-		auto it = std::begin(m_pendingQueue);
-		while (it != std::end(m_pendingQueue))
 		{
-			auto weak = it->second;
-			if (!weak.expired())
+			std::shared_lock<std::shared_mutex> CS(m_mutex);
+			for (size_t i = 0; i < paths.size(); ++i)
 			{
-				auto resource = weak.lock();
-				if (resource)
+				resources[i] = std::dynamic_pointer_cast<TResource>(FindObjectNoLock(paths[i]));
+				if (!resources[i])
 				{
-					if (resource->IsLoadFinished())
-					{
-						if (resource->IsReady())
-						{
-							resource->ExecutePostLoadCallbacks();
-						}
-						m_readyQueue[it->first] = resource;
-						it = m_pendingQueue.erase(it);
-					}
+					missing.push_back(i);
 				}
-				else
+			}
+		}
+
+		if (!m_asyncLoadEnabled)
+		{
+			for (auto& resource : resources)
+			{
+				if (resource)
 				{
-					++it;
+					resource->Wait();
 				}
 			}
-			else
+		}
+
+		// Create the rest, once per distinct path
+		auto& filesystem = Filesystem::GetInstance();
+		std::unordered_map<std::string, std::shared_ptr<TResource>> created;
+		std::vector<std::shared_ptr<IAsyncResource>> newResources;
+
+		for (auto i : missing)
+		{
+			auto it = created.find(paths[i]);
+			if (it != end(created))
+			{
+				resources[i] = it->second;
+				continue;
+			}
+
+			std::shared_ptr<TResource> resource;
+			if (filesystem.Exists(paths[i]))
 			{
-				it = m_pendingQueue.erase(it);
+				resource = create(i);
+				resource->SetResourcePath(paths[i]);
+				newResources.push_back(resource);
 			}
+			created[paths[i]] = resource;
+			resources[i] = resource;
 		}
 
-		it = std::begin(m_readyQueue);
-		while (it != std::end(m_readyQueue))
+		if (newResources.empty())
+		{
+			return resources;
+		}
+
+		if (m_asyncLoadEnabled)
 		{
-			if (it->second.expired())
+			std::unique_lock<std::shared_mutex> CS(m_mutex);
+			for (auto& resource : newResources)
 			{
-				it = m_readyQueue.erase(it);
+				QueueNoLock(resource->GetResourcePath(), resource);
 			}
-			else
+		}
+		else
+		{
+			for (auto& resource : newResources)
+			{
+				LOAD_TELEMETRY_BEGIN(*resource);
+				resource->DoLoad();
+				LOAD_TELEMETRY_END(*resource);
+			}
+
+			std::unique_lock<std::shared_mutex> CS(m_mutex);
+			for (auto& resource : newResources)
 			{
-				++it;
+				m_readyQueue[resource->GetResourcePath()] = resource;
 			}
 		}
+
+		return resources;
 	}
 
 
+	// Drains the loads completed since the last call and sweeps a slice of the expired entries
+	void Update();
+
+	// Number of ready queue hash buckets Update checks for expired resources each frame
+	void SetSweepBucketsPerFrame(size_t numBuckets) { m_sweepBucketsPerFrame = numBuckets; }
+
+
 private:
 	void Queue(const std::string& path, std::shared_ptr<IAsyncResource> resource)
 	{
-		std::weak_ptr<IAsyncResource> weak = resource;
-		
+		std::unique_lock<std::shared_mutex> CS(m_mutex);
+		QueueNoLock(path, resource);
+	}
+
+
+	// Caller holds m_mutex exclusively
+	void QueueNoLock(const std::string& path, std::shared_ptr<IAsyncResource> resource)
+	{
 		// Add to pending work queue
+		m_pendingQueue[path] = resource;
+
+		LOAD_TELEMETRY_QUEUED(*resource);
+
+		// Launch async background task, which hands the resource back through the completion queue.  The
+		// future keeps the task alive for as long as the resource holds it, so the task only borrows the
+		// resource's reference while the load runs, or the resource could never be freed.
+		auto loadingResource = std::make_shared<std::shared_ptr<IAsyncResource>>(resource);
+		auto fut = std::async(std::launch::async, [this, loadingResource]()
 		{
-			std::unique_lock<std::shared_mutex> CS(m_mutex);
-			m_pendingQueue[path] = weak;
+			auto resource = std::move(*loadingResource);
 
-			// Launch async background task
-			auto fut = std::async(std::launch::async, [resource]() { resource->DoLoad(); });
-			resource->AcquireThreadResult(std::move(fut));
-		}
+			LOAD_TELEMETRY_BEGIN(*resource);
+			try
+			{
+				resource->DoLoad();
+			}
+			catch (...)
+			{
+				LOAD_TELEMETRY_END(*resource);
+				m_completionQueue.push(resource);
+				throw;
+			}
+			LOAD_TELEMETRY_END(*resource);
+			m_completionQueue.push(resource);
+		});
+		resource->AcquireThreadResult(std::move(fut));
 	}
 
 
+	void SweepExpired();
+
+
 	std::shared_ptr<IAsyncResource> FindObject(const std::string& path)
 	{
 		std::shared_lock<std::shared_mutex> CS(m_mutex);
+		return FindObjectNoLock(path);
+	}
 
-		// Check ready queue first
+
+	// Caller holds m_mutex
+	std::shared_ptr<IAsyncResource> FindObjectNoLock(const std::string& path)
+	{
+		// Check ready queue first.  Expired entries linger until the incremental sweep reaches them,
+		// and a reload of the same path may be pending in the meantime.
 		{
 			auto res = m_readyQueue.find(path);
 			if (res != end(m_readyQueue))
 			{
-				return res->second.lock();
+				if (auto resource = res->second.lock())
+				{
+					return resource;
+				}
 			}
 		}
 
@@ -198,6 +291,14 @@ private:
 	std::shared_mutex	m_mutex;
 	std::unordered_map<std::string, std::weak_ptr<IAsyncResource>> m_pendingQueue;
 	std::unordered_map<std::string, std::weak_ptr<IAsyncResource>> m_readyQueue;
+
+	// Loader threads push finished resources here, and Update pops them without scanning m_pendingQueue
+	Concurrency::concurrent_queue<std::shared_ptr<IAsyncResource>> m_completionQueue;
+
+	// Incremental sweep of expired entries in m_readyQueue, only touched by Update
+	size_t						m_sweepBucket{ 0 };
+	size_t						m_sweepBucketsPerFrame{ 256 };
+	std::vector<std::string>	m_expiredPaths;
 };
 
 } // namespace Kodiak
\ No newline at end of file
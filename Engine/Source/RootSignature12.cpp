@@ -13,7 +13,7 @@
 #include "RootSignature12.h"
 
 #include "DeviceManager12.h"
-#include "RenderUtils.h"
+#include "PSOCache.h"
 
 
 using namespace Kodiak;
@@ -21,7 +21,13 @@ using namespace std;
 using namespace Microsoft::WRL;
 
 
-static std::map<size_t, ComPtr<ID3D12RootSignature>> s_rootSignatureHashMap;
+// Keyed on the hash of the serialized signature, which covers the flags and leaves out the unused
+// bytes of each root parameter's union
+static std::map<uint64_t, ComPtr<ID3D12RootSignature>> s_rootSignatureHashMap;
+static atomic<uint32_t> s_finalizeCount{ 0 };
+
+atomic<uint64_t> RootSignature::s_bindCount{ 0 };
+atomic<uint64_t> RootSignature::s_changeCount{ 0 };
 
 
 void RootSignature::DestroyAll(void)
@@ -108,8 +114,6 @@ void RootSignature::Finalize(D3D12_ROOT_SIGNATURE_FLAGS flags)
 	m_descriptorTableBitMap = 0;
 	m_maxDescriptorCacheHandleCount = 0;
 
-	size_t hashCode = HashStateArray(rootDesc.pStaticSamplers, m_numSamplers);
-
 	for(uint32_t param = 0; param < m_numParameters; ++param)
 	{
 		const D3D12_ROOT_PARAMETER& rootParam = rootDesc.pParameters[param];
@@ -119,15 +123,18 @@ void RootSignature::Finalize(D3D12_ROOT_SIGNATURE_FLAGS flags)
 		{
 			assert(rootParam.DescriptorTable.pDescriptorRanges != nullptr);
 
-			hashCode = HashStateArray(rootParam.DescriptorTable.pDescriptorRanges,
-				rootParam.DescriptorTable.NumDescriptorRanges, hashCode);
-
 			// We don't care about sampler descriptor tables.  We don't manage them in DescriptorCache
 			if(rootParam.DescriptorTable.pDescriptorRanges->RangeType == D3D12_DESCRIPTOR_RANGE_TYPE_SAMPLER)
 			{
 				continue;
 			}
 
+			// Tables outside register space 0 index the persistent bindless heap, and are bound directly
+			if (rootParam.DescriptorTable.pDescriptorRanges->RegisterSpace != 0)
+			{
+				continue;
+			}
+
 			m_descriptorTableBitMap |= (1 << param);
 			for (uint32_t tableRange = 0; tableRange < rootParam.DescriptorTable.NumDescriptorRanges; ++tableRange)
 			{
@@ -136,11 +143,24 @@ void RootSignature::Finalize(D3D12_ROOT_SIGNATURE_FLAGS flags)
 
 			m_maxDescriptorCacheHandleCount += m_descriptorTableSize[param];
 		}
-		else
+	}
+
+	// Serialized up front, since both the persistent PSO cache and the lookup below key on the blob's contents
+	ComPtr<ID3DBlob> pOutBlob, pErrorBlob;
+
+	HRESULT hr = D3D12SerializeRootSignature(&rootDesc, D3D_ROOT_SIGNATURE_VERSION_1,
+		pOutBlob.GetAddressOf(), pErrorBlob.GetAddressOf());
+	if(FAILED(hr))
+	{ 
+		if (pErrorBlob)
 		{
-			hashCode = HashState(&rootParam, hashCode);
+			OutputDebugStringA((char*)pErrorBlob->GetBufferPointer());
 		}
 	}
+	ThrowIfFailed(hr);
+
+	m_blobHash = HashPSOBytes(pOutBlob->GetBufferPointer(), pOutBlob->GetBufferSize());
+	++s_finalizeCount;
 
 	ID3D12RootSignature** rsRef = nullptr;
 	bool firstCompile = false;
@@ -148,12 +168,12 @@ void RootSignature::Finalize(D3D12_ROOT_SIGNATURE_FLAGS flags)
 		static mutex s_hashMapMutex;
 		lock_guard<mutex> CS(s_hashMapMutex);
 
-		auto iter = s_rootSignatureHashMap.find(hashCode);
+		auto iter = s_rootSignatureHashMap.find(m_blobHash);
 
 		// Reserve space so the next inquiry will find that someone got here first.
 		if(iter == s_rootSignatureHashMap.end())
 		{
-			rsRef = s_rootSignatureHashMap[hashCode].GetAddressOf();
+			rsRef = s_rootSignatureHashMap[m_blobHash].GetAddressOf();
 			firstCompile = true;
 		}
 		else
@@ -164,22 +184,10 @@ void RootSignature::Finalize(D3D12_ROOT_SIGNATURE_FLAGS flags)
 
 	if(firstCompile)
 	{
-		ComPtr<ID3DBlob> pOutBlob, pErrorBlob;
-
-		HRESULT hr = D3D12SerializeRootSignature(&rootDesc, D3D_ROOT_SIGNATURE_VERSION_1,
-			pOutBlob.GetAddressOf(), pErrorBlob.GetAddressOf());
-		if(FAILED(hr))
-		{ 
-			if (pErrorBlob)
-			{
-				OutputDebugStringA((char*)pErrorBlob->GetBufferPointer());
-			}
-		}
-
 		ThrowIfFailed(g_device->CreateRootSignature(1, pOutBlob->GetBufferPointer(), pOutBlob->GetBufferSize(),
 			IID_PPV_ARGS(&m_signature)));
 
-		s_rootSignatureHashMap[hashCode].Attach(m_signature);
+		s_rootSignatureHashMap[m_blobHash].Attach(m_signature);
 		assert(*rsRef == m_signature);
 	}
 	else
@@ -192,4 +200,22 @@ void RootSignature::Finalize(D3D12_ROOT_SIGNATURE_FLAGS flags)
 	}
 
 	m_finalized = true;
+}
+
+
+void RootSignature::LogStats(uint64_t frameCount)
+{
+	const uint32_t finalizeCount = s_finalizeCount.load();
+	if (finalizeCount == 0)
+	{
+		return;
+	}
+
+	LOG_INFO << finalizeCount << " root signatures finalized, " << s_rootSignatureHashMap.size() << " distinct";
+
+	if (frameCount > 0)
+	{
+		LOG_INFO << "Root signature changes per frame: " << (s_changeCount.load() / frameCount) << " of "
+			<< (s_bindCount.load() / frameCount) << " sets";
+	}
 }
\ No newline at end of file
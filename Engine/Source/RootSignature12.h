@@ -132,6 +132,19 @@ public:
 
 	static void DestroyAll(void);
 
+	// Called by the command lists, to count how often the bound root signature actually changes
+	static void RecordBind(bool changed)
+	{
+		s_bindCount.fetch_add(1, std::memory_order_relaxed);
+		if (changed)
+		{
+			s_changeCount.fetch_add(1, std::memory_order_relaxed);
+		}
+	}
+
+	// Logs how many distinct root signatures the finalized ones collapsed into, and the changes per frame
+	static void LogStats(uint64_t frameCount);
+
 
 	void Reset(uint32_t numRootParams, uint32_t numStaticSamplers = 0)
 	{
@@ -181,6 +194,9 @@ public:
 
 	ID3D12RootSignature* GetSignature() const { return m_signature; }
 
+	// Hash of the serialized signature, which unlike the pointer is the same from run to run
+	uint64_t GetBlobHash() const { return m_blobHash; }
+
 protected:
 	bool m_finalized{ false };
 	uint32_t m_numParameters;
@@ -192,5 +208,9 @@ protected:
 	std::unique_ptr<RootParameter[]> m_paramArray;
 	std::unique_ptr<D3D12_STATIC_SAMPLER_DESC[]> m_samplerArray;
 	ID3D12RootSignature* m_signature{ nullptr };
+	uint64_t m_blobHash{ 0 };
+
+	static std::atomic<uint64_t> s_bindCount;
+	static std::atomic<uint64_t> s_changeCount;
 };
 } // namespace Kodiak
\ No newline at end of file
@@ -14,6 +14,7 @@
 
 #include "Camera.h"
 #include "CommandList.h"
+#include "ComputeConstantBuffer.h"
 #include "ComputeParameter.h"
 #include "ComputeResource.h"
 #include "DepthBuffer.h"
@@ -29,6 +30,87 @@ using namespace DirectX;
 using namespace Math;
 
 
+namespace
+{
+
+// Mirrors the cbuffer in AoRenderCS.hlsli
+struct AoRenderConstants
+{
+	XMFLOAT4	invThicknessTable[3];
+	XMFLOAT4	sampleWeightTable[3];
+	XMFLOAT2	invSliceDimension;
+	float		rejectFadeoff;
+	float		rcpAccentuation;
+};
+
+const ShaderReflection::ConstantStructMember s_aoRenderMembers[] =
+{
+	{ "gInvThicknessTable",	offsetof(AoRenderConstants, invThicknessTable),	sizeof(AoRenderConstants::invThicknessTable) },
+	{ "gSampleWeightTable",	offsetof(AoRenderConstants, sampleWeightTable),	sizeof(AoRenderConstants::sampleWeightTable) },
+	{ "gInvSliceDimension",	offsetof(AoRenderConstants, invSliceDimension),	sizeof(AoRenderConstants::invSliceDimension) },
+	{ "gRejectFadeoff",		offsetof(AoRenderConstants, rejectFadeoff),		sizeof(AoRenderConstants::rejectFadeoff) },
+	{ "gRcpAccentuation",	offsetof(AoRenderConstants, rcpAccentuation),	sizeof(AoRenderConstants::rcpAccentuation) }
+};
+
+
+// Mirrors the cbuffer in AoBlurAndUpsampleCS.hlsli
+struct AoBlurAndUpsampleConstants
+{
+	XMFLOAT2	invLowResolution;
+	XMFLOAT2	invHighResolution;
+	float		noiseFilterStrength;
+	float		stepSize;
+	float		blurTolerance;
+	float		upsampleTolerance;
+};
+
+const ShaderReflection::ConstantStructMember s_aoBlurAndUpsampleMembers[] =
+{
+	{ "InvLowResolution",		offsetof(AoBlurAndUpsampleConstants, invLowResolution),		sizeof(AoBlurAndUpsampleConstants::invLowResolution) },
+	{ "InvHighResolution",		offsetof(AoBlurAndUpsampleConstants, invHighResolution),	sizeof(AoBlurAndUpsampleConstants::invHighResolution) },
+	{ "NoiseFilterStrength",	offsetof(AoBlurAndUpsampleConstants, noiseFilterStrength),	sizeof(AoBlurAndUpsampleConstants::noiseFilterStrength) },
+	{ "StepSize",				offsetof(AoBlurAndUpsampleConstants, stepSize),				sizeof(AoBlurAndUpsampleConstants::stepSize) },
+	{ "kBlurTolerance",			offsetof(AoBlurAndUpsampleConstants, blurTolerance),		sizeof(AoBlurAndUpsampleConstants::blurTolerance) },
+	{ "kUpsampleTolerance",		offsetof(AoBlurAndUpsampleConstants, upsampleTolerance),	sizeof(AoBlurAndUpsampleConstants::upsampleTolerance) }
+};
+
+
+// AO render permutations.  The high quality pass samples the downsized depth buffer instead of the interleaved tiles.
+constexpr PermutationFeature kAoRenderHighQuality = FirstFeature(1);
+constexpr uint32_t kNumAoRenderPermutations = PermutationCount(kAoRenderHighQuality);
+constexpr uint32_t kAoRenderInterleavedKey = EncodeFeature(kAoRenderHighQuality, false);
+constexpr uint32_t kAoRenderHighQualityKey = EncodeFeature(kAoRenderHighQuality, true);
+
+string GetAoRenderPath(uint32_t key)
+{
+	return DecodeFeature(kAoRenderHighQuality, key) ? "Engine\\AoRender2CS.dx.cso" : "Engine\\AoRender1CS.dx.cso";
+}
+
+
+// Blur and upsample permutations.  BlendOut blends with the higher resolution AO, and PreMin combines the
+// interleaved AO with the high quality AO.
+constexpr PermutationFeature kBlurUpsampleBlendOut = FirstFeature(1);
+constexpr PermutationFeature kBlurUpsamplePreMin = NextFeature(kBlurUpsampleBlendOut, 1);
+constexpr uint32_t kNumBlurUpsamplePermutations = PermutationCount(kBlurUpsamplePreMin);
+
+string GetBlurUpsamplePath(uint32_t key)
+{
+	static const char* s_paths[kNumBlurUpsamplePermutations] =
+	{
+		"Engine\\AoBlurUpsampleCS.dx.cso",
+		"Engine\\AoBlurUpsampleBlendOutCS.dx.cso",
+		"Engine\\AoBlurUpsamplePreMinCS.dx.cso",
+		"Engine\\AoBlurUpsamplePreMinBlendOutCS.dx.cso"
+	};
+	return s_paths[key];
+}
+
+// One instance per level of the depth hierarchy
+const uint32_t kNumHierarchyLevels = 4;
+
+} // anonymous namespace
+
+
 SSAO::SSAO()
 	: Enable(m_enabled)
 	, DebugDraw(m_debugDraw)
@@ -37,6 +119,8 @@ SSAO::SSAO()
 	, SceneColorBuffer(m_sceneColorBuffer)
 	, SceneDepthBuffer(m_sceneDepthBuffer)
 	, LinearDepthBuffer(m_linearDepth)
+	, m_renderCs("AO render", kNumAoRenderPermutations, kNumHierarchyLevels, GetAoRenderPath)
+	, m_blurUpsampleCs("AO blur and upsample", kNumBlurUpsamplePermutations, kNumHierarchyLevels, GetBlurUpsamplePath)
 {}
 
 
@@ -59,18 +143,9 @@ void SSAO::Initialize(uint32_t width, uint32_t height)
 
 	m_depthPrepare1Cs.SetComputeShaderPath("Engine\\AoPrepareDepthBuffers1CS.dx.cso", immediate);
 	m_depthPrepare2Cs.SetComputeShaderPath("Engine\\AoPrepareDepthBuffers2CS.dx.cso", immediate);
-	
-	for (int32_t i = 0; i < 4; ++i)
-	{
-		m_render1Cs[i].SetComputeShaderPath("Engine\\AoRender1CS.dx.cso", immediate);
-		m_render2Cs[i].SetComputeShaderPath("Engine\\AoRender2CS.dx.cso", immediate);
-		
-		m_blurUpsampleBlend[i][0].SetComputeShaderPath("Engine\\AoBlurUpsampleBlendOutCS.dx.cso", immediate);
-		m_blurUpsampleBlend[i][1].SetComputeShaderPath("Engine\\AoBlurUpsamplePreMinBlendOutCS.dx.cso", immediate);
-		
-		m_blurUpsampleFinal[i][0].SetComputeShaderPath("Engine\\AoBlurUpsampleCS.dx.cso", immediate);
-		m_blurUpsampleFinal[i][1].SetComputeShaderPath("Engine\\AoBlurUpsamplePreMinCS.dx.cso", immediate);
-	}
+
+	// Only the render and blur/upsample permutations the current settings use are created
+	RequestPermutations();
 
 	m_linearizeDepthCs.SetComputeShaderPath("Engine\\LinearizeDepthCS.dx.cso", immediate);
 	
@@ -136,12 +211,64 @@ void SSAO::SetCamera(shared_ptr<Camera> camera)
 }
 
 
+template <typename TFunction>
+void SSAO::ForEachPermutation(TFunction function)
+{
+	// Mirrors the passes in Render.  Instance 0 is the coarsest level, which needs a hierarchy depth over 3, and
+	// the finest level always runs.  Each level's high quality pass starts at a higher quality setting.
+	const QualityLevel highQualityLevels[kNumHierarchyLevels] = { kSsaoQualityLow, kSsaoQualityMedium, kSsaoQualityHigh, kSsaoQualityVeryHigh };
+
+	uint32_t blendInstance = 0;
+	for (uint32_t level = 0; level < kNumHierarchyLevels; ++level)
+	{
+		const bool isFinest = (level + 1 == kNumHierarchyLevels);
+		if (!isFinest && m_hierarchyDepth <= static_cast<int32_t>(kNumHierarchyLevels - 1 - level))
+		{
+			continue;
+		}
+
+		const bool highQuality = m_qualityLevel >= highQualityLevels[level];
+
+		function(m_renderCs, kAoRenderInterleavedKey, level);
+		if (highQuality)
+		{
+			function(m_renderCs, kAoRenderHighQualityKey, level);
+		}
+
+		// Every level but the finest blends with the next one up
+		const uint32_t blurUpsampleKey = EncodeFeature(kBlurUpsampleBlendOut, !isFinest) | EncodeFeature(kBlurUpsamplePreMin, highQuality);
+		function(m_blurUpsampleCs, blurUpsampleKey, isFinest ? 0 : blendInstance++);
+	}
+}
+
+
+void SSAO::RequestPermutations()
+{
+	ForEachPermutation([](ComputeKernelPermutations& permutations, uint32_t key, uint32_t instance)
+	{
+		permutations.Request(key, instance);
+	});
+}
+
+
+bool SSAO::ArePermutationsLoaded()
+{
+	bool loaded = true;
+	ForEachPermutation([&loaded](ComputeKernelPermutations& permutations, uint32_t key, uint32_t instance)
+	{
+		loaded = loaded && (permutations.Find(key, instance) != nullptr);
+	});
+	return loaded;
+}
+
+
 void SSAO::Render(GraphicsCommandList& commandList)
 {
 	auto cameraProxy = m_camera->GetProxy();
 	const float zMagic = (cameraProxy->FarClip - cameraProxy->NearClip) / cameraProxy->NearClip;
 	
-	if (!m_enabled)
+	// Settings whose permutations the main thread hasn't created yet get no AO, rather than a load here
+	if (!m_enabled || !ArePermutationsLoaded())
 	{
 		commandList.PIXBeginEvent("Generate SSAO");
 
@@ -270,33 +397,33 @@ void SSAO::Render(GraphicsCommandList& commandList)
 		// Render SSAO for each sub-tile
 		if (m_hierarchyDepth > 3)
 		{
-			ComputeAO(computeCommandList, m_render1Cs[0], m_aoMerged4, m_depthTiled4, fovTangent);
+			ComputeAO(computeCommandList, *m_renderCs.Find(kAoRenderInterleavedKey, 0), m_aoMerged4, m_depthTiled4, fovTangent);
 			if (m_qualityLevel >= kSsaoQualityLow)
 			{
-				ComputeAO(computeCommandList, m_render2Cs[0], m_aoHighQuality4, m_depthDownsize4, fovTangent);
+				ComputeAO(computeCommandList, *m_renderCs.Find(kAoRenderHighQualityKey, 0), m_aoHighQuality4, m_depthDownsize4, fovTangent);
 			}
 		}
 		if (m_hierarchyDepth > 2)
 		{
-			ComputeAO(computeCommandList, m_render1Cs[1], m_aoMerged3, m_depthTiled3, fovTangent);
+			ComputeAO(computeCommandList, *m_renderCs.Find(kAoRenderInterleavedKey, 1), m_aoMerged3, m_depthTiled3, fovTangent);
 			if (m_qualityLevel >= kSsaoQualityMedium)
 			{
-				ComputeAO(computeCommandList, m_render2Cs[1], m_aoHighQuality3, m_depthDownsize3, fovTangent);
+				ComputeAO(computeCommandList, *m_renderCs.Find(kAoRenderHighQualityKey, 1), m_aoHighQuality3, m_depthDownsize3, fovTangent);
 			}
 		}
 		if (m_hierarchyDepth > 1)
 		{
-			ComputeAO(computeCommandList, m_render1Cs[2], m_aoMerged2, m_depthTiled2, fovTangent);
+			ComputeAO(computeCommandList, *m_renderCs.Find(kAoRenderInterleavedKey, 2), m_aoMerged2, m_depthTiled2, fovTangent);
 			if (m_qualityLevel >= kSsaoQualityHigh)
 			{
-				ComputeAO(computeCommandList, m_render2Cs[2], m_aoHighQuality2, m_depthDownsize2, fovTangent);
+				ComputeAO(computeCommandList, *m_renderCs.Find(kAoRenderHighQualityKey, 2), m_aoHighQuality2, m_depthDownsize2, fovTangent);
 			}
 		}
 		{
-			ComputeAO(computeCommandList, m_render1Cs[3], m_aoMerged1, m_depthTiled1, fovTangent);
+			ComputeAO(computeCommandList, *m_renderCs.Find(kAoRenderInterleavedKey, 3), m_aoMerged1, m_depthTiled1, fovTangent);
 			if (m_qualityLevel >= kSsaoQualityVeryHigh)
 			{
-				ComputeAO(computeCommandList, m_render2Cs[3], m_aoHighQuality1, m_depthDownsize1, fovTangent);
+				ComputeAO(computeCommandList, *m_renderCs.Find(kAoRenderHighQualityKey, 3), m_aoHighQuality1, m_depthDownsize1, fovTangent);
 			}
 		}
 
@@ -471,15 +598,11 @@ void SSAO::ComputeAO(ComputeCommandList& commandList, ComputeKernel& kernel, Col
 	ssaoCB[26] = 1.0f / -m_rejectionFalloff;
 	ssaoCB[27] = 1.0f / (1.0f + m_accentuation);
 
-	kernel.GetParameter("gInvThicknessTable")->SetValueImmediate(Vector4(ssaoCB[0], ssaoCB[1], ssaoCB[2], ssaoCB[3]), 0);
-	kernel.GetParameter("gInvThicknessTable")->SetValueImmediate(Vector4(ssaoCB[4], ssaoCB[5], ssaoCB[6], ssaoCB[7]), 1);
-	kernel.GetParameter("gInvThicknessTable")->SetValueImmediate(Vector4(ssaoCB[8], ssaoCB[9], ssaoCB[10], ssaoCB[11]), 2);
-	kernel.GetParameter("gSampleWeightTable")->SetValueImmediate(Vector4(ssaoCB[12], ssaoCB[13], ssaoCB[14], ssaoCB[15]), 0);
-	kernel.GetParameter("gSampleWeightTable")->SetValueImmediate(Vector4(ssaoCB[16], ssaoCB[17], ssaoCB[18], ssaoCB[19]), 1);
-	kernel.GetParameter("gSampleWeightTable")->SetValueImmediate(Vector4(ssaoCB[20], ssaoCB[21], ssaoCB[22], ssaoCB[23]), 2);
-	kernel.GetParameter("gInvSliceDimension")->SetValueImmediate(XMFLOAT2(ssaoCB[24], ssaoCB[25]));
-	kernel.GetParameter("gRejectFadeoff")->SetValueImmediate(ssaoCB[26]);
-	kernel.GetParameter("gRcpAccentuation")->SetValueImmediate(ssaoCB[27]);
+	// ssaoCB is laid out like the cbuffer
+	static_assert(sizeof(AoRenderConstants) == sizeof(ssaoCB), "AoRenderConstants doesn't match ssaoCB");
+	AoRenderConstants constants;
+	memcpy(&constants, ssaoCB, sizeof(constants));
+	kernel.GetConstantBuffer("ConstantBuffer")->SetConstantsImmediate(constants, s_aoRenderMembers);
 
 	kernel.GetResource("DepthTex")->SetSRVImmediate(depthBuffer);
 	kernel.GetResource("Occlusion")->SetUAVImmediate(destination);
@@ -510,21 +633,23 @@ void SSAO::BlurAndUpsample(ComputeCommandList& commandList,
 	uint32_t hiWidth = hiResDepth.GetWidth();
 	uint32_t hiHeight = hiResDepth.GetHeight();
 
-	auto& kernel = (hiResAO == nullptr) ? 
-		m_blurUpsampleFinal[m_currentBlurUpsampleFinal++][highQualityAO == nullptr ? 0 : 1] :
-		m_blurUpsampleBlend[m_currentBlurUpsampleBlend++][highQualityAO == nullptr ? 0 : 1];
+	const uint32_t key = EncodeFeature(kBlurUpsampleBlendOut, hiResAO != nullptr) | EncodeFeature(kBlurUpsamplePreMin, highQualityAO != nullptr);
+	const uint32_t instance = (hiResAO == nullptr) ? m_currentBlurUpsampleFinal++ : m_currentBlurUpsampleBlend++;
+	auto& kernel = *m_blurUpsampleCs.Find(key, instance);
 
 	float blurTolerance = 1.0f - powf(10.0f, m_blurTolerance) * 1920.0f / (float)loWidth;
 	blurTolerance *= blurTolerance;
 	float upsampleTolerance = powf(10.0f, m_upsampleTolerance);
 	float noiseFilterWeight = 1.0f / (powf(10.0f, m_noiseFilterTolerance) + upsampleTolerance);
 
-	kernel.GetParameter("InvLowResolution")->SetValueImmediate(XMFLOAT2(1.0f / loWidth, 1.0f / loHeight));
-	kernel.GetParameter("InvHighResolution")->SetValueImmediate(XMFLOAT2(1.0f / hiWidth, 1.0f / hiHeight));
-	kernel.GetParameter("NoiseFilterStrength")->SetValueImmediate(noiseFilterWeight);
-	kernel.GetParameter("StepSize")->SetValueImmediate(1920.0f / (float)loWidth);
-	kernel.GetParameter("kBlurTolerance")->SetValueImmediate(blurTolerance);
-	kernel.GetParameter("kUpsampleTolerance")->SetValueImmediate(upsampleTolerance);
+	AoBlurAndUpsampleConstants constants;
+	constants.invLowResolution = XMFLOAT2(1.0f / loWidth, 1.0f / loHeight);
+	constants.invHighResolution = XMFLOAT2(1.0f / hiWidth, 1.0f / hiHeight);
+	constants.noiseFilterStrength = noiseFilterWeight;
+	constants.stepSize = 1920.0f / (float)loWidth;
+	constants.blurTolerance = blurTolerance;
+	constants.upsampleTolerance = upsampleTolerance;
+	kernel.GetConstantBuffer("ConstantBuffer")->SetConstantsImmediate(constants, s_aoBlurAndUpsampleMembers);
 
 	commandList.TransitionResource(destination, ResourceState::UnorderedAccess);
 	commandList.TransitionResource(loResDepth, ResourceState::NonPixelShaderResource);
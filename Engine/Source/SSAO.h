@@ -11,7 +11,7 @@
 #pragma once
 
 #include "ColorBuffer.h"
-#include "ComputeKernel.h"
+#include "ComputeKernelPermutations.h"
 #include "RenderThread.h"
 
 namespace Kodiak
@@ -49,6 +49,15 @@ public:
 	void Render(GraphicsCommandList& commandList);
 
 private:
+	// Calls function(permutations, key, instance) for each render and blur/upsample kernel Render uses at the
+	// current quality level and hierarchy depth
+	template <typename TFunction>
+	void ForEachPermutation(TFunction function);
+
+	// Creates the kernels for the current settings.  Main thread; call it again whenever the settings change.
+	void RequestPermutations();
+	bool ArePermutationsLoaded();
+
 	void ComputeAO(ComputeCommandList& commandList, ComputeKernel& kernel, ColorBuffer& destination,
 		ColorBuffer& depthBuffer, const float tanHalfFovH);
 
@@ -60,10 +69,8 @@ private:
 	// Compute shader kernels
 	ComputeKernel	m_depthPrepare1Cs;
 	ComputeKernel	m_depthPrepare2Cs;
-	ComputeKernel	m_render1Cs[4];
-	ComputeKernel	m_render2Cs[4];
-	ComputeKernel	m_blurUpsampleBlend[4][2];
-	ComputeKernel	m_blurUpsampleFinal[4][2];
+	ComputeKernelPermutations	m_renderCs;
+	ComputeKernelPermutations	m_blurUpsampleCs;
 	ComputeKernel	m_linearizeDepthCs;
 	ComputeKernel	m_debugSsaoCs;
 	uint32_t		m_currentBlurUpsampleBlend{ 0 };
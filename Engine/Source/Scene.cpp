@@ -43,6 +43,46 @@ using namespace Math;
 using namespace RenderThread;
 
 
+namespace
+{
+
+// Models share the GeometryPool's buffers, so consecutive parts usually draw from the same VB/IB.  Only
+// bind what changed since the last draw in the pass.
+class GeometryBindings
+{
+public:
+	void Bind(GraphicsCommandList& commandList, const StaticMeshPartData& meshPart)
+	{
+		if (meshPart.vertexBuffer.get() != m_vertexBuffer)
+		{
+			commandList.SetVertexBuffer(0, *meshPart.vertexBuffer);
+			m_vertexBuffer = meshPart.vertexBuffer.get();
+		}
+
+		if (meshPart.indexBuffer.get() != m_indexBuffer)
+		{
+			commandList.SetIndexBuffer(*meshPart.indexBuffer);
+			m_indexBuffer = meshPart.indexBuffer.get();
+		}
+
+		if (!m_hasTopology || meshPart.topology != m_topology)
+		{
+			commandList.SetPrimitiveTopology((D3D_PRIMITIVE_TOPOLOGY)meshPart.topology);
+			m_topology = meshPart.topology;
+			m_hasTopology = true;
+		}
+	}
+
+private:
+	const VertexBuffer*	m_vertexBuffer{ nullptr };
+	const IndexBuffer*	m_indexBuffer{ nullptr };
+	PrimitiveTopology	m_topology;
+	bool				m_hasTopology{ false };
+};
+
+} // anonymous namespace
+
+
 Scene::Scene()
 #if DX11
 	: SsaoFullscreen(m_ssaoFullscreen)
@@ -64,6 +104,13 @@ void Scene::AddStaticModel(shared_ptr<StaticModel> model)
 }
 
 
+void Scene::CullMeshlets()
+{
+	auto cameraProxy = m_camera->GetProxy();
+	CullMeshletsForView(cameraProxy->Base.ViewProjMatrix, cameraProxy->Base.Position);
+}
+
+
 void Scene::Update(GraphicsCommandList& commandList)
 {
 	PROFILE_BEGIN(itt_scene_update);
@@ -108,6 +155,8 @@ void Scene::Render(shared_ptr<RenderPass> renderPass, GraphicsCommandList& comma
 	commandList.PIXEndEvent();
 
 	commandList.PIXBeginEvent(renderPass->GetName());
+	GeometryBindings bindings;
+
 	// Visit models
 	for (auto& model : m_staticModels)
 	{
@@ -115,11 +164,18 @@ void Scene::Render(shared_ptr<RenderPass> renderPass, GraphicsCommandList& comma
 		// Visit meshes
 		for (const auto& mesh : model->meshes)
 		{
+			// Every meshlet was culled
+			if (mesh->meshlets && mesh->visibleRanges.empty())
+			{
+				continue;
+			}
+
 			PROFILE_BEGIN(itt_draw_mesh);
 			// Visit mesh parts
 			for (const auto& meshPart : mesh->meshParts)
 			{
-				if (meshPart.material->renderPass == renderPass && meshPart.material->IsReady())
+				if (meshPart.material->GetRenderPass() == renderPass && meshPart.material->IsPipelineReady() &&
+					(model->isResident || meshPart.material->IsReady()))
 				{
 					meshPart.material->Commit(commandList);
 
@@ -142,11 +198,19 @@ void Scene::Render(shared_ptr<RenderPass> renderPass, GraphicsCommandList& comma
 					}
 #endif
 					
-					commandList.SetVertexBuffer(0, *meshPart.vertexBuffer);
-					commandList.SetIndexBuffer(*meshPart.indexBuffer);
-					commandList.SetPrimitiveTopology((D3D_PRIMITIVE_TOPOLOGY)meshPart.topology);
+					bindings.Bind(commandList, meshPart);
 
-					commandList.DrawIndexed(meshPart.indexCount, meshPart.startIndex, meshPart.baseVertexOffset);
+					if (mesh->meshlets)
+					{
+						for (const auto& range : mesh->visibleRanges)
+						{
+							commandList.DrawIndexed(range.indexCount, meshPart.startIndex + range.startIndex, meshPart.baseVertexOffset);
+						}
+					}
+					else
+					{
+						commandList.DrawIndexed(meshPart.indexCount, meshPart.startIndex, meshPart.baseVertexOffset);
+					}
 				}
 			}
 			PROFILE_END();
@@ -181,6 +245,8 @@ void Scene::RenderShadows(shared_ptr<RenderPass> renderPass, GraphicsCommandList
 	commandList.PIXEndEvent();
 
 	commandList.PIXBeginEvent(renderPass->GetName());
+	GeometryBindings bindings;
+
 	// Visit models
 	for (auto& model : m_staticModels)
 	{
@@ -192,7 +258,8 @@ void Scene::RenderShadows(shared_ptr<RenderPass> renderPass, GraphicsCommandList
 			// Visit mesh parts
 			for (const auto& meshPart : mesh->meshParts)
 			{
-				if (meshPart.material->renderPass == renderPass && meshPart.material->IsReady())
+				if (meshPart.material->GetRenderPass() == renderPass && meshPart.material->IsPipelineReady() &&
+					(model->isResident || meshPart.material->IsReady()))
 				{
 					meshPart.material->Commit(commandList);
 
@@ -206,9 +273,7 @@ void Scene::RenderShadows(shared_ptr<RenderPass> renderPass, GraphicsCommandList
 					commandList.SetPixelShaderResource(3, m_ssaoFullscreen->GetSRV());
 #endif
 
-					commandList.SetVertexBuffer(0, *meshPart.vertexBuffer);
-					commandList.SetIndexBuffer(*meshPart.indexBuffer);
-					commandList.SetPrimitiveTopology((D3D_PRIMITIVE_TOPOLOGY)meshPart.topology);
+					bindings.Bind(commandList, meshPart);
 
 					commandList.DrawIndexed(meshPart.indexCount, meshPart.startIndex, meshPart.baseVertexOffset);
 				}
@@ -228,6 +293,25 @@ void Scene::RenderShadows(shared_ptr<RenderPass> renderPass, GraphicsCommandList
 }
 
 
+void Scene::LogMeshletCullStats() const
+{
+	const auto& stats = m_meshletCullStats;
+	if (m_meshletCullViews == 0 || stats.triangleCount == 0)
+	{
+		return;
+	}
+
+	const auto views = m_meshletCullViews;
+	const auto culledTriangles = stats.frustumCulledTriangles + stats.backfaceCulledTriangles;
+
+	LOG_INFO << "Meshlet culling over " << views << " views: " << (stats.triangleCount / views) << " triangles in "
+		<< (stats.meshletCount / views) << " meshlets per view, " << (culledTriangles / views) << " culled ("
+		<< (100 * culledTriangles / stats.triangleCount) << "%), " << (stats.frustumCulledTriangles / views)
+		<< " by the frustum and " << (stats.backfaceCulledTriangles / views) << " as backfacing, drawn in "
+		<< (stats.rangeCount / views) << " index ranges";
+}
+
+
 void Scene::SetCamera(shared_ptr<Kodiak::Camera> camera)
 {
 	auto thisScene = shared_from_this();
@@ -274,6 +358,46 @@ void Scene::Initialize()
 }
 
 
+void Scene::CullMeshletsForView(const Matrix4& viewProjection, const Vector3& viewPosition)
+{
+	MeshletCullStats viewStats;
+
+	for (auto& model : m_staticModels)
+	{
+		for (const auto& mesh : model->meshes)
+		{
+			if (!mesh->meshlets)
+			{
+				continue;
+			}
+
+			// Cull in the mesh's own space, where the meshlet bounds are
+			const Matrix4 objectToWorld = model->matrix * mesh->matrix;
+
+			DirectX::XMFLOAT4X4 objectToClip;
+			DirectX::XMStoreFloat4x4(&objectToClip, viewProjection * objectToWorld);
+
+			DirectX::XMFLOAT3 cameraPosition;
+			DirectX::XMStoreFloat3(&cameraPosition, Invert(objectToWorld) * viewPosition);
+
+			auto view = MakeMeshletCullView(objectToClip.m, &cameraPosition.x);
+
+			// Mirroring transforms flip the winding, and with it which side of the normal cone is the back
+			view.backfaceCulling = DirectX::XMVectorGetX(DirectX::XMMatrixDeterminant(objectToWorld)) > 0.0f;
+
+			mesh->visibleRanges.clear();
+			Kodiak::CullMeshlets(mesh->meshlets->data(), mesh->meshlets->size(), view, mesh->visibleRanges, &viewStats);
+		}
+	}
+
+	if (viewStats.meshletCount > 0)
+	{
+		AccumulateMeshletCullStats(m_meshletCullStats, viewStats);
+		++m_meshletCullViews;
+	}
+}
+
+
 void Scene::SetCameraDeferred(shared_ptr<Kodiak::Camera> camera)
 {
 	// TODO: Not threadsafe!!!
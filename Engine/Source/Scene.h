@@ -10,6 +10,7 @@
 #pragma once
 
 #include <concurrent_queue.h>
+#include "Meshlet.h"
 #include "RenderThread.h"
 
 namespace Kodiak
@@ -45,6 +46,11 @@ public:
 
 	void AddStaticModel(std::shared_ptr<StaticModel> model);
 
+	// Culls meshlets against the scene camera, leaving each mesh's visible index ranges for Render.  Call once
+	// per frame on the render thread, before the passes that draw the camera's view.
+	void CullMeshlets();
+
+	// Uploads per-view and per-object constants.  Call on each command list that renders the scene.
 	void Update(GraphicsCommandList& commandList);
 	void Render(std::shared_ptr<RenderPass> renderPass, GraphicsCommandList& commandList);
 
@@ -65,6 +71,10 @@ public:
 	// TODO: Super-hacky way to ram sampler states into the engine
 	void BindSamplerStates(GraphicsCommandList& commandList);
 
+	// Logs triangles culled per view by meshlet culling, averaged over every CullMeshlets so far.  Call from
+	// the render thread, or once it has stopped.
+	void LogMeshletCullStats() const;
+
 #if DX11
 	ThreadParameter<std::shared_ptr<ColorBuffer>> SsaoFullscreen;
 #endif
@@ -72,6 +82,9 @@ public:
 private:
 	void Initialize();
 
+	// Culls the meshlets of every mesh that has them, leaving each mesh's visible index ranges
+	void CullMeshletsForView(const Math::Matrix4& viewProjection, const Math::Vector3& viewPosition);
+
 private:
 	std::shared_ptr<ConstantBuffer>		m_perViewConstantBuffer;
 	std::shared_ptr<GraphicsPSO>		m_pso;
@@ -107,6 +120,10 @@ private:
 	std::map<std::shared_ptr<RenderThread::StaticModelData>, size_t>	m_staticModelMap;
 	// Main list of static models for culling and rendering
 	std::vector<std::shared_ptr<RenderThread::StaticModelData>>			m_staticModels;
+
+	// Meshlet culling totals, over m_meshletCullViews views
+	MeshletCullStats	m_meshletCullStats;
+	uint64_t			m_meshletCullViews{ 0 };
 };
 
 
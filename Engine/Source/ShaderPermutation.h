@@ -0,0 +1,71 @@
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+// Author: David Elder
+//
+
+#pragma once
+
+// Shader permutations are identified by a key that packs the value of each feature into its own run of bits.
+// Features are declared as constexpr values, each one starting where the previous one ends:
+//
+//   constexpr PermutationFeature kHighQuality = FirstFeature(1);
+//   constexpr PermutationFeature kFilterMode = NextFeature(kHighQuality, 2);
+//   constexpr uint32_t kNumPermutations = PermutationCount(kFilterMode);
+//
+//   const uint32_t key = EncodeFeature(kHighQuality, true) | EncodeFeature(kFilterMode, 3);
+//
+// Values that don't fit in a feature's bits are masked off.  This header only depends on the standard library.
+
+#include <cstdint>
+
+namespace Kodiak
+{
+
+struct PermutationFeature
+{
+	uint32_t offset;
+	uint32_t bits;
+};
+
+
+constexpr PermutationFeature FirstFeature(uint32_t bits)
+{
+	return PermutationFeature{ 0, bits };
+}
+
+
+constexpr PermutationFeature NextFeature(PermutationFeature previous, uint32_t bits)
+{
+	return PermutationFeature{ previous.offset + previous.bits, bits };
+}
+
+
+constexpr uint32_t FeatureMask(PermutationFeature feature)
+{
+	return ((1u << feature.bits) - 1) << feature.offset;
+}
+
+
+constexpr uint32_t EncodeFeature(PermutationFeature feature, uint32_t value)
+{
+	return (value << feature.offset) & FeatureMask(feature);
+}
+
+
+constexpr uint32_t DecodeFeature(PermutationFeature feature, uint32_t key)
+{
+	return (key & FeatureMask(feature)) >> feature.offset;
+}
+
+
+// Number of keys covered by every feature up to and including lastFeature
+constexpr uint32_t PermutationCount(PermutationFeature lastFeature)
+{
+	return 1u << (lastFeature.offset + lastFeature.bits);
+}
+
+} // namespace Kodiak
\ No newline at end of file
@@ -14,12 +14,85 @@
 #include "Material.h"
 #include "RenderEnums.h"
 #include "RenderUtils.h"
+#include "VertexFormats.h"
 
 
 using namespace Kodiak;
 using namespace std;
 
 
+namespace
+{
+
+DXGI_FORMAT GetSignatureFormat(BYTE mask, D3D_REGISTER_COMPONENT_TYPE componentType)
+{
+	if (mask == 1)
+	{
+		if (componentType == D3D_REGISTER_COMPONENT_UINT32)
+		{
+			return DXGI_FORMAT_R32_UINT;
+		}
+		else if (componentType == D3D_REGISTER_COMPONENT_SINT32)
+		{
+			return DXGI_FORMAT_R32_SINT;
+		}
+		else if (componentType == D3D_REGISTER_COMPONENT_FLOAT32)
+		{
+			return DXGI_FORMAT_R32_FLOAT;
+		}
+	}
+	else if (mask <= 3)
+	{
+		if (componentType == D3D_REGISTER_COMPONENT_UINT32)
+		{
+			return DXGI_FORMAT_R32G32_UINT;
+		}
+		else if (componentType == D3D_REGISTER_COMPONENT_SINT32)
+		{
+			return DXGI_FORMAT_R32G32_SINT;
+		}
+		else if (componentType == D3D_REGISTER_COMPONENT_FLOAT32)
+		{
+			return DXGI_FORMAT_R32G32_FLOAT;
+		}
+	}
+	else if (mask <= 7)
+	{
+		if (componentType == D3D_REGISTER_COMPONENT_UINT32)
+		{
+			return DXGI_FORMAT_R32G32B32_UINT;
+		}
+		else if (componentType == D3D_REGISTER_COMPONENT_SINT32)
+		{
+			return DXGI_FORMAT_R32G32B32_SINT;
+		}
+		else if (componentType == D3D_REGISTER_COMPONENT_FLOAT32)
+		{
+			return DXGI_FORMAT_R32G32B32_FLOAT;
+		}
+	}
+	else if (mask <= 15)
+	{
+		if (componentType == D3D_REGISTER_COMPONENT_UINT32)
+		{
+			return DXGI_FORMAT_R32G32B32A32_UINT;
+		}
+		else if (componentType == D3D_REGISTER_COMPONENT_SINT32)
+		{
+			return DXGI_FORMAT_R32G32B32A32_SINT;
+		}
+		else if (componentType == D3D_REGISTER_COMPONENT_FLOAT32)
+		{
+			return DXGI_FORMAT_R32G32B32A32_FLOAT;
+		}
+	}
+
+	return DXGI_FORMAT_UNKNOWN;
+}
+
+} // anonymous namespace
+
+
 namespace ShaderReflection
 {
 
@@ -184,6 +257,18 @@ void IntrospectCBuffer(ID3DShaderReflection* reflector, const D3D_SHADER_INPUT_B
 
 void IntrospectResourceSRV(ShaderResourceType type, const D3D_SHADER_INPUT_BIND_DESC& inputDesc, Signature& signature)
 {
+#if defined(DX12)
+	// The bindless texture array is indexed through material constants, so it isn't a material resource
+	if (inputDesc.Space == GetBindlessTextureSpace())
+	{
+		assert(signature.bindlessSrvRegister == kInvalid);
+		signature.bindlessSrvRegister = inputDesc.BindPoint;
+
+		++signature.numDescriptors;
+		return;
+	}
+#endif
+
 	ShaderReflection::ResourceSRV<1> resourceSRV;
 	resourceSRV.name = inputDesc.Name;
 	resourceSRV.type = type;
@@ -223,36 +308,6 @@ void IntrospectSampler(const D3D_SHADER_INPUT_BIND_DESC& inputDesc, Signature& s
 }
 
 
-void ResetSignature(Signature& signature)
-{
-	// Reset per-view and per-object CBV bindings
-	signature.cbvPerViewData.byteOffset = kInvalid;
-	signature.cbvPerViewData.sizeInBytes = kInvalid;
-	signature.cbvPerViewData.shaderRegister = kInvalid;
-
-	signature.cbvPerObjectData.byteOffset = kInvalid;
-	signature.cbvPerObjectData.sizeInBytes = kInvalid;
-	signature.cbvPerObjectData.shaderRegister = kInvalid;
-
-	// Clear tables
-	signature.cbvTable.clear();
-	signature.srvTable.clear();
-	signature.uavTable.clear();
-	signature.samplerTable.clear();
-
-	// Clear parameters
-	signature.parameters.clear();
-	signature.resources.clear();
-	signature.uavs.clear();
-	signature.samplers.clear();
-
-	// Reset additional data
-	signature.numDescriptors = 0;
-	signature.numMaterialDescriptors = 0;
-	signature.numSamplers = 0;
-}
-
-
 void Introspect(ID3DShaderReflection* reflector, Signature& signature)
 {
 	ResetSignature(signature);
@@ -473,4 +528,86 @@ void Introspect(ID3DShaderReflection* reflector, Signature& signature)
 	}
 }
 
+
+void IntrospectInputs(ID3DShaderReflection* reflector, vector<InputElement>& inputElements)
+{
+	inputElements.clear();
+
+	D3D_SHADER_DESC shaderDesc;
+	reflector->GetDesc(&shaderDesc);
+
+	inputElements.reserve(shaderDesc.InputParameters);
+
+	for (uint32_t i = 0; i < shaderDesc.InputParameters; ++i)
+	{
+		D3D_SIGNATURE_PARAMETER_DESC paramDesc;
+		reflector->GetInputParameterDesc(i, &paramDesc);
+
+		// Skip certain system value semantics
+		string upper = paramDesc.SemanticName;
+		transform(begin(upper), end(upper), begin(upper), ::toupper);
+
+		if (upper == "SV_INSTANCEID" || upper == "SV_VERTEXID" || upper == "SV_PRIMITIVEID")
+		{
+			continue;
+		}
+
+		InputElement element;
+		element.semanticName = paramDesc.SemanticName;
+		element.semanticIndex = paramDesc.SemanticIndex;
+
+		// Quantized attributes are narrower than the 32-bit types in the signature
+		DXGI_FORMAT format = GetQuantizedVertexFormat(upper);
+		if (format == DXGI_FORMAT_UNKNOWN)
+		{
+			format = GetSignatureFormat(paramDesc.Mask, paramDesc.ComponentType);
+		}
+		element.format = static_cast<uint32_t>(format);
+
+		inputElements.push_back(element);
+	}
+}
+
+
+
+bool ValidateConstantLayout(const string& cbufferName, size_t cbufferSize, const vector<CBVMember>& reflectedMembers,
+	size_t structSize, const ConstantStructMember* members, size_t numMembers)
+{
+	if (structSize > cbufferSize)
+	{
+		LOG_ERROR << "Constants for cbuffer " << cbufferName << " are " << structSize << " bytes, the cbuffer is only "
+			<< cbufferSize;
+		return false;
+	}
+
+	for (const auto& reflected : reflectedMembers)
+	{
+		const ConstantStructMember* member = nullptr;
+		for (size_t i = 0; i < numMembers; ++i)
+		{
+			if (reflected.name == members[i].name)
+			{
+				member = &members[i];
+				break;
+			}
+		}
+
+		if (member == nullptr)
+		{
+			LOG_ERROR << "Constants for cbuffer " << cbufferName << " are missing " << reflected.name;
+			return false;
+		}
+
+		if (member->byteOffset != reflected.byteOffset || member->sizeInBytes != reflected.sizeInBytes)
+		{
+			LOG_ERROR << "Constants for cbuffer " << cbufferName << " have " << reflected.name << " at offset "
+				<< member->byteOffset << " (" << member->sizeInBytes << " bytes), the shader has it at offset "
+				<< reflected.byteOffset << " (" << reflected.sizeInBytes << " bytes)";
+			return false;
+		}
+	}
+
+	return true;
+}
+
 } // namespace Kodiak
\ No newline at end of file
@@ -9,38 +9,26 @@
 
 #pragma once
 
-// Forward declarations
-namespace Kodiak
-{
-enum class ShaderResourceDimension;
-enum class ShaderResourceType;
-enum class ShaderVariableType;
-}
+#include "ShaderSignature.h"
 
 namespace ShaderReflection
 {
 
-struct TableLayout
-{
-	uint32_t		shaderRegister{ kInvalid };
-	uint32_t		numItems{ kInvalid };
-};
-
-
-struct TableEntry
+// A variable in a cbuffer, byteOffset is from the start of the cbuffer
+struct CBVMember
 {
-	uint32_t		tableIndex{ kInvalid };
-	uint32_t		tableSlot{ kInvalid };
+	std::string		name;
+	uint32_t		byteOffset{ kInvalid };
+	uint32_t		sizeInBytes{ 0 };
 };
 
 
-struct CBVLayout
+// A member of a C++ struct that mirrors a cbuffer, byteOffset is from the start of the struct
+struct ConstantStructMember
 {
-	std::string		name;
-	uint32_t		byteOffset{ kInvalid };		// offset from start of large cbuffer (16-byte aligned)
-	uint32_t		sizeInBytes{ kInvalid };    // cbuffer size in bytes (multiple of 16)
-	uint32_t		shaderRegister{ kInvalid };
-	TableEntry		binding;
+	const char*		name;
+	size_t			byteOffset;
+	size_t			sizeInBytes;
 };
 
 
@@ -60,194 +48,6 @@ struct DescriptorRange
 };
 
 
-struct BaseParameter
-{
-	BaseParameter() = default;
-	BaseParameter(const BaseParameter& other) : name(other.name), type(other.type), sizeInBytes(other.sizeInBytes), numElements(other.numElements) {}
-
-	std::string							name;
-	Kodiak::ShaderVariableType			type;
-	uint32_t							sizeInBytes{ 0 };
-	uint32_t							numElements{ 0 };
-};
-
-
-template <uint32_t SlotCount = 1>
-struct Parameter : public BaseParameter
-{
-	Parameter()
-	{
-		cbvShaderRegister.fill(kInvalid);
-		byteOffset.fill(kInvalid);
-	}
-
-	Parameter(uint32_t slot, const Parameter<1>& other) : BaseParameter(other)
-	{
-		cbvShaderRegister.fill(kInvalid);
-		byteOffset.fill(kInvalid);
-
-		assert(slot < SlotCount);
-		cbvShaderRegister[slot] = other.cbvShaderRegister[0];
-		byteOffset[slot] = other.byteOffset[0];
-	}
-
-	void Assign(uint32_t slot, const Parameter<1>& other)
-	{
-		assert(slot < SlotCount);
-		assert(type == other.type);
-		assert(sizeInBytes == other.sizeInBytes);
-		assert(numElements == other.numElements);
-		cbvShaderRegister[slot] = other.cbvShaderRegister[0];
-		byteOffset[slot] = other.byteOffset[0];
-	}
-
-	std::array<uint32_t, SlotCount>		cbvShaderRegister;
-	std::array<uint32_t, SlotCount>		byteOffset;
-};
-
-
-struct BaseResourceSRV
-{
-	BaseResourceSRV() = default;
-	BaseResourceSRV(const BaseResourceSRV& other) : name(other.name), type(other.type), dimension(other.dimension) {}
-
-	std::string							name;
-	Kodiak::ShaderResourceType			type;
-	Kodiak::ShaderResourceDimension		dimension;
-};
-
-
-template <uint32_t SlotCount = 1>
-struct ResourceSRV : public BaseResourceSRV
-{
-	ResourceSRV()
-	{
-		shaderRegister.fill(kInvalid);
-	}
-
-	ResourceSRV(uint32_t slot, const ResourceSRV<1>& other) : BaseResourceSRV(other)
-	{
-		shaderRegister.fill(kInvalid);
-
-		assert(slot < SlotCount);
-		binding[slot] = other.binding[0];
-		shaderRegister[slot] = other.shaderRegister[0];
-	}
-
-	void Assign(uint32_t slot, const ResourceSRV<1>& other)
-	{
-		assert(slot < SlotCount);
-		assert(type == other.type);
-		assert(dimension == other.dimension);
-		binding[slot] = other.binding[0];
-		shaderRegister[slot] = other.shaderRegister[0];
-	}
-
-	std::array<TableEntry, SlotCount>	binding;
-	std::array<uint32_t, SlotCount>		shaderRegister;
-};
-
-
-struct BaseResourceUAV
-{
-	BaseResourceUAV() = default;
-	BaseResourceUAV(const BaseResourceUAV& other) : name(other.name), type(other.type) {}
-
-	std::string							name;
-	Kodiak::ShaderResourceType			type;
-};
-
-
-template <uint32_t SlotCount = 1>
-struct ResourceUAV : public BaseResourceUAV
-{
-	ResourceUAV()
-	{
-		shaderRegister.fill(kInvalid);
-	}
-
-	ResourceUAV(uint32_t slot, const ResourceUAV<1>& other) : BaseResourceUAV(other)
-	{
-		shaderRegister.fill(kInvalid);
-
-		assert(slot < SlotCount);
-		binding[slot] = other.binding[0];
-		shaderRegister[slot] = other.shaderRegister[0];
-	}
-
-	void Assign(uint32_t slot, const ResourceUAV<1>& other)
-	{
-		assert(slot < SlotCount);
-		assert(type == other.type);
-		binding[slot] = other.binding[0];
-		shaderRegister[slot] = other.shaderRegister[0];
-	}
-
-	std::array<TableEntry, SlotCount>	binding;
-	std::array<uint32_t, SlotCount>		shaderRegister;
-};
-
-
-struct BaseSampler
-{
-	BaseSampler() = default;
-	BaseSampler(const BaseSampler& other) : name(other.name) {}
-	std::string							name;
-};
-
-template <uint32_t SlotCount = 1>
-struct Sampler : public BaseSampler
-{
-	Sampler()
-	{
-		shaderRegister.fill(kInvalid);
-	}
-
-	Sampler(uint32_t slot, const Sampler<1>& other) : BaseSampler(other)
-	{
-		shaderRegister.fill(kInvalid);
-
-		assert(slot < SlotCount);
-		binding[slot] = other.binding[0];
-		shaderRegister[slot] = other.shaderRegister[0];
-	}
-
-	void Assign(uint32_t slot, const Sampler<1>& other)
-	{
-		assert(slot < SlotCount);
-		binding[slot] = other.binding[0];
-		shaderRegister[slot] = other.shaderRegister[0];
-	}
-
-	std::array<TableEntry, SlotCount>	binding;
-	std::array<uint32_t, SlotCount>		shaderRegister;
-};
-
-
-// Signature of a single shader
-struct Signature
-{
-	// DX API inputs
-	ShaderReflection::CBVLayout						cbvPerViewData;
-	ShaderReflection::CBVLayout						cbvPerObjectData;
-	std::vector<ShaderReflection::CBVLayout>		cbvTable;
-	std::vector<ShaderReflection::TableLayout>		srvTable;
-	std::vector<ShaderReflection::TableLayout>		uavTable;
-	std::vector<ShaderReflection::TableLayout>		samplerTable;
-
-	// Application inputs
-	std::vector<ShaderReflection::Parameter<1>>		parameters;
-	std::vector<ShaderReflection::ResourceSRV<1>>	resources;
-	std::vector<ShaderReflection::ResourceUAV<1>>	uavs;
-	std::vector<ShaderReflection::Sampler<1>>		samplers;
-
-	// Additional data
-	uint32_t										numDescriptors{ 0 };
-	uint32_t										numMaterialDescriptors{ 0 };
-	uint32_t										numSamplers{ 0 };
-};
-
-
 //
 // Utility functions
 //
@@ -262,6 +62,7 @@ using D3D_SHADER_VARIABLE_DESC		= D3D11_SHADER_VARIABLE_DESC;
 using D3D_SHADER_TYPE_DESC			= D3D11_SHADER_TYPE_DESC;
 using D3D_SHADER_TYPE_DESC			= D3D11_SHADER_TYPE_DESC;
 using D3D_SHADER_DESC				= D3D11_SHADER_DESC;
+using D3D_SIGNATURE_PARAMETER_DESC	= D3D11_SIGNATURE_PARAMETER_DESC;
 #elif defined(DX12)
 using ID3DShaderReflection			= ID3D12ShaderReflection;
 using D3D_SHADER_INPUT_BIND_DESC	= D3D12_SHADER_INPUT_BIND_DESC;
@@ -269,6 +70,7 @@ using D3D_SHADER_BUFFER_DESC		= D3D12_SHADER_BUFFER_DESC;
 using D3D_SHADER_VARIABLE_DESC		= D3D12_SHADER_VARIABLE_DESC;
 using D3D_SHADER_TYPE_DESC			= D3D12_SHADER_TYPE_DESC;
 using D3D_SHADER_DESC				= D3D12_SHADER_DESC;
+using D3D_SIGNATURE_PARAMETER_DESC	= D3D12_SIGNATURE_PARAMETER_DESC;
 #else
 #error Not using DirectX!
 #endif
@@ -277,8 +79,13 @@ void IntrospectCBuffer(ID3DShaderReflection* reflector, const D3D_SHADER_INPUT_B
 void IntrospectResourceSRV(Kodiak::ShaderResourceType type, const D3D_SHADER_INPUT_BIND_DESC& inputDesc, Signature& signature);
 void IntrospectResourceUAV(Kodiak::ShaderResourceType type, const D3D_SHADER_INPUT_BIND_DESC& inputDesc, Signature& signature);
 void IntrospectSampler(const D3D_SHADER_INPUT_BIND_DESC& inputDesc, Signature& signature);
-void ResetSignature(Signature& signature);
 
 void Introspect(ID3DShaderReflection* reflector, Signature& signature);
+void IntrospectInputs(ID3DShaderReflection* reflector, std::vector<InputElement>& inputElements);
+
+// True if every reflected member of the cbuffer is in the struct at the same offset and size, and the struct
+// fits in the cbuffer.  Struct members the shader doesn't declare are allowed.  Logs the first mismatch.
+bool ValidateConstantLayout(const std::string& cbufferName, size_t cbufferSize, const std::vector<CBVMember>& reflectedMembers,
+	size_t structSize, const ConstantStructMember* members, size_t numMembers);
 
 } // namespace ShaderReflection
\ No newline at end of file
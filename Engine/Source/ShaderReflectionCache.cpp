@@ -0,0 +1,119 @@
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+// Author: David Elder
+//
+
+#include "Stdafx.h"
+
+#include "ShaderReflectionCache.h"
+
+#include "BinaryReader.h"
+#include "RenderUtils.h"
+
+
+using namespace Kodiak;
+using namespace ShaderReflection;
+using namespace std;
+using namespace Microsoft::WRL;
+
+
+namespace
+{
+
+atomic<uint32_t> s_loadedCount{ 0 };
+atomic<uint32_t> s_reflectedCount{ 0 };
+atomic<uint64_t> s_loadedMicroseconds{ 0 };
+atomic<uint64_t> s_reflectedMicroseconds{ 0 };
+
+
+string GetReflectionPath(const string& shaderPath)
+{
+	const auto extensionPos = shaderPath.find_last_of('.');
+	const auto separatorPos = shaderPath.find_last_of("\\/");
+	if (extensionPos != string::npos && (separatorPos == string::npos || extensionPos > separatorPos))
+	{
+		return shaderPath.substr(0, extensionPos) + ".refl";
+	}
+	return shaderPath + ".refl";
+}
+
+} // anonymous namespace
+
+
+namespace ShaderReflection
+{
+
+void LoadSignature(const string& shaderPath, const uint8_t* byteCode, size_t byteCodeSize, Signature& signature,
+	vector<InputElement>* inputElements)
+{
+	const auto startTime = chrono::high_resolution_clock::now();
+
+	const string reflectionPath = GetReflectionPath(shaderPath);
+	vector<InputElement> localInputElements;
+	auto& elements = inputElements ? *inputElements : localInputElements;
+
+	unique_ptr<uint8_t[]> data;
+	size_t dataSize = 0;
+	bool loaded = SUCCEEDED(BinaryReader::ReadEntireFile(reflectionPath, data, &dataSize)) &&
+		DeserializeSignature(data.get(), dataSize, byteCode, byteCodeSize, signature, elements);
+
+	if (!loaded)
+	{
+		ComPtr<ID3DShaderReflection> reflector;
+		ThrowIfFailed(D3DReflect(byteCode, byteCodeSize, __uuidof(ID3DShaderReflection), &reflector));
+
+		Introspect(reflector.Get(), signature);
+		elements.clear();
+		if (inputElements)
+		{
+			IntrospectInputs(reflector.Get(), elements);
+		}
+
+		vector<uint8_t> serialized;
+		if (SerializeSignature(byteCode, byteCodeSize, signature, elements, serialized))
+		{
+			ofstream file(reflectionPath, ios::out | ios::trunc | ios::binary);
+			if (file)
+			{
+				file.write(reinterpret_cast<const char*>(serialized.data()), serialized.size());
+			}
+			else
+			{
+				LOG_WARNING << "Failed to write shader reflection data to " << reflectionPath;
+			}
+		}
+	}
+
+	const auto elapsed = chrono::high_resolution_clock::now() - startTime;
+	const auto microseconds = chrono::duration_cast<chrono::microseconds>(elapsed).count();
+	if (loaded)
+	{
+		++s_loadedCount;
+		s_loadedMicroseconds += microseconds;
+	}
+	else
+	{
+		++s_reflectedCount;
+		s_reflectedMicroseconds += microseconds;
+	}
+}
+
+
+void LogSignatureCacheStats()
+{
+	const uint32_t loadedCount = s_loadedCount;
+	const uint32_t reflectedCount = s_reflectedCount;
+	if (loadedCount + reflectedCount == 0)
+	{
+		return;
+	}
+
+	LOG_INFO << "Shader reflection: " << loadedCount << " loaded from .refl files in " << (s_loadedMicroseconds.load() / 1000.0) << " ms, "
+		<< reflectedCount << " reflected in " << (s_reflectedMicroseconds.load() / 1000.0) << " ms";
+}
+
+} // namespace ShaderReflection
\ No newline at end of file
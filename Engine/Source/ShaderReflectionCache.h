@@ -0,0 +1,31 @@
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+// Author: David Elder
+//
+
+#pragma once
+
+// Serialized reflection data, saved as a .refl file next to each .cso the first time it is reflected, so
+// later runs can skip D3DReflect and Introspect.  A .refl file is tied to its bytecode through the
+// checksum the compiler writes into the DXBC container, and is ignored once the shader is rebuilt.
+//
+// SerializeSignature and DeserializeSignature, in ShaderSignature.h, read and write the files.
+
+#include "ShaderReflection.h"
+
+namespace ShaderReflection
+{
+
+// Fills in the signature, and the vertex inputs if inputElements isn't null, from the .refl file next to
+// shaderPath (the full path of the .cso).  If there isn't a valid one, reflects the bytecode and writes it.
+void LoadSignature(const std::string& shaderPath, const uint8_t* byteCode, size_t byteCodeSize, Signature& signature,
+	std::vector<InputElement>* inputElements);
+
+// Logs how many shaders were loaded from .refl files vs. reflected, and the time spent on each
+void LogSignatureCacheStats();
+
+} // namespace ShaderReflection
\ No newline at end of file
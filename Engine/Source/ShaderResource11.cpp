@@ -16,6 +16,7 @@
 #include "Filesystem.h"
 #include "LoaderEnums.h"
 #include "RenderUtils.h"
+#include "ShaderReflectionCache.h"
 
 
 using namespace std;
@@ -35,6 +36,14 @@ bool LoadShaderFile(const string& path, unique_ptr<byte[]>& data, size_t& dataSi
 	return (res == S_OK);
 }
 
+
+void LoadShaderSignature(const string& path, const byte* data, size_t dataSize, ShaderReflection::Signature& signature,
+	vector<ShaderReflection::InputElement>* inputElements = nullptr)
+{
+	const string fullpath = Filesystem::GetInstance().GetFullPath(path);
+	ShaderReflection::LoadSignature(fullpath, data, dataSize, signature, inputElements);
+}
+
 } // anonymous namespace
 
 
@@ -47,10 +56,20 @@ bool ShaderResource::DoLoad()
 	unique_ptr<byte[]> data;
 	size_t dataSize;
 
-	auto res = LoadShaderFile(m_resourcePath, data, dataSize);
+	bool res = false;
+	{
+		LOAD_PHASE(LoadPhase::IO);
+		res = LoadShaderFile(m_resourcePath, data, dataSize);
+	}
+
 	if (res)
 	{
-		Create(data, dataSize);
+		LOAD_BYTES(dataSize);
+		{
+			// Shader creation and reflection
+			LOAD_PHASE(LoadPhase::Upload);
+			Create(data, dataSize);
+		}
 
 		m_loadState = LoadState::LoadSucceeded;
 		return true;
@@ -67,107 +86,31 @@ void VertexShaderResource::Create(unique_ptr<byte[]>& data, size_t dataSize)
 {
 	ThrowIfFailed(g_device->CreateVertexShader(data.get(), dataSize, nullptr, &m_shader));
 
-	ComPtr<ID3D11ShaderReflection> reflector;
-	ThrowIfFailed(D3DReflect(data.get(), dataSize, IID_ID3D11ShaderReflection, &reflector));
+	vector<ShaderReflection::InputElement> inputElements;
+	LoadShaderSignature(m_resourcePath, data.get(), dataSize, m_signature, &inputElements);
 
-	Introspect(reflector.Get(), m_signature);
-	CreateInputLayout(reflector.Get(), data, dataSize);
+	CreateInputLayout(inputElements, data, dataSize);
 }
 
 
-void VertexShaderResource::CreateInputLayout(ID3D11ShaderReflection* reflector, unique_ptr<byte[]>& data, size_t dataSize)
+void VertexShaderResource::CreateInputLayout(const vector<ShaderReflection::InputElement>& inputElements, unique_ptr<byte[]>& data,
+	size_t dataSize)
 {
 	std::vector<D3D11_INPUT_ELEMENT_DESC> inputLayoutDesc;
+	inputLayoutDesc.reserve(inputElements.size());
 
-	// Get shader info
-	D3D11_SHADER_DESC shaderDesc;
-	reflector->GetDesc(&shaderDesc);
-
-	for (uint32_t i = 0; i < shaderDesc.InputParameters; ++i)
+	for (const auto& inputElement : inputElements)
 	{
-		D3D11_SIGNATURE_PARAMETER_DESC paramDesc;
-		reflector->GetInputParameterDesc(i, &paramDesc);
-
 		// Fill out input element desc
 		D3D11_INPUT_ELEMENT_DESC elementDesc;
-		elementDesc.SemanticName = paramDesc.SemanticName;
-		elementDesc.SemanticIndex = paramDesc.SemanticIndex;
+		elementDesc.SemanticName = inputElement.semanticName.c_str();
+		elementDesc.SemanticIndex = inputElement.semanticIndex;
+		elementDesc.Format = static_cast<DXGI_FORMAT>(inputElement.format);
 		elementDesc.InputSlot = 0;
 		elementDesc.AlignedByteOffset = D3D11_APPEND_ALIGNED_ELEMENT;
 		elementDesc.InputSlotClass = D3D11_INPUT_PER_VERTEX_DATA;
 		elementDesc.InstanceDataStepRate = 0;
 
-		// Skip certain system value semantics
-		string upper = elementDesc.SemanticName;
-		transform(begin(upper), end(upper), begin(upper), ::toupper);
-
-		if (upper == "SV_INSTANCEID" || upper == "SV_VERTEXID" || upper == "SV_PRIMITIVEID")
-		{
-			continue;
-		}
-
-		// Determine DXGI format
-		if (paramDesc.Mask == 1)
-		{
-			if (paramDesc.ComponentType == D3D_REGISTER_COMPONENT_UINT32)
-			{
-				elementDesc.Format = DXGI_FORMAT_R32_UINT;
-			}
-			else if (paramDesc.ComponentType == D3D_REGISTER_COMPONENT_SINT32)
-			{
-				elementDesc.Format = DXGI_FORMAT_R32_SINT;
-			}
-			else if (paramDesc.ComponentType == D3D_REGISTER_COMPONENT_FLOAT32)
-			{
-				elementDesc.Format = DXGI_FORMAT_R32_FLOAT;
-			}
-		}
-		else if (paramDesc.Mask <= 3)
-		{
-			if (paramDesc.ComponentType == D3D_REGISTER_COMPONENT_UINT32)
-			{
-				elementDesc.Format = DXGI_FORMAT_R32G32_UINT;
-			}
-			else if (paramDesc.ComponentType == D3D_REGISTER_COMPONENT_SINT32)
-			{
-				elementDesc.Format = DXGI_FORMAT_R32G32_SINT;
-			}
-			else if (paramDesc.ComponentType == D3D_REGISTER_COMPONENT_FLOAT32)
-			{
-				elementDesc.Format = DXGI_FORMAT_R32G32_FLOAT;
-			}
-		}
-		else if (paramDesc.Mask <= 7)
-		{
-			if (paramDesc.ComponentType == D3D_REGISTER_COMPONENT_UINT32)
-			{
-				elementDesc.Format = DXGI_FORMAT_R32G32B32_UINT;
-			}
-			else if (paramDesc.ComponentType == D3D_REGISTER_COMPONENT_SINT32)
-			{
-				elementDesc.Format = DXGI_FORMAT_R32G32B32_SINT;
-			}
-			else if (paramDesc.ComponentType == D3D_REGISTER_COMPONENT_FLOAT32)
-			{
-				elementDesc.Format = DXGI_FORMAT_R32G32B32_FLOAT;
-			}
-		}
-		else if (paramDesc.Mask <= 15)
-		{
-			if (paramDesc.ComponentType == D3D_REGISTER_COMPONENT_UINT32)
-			{
-				elementDesc.Format = DXGI_FORMAT_R32G32B32A32_UINT;
-			}
-			else if (paramDesc.ComponentType == D3D_REGISTER_COMPONENT_SINT32)
-			{
-				elementDesc.Format = DXGI_FORMAT_R32G32B32A32_SINT;
-			}
-			else if (paramDesc.ComponentType == D3D_REGISTER_COMPONENT_FLOAT32)
-			{
-				elementDesc.Format = DXGI_FORMAT_R32G32B32A32_FLOAT;
-			}
-		}
-
 		// Save element desc
 		inputLayoutDesc.push_back(elementDesc);
 	}
@@ -190,10 +133,7 @@ void HullShaderResource::Create(unique_ptr<byte[]>& data, size_t dataSize)
 {
 	ThrowIfFailed(g_device->CreateHullShader(data.get(), dataSize, nullptr, &m_shader));
 
-	ComPtr<ID3D11ShaderReflection> reflector;
-	ThrowIfFailed(D3DReflect(data.get(), dataSize, IID_ID3D11ShaderReflection, &reflector));
-
-	Introspect(reflector.Get(), m_signature);
+	LoadShaderSignature(m_resourcePath, data.get(), dataSize, m_signature);
 }
 
 
@@ -201,10 +141,7 @@ void DomainShaderResource::Create(unique_ptr<byte[]>& data, size_t dataSize)
 {
 	ThrowIfFailed(g_device->CreateDomainShader(data.get(), dataSize, nullptr, &m_shader));
 
-	ComPtr<ID3D11ShaderReflection> reflector;
-	ThrowIfFailed(D3DReflect(data.get(), dataSize, IID_ID3D11ShaderReflection, &reflector));
-
-	Introspect(reflector.Get(), m_signature);
+	LoadShaderSignature(m_resourcePath, data.get(), dataSize, m_signature);
 }
 
 
@@ -212,10 +149,7 @@ void GeometryShaderResource::Create(unique_ptr<byte[]>& data, size_t dataSize)
 {
 	ThrowIfFailed(g_device->CreateGeometryShader(data.get(), dataSize, nullptr, &m_shader));
 
-	ComPtr<ID3D11ShaderReflection> reflector;
-	ThrowIfFailed(D3DReflect(data.get(), dataSize, IID_ID3D11ShaderReflection, &reflector));
-
-	Introspect(reflector.Get(), m_signature);
+	LoadShaderSignature(m_resourcePath, data.get(), dataSize, m_signature);
 }
 
 
@@ -223,10 +157,7 @@ void PixelShaderResource::Create(unique_ptr<byte[]>& data, size_t dataSize)
 {
 	ThrowIfFailed(g_device->CreatePixelShader(data.get(), dataSize, nullptr, &m_shader));
 
-	ComPtr<ID3D11ShaderReflection> reflector;
-	ThrowIfFailed(D3DReflect(data.get(), dataSize, IID_ID3D11ShaderReflection, &reflector));
-
-	Introspect(reflector.Get(), m_signature);
+	LoadShaderSignature(m_resourcePath, data.get(), dataSize, m_signature);
 }
 
 
@@ -234,8 +165,5 @@ void ComputeShaderResource::Create(unique_ptr<byte[]>& data, size_t dataSize)
 {
 	ThrowIfFailed(g_device->CreateComputeShader(data.get(), dataSize, nullptr, &m_shader));
 
-	ComPtr<ID3D11ShaderReflection> reflector;
-	ThrowIfFailed(D3DReflect(data.get(), dataSize, IID_ID3D11ShaderReflection, &reflector));
-
-	Introspect(reflector.Get(), m_signature);
+	LoadShaderSignature(m_resourcePath, data.get(), dataSize, m_signature);
 }
\ No newline at end of file
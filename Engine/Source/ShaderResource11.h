@@ -48,7 +48,8 @@ public:
 
 private:
 	void Create(std::unique_ptr<byte[]>& data, size_t dataSize) final override;
-	void CreateInputLayout(ID3D11ShaderReflection* reflector, std::unique_ptr<byte[]>& data, size_t dataSize);
+	void CreateInputLayout(const std::vector<ShaderReflection::InputElement>& inputElements, std::unique_ptr<byte[]>& data,
+		size_t dataSize);
 
 private:
 	Microsoft::WRL::ComPtr<ID3D11VertexShader>	m_shader;
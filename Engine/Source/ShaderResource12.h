@@ -55,7 +55,7 @@ public:
 
 private:
 	void Finalize() final override;
-	void CreateInputLayout(ID3D12ShaderReflection* reflector);
+	void CreateInputLayout(const std::vector<ShaderReflection::InputElement>& inputElements);
 
 private:
 	InputLayout			m_inputLayout;
@@ -0,0 +1,523 @@
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+// Author: David Elder
+//
+
+// Built without the precompiled header, so that tools can share it
+
+#include "ShaderSignature.h"
+
+#include <cstring>
+#include <initializer_list>
+
+
+using namespace Kodiak;
+using namespace ShaderReflection;
+using namespace std;
+
+
+namespace
+{
+
+const uint32_t s_magic = 0x4652534B; // 'KSRF'
+const uint32_t s_version = 2;
+
+// DXBC containers start with this, then an MD5 checksum of everything after it
+const uint32_t s_dxbcMagic = 0x43425844; // 'DXBC'
+const size_t s_dxbcChecksumSize = 16;
+
+
+// Offset into the string table, which follows the records
+struct StringRef
+{
+	uint32_t	offset;
+	uint32_t	length;
+};
+
+
+struct FileHeader
+{
+	uint32_t	magic;
+	uint32_t	version;
+	uint8_t		byteCodeChecksum[s_dxbcChecksumSize];
+	uint32_t	byteCodeSize;
+
+	uint32_t	numCBVs;
+	uint32_t	numSRVTables;
+	uint32_t	numUAVTables;
+	uint32_t	numSamplerTables;
+	uint32_t	numParameters;
+	uint32_t	numResources;
+	uint32_t	numUAVs;
+	uint32_t	numSamplers;
+	uint32_t	numInputElements;
+
+	uint32_t	numDescriptors;
+	uint32_t	numMaterialDescriptors;
+	uint32_t	numSamplerDescriptors;
+	uint32_t	bindlessSrvRegister;
+
+	uint32_t	stringTableSize;
+};
+
+
+// Per-view and per-object CBVs come first, then the CBV table
+struct CBVRecord
+{
+	StringRef	name;
+	uint32_t	byteOffset;
+	uint32_t	sizeInBytes;
+	uint32_t	shaderRegister;
+	uint32_t	tableIndex;
+	uint32_t	tableSlot;
+};
+
+
+struct TableRecord
+{
+	uint32_t	shaderRegister;
+	uint32_t	numItems;
+};
+
+
+struct ParameterRecord
+{
+	StringRef	name;
+	uint32_t	type;
+	uint32_t	sizeInBytes;
+	uint32_t	numElements;
+	uint32_t	cbvShaderRegister;
+	uint32_t	byteOffset;
+};
+
+
+struct SRVRecord
+{
+	StringRef	name;
+	uint32_t	type;
+	uint32_t	dimension;
+	uint32_t	shaderRegister;
+	uint32_t	tableIndex;
+	uint32_t	tableSlot;
+};
+
+
+struct UAVRecord
+{
+	StringRef	name;
+	uint32_t	type;
+	uint32_t	shaderRegister;
+	uint32_t	tableIndex;
+	uint32_t	tableSlot;
+};
+
+
+struct SamplerRecord
+{
+	StringRef	name;
+	uint32_t	shaderRegister;
+	uint32_t	tableIndex;
+	uint32_t	tableSlot;
+};
+
+
+struct InputElementRecord
+{
+	StringRef	semanticName;
+	uint32_t	semanticIndex;
+	uint32_t	format;
+};
+
+
+bool GetByteCodeChecksum(const uint8_t* byteCode, size_t byteCodeSize, const uint8_t*& checksum)
+{
+	uint32_t magic = 0;
+	if (byteCode == nullptr || byteCodeSize < sizeof(magic) + s_dxbcChecksumSize)
+	{
+		return false;
+	}
+
+	memcpy(&magic, byteCode, sizeof(magic));
+	checksum = byteCode + sizeof(magic);
+	return magic == s_dxbcMagic;
+}
+
+
+class RecordWriter
+{
+public:
+	explicit RecordWriter(vector<uint8_t>& data) : m_data(data) {}
+
+	template <typename T>
+	void Write(const T& record)
+	{
+		const auto bytes = reinterpret_cast<const uint8_t*>(&record);
+		m_data.insert(m_data.end(), bytes, bytes + sizeof(T));
+	}
+
+	StringRef AddString(const string& str)
+	{
+		StringRef ref;
+		ref.offset = static_cast<uint32_t>(m_strings.size());
+		ref.length = static_cast<uint32_t>(str.size());
+		m_strings.insert(m_strings.end(), str.begin(), str.end());
+		return ref;
+	}
+
+	CBVRecord MakeCBVRecord(const CBVLayout& cbv)
+	{
+		CBVRecord record;
+		record.name = AddString(cbv.name);
+		record.byteOffset = cbv.byteOffset;
+		record.sizeInBytes = cbv.sizeInBytes;
+		record.shaderRegister = cbv.shaderRegister;
+		record.tableIndex = cbv.binding.tableIndex;
+		record.tableSlot = cbv.binding.tableSlot;
+		return record;
+	}
+
+	// Appends the string table, and returns its size
+	uint32_t Finish()
+	{
+		m_data.insert(m_data.end(), m_strings.begin(), m_strings.end());
+		return static_cast<uint32_t>(m_strings.size());
+	}
+
+private:
+	vector<uint8_t>&	m_data;
+	vector<char>		m_strings;
+};
+
+
+class RecordReader
+{
+public:
+	RecordReader(const uint8_t* records, const char* strings, uint32_t stringTableSize)
+		: m_cursor(records)
+		, m_strings(strings)
+		, m_stringTableSize(stringTableSize)
+	{}
+
+	// The caller has already checked that the records fit
+	template <typename T>
+	void Read(T& record)
+	{
+		memcpy(&record, m_cursor, sizeof(T));
+		m_cursor += sizeof(T);
+	}
+
+	bool GetString(const StringRef& ref, string& str) const
+	{
+		if (ref.offset > m_stringTableSize || ref.length > m_stringTableSize - ref.offset)
+		{
+			return false;
+		}
+		str.assign(m_strings + ref.offset, ref.length);
+		return true;
+	}
+
+	bool ReadCBV(CBVLayout& cbv)
+	{
+		CBVRecord record;
+		Read(record);
+		cbv.byteOffset = record.byteOffset;
+		cbv.sizeInBytes = record.sizeInBytes;
+		cbv.shaderRegister = record.shaderRegister;
+		cbv.binding.tableIndex = record.tableIndex;
+		cbv.binding.tableSlot = record.tableSlot;
+		return GetString(record.name, cbv.name);
+	}
+
+	void ReadTables(uint32_t count, vector<TableLayout>& tables)
+	{
+		tables.resize(count);
+		for (auto& table : tables)
+		{
+			TableRecord record;
+			Read(record);
+			table.shaderRegister = record.shaderRegister;
+			table.numItems = record.numItems;
+		}
+	}
+
+private:
+	const uint8_t*	m_cursor;
+	const char*		m_strings;
+	uint32_t		m_stringTableSize;
+};
+
+} // anonymous namespace
+
+
+namespace ShaderReflection
+{
+
+void ResetSignature(Signature& signature)
+{
+	// Reset per-view and per-object CBV bindings
+	signature.cbvPerViewData.byteOffset = kInvalid;
+	signature.cbvPerViewData.sizeInBytes = kInvalid;
+	signature.cbvPerViewData.shaderRegister = kInvalid;
+
+	signature.cbvPerObjectData.byteOffset = kInvalid;
+	signature.cbvPerObjectData.sizeInBytes = kInvalid;
+	signature.cbvPerObjectData.shaderRegister = kInvalid;
+
+	// Clear tables
+	signature.cbvTable.clear();
+	signature.srvTable.clear();
+	signature.uavTable.clear();
+	signature.samplerTable.clear();
+
+	// Clear parameters
+	signature.parameters.clear();
+	signature.resources.clear();
+	signature.uavs.clear();
+	signature.samplers.clear();
+
+	// Reset additional data
+	signature.numDescriptors = 0;
+	signature.numMaterialDescriptors = 0;
+	signature.numSamplers = 0;
+	signature.bindlessSrvRegister = kInvalid;
+}
+
+
+bool SerializeSignature(const uint8_t* byteCode, size_t byteCodeSize, const Signature& signature,
+	const vector<InputElement>& inputElements, vector<uint8_t>& data)
+{
+	const uint8_t* checksum = nullptr;
+	if (!GetByteCodeChecksum(byteCode, byteCodeSize, checksum))
+	{
+		return false;
+	}
+
+	FileHeader header;
+	header.magic = s_magic;
+	header.version = s_version;
+	memcpy(header.byteCodeChecksum, checksum, s_dxbcChecksumSize);
+	header.byteCodeSize = static_cast<uint32_t>(byteCodeSize);
+	header.numCBVs = static_cast<uint32_t>(signature.cbvTable.size());
+	header.numSRVTables = static_cast<uint32_t>(signature.srvTable.size());
+	header.numUAVTables = static_cast<uint32_t>(signature.uavTable.size());
+	header.numSamplerTables = static_cast<uint32_t>(signature.samplerTable.size());
+	header.numParameters = static_cast<uint32_t>(signature.parameters.size());
+	header.numResources = static_cast<uint32_t>(signature.resources.size());
+	header.numUAVs = static_cast<uint32_t>(signature.uavs.size());
+	header.numSamplers = static_cast<uint32_t>(signature.samplers.size());
+	header.numInputElements = static_cast<uint32_t>(inputElements.size());
+	header.numDescriptors = signature.numDescriptors;
+	header.numMaterialDescriptors = signature.numMaterialDescriptors;
+	header.numSamplerDescriptors = signature.numSamplers;
+	header.bindlessSrvRegister = signature.bindlessSrvRegister;
+	header.stringTableSize = 0;
+
+	data.clear();
+	RecordWriter writer(data);
+	writer.Write(header);
+
+	writer.Write(writer.MakeCBVRecord(signature.cbvPerViewData));
+	writer.Write(writer.MakeCBVRecord(signature.cbvPerObjectData));
+	for (const auto& cbv : signature.cbvTable)
+	{
+		writer.Write(writer.MakeCBVRecord(cbv));
+	}
+
+	for (const auto* tables : { &signature.srvTable, &signature.uavTable, &signature.samplerTable })
+	{
+		for (const auto& table : *tables)
+		{
+			writer.Write(TableRecord{ table.shaderRegister, table.numItems });
+		}
+	}
+
+	for (const auto& parameter : signature.parameters)
+	{
+		ParameterRecord record;
+		record.name = writer.AddString(parameter.name);
+		record.type = static_cast<uint32_t>(parameter.type);
+		record.sizeInBytes = parameter.sizeInBytes;
+		record.numElements = parameter.numElements;
+		record.cbvShaderRegister = parameter.cbvShaderRegister[0];
+		record.byteOffset = parameter.byteOffset[0];
+		writer.Write(record);
+	}
+
+	for (const auto& resource : signature.resources)
+	{
+		SRVRecord record;
+		record.name = writer.AddString(resource.name);
+		record.type = static_cast<uint32_t>(resource.type);
+		record.dimension = static_cast<uint32_t>(resource.dimension);
+		record.shaderRegister = resource.shaderRegister[0];
+		record.tableIndex = resource.binding[0].tableIndex;
+		record.tableSlot = resource.binding[0].tableSlot;
+		writer.Write(record);
+	}
+
+	for (const auto& uav : signature.uavs)
+	{
+		UAVRecord record;
+		record.name = writer.AddString(uav.name);
+		record.type = static_cast<uint32_t>(uav.type);
+		record.shaderRegister = uav.shaderRegister[0];
+		record.tableIndex = uav.binding[0].tableIndex;
+		record.tableSlot = uav.binding[0].tableSlot;
+		writer.Write(record);
+	}
+
+	for (const auto& sampler : signature.samplers)
+	{
+		SamplerRecord record;
+		record.name = writer.AddString(sampler.name);
+		record.shaderRegister = sampler.shaderRegister[0];
+		record.tableIndex = sampler.binding[0].tableIndex;
+		record.tableSlot = sampler.binding[0].tableSlot;
+		writer.Write(record);
+	}
+
+	for (const auto& element : inputElements)
+	{
+		InputElementRecord record;
+		record.semanticName = writer.AddString(element.semanticName);
+		record.semanticIndex = element.semanticIndex;
+		record.format = element.format;
+		writer.Write(record);
+	}
+
+	header.stringTableSize = writer.Finish();
+	memcpy(data.data(), &header, sizeof(header));
+
+	return true;
+}
+
+
+bool DeserializeSignature(const uint8_t* data, size_t dataSize, const uint8_t* byteCode, size_t byteCodeSize,
+	Signature& signature, vector<InputElement>& inputElements)
+{
+	const uint8_t* checksum = nullptr;
+	FileHeader header;
+	if (!GetByteCodeChecksum(byteCode, byteCodeSize, checksum) || data == nullptr || dataSize < sizeof(header))
+	{
+		return false;
+	}
+
+	memcpy(&header, data, sizeof(header));
+	if (header.magic != s_magic ||
+		header.version != s_version ||
+		header.byteCodeSize != byteCodeSize ||
+		memcmp(header.byteCodeChecksum, checksum, s_dxbcChecksumSize) != 0)
+	{
+		return false;
+	}
+
+	// Everything has a fixed size except the string table, so the whole file can be checked up front
+	const uint64_t recordBytes =
+		(2ull + header.numCBVs) * sizeof(CBVRecord) +
+		(static_cast<uint64_t>(header.numSRVTables) + header.numUAVTables + header.numSamplerTables) * sizeof(TableRecord) +
+		static_cast<uint64_t>(header.numParameters) * sizeof(ParameterRecord) +
+		static_cast<uint64_t>(header.numResources) * sizeof(SRVRecord) +
+		static_cast<uint64_t>(header.numUAVs) * sizeof(UAVRecord) +
+		static_cast<uint64_t>(header.numSamplers) * sizeof(SamplerRecord) +
+		static_cast<uint64_t>(header.numInputElements) * sizeof(InputElementRecord);
+	if (sizeof(header) + recordBytes + header.stringTableSize != dataSize)
+	{
+		return false;
+	}
+
+	const uint8_t* records = data + sizeof(header);
+	RecordReader reader(records, reinterpret_cast<const char*>(records + recordBytes), header.stringTableSize);
+
+	ResetSignature(signature);
+	inputElements.clear();
+
+	bool valid = reader.ReadCBV(signature.cbvPerViewData);
+	valid = reader.ReadCBV(signature.cbvPerObjectData) && valid;
+
+	signature.cbvTable.resize(header.numCBVs);
+	for (auto& cbv : signature.cbvTable)
+	{
+		valid = reader.ReadCBV(cbv) && valid;
+	}
+
+	reader.ReadTables(header.numSRVTables, signature.srvTable);
+	reader.ReadTables(header.numUAVTables, signature.uavTable);
+	reader.ReadTables(header.numSamplerTables, signature.samplerTable);
+
+	signature.parameters.resize(header.numParameters);
+	for (auto& parameter : signature.parameters)
+	{
+		ParameterRecord record;
+		reader.Read(record);
+		valid = reader.GetString(record.name, parameter.name) && valid;
+		parameter.type = static_cast<ShaderVariableType>(record.type);
+		parameter.sizeInBytes = record.sizeInBytes;
+		parameter.numElements = record.numElements;
+		parameter.cbvShaderRegister[0] = record.cbvShaderRegister;
+		parameter.byteOffset[0] = record.byteOffset;
+	}
+
+	signature.resources.resize(header.numResources);
+	for (auto& resource : signature.resources)
+	{
+		SRVRecord record;
+		reader.Read(record);
+		valid = reader.GetString(record.name, resource.name) && valid;
+		resource.type = static_cast<ShaderResourceType>(record.type);
+		resource.dimension = static_cast<ShaderResourceDimension>(record.dimension);
+		resource.shaderRegister[0] = record.shaderRegister;
+		resource.binding[0].tableIndex = record.tableIndex;
+		resource.binding[0].tableSlot = record.tableSlot;
+	}
+
+	signature.uavs.resize(header.numUAVs);
+	for (auto& uav : signature.uavs)
+	{
+		UAVRecord record;
+		reader.Read(record);
+		valid = reader.GetString(record.name, uav.name) && valid;
+		uav.type = static_cast<ShaderResourceType>(record.type);
+		uav.shaderRegister[0] = record.shaderRegister;
+		uav.binding[0].tableIndex = record.tableIndex;
+		uav.binding[0].tableSlot = record.tableSlot;
+	}
+
+	signature.samplers.resize(header.numSamplers);
+	for (auto& sampler : signature.samplers)
+	{
+		SamplerRecord record;
+		reader.Read(record);
+		valid = reader.GetString(record.name, sampler.name) && valid;
+		sampler.shaderRegister[0] = record.shaderRegister;
+		sampler.binding[0].tableIndex = record.tableIndex;
+		sampler.binding[0].tableSlot = record.tableSlot;
+	}
+
+	inputElements.resize(header.numInputElements);
+	for (auto& element : inputElements)
+	{
+		InputElementRecord record;
+		reader.Read(record);
+		valid = reader.GetString(record.semanticName, element.semanticName) && valid;
+		element.semanticIndex = record.semanticIndex;
+		element.format = record.format;
+	}
+
+	signature.numDescriptors = header.numDescriptors;
+	signature.numMaterialDescriptors = header.numMaterialDescriptors;
+	signature.numSamplers = header.numSamplerDescriptors;
+	signature.bindlessSrvRegister = header.bindlessSrvRegister;
+
+	if (!valid)
+	{
+		ResetSignature(signature);
+		inputElements.clear();
+	}
+	return valid;
+}
+
+} // namespace ShaderReflection
\ No newline at end of file
@@ -0,0 +1,271 @@
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+// Author: David Elder
+//
+
+#pragma once
+
+// The reflected bindings of a shader, and their serialized form, which ShaderReflectionCache saves in .refl files.
+// The format is position independent: a header, fixed-size records for each table, then a string table that
+// records refer to by offset.
+//
+// This header, ShaderSignature.cpp and Constants.cpp only depend on the standard library.
+
+#include "Constants.h"
+
+#include <array>
+#include <cassert>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Forward declarations
+namespace Kodiak
+{
+enum class ShaderResourceDimension;
+enum class ShaderResourceType;
+enum class ShaderVariableType;
+}
+
+namespace ShaderReflection
+{
+
+struct TableLayout
+{
+	uint32_t		shaderRegister{ kInvalid };
+	uint32_t		numItems{ kInvalid };
+};
+
+
+struct TableEntry
+{
+	uint32_t		tableIndex{ kInvalid };
+	uint32_t		tableSlot{ kInvalid };
+};
+
+
+struct CBVLayout
+{
+	std::string		name;
+	uint32_t		byteOffset{ kInvalid };		// offset from start of large cbuffer (16-byte aligned)
+	uint32_t		sizeInBytes{ kInvalid };    // cbuffer size in bytes (multiple of 16)
+	uint32_t		shaderRegister{ kInvalid };
+	TableEntry		binding;
+};
+
+
+struct BaseParameter
+{
+	BaseParameter() = default;
+	BaseParameter(const BaseParameter& other) : name(other.name), type(other.type), sizeInBytes(other.sizeInBytes), numElements(other.numElements) {}
+
+	std::string							name;
+	Kodiak::ShaderVariableType			type;
+	uint32_t							sizeInBytes{ 0 };
+	uint32_t							numElements{ 0 };
+};
+
+
+template <uint32_t SlotCount = 1>
+struct Parameter : public BaseParameter
+{
+	Parameter()
+	{
+		cbvShaderRegister.fill(kInvalid);
+		byteOffset.fill(kInvalid);
+	}
+
+	Parameter(uint32_t slot, const Parameter<1>& other) : BaseParameter(other)
+	{
+		cbvShaderRegister.fill(kInvalid);
+		byteOffset.fill(kInvalid);
+
+		assert(slot < SlotCount);
+		cbvShaderRegister[slot] = other.cbvShaderRegister[0];
+		byteOffset[slot] = other.byteOffset[0];
+	}
+
+	void Assign(uint32_t slot, const Parameter<1>& other)
+	{
+		assert(slot < SlotCount);
+		assert(type == other.type);
+		assert(sizeInBytes == other.sizeInBytes);
+		assert(numElements == other.numElements);
+		cbvShaderRegister[slot] = other.cbvShaderRegister[0];
+		byteOffset[slot] = other.byteOffset[0];
+	}
+
+	std::array<uint32_t, SlotCount>		cbvShaderRegister;
+	std::array<uint32_t, SlotCount>		byteOffset;
+};
+
+
+struct BaseResourceSRV
+{
+	BaseResourceSRV() = default;
+	BaseResourceSRV(const BaseResourceSRV& other) : name(other.name), type(other.type), dimension(other.dimension) {}
+
+	std::string							name;
+	Kodiak::ShaderResourceType			type;
+	Kodiak::ShaderResourceDimension		dimension;
+};
+
+
+template <uint32_t SlotCount = 1>
+struct ResourceSRV : public BaseResourceSRV
+{
+	ResourceSRV()
+	{
+		shaderRegister.fill(kInvalid);
+	}
+
+	ResourceSRV(uint32_t slot, const ResourceSRV<1>& other) : BaseResourceSRV(other)
+	{
+		shaderRegister.fill(kInvalid);
+
+		assert(slot < SlotCount);
+		binding[slot] = other.binding[0];
+		shaderRegister[slot] = other.shaderRegister[0];
+	}
+
+	void Assign(uint32_t slot, const ResourceSRV<1>& other)
+	{
+		assert(slot < SlotCount);
+		assert(type == other.type);
+		assert(dimension == other.dimension);
+		binding[slot] = other.binding[0];
+		shaderRegister[slot] = other.shaderRegister[0];
+	}
+
+	std::array<TableEntry, SlotCount>	binding;
+	std::array<uint32_t, SlotCount>		shaderRegister;
+};
+
+
+struct BaseResourceUAV
+{
+	BaseResourceUAV() = default;
+	BaseResourceUAV(const BaseResourceUAV& other) : name(other.name), type(other.type) {}
+
+	std::string							name;
+	Kodiak::ShaderResourceType			type;
+};
+
+
+template <uint32_t SlotCount = 1>
+struct ResourceUAV : public BaseResourceUAV
+{
+	ResourceUAV()
+	{
+		shaderRegister.fill(kInvalid);
+	}
+
+	ResourceUAV(uint32_t slot, const ResourceUAV<1>& other) : BaseResourceUAV(other)
+	{
+		shaderRegister.fill(kInvalid);
+
+		assert(slot < SlotCount);
+		binding[slot] = other.binding[0];
+		shaderRegister[slot] = other.shaderRegister[0];
+	}
+
+	void Assign(uint32_t slot, const ResourceUAV<1>& other)
+	{
+		assert(slot < SlotCount);
+		assert(type == other.type);
+		binding[slot] = other.binding[0];
+		shaderRegister[slot] = other.shaderRegister[0];
+	}
+
+	std::array<TableEntry, SlotCount>	binding;
+	std::array<uint32_t, SlotCount>		shaderRegister;
+};
+
+
+struct BaseSampler
+{
+	BaseSampler() = default;
+	BaseSampler(const BaseSampler& other) : name(other.name) {}
+	std::string							name;
+};
+
+template <uint32_t SlotCount = 1>
+struct Sampler : public BaseSampler
+{
+	Sampler()
+	{
+		shaderRegister.fill(kInvalid);
+	}
+
+	Sampler(uint32_t slot, const Sampler<1>& other) : BaseSampler(other)
+	{
+		shaderRegister.fill(kInvalid);
+
+		assert(slot < SlotCount);
+		binding[slot] = other.binding[0];
+		shaderRegister[slot] = other.shaderRegister[0];
+	}
+
+	void Assign(uint32_t slot, const Sampler<1>& other)
+	{
+		assert(slot < SlotCount);
+		binding[slot] = other.binding[0];
+		shaderRegister[slot] = other.shaderRegister[0];
+	}
+
+	std::array<TableEntry, SlotCount>	binding;
+	std::array<uint32_t, SlotCount>		shaderRegister;
+};
+
+
+// Signature of a single shader
+struct Signature
+{
+	// DX API inputs
+	ShaderReflection::CBVLayout						cbvPerViewData;
+	ShaderReflection::CBVLayout						cbvPerObjectData;
+	std::vector<ShaderReflection::CBVLayout>		cbvTable;
+	std::vector<ShaderReflection::TableLayout>		srvTable;
+	std::vector<ShaderReflection::TableLayout>		uavTable;
+	std::vector<ShaderReflection::TableLayout>		samplerTable;
+
+	// Application inputs
+	std::vector<ShaderReflection::Parameter<1>>		parameters;
+	std::vector<ShaderReflection::ResourceSRV<1>>	resources;
+	std::vector<ShaderReflection::ResourceUAV<1>>	uavs;
+	std::vector<ShaderReflection::Sampler<1>>		samplers;
+
+	// Additional data
+	uint32_t										numDescriptors{ 0 };
+	uint32_t										numMaterialDescriptors{ 0 };
+	uint32_t										numSamplers{ 0 };
+
+	// Register of the unbounded texture array in the bindless space, if the shader declares one
+	uint32_t										bindlessSrvRegister{ kInvalid };
+};
+
+
+// Vertex shader input, in input signature order.  System values that aren't fed from vertex buffers are left out.
+struct InputElement
+{
+	std::string										semanticName;
+	uint32_t										semanticIndex{ 0 };
+	uint32_t										format{ 0 };		// DXGI_FORMAT, 0 is DXGI_FORMAT_UNKNOWN
+};
+
+
+void ResetSignature(Signature& signature);
+
+// Returns false if byteCode isn't a DXBC container, which has no checksum to validate against
+bool SerializeSignature(const uint8_t* byteCode, size_t byteCodeSize, const Signature& signature,
+	const std::vector<InputElement>& inputElements, std::vector<uint8_t>& data);
+
+// Returns false if the data is truncated or was written for other bytecode or by another version
+bool DeserializeSignature(const uint8_t* data, size_t dataSize, const uint8_t* byteCode, size_t byteCodeSize,
+	Signature& signature, std::vector<InputElement>& inputElements);
+
+} // namespace ShaderReflection
\ No newline at end of file
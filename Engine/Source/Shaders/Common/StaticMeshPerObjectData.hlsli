@@ -4,6 +4,8 @@
 cbuffer PerObjectConstants : register(b1)
 {
 	matrix model;
+	float3 positionScale;	// Decodes quantized positions
+	float3 positionBias;
 };
 
 #endif
\ No newline at end of file
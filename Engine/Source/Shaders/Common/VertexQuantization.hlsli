@@ -0,0 +1,34 @@
+#ifndef VERTEX_QUANTIZATION
+#define VERTEX_QUANTIZATION
+
+// Decoders for the QuantizedVertex layout in VertexQuantization.h.  Declare the inputs in this order:
+//
+//   float4 position : QPOSITION;
+//   float2 texcoord : QTEXCOORD;
+//   float2 normal : QNORMAL;
+//   float2 tangent : QTANGENT;
+
+float3 DecodePosition(float4 position, float3 scale, float3 bias)
+{
+	return position.xyz * scale + bias;
+}
+
+
+float3 DecodeOctahedral(float2 encoded)
+{
+	float3 direction = float3(encoded.x, encoded.y, 1.0 - abs(encoded.x) - abs(encoded.y));
+
+	// Unfold the lower hemisphere
+	float t = saturate(-direction.z);
+	direction.xy += direction.xy >= 0.0 ? -t : t;
+
+	return normalize(direction);
+}
+
+
+float3 DecodeBitangent(float3 normal, float3 tangent, float4 position)
+{
+	return cross(normal, tangent) * (position.w * 2.0 - 1.0);
+}
+
+#endif
\ No newline at end of file
@@ -12,8 +12,10 @@
 #include "Texture.h"
 
 #include "Format.h"
+#include "LoadGraph.h"
 #include "ResourceLoader.h"
 #include "TextureResource.h"
+#include "TextureStreaming.h"
 
 
 using namespace Kodiak;
@@ -134,9 +136,77 @@ shared_ptr<Texture> Texture::Load(const string& path, bool isSRGB)
 }
 
 
+vector<shared_ptr<Texture>> Texture::LoadBatch(const vector<TextureLoadRequest>& requests)
+{
+	vector<string> paths;
+	paths.reserve(requests.size());
+	for (const auto& request : requests)
+	{
+		paths.push_back(request.path);
+	}
+
+	auto resources = ResourceLoader::GetInstance().LoadBatch<TextureResource>(paths, [&requests](size_t index)
+	{
+		auto resource = make_shared<TextureResource>(requests[index].isSRGB);
+		resource->SetStreamingAllowed(requests[index].allowStreaming);
+		return resource;
+	});
+
+	vector<shared_ptr<Texture>> textures(requests.size());
+	for (size_t i = 0; i < requests.size(); ++i)
+	{
+		auto texture = make_shared<Texture>();
+		texture->m_name = "<Unnamed Texture>";
+		texture->m_resource = resources[i];
+		textures[i] = texture;
+	}
+
+	return textures;
+}
+
+
 void Texture::AddPostLoadCallback(function<void()> callback)
 {
 	assert(m_resource);
 
 	m_resource->AddPostLoadCallback(callback);
+}
+
+
+shared_ptr<LoadNode> Texture::GetLoadNode()
+{
+	if (m_resource)
+	{
+		return LoadNode::Track(m_resource);
+	}
+
+	// Nothing to load, e.g. the file didn't exist
+	auto node = make_shared<LoadNode>(m_name);
+	node->FinishWork(false);
+	return node;
+}
+
+
+void Texture::SetStreamingPriority(float priority, uint32_t desiredMip)
+{
+	if (m_resource)
+	{
+		m_resource->SetStreamingPriority(priority, desiredMip);
+	}
+}
+
+
+void Texture::SetStreamingDistance(float distance, float fullDetailDistance)
+{
+	if (m_resource)
+	{
+		uint32_t desiredMip = ComputeDesiredMip(distance, fullDetailDistance, m_resource->GetMipLevels());
+		m_resource->SetStreamingPriority(1.0f / (1.0f + std::max<float>(0.0f, distance)), desiredMip);
+	}
+}
+
+
+uint32_t Texture::GetResidentMip() const
+{
+	return m_resource ? m_resource->GetResidentMip() : 0;
 }
\ No newline at end of file
@@ -14,8 +14,18 @@ namespace Kodiak
 
 // Forward declarations
 enum class ColorFormat;
+class LoadNode;
 class TextureResource;
 
+
+struct TextureLoadRequest
+{
+	std::string path;
+	bool isSRGB;
+	bool allowStreaming{ true };
+};
+
+
 class Texture
 {
 public:
@@ -39,8 +49,22 @@ public:
 
 	static std::shared_ptr<Texture> Load(const std::string& path, bool isSRGB);
 
+	// Hands all of the requests to the loader at once.  Returns a texture per request, in order.
+	static std::vector<std::shared_ptr<Texture>> LoadBatch(const std::vector<TextureLoadRequest>& requests);
+
 	void AddPostLoadCallback(std::function<void()> callback);
 
+	std::shared_ptr<TextureResource> GetResource() const { return m_resource; }
+
+	// Load graph leaf that finishes when the texture has loaded.  Textures sharing a file share the node.
+	std::shared_ptr<LoadNode> GetLoadNode();
+
+	// Mip streaming hints.  Higher priority textures stream in first; desiredMip is the most detailed
+	// mip worth keeping resident.  SetStreamingDistance derives both from the distance to the viewer.
+	void SetStreamingPriority(float priority, uint32_t desiredMip = 0);
+	void SetStreamingDistance(float distance, float fullDetailDistance);
+	uint32_t GetResidentMip() const;
+
 private:
 	std::shared_ptr<TextureResource> m_resource;
 	std::string m_name;
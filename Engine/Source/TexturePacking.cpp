@@ -0,0 +1,80 @@
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+// Author: David Elder
+//
+
+// Built without the precompiled header, so that tools can share it
+
+#include "TexturePacking.h"
+
+#include <algorithm>
+#include <cassert>
+#include <map>
+#include <tuple>
+
+
+using namespace Kodiak;
+using namespace std;
+
+
+namespace Kodiak
+{
+
+TexturePackLayout PackTextureArrays(const vector<TexturePackInput>& inputs, uint32_t maxSlices)
+{
+	assert(maxSlices > 0);
+	maxSlices = min(maxSlices, kMaxTextureArraySlices);
+
+	TexturePackLayout layout;
+	layout.placements.resize(inputs.size());
+
+	// Index of the array currently filling up for each format, size and mip count
+	map<tuple<uint32_t, uint32_t, uint32_t, uint32_t>, uint32_t> openArrays;
+
+	for (uint32_t i = 0; i < static_cast<uint32_t>(inputs.size()); ++i)
+	{
+		const auto& input = inputs[i];
+		const auto key = make_tuple(input.format, input.width, input.height, input.mipCount);
+
+		auto it = openArrays.find(key);
+		if (it == end(openArrays) || layout.arrays[it->second].inputs.size() >= maxSlices)
+		{
+			TexturePackArray textureArray;
+			textureArray.format = input.format;
+			textureArray.width = input.width;
+			textureArray.height = input.height;
+			textureArray.mipCount = input.mipCount;
+
+			openArrays[key] = static_cast<uint32_t>(layout.arrays.size());
+			layout.arrays.push_back(move(textureArray));
+		}
+
+		const uint32_t arrayIndex = openArrays[key];
+		auto& textureArray = layout.arrays[arrayIndex];
+		layout.placements[i].arrayIndex = arrayIndex;
+		layout.placements[i].slice = static_cast<uint32_t>(textureArray.inputs.size());
+		textureArray.inputs.push_back(i);
+	}
+
+	return layout;
+}
+
+
+size_t CountDescriptorTableUpdates(const vector<uint32_t>& drawTables)
+{
+	size_t updates = 0;
+	for (size_t i = 0; i < drawTables.size(); ++i)
+	{
+		if (i == 0 || drawTables[i] != drawTables[i - 1])
+		{
+			++updates;
+		}
+	}
+	return updates;
+}
+
+} // namespace Kodiak
\ No newline at end of file
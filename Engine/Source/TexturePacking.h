@@ -0,0 +1,69 @@
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+// Author: David Elder
+//
+
+#pragma once
+
+// Groups textures of the same format, size and mip count into texture arrays, so materials can bind
+// shared arrays and pick their slice through a constant.  The packer only sees texture descriptions, and
+// the same inputs always produce the same arrays, in the same order.  This header and TexturePacking.cpp
+// only depend on the standard library.
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Kodiak
+{
+
+// Bounded by D3D12_REQ_TEXTURE2D_ARRAY_AXIS_DIMENSION
+const uint32_t kMaxTextureArraySlices = 2048;
+
+
+struct TexturePackInput
+{
+	uint32_t	format{ 0 };		// Any value; textures only share an array if it matches
+	uint32_t	width{ 0 };
+	uint32_t	height{ 0 };
+	uint32_t	mipCount{ 0 };
+};
+
+
+struct TexturePackArray
+{
+	uint32_t				format{ 0 };
+	uint32_t				width{ 0 };
+	uint32_t				height{ 0 };
+	uint32_t				mipCount{ 0 };
+	std::vector<uint32_t>	inputs;		// Input index of each slice
+};
+
+
+struct TexturePackPlacement
+{
+	uint32_t	arrayIndex{ 0 };
+	uint32_t	slice{ 0 };
+};
+
+
+struct TexturePackLayout
+{
+	std::vector<TexturePackArray>		arrays;
+	std::vector<TexturePackPlacement>	placements;		// One per input, in input order
+};
+
+
+// Arrays are ordered by the first input that lands in them, and slices follow input order.  A group with
+// more than maxSlices textures is split across several arrays.
+TexturePackLayout PackTextureArrays(const std::vector<TexturePackInput>& inputs, uint32_t maxSlices = kMaxTextureArraySlices);
+
+// Number of times the bound descriptor table changes when drawing with the given tables in order.  Each
+// entry identifies the set of views a draw binds; the first draw always counts as a change.
+size_t CountDescriptorTableUpdates(const std::vector<uint32_t>& drawTables);
+
+} // namespace Kodiak
\ No newline at end of file
@@ -0,0 +1,87 @@
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+// Author: David Elder
+//
+
+// Built without the precompiled header, so that tools can share it
+
+#include "TextureResidency.h"
+
+#include <algorithm>
+#include <numeric>
+
+
+using namespace Kodiak;
+using namespace std;
+
+
+namespace Kodiak
+{
+
+vector<TextureResidencyDecision> TextureResidencyPolicy::Enforce(vector<TextureResidencyState>& states) const
+{
+	vector<TextureResidencyDecision> decisions;
+
+	size_t residentBytes = ComputeResidentBytes(states);
+	if (residentBytes <= m_memoryBudget)
+	{
+		return decisions;
+	}
+
+	// Oldest first
+	vector<size_t> order(states.size());
+	iota(begin(order), end(order), 0);
+	stable_sort(begin(order), end(order), [&states](size_t a, size_t b)
+	{
+		const auto& stateA = states[a];
+		const auto& stateB = states[b];
+		if (stateA.lastUsedFrame != stateB.lastUsedFrame)
+		{
+			return stateA.lastUsedFrame < stateB.lastUsedFrame;
+		}
+		return stateA.residentBytes[stateA.residentMip] > stateB.residentBytes[stateB.residentMip];
+	});
+
+	for (auto stateIndex : order)
+	{
+		if (residentBytes <= m_memoryBudget)
+		{
+			break;
+		}
+
+		auto& state = states[stateIndex];
+		if (state.pinned || state.residentMip >= state.minDetailMip)
+		{
+			continue;
+		}
+
+		uint32_t newMip = state.residentMip;
+		while (newMip < state.minDetailMip && residentBytes > m_memoryBudget)
+		{
+			residentBytes -= state.residentBytes[newMip] - state.residentBytes[newMip + 1];
+			++newMip;
+		}
+
+		state.residentMip = newMip;
+		decisions.push_back({ state.id, newMip });
+	}
+
+	return decisions;
+}
+
+
+size_t TextureResidencyPolicy::ComputeResidentBytes(const vector<TextureResidencyState>& states)
+{
+	size_t residentBytes = 0;
+	for (const auto& state : states)
+	{
+		residentBytes += state.residentBytes[state.residentMip];
+	}
+	return residentBytes;
+}
+
+} // namespace Kodiak
\ No newline at end of file
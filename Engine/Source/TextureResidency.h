@@ -0,0 +1,77 @@
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+// Author: David Elder
+//
+
+#pragma once
+
+// Least-recently-used residency for streamed textures.  Materials record the frame each texture was
+// last drawn with; when the resident total goes over budget, the textures that have gone unused the
+// longest give up their mips first.  This header and TextureResidency.cpp only depend on the standard
+// library, so the policy can be run against a simulated allocator without a GPU.
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Kodiak
+{
+
+// Mip chains are bounded by D3D12_REQ_MIP_LEVELS (15), plus one entry for "nothing resident"
+const uint32_t kMaxStreamingMips = 16;
+
+
+struct TextureResidencyState
+{
+	uint64_t	id{ 0 };
+	uint64_t	lastUsedFrame{ 0 };
+	uint32_t	residentMip{ 0 };		// Most detailed mip currently resident
+	uint32_t	minDetailMip{ 0 };		// Coarsest stage, which is never evicted
+	bool		pinned{ false };		// A stream is in flight, so the texture can't change this pass
+
+	// residentBytes[m] is the memory footprint when mip m is the most detailed resident mip
+	std::array<size_t, kMaxStreamingMips> residentBytes{};
+};
+
+
+struct TextureResidencyDecision
+{
+	uint64_t	id;
+	uint32_t	newResidentMip;
+};
+
+
+class TextureResidencyPolicy
+{
+public:
+	void SetMemoryBudget(size_t bytes) { m_memoryBudget = bytes; }
+	size_t GetMemoryBudget() const { return m_memoryBudget; }
+
+	// Textures that haven't been drawn for this many frames are idle.  Idle textures don't stream
+	// detail back in until they are used again.
+	void SetIdleFrames(uint32_t frames) { m_idleFrames = frames; }
+	uint32_t GetIdleFrames() const { return m_idleFrames; }
+
+	bool IsIdle(const TextureResidencyState& state, uint64_t currentFrame) const
+	{
+		return currentFrame > state.lastUsedFrame + m_idleFrames;
+	}
+
+	// Drops mips from the least recently used textures, one level at a time, until the resident total
+	// fits the budget or every texture is down to its minDetailMip.  Ties go to the texture holding
+	// the most memory.  The residentMip of each state is updated to reflect the returned decisions.
+	std::vector<TextureResidencyDecision> Enforce(std::vector<TextureResidencyState>& states) const;
+
+	static size_t ComputeResidentBytes(const std::vector<TextureResidencyState>& states);
+
+private:
+	size_t		m_memoryBudget{ 256 * 1024 * 1024 };
+	uint32_t	m_idleFrames{ 120 };
+};
+
+} // namespace Kodiak
\ No newline at end of file
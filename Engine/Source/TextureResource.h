@@ -11,6 +11,7 @@
 
 #include "GpuResource.h"
 #include "IAsyncResource.h"
+#include "TextureStreaming.h"
 
 namespace Kodiak
 {
@@ -19,10 +20,16 @@ namespace Kodiak
 // Forward declarations
 enum class ColorFormat;
 enum class LoadState;
+class TextureStreamer;
+#if defined(DX12)
+class BindlessDescriptor;
+#endif
 
 
-class TextureResource : public GpuResource, public IAsyncResource
+class TextureResource : public GpuResource, public IAsyncResource, public std::enable_shared_from_this<TextureResource>
 {
+	friend class TextureStreamer;
+
 public:
 	TextureResource();
 	explicit TextureResource(bool isSRGB);
@@ -42,6 +49,65 @@ public:
 
 	// IAsyncResource interface
 	bool DoLoad() final override;
+	void SetLoadPriority(float priority) final override { m_streamingPriority = priority; }
+	void CancelLoad() final override
+	{
+		// Stop streaming in detail, and let the streamer evict what's there first
+		m_streamingPriority = 0.0f;
+		m_desiredMip = kMaxStreamingMips - 1;
+	}
+
+	// Mip streaming.  The streamer favors textures with higher priority, and stops streaming
+	// in detail once desiredMip is resident.
+	void SetStreamingPriority(float priority, uint32_t desiredMip = 0)
+	{
+		m_streamingPriority = priority;
+		m_desiredMip = desiredMip;
+	}
+	float GetStreamingPriority() const { return m_streamingPriority; }
+	uint32_t GetDesiredMip() const { return m_desiredMip; }
+	uint32_t GetResidentMip() const { return m_residentMip; }
+
+	// Residency.  Materials mark their textures as they're committed on the render thread, and the
+	// streamer evicts detail from the least recently used ones when over budget.
+	void MarkUsed(uint64_t frame)
+	{
+		if (m_lastUsedFrame.load(std::memory_order_relaxed) != frame)
+		{
+			m_lastUsedFrame.store(frame, std::memory_order_relaxed);
+		}
+	}
+	uint64_t GetLastUsedFrame() const { return m_lastUsedFrame.load(std::memory_order_relaxed); }
+
+	// Textures that get copied elsewhere, e.g. into a texture array, need their whole mip chain.  Set
+	// before the load starts.  IsStreamed reports whether the loaded texture ended up streaming anyway.
+	void SetStreamingAllowed(bool allowed) { m_streamingAllowed = allowed; }
+	bool IsStreamed() const { return m_streamed; }
+
+#if defined(DX12)
+	// The bindless heap slot for the current view, shared by every material using it.  Frames in flight may
+	// read a slot, so it isn't rewritten when streamed mips are committed.  The new view gets a slot of its own,
+	// and the view changed callbacks run on the main thread so materials can point their indices at it.  The
+	// old slot is freed once the last material lets go of it and the GPU is past it.
+	std::shared_ptr<BindlessDescriptor> GetBindlessDescriptor();
+
+	// Keeps one callback per owner, replacing any earlier one.  It's dropped once it returns false.
+	void AddViewChangedCallback(const void* owner, std::function<bool()> callback);
+#endif
+
+private:
+#if defined(DX12)
+	// Returns false if the texture isn't streamable, in which case it has been loaded in full
+	bool LoadStreamingDDS(const std::string& fullpath);
+#endif
+
+	// Called by the TextureStreamer on the main thread
+	void StreamToMip(uint32_t firstMip);
+	bool IsStreamInFlight() const { return m_streamInFlight; }
+	bool IsStreamComplete() const { return m_streamComplete; }
+	void CommitStreamedMips();
+
+	static void ReleaseRetiredResources();
 
 private:
 	uint32_t m_width{ 0 };
@@ -53,6 +119,33 @@ private:
 	bool m_isSRGB{ false };
 
 	ShaderResourceViewPtr m_srv;
+
+	// Mip streaming state
+	std::atomic<float>		m_streamingPriority{ 0.0f };
+	std::atomic<uint32_t>	m_desiredMip{ 0 };
+	std::atomic<uint32_t>	m_residentMip{ 0 };
+	std::atomic<uint32_t>	m_pendingMip{ 0 };
+	std::atomic<bool>		m_streamInFlight{ false };
+	std::atomic<bool>		m_streamComplete{ false };
+	uint32_t				m_minDetailMip{ 0 };
+	std::array<size_t, kMaxStreamingMips>	m_mipResidentBytes{};
+	std::atomic<uint64_t>	m_lastUsedFrame{ 0 };
+	bool					m_streamingAllowed{ true };
+	bool					m_streamed{ false };
+
+#if defined(DX12)
+	// The next, more detailed, view is written here by the streaming task and copied over m_srv on
+	// the render thread, so materials holding m_srv switch to the new mip range atomically.
+	ShaderResourceViewPtr						m_stagingSrv;
+	Microsoft::WRL::ComPtr<ID3D12Resource>		m_streamedResource;
+
+	// Guards the bindless state.  Between the commit and its render command the current view is still in
+	// m_stagingSrv, so new slots are copied from there.
+	std::mutex									m_bindlessMutex;
+	std::weak_ptr<BindlessDescriptor>			m_bindlessDescriptor;
+	bool										m_commitPending{ false };
+	std::vector<std::pair<const void*, std::function<bool()>>>	m_viewChangedCallbacks;
+#endif
 };
 
 } // namespace Kodiak
\ No newline at end of file
@@ -11,6 +11,8 @@
 
 #include "TextureResource.h"
 
+#include "BinaryReader.h"
+#include "DDSMipGenerator.h"
 #include "DDSTextureLoader11.h"
 #include "DeviceManager11.h"
 #include "DXGIUtility.h"
@@ -122,7 +124,7 @@ void TextureResource::CreateArray(uint32_t width, uint32_t height, uint32_t arra
 	desc.SampleDesc.Count = 1;
 	desc.Usage = D3D11_USAGE_DEFAULT;
 	desc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
-	desc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+	desc.CPUAccessFlags = 0; // Default usage; slices are filled with copies
 	desc.MiscFlags = 0;
 
 	ID3D11Texture2D* texture = nullptr;
@@ -191,15 +193,49 @@ bool TextureResource::DoLoad()
 	{
 	case TextureFormat::DDS:
 
-		ThrowIfFailed(CreateDDSTextureFromFile(g_device,
-			fullpath,
-			0, // maxsize
-			m_isSRGB,
-			m_resource.GetAddressOf(),
-			m_srv.GetAddressOf()));
+		{
+			unique_ptr<uint8_t[]> ddsData;
+			size_t ddsDataSize = 0;
+			{
+				LOAD_PHASE(LoadPhase::IO);
+				ThrowIfFailed(BinaryReader::ReadEntireFile(fullpath, ddsData, &ddsDataSize));
+			}
+			LOAD_BYTES(ddsDataSize);
+
+			{
+				LOAD_PHASE(LoadPhase::Process);
+				GenerateMissingDDSMips(ddsData, ddsDataSize, m_isSRGB);
+			}
+
+			LOAD_PHASE(LoadPhase::Upload);
+			ThrowIfFailed(CreateDDSTextureFromMemory(g_device,
+				ddsData.get(),
+				ddsDataSize,
+				0, // maxsize
+				m_isSRGB,
+				m_resource.GetAddressOf(),
+				m_srv.GetAddressOf()));
+		}
 		break;
 	}
 
 	m_loadState = LoadState::LoadSucceeded;
 	return true;
-}
\ No newline at end of file
+}
+
+// Mip streaming is only implemented for DX12.  DX11 textures always load their full mip chain
+// and never register with the TextureStreamer, so these are never reached.
+void TextureResource::StreamToMip(uint32_t firstMip)
+{
+	assert_msg(false, "Mip streaming is not supported on DX11");
+}
+
+
+void TextureResource::CommitStreamedMips()
+{
+	assert_msg(false, "Mip streaming is not supported on DX11");
+}
+
+
+void TextureResource::ReleaseRetiredResources()
+{}
\ No newline at end of file
@@ -11,17 +11,27 @@
 
 #include "TextureResource.h"
 
+#include "BinaryReader.h"
+#include "BindlessDescriptorHeap12.h"
 #include "CommandList12.h"
+#include "CommandListManager12.h"
+#include "DDSCommon.h"
+#include "DDSMipGenerator.h"
 #include "DDSTextureLoader12.h"
 #include "DeviceManager12.h"
 #include "DXGIUtility.h"
 #include "Filesystem.h"
 #include "Format.h"
 #include "LoaderEnums.h"
+#include "Renderer.h"
 #include "RenderUtils.h"
+#include "TextureStreamer.h"
+
+#include <algorithm>
 
 
 using namespace Kodiak;
+using namespace Microsoft::WRL;
 using namespace std;
 
 
@@ -42,6 +52,22 @@ const string s_formatString[] =
 	"dds",
 };
 
+
+// Textures replaced by a streamed mip range can still be referenced by GPU work in flight.  They are
+// parked in s_pendingRetire when swapped out, and released once a fence issued after the swap completes.
+mutex s_retireMutex;
+vector<ComPtr<ID3D12Resource>> s_pendingRetire;
+queue<pair<uint64_t, ComPtr<ID3D12Resource>>> s_retiredResources;
+
+
+bool IsStreamable(const DDSLayout& layout)
+{
+	return (layout.dimension == kDDSDimensionTexture2D)
+		&& (layout.arraySize == 1)
+		&& (layout.mipCount > 1)
+		&& (layout.mipCount <= kMaxStreamingMips);
+}
+
 } // anonymous namespace
 
 
@@ -183,8 +209,8 @@ void TextureResource::CreateArray(uint32_t width, uint32_t height, uint32_t arra
 	srvDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
 	srvDesc.Format = dxgiFormat;
 	srvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2DARRAY;
-	srvDesc.Texture2DArray.MipLevels = 4;
-	srvDesc.Texture2DArray.ArraySize = 16;
+	srvDesc.Texture2DArray.MipLevels = numMips;
+	srvDesc.Texture2DArray.ArraySize = arraySize;
 
 	g_device->CreateShaderResourceView(m_resource.Get(), &srvDesc, m_srv);
 
@@ -230,15 +256,285 @@ bool TextureResource::DoLoad()
 
 		m_srv = DeviceManager::GetInstance().AllocateDescriptor(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
 
-		ThrowIfFailed(CreateDDSTextureFromFile(g_device,
-			fullpath,
+		if (m_streamingAllowed && TextureStreamer::GetInstance().IsEnabled())
+		{
+			if (LoadStreamingDDS(fullpath))
+			{
+				m_loadState = LoadState::LoadSucceeded;
+				m_streamed = true;
+
+				TextureStreamer::GetInstance().Register(shared_from_this());
+				return true;
+			}
+			break;
+		}
+
+		{
+			unique_ptr<uint8_t[]> ddsData;
+			size_t ddsDataSize = 0;
+			{
+				LOAD_PHASE(LoadPhase::IO);
+				ThrowIfFailed(BinaryReader::ReadEntireFile(fullpath, ddsData, &ddsDataSize));
+			}
+			LOAD_BYTES(ddsDataSize);
+
+			{
+				LOAD_PHASE(LoadPhase::Process);
+				GenerateMissingDDSMips(ddsData, ddsDataSize, m_isSRGB);
+			}
+
+			LOAD_PHASE(LoadPhase::Upload);
+			ThrowIfFailed(CreateDDSTextureFromMemory(g_device,
+				ddsData.get(),
+				ddsDataSize,
+				0, // maxsize
+				m_isSRGB,
+				m_resource.GetAddressOf(),
+				m_srv));
+		}
+		break;
+	}
+
+	m_loadState = LoadState::LoadSucceeded;
+	return true;
+}
+
+
+bool TextureResource::LoadStreamingDDS(const string& fullpath)
+{
+	unique_ptr<uint8_t[]> ddsData;
+	size_t ddsDataSize = 0;
+	{
+		LOAD_PHASE(LoadPhase::IO);
+		ThrowIfFailed(BinaryReader::ReadEntireFile(fullpath, ddsData, &ddsDataSize));
+	}
+	LOAD_BYTES(ddsDataSize);
+
+	// With a generated chain, single-mip files can stream like any other
+	{
+		LOAD_PHASE(LoadPhase::Process);
+		GenerateMissingDDSMips(ddsData, ddsDataSize, m_isSRGB);
+	}
+
+	DDSLayout layout;
+	{
+		LOAD_PHASE(LoadPhase::Parse);
+		ThrowIfFailed(DDS::GetParseResultHRESULT(ParseDDSLayout(ddsData.get(), ddsDataSize, layout)));
+	}
+
+	LOAD_PHASE(LoadPhase::Upload);
+
+	if (!IsStreamable(layout))
+	{
+		// Load the whole thing in one go, from the data we already have in memory
+		ThrowIfFailed(CreateDDSTextureFromMemory(g_device,
+			ddsData.get(),
+			ddsDataSize,
 			0, // maxsize
 			m_isSRGB,
 			m_resource.GetAddressOf(),
 			m_srv));
-		break;
+		return false;
 	}
 
-	m_loadState = LoadState::LoadSucceeded;
+	m_width = layout.width;
+	m_height = layout.height;
+	m_depth = layout.depth;
+	m_arraySize = layout.arraySize;
+	m_mipLevels = layout.mipCount;
+
+	for (uint32_t mip = 0; mip < kMaxStreamingMips; ++mip)
+	{
+		m_mipResidentBytes[mip] = (mip < layout.mipCount) ? layout.GetResidentBytes(mip) : 0;
+	}
+
+	// First stage: only the smallest mips, so the texture is usable right away
+	m_minDetailMip = SelectFirstResidentMip(layout, TextureStreamer::GetInstance().GetInitialMipDimension());
+	m_residentMip = m_minDetailMip;
+	m_pendingMip = m_minDetailMip;
+
+	ThrowIfFailed(CreateDDSTextureFromLayout(g_device,
+		ddsData.get(),
+		layout,
+		m_minDetailMip,
+		m_isSRGB,
+		m_resource.ReleaseAndGetAddressOf(),
+		m_srv));
+
+	m_stagingSrv = DeviceManager::GetInstance().AllocateDescriptor(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+
 	return true;
+}
+
+
+void TextureResource::StreamToMip(uint32_t firstMip)
+{
+	assert(!m_streamInFlight);
+
+	m_pendingMip = firstMip;
+	m_streamInFlight = true;
+
+	auto thisResource = shared_from_this();
+	concurrency::create_task([thisResource, firstMip]()
+	{
+		auto& filesystem = Filesystem::GetInstance();
+		string fullpath = filesystem.GetFullPath(thisResource->m_resourcePath);
+
+		unique_ptr<uint8_t[]> ddsData;
+		size_t ddsDataSize = 0;
+		DDSLayout layout;
+
+		HRESULT hr = BinaryReader::ReadEntireFile(fullpath, ddsData, &ddsDataSize);
+		if (SUCCEEDED(hr))
+		{
+			hr = DDS::GetParseResultHRESULT(ParseDDSLayout(ddsData.get(), ddsDataSize, layout));
+		}
+		if (SUCCEEDED(hr))
+		{
+			hr = CreateDDSTextureFromLayout(g_device,
+				ddsData.get(),
+				layout,
+				firstMip,
+				thisResource->m_isSRGB,
+				thisResource->m_streamedResource.ReleaseAndGetAddressOf(),
+				thisResource->m_stagingSrv);
+		}
+
+		if (FAILED(hr))
+		{
+			LOG_WARNING << "Failed to stream mip " << firstMip << " of texture " << thisResource->m_resourcePath;
+
+			thisResource->m_streamedResource.Reset();
+			thisResource->m_pendingMip = thisResource->m_residentMip.load();
+			thisResource->m_streamInFlight = false;
+			return;
+		}
+
+		thisResource->m_streamComplete = true;
+	});
+}
+
+
+void TextureResource::CommitStreamedMips()
+{
+	assert(m_streamComplete);
+	m_streamComplete = false;
+
+	// A bindless slot in use gets replaced by one for the new view, rather than rewritten under frames in flight
+	shared_ptr<BindlessDescriptor> descriptor;
+	vector<pair<const void*, function<bool()>>> callbacks;
+	{
+		lock_guard<mutex> CS(m_bindlessMutex);
+
+		m_commitPending = true;
+		if (!m_bindlessDescriptor.expired())
+		{
+			descriptor = make_shared<BindlessDescriptor>(m_stagingSrv);
+			m_bindlessDescriptor = descriptor;
+			swap(callbacks, m_viewChangedCallbacks);
+		}
+	}
+
+	auto thisResource = shared_from_this();
+	EnqueueRenderCommand([thisResource]()
+	{
+		// Descriptor tables are copied on the render thread, so rewriting m_srv here can't race with them
+		g_device->CopyDescriptorsSimple(1, thisResource->m_srv, thisResource->m_stagingSrv, D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+
+		{
+			lock_guard<mutex> CS(thisResource->m_bindlessMutex);
+			thisResource->m_commitPending = false;
+		}
+
+		{
+			lock_guard<mutex> CS(s_retireMutex);
+			s_pendingRetire.push_back(thisResource->m_resource);
+		}
+
+		thisResource->m_resource = move(thisResource->m_streamedResource);
+		thisResource->m_usageState = D3D12_RESOURCE_STATE_GENERIC_READ;
+		thisResource->m_residentMip = thisResource->m_pendingMip.load();
+		thisResource->m_streamInFlight = false;
+	});
+
+	if (callbacks.empty())
+	{
+		return;
+	}
+
+	// Materials queue their index changes after the command above.  Until those run, draws keep reading the old
+	// slot, which stays valid along with the old resource.
+	auto it = remove_if(begin(callbacks), end(callbacks), [](const pair<const void*, function<bool()>>& callback)
+	{
+		return !callback.second();
+	});
+	callbacks.erase(it, end(callbacks));
+
+	// Put back the ones still wanted, unless their owner registered again while they ran
+	lock_guard<mutex> CS(m_bindlessMutex);
+	for (auto& callback : callbacks)
+	{
+		auto registered = find_if(begin(m_viewChangedCallbacks), end(m_viewChangedCallbacks),
+			[&callback](const pair<const void*, function<bool()>>& other) { return other.first == callback.first; });
+		if (registered == end(m_viewChangedCallbacks))
+		{
+			m_viewChangedCallbacks.push_back(move(callback));
+		}
+	}
+}
+
+
+shared_ptr<BindlessDescriptor> TextureResource::GetBindlessDescriptor()
+{
+	lock_guard<mutex> CS(m_bindlessMutex);
+
+	auto descriptor = m_bindlessDescriptor.lock();
+	if (!descriptor)
+	{
+		descriptor = make_shared<BindlessDescriptor>(m_commitPending ? m_stagingSrv : m_srv);
+		m_bindlessDescriptor = descriptor;
+	}
+
+	return descriptor;
+}
+
+
+void TextureResource::AddViewChangedCallback(const void* owner, function<bool()> callback)
+{
+	lock_guard<mutex> CS(m_bindlessMutex);
+
+	for (auto& registered : m_viewChangedCallbacks)
+	{
+		if (registered.first == owner)
+		{
+			registered.second = move(callback);
+			return;
+		}
+	}
+
+	m_viewChangedCallbacks.push_back(make_pair(owner, move(callback)));
+}
+
+
+void TextureResource::ReleaseRetiredResources()
+{
+	auto& commandListManager = CommandListManager::GetInstance();
+
+	lock_guard<mutex> CS(s_retireMutex);
+
+	while (!s_retiredResources.empty() && commandListManager.IsFenceComplete(s_retiredResources.front().first))
+	{
+		s_retiredResources.pop();
+	}
+
+	// Everything swapped out last frame has been submitted by now, so a fence signaled here follows it
+	if (!s_pendingRetire.empty())
+	{
+		uint64_t fenceValue = commandListManager.IncrementFence();
+		for (auto& resource : s_pendingRetire)
+		{
+			s_retiredResources.push(make_pair(fenceValue, move(resource)));
+		}
+		s_pendingRetire.clear();
+	}
 }
\ No newline at end of file
@@ -0,0 +1,169 @@
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+// Author: David Elder
+//
+
+#include "Stdafx.h"
+
+#include "TextureStreamer.h"
+
+#include "TextureResource.h"
+
+
+using namespace Kodiak;
+using namespace std;
+
+
+size_t TextureStreamer::GetMemoryBudget() const
+{
+	lock_guard<mutex> CS(m_mutex);
+	return m_scheduler.GetMemoryBudget();
+}
+
+
+void TextureStreamer::SetMemoryBudget(size_t bytes)
+{
+	lock_guard<mutex> CS(m_mutex);
+	m_scheduler.SetMemoryBudget(bytes);
+	m_residency.SetMemoryBudget(bytes);
+}
+
+
+void TextureStreamer::SetIdleFrames(uint32_t frames)
+{
+	lock_guard<mutex> CS(m_mutex);
+	m_residency.SetIdleFrames(frames);
+}
+
+
+void TextureStreamer::SetMipsPerStage(uint32_t mips)
+{
+	lock_guard<mutex> CS(m_mutex);
+	m_scheduler.SetMipsPerStage(mips);
+}
+
+
+void TextureStreamer::SetMaxStreamsPerUpdate(uint32_t count)
+{
+	lock_guard<mutex> CS(m_mutex);
+	m_scheduler.SetMaxStreamsPerUpdate(count);
+}
+
+
+void TextureStreamer::Register(shared_ptr<TextureResource> resource)
+{
+	// Count new textures as used, so they aren't the first to be evicted
+	resource->MarkUsed(GetCurrentFrame());
+
+	lock_guard<mutex> CS(m_mutex);
+	m_textures.push_back(resource);
+}
+
+
+void TextureStreamer::Update()
+{
+	TextureResource::ReleaseRetiredResources();
+
+	const uint64_t frame = ++m_frame;
+
+	if (!m_enabled)
+	{
+		return;
+	}
+
+	vector<shared_ptr<TextureResource>> textures;
+	vector<MipStreamingState> states;
+
+	lock_guard<mutex> CS(m_mutex);
+
+	textures.reserve(m_textures.size());
+
+	auto it = begin(m_textures);
+	while (it != end(m_textures))
+	{
+		if (auto texture = it->lock())
+		{
+			textures.push_back(texture);
+			++it;
+		}
+		else
+		{
+			it = m_textures.erase(it);
+		}
+	}
+
+	// Commit finished streams, then get back under budget by evicting detail from the least recently
+	// used textures
+	vector<TextureResidencyState> residencyStates(textures.size());
+
+	for (size_t i = 0; i < textures.size(); ++i)
+	{
+		auto& texture = textures[i];
+
+		if (texture->IsStreamComplete())
+		{
+			texture->CommitStreamedMips();
+		}
+
+		auto& residency = residencyStates[i];
+		residency.id = i;
+		residency.lastUsedFrame = texture->GetLastUsedFrame();
+		residency.minDetailMip = texture->m_minDetailMip;
+		residency.residentBytes = texture->m_mipResidentBytes;
+		residency.pinned = texture->IsStreamInFlight();
+		residency.residentMip = residency.pinned ? texture->m_pendingMip.load() : texture->GetResidentMip();
+	}
+
+	for (const auto& eviction : m_residency.Enforce(residencyStates))
+	{
+		auto& texture = textures[eviction.id];
+		m_evictedMips += eviction.newResidentMip - texture->GetResidentMip();
+		texture->StreamToMip(eviction.newResidentMip);
+	}
+
+	// Stream in detail by priority.  Idle textures stay as they are until they're drawn again.
+	states.resize(textures.size());
+
+	for (size_t i = 0; i < textures.size(); ++i)
+	{
+		auto& texture = textures[i];
+
+		auto& state = states[i];
+		state.id = i;
+		state.priority = texture->GetStreamingPriority();
+		state.residentBytes = texture->m_mipResidentBytes;
+
+		if (texture->IsStreamInFlight())
+		{
+			// Account for the memory of the stream in flight, but don't touch the texture until it lands
+			uint32_t pendingMip = texture->m_pendingMip;
+			state.residentMip = pendingMip;
+			state.desiredMip = pendingMip;
+			state.minDetailMip = pendingMip;
+		}
+		else
+		{
+			state.residentMip = texture->GetResidentMip();
+			state.desiredMip = texture->GetDesiredMip();
+			state.minDetailMip = texture->m_minDetailMip;
+
+			if (m_residency.IsIdle(residencyStates[i], frame))
+			{
+				state.desiredMip = max<uint32_t>(state.desiredMip, state.residentMip);
+			}
+		}
+	}
+
+	auto decisions = m_scheduler.Schedule(states);
+
+	for (const auto& decision : decisions)
+	{
+		textures[decision.id]->StreamToMip(decision.newResidentMip);
+	}
+
+	m_residentBytes = MipStreamingScheduler::ComputeResidentBytes(states);
+}
\ No newline at end of file
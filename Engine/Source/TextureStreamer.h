@@ -0,0 +1,74 @@
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+// Author: David Elder
+//
+
+#pragma once
+
+#include "TextureStreaming.h"
+
+namespace Kodiak
+{
+
+// Forward declarations
+class TextureResource;
+
+
+class TextureStreamer
+{
+public:
+	static TextureStreamer& GetInstance()
+	{
+		static TextureStreamer instance;
+		return instance;
+	}
+
+	bool IsEnabled() const { return m_enabled; }
+	void SetEnabled(bool enabled) { m_enabled = enabled; }
+
+	// Textures load their mips up to this size first, and report IsReady as soon as those are resident
+	uint32_t GetInitialMipDimension() const { return m_initialMipDimension; }
+	void SetInitialMipDimension(uint32_t dimension) { m_initialMipDimension = dimension; }
+
+	size_t GetMemoryBudget() const;
+	void SetMemoryBudget(size_t bytes);
+	void SetMipsPerStage(uint32_t mips);
+	void SetMaxStreamsPerUpdate(uint32_t count);
+
+	size_t GetResidentBytes() const { return m_residentBytes; }
+
+	// Textures not drawn for this many frames stop streaming in detail until they're used again
+	void SetIdleFrames(uint32_t frames);
+
+	// Mip levels taken from least recently used textures to stay within the budget
+	uint64_t GetEvictedMipCount() const { return m_evictedMips; }
+
+	// Advanced by Update.  Materials stamp their textures with it when they're drawn.
+	uint64_t GetCurrentFrame() const { return m_frame.load(std::memory_order_relaxed); }
+
+	void Register(std::shared_ptr<TextureResource> resource);
+
+	// Commits finished streams and schedules new ones.  Called once per frame from the main thread.
+	void Update();
+
+private:
+	TextureStreamer() = default;
+
+private:
+	std::atomic<bool>		m_enabled{ false };
+	std::atomic<uint32_t>	m_initialMipDimension{ 64 };
+	std::atomic<size_t>		m_residentBytes{ 0 };
+	std::atomic<uint64_t>	m_evictedMips{ 0 };
+	std::atomic<uint64_t>	m_frame{ 0 };
+
+	mutable std::mutex								m_mutex;
+	std::vector<std::weak_ptr<TextureResource>>		m_textures;
+	MipStreamingScheduler							m_scheduler;
+	TextureResidencyPolicy							m_residency;
+};
+
+} // namespace Kodiak
\ No newline at end of file
@@ -0,0 +1,669 @@
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+// Author: David Elder
+//
+
+// Built without the precompiled header, so that tools can share it
+
+#include "TextureStreaming.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+
+using namespace Kodiak;
+using namespace std;
+
+
+namespace
+{
+
+// Hardware limits, matching the D3D 11.x/12 feature level 11 requirements
+const uint32_t s_maxMipLevels = 15;
+const uint32_t s_maxTexture1DDimension = 16384;
+const uint32_t s_maxTexture2DDimension = 16384;
+const uint32_t s_maxTexture3DDimension = 2048;
+const uint32_t s_maxTextureCubeDimension = 16384;
+const uint32_t s_maxTextureArraySize = 2048;
+
+// The file layout from dds.h, which needs the Windows SDK for DXGI_FORMAT
+const uint32_t kDDSMagic = 0x20534444;	// "DDS "
+
+const uint32_t kDDSFlagFourCC = 0x00000004;
+const uint32_t kDDSFlagRGB = 0x00000040;
+const uint32_t kDDSFlagLuminance = 0x00020000;
+const uint32_t kDDSFlagAlpha = 0x00000002;
+
+const uint32_t kDDSHeaderFlagHeight = 0x00000002;
+const uint32_t kDDSHeaderFlagVolume = 0x00800000;
+
+const uint32_t kDDSCubeMap = 0x00000200;
+const uint32_t kDDSCubeMapAllFaces = 0x0000FE00;
+
+const uint32_t kDDSMiscTextureCube = 0x4;
+
+struct DDSPixelFormat
+{
+	uint32_t	size;
+	uint32_t	flags;
+	uint32_t	fourCC;
+	uint32_t	RGBBitCount;
+	uint32_t	RBitMask;
+	uint32_t	GBitMask;
+	uint32_t	BBitMask;
+	uint32_t	ABitMask;
+};
+
+struct DDSHeader
+{
+	uint32_t		size;
+	uint32_t		flags;
+	uint32_t		height;
+	uint32_t		width;
+	uint32_t		pitchOrLinearSize;
+	uint32_t		depth;
+	uint32_t		mipMapCount;
+	uint32_t		reserved1[11];
+	DDSPixelFormat	ddspf;
+	uint32_t		caps;
+	uint32_t		caps2;
+	uint32_t		caps3;
+	uint32_t		caps4;
+	uint32_t		reserved2;
+};
+
+struct DDSHeaderDXT10
+{
+	uint32_t	dxgiFormat;
+	uint32_t	resourceDimension;
+	uint32_t	miscFlag;
+	uint32_t	arraySize;
+	uint32_t	miscFlags2;
+};
+
+static_assert(sizeof(DDSHeader) == 124, "DDS header size mismatch");
+static_assert(sizeof(DDSHeaderDXT10) == 20, "DDS DX10 extended header size mismatch");
+static_assert(kMaxDDSHeaderBytes == sizeof(uint32_t) + sizeof(DDSHeader) + sizeof(DDSHeaderDXT10), "DDS header size mismatch");
+
+
+constexpr uint32_t MakeFourCC(char ch0, char ch1, char ch2, char ch3)
+{
+	return uint32_t(uint8_t(ch0)) | (uint32_t(uint8_t(ch1)) << 8) | (uint32_t(uint8_t(ch2)) << 16) | (uint32_t(uint8_t(ch3)) << 24);
+}
+
+
+// The DXGI_FORMAT values the parser needs by name
+enum DXGIFormat : uint32_t
+{
+	kFormatUnknown = 0,
+	kFormatR32G32B32A32Float = 2,
+	kFormatR16G16B16A16Float = 10,
+	kFormatR16G16B16A16UNorm = 11,
+	kFormatR16G16B16A16SNorm = 13,
+	kFormatR32G32Float = 16,
+	kFormatR10G10B10A2UNorm = 24,
+	kFormatR8G8B8A8UNorm = 28,
+	kFormatR16G16Float = 34,
+	kFormatR16G16UNorm = 35,
+	kFormatR32Float = 41,
+	kFormatR8G8UNorm = 49,
+	kFormatR16Float = 54,
+	kFormatR16UNorm = 56,
+	kFormatR8UNorm = 61,
+	kFormatA8UNorm = 65,
+	kFormatR8G8_B8G8UNorm = 68,
+	kFormatG8R8_G8B8UNorm = 69,
+	kFormatBC1UNorm = 71,
+	kFormatBC2UNorm = 74,
+	kFormatBC3UNorm = 77,
+	kFormatBC4UNorm = 80,
+	kFormatBC4SNorm = 81,
+	kFormatBC5UNorm = 83,
+	kFormatBC5SNorm = 84,
+	kFormatB5G6R5UNorm = 85,
+	kFormatB5G5R5A1UNorm = 86,
+	kFormatB8G8R8A8UNorm = 87,
+	kFormatB8G8R8X8UNorm = 88,
+	kFormatNV12 = 103,
+	kFormatP010 = 104,
+	kFormatP016 = 105,
+	kFormat420Opaque = 106,
+	kFormatYUY2 = 107,
+	kFormatY210 = 108,
+	kFormatY216 = 109,
+	kFormatNV11 = 110,
+	kFormatAI44 = 111,
+	kFormatIA44 = 112,
+	kFormatP8 = 113,
+	kFormatA8P8 = 114,
+	kFormatB4G4R4A4UNorm = 115
+};
+
+
+// Same as DXGIUtility::BitsPerPixel, indexed by DXGI_FORMAT
+const uint8_t s_bitsPerPixel[] =
+{
+	0,							// UNKNOWN
+	128, 128, 128, 128,			// R32G32B32A32
+	96, 96, 96, 96,				// R32G32B32
+	64, 64, 64, 64, 64, 64,		// R16G16B16A16
+	64, 64, 64, 64,				// R32G32
+	64, 64, 64, 64,				// R32G8X24 and its depth/stencil views
+	32, 32, 32,					// R10G10B10A2
+	32,							// R11G11B10_FLOAT
+	32, 32, 32, 32, 32, 32,		// R8G8B8A8
+	32, 32, 32, 32, 32, 32,		// R16G16
+	32, 32, 32, 32, 32,			// R32 and D32_FLOAT
+	32, 32, 32, 32,				// R24G8 and its depth/stencil views
+	16, 16, 16, 16, 16,			// R8G8
+	16, 16, 16, 16, 16, 16, 16,	// R16 and D16_UNORM
+	8, 8, 8, 8, 8,				// R8
+	8,							// A8_UNORM
+	1,							// R1_UNORM
+	32,							// R9G9B9E5_SHAREDEXP
+	32, 32,						// R8G8_B8G8, G8R8_G8B8
+	4, 4, 4,					// BC1
+	8, 8, 8,					// BC2
+	8, 8, 8,					// BC3
+	4, 4, 4,					// BC4
+	8, 8, 8,					// BC5
+	16, 16,						// B5G6R5, B5G5R5A1
+	32, 32, 32,					// B8G8R8A8, B8G8R8X8, R10G10B10_XR_BIAS_A2
+	32, 32, 32, 32,				// B8G8R8A8 and B8G8R8X8 typeless and sRGB
+	8, 8, 8,					// BC6H
+	8, 8, 8,					// BC7
+	32, 32, 64,					// AYUV, Y410, Y416
+	12, 24, 24, 12,				// NV12, P010, P016, 420_OPAQUE
+	32, 64, 64,					// YUY2, Y210, Y216
+	12,							// NV11
+	8, 8, 8, 16,				// AI44, IA44, P8, A8P8
+	16							// B4G4R4A4
+};
+
+static_assert(sizeof(s_bitsPerPixel) == kFormatB4G4R4A4UNorm + 1, "Bits per pixel table doesn't cover every format");
+
+
+uint32_t GetBitsPerPixel(uint32_t format)
+{
+	return (format < sizeof(s_bitsPerPixel)) ? s_bitsPerPixel[format] : 0;
+}
+
+
+// Same as DDS::GetSurfaceInfo
+void GetSurfaceInfo(uint32_t width, uint32_t height, uint32_t format, size_t& numBytes, size_t& rowBytes, size_t& numRows)
+{
+	size_t blockBytes = 0;
+	bool packed = false;
+	bool planar = false;
+	size_t bytesPerElement = 0;
+
+	if ((format >= 70 && format <= 72) || (format >= 79 && format <= 81))
+	{
+		// BC1 and BC4
+		blockBytes = 8;
+	}
+	else if ((format >= 73 && format <= 84) || (format >= 94 && format <= 99))
+	{
+		// BC2, BC3, BC5, BC6H and BC7
+		blockBytes = 16;
+	}
+	else if (format == kFormatR8G8_B8G8UNorm || format == kFormatG8R8_G8B8UNorm || format == kFormatYUY2)
+	{
+		packed = true;
+		bytesPerElement = 4;
+	}
+	else if (format == kFormatY210 || format == kFormatY216)
+	{
+		packed = true;
+		bytesPerElement = 8;
+	}
+	else if (format == kFormatNV12 || format == kFormat420Opaque)
+	{
+		planar = true;
+		bytesPerElement = 2;
+	}
+	else if (format == kFormatP010 || format == kFormatP016)
+	{
+		planar = true;
+		bytesPerElement = 4;
+	}
+
+	if (blockBytes)
+	{
+		const size_t numBlocksWide = (width > 0) ? max<size_t>(1, (width + 3) / 4) : 0;
+		const size_t numBlocksHigh = (height > 0) ? max<size_t>(1, (height + 3) / 4) : 0;
+		rowBytes = numBlocksWide * blockBytes;
+		numRows = numBlocksHigh;
+		numBytes = rowBytes * numBlocksHigh;
+	}
+	else if (packed)
+	{
+		rowBytes = ((size_t(width) + 1) >> 1) * bytesPerElement;
+		numRows = height;
+		numBytes = rowBytes * height;
+	}
+	else if (format == kFormatNV11)
+	{
+		rowBytes = ((size_t(width) + 3) >> 2) * 4;
+		numRows = size_t(height) * 2;	// Direct3D makes this simplifying assumption, although it is larger than the 4:1:1 data
+		numBytes = rowBytes * numRows;
+	}
+	else if (planar)
+	{
+		rowBytes = ((size_t(width) + 1) >> 1) * bytesPerElement;
+		numBytes = (rowBytes * height) + ((rowBytes * height + 1) >> 1);
+		numRows = height + ((size_t(height) + 1) >> 1);
+	}
+	else
+	{
+		const size_t bitsPerPixel = GetBitsPerPixel(format);
+		rowBytes = (size_t(width) * bitsPerPixel + 7) / 8;	// Round up to the nearest byte
+		numRows = height;
+		numBytes = rowBytes * height;
+	}
+}
+
+
+bool IsBitMask(const DDSPixelFormat& ddpf, uint32_t r, uint32_t g, uint32_t b, uint32_t a)
+{
+	return ddpf.RBitMask == r && ddpf.GBitMask == g && ddpf.BBitMask == b && ddpf.ABitMask == a;
+}
+
+
+// Same as DDS::GetDXGIFormat, for files without the DX10 extended header
+uint32_t GetLegacyFormat(const DDSPixelFormat& ddpf)
+{
+	if (ddpf.flags & kDDSFlagRGB)
+	{
+		// Note that sRGB formats are written using the "DX10" extended header
+		switch (ddpf.RGBBitCount)
+		{
+		case 32:
+			if (IsBitMask(ddpf, 0x000000ff, 0x0000ff00, 0x00ff0000, 0xff000000))
+			{
+				return kFormatR8G8B8A8UNorm;
+			}
+			if (IsBitMask(ddpf, 0x00ff0000, 0x0000ff00, 0x000000ff, 0xff000000))
+			{
+				return kFormatB8G8R8A8UNorm;
+			}
+			if (IsBitMask(ddpf, 0x00ff0000, 0x0000ff00, 0x000000ff, 0x00000000))
+			{
+				return kFormatB8G8R8X8UNorm;
+			}
+
+			// D3DX writes 10:10:10:2 with the red and blue masks swapped, so this is R10G10B10A2
+			if (IsBitMask(ddpf, 0x3ff00000, 0x000ffc00, 0x000003ff, 0xc0000000))
+			{
+				return kFormatR10G10B10A2UNorm;
+			}
+			if (IsBitMask(ddpf, 0x0000ffff, 0xffff0000, 0x00000000, 0x00000000))
+			{
+				return kFormatR16G16UNorm;
+			}
+			if (IsBitMask(ddpf, 0xffffffff, 0x00000000, 0x00000000, 0x00000000))
+			{
+				// Only 32-bit color channel format in D3D9 was R32F
+				return kFormatR32Float;
+			}
+			break;
+
+		case 16:
+			if (IsBitMask(ddpf, 0x7c00, 0x03e0, 0x001f, 0x8000))
+			{
+				return kFormatB5G5R5A1UNorm;
+			}
+			if (IsBitMask(ddpf, 0xf800, 0x07e0, 0x001f, 0x0000))
+			{
+				return kFormatB5G6R5UNorm;
+			}
+			if (IsBitMask(ddpf, 0x0f00, 0x00f0, 0x000f, 0xf000))
+			{
+				return kFormatB4G4R4A4UNorm;
+			}
+			break;
+		}
+	}
+	else if (ddpf.flags & kDDSFlagLuminance)
+	{
+		if (ddpf.RGBBitCount == 8 && IsBitMask(ddpf, 0x000000ff, 0x00000000, 0x00000000, 0x00000000))
+		{
+			return kFormatR8UNorm;
+		}
+
+		if (ddpf.RGBBitCount == 16)
+		{
+			if (IsBitMask(ddpf, 0x0000ffff, 0x00000000, 0x00000000, 0x00000000))
+			{
+				return kFormatR16UNorm;
+			}
+			if (IsBitMask(ddpf, 0x000000ff, 0x00000000, 0x00000000, 0x0000ff00))
+			{
+				return kFormatR8G8UNorm;
+			}
+		}
+	}
+	else if (ddpf.flags & kDDSFlagAlpha)
+	{
+		if (ddpf.RGBBitCount == 8)
+		{
+			return kFormatA8UNorm;
+		}
+	}
+	else if (ddpf.flags & kDDSFlagFourCC)
+	{
+		switch (ddpf.fourCC)
+		{
+		// Premultiplied DXT2 and DXT4 are read as BC2 and BC3
+		case MakeFourCC('D', 'X', 'T', '1'): return kFormatBC1UNorm;
+		case MakeFourCC('D', 'X', 'T', '2'): return kFormatBC2UNorm;
+		case MakeFourCC('D', 'X', 'T', '3'): return kFormatBC2UNorm;
+		case MakeFourCC('D', 'X', 'T', '4'): return kFormatBC3UNorm;
+		case MakeFourCC('D', 'X', 'T', '5'): return kFormatBC3UNorm;
+		case MakeFourCC('A', 'T', 'I', '1'): return kFormatBC4UNorm;
+		case MakeFourCC('B', 'C', '4', 'U'): return kFormatBC4UNorm;
+		case MakeFourCC('B', 'C', '4', 'S'): return kFormatBC4SNorm;
+		case MakeFourCC('A', 'T', 'I', '2'): return kFormatBC5UNorm;
+		case MakeFourCC('B', 'C', '5', 'U'): return kFormatBC5UNorm;
+		case MakeFourCC('B', 'C', '5', 'S'): return kFormatBC5SNorm;
+		case MakeFourCC('R', 'G', 'B', 'G'): return kFormatR8G8_B8G8UNorm;
+		case MakeFourCC('G', 'R', 'G', 'B'): return kFormatG8R8_G8B8UNorm;
+		case MakeFourCC('Y', 'U', 'Y', '2'): return kFormatYUY2;
+
+		// D3DFORMAT values stored as the FourCC
+		case 36: return kFormatR16G16B16A16UNorm;	// D3DFMT_A16B16G16R16
+		case 110: return kFormatR16G16B16A16SNorm;	// D3DFMT_Q16W16V16U16
+		case 111: return kFormatR16Float;			// D3DFMT_R16F
+		case 112: return kFormatR16G16Float;		// D3DFMT_G16R16F
+		case 113: return kFormatR16G16B16A16Float;	// D3DFMT_A16B16G16R16F
+		case 114: return kFormatR32Float;			// D3DFMT_R32F
+		case 115: return kFormatR32G32Float;		// D3DFMT_G32R32F
+		case 116: return kFormatR32G32B32A32Float;	// D3DFMT_A32B32G32R32F
+		}
+	}
+
+	return kFormatUnknown;
+}
+
+} // anonymous namespace
+
+
+size_t DDSLayout::GetMipBytes(uint32_t mip) const
+{
+	assert(mip < mipCount);
+
+	size_t numBytes = 0;
+	for (uint32_t slice = 0; slice < arraySize; ++slice)
+	{
+		const auto& subresource = GetSubresource(slice, mip);
+		numBytes += subresource.sliceBytes * subresource.depth;
+	}
+	return numBytes;
+}
+
+
+size_t DDSLayout::GetResidentBytes(uint32_t firstMip) const
+{
+	size_t numBytes = 0;
+	for (uint32_t mip = firstMip; mip < mipCount; ++mip)
+	{
+		numBytes += GetMipBytes(mip);
+	}
+	return numBytes;
+}
+
+
+namespace Kodiak
+{
+
+DDSParseResult ParseDDSHeader(const uint8_t* headerData, size_t headerDataSize, size_t fileSize, DDSLayout& layout)
+{
+	// Need at least enough data to fill the header and magic number to be a valid DDS
+	if (!headerData || headerDataSize < (sizeof(uint32_t) + sizeof(DDSHeader)))
+	{
+		return DDSParseResult::InvalidData;
+	}
+
+	uint32_t magicNumber = 0;
+	memcpy(&magicNumber, headerData, sizeof(uint32_t));
+	if (magicNumber != kDDSMagic)
+	{
+		return DDSParseResult::InvalidData;
+	}
+
+	DDSHeader header;
+	memcpy(&header, headerData + sizeof(uint32_t), sizeof(DDSHeader));
+
+	// Verify header to validate DDS file
+	if (header.size != sizeof(DDSHeader) || header.ddspf.size != sizeof(DDSPixelFormat))
+	{
+		return DDSParseResult::InvalidData;
+	}
+
+	size_t offset = sizeof(uint32_t) + sizeof(DDSHeader);
+
+	layout.width = header.width;
+	layout.height = header.height;
+	layout.depth = header.depth;
+	layout.arraySize = 1;
+	layout.mipCount = (header.mipMapCount == 0) ? 1 : header.mipMapCount;
+	layout.format = kFormatUnknown;
+	layout.isCubeMap = false;
+	layout.subresources.clear();
+
+	if ((header.ddspf.flags & kDDSFlagFourCC) && (MakeFourCC('D', 'X', '1', '0') == header.ddspf.fourCC))
+	{
+		if (headerDataSize < offset + sizeof(DDSHeaderDXT10))
+		{
+			return DDSParseResult::InvalidData;
+		}
+
+		DDSHeaderDXT10 d3d10ext;
+		memcpy(&d3d10ext, headerData + offset, sizeof(DDSHeaderDXT10));
+		offset += sizeof(DDSHeaderDXT10);
+
+		layout.arraySize = d3d10ext.arraySize;
+		if (layout.arraySize == 0)
+		{
+			return DDSParseResult::InvalidData;
+		}
+
+		switch (d3d10ext.dxgiFormat)
+		{
+		case kFormatAI44:
+		case kFormatIA44:
+		case kFormatP8:
+		case kFormatA8P8:
+			return DDSParseResult::NotSupported;
+
+		default:
+			if (GetBitsPerPixel(d3d10ext.dxgiFormat) == 0)
+			{
+				return DDSParseResult::NotSupported;
+			}
+		}
+
+		layout.format = d3d10ext.dxgiFormat;
+
+		switch (d3d10ext.resourceDimension)
+		{
+		case kDDSDimensionTexture1D:
+			// D3DX writes 1D textures with a fixed Height of 1
+			if ((header.flags & kDDSHeaderFlagHeight) && layout.height != 1)
+			{
+				return DDSParseResult::InvalidData;
+			}
+			layout.height = layout.depth = 1;
+			break;
+
+		case kDDSDimensionTexture2D:
+			if (d3d10ext.miscFlag & kDDSMiscTextureCube)
+			{
+				layout.arraySize *= 6;
+				layout.isCubeMap = true;
+			}
+			layout.depth = 1;
+			break;
+
+		case kDDSDimensionTexture3D:
+			if (!(header.flags & kDDSHeaderFlagVolume))
+			{
+				return DDSParseResult::InvalidData;
+			}
+
+			if (layout.arraySize > 1)
+			{
+				return DDSParseResult::NotSupported;
+			}
+			break;
+
+		default:
+			return DDSParseResult::NotSupported;
+		}
+
+		layout.dimension = d3d10ext.resourceDimension;
+	}
+	else
+	{
+		layout.format = GetLegacyFormat(header.ddspf);
+
+		if (layout.format == kFormatUnknown)
+		{
+			return DDSParseResult::NotSupported;
+		}
+
+		if (header.flags & kDDSHeaderFlagVolume)
+		{
+			layout.dimension = kDDSDimensionTexture3D;
+		}
+		else
+		{
+			if (header.caps2 & kDDSCubeMap)
+			{
+				// We require all six faces to be defined
+				if ((header.caps2 & kDDSCubeMapAllFaces) != kDDSCubeMapAllFaces)
+				{
+					return DDSParseResult::NotSupported;
+				}
+
+				layout.arraySize = 6;
+				layout.isCubeMap = true;
+			}
+
+			layout.depth = 1;
+			layout.dimension = kDDSDimensionTexture2D;
+		}
+	}
+
+	// Bound sizes (for security purposes we don't trust DDS file metadata larger than the hardware requirements)
+	if (layout.mipCount > s_maxMipLevels)
+	{
+		return DDSParseResult::NotSupported;
+	}
+
+	switch (layout.dimension)
+	{
+	case kDDSDimensionTexture1D:
+		if (layout.arraySize > s_maxTextureArraySize || layout.width > s_maxTexture1DDimension)
+		{
+			return DDSParseResult::NotSupported;
+		}
+		break;
+
+	case kDDSDimensionTexture2D:
+		if (layout.isCubeMap)
+		{
+			if (layout.arraySize > s_maxTextureArraySize ||
+				layout.width > s_maxTextureCubeDimension ||
+				layout.height > s_maxTextureCubeDimension)
+			{
+				return DDSParseResult::NotSupported;
+			}
+		}
+		else if (layout.arraySize > s_maxTextureArraySize ||
+			layout.width > s_maxTexture2DDimension ||
+			layout.height > s_maxTexture2DDimension)
+		{
+			return DDSParseResult::NotSupported;
+		}
+		break;
+
+	case kDDSDimensionTexture3D:
+		if (layout.width > s_maxTexture3DDimension ||
+			layout.height > s_maxTexture3DDimension ||
+			layout.depth > s_maxTexture3DDimension)
+		{
+			return DDSParseResult::NotSupported;
+		}
+		break;
+	}
+
+	// Walk the subresources in file order (all mips of slice 0, then all mips of slice 1, ...)
+	layout.subresources.resize(layout.arraySize * layout.mipCount);
+
+	size_t curOffset = offset;
+	for (uint32_t slice = 0; slice < layout.arraySize; ++slice)
+	{
+		uint32_t w = layout.width;
+		uint32_t h = layout.height;
+		uint32_t d = layout.depth;
+
+		for (uint32_t mip = 0; mip < layout.mipCount; ++mip)
+		{
+			size_t numBytes = 0;
+			size_t rowBytes = 0;
+			size_t numRows = 0;
+			GetSurfaceInfo(w, h, layout.format, numBytes, rowBytes, numRows);
+
+			auto& subresource = layout.subresources[slice * layout.mipCount + mip];
+			subresource.width = w;
+			subresource.height = h;
+			subresource.depth = d;
+			subresource.rowBytes = rowBytes;
+			subresource.rowCount = numRows;
+			subresource.sliceBytes = numBytes;
+			subresource.dataOffset = curOffset;
+
+			curOffset += numBytes * d;
+			if (curOffset > fileSize)
+			{
+				return DDSParseResult::Truncated;
+			}
+
+			w = max<uint32_t>(1, w >> 1);
+			h = max<uint32_t>(1, h >> 1);
+			d = max<uint32_t>(1, d >> 1);
+		}
+	}
+
+	return DDSParseResult::Success;
+}
+
+
+DDSParseResult ParseDDSLayout(const uint8_t* ddsData, size_t ddsDataSize, DDSLayout& layout)
+{
+	return ParseDDSHeader(ddsData, ddsDataSize, ddsDataSize, layout);
+}
+
+
+uint32_t SelectFirstResidentMip(const DDSLayout& layout, uint32_t maxDimension)
+{
+	for (uint32_t mip = 0; mip < layout.mipCount; ++mip)
+	{
+		const auto& subresource = layout.GetSubresource(0, mip);
+		if (subresource.width <= maxDimension && subresource.height <= maxDimension)
+		{
+			return mip;
+		}
+	}
+
+	// Even the smallest mip is too large, so start with that one
+	return layout.mipCount - 1;
+}
+
+} // namespace Kodiak
\ No newline at end of file
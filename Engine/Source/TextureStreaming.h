@@ -0,0 +1,94 @@
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+// Author: David Elder
+//
+
+#pragma once
+
+// CPU-side DDS layout parsing for texture streaming.  Nothing in here touches a graphics device.  The
+// mip-range selection it feeds lives in MipStreaming.h.  This header and TextureStreaming.cpp only depend
+// on the standard library, so formats are DXGI_FORMAT values held as uint32_t.
+
+#include "MipStreaming.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Kodiak
+{
+
+// DDS_RESOURCE_DIMENSION values, which match D3D12_RESOURCE_DIMENSION
+const uint32_t kDDSDimensionTexture1D = 2;
+const uint32_t kDDSDimensionTexture2D = 3;
+const uint32_t kDDSDimensionTexture3D = 4;
+
+
+enum class DDSParseResult
+{
+	Success,
+	InvalidData,		// Not a DDS file, or its headers contradict each other
+	NotSupported,		// A format, dimension or size the loaders can't handle
+	Truncated			// The subresources run past the end of the file
+};
+
+
+// Location and size of one subresource (one mip of one array slice) inside a DDS file
+struct DDSSubresource
+{
+	uint32_t	width{ 0 };
+	uint32_t	height{ 0 };
+	uint32_t	depth{ 0 };
+	size_t		rowBytes{ 0 };
+	size_t		rowCount{ 0 };		// Rows of blocks for block-compressed formats
+	size_t		sliceBytes{ 0 };
+	size_t		dataOffset{ 0 };	// From the start of the file
+};
+
+
+struct DDSLayout
+{
+	uint32_t		dimension{ 0 };		// One of kDDSDimensionTexture*
+	uint32_t		width{ 0 };
+	uint32_t		height{ 0 };
+	uint32_t		depth{ 0 };
+	uint32_t		arraySize{ 0 };
+	uint32_t		mipCount{ 0 };
+	uint32_t		format{ 0 };		// DXGI_FORMAT
+	bool			isCubeMap{ false };
+
+	// Indexed by arraySlice * mipCount + mip
+	std::vector<DDSSubresource> subresources;
+
+	const DDSSubresource& GetSubresource(uint32_t arraySlice, uint32_t mip) const
+	{
+		return subresources[arraySlice * mipCount + mip];
+	}
+
+	// Size of a single mip level, summed over all array slices and depth slices
+	size_t GetMipBytes(uint32_t mip) const;
+
+	// Size of the mip range [firstMip, mipCount), i.e. what is resident when firstMip is the most detailed mip
+	size_t GetResidentBytes(uint32_t firstMip) const;
+};
+
+
+// Parses and validates the headers of an in-memory DDS file and computes the offset of every subresource
+DDSParseResult ParseDDSLayout(const uint8_t* ddsData, size_t ddsDataSize, DDSLayout& layout);
+
+// Magic number, DDS_HEADER and DDS_HEADER_DXT10.  Enough of a file for ParseDDSHeader.
+const size_t kMaxDDSHeaderBytes = 148;
+
+// Same as ParseDDSLayout, from just the start of the file.  headerData needs to hold the headers, and
+// fileSize is only used to check that the subresources fit in the file.
+DDSParseResult ParseDDSHeader(const uint8_t* headerData, size_t headerDataSize, size_t fileSize, DDSLayout& layout);
+
+// Returns the most detailed mip whose width and height both fit within maxDimension.  This is the
+// first streaming stage, uploaded before the texture reports IsReady.
+uint32_t SelectFirstResidentMip(const DDSLayout& layout, uint32_t maxDimension);
+
+} // namespace Kodiak
\ No newline at end of file
@@ -85,18 +85,23 @@ private:
 class VertexBufferDataRaw : public BaseVertexBufferData
 {
 public:
+	// With null data, the buffer is created uninitialized
 	VertexBufferDataRaw(const byte* data, size_t stride, size_t sizeInBytes)
 	{
 		m_id = s_baseId++;
 
 		m_elementSize = stride;
 		m_numElements = sizeInBytes / stride;
-		m_data = (byte*)_aligned_malloc(m_elementSize * m_numElements, 16);
 
-		assert(m_data);
-		if (m_data)
+		if (data)
 		{
-			memcpy(m_data, data, m_elementSize * m_numElements);
+			m_data = (byte*)_aligned_malloc(m_elementSize * m_numElements, 16);
+
+			assert(m_data);
+			if (m_data)
+			{
+				memcpy(m_data, data, m_elementSize * m_numElements);
+			}
 		}
 	}
 
@@ -36,4 +36,24 @@ struct VertexPositionNormalColor
 	Math::Vector3 color;
 };
 
+
+// Input layout formats for the QuantizedVertex semantics (see VertexQuantization.h).  Returns
+// DXGI_FORMAT_UNKNOWN for other semantics, whose formats come from the shader signature.
+inline DXGI_FORMAT GetQuantizedVertexFormat(const std::string& upperCaseSemanticName)
+{
+	if (upperCaseSemanticName == "QPOSITION")
+	{
+		return DXGI_FORMAT_R16G16B16A16_UNORM;
+	}
+	else if (upperCaseSemanticName == "QTEXCOORD")
+	{
+		return DXGI_FORMAT_R16G16_FLOAT;
+	}
+	else if (upperCaseSemanticName == "QNORMAL" || upperCaseSemanticName == "QTANGENT")
+	{
+		return DXGI_FORMAT_R16G16_SNORM;
+	}
+	return DXGI_FORMAT_UNKNOWN;
+}
+
 } // namespace Kodiak
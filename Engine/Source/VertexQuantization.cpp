@@ -0,0 +1,201 @@
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+// Author: David Elder
+//
+
+// Built without the precompiled header, so that the cooker can share it
+
+#include "VertexQuantization.h"
+
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+
+
+using namespace Kodiak;
+using namespace std;
+
+
+namespace
+{
+
+void ReadFloats(const uint8_t* vertex, size_t offset, float* values, size_t count)
+{
+	memcpy(values, vertex + offset, count * sizeof(float));
+}
+
+
+uint16_t ToUnorm16(float value)
+{
+	value = value < 0.0f ? 0.0f : (value > 1.0f ? 1.0f : value);
+	return static_cast<uint16_t>(value * 65535.0f + 0.5f);
+}
+
+
+int16_t ToSnorm16(float value)
+{
+	value = value < -1.0f ? -1.0f : (value > 1.0f ? 1.0f : value);
+	return static_cast<int16_t>(lroundf(value * 32767.0f));
+}
+
+} // anonymous namespace
+
+
+namespace Kodiak
+{
+
+QuantizationBounds ComputePositionBounds(const uint8_t* vertexData, const FloatVertexLayout& layout, size_t vertexCount)
+{
+	QuantizationBounds bounds;
+	for (uint32_t i = 0; i < 3; ++i)
+	{
+		bounds.min[i] = vertexCount > 0 ? FLT_MAX : 0.0f;
+		bounds.max[i] = vertexCount > 0 ? -FLT_MAX : 0.0f;
+	}
+
+	for (size_t v = 0; v < vertexCount; ++v)
+	{
+		float position[3];
+		ReadFloats(vertexData + v * layout.stride, layout.position, position, 3);
+
+		for (uint32_t i = 0; i < 3; ++i)
+		{
+			bounds.min[i] = position[i] < bounds.min[i] ? position[i] : bounds.min[i];
+			bounds.max[i] = position[i] > bounds.max[i] ? position[i] : bounds.max[i];
+		}
+	}
+
+	return bounds;
+}
+
+
+void QuantizeVertices(const uint8_t* vertexData, const FloatVertexLayout& layout, size_t vertexCount,
+	const QuantizationBounds& bounds, QuantizedVertex* output)
+{
+	float invExtent[3];
+	for (uint32_t i = 0; i < 3; ++i)
+	{
+		const float extent = bounds.max[i] - bounds.min[i];
+		invExtent[i] = extent > 0.0f ? 1.0f / extent : 0.0f;
+	}
+
+	for (size_t v = 0; v < vertexCount; ++v)
+	{
+		const uint8_t* vertex = vertexData + v * layout.stride;
+
+		float position[3], texcoord[2], normal[3], tangent[3], bitangent[3];
+		ReadFloats(vertex, layout.position, position, 3);
+		ReadFloats(vertex, layout.texcoord, texcoord, 2);
+		ReadFloats(vertex, layout.normal, normal, 3);
+		ReadFloats(vertex, layout.tangent, tangent, 3);
+		ReadFloats(vertex, layout.bitangent, bitangent, 3);
+
+		QuantizedVertex& quantized = output[v];
+
+		for (uint32_t i = 0; i < 3; ++i)
+		{
+			quantized.position[i] = ToUnorm16((position[i] - bounds.min[i]) * invExtent[i]);
+		}
+
+		// The bitangent is rebuilt from the normal and tangent, so only its handedness is kept
+		const float cross[3] = {
+			normal[1] * tangent[2] - normal[2] * tangent[1],
+			normal[2] * tangent[0] - normal[0] * tangent[2],
+			normal[0] * tangent[1] - normal[1] * tangent[0] };
+		const float handedness = cross[0] * bitangent[0] + cross[1] * bitangent[1] + cross[2] * bitangent[2];
+		quantized.position[3] = handedness < 0.0f ? 0 : 65535;
+
+		quantized.texcoord[0] = FloatToHalf(texcoord[0]);
+		quantized.texcoord[1] = FloatToHalf(texcoord[1]);
+
+		EncodeOctahedral(normal, quantized.normal);
+		EncodeOctahedral(tangent, quantized.tangent);
+	}
+}
+
+
+uint16_t FloatToHalf(float value)
+{
+	uint32_t bits;
+	memcpy(&bits, &value, sizeof(bits));
+
+	const uint16_t sign = static_cast<uint16_t>((bits >> 16) & 0x8000);
+	const uint32_t absBits = bits & 0x7FFFFFFF;
+
+	// Infinity and NaN
+	if (absBits >= 0x7F800000)
+	{
+		return sign | 0x7C00 | (absBits > 0x7F800000 ? 0x0200 : 0);
+	}
+
+	// Too large for a half
+	if (absBits >= 0x47800000)
+	{
+		return sign | 0x7C00;
+	}
+
+	// Denormal halves, or zero
+	if (absBits < 0x38800000)
+	{
+		if (absBits < 0x33000000)
+		{
+			return sign;
+		}
+
+		const uint32_t exponent = absBits >> 23;
+		const uint32_t mantissa = (absBits & 0x007FFFFF) | 0x00800000;
+		const uint32_t shift = 126 - exponent;
+
+		uint32_t half = mantissa >> shift;
+		const uint32_t remainder = mantissa & ((1u << shift) - 1);
+		const uint32_t halfway = 1u << (shift - 1);
+		if (remainder > halfway || (remainder == halfway && (half & 1)))
+		{
+			++half;
+		}
+		return sign | static_cast<uint16_t>(half);
+	}
+
+	// Rebias the exponent and round to nearest even.  A carry out of the mantissa correctly bumps the
+	// exponent, up to infinity.
+	uint32_t half = (absBits - 0x38000000) >> 13;
+	const uint32_t remainder = absBits & 0x1FFF;
+	if (remainder > 0x1000 || (remainder == 0x1000 && (half & 1)))
+	{
+		++half;
+	}
+	return sign | static_cast<uint16_t>(half);
+}
+
+
+void EncodeOctahedral(const float direction[3], int16_t encoded[2])
+{
+	const float length = fabsf(direction[0]) + fabsf(direction[1]) + fabsf(direction[2]);
+	if (length == 0.0f)
+	{
+		encoded[0] = 0;
+		encoded[1] = 0;
+		return;
+	}
+
+	float x = direction[0] / length;
+	float y = direction[1] / length;
+
+	// Fold the lower hemisphere over the diagonals
+	if (direction[2] < 0.0f)
+	{
+		const float foldedX = (1.0f - fabsf(y)) * (x >= 0.0f ? 1.0f : -1.0f);
+		const float foldedY = (1.0f - fabsf(x)) * (y >= 0.0f ? 1.0f : -1.0f);
+		x = foldedX;
+		y = foldedY;
+	}
+
+	encoded[0] = ToSnorm16(x);
+	encoded[1] = ToSnorm16(y);
+}
+
+} // namespace Kodiak
\ No newline at end of file
@@ -0,0 +1,66 @@
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+// Author: David Elder
+//
+
+#pragma once
+
+// Compact vertex layout for static meshes.  Shared with the ModelCooker tool, so this header and
+// VertexQuantization.cpp only depend on the standard library.
+//
+// Shaders read the layout through the QPOSITION, QTEXCOORD, QNORMAL and QTANGENT semantics, declared
+// in that order, and decode it with the helpers in Shaders/Common/VertexQuantization.hlsli.
+
+#include <cstddef>
+#include <cstdint>
+
+namespace Kodiak
+{
+
+struct QuantizedVertex
+{
+	uint16_t	position[4];	// R16G16B16A16_UNORM.  xyz within the mesh bounds, w is the bitangent sign (0 or 1)
+	uint16_t	texcoord[2];	// R16G16_FLOAT
+	int16_t		normal[2];		// R16G16_SNORM, octahedral
+	int16_t		tangent[2];		// R16G16_SNORM, octahedral
+};
+
+static_assert(sizeof(QuantizedVertex) == 20, "QuantizedVertex layout changed");
+
+
+// Where each attribute of a float vertex lives.  Positions, normals, tangents and bitangents are
+// float3s, texcoords are float2s.
+struct FloatVertexLayout
+{
+	size_t stride;
+	size_t position;
+	size_t texcoord;
+	size_t normal;
+	size_t tangent;
+	size_t bitangent;
+};
+
+
+// Positions are stored relative to these bounds; shaders undo it with position * scale + bias,
+// where scale is max - min and bias is min
+struct QuantizationBounds
+{
+	float min[3];
+	float max[3];
+};
+
+QuantizationBounds ComputePositionBounds(const uint8_t* vertexData, const FloatVertexLayout& layout, size_t vertexCount);
+
+void QuantizeVertices(const uint8_t* vertexData, const FloatVertexLayout& layout, size_t vertexCount,
+	const QuantizationBounds& bounds, QuantizedVertex* output);
+
+
+// Encoders, exposed for tools
+uint16_t FloatToHalf(float value);
+void EncodeOctahedral(const float direction[3], int16_t encoded[2]);
+
+} // namespace Kodiak
\ No newline at end of file
@@ -0,0 +1,615 @@
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+// Author: David Elder
+//
+
+// Converts H3D models into the load-in-place .kmdl format described in Engine/Source/CookedModel.h.
+// Each mesh's triangles and vertices are reordered on the way through (see MeshOptimizer.h), and the
+// vertex cache stats before and after are printed.  Meshes are then split into meshlets (see Meshlet.h)
+// for the runtime to cull.  With -quantize, vertices are converted to the QuantizedVertex layout in
+// VertexQuantization.h.
+//
+//   ModelCooker [-quantize] <input.h3d> <output.kmdl>
+//
+// Only the standard library is used, so the cooker also builds outside Visual Studio, e.g.
+//   g++ -std=c++14 -O2 -IEngine/Source ModelCooker/Source/Main.cpp Engine/Source/MeshOptimizer.cpp
+//     Engine/Source/Meshlet.cpp Engine/Source/VertexQuantization.cpp -o ModelCooker
+
+#include "CookedModel.h"
+#include "MeshOptimizer.h"
+#include "Meshlet.h"
+#include "VertexQuantization.h"
+
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using namespace Kodiak;
+using namespace std;
+
+
+namespace
+{
+
+// Bounds-checked reads from the H3D file.  Like the runtime loader, this assumes a little-endian host.
+class Reader
+{
+public:
+	Reader(const vector<uint8_t>& data)
+		: m_pos(data.data())
+		, m_end(data.data() + data.size())
+	{}
+
+	const uint8_t* ReadBytes(size_t size)
+	{
+		if (size > static_cast<size_t>(m_end - m_pos))
+		{
+			throw runtime_error("unexpected end of file");
+		}
+		const uint8_t* ret = m_pos;
+		m_pos += size;
+		return ret;
+	}
+
+	template <typename T> T Read()
+	{
+		T value;
+		memcpy(&value, ReadBytes(sizeof(T)), sizeof(T));
+		return value;
+	}
+
+	// Fixed-size, NUL-padded string field
+	string ReadString(size_t fieldSize)
+	{
+		const char* str = reinterpret_cast<const char*>(ReadBytes(fieldSize));
+		return string(str, strnlen(str, fieldSize));
+	}
+
+	void Skip(size_t size) { ReadBytes(size); }
+
+private:
+	const uint8_t* m_pos;
+	const uint8_t* m_end;
+};
+
+
+// H3D layout, as read by LoadModelH3D
+namespace H3D
+{
+
+const size_t kAttribSize = 8;
+const size_t kMaxAttribs = 16;
+const size_t kMaxTexPath = 128;
+const size_t kMaxMaterialName = 128;
+
+enum
+{
+	kAttribPosition = 0,
+	kAttribTexcoord0 = 1,
+	kAttribNormal = 2,
+	kAttribTangent = 3,
+	kAttribBitangent = 4,
+};
+
+const uint16_t kAttribFormatFloat = 5;
+
+struct Attrib
+{
+	uint16_t offset;
+	uint16_t normalized;
+	uint16_t components;
+	uint16_t format;
+};
+
+struct BoundingBox
+{
+	float min[4];
+	float max[4];
+};
+
+struct Header
+{
+	uint32_t meshCount;
+	uint32_t materialCount;
+	uint32_t vertexDataByteSize;
+	uint32_t indexDataByteSize;
+	uint32_t vertexDataByteSizeDepth;
+	BoundingBox boundingBox;
+};
+
+struct Mesh
+{
+	BoundingBox boundingBox;
+	uint32_t materialIndex;
+	uint32_t attribsEnabled;
+	uint32_t vertexStride;
+	Attrib attrib[kMaxAttribs];
+	uint32_t vertexDataByteOffset;
+	uint32_t vertexCount;
+	uint32_t indexDataByteOffset;
+	uint32_t indexCount;
+};
+
+struct Material
+{
+	string texDiffusePath;
+	string texSpecularPath;
+	string texNormalPath;
+	string name;
+};
+
+
+BoundingBox ReadBoundingBox(Reader& reader)
+{
+	return reader.Read<BoundingBox>();
+}
+
+
+Header ReadHeader(Reader& reader)
+{
+	Header header;
+	header.meshCount = reader.Read<uint32_t>();
+	header.materialCount = reader.Read<uint32_t>();
+	header.vertexDataByteSize = reader.Read<uint32_t>();
+	header.indexDataByteSize = reader.Read<uint32_t>();
+	header.vertexDataByteSizeDepth = reader.Read<uint32_t>();
+	reader.Skip(3 * sizeof(uint32_t)); // Padding
+	header.boundingBox = ReadBoundingBox(reader);
+	return header;
+}
+
+
+Mesh ReadMesh(Reader& reader)
+{
+	Mesh mesh;
+	mesh.boundingBox = ReadBoundingBox(reader);
+	mesh.materialIndex = reader.Read<uint32_t>();
+	mesh.attribsEnabled = reader.Read<uint32_t>();
+	reader.Skip(sizeof(uint32_t)); // attribsEnabledDepth
+	mesh.vertexStride = reader.Read<uint32_t>();
+	reader.Skip(sizeof(uint32_t)); // vertexStrideDepth
+	for (auto& attrib : mesh.attrib)
+	{
+		attrib = reader.Read<Attrib>();
+	}
+	reader.Skip(kMaxAttribs * kAttribSize); // attribDepth
+	mesh.vertexDataByteOffset = reader.Read<uint32_t>();
+	mesh.vertexCount = reader.Read<uint32_t>();
+	mesh.indexDataByteOffset = reader.Read<uint32_t>();
+	mesh.indexCount = reader.Read<uint32_t>();
+	reader.Skip(2 * sizeof(uint32_t)); // vertexDataByteOffsetDepth, vertexCountDepth
+	reader.Skip(sizeof(uint32_t)); // Padding
+	return mesh;
+}
+
+
+Material ReadMaterial(Reader& reader)
+{
+	Material material;
+	reader.Skip(5 * 4 * sizeof(float)); // diffuse, specular, ambient, emissive, transparent
+	reader.Skip(3 * sizeof(float)); // opacity, shininess, specularStrength
+	material.texDiffusePath = reader.ReadString(kMaxTexPath);
+	material.texSpecularPath = reader.ReadString(kMaxTexPath);
+	reader.Skip(kMaxTexPath); // texEmissivePath
+	material.texNormalPath = reader.ReadString(kMaxTexPath);
+	reader.Skip(2 * kMaxTexPath); // texLightmapPath, texReflectionPath
+	material.name = reader.ReadString(kMaxMaterialName);
+	reader.Skip(sizeof(uint32_t)); // Padding
+	return material;
+}
+
+} // namespace H3D
+
+
+// Matches the runtime H3D loader: paths without an extension are DDS files
+string BuildTexturePath(const string& basePath)
+{
+	if (basePath.rfind('.') == string::npos)
+	{
+		return basePath + ".dds";
+	}
+	return basePath;
+}
+
+
+class StringTable
+{
+public:
+	StringTable()
+	{
+		Add("");
+	}
+
+	// Returns the offset of str within the table
+	uint32_t Add(const string& str)
+	{
+		auto it = m_offsets.find(str);
+		if (it != end(m_offsets))
+		{
+			return it->second;
+		}
+
+		uint32_t offset = static_cast<uint32_t>(m_data.size());
+		m_data.insert(end(m_data), begin(str), end(str));
+		m_data.push_back('\0');
+		m_offsets[str] = offset;
+		return offset;
+	}
+
+	const vector<char>& GetData() const { return m_data; }
+
+private:
+	vector<char>						m_data;
+	unordered_map<string, uint32_t>		m_offsets;
+};
+
+
+void PrintStats(const char* label, const VertexCacheStats& before, const VertexCacheStats& after)
+{
+	cout << "  " << label << fixed << setprecision(3)
+		<< ": ACMR " << before.acmr << " -> " << after.acmr
+		<< ", ATVR " << before.atvr << " -> " << after.atvr << endl;
+}
+
+
+// Byte offset of the mesh's float3 positions within a vertex, or kNoPositionOffset if it doesn't have them
+size_t GetPositionOffset(const H3D::Mesh& h3dMesh)
+{
+	const auto& position = h3dMesh.attrib[H3D::kAttribPosition];
+	return (position.format == H3D::kAttribFormatFloat && position.components >= 3 &&
+		position.offset + 3 * sizeof(float) <= h3dMesh.vertexStride) ? position.offset : kNoPositionOffset;
+}
+
+
+// Reorders each mesh's triangles and vertices in place.  Meshes own disjoint ranges of both buffers.
+void OptimizeMeshes(const vector<H3D::Mesh>& h3dMeshes, vector<uint8_t>& vertexData, vector<uint8_t>& indexData)
+{
+	VertexCacheStats totalBefore;
+	VertexCacheStats totalAfter;
+
+	for (size_t i = 0; i < h3dMeshes.size(); ++i)
+	{
+		const auto& h3dMesh = h3dMeshes[i];
+		const size_t positionOffset = GetPositionOffset(h3dMesh);
+
+		auto result = OptimizeMesh(
+			reinterpret_cast<uint16_t*>(indexData.data() + h3dMesh.indexDataByteOffset),
+			h3dMesh.indexCount,
+			vertexData.data() + h3dMesh.vertexDataByteOffset,
+			h3dMesh.vertexStride,
+			h3dMesh.vertexCount,
+			positionOffset);
+
+		AccumulateVertexCacheStats(totalBefore, result.before);
+		AccumulateVertexCacheStats(totalAfter, result.after);
+
+		const string label = "Mesh " + to_string(i);
+		PrintStats(label.c_str(), result.before, result.after);
+	}
+
+	PrintStats("All meshes", totalBefore, totalAfter);
+}
+
+
+// Splits each mesh into meshlets, reordering its triangles in place, and records the mesh's run of the
+// meshlet table.  Run it after OptimizeMeshes and before quantization, while positions are still floats.
+// Meshes without float positions are left whole.
+void BuildMeshMeshlets(const vector<H3D::Mesh>& h3dMeshes, vector<CookedModel::Mesh>& meshes, const vector<uint8_t>& vertexData,
+	vector<uint8_t>& indexData, vector<Meshlet>& meshlets)
+{
+	size_t triangleCount = 0;
+	size_t vertexCount = 0;
+
+	for (size_t i = 0; i < h3dMeshes.size(); ++i)
+	{
+		const auto& h3dMesh = h3dMeshes[i];
+		const size_t positionOffset = GetPositionOffset(h3dMesh);
+		if (positionOffset == kNoPositionOffset)
+		{
+			continue;
+		}
+
+		auto meshMeshlets = BuildMeshlets(
+			reinterpret_cast<uint16_t*>(indexData.data() + h3dMesh.indexDataByteOffset),
+			h3dMesh.indexCount,
+			vertexData.data() + h3dMesh.vertexDataByteOffset + positionOffset,
+			h3dMesh.vertexStride,
+			h3dMesh.vertexCount);
+
+		meshes[i].firstMeshlet = static_cast<uint32_t>(meshlets.size());
+		meshes[i].meshletCount = static_cast<uint32_t>(meshMeshlets.size());
+
+		for (const auto& meshlet : meshMeshlets)
+		{
+			triangleCount += meshlet.triangleCount;
+			vertexCount += meshlet.vertexCount;
+		}
+		meshlets.insert(meshlets.end(), meshMeshlets.begin(), meshMeshlets.end());
+	}
+
+	if (!meshlets.empty())
+	{
+		cout << "  " << meshlets.size() << " meshlets, averaging " << (triangleCount / meshlets.size()) << " triangles and "
+			<< (vertexCount / meshlets.size()) << " vertices" << endl;
+	}
+}
+
+
+// Quantization needs float positions, texcoords, normals, tangents and bitangents
+FloatVertexLayout GetFloatVertexLayout(const H3D::Mesh& mesh)
+{
+	const uint32_t attribs[] = { H3D::kAttribPosition, H3D::kAttribTexcoord0, H3D::kAttribNormal, H3D::kAttribTangent, H3D::kAttribBitangent };
+	const uint16_t components[] = { 3, 2, 3, 3, 3 };
+
+	for (size_t i = 0; i < sizeof(attribs) / sizeof(attribs[0]); ++i)
+	{
+		const auto& attrib = mesh.attrib[attribs[i]];
+		if ((mesh.attribsEnabled & (1u << attribs[i])) == 0 || attrib.format != H3D::kAttribFormatFloat ||
+			attrib.components < components[i] || attrib.offset + components[i] * sizeof(float) > mesh.vertexStride)
+		{
+			throw runtime_error("mesh vertices can't be quantized, they need float positions, texcoords, normals, tangents and bitangents");
+		}
+	}
+
+	FloatVertexLayout layout;
+	layout.stride = mesh.vertexStride;
+	layout.position = mesh.attrib[H3D::kAttribPosition].offset;
+	layout.texcoord = mesh.attrib[H3D::kAttribTexcoord0].offset;
+	layout.normal = mesh.attrib[H3D::kAttribNormal].offset;
+	layout.tangent = mesh.attrib[H3D::kAttribTangent].offset;
+	layout.bitangent = mesh.attrib[H3D::kAttribBitangent].offset;
+	return layout;
+}
+
+
+// Replaces vertexData with QuantizedVertex data.  Each mesh's positions are quantized to its own
+// bounds, which are written back to the cooked mesh for the runtime to decode with.
+void QuantizeMeshes(const vector<H3D::Mesh>& h3dMeshes, vector<CookedModel::Mesh>& meshes, vector<uint8_t>& vertexData)
+{
+	const size_t vertexStride = h3dMeshes[0].vertexStride;
+	const size_t vertexCount = vertexData.size() / vertexStride;
+
+	vector<QuantizedVertex> quantized(vertexCount, QuantizedVertex{});
+
+	for (size_t i = 0; i < h3dMeshes.size(); ++i)
+	{
+		const auto& h3dMesh = h3dMeshes[i];
+		const FloatVertexLayout layout = GetFloatVertexLayout(h3dMesh);
+		const uint8_t* meshVertices = vertexData.data() + h3dMesh.vertexDataByteOffset;
+
+		const QuantizationBounds bounds = ComputePositionBounds(meshVertices, layout, h3dMesh.vertexCount);
+		QuantizeVertices(meshVertices, layout, h3dMesh.vertexCount, bounds, quantized.data() + meshes[i].baseVertex);
+
+		memcpy(meshes[i].boundsMin, bounds.min, sizeof(bounds.min));
+		memcpy(meshes[i].boundsMax, bounds.max, sizeof(bounds.max));
+	}
+
+	const size_t originalSize = vertexData.size();
+	vertexData.resize(quantized.size() * sizeof(QuantizedVertex));
+	memcpy(vertexData.data(), quantized.data(), vertexData.size());
+
+	cout << "  Quantized vertices: " << originalSize << " -> " << vertexData.size() << " bytes ("
+		<< (100 * vertexData.size() / originalSize) << "% of the original), vertex fetch "
+		<< vertexStride << " -> " << sizeof(QuantizedVertex) << " bytes per vertex" << endl;
+}
+
+
+uint32_t AlignUp(size_t value)
+{
+	const size_t alignment = CookedModel::kSectionAlignment;
+	return static_cast<uint32_t>((value + alignment - 1) & ~(alignment - 1));
+}
+
+
+void Cook(const vector<uint8_t>& input, bool quantize, vector<uint8_t>& output)
+{
+	Reader reader(input);
+
+	H3D::Header h3dHeader = H3D::ReadHeader(reader);
+
+	vector<H3D::Mesh> h3dMeshes;
+	for (uint32_t i = 0; i < h3dHeader.meshCount; ++i)
+	{
+		h3dMeshes.push_back(H3D::ReadMesh(reader));
+	}
+
+	vector<H3D::Material> h3dMaterials;
+	for (uint32_t i = 0; i < h3dHeader.materialCount; ++i)
+	{
+		h3dMaterials.push_back(H3D::ReadMaterial(reader));
+	}
+
+	const uint8_t* vertexBytes = reader.ReadBytes(h3dHeader.vertexDataByteSize);
+	vector<uint8_t> vertexData(vertexBytes, vertexBytes + h3dHeader.vertexDataByteSize);
+
+	const uint8_t* indexBytes = reader.ReadBytes(h3dHeader.indexDataByteSize);
+	vector<uint8_t> indexData(indexBytes, indexBytes + h3dHeader.indexDataByteSize);
+	// The depth-only vertex and index data aren't used at runtime, so they aren't cooked
+
+	if (h3dMeshes.empty())
+	{
+		throw runtime_error("model has no meshes");
+	}
+
+	// All meshes share one vertex buffer, so they must agree on the stride
+	const uint32_t vertexStride = h3dMeshes[0].vertexStride;
+
+	vector<CookedModel::Mesh> meshes;
+	for (const auto& h3dMesh : h3dMeshes)
+	{
+		if (h3dMesh.vertexStride != vertexStride ||
+			(h3dMesh.vertexDataByteOffset % vertexStride) != 0 ||
+			(h3dMesh.indexDataByteOffset % sizeof(uint16_t)) != 0 ||
+			h3dMesh.materialIndex >= h3dHeader.materialCount)
+		{
+			throw runtime_error("mesh layout isn't supported");
+		}
+
+		if (static_cast<uint64_t>(h3dMesh.vertexDataByteOffset) + static_cast<uint64_t>(h3dMesh.vertexCount) * vertexStride > vertexData.size() ||
+			static_cast<uint64_t>(h3dMesh.indexDataByteOffset) + static_cast<uint64_t>(h3dMesh.indexCount) * sizeof(uint16_t) > indexData.size() ||
+			(h3dMesh.indexCount % 3) != 0)
+		{
+			throw runtime_error("mesh data is out of range");
+		}
+
+		const uint16_t* meshIndices = reinterpret_cast<const uint16_t*>(indexData.data() + h3dMesh.indexDataByteOffset);
+		for (uint32_t i = 0; i < h3dMesh.indexCount; ++i)
+		{
+			if (meshIndices[i] >= h3dMesh.vertexCount)
+			{
+				throw runtime_error("mesh index is out of range");
+			}
+		}
+
+		CookedModel::Mesh mesh{};
+		memcpy(mesh.boundsMin, h3dMesh.boundingBox.min, sizeof(mesh.boundsMin));
+		memcpy(mesh.boundsMax, h3dMesh.boundingBox.max, sizeof(mesh.boundsMax));
+		mesh.materialIndex = h3dMesh.materialIndex;
+		mesh.indexCount = h3dMesh.indexCount;
+		mesh.startIndex = h3dMesh.indexDataByteOffset / sizeof(uint16_t);
+		mesh.baseVertex = static_cast<int32_t>(h3dMesh.vertexDataByteOffset / vertexStride);
+		meshes.push_back(mesh);
+	}
+
+	OptimizeMeshes(h3dMeshes, vertexData, indexData);
+
+	vector<Meshlet> meshlets;
+	BuildMeshMeshlets(h3dMeshes, meshes, vertexData, indexData, meshlets);
+
+	if (quantize)
+	{
+		QuantizeMeshes(h3dMeshes, meshes, vertexData);
+	}
+
+	StringTable strings;
+
+	vector<CookedModel::Material> materials;
+	for (const auto& h3dMaterial : h3dMaterials)
+	{
+		CookedModel::Material material{};
+		material.name = strings.Add(h3dMaterial.name);
+		material.texturePaths[CookedModel::kDiffuse] = strings.Add(BuildTexturePath(h3dMaterial.texDiffusePath));
+		material.texturePaths[CookedModel::kSpecular] = strings.Add(BuildTexturePath(h3dMaterial.texSpecularPath));
+		material.texturePaths[CookedModel::kSpecularFallback] = strings.Add(BuildTexturePath(h3dMaterial.texDiffusePath + "_specular"));
+		material.texturePaths[CookedModel::kNormal] = strings.Add(BuildTexturePath(h3dMaterial.texNormalPath));
+		material.texturePaths[CookedModel::kNormalFallback] = strings.Add(BuildTexturePath(h3dMaterial.texDiffusePath + "_normal"));
+		materials.push_back(material);
+	}
+
+	// Lay out the sections
+	CookedModel::Header header{};
+	header.magic = CookedModel::kMagic;
+	header.version = CookedModel::kVersion;
+	header.meshCount = static_cast<uint32_t>(meshes.size());
+	header.materialCount = static_cast<uint32_t>(materials.size());
+	header.vertexStride = quantize ? static_cast<uint32_t>(sizeof(QuantizedVertex)) : vertexStride;
+	header.indexSize = sizeof(uint16_t);
+	header.flags = quantize ? CookedModel::kFlagQuantizedVertices : 0;
+	memcpy(header.boundsMin, h3dHeader.boundingBox.min, sizeof(header.boundsMin));
+	memcpy(header.boundsMax, h3dHeader.boundingBox.max, sizeof(header.boundsMax));
+
+	size_t offset = sizeof(CookedModel::Header);
+	auto placeSection = [&offset](CookedModel::Section& section, size_t size)
+	{
+		section.offset = AlignUp(offset);
+		section.size = static_cast<uint32_t>(size);
+		offset = section.offset + size;
+	};
+
+	placeSection(header.meshes, meshes.size() * sizeof(CookedModel::Mesh));
+	placeSection(header.materials, materials.size() * sizeof(CookedModel::Material));
+	placeSection(header.strings, strings.GetData().size());
+	placeSection(header.vertexData, vertexData.size());
+	placeSection(header.indexData, indexData.size());
+	placeSection(header.meshlets, meshlets.size() * sizeof(Meshlet));
+	header.fileSize = static_cast<uint32_t>(offset);
+
+	// String offsets are relative to the file, not the table
+	for (auto& material : materials)
+	{
+		material.name += header.strings.offset;
+		for (auto& path : material.texturePaths)
+		{
+			path += header.strings.offset;
+		}
+	}
+
+	output.assign(header.fileSize, 0);
+	memcpy(output.data(), &header, sizeof(header));
+	memcpy(output.data() + header.meshes.offset, meshes.data(), header.meshes.size);
+	memcpy(output.data() + header.materials.offset, materials.data(), header.materials.size);
+	memcpy(output.data() + header.strings.offset, strings.GetData().data(), header.strings.size);
+	memcpy(output.data() + header.vertexData.offset, vertexData.data(), header.vertexData.size);
+	memcpy(output.data() + header.indexData.offset, indexData.data(), header.indexData.size);
+	if (!meshlets.empty())
+	{
+		memcpy(output.data() + header.meshlets.offset, meshlets.data(), header.meshlets.size);
+	}
+
+	if (!CookedModel::Validate(output.data(), output.size()))
+	{
+		throw runtime_error("cooked model failed validation");
+	}
+
+	cout << "  " << header.meshCount << " meshes, " << header.materialCount << " materials, "
+		<< header.vertexData.size << " bytes of vertices, " << header.indexData.size << " bytes of indices" << endl;
+	cout << "  Dropped " << (h3dHeader.vertexDataByteSizeDepth + h3dHeader.indexDataByteSize) << " bytes of unused depth-only data" << endl;
+}
+
+} // anonymous namespace
+
+
+int main(int argc, char* argv[])
+{
+	const bool quantize = argc == 4 && string(argv[1]) == "-quantize";
+	if (argc != (quantize ? 4 : 3))
+	{
+		cerr << "Usage: ModelCooker [-quantize] <input.h3d> <output.kmdl>" << endl;
+		return 1;
+	}
+
+	const string inputPath = argv[argc - 2];
+	const string outputPath = argv[argc - 1];
+
+	ifstream inputFile(inputPath, ios::in | ios::binary);
+	if (!inputFile)
+	{
+		cerr << "Failed to open " << inputPath << endl;
+		return 1;
+	}
+	vector<uint8_t> input((istreambuf_iterator<char>(inputFile)), istreambuf_iterator<char>());
+
+	cout << "Cooking " << inputPath << endl;
+
+	vector<uint8_t> output;
+	try
+	{
+		Cook(input, quantize, output);
+	}
+	catch (const exception& e)
+	{
+		cerr << "Failed to cook " << inputPath << ": " << e.what() << endl;
+		return 1;
+	}
+
+	ofstream outputFile(outputPath, ios::out | ios::binary | ios::trunc);
+	outputFile.write(reinterpret_cast<const char*>(output.data()), output.size());
+	if (!outputFile)
+	{
+		cerr << "Failed to write " << outputPath << endl;
+		return 1;
+	}
+
+	cout << "Wrote " << outputPath << " (" << output.size() << " bytes)" << endl;
+	return 0;
+}
\ No newline at end of file
@@ -1,6 +1,14 @@
+#if TEXTURE_ARRAYS
+Texture2DArray<float3> texDiffuse : register(t0);
+Texture2DArray<float3> texSpecular : register(t1);
+Texture2DArray<float3> texNormal : register(t2);
+#define SAMPLE_MATERIAL_TEXTURE(tex, slice, uv) tex.Sample(AnisotropicWrap, float3(uv, slice))
+#else
 Texture2D<float3> texDiffuse : register(t0);
 Texture2D<float3> texSpecular : register(t1);
 Texture2D<float3> texNormal : register(t2);
+#define SAMPLE_MATERIAL_TEXTURE(tex, slice, uv) tex.Sample(AnisotropicWrap, uv)
+#endif
 
 Texture2D<float> texSSAO : register(t3);
 Texture2D<float> texShadow : register(t4);
@@ -15,6 +23,9 @@ cbuffer PerMaterialData : register(b2)
 	float3 ambientColor;
 	uint _pad;
 	float shadowTexelSize;
+#if TEXTURE_ARRAYS
+	uint3 textureSlices;	// Diffuse, specular and normal
+#endif
 };
 
 
@@ -116,10 +127,10 @@ void AntiAliasSpecular(inout float3 texNormal, inout float gloss)
 
 float3 main(PixelShaderInput input) : SV_Target0
 {
-	float3 diffuseAlbedo = texDiffuse.Sample(AnisotropicWrap, input.texcoord0);
+	float3 diffuseAlbedo = SAMPLE_MATERIAL_TEXTURE(texDiffuse, textureSlices.x, input.texcoord0);
 	float3 specularAlbedo = float3(0.56f, 0.56f, 0.56f);//float3(1.0, 0.71, 0.29);
-	float specularMask = texSpecular.Sample(AnisotropicWrap, input.texcoord0).g;
-	float3 normal = texNormal.Sample(AnisotropicWrap, input.texcoord0) * 2.0f - 1.0f;
+	float specularMask = SAMPLE_MATERIAL_TEXTURE(texSpecular, textureSlices.y, input.texcoord0).g;
+	float3 normal = SAMPLE_MATERIAL_TEXTURE(texNormal, textureSlices.z, input.texcoord0) * 2.0f - 1.0f;
 	float gloss = 128.0f;
 	float ao = texSSAO[uint2(input.position.xy)];
 	float3 viewDir = normalize(input.viewDir);
@@ -0,0 +1,3 @@
+// BasePS.hlsl for materials whose textures are packed into texture arrays
+#define TEXTURE_ARRAYS 1
+#include "BasePS.hlsl"
\ No newline at end of file
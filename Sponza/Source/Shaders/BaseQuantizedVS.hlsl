@@ -0,0 +1,3 @@
+// BaseVS.hlsl for models with quantized vertices
+#define QUANTIZED_VERTICES 1
+#include "BaseVS.hlsl"
\ No newline at end of file
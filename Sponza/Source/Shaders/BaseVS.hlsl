@@ -1,13 +1,21 @@
 #include "..\..\..\Engine\Source\Shaders\Common\PerViewData.hlsli"
 #include "..\..\..\Engine\Source\Shaders\Common\StaticMeshPerObjectData.hlsli"
+#include "..\..\..\Engine\Source\Shaders\Common\VertexQuantization.hlsli"
 
 struct VertexShaderInput
 {
+#if QUANTIZED_VERTICES
+	float4 position : QPOSITION;
+	float2 texcoord0 : QTEXCOORD;
+	float2 normal : QNORMAL;
+	float2 tangent : QTANGENT;
+#else
 	float3 position : POSITION;
 	float2 texcoord0 : TEXCOORD;
 	float3 normal : NORMAL;
 	float3 tangent : TANGENT;
 	float3 bitangent : BITANGENT;
+#endif
 };
 
 
@@ -27,7 +35,19 @@ VertexShaderOutput main(VertexShaderInput input)
 {
 	VertexShaderOutput output;
 
-	float4 pos = float4(input.position, 1.0f);
+#if QUANTIZED_VERTICES
+	float3 position = DecodePosition(input.position, positionScale, positionBias);
+	float3 normal = DecodeOctahedral(input.normal);
+	float3 tangent = DecodeOctahedral(input.tangent);
+	float3 bitangent = DecodeBitangent(normal, tangent, input.position);
+#else
+	float3 position = input.position;
+	float3 normal = input.normal;
+	float3 tangent = input.tangent;
+	float3 bitangent = input.bitangent;
+#endif
+
+	float4 pos = float4(position, 1.0f);
 
 	// Transform the vertex position into projected space.
 	pos = mul(model, pos);
@@ -35,11 +55,11 @@ VertexShaderOutput main(VertexShaderInput input)
 	output.position = pos;
 
 	output.texcoord0 = input.texcoord0;
-	output.viewDir = input.position - viewPosition;
-	output.shadowCoord = mul(modelToShadow, float4(input.position, 1.0)).xyz;
-	output.normal = input.normal;
-	output.tangent = input.tangent;
-	output.bitangent = input.bitangent;
+	output.viewDir = position - viewPosition;
+	output.shadowCoord = mul(modelToShadow, float4(position, 1.0)).xyz;
+	output.normal = normal;
+	output.tangent = tangent;
+	output.bitangent = bitangent;
 
 	return output;
 }
\ No newline at end of file
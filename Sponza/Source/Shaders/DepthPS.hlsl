@@ -4,12 +4,26 @@ struct PixelShaderInput
 	float2 texcoord : TEXCOORD;
 };
 
+#if TEXTURE_ARRAYS
+Texture2DArray<float4> texDiffuse : register(t0);
+
+cbuffer PerMaterialData : register(b2)
+{
+	uint3 textureSlices;	// Only the diffuse slice is used here
+};
+#else
 Texture2D<float4> texDiffuse : register(t0);
+#endif
 SamplerState AnisotropicWrap : register(s0);
 
 void main(PixelShaderInput input)
 {
-	if (texDiffuse.Sample(AnisotropicWrap, input.texcoord).a < 0.5f)
+#if TEXTURE_ARRAYS
+	float alpha = texDiffuse.Sample(AnisotropicWrap, float3(input.texcoord, textureSlices.x)).a;
+#else
+	float alpha = texDiffuse.Sample(AnisotropicWrap, input.texcoord).a;
+#endif
+	if (alpha < 0.5f)
 	{
 		discard;
 	}
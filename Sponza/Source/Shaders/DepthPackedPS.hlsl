@@ -0,0 +1,3 @@
+// DepthPS.hlsl for materials whose textures are packed into texture arrays
+#define TEXTURE_ARRAYS 1
+#include "DepthPS.hlsl"
\ No newline at end of file
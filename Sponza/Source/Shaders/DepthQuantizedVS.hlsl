@@ -0,0 +1,3 @@
+// DepthVS.hlsl for models with quantized vertices
+#define QUANTIZED_VERTICES 1
+#include "DepthVS.hlsl"
\ No newline at end of file
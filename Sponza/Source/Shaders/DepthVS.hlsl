@@ -1,14 +1,22 @@
 #include "..\..\..\Engine\Source\Shaders\Common\PerViewData.hlsli"
 #include "..\..\..\Engine\Source\Shaders\Common\StaticMeshPerObjectData.hlsli"
+#include "..\..\..\Engine\Source\Shaders\Common\VertexQuantization.hlsli"
 
 
 struct VertexShaderInput
 {
+#if QUANTIZED_VERTICES
+	float4 position : QPOSITION;
+	float2 texcoord : QTEXCOORD;
+	float2 normal : QNORMAL;
+	float2 tangent : QTANGENT;
+#else
 	float3 position : POSITION;
 	float2 texcoord : TEXCOORD;
 	float3 normal : NORMAL;
 	float3 tangent : TANGENT;
 	float3 bitangent : BITANGENT;
+#endif
 };
 
 
@@ -22,7 +30,11 @@ struct VertexShaderOutput
 VertexShaderOutput main(VertexShaderInput input)
 {
 	VertexShaderOutput output;
+#if QUANTIZED_VERTICES
+	float4 pos = float4(DecodePosition(input.position, positionScale, positionBias), 1.0f);
+#else
 	float4 pos = float4(input.position, 1.0f);
+#endif
 
 	// Transform the vertex position into projected space.
 	pos = mul(model, pos);
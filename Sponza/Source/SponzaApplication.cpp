@@ -39,6 +39,7 @@
 #include "Engine\Source\ShadowBuffer.h"
 #include "Engine\Source\ShadowCamera.h"
 #include "Engine\Source\StepTimer.h"
+#include "Engine\Source\TextureStreamer.h"
 
 
 #if defined(PROFILING) && (PROFILING == 1)
@@ -60,6 +61,62 @@ using namespace DirectX;
 using namespace std;
 
 
+namespace
+{
+
+struct DefaultEffects
+{
+	shared_ptr<Effect> base;
+	shared_ptr<Effect> depth;
+	shared_ptr<Effect> shadow;
+};
+
+
+shared_ptr<Effect> CreateDefaultEffect(const string& name, const string& vertexShaderPath, const string& pixelShaderPath,
+	const RasterizerStateDesc& rasterizerState, const DepthStencilStateDesc& depthStencilState, ColorFormat colorFormat,
+	DepthFormat depthFormat)
+{
+	auto effect = make_shared<Effect>(name);
+	effect->SetVertexShaderPath(vertexShaderPath);
+	effect->SetPixelShaderPath(pixelShaderPath);
+	effect->SetBlendState(CommonStates::Opaque());
+	effect->SetRasterizerState(rasterizerState);
+	effect->SetDepthStencilState(depthStencilState);
+	effect->SetPrimitiveTopology(PrimitiveTopologyType::Triangle);
+	if (colorFormat != ColorFormat::Unknown)
+	{
+		effect->SetRenderTargetFormat(colorFormat, depthFormat);
+	}
+	else
+	{
+		effect->SetRenderTargetFormats(0, nullptr, depthFormat);
+	}
+	effect->FinalizeAsync();
+	return effect;
+}
+
+
+// The base, depth and shadow effects for one vertex layout.  Shadows reuse the depth shaders.
+DefaultEffects CreateDefaultEffects(const string& suffix, const string& baseVS, const string& basePS, const string& depthVS,
+	const string& depthPS)
+{
+	DefaultEffects effects;
+
+	effects.base = CreateDefaultEffect("Base" + suffix, baseVS, basePS, CommonStates::CullCounterClockwise(),
+		CommonStates::DepthReadEqual(), ColorFormat::R11G11B10_Float, DepthFormat::D32);
+
+	effects.depth = CreateDefaultEffect("Depth" + suffix, depthVS, depthPS, CommonStates::CullCounterClockwise(),
+		CommonStates::DepthGreaterEqual(), ColorFormat::Unknown, DepthFormat::D32);
+
+	effects.shadow = CreateDefaultEffect("Shadow" + suffix, depthVS, depthPS, CommonStates::Shadow(),
+		CommonStates::DepthGreaterEqual(), ColorFormat::Unknown, DepthFormat::D16);
+
+	return effects;
+}
+
+} // anonymous namespace
+
+
 SponzaApplication::SponzaApplication(uint32_t width, uint32_t height, const std::wstring& name)
 	: Application(width, height, name)
 {}
@@ -88,6 +145,9 @@ void SponzaApplication::OnStartup()
 	// Setup renderer
 	auto& renderer = Renderer::GetInstance();
 	renderer.EnableRenderThread(false);
+
+	// Streaming is off by default, Sponza has enough texture data to need it
+	TextureStreamer::GetInstance().SetEnabled(true);
 }
 
 
@@ -112,8 +172,18 @@ void SponzaApplication::OnInit()
 	CreateParticleEffects();
 #endif
 
-	CreateEffects();
-	CreateModel();
+	// Only the default effects for the vertex layout the model loads with are created
+	ModelLoadDesc modelDesc;
+	modelDesc.optimizeMeshes = true;
+	modelDesc.quantizeVertices = true;
+	modelDesc.buildMeshlets = true;
+
+	// Packing shares descriptor tables between materials, but packed textures load their full mip chains
+	// and skip streaming.  The loader logs the base pass descriptor table updates it saves.
+	modelDesc.packTextures = false;
+
+	CreateEffects(modelDesc);
+	CreateModel(modelDesc);
 
 	SetupScene();
 }
@@ -179,6 +249,8 @@ void SponzaApplication::OnRender()
 			commandList.SetScissor(0, 0, m_width, m_height);
 			commandList.SetDepthStencilTarget(*m_depthBuffer);
 
+			// The depth and base passes draw the same view, so cull it once for both
+			m_mainScene->CullMeshlets();
 			m_mainScene->Update(commandList);
 			m_mainScene->Render(GetDefaultDepthPass(), commandList);
 
@@ -290,11 +362,24 @@ void SponzaApplication::OnDestroy()
 {
 	Renderer::GetInstance().Finalize();
 
+	// The render thread has stopped, so the scene's stats are safe to read
+	m_mainScene->LogMeshletCullStats();
+
 	SetDefaultBasePass(nullptr);
 	SetDefaultDepthPass(nullptr);
 	
 	SetDefaultBaseEffect(nullptr);
 	SetDefaultDepthEffect(nullptr);
+	SetDefaultShadowEffect(nullptr);
+	SetDefaultQuantizedBaseEffect(nullptr);
+	SetDefaultQuantizedDepthEffect(nullptr);
+	SetDefaultQuantizedShadowEffect(nullptr);
+	SetDefaultPackedBaseEffect(nullptr);
+	SetDefaultPackedDepthEffect(nullptr);
+	SetDefaultPackedShadowEffect(nullptr);
+	SetDefaultQuantizedPackedBaseEffect(nullptr);
+	SetDefaultQuantizedPackedDepthEffect(nullptr);
+	SetDefaultQuantizedPackedShadowEffect(nullptr);
 
 	LOG_INFO << "SponzaApplication finalize";
 }
@@ -415,7 +500,7 @@ void SponzaApplication::CreateParticleEffects()
 #endif
 
 
-void SponzaApplication::CreateEffects()
+void SponzaApplication::CreateEffects(const ModelLoadDesc& modelDesc)
 {
 	// Default render passes
 	auto basePass = make_shared<RenderPass>("Base");
@@ -431,45 +516,49 @@ void SponzaApplication::CreateEffects()
 	SetDefaultShadowPass(shadowPass);
 
 
-	// Default effects
-	auto baseEffect = make_shared<Effect>("Base");
-	baseEffect->SetVertexShaderPath("BaseVS.dx.cso");
-	baseEffect->SetPixelShaderPath("BasePS.dx.cso");
-	baseEffect->SetBlendState(CommonStates::Opaque());
-	baseEffect->SetRasterizerState(CommonStates::CullCounterClockwise());
-	baseEffect->SetDepthStencilState(CommonStates::DepthReadEqual());
-	baseEffect->SetPrimitiveTopology(PrimitiveTopologyType::Triangle);
-	baseEffect->SetRenderTargetFormat(ColorFormat::R11G11B10_Float, DepthFormat::D32);
-	baseEffect->Finalize();
-	SetDefaultBaseEffect(baseEffect);
-
-	auto depthEffect = make_shared<Effect>("Depth");
-	depthEffect->SetVertexShaderPath("DepthVS.dx.cso");
-	depthEffect->SetPixelShaderPath("DepthPS.dx.cso");
-	depthEffect->SetBlendState(CommonStates::Opaque());
-	depthEffect->SetRasterizerState(CommonStates::CullCounterClockwise());
-	depthEffect->SetDepthStencilState(CommonStates::DepthGreaterEqual());
-	depthEffect->SetPrimitiveTopology(PrimitiveTopologyType::Triangle);
-	depthEffect->SetRenderTargetFormats(0, nullptr, DepthFormat::D32);
-	depthEffect->Finalize();
-	SetDefaultDepthEffect(depthEffect);
-
-	auto shadowEffect = make_shared<Effect>("Shadow");
-	shadowEffect->SetVertexShaderPath("DepthVS.dx.cso");
-	shadowEffect->SetPixelShaderPath("DepthPS.dx.cso");
-	shadowEffect->SetBlendState(CommonStates::Opaque());
-	shadowEffect->SetRasterizerState(CommonStates::Shadow());
-	shadowEffect->SetDepthStencilState(CommonStates::DepthGreaterEqual());
-	shadowEffect->SetPrimitiveTopology(PrimitiveTopologyType::Triangle);
-	shadowEffect->SetRenderTargetFormats(0, nullptr, DepthFormat::D16);
-	shadowEffect->Finalize();
-	SetDefaultShadowEffect(shadowEffect);
+	// Default effects.  They finish finalizing in the background, and the model's materials are set up
+	// as each one does.
+	const string baseVS = modelDesc.quantizeVertices ? "BaseQuantizedVS.dx.cso" : "BaseVS.dx.cso";
+	const string depthVS = modelDesc.quantizeVertices ? "DepthQuantizedVS.dx.cso" : "DepthVS.dx.cso";
+	const string suffix = modelDesc.quantizeVertices ? " Quantized" : "";
+
+	auto effects = CreateDefaultEffects(suffix, baseVS, "BasePS.dx.cso", depthVS, "DepthPS.dx.cso");
+	if (modelDesc.quantizeVertices)
+	{
+		SetDefaultQuantizedBaseEffect(effects.base);
+		SetDefaultQuantizedDepthEffect(effects.depth);
+		SetDefaultQuantizedShadowEffect(effects.shadow);
+	}
+	else
+	{
+		SetDefaultBaseEffect(effects.base);
+		SetDefaultDepthEffect(effects.depth);
+		SetDefaultShadowEffect(effects.shadow);
+	}
+
+	// Variants that sample texture arrays.  Materials whose textures couldn't all be packed keep the effects above.
+	if (modelDesc.packTextures)
+	{
+		auto packedEffects = CreateDefaultEffects(suffix + " Packed", baseVS, "BasePackedPS.dx.cso", depthVS, "DepthPackedPS.dx.cso");
+		if (modelDesc.quantizeVertices)
+		{
+			SetDefaultQuantizedPackedBaseEffect(packedEffects.base);
+			SetDefaultQuantizedPackedDepthEffect(packedEffects.depth);
+			SetDefaultQuantizedPackedShadowEffect(packedEffects.shadow);
+		}
+		else
+		{
+			SetDefaultPackedBaseEffect(packedEffects.base);
+			SetDefaultPackedDepthEffect(packedEffects.depth);
+			SetDefaultPackedShadowEffect(packedEffects.shadow);
+		}
+	}
 }
 
 
-void SponzaApplication::CreateModel()
+void SponzaApplication::CreateModel(const ModelLoadDesc& modelDesc)
 {
-	m_sponzaModel = LoadModel("sponza.h3d");
+	m_sponzaModel = LoadModel("sponza.h3d", modelDesc);
 
 	// Miserable hack!!!!
 #if DX12
@@ -29,6 +29,7 @@ class Scene;
 class ShadowBuffer;
 class ShadowCamera;
 class StaticModel;
+struct ModelLoadDesc;
 
 
 class SponzaApplication : public Application
@@ -49,8 +50,8 @@ private:
 #if 0
 	void CreateParticleEffects();
 #endif
-	void CreateEffects();
-	void CreateModel();
+	void CreateEffects(const ModelLoadDesc& modelDesc);
+	void CreateModel(const ModelLoadDesc& modelDesc);
 	void SetupScene();
 
 private:
@@ -0,0 +1,422 @@
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+// Author: David Elder
+//
+
+// Loads 200 effects at once, the way the model loader does: materials set their effects from several worker
+// threads, shaders load on loader threads, and the main thread keeps running frames that hand out the
+// callbacks.  Checks that every effect is finalized exactly once, that no frame waits on a load, and that
+// IAsyncResource::Wait can be called by any number of threads.
+
+#include "IAsyncResource.h"
+#include "LoaderEnums.h"
+
+#include "TestUtility.h"
+
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+
+
+using namespace Kodiak;
+using namespace std;
+
+
+namespace
+{
+
+typedef chrono::steady_clock Clock;
+
+const uint32_t kNumEffects = 200;
+const uint32_t kNumShaders = 40;
+const uint32_t kMaterialsPerEffect = 3;
+const uint32_t kNumWorkers = 8;
+
+// Long enough that a frame waiting on either one stands out from scheduling noise
+const auto kShaderLoadTime = chrono::milliseconds(100);
+const auto kFinalizeTime = chrono::milliseconds(20);
+const auto kMaxFrameTime = chrono::milliseconds(50);
+
+
+class TestShader : public IAsyncResource
+{
+public:
+	explicit TestShader(bool fails) : m_fails(fails) {}
+
+	bool DoLoad() override
+	{
+		m_loadState = LoadState::Loading;
+		this_thread::sleep_for(kShaderLoadTime);
+
+		if (m_fails)
+		{
+			m_loadState = LoadState::LoadFailed;
+			throw runtime_error("Shader failed to compile");
+		}
+
+		m_loadState = LoadState::LoadSucceeded;
+		return true;
+	}
+
+private:
+	const bool m_fails;
+};
+
+
+// Launches loads and hands finished ones back to the main thread, like ResourceLoader::Queue and Update
+class TestLoader
+{
+public:
+	void Queue(shared_ptr<IAsyncResource> resource)
+	{
+		// The future keeps the task alive, so the task lets go of the resource once it's loaded
+		auto loadingResource = make_shared<shared_ptr<IAsyncResource>>(resource);
+		auto fut = async(launch::async, [this, loadingResource]()
+		{
+			auto resource = move(*loadingResource);
+			try
+			{
+				resource->DoLoad();
+			}
+			catch (...)
+			{
+				Complete(resource);
+				throw;
+			}
+			Complete(resource);
+		});
+		resource->AcquireThreadResult(move(fut));
+	}
+
+	void Update()
+	{
+		vector<shared_ptr<IAsyncResource>> completed;
+		{
+			lock_guard<mutex> CS(m_mutex);
+			swap(completed, m_completed);
+		}
+
+		for (auto& resource : completed)
+		{
+			resource->ExecutePostLoadCallbacks();
+		}
+	}
+
+private:
+	void Complete(shared_ptr<IAsyncResource> resource)
+	{
+		lock_guard<mutex> CS(m_mutex);
+		m_completed.push_back(resource);
+	}
+
+	mutex								m_mutex;
+	vector<shared_ptr<IAsyncResource>>	m_completed;
+};
+
+
+// Stands in for BaseEffect, which needs the PPL: the same once-only FinalizeAsync, finalizing on a worker
+// once every shader's post-load callback has run, and handing the finalized callbacks to the main thread
+class TestEffect : public enable_shared_from_this<TestEffect>
+{
+public:
+	explicit TestEffect(vector<shared_ptr<TestShader>> shaders) : m_shaders(move(shaders)) {}
+
+	void FinalizeAsync()
+	{
+		if (m_isFinalized || m_finalizeStarted.exchange(true)) return;
+
+		auto thisEffect = shared_from_this();
+		auto remaining = make_shared<atomic<uint32_t>>(static_cast<uint32_t>(m_shaders.size()));
+		for (auto& shader : m_shaders)
+		{
+			shader->AddPostLoadCallback([thisEffect, remaining]()
+			{
+				if (--*remaining == 0)
+				{
+					auto finalizeTask = async(launch::async, [thisEffect]() { thisEffect->Finalize(); });
+
+					lock_guard<mutex> CS(s_finalizedMutex);
+					s_finalizeTasks.push_back(move(finalizeTask));
+				}
+			});
+		}
+	}
+
+	void AddFinalizedCallback(function<void()> callback)
+	{
+		{
+			lock_guard<mutex> CS(m_callbackMutex);
+			if (!m_isFinalized)
+			{
+				m_finalizedCallbacks.push_back(callback);
+				return;
+			}
+		}
+
+		callback();
+	}
+
+	// Main thread, once per frame
+	static void DispatchFinalizedCallbacks()
+	{
+		vector<shared_ptr<TestEffect>> effects;
+		{
+			lock_guard<mutex> CS(s_finalizedMutex);
+			swap(effects, s_finalizedEffects);
+		}
+
+		for (auto& effect : effects)
+		{
+			vector<function<void()>> callbacks;
+			{
+				lock_guard<mutex> CS(effect->m_callbackMutex);
+				swap(callbacks, effect->m_finalizedCallbacks);
+			}
+
+			for (auto& callback : callbacks)
+			{
+				callback();
+			}
+		}
+	}
+
+	// Waits for the finalizes started so far, so nothing outlives the test
+	static void WaitForFinalizeTasks()
+	{
+		vector<future<void>> finalizeTasks;
+		{
+			lock_guard<mutex> CS(s_finalizedMutex);
+			swap(finalizeTasks, s_finalizeTasks);
+		}
+
+		for (auto& finalizeTask : finalizeTasks)
+		{
+			finalizeTask.get();
+		}
+	}
+
+	uint32_t GetFinalizeCount() const { return m_finalizeCount; }
+
+private:
+	void Finalize()
+	{
+		// The PSO compile
+		this_thread::sleep_for(kFinalizeTime);
+		++m_finalizeCount;
+
+		{
+			lock_guard<mutex> CS(m_callbackMutex);
+			m_isFinalized = true;
+		}
+
+		lock_guard<mutex> CS(s_finalizedMutex);
+		s_finalizedEffects.push_back(shared_from_this());
+	}
+
+	vector<shared_ptr<TestShader>>	m_shaders;
+
+	atomic<bool>					m_isFinalized{ false };
+	atomic<bool>					m_finalizeStarted{ false };
+	atomic<uint32_t>				m_finalizeCount{ 0 };
+
+	mutex							m_callbackMutex;
+	vector<function<void()>>		m_finalizedCallbacks;
+
+	static mutex							s_finalizedMutex;
+	static vector<shared_ptr<TestEffect>>	s_finalizedEffects;
+	static vector<future<void>>				s_finalizeTasks;
+};
+
+mutex TestEffect::s_finalizedMutex;
+vector<shared_ptr<TestEffect>> TestEffect::s_finalizedEffects;
+vector<future<void>> TestEffect::s_finalizeTasks;
+
+
+uint32_t GetVertexShaderIndex(uint32_t effectIndex)
+{
+	return effectIndex % kNumShaders;
+}
+
+
+uint32_t GetPixelShaderIndex(uint32_t effectIndex)
+{
+	return (effectIndex * 7 + 1) % kNumShaders;
+}
+
+
+// Shader 0 fails to load, so the effects using it are never finalized
+bool IsFailedEffect(uint32_t effectIndex)
+{
+	return GetVertexShaderIndex(effectIndex) == 0 || GetPixelShaderIndex(effectIndex) == 0;
+}
+
+
+void TestConcurrentEffectLoads()
+{
+	TestLoader loader;
+
+	// Effects share shaders, the way the shader cache hands them out
+	vector<shared_ptr<TestShader>> shaders;
+	for (uint32_t i = 0; i < kNumShaders; ++i)
+	{
+		shaders.push_back(make_shared<TestShader>(i == 0));
+		loader.Queue(shaders.back());
+	}
+
+	vector<shared_ptr<TestEffect>> effects;
+	for (uint32_t i = 0; i < kNumEffects; ++i)
+	{
+		vector<shared_ptr<TestShader>> effectShaders = { shaders[GetVertexShaderIndex(i)], shaders[GetPixelShaderIndex(i)] };
+		effects.push_back(make_shared<TestEffect>(effectShaders));
+	}
+
+	// Each material sets its effect on whichever worker builds it, so each effect is started from several
+	// threads at once
+	vector<atomic<uint32_t>> callbackCounts(kNumEffects);
+	for (auto& count : callbackCounts)
+	{
+		count = 0;
+	}
+
+	vector<thread> workers;
+	for (uint32_t worker = 0; worker < kNumWorkers; ++worker)
+	{
+		workers.emplace_back([&effects, &callbackCounts, worker]()
+		{
+			for (uint32_t material = worker; material < kNumEffects * kMaterialsPerEffect; material += kNumWorkers)
+			{
+				const uint32_t effectIndex = material % kNumEffects;
+				auto& count = callbackCounts[effectIndex];
+				effects[effectIndex]->AddFinalizedCallback([&count]() { ++count; });
+				effects[effectIndex]->FinalizeAsync();
+			}
+		});
+	}
+
+	// Run frames until every effect that can be finalized has handed out its callbacks
+	uint32_t expectedCallbacks = 0;
+	for (uint32_t i = 0; i < kNumEffects; ++i)
+	{
+		expectedCallbacks += IsFailedEffect(i) ? 0 : kMaterialsPerEffect;
+	}
+
+	auto countCallbacks = [&callbackCounts]()
+	{
+		uint32_t total = 0;
+		for (const auto& count : callbackCounts)
+		{
+			total += count;
+		}
+		return total;
+	};
+
+	const auto startTime = Clock::now();
+	Clock::duration maxFrameTime{ 0 };
+	uint32_t numFrames = 0;
+
+	while (countCallbacks() < expectedCallbacks && Clock::now() - startTime < chrono::seconds(30))
+	{
+		const auto frameStart = Clock::now();
+		loader.Update();
+		TestEffect::DispatchFinalizedCallbacks();
+		maxFrameTime = max(maxFrameTime, Clock::now() - frameStart);
+		++numFrames;
+
+		this_thread::sleep_for(chrono::milliseconds(1));
+	}
+
+	for (auto& worker : workers)
+	{
+		worker.join();
+	}
+
+	// One more frame after everything has settled, which would pick up a finalize that shouldn't have run
+	TestEffect::WaitForFinalizeTasks();
+	loader.Update();
+	TestEffect::DispatchFinalizedCallbacks();
+
+	CHECK_EQUAL(expectedCallbacks, countCallbacks());
+	CHECK(numFrames > 1);
+	CHECK(maxFrameTime < kMaxFrameTime);
+
+	for (uint32_t i = 0; i < kNumEffects; ++i)
+	{
+		CHECK_EQUAL(IsFailedEffect(i) ? 0u : 1u, effects[i]->GetFinalizeCount());
+		CHECK_EQUAL(IsFailedEffect(i) ? 0u : kMaterialsPerEffect, callbackCounts[i].load());
+	}
+
+	// Materials set up after the effect is finalized get their callback right away
+	uint32_t lateCallbacks = 0;
+	effects[1]->AddFinalizedCallback([&lateCallbacks]() { ++lateCallbacks; });
+	effects[1]->FinalizeAsync();
+	CHECK_EQUAL(1u, lateCallbacks);
+	CHECK_EQUAL(1u, effects[1]->GetFinalizeCount());
+}
+
+
+void TestWaitFromManyThreads()
+{
+	TestLoader loader;
+
+	auto shader = make_shared<TestShader>(false);
+	auto failedShader = make_shared<TestShader>(true);
+	loader.Queue(shader);
+	loader.Queue(failedShader);
+
+	// Every thread waits on both loads, twice, while they are still running and after they've finished
+	atomic<uint32_t> numRethrown{ 0 };
+	vector<thread> waiters;
+	for (uint32_t i = 0; i < kNumWorkers; ++i)
+	{
+		waiters.emplace_back([&shader, &failedShader, &numRethrown]()
+		{
+			for (uint32_t pass = 0; pass < 2; ++pass)
+			{
+				shader->Wait();
+				try
+				{
+					failedShader->Wait();
+				}
+				catch (const runtime_error&)
+				{
+					++numRethrown;
+				}
+			}
+		});
+	}
+
+	for (auto& waiter : waiters)
+	{
+		waiter.join();
+	}
+
+	CHECK(shader->IsReady());
+	CHECK(failedShader->IsLoadFinished() && !failedShader->IsReady());
+	CHECK_EQUAL(kNumWorkers * 2, numRethrown.load());
+
+	// Post-load callbacks only run for the load that succeeded, and load-finished callbacks run for both,
+	// after the post-load ones
+	vector<int> order;
+	shader->AddPostLoadCallback([&order]() { order.push_back(1); });
+	shader->AddLoadFinishedCallback([&order](bool succeeded) { order.push_back(succeeded ? 2 : -2); });
+	failedShader->AddPostLoadCallback([&order]() { order.push_back(3); });
+	failedShader->AddLoadFinishedCallback([&order](bool succeeded) { order.push_back(succeeded ? 4 : -4); });
+	loader.Update();
+
+	CHECK((order == vector<int>{ 1, 2, -4 }));
+}
+
+} // anonymous namespace
+
+
+int main()
+{
+	TestConcurrentEffectLoads();
+	TestWaitFromManyThreads();
+
+	return KodiakTest::FinishTest("AsyncEffectLoadTest");
+}
\ No newline at end of file
@@ -0,0 +1,118 @@
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+// Author: David Elder
+//
+
+// Decode throughput of BCDecoder in megapixels per second, on one thread and split by block rows across
+// all of them the way DecodeDDSSubresource does.  Pass a surface size to override the default 2048.
+//
+//   BCDecoderBenchmark [size]
+
+#include "BCDecoder.h"
+
+#include "TestUtility.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+
+using namespace Kodiak;
+using namespace std;
+using namespace std::chrono;
+
+
+namespace
+{
+
+const int kRepetitions = 3;
+
+
+double MeasureMegapixelsPerSecond(BCFormat format, const vector<uint8_t>& blocks, uint32_t size, uint32_t numThreads,
+	vector<uint8_t>& pixels)
+{
+	const uint32_t blockRows = size / 4;
+	const size_t srcRowBytes = (size / 4) * GetBCBlockBytes(format);
+	const uint32_t rowsPerThread = (blockRows + numThreads - 1) / numThreads;
+
+	const auto startTime = high_resolution_clock::now();
+
+	for (int repetition = 0; repetition < kRepetitions; ++repetition)
+	{
+		vector<thread> threads;
+		for (uint32_t i = 1; i < numThreads; ++i)
+		{
+			const uint32_t firstRow = i * rowsPerThread;
+			if (firstRow < blockRows)
+			{
+				threads.emplace_back([&, firstRow]()
+				{
+					DecodeBCBlockRows(format, blocks.data(), srcRowBytes, size, size, firstRow,
+						min(rowsPerThread, blockRows - firstRow), pixels.data(), size * 4);
+				});
+			}
+		}
+
+		DecodeBCBlockRows(format, blocks.data(), srcRowBytes, size, size, 0, min(rowsPerThread, blockRows), pixels.data(), size * 4);
+
+		for (auto& t : threads)
+		{
+			t.join();
+		}
+	}
+
+	const duration<double> elapsed = high_resolution_clock::now() - startTime;
+	return static_cast<double>(size) * size * kRepetitions / elapsed.count() / 1.0e6;
+}
+
+} // anonymous namespace
+
+
+int main(int argc, char* argv[])
+{
+	const uint32_t size = (argc > 1) ? max(4u, static_cast<uint32_t>(atoi(argv[1])) & ~3u) : 2048;
+	const uint32_t numThreads = max(1u, thread::hardware_concurrency());
+
+	const struct
+	{
+		BCFormat	format;
+		const char*	name;
+	} formats[] =
+	{
+		{ BCFormat::BC1, "BC1" },
+		{ BCFormat::BC2, "BC2" },
+		{ BCFormat::BC3, "BC3" },
+		{ BCFormat::BC4, "BC4" },
+		{ BCFormat::BC5, "BC5" },
+		{ BCFormat::BC7, "BC7" },
+	};
+
+	printf("%ux%u, BC1-BC5 %s SSSE3, %u threads\n", size, size, IsBCDecoderVectorized() ? "use" : "don't use", numThreads);
+
+	uint32_t seed = 1;
+	vector<uint8_t> pixels(size_t(size) * size * 4);
+
+	for (const auto& format : formats)
+	{
+		vector<uint8_t> blocks(size_t(size / 4) * (size / 4) * GetBCBlockBytes(format.format));
+		for (auto& byte : blocks)
+		{
+			seed = seed * 1664525u + 1013904223u;
+			byte = static_cast<uint8_t>(seed >> 24);
+		}
+
+		const double singleThread = MeasureMegapixelsPerSecond(format.format, blocks, size, 1, pixels);
+		const double allThreads = MeasureMegapixelsPerSecond(format.format, blocks, size, numThreads, pixels);
+		printf("%s: %.0f MP/s on one thread, %.0f MP/s on %u\n", format.name, singleThread, allThreads, numThreads);
+
+		CHECK(singleThread > 0.0);
+	}
+
+	return KodiakTest::FinishTest("BCDecoderBenchmark");
+}
\ No newline at end of file
@@ -0,0 +1,206 @@
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+// Author: David Elder
+//
+
+// Bit-exact reference vectors for BCDecoder.  Each case decodes a surface of pseudo-random blocks and
+// compares a hash of the RGBA8 output with one taken from Pillow's BCn decoder on the same blocks, with
+// BC4 expanded to (r, 0, 0, 255) and BC5 to (r, g, 0, 255).  The 61x37 surfaces check edge clipping.
+
+#include "BCDecoder.h"
+
+#include "TestUtility.h"
+
+#include <cstring>
+#include <vector>
+
+
+using namespace Kodiak;
+using namespace std;
+
+
+namespace
+{
+
+struct ReferenceCase
+{
+	BCFormat	format;
+	uint32_t	width;
+	uint32_t	height;
+	uint64_t	seed;
+	uint64_t	expectedHash;
+};
+
+const ReferenceCase s_referenceCases[] =
+{
+	{ BCFormat::BC1, 64, 64, 1, 0xC2CE4AF80AC9F755ull },
+	{ BCFormat::BC1, 61, 37, 2, 0xB7E57F4F223CC9A2ull },
+	{ BCFormat::BC2, 64, 64, 3, 0x41C54B325E8017C0ull },
+	{ BCFormat::BC2, 61, 37, 4, 0xA294C067A55A3362ull },
+	{ BCFormat::BC3, 64, 64, 5, 0x2E86665696268195ull },
+	{ BCFormat::BC3, 61, 37, 6, 0x9677A9AA69E68200ull },
+	{ BCFormat::BC4, 64, 64, 7, 0x0E705445AC6F034Dull },
+	{ BCFormat::BC4, 61, 37, 8, 0xC1EC780C37E91A0Aull },
+	{ BCFormat::BC5, 64, 64, 9, 0xA782EED4189EE2D5ull },
+	{ BCFormat::BC5, 61, 37, 10, 0x3BF2115E1B825284ull },
+	{ BCFormat::BC7, 64, 64, 11, 0xC0794CE12AB9963Full },
+	{ BCFormat::BC7, 61, 37, 12, 0xF9ACD304E2DA35EBull },
+};
+
+
+uint64_t SplitMix64(uint64_t& state)
+{
+	uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+	return z ^ (z >> 31);
+}
+
+
+uint64_t HashFNV1a(const vector<uint8_t>& data)
+{
+	uint64_t hash = 0xCBF29CE484222325ull;
+	for (auto byte : data)
+	{
+		hash = (hash ^ byte) * 0x100000001B3ull;
+	}
+	return hash;
+}
+
+
+// Pseudo-random blocks.  BC7 blocks cycle through the eight modes, since random bytes would mostly be mode 0.
+vector<uint8_t> MakeBlocks(BCFormat format, uint32_t numBlocks, uint64_t seed)
+{
+	const size_t blockBytes = GetBCBlockBytes(format);
+
+	vector<uint8_t> blocks((numBlocks * blockBytes + 7) & ~size_t(7));
+	for (size_t i = 0; i < blocks.size(); i += 8)
+	{
+		const uint64_t value = SplitMix64(seed);
+		for (size_t j = 0; j < 8; ++j)
+		{
+			blocks[i + j] = static_cast<uint8_t>(value >> (8 * j));
+		}
+	}
+	blocks.resize(numBlocks * blockBytes);
+
+	if (format == BCFormat::BC7)
+	{
+		for (uint32_t i = 0; i < numBlocks; ++i)
+		{
+			const uint32_t mode = i % 8;
+			uint8_t& modeByte = blocks[i * blockBytes];
+			modeByte = static_cast<uint8_t>((modeByte << (mode + 1)) | (1u << mode));
+		}
+	}
+
+	return blocks;
+}
+
+
+vector<uint8_t> DecodeSurface(BCFormat format, const vector<uint8_t>& blocks, uint32_t width, uint32_t height)
+{
+	const uint32_t blocksWide = (width + 3) / 4;
+	const uint32_t blocksHigh = (height + 3) / 4;
+
+	vector<uint8_t> pixels(width * height * 4, 0xCD);
+	DecodeBCBlockRows(format, blocks.data(), blocksWide * GetBCBlockBytes(format), width, height, 0, blocksHigh,
+		pixels.data(), width * 4);
+	return pixels;
+}
+
+
+void TestReferenceVectors()
+{
+	for (const auto& referenceCase : s_referenceCases)
+	{
+		const uint32_t numBlocks = ((referenceCase.width + 3) / 4) * ((referenceCase.height + 3) / 4);
+		const auto blocks = MakeBlocks(referenceCase.format, numBlocks, referenceCase.seed);
+		const auto pixels = DecodeSurface(referenceCase.format, blocks, referenceCase.width, referenceCase.height);
+
+		const uint64_t hash = HashFNV1a(pixels);
+		if (hash != referenceCase.expectedHash)
+		{
+			printf("BC%d %ux%u: decoded hash 0x%016llX\n", static_cast<int>(referenceCase.format) + (referenceCase.format == BCFormat::BC7 ? 2 : 1),
+				referenceCase.width, referenceCase.height, static_cast<unsigned long long>(hash));
+		}
+		CHECK_EQUAL(referenceCase.expectedHash, hash);
+	}
+}
+
+
+// A BC1 block that can be checked by hand.  Red and blue endpoints, with color0 > color1 so there are two
+// interpolated colors, one index per row.
+void TestBC1Block()
+{
+	const uint8_t block[8] = { 0x00, 0xF8, 0x1F, 0x00, 0x00, 0x55, 0xAA, 0xFF };
+
+	uint8_t pixels[16 * 4];
+	DecodeBCBlock(BCFormat::BC1, block, pixels, 16);
+
+	const uint8_t expected[4][4] =
+	{
+		{ 255, 0, 0, 255 },
+		{ 0, 0, 255, 255 },
+		{ 170, 0, 85, 255 },
+		{ 85, 0, 170, 255 },
+	};
+
+	for (uint32_t y = 0; y < 4; ++y)
+	{
+		for (uint32_t x = 0; x < 4; ++x)
+		{
+			CHECK(memcmp(pixels + y * 16 + x * 4, expected[y], 4) == 0);
+		}
+	}
+}
+
+
+// Decoding in separate ranges of block rows gives the same pixels as one pass, and writes nothing past the
+// surface's width even when the pitch leaves room
+void TestBlockRowRanges()
+{
+	const uint32_t width = 61;
+	const uint32_t height = 37;
+	const uint32_t blocksWide = (width + 3) / 4;
+	const uint32_t blocksHigh = (height + 3) / 4;
+	const size_t pitch = (width + 3) * 4;
+
+	for (auto format : { BCFormat::BC1, BCFormat::BC3, BCFormat::BC7 })
+	{
+		const auto blocks = MakeBlocks(format, blocksWide * blocksHigh, 99);
+		const auto reference = DecodeSurface(format, blocks, width, height);
+
+		vector<uint8_t> pixels(pitch * height, 0xCD);
+		const size_t srcRowBytes = blocksWide * GetBCBlockBytes(format);
+		DecodeBCBlockRows(format, blocks.data(), srcRowBytes, width, height, 3, blocksHigh - 3, pixels.data(), pitch);
+		DecodeBCBlockRows(format, blocks.data(), srcRowBytes, width, height, 0, 3, pixels.data(), pitch);
+
+		for (uint32_t y = 0; y < height; ++y)
+		{
+			CHECK(memcmp(pixels.data() + y * pitch, reference.data() + y * width * 4, width * 4) == 0);
+			for (size_t x = width * 4; x < pitch; ++x)
+			{
+				CHECK_EQUAL(0xCD, pixels[y * pitch + x]);
+			}
+		}
+	}
+}
+
+} // anonymous namespace
+
+
+int main()
+{
+	printf("BC1-BC5 %s SSSE3\n", IsBCDecoderVectorized() ? "use" : "don't use");
+
+	TestReferenceVectors();
+	TestBC1Block();
+	TestBlockRowRanges();
+
+	return KodiakTest::FinishTest("BCDecoderTest");
+}
\ No newline at end of file
@@ -0,0 +1,577 @@
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+// Author: David Elder
+//
+
+// Time taken to load a synthetic model of grid meshes from H3D, with and without the vertex cache optimization,
+// meshlet building and quantization that ModelLoadDesc can ask for at load time, against cooking it the way
+// ModelCooker does and loading the .kmdl, which only needs Validate before its tables are used in place.  Files
+// are read from memory, and both loaders stop short of uploading the geometry, which costs the same either way.
+// Pass a grid size to override the default 128 quads on a side per mesh.
+//
+//   CookedModelBenchmark [gridSize]
+
+#include "CookedModel.h"
+#include "MeshOptimizer.h"
+#include "Meshlet.h"
+#include "VertexQuantization.h"
+
+#include "TestUtility.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+
+using namespace Kodiak;
+using namespace std;
+using namespace std::chrono;
+
+
+namespace
+{
+
+const int kRepetitions = 5;
+const uint32_t kMeshCount = 4;
+const uint32_t kMaterialCount = 2;
+
+
+// H3D layout, as read by LoadModelH3D
+namespace H3D
+{
+
+const uint32_t kMaxAttribs = 16;
+const size_t kMaxTexPath = 128;
+const size_t kMaxMaterialName = 128;
+const uint16_t kAttribFormatFloat = 5;
+
+struct Attrib
+{
+	uint16_t offset;
+	uint16_t normalized;
+	uint16_t components;
+	uint16_t format;
+};
+
+struct Mesh
+{
+	float boundsMin[4];
+	float boundsMax[4];
+	uint32_t materialIndex;
+	uint32_t attribsEnabled;
+	uint32_t vertexStride;
+	Attrib attrib[kMaxAttribs];
+	uint32_t vertexDataByteOffset;
+	uint32_t vertexCount;
+	uint32_t indexDataByteOffset;
+	uint32_t indexCount;
+};
+
+struct Material
+{
+	string texDiffusePath;
+	string texSpecularPath;
+	string texNormalPath;
+	string name;
+};
+
+} // namespace H3D
+
+
+// Engine-style float vertex, positions through bitangents, 56 bytes
+struct GridVertex
+{
+	float position[3];
+	float texcoord[2];
+	float normal[3];
+	float tangent[3];
+	float bitangent[3];
+};
+
+
+class Writer
+{
+public:
+	template <typename T> void Write(const T& value)
+	{
+		const auto* bytes = reinterpret_cast<const uint8_t*>(&value);
+		m_data.insert(m_data.end(), bytes, bytes + sizeof(T));
+	}
+
+	void WriteBytes(const void* data, size_t size)
+	{
+		const auto* bytes = static_cast<const uint8_t*>(data);
+		m_data.insert(m_data.end(), bytes, bytes + size);
+	}
+
+	// Fixed-size, NUL-padded string field
+	void WriteString(const string& str, size_t fieldSize)
+	{
+		const size_t size = min(str.size(), fieldSize - 1);
+		WriteBytes(str.data(), size);
+		Skip(fieldSize - size);
+	}
+
+	void Skip(size_t size) { m_data.insert(m_data.end(), size, 0); }
+
+	vector<uint8_t>& GetData() { return m_data; }
+
+private:
+	vector<uint8_t> m_data;
+};
+
+
+// Bounds-checked reads, like BinaryReader
+class Reader
+{
+public:
+	Reader(const vector<uint8_t>& data)
+		: m_pos(data.data())
+		, m_end(data.data() + data.size())
+	{}
+
+	const uint8_t* ReadBytes(size_t size)
+	{
+		if (size > static_cast<size_t>(m_end - m_pos))
+		{
+			throw runtime_error("unexpected end of file");
+		}
+		const uint8_t* ret = m_pos;
+		m_pos += size;
+		return ret;
+	}
+
+	template <typename T> T Read()
+	{
+		T value;
+		memcpy(&value, ReadBytes(sizeof(T)), sizeof(T));
+		return value;
+	}
+
+	string ReadString(size_t fieldSize)
+	{
+		const char* str = reinterpret_cast<const char*>(ReadBytes(fieldSize));
+		return string(str, strnlen(str, fieldSize));
+	}
+
+	void Skip(size_t size) { ReadBytes(size); }
+
+private:
+	const uint8_t* m_pos;
+	const uint8_t* m_end;
+};
+
+
+// kMeshCount wavy grids of gridSize x gridSize quads, side by side, in one H3D file
+vector<uint8_t> MakeH3D(uint32_t gridSize)
+{
+	const uint32_t side = gridSize + 1;
+	const uint32_t vertexCount = side * side;
+	const uint32_t indexCount = gridSize * gridSize * 6;
+
+	vector<GridVertex> vertices;
+	vector<uint16_t> indices;
+	for (uint32_t mesh = 0; mesh < kMeshCount; ++mesh)
+	{
+		for (uint32_t z = 0; z < side; ++z)
+		{
+			for (uint32_t x = 0; x < side; ++x)
+			{
+				GridVertex vertex{};
+				vertex.position[0] = static_cast<float>(mesh * side + x);
+				vertex.position[1] = sinf(0.3f * x) * cosf(0.2f * z);
+				vertex.position[2] = static_cast<float>(z);
+				vertex.texcoord[0] = static_cast<float>(x) / gridSize;
+				vertex.texcoord[1] = static_cast<float>(z) / gridSize;
+				vertex.normal[1] = 1.0f;
+				vertex.tangent[0] = 1.0f;
+				vertex.bitangent[2] = 1.0f;
+				vertices.push_back(vertex);
+			}
+		}
+
+		// Rows of quads, which is the order a cache-unaware exporter tends to write
+		for (uint32_t z = 0; z < gridSize; ++z)
+		{
+			for (uint32_t x = 0; x < gridSize; ++x)
+			{
+				const uint16_t i0 = static_cast<uint16_t>(z * side + x);
+				const uint16_t i1 = static_cast<uint16_t>(i0 + 1);
+				const uint16_t i2 = static_cast<uint16_t>(i0 + side);
+				const uint16_t i3 = static_cast<uint16_t>(i2 + 1);
+				const uint16_t quad[] = { i0, i2, i1, i1, i2, i3 };
+				indices.insert(indices.end(), begin(quad), end(quad));
+			}
+		}
+	}
+
+	const float boundsMin[4] = { 0.0f, -1.0f, 0.0f, 0.0f };
+	const float boundsMax[4] = { static_cast<float>(kMeshCount * side), 1.0f, static_cast<float>(gridSize), 0.0f };
+
+	Writer writer;
+
+	writer.Write(kMeshCount);
+	writer.Write(kMaterialCount);
+	writer.Write(static_cast<uint32_t>(vertices.size() * sizeof(GridVertex)));
+	writer.Write(static_cast<uint32_t>(indices.size() * sizeof(uint16_t)));
+	writer.Write(uint32_t(0)); // vertexDataByteSizeDepth
+	writer.Skip(3 * sizeof(uint32_t)); // Padding
+	writer.Write(boundsMin);
+	writer.Write(boundsMax);
+
+	const H3D::Attrib attribs[] =
+	{
+		{ offsetof(GridVertex, position), 0, 3, H3D::kAttribFormatFloat },
+		{ offsetof(GridVertex, texcoord), 0, 2, H3D::kAttribFormatFloat },
+		{ offsetof(GridVertex, normal), 0, 3, H3D::kAttribFormatFloat },
+		{ offsetof(GridVertex, tangent), 0, 3, H3D::kAttribFormatFloat },
+		{ offsetof(GridVertex, bitangent), 0, 3, H3D::kAttribFormatFloat },
+	};
+	const uint32_t attribCount = sizeof(attribs) / sizeof(attribs[0]);
+
+	for (uint32_t mesh = 0; mesh < kMeshCount; ++mesh)
+	{
+		writer.Write(boundsMin);
+		writer.Write(boundsMax);
+		writer.Write(mesh % kMaterialCount);
+		writer.Write((1u << attribCount) - 1); // attribsEnabled
+		writer.Write(uint32_t(0)); // attribsEnabledDepth
+		writer.Write(static_cast<uint32_t>(sizeof(GridVertex)));
+		writer.Write(uint32_t(0)); // vertexStrideDepth
+		writer.Write(attribs);
+		writer.Skip((H3D::kMaxAttribs - attribCount) * sizeof(H3D::Attrib));
+		writer.Skip(H3D::kMaxAttribs * sizeof(H3D::Attrib)); // attribDepth
+		writer.Write(static_cast<uint32_t>(mesh * vertexCount * sizeof(GridVertex)));
+		writer.Write(vertexCount);
+		writer.Write(static_cast<uint32_t>(mesh * indexCount * sizeof(uint16_t)));
+		writer.Write(indexCount);
+		writer.Skip(2 * sizeof(uint32_t)); // vertexDataByteOffsetDepth, vertexCountDepth
+		writer.Skip(sizeof(uint32_t)); // Padding
+	}
+
+	for (uint32_t material = 0; material < kMaterialCount; ++material)
+	{
+		const string name = "material" + to_string(material);
+		writer.Skip(5 * 4 * sizeof(float)); // diffuse, specular, ambient, emissive, transparent
+		writer.Skip(3 * sizeof(float)); // opacity, shininess, specularStrength
+		writer.WriteString("Textures/" + name, H3D::kMaxTexPath);
+		writer.WriteString("Textures/" + name + "_spec", H3D::kMaxTexPath);
+		writer.WriteString("", H3D::kMaxTexPath); // texEmissivePath
+		writer.WriteString("Textures/" + name + "_norm", H3D::kMaxTexPath);
+		writer.WriteString("", 2 * H3D::kMaxTexPath); // texLightmapPath, texReflectionPath
+		writer.WriteString(name, H3D::kMaxMaterialName);
+		writer.Skip(sizeof(uint32_t)); // Padding
+	}
+
+	writer.WriteBytes(vertices.data(), vertices.size() * sizeof(GridVertex));
+	writer.WriteBytes(indices.data(), indices.size() * sizeof(uint16_t));
+
+	return move(writer.GetData());
+}
+
+
+struct H3DModel
+{
+	vector<H3D::Mesh>		meshes;
+	vector<H3D::Material>	materials;
+	const uint8_t*			vertexData;
+	uint32_t				vertexDataSize;
+	const uint8_t*			indexData;
+	uint32_t				indexDataSize;
+};
+
+
+// What LoadModelH3D does before it touches the geometry
+H3DModel ParseH3D(const vector<uint8_t>& file)
+{
+	Reader reader(file);
+	H3DModel model;
+
+	const uint32_t meshCount = reader.Read<uint32_t>();
+	const uint32_t materialCount = reader.Read<uint32_t>();
+	model.vertexDataSize = reader.Read<uint32_t>();
+	model.indexDataSize = reader.Read<uint32_t>();
+	reader.Skip(4 * sizeof(uint32_t)); // vertexDataByteSizeDepth, padding
+	reader.Skip(8 * sizeof(float)); // Bounding box
+
+	model.meshes.resize(meshCount);
+	for (auto& mesh : model.meshes)
+	{
+		memcpy(mesh.boundsMin, reader.ReadBytes(sizeof(mesh.boundsMin)), sizeof(mesh.boundsMin));
+		memcpy(mesh.boundsMax, reader.ReadBytes(sizeof(mesh.boundsMax)), sizeof(mesh.boundsMax));
+		mesh.materialIndex = reader.Read<uint32_t>();
+		mesh.attribsEnabled = reader.Read<uint32_t>();
+		reader.Skip(sizeof(uint32_t)); // attribsEnabledDepth
+		mesh.vertexStride = reader.Read<uint32_t>();
+		reader.Skip(sizeof(uint32_t)); // vertexStrideDepth
+		for (auto& attrib : mesh.attrib)
+		{
+			attrib = reader.Read<H3D::Attrib>();
+		}
+		reader.Skip(H3D::kMaxAttribs * sizeof(H3D::Attrib)); // attribDepth
+		mesh.vertexDataByteOffset = reader.Read<uint32_t>();
+		mesh.vertexCount = reader.Read<uint32_t>();
+		mesh.indexDataByteOffset = reader.Read<uint32_t>();
+		mesh.indexCount = reader.Read<uint32_t>();
+		reader.Skip(3 * sizeof(uint32_t)); // vertexDataByteOffsetDepth, vertexCountDepth, padding
+	}
+
+	model.materials.resize(materialCount);
+	for (auto& material : model.materials)
+	{
+		reader.Skip(5 * 4 * sizeof(float) + 3 * sizeof(float));
+		material.texDiffusePath = reader.ReadString(H3D::kMaxTexPath);
+		material.texSpecularPath = reader.ReadString(H3D::kMaxTexPath);
+		reader.Skip(H3D::kMaxTexPath); // texEmissivePath
+		material.texNormalPath = reader.ReadString(H3D::kMaxTexPath);
+		reader.Skip(2 * H3D::kMaxTexPath); // texLightmapPath, texReflectionPath
+		material.name = reader.ReadString(H3D::kMaxMaterialName);
+		reader.Skip(sizeof(uint32_t)); // Padding
+	}
+
+	model.vertexData = reader.ReadBytes(model.vertexDataSize);
+	model.indexData = reader.ReadBytes(model.indexDataSize);
+	return model;
+}
+
+
+// The H3D geometry after the load-time passes, which the cooker runs offline instead
+struct ProcessedModel
+{
+	vector<CookedModel::Mesh>	meshes;
+	vector<Meshlet>				meshlets;
+	vector<QuantizedVertex>		vertices;
+	vector<uint8_t>				indexData;
+};
+
+
+// Vertex cache optimization, then meshlets, then quantization, in the order LoadModelH3D and the cooker run them
+ProcessedModel ProcessH3D(const H3DModel& model)
+{
+	ProcessedModel processed;
+
+	vector<uint8_t> vertexData(model.vertexData, model.vertexData + model.vertexDataSize);
+	processed.indexData.assign(model.indexData, model.indexData + model.indexDataSize);
+	processed.vertices.resize(model.vertexDataSize / sizeof(GridVertex));
+
+	FloatVertexLayout layout;
+	layout.stride = sizeof(GridVertex);
+	layout.position = offsetof(GridVertex, position);
+	layout.texcoord = offsetof(GridVertex, texcoord);
+	layout.normal = offsetof(GridVertex, normal);
+	layout.tangent = offsetof(GridVertex, tangent);
+	layout.bitangent = offsetof(GridVertex, bitangent);
+
+	for (const auto& h3dMesh : model.meshes)
+	{
+		auto* indices = reinterpret_cast<uint16_t*>(processed.indexData.data() + h3dMesh.indexDataByteOffset);
+		uint8_t* vertices = vertexData.data() + h3dMesh.vertexDataByteOffset;
+
+		OptimizeMesh(indices, h3dMesh.indexCount, vertices, h3dMesh.vertexStride, h3dMesh.vertexCount, layout.position);
+		auto meshlets = BuildMeshlets(indices, h3dMesh.indexCount, vertices + layout.position, h3dMesh.vertexStride,
+			h3dMesh.vertexCount);
+
+		CookedModel::Mesh mesh{};
+		mesh.materialIndex = h3dMesh.materialIndex;
+		mesh.indexCount = h3dMesh.indexCount;
+		mesh.startIndex = h3dMesh.indexDataByteOffset / sizeof(uint16_t);
+		mesh.baseVertex = static_cast<int32_t>(h3dMesh.vertexDataByteOffset / sizeof(GridVertex));
+		mesh.firstMeshlet = static_cast<uint32_t>(processed.meshlets.size());
+		mesh.meshletCount = static_cast<uint32_t>(meshlets.size());
+		processed.meshlets.insert(processed.meshlets.end(), meshlets.begin(), meshlets.end());
+
+		const QuantizationBounds bounds = ComputePositionBounds(vertices, layout, h3dMesh.vertexCount);
+		QuantizeVertices(vertices, layout, h3dMesh.vertexCount, bounds, processed.vertices.data() + mesh.baseVertex);
+		memcpy(mesh.boundsMin, bounds.min, sizeof(bounds.min));
+		memcpy(mesh.boundsMax, bounds.max, sizeof(bounds.max));
+
+		processed.meshes.push_back(mesh);
+	}
+
+	return processed;
+}
+
+
+uint32_t AlignUp(size_t value)
+{
+	const size_t alignment = CookedModel::kSectionAlignment;
+	return static_cast<uint32_t>((value + alignment - 1) & ~(alignment - 1));
+}
+
+
+// Lays the processed model out as a .kmdl, like ModelCooker's Cook
+vector<uint8_t> WriteCooked(const H3DModel& model, const ProcessedModel& processed)
+{
+	string strings(1, '\0');
+	auto addString = [&strings](const string& str)
+	{
+		const uint32_t offset = static_cast<uint32_t>(strings.size());
+		strings.append(str).push_back('\0');
+		return offset;
+	};
+
+	vector<CookedModel::Material> materials;
+	for (const auto& h3dMaterial : model.materials)
+	{
+		CookedModel::Material material{};
+		material.name = addString(h3dMaterial.name);
+		material.texturePaths[CookedModel::kDiffuse] = addString(h3dMaterial.texDiffusePath + ".dds");
+		material.texturePaths[CookedModel::kSpecular] = addString(h3dMaterial.texSpecularPath + ".dds");
+		material.texturePaths[CookedModel::kSpecularFallback] = addString(h3dMaterial.texDiffusePath + "_specular.dds");
+		material.texturePaths[CookedModel::kNormal] = addString(h3dMaterial.texNormalPath + ".dds");
+		material.texturePaths[CookedModel::kNormalFallback] = addString(h3dMaterial.texDiffusePath + "_normal.dds");
+		materials.push_back(material);
+	}
+
+	CookedModel::Header header{};
+	header.magic = CookedModel::kMagic;
+	header.version = CookedModel::kVersion;
+	header.meshCount = static_cast<uint32_t>(processed.meshes.size());
+	header.materialCount = static_cast<uint32_t>(materials.size());
+	header.vertexStride = sizeof(QuantizedVertex);
+	header.indexSize = sizeof(uint16_t);
+	header.flags = CookedModel::kFlagQuantizedVertices;
+
+	size_t offset = sizeof(CookedModel::Header);
+	auto placeSection = [&offset](CookedModel::Section& section, size_t size)
+	{
+		section.offset = AlignUp(offset);
+		section.size = static_cast<uint32_t>(size);
+		offset = section.offset + size;
+	};
+
+	placeSection(header.meshes, processed.meshes.size() * sizeof(CookedModel::Mesh));
+	placeSection(header.materials, materials.size() * sizeof(CookedModel::Material));
+	placeSection(header.strings, strings.size());
+	placeSection(header.vertexData, processed.vertices.size() * sizeof(QuantizedVertex));
+	placeSection(header.indexData, processed.indexData.size());
+	placeSection(header.meshlets, processed.meshlets.size() * sizeof(Meshlet));
+	header.fileSize = static_cast<uint32_t>(offset);
+
+	// String offsets are relative to the file, not the table
+	for (auto& material : materials)
+	{
+		material.name += header.strings.offset;
+		for (auto& path : material.texturePaths)
+		{
+			path += header.strings.offset;
+		}
+	}
+
+	vector<uint8_t> file(header.fileSize, 0);
+	memcpy(file.data(), &header, sizeof(header));
+	memcpy(file.data() + header.meshes.offset, processed.meshes.data(), header.meshes.size);
+	memcpy(file.data() + header.materials.offset, materials.data(), header.materials.size);
+	memcpy(file.data() + header.strings.offset, strings.data(), header.strings.size);
+	memcpy(file.data() + header.vertexData.offset, processed.vertices.data(), header.vertexData.size);
+	memcpy(file.data() + header.indexData.offset, processed.indexData.data(), header.indexData.size);
+	memcpy(file.data() + header.meshlets.offset, processed.meshlets.data(), header.meshlets.size);
+	return file;
+}
+
+
+// What LoadModelCooked does before it touches the geometry.  Returns the total meshlet count, or 0 if the file
+// isn't valid.
+size_t LoadCooked(const vector<uint8_t>& file)
+{
+	if (!CookedModel::Validate(file.data(), file.size()))
+	{
+		return 0;
+	}
+
+	const auto& header = *reinterpret_cast<const CookedModel::Header*>(file.data());
+
+	size_t pathLength = 0;
+	const auto* materials = CookedModel::GetTable<CookedModel::Material>(file.data(), header.materials);
+	for (uint32_t i = 0; i < header.materialCount; ++i)
+	{
+		for (auto path : materials[i].texturePaths)
+		{
+			pathLength += strlen(CookedModel::GetString(file.data(), path));
+		}
+	}
+
+	size_t meshletCount = 0;
+	const auto* meshes = CookedModel::GetTable<CookedModel::Mesh>(file.data(), header.meshes);
+	for (uint32_t i = 0; i < header.meshCount; ++i)
+	{
+		meshletCount += meshes[i].meshletCount;
+	}
+
+	return pathLength > 0 ? meshletCount : 0;
+}
+
+
+template <typename Function>
+double MeasureMilliseconds(Function function)
+{
+	const auto startTime = high_resolution_clock::now();
+
+	for (int repetition = 0; repetition < kRepetitions; ++repetition)
+	{
+		function();
+	}
+
+	const duration<double, milli> elapsed = high_resolution_clock::now() - startTime;
+	return elapsed.count() / kRepetitions;
+}
+
+} // anonymous namespace
+
+
+int main(int argc, char* argv[])
+{
+	// Meshes use 16-bit indices
+	const uint32_t gridSize = (argc > 1) ? min(254u, max(1u, static_cast<uint32_t>(atoi(argv[1])))) : 128;
+
+	const auto h3dFile = MakeH3D(gridSize);
+
+	size_t sink = 0;
+
+	const double parseTime = MeasureMilliseconds([&]()
+	{
+		sink += ParseH3D(h3dFile).meshes.size();
+	});
+
+	const double processTime = MeasureMilliseconds([&]()
+	{
+		sink += ProcessH3D(ParseH3D(h3dFile)).meshlets.size();
+	});
+
+	vector<uint8_t> cookedFile;
+	const double cookTime = MeasureMilliseconds([&]()
+	{
+		const auto model = ParseH3D(h3dFile);
+		cookedFile = WriteCooked(model, ProcessH3D(model));
+	});
+
+	size_t cookedMeshletCount = 0;
+	const double loadTime = MeasureMilliseconds([&]()
+	{
+		cookedMeshletCount = LoadCooked(cookedFile);
+	});
+
+	printf("%u meshes of %ux%u quads, %zu bytes as H3D, %zu bytes cooked\n", kMeshCount, gridSize, gridSize,
+		h3dFile.size(), cookedFile.size());
+	printf("H3D: parse %.3f ms, parse with load-time optimization, meshlets and quantization %.3f ms\n",
+		parseTime, processTime);
+	printf("Cooked: cook %.3f ms, load %.2f us\n", cookTime, loadTime * 1000.0);
+
+	CHECK(sink > 0);
+	CHECK(cookedMeshletCount > 0);
+	CHECK(parseTime > 0.0);
+	CHECK(processTime > 0.0);
+	CHECK(cookTime > 0.0);
+
+	return KodiakTest::FinishTest("CookedModelBenchmark");
+}
\ No newline at end of file
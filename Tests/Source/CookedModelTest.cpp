@@ -0,0 +1,286 @@
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+// Author: David Elder
+//
+
+// Lays out a small cooked model by hand and checks that Validate accepts it, then corrupts one field at a time
+// and checks that Validate rejects the header, section, string, mesh and meshlet ranges that would let the
+// loader read out of bounds
+
+#include "CookedModel.h"
+
+#include "TestUtility.h"
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+
+using namespace Kodiak;
+using namespace Kodiak::CookedModel;
+using namespace std;
+
+
+namespace
+{
+
+const uint32_t kVertexStride = 3 * sizeof(float);
+const uint32_t kVertexCount = 4;
+const uint32_t kIndexCount = 6;
+const uint32_t kMeshletCount = 2;
+
+
+uint32_t AlignUp(size_t value)
+{
+	return static_cast<uint32_t>((value + kSectionAlignment - 1) & ~size_t(kSectionAlignment - 1));
+}
+
+
+// One quad, as one mesh of two one-triangle meshlets, with one material
+vector<uint8_t> MakeValidFile()
+{
+	const string strings("\0quad\0quad.dds\0", 15);
+
+	Header header{};
+	header.magic = kMagic;
+	header.version = kVersion;
+	header.meshCount = 1;
+	header.materialCount = 1;
+	header.vertexStride = kVertexStride;
+	header.indexSize = sizeof(uint16_t);
+
+	size_t offset = sizeof(Header);
+	auto placeSection = [&offset](Section& section, size_t size)
+	{
+		section.offset = AlignUp(offset);
+		section.size = static_cast<uint32_t>(size);
+		offset = section.offset + size;
+	};
+
+	placeSection(header.meshes, sizeof(Mesh));
+	placeSection(header.materials, sizeof(Material));
+	placeSection(header.strings, strings.size());
+	placeSection(header.vertexData, kVertexCount * kVertexStride);
+	placeSection(header.indexData, kIndexCount * sizeof(uint16_t));
+	placeSection(header.meshlets, kMeshletCount * sizeof(Meshlet));
+	header.fileSize = static_cast<uint32_t>(offset);
+
+	Mesh mesh{};
+	mesh.indexCount = kIndexCount;
+	mesh.meshletCount = kMeshletCount;
+
+	// String offsets are relative to the file
+	Material material{};
+	material.name = header.strings.offset + 1;
+	for (auto& path : material.texturePaths)
+	{
+		path = header.strings.offset + 6;
+	}
+
+	const float positions[kVertexCount][3] = { { 0, 0, 0 }, { 1, 0, 0 }, { 1, 1, 0 }, { 0, 1, 0 } };
+	const uint16_t indices[kIndexCount] = { 0, 1, 2, 0, 2, 3 };
+
+	Meshlet meshlets[kMeshletCount] = {};
+	meshlets[0].triangleCount = 1;
+	meshlets[1].startIndex = 3;
+	meshlets[1].triangleCount = 1;
+
+	vector<uint8_t> file(header.fileSize, 0);
+	memcpy(file.data(), &header, sizeof(header));
+	memcpy(file.data() + header.meshes.offset, &mesh, sizeof(mesh));
+	memcpy(file.data() + header.materials.offset, &material, sizeof(material));
+	memcpy(file.data() + header.strings.offset, strings.data(), strings.size());
+	memcpy(file.data() + header.vertexData.offset, positions, sizeof(positions));
+	memcpy(file.data() + header.indexData.offset, indices, sizeof(indices));
+	memcpy(file.data() + header.meshlets.offset, meshlets, sizeof(meshlets));
+	return file;
+}
+
+
+Header& GetHeader(vector<uint8_t>& file)
+{
+	return *reinterpret_cast<Header*>(file.data());
+}
+
+
+Mesh& GetMesh(vector<uint8_t>& file)
+{
+	return *reinterpret_cast<Mesh*>(file.data() + GetHeader(file).meshes.offset);
+}
+
+
+Material& GetMaterial(vector<uint8_t>& file)
+{
+	return *reinterpret_cast<Material*>(file.data() + GetHeader(file).materials.offset);
+}
+
+
+Meshlet& GetMeshlet(vector<uint8_t>& file, uint32_t index)
+{
+	return reinterpret_cast<Meshlet*>(file.data() + GetHeader(file).meshlets.offset)[index];
+}
+
+
+// Validates the quad after corrupt has changed it
+template <typename Corrupt>
+bool ValidateCorrupted(Corrupt corrupt)
+{
+	auto file = MakeValidFile();
+	corrupt(file);
+	return Validate(file.data(), file.size());
+}
+
+
+void TestValidFile()
+{
+	const auto file = MakeValidFile();
+	CHECK(Validate(file.data(), file.size()));
+
+	const auto& header = *reinterpret_cast<const Header*>(file.data());
+	const auto* materials = GetTable<Material>(file.data(), header.materials);
+	CHECK(string(GetString(file.data(), materials[0].name)) == "quad");
+	CHECK(string(GetString(file.data(), materials[0].texturePaths[kNormal])) == "quad.dds");
+
+	const auto* meshes = GetTable<Mesh>(file.data(), header.meshes);
+	CHECK_EQUAL(kIndexCount, meshes[0].indexCount);
+	CHECK_EQUAL(kMeshletCount, meshes[0].meshletCount);
+}
+
+
+void TestHeader()
+{
+	const auto file = MakeValidFile();
+	CHECK(!Validate(nullptr, file.size()));
+	CHECK(!Validate(file.data(), sizeof(Header) - 1));
+
+	CHECK(!ValidateCorrupted([](vector<uint8_t>& f) { GetHeader(f).magic = 0x4C444D4Au; }));
+
+	// Only the current version loads
+	CHECK_EQUAL(2u, kVersion);
+	CHECK(ValidateCorrupted([](vector<uint8_t>& f) { GetHeader(f).version = 2; }));
+	CHECK(!ValidateCorrupted([](vector<uint8_t>& f) { GetHeader(f).version = 1; }));
+	CHECK(!ValidateCorrupted([](vector<uint8_t>& f) { GetHeader(f).version = 3; }));
+
+	// The recorded size has to match the data, whether the file was truncated or padded
+	CHECK(!ValidateCorrupted([](vector<uint8_t>& f) { GetHeader(f).fileSize -= 1; }));
+	CHECK(!ValidateCorrupted([](vector<uint8_t>& f) { f.resize(f.size() - 1); }));
+	CHECK(!ValidateCorrupted([](vector<uint8_t>& f) { f.push_back(0); }));
+
+	CHECK(!ValidateCorrupted([](vector<uint8_t>& f) { GetHeader(f).flags = 1 << 1; }));
+	CHECK(!ValidateCorrupted([](vector<uint8_t>& f) { GetHeader(f).flags = kFlagQuantizedVertices; }));
+}
+
+
+void TestSections()
+{
+	// Past the end of the file
+	CHECK(!ValidateCorrupted([](vector<uint8_t>& f) { GetHeader(f).meshlets.size += sizeof(Meshlet); }));
+	CHECK(!ValidateCorrupted([](vector<uint8_t>& f) { GetHeader(f).vertexData.offset = GetHeader(f).fileSize; }));
+	CHECK(!ValidateCorrupted([](vector<uint8_t>& f) { GetHeader(f).meshlets.offset += kSectionAlignment; }));
+
+	// offset + size wraps around in 32 bits
+	CHECK(!ValidateCorrupted([](vector<uint8_t>& f)
+	{
+		GetHeader(f).strings.offset = 0xFFFFFFF0u;
+		GetHeader(f).strings.size = 0x20;
+	}));
+
+	// Misaligned
+	CHECK(!ValidateCorrupted([](vector<uint8_t>& f) { GetHeader(f).indexData.offset += 2; }));
+
+	// Table sizes that don't match the counts or the element size
+	CHECK(!ValidateCorrupted([](vector<uint8_t>& f) { GetHeader(f).meshCount = 2; }));
+	CHECK(!ValidateCorrupted([](vector<uint8_t>& f) { GetHeader(f).materialCount = 0; }));
+	CHECK(!ValidateCorrupted([](vector<uint8_t>& f) { GetHeader(f).meshlets.size -= 4; }));
+	CHECK(!ValidateCorrupted([](vector<uint8_t>& f) { GetHeader(f).vertexData.size -= 4; }));
+	CHECK(!ValidateCorrupted([](vector<uint8_t>& f) { GetHeader(f).vertexStride = 0; }));
+	CHECK(!ValidateCorrupted([](vector<uint8_t>& f) { GetHeader(f).indexSize = sizeof(uint32_t); }));
+}
+
+
+void TestStrings()
+{
+	CHECK(!ValidateCorrupted([](vector<uint8_t>& f)
+	{
+		const auto& strings = GetHeader(f).strings;
+		f[strings.offset + strings.size - 1] = 'x';
+	}));
+	CHECK(!ValidateCorrupted([](vector<uint8_t>& f) { GetHeader(f).strings.size = 0; }));
+
+	// Offsets just outside the table, on either side
+	CHECK(!ValidateCorrupted([](vector<uint8_t>& f) { GetMaterial(f).name = GetHeader(f).strings.offset - 1; }));
+	CHECK(!ValidateCorrupted([](vector<uint8_t>& f)
+	{
+		GetMaterial(f).texturePaths[kNormalFallback] = GetHeader(f).strings.offset + GetHeader(f).strings.size;
+	}));
+	CHECK(ValidateCorrupted([](vector<uint8_t>& f)
+	{
+		GetMaterial(f).texturePaths[kNormalFallback] = GetHeader(f).strings.offset + GetHeader(f).strings.size - 1;
+	}));
+}
+
+
+void TestMeshRanges()
+{
+	CHECK(!ValidateCorrupted([](vector<uint8_t>& f) { GetMesh(f).materialIndex = 1; }));
+
+	CHECK(!ValidateCorrupted([](vector<uint8_t>& f) { GetMesh(f).startIndex = 1; }));
+	CHECK(!ValidateCorrupted([](vector<uint8_t>& f) { GetMesh(f).indexCount = kIndexCount + 3; }));
+	CHECK(!ValidateCorrupted([](vector<uint8_t>& f)
+	{
+		GetMesh(f).startIndex = 0xFFFFFFFFu;
+		GetMesh(f).indexCount = 2;
+		GetMesh(f).meshletCount = 0;
+	}));
+
+	CHECK(!ValidateCorrupted([](vector<uint8_t>& f) { GetMesh(f).baseVertex = -1; }));
+	CHECK(!ValidateCorrupted([](vector<uint8_t>& f) { GetMesh(f).baseVertex = kVertexCount + 1; }));
+
+	CHECK(!ValidateCorrupted([](vector<uint8_t>& f) { GetMesh(f).firstMeshlet = 1; }));
+	CHECK(!ValidateCorrupted([](vector<uint8_t>& f) { GetMesh(f).meshletCount = kMeshletCount + 1; }));
+
+	// A mesh without meshlets can point anywhere in the table
+	CHECK(ValidateCorrupted([](vector<uint8_t>& f)
+	{
+		GetMesh(f).firstMeshlet = kMeshletCount;
+		GetMesh(f).meshletCount = 0;
+	}));
+}
+
+
+void TestMeshletRanges()
+{
+	// Meshlet index ranges are relative to the mesh and have to end within it
+	CHECK(!ValidateCorrupted([](vector<uint8_t>& f) { GetMeshlet(f, 1).triangleCount = 2; }));
+	CHECK(!ValidateCorrupted([](vector<uint8_t>& f) { GetMeshlet(f, 1).startIndex = kIndexCount; }));
+	CHECK(!ValidateCorrupted([](vector<uint8_t>& f) { GetMeshlet(f, 0).triangleCount = 0xFFFFFFFFu; }));
+
+	// A shorter mesh leaves the second meshlet hanging off its end, although the index data covers it
+	CHECK(!ValidateCorrupted([](vector<uint8_t>& f) { GetMesh(f).indexCount = 3; }));
+
+	CHECK(ValidateCorrupted([](vector<uint8_t>& f) { GetMeshlet(f, 1).triangleCount = 0; }));
+	CHECK(ValidateCorrupted([](vector<uint8_t>& f)
+	{
+		GetMeshlet(f, 0).triangleCount = 2;
+		GetMesh(f).meshletCount = 1;
+	}));
+}
+
+} // anonymous namespace
+
+
+int main()
+{
+	TestValidFile();
+	TestHeader();
+	TestSections();
+	TestStrings();
+	TestMeshRanges();
+	TestMeshletRanges();
+
+	return KodiakTest::FinishTest("CookedModelTest");
+}
\ No newline at end of file
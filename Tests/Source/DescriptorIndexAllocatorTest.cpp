@@ -0,0 +1,223 @@
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+// Author: David Elder
+//
+
+// Checks DescriptorIndexAllocator: keys share a slot while referenced, a full heap hands out kInvalidIndex, and a
+// released slot is only reused once the fence it was retired with completes.  The bindless heap acquires each key
+// once, which TestReuseAfterFence follows.
+
+#include "DescriptorIndexAllocator.h"
+
+#include "TestUtility.h"
+
+#include <set>
+
+
+using namespace Kodiak;
+using namespace std;
+
+
+namespace
+{
+
+// Stands in for the command list manager's fence
+struct TestFence
+{
+	uint64_t completed{ 0 };
+
+	bool operator()(uint64_t fenceValue) const { return fenceValue <= completed; }
+};
+
+
+void TestRefCounts()
+{
+	DescriptorIndexAllocator allocator(8);
+
+	bool isNew = false;
+	const uint32_t first = allocator.Acquire(100, isNew);
+	CHECK(isNew);
+	CHECK(first != DescriptorIndexAllocator::kInvalidIndex);
+
+	// Only the first reference fills in the descriptor
+	CHECK_EQUAL(first, allocator.Acquire(100, isNew));
+	CHECK(!isNew);
+	CHECK_EQUAL(1u, allocator.GetNumUsed());
+
+	const uint32_t second = allocator.Acquire(200, isNew);
+	CHECK(isNew);
+	CHECK(second != first);
+	CHECK_EQUAL(2u, allocator.GetNumUsed());
+
+	// The slot is kept until the last reference goes
+	allocator.Release(100);
+	CHECK_EQUAL(first, allocator.Find(100));
+	CHECK(!allocator.HasReleased());
+
+	allocator.Release(100);
+	CHECK_EQUAL(DescriptorIndexAllocator::kInvalidIndex, allocator.Find(100));
+	CHECK(allocator.HasReleased());
+	CHECK_EQUAL(1u, allocator.GetNumUsed());
+	CHECK_EQUAL(1u, allocator.GetNumPending());
+
+	// Acquired again, the key gets a new slot to fill in, since the old one may still be read
+	const uint32_t again = allocator.Acquire(100, isNew);
+	CHECK(isNew);
+	CHECK(again != first);
+	CHECK(again != second);
+}
+
+
+void TestExhaustion()
+{
+	const uint32_t capacity = 4;
+	DescriptorIndexAllocator allocator(capacity);
+
+	set<uint32_t> indices;
+	bool isNew = false;
+	for (uint32_t key = 0; key < capacity; ++key)
+	{
+		const uint32_t index = allocator.Acquire(key, isNew);
+		CHECK(isNew);
+		CHECK(index < capacity);
+		indices.insert(index);
+	}
+	CHECK_EQUAL(size_t(capacity), indices.size());
+
+	isNew = true;
+	CHECK_EQUAL(DescriptorIndexAllocator::kInvalidIndex, allocator.Acquire(capacity, isNew));
+	CHECK(!isNew);
+	CHECK_EQUAL(DescriptorIndexAllocator::kInvalidIndex, allocator.Find(capacity));
+
+	// Keys that already have a slot still get it
+	CHECK(allocator.Acquire(0, isNew) != DescriptorIndexAllocator::kInvalidIndex);
+	CHECK(!isNew);
+
+	// Releasing doesn't make room until the slot is retired and its fence completes
+	allocator.Release(1);
+	CHECK_EQUAL(DescriptorIndexAllocator::kInvalidIndex, allocator.Acquire(capacity, isNew));
+
+	allocator.RetireReleased(1);
+	CHECK_EQUAL(DescriptorIndexAllocator::kInvalidIndex, allocator.Acquire(capacity, isNew));
+
+	TestFence fence;
+	allocator.Reclaim(fence);
+	CHECK_EQUAL(DescriptorIndexAllocator::kInvalidIndex, allocator.Acquire(capacity, isNew));
+
+	fence.completed = 1;
+	allocator.Reclaim(fence);
+	CHECK(allocator.Acquire(capacity, isNew) < capacity);
+	CHECK(isNew);
+}
+
+
+void TestRetireAndReclaimOrder()
+{
+	DescriptorIndexAllocator allocator(16);
+	TestFence fence;
+
+	bool isNew = false;
+	uint32_t indices[6];
+	for (uint32_t key = 0; key < 6; ++key)
+	{
+		indices[key] = allocator.Acquire(key, isNew);
+	}
+
+	// Three frames, each releasing two slots and retiring them with its own fence
+	allocator.Release(0);
+	allocator.Release(1);
+	allocator.RetireReleased(10);
+
+	allocator.Release(2);
+	allocator.Release(3);
+	allocator.RetireReleased(20);
+
+	allocator.Release(4);
+	allocator.Release(5);
+	CHECK(allocator.HasReleased());
+	CHECK_EQUAL(6u, allocator.GetNumPending());
+
+	// Reclaiming frees nothing while the fences are outstanding
+	fence.completed = 9;
+	allocator.Reclaim(fence);
+	CHECK_EQUAL(6u, allocator.GetNumPending());
+
+	// Only slots retired with a completed fence come back.  The ones not yet retired wait for the next fence.
+	fence.completed = 20;
+	allocator.Reclaim(fence);
+	CHECK_EQUAL(2u, allocator.GetNumPending());
+	CHECK(allocator.HasReleased());
+
+	allocator.RetireReleased(30);
+	CHECK(!allocator.HasReleased());
+	allocator.Reclaim(fence);
+	CHECK_EQUAL(2u, allocator.GetNumPending());
+
+	// Reclaim stops at the first fence that hasn't completed, even if later ones report done
+	const uint32_t reused = allocator.Acquire(100, isNew);
+	allocator.Release(100);
+	allocator.RetireReleased(40);
+	allocator.Reclaim([](uint64_t fenceValue) { return fenceValue != 30; });
+	CHECK_EQUAL(3u, allocator.GetNumPending());
+
+	fence.completed = 40;
+	allocator.Reclaim(fence);
+	CHECK_EQUAL(0u, allocator.GetNumPending());
+
+	// Freed slots are handed out before untouched ones
+	const set<uint32_t> freed(begin(indices), end(indices));
+	CHECK(freed.count(reused) == 1);
+
+	set<uint32_t> acquired;
+	for (uint32_t key = 200; key < 206; ++key)
+	{
+		acquired.insert(allocator.Acquire(key, isNew));
+	}
+	CHECK(acquired == freed);
+}
+
+
+void TestReuseAfterFence()
+{
+	// The streaming case: a texture's new view takes a new key while draws may still read the old slot
+	DescriptorIndexAllocator allocator(2);
+	TestFence fence;
+
+	bool isNew = false;
+	const uint32_t oldView = allocator.Acquire(1, isNew);
+	const uint32_t newView = allocator.Acquire(2, isNew);
+	CHECK(isNew);
+	CHECK(oldView != newView);
+
+	// The material moves to the new slot and lets go of the old one, in frame 5
+	allocator.Release(1);
+	allocator.RetireReleased(5);
+
+	// The next view can't take the old slot while frame 5 is in flight
+	fence.completed = 4;
+	allocator.Reclaim(fence);
+	CHECK_EQUAL(DescriptorIndexAllocator::kInvalidIndex, allocator.Acquire(3, isNew));
+
+	fence.completed = 5;
+	allocator.Reclaim(fence);
+	CHECK_EQUAL(oldView, allocator.Acquire(3, isNew));
+	CHECK(isNew);
+	CHECK_EQUAL(newView, allocator.Find(2));
+}
+
+} // anonymous namespace
+
+
+int main()
+{
+	TestRefCounts();
+	TestExhaustion();
+	TestRetireAndReclaimOrder();
+	TestReuseAfterFence();
+
+	return KodiakTest::FinishTest("DescriptorIndexAllocatorTest");
+}
\ No newline at end of file
@@ -0,0 +1,206 @@
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+// Author: David Elder
+//
+
+// Checks DescriptorTableMap the way DynamicDescriptorHeap uses it: tables staged with the same handles in
+// their assigned slots are found again, anything else is copied, and nothing survives the heap being retired
+
+#include "DescriptorTableMap.h"
+
+#include "TestUtility.h"
+
+
+using namespace Kodiak;
+using namespace std;
+
+
+namespace
+{
+
+// Stands in for D3D12_CPU_DESCRIPTOR_HANDLE
+struct TestHandle
+{
+	size_t ptr;
+};
+
+typedef DescriptorTableMap<TestHandle> TableMap;
+
+const uint32_t kNumSlots = 32;
+
+
+// Handles for a staged table, with every slot filled in so unassigned ones hold something too
+void FillHandles(TestHandle (&handles)[kNumSlots], size_t base)
+{
+	for (uint32_t i = 0; i < kNumSlots; ++i)
+	{
+		handles[i].ptr = base + i * 64;
+	}
+}
+
+
+void TestHashCoversAssignedSlots()
+{
+	TestHandle handles[kNumSlots];
+	FillHandles(handles, 0x10000);
+
+	const uint32_t assigned = 0x0000000Bu;	// Slots 0, 1 and 3
+	const uint64_t hash = TableMap::Hash(handles, assigned);
+
+	// Unassigned slots aren't copied, so they don't change the hash
+	TestHandle changed[kNumSlots];
+	FillHandles(changed, 0x10000);
+	changed[2].ptr = 0x99999;
+	changed[31].ptr = 0x99999;
+	CHECK_EQUAL(hash, TableMap::Hash(changed, assigned));
+
+	// Assigned ones do
+	changed[3].ptr = 0x99999;
+	CHECK(hash != TableMap::Hash(changed, assigned));
+
+	// A subset of the same handles is a different table
+	CHECK(hash != TableMap::Hash(handles, 0x00000003u));
+	CHECK(hash != TableMap::Hash(handles, 0x0000000Fu));
+
+	// So is the same handle in a different slot
+	TestHandle slot0[kNumSlots] = {};
+	TestHandle slot1[kNumSlots] = {};
+	slot0[0].ptr = 0x20000;
+	slot1[1].ptr = 0x20000;
+	CHECK(TableMap::Hash(slot0, 0x1u) != TableMap::Hash(slot1, 0x2u));
+
+	// The top slot takes part
+	TestHandle top[kNumSlots];
+	FillHandles(top, 0x10000);
+	const uint64_t topHash = TableMap::Hash(top, 0x80000001u);
+	top[31].ptr = 0x99999;
+	CHECK(topHash != TableMap::Hash(top, 0x80000001u));
+
+	// Hashing reads nothing when no slot is assigned
+	CHECK_EQUAL(TableMap::Hash(handles, 0), TableMap::Hash(nullptr, 0));
+}
+
+
+void TestFind()
+{
+	TableMap map;
+
+	TestHandle handles[kNumSlots];
+	FillHandles(handles, 0x10000);
+
+	const uint32_t assigned = 0x00010105u;	// Slots 0, 2, 8 and 16
+	const uint64_t hash = TableMap::Hash(handles, assigned);
+
+	CHECK_EQUAL(TableMap::kNotFound, map.Find(hash, handles, assigned));
+
+	map.Insert(hash, handles, assigned, 40);
+	CHECK_EQUAL(1u, map.GetSize());
+	CHECK_EQUAL(40u, map.Find(hash, handles, assigned));
+
+	// Staged again with different handles in the unassigned slots, it's still the same table
+	TestHandle restaged[kNumSlots];
+	FillHandles(restaged, 0x50000);
+	restaged[0] = handles[0];
+	restaged[2] = handles[2];
+	restaged[8] = handles[8];
+	restaged[16] = handles[16];
+	CHECK_EQUAL(40u, map.Find(TableMap::Hash(restaged, assigned), restaged, assigned));
+
+	// Matching the hash isn't enough: the handles and the bitmap are compared too
+	restaged[8].ptr = 0x99999;
+	CHECK_EQUAL(TableMap::kNotFound, map.Find(hash, restaged, assigned));
+	CHECK_EQUAL(TableMap::kNotFound, map.Find(hash, handles, assigned & ~0x100u));
+	CHECK_EQUAL(TableMap::kNotFound, map.Find(hash, handles, assigned | 0x2u));
+
+	// Tables over a subset of the slots are kept apart
+	const uint32_t subset = 0x00000005u;
+	map.Insert(TableMap::Hash(handles, subset), handles, subset, 80);
+	CHECK_EQUAL(2u, map.GetSize());
+	CHECK_EQUAL(80u, map.Find(TableMap::Hash(handles, subset), handles, subset));
+	CHECK_EQUAL(40u, map.Find(hash, handles, assigned));
+}
+
+
+void TestCollisionReplaces()
+{
+	TableMap map;
+
+	TestHandle first[kNumSlots];
+	TestHandle second[kNumSlots];
+	FillHandles(first, 0x10000);
+	FillHandles(second, 0x20000);
+
+	// Force both tables onto one hash, as if they collided
+	const uint64_t hash = 12345;
+	map.Insert(hash, first, 0x7u, 8);
+	CHECK_EQUAL(8u, map.Find(hash, first, 0x7u));
+	CHECK_EQUAL(TableMap::kNotFound, map.Find(hash, second, 0x7u));
+
+	// The newer table takes the entry, and the older one is copied again next time
+	map.Insert(hash, second, 0x3u, 16);
+	CHECK_EQUAL(1u, map.GetSize());
+	CHECK_EQUAL(16u, map.Find(hash, second, 0x3u));
+	CHECK_EQUAL(TableMap::kNotFound, map.Find(hash, first, 0x7u));
+	CHECK_EQUAL(TableMap::kNotFound, map.Find(hash, second, 0x7u));
+
+	// Reinserting with fewer slots doesn't leave the old handles behind
+	map.Insert(hash, first, 0x1u, 24);
+	CHECK_EQUAL(24u, map.Find(hash, first, 0x1u));
+	CHECK_EQUAL(TableMap::kNotFound, map.Find(hash, first, 0x7u));
+}
+
+
+void TestClearOnHeapRetire()
+{
+	TableMap map;
+
+	// Fill a heap's worth of tables, the way one command list would
+	const uint32_t numTables = 64;
+	const uint32_t tableSize = 4;
+	const uint32_t assigned = (1u << tableSize) - 1;
+
+	vector<uint64_t> hashes;
+	for (uint32_t table = 0; table < numTables; ++table)
+	{
+		TestHandle handles[kNumSlots];
+		FillHandles(handles, 0x100000 * (table + 1));
+		hashes.push_back(TableMap::Hash(handles, assigned));
+		map.Insert(hashes.back(), handles, assigned, table * tableSize);
+	}
+	CHECK_EQUAL(numTables, map.GetSize());
+
+	// Retiring the heap throws every offset away, since they point into it
+	map.Clear();
+	CHECK_EQUAL(0u, map.GetSize());
+
+	for (uint32_t table = 0; table < numTables; ++table)
+	{
+		TestHandle handles[kNumSlots];
+		FillHandles(handles, 0x100000 * (table + 1));
+		CHECK_EQUAL(TableMap::kNotFound, map.Find(hashes[table], handles, assigned));
+	}
+
+	// The next heap starts over
+	TestHandle handles[kNumSlots];
+	FillHandles(handles, 0x100000);
+	map.Insert(hashes[0], handles, assigned, 0);
+	CHECK_EQUAL(0u, map.Find(hashes[0], handles, assigned));
+	CHECK_EQUAL(1u, map.GetSize());
+}
+
+} // anonymous namespace
+
+
+int main()
+{
+	TestHashCoversAssignedSlots();
+	TestFind();
+	TestCollisionReplaces();
+	TestClearOnHeapRetire();
+
+	return KodiakTest::FinishTest("DescriptorTableMapTest");
+}
\ No newline at end of file
@@ -0,0 +1,166 @@
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+// Author: David Elder
+//
+
+// Sweeps a ready queue of 50k resources the way ResourceLoader::Update does, checks that every expired
+// entry is erased and no live one is, and reports the per-frame cost against a full sweep
+
+#include "ExpiredEntrySweep.h"
+
+#include "TestUtility.h"
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+
+using namespace Kodiak;
+using namespace std;
+using namespace std::chrono;
+
+
+namespace
+{
+
+const size_t kNumResources = 50000;
+const size_t kBucketsPerFrame = 256;
+
+typedef unordered_map<string, weak_ptr<int>> ReadyQueue;
+
+
+double ToMicroseconds(high_resolution_clock::duration elapsed)
+{
+	return duration_cast<duration<double, micro>>(elapsed).count();
+}
+
+
+// Fills the queue, keeping every resource alive except one in every expireEvery
+void FillQueue(ReadyQueue& readyQueue, vector<shared_ptr<int>>& liveResources, size_t expireEvery)
+{
+	for (size_t i = 0; i < kNumResources; ++i)
+	{
+		auto resource = make_shared<int>(static_cast<int>(i));
+		readyQueue["Textures/Resource" + to_string(i) + ".dds"] = resource;
+		liveResources.push_back(resource);
+	}
+
+	for (size_t i = 0; i < kNumResources; i += expireEvery)
+	{
+		liveResources[i].reset();
+	}
+}
+
+
+void BenchmarkIncrementalSweep()
+{
+	ReadyQueue readyQueue;
+	vector<shared_ptr<int>> liveResources;
+	FillQueue(readyQueue, liveResources, 10);
+
+	const size_t numExpired = (kNumResources + 9) / 10;
+	const size_t framesPerPass = (readyQueue.bucket_count() + kBucketsPerFrame - 1) / kBucketsPerFrame;
+
+	size_t cursor = 0;
+	vector<string> expiredKeys;
+	size_t numErased = 0;
+	high_resolution_clock::duration total{ 0 };
+	high_resolution_clock::duration worst{ 0 };
+
+	for (size_t frame = 0; frame < framesPerPass; ++frame)
+	{
+		const auto startTime = high_resolution_clock::now();
+
+		CollectExpired(readyQueue, cursor, kBucketsPerFrame, expiredKeys);
+		numErased += EraseExpired(readyQueue, expiredKeys);
+		expiredKeys.clear();
+
+		const auto elapsed = high_resolution_clock::now() - startTime;
+		total += elapsed;
+		worst = max(worst, elapsed);
+	}
+
+	CHECK_EQUAL(numExpired, numErased);
+	CHECK_EQUAL(kNumResources - numExpired, readyQueue.size());
+
+	// Nothing left to find, and a frame with nothing expired doesn't erase anything
+	CollectExpired(readyQueue, cursor, readyQueue.bucket_count(), expiredKeys);
+	CHECK(expiredKeys.empty());
+
+	printf("%zu resources, %zu buckets, %zu buckets per frame: %zu frames per pass, %.1f us per frame on average, %.1f us worst\n",
+		kNumResources, readyQueue.bucket_count(), kBucketsPerFrame, framesPerPass,
+		ToMicroseconds(total) / framesPerPass, ToMicroseconds(worst));
+}
+
+
+void BenchmarkFullSweep()
+{
+	ReadyQueue readyQueue;
+	vector<shared_ptr<int>> liveResources;
+	FillQueue(readyQueue, liveResources, 10);
+
+	const auto startTime = high_resolution_clock::now();
+
+	size_t cursor = 0;
+	vector<string> expiredKeys;
+	CollectExpired(readyQueue, cursor, readyQueue.bucket_count(), expiredKeys);
+	const size_t numErased = EraseExpired(readyQueue, expiredKeys);
+
+	const auto elapsed = high_resolution_clock::now() - startTime;
+
+	CHECK_EQUAL((kNumResources + 9) / 10, numErased);
+	printf("Full sweep of %zu resources: %.1f us\n", kNumResources, ToMicroseconds(elapsed));
+}
+
+
+// A key that expired when collected but was reloaded before the erase has to survive
+void TestReloadedBeforeErase()
+{
+	ReadyQueue readyQueue;
+	auto resource = make_shared<int>(0);
+	readyQueue["Reloaded.dds"] = resource;
+	resource.reset();
+
+	size_t cursor = 0;
+	vector<string> expiredKeys;
+	CollectExpired(readyQueue, cursor, readyQueue.bucket_count(), expiredKeys);
+	CHECK_EQUAL(size_t(1), expiredKeys.size());
+
+	auto reloaded = make_shared<int>(1);
+	readyQueue["Reloaded.dds"] = reloaded;
+
+	CHECK_EQUAL(size_t(0), EraseExpired(readyQueue, expiredKeys));
+	CHECK_EQUAL(size_t(1), readyQueue.size());
+}
+
+
+// Rehashing to fewer buckets mustn't leave the cursor out of range
+void TestCursorAfterRehash()
+{
+	ReadyQueue readyQueue;
+	readyQueue["Expired.dds"] = weak_ptr<int>();
+
+	size_t cursor = readyQueue.bucket_count() + 100;
+	vector<string> expiredKeys;
+	CollectExpired(readyQueue, cursor, readyQueue.bucket_count(), expiredKeys);
+	CHECK_EQUAL(size_t(1), expiredKeys.size());
+	CHECK(cursor < readyQueue.bucket_count());
+}
+
+} // anonymous namespace
+
+
+int main()
+{
+	TestReloadedBeforeErase();
+	TestCursorAfterRehash();
+	BenchmarkIncrementalSweep();
+	BenchmarkFullSweep();
+
+	return KodiakTest::FinishTest("ExpiredEntrySweepBenchmark");
+}
\ No newline at end of file
@@ -0,0 +1,453 @@
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+// Author: David Elder
+//
+
+// Builds meshlets for a flat grid and a sphere, and checks their limits, coverage and bounds, that the normal
+// cone only rejects clusters facing away from the camera, and the index ranges the CPU cull emits
+
+#include "Meshlet.h"
+
+#include "TestUtility.h"
+
+#include <array>
+#include <cmath>
+#include <set>
+
+
+using namespace Kodiak;
+using namespace std;
+
+
+namespace
+{
+
+// Positions are followed by a normal and a uv, like the engine's vertices, so the stride is exercised
+struct TestVertex
+{
+	float position[3];
+	float normal[3];
+	float uv[2];
+};
+
+
+struct TestMesh
+{
+	vector<TestVertex>	vertices;
+	vector<uint16_t>	indices;
+};
+
+
+TestVertex MakeVertex(float x, float y, float z)
+{
+	TestVertex vertex = {};
+	vertex.position[0] = x;
+	vertex.position[1] = y;
+	vertex.position[2] = z;
+	return vertex;
+}
+
+
+// size x size quads in the z = 0 plane, from (0, 0) to (size, size), facing +z
+TestMesh MakeGrid(uint32_t size)
+{
+	TestMesh mesh;
+	for (uint32_t y = 0; y <= size; ++y)
+	{
+		for (uint32_t x = 0; x <= size; ++x)
+		{
+			mesh.vertices.push_back(MakeVertex(float(x), float(y), 0.0f));
+		}
+	}
+
+	for (uint32_t y = 0; y < size; ++y)
+	{
+		for (uint32_t x = 0; x < size; ++x)
+		{
+			const uint16_t v0 = static_cast<uint16_t>(y * (size + 1) + x);
+			const uint16_t v1 = static_cast<uint16_t>(v0 + 1);
+			const uint16_t v2 = static_cast<uint16_t>(v0 + size + 1);
+			const uint16_t v3 = static_cast<uint16_t>(v2 + 1);
+
+			const uint16_t quad[6] = { v0, v1, v3, v0, v3, v2 };
+			mesh.indices.insert(mesh.indices.end(), quad, quad + 6);
+		}
+	}
+
+	return mesh;
+}
+
+
+// A unit sphere around the origin, with outward facing triangles
+TestMesh MakeSphere(uint32_t rings, uint32_t segments)
+{
+	const float pi = 3.14159265f;
+
+	TestMesh mesh;
+	for (uint32_t ring = 0; ring <= rings; ++ring)
+	{
+		const float theta = pi * ring / rings;
+		for (uint32_t segment = 0; segment <= segments; ++segment)
+		{
+			const float phi = 2.0f * pi * segment / segments;
+			mesh.vertices.push_back(MakeVertex(sinf(theta) * cosf(phi), sinf(theta) * sinf(phi), cosf(theta)));
+		}
+	}
+
+	for (uint32_t ring = 0; ring < rings; ++ring)
+	{
+		for (uint32_t segment = 0; segment < segments; ++segment)
+		{
+			const uint16_t v0 = static_cast<uint16_t>(ring * (segments + 1) + segment);
+			const uint16_t v1 = static_cast<uint16_t>(v0 + 1);
+			const uint16_t v2 = static_cast<uint16_t>(v0 + segments + 1);
+			const uint16_t v3 = static_cast<uint16_t>(v2 + 1);
+
+			// The poles' degenerate triangles are kept, since real meshes have them too
+			const uint16_t quad[6] = { v0, v2, v3, v0, v3, v1 };
+			mesh.indices.insert(mesh.indices.end(), quad, quad + 6);
+		}
+	}
+
+	return mesh;
+}
+
+
+vector<Meshlet> Build(TestMesh& mesh)
+{
+	return BuildMeshlets(mesh.indices.data(), mesh.indices.size(), reinterpret_cast<const uint8_t*>(mesh.vertices.data()),
+		sizeof(TestVertex), mesh.vertices.size());
+}
+
+
+typedef array<uint16_t, 3> Triangle;
+
+multiset<Triangle> GetTriangles(const vector<uint16_t>& indices)
+{
+	multiset<Triangle> triangles;
+	for (size_t i = 0; i + 2 < indices.size(); i += 3)
+	{
+		triangles.insert(Triangle{ { indices[i], indices[i + 1], indices[i + 2] } });
+	}
+	return triangles;
+}
+
+
+float Distance(const float* a, const float* b)
+{
+	const float dx = a[0] - b[0];
+	const float dy = a[1] - b[1];
+	const float dz = a[2] - b[2];
+	return sqrtf(dx * dx + dy * dy + dz * dz);
+}
+
+
+void CheckMeshlets(const TestMesh& original, const TestMesh& mesh, const vector<Meshlet>& meshlets)
+{
+	CHECK(!meshlets.empty());
+
+	// Triangles are reordered, never changed, added or dropped
+	CHECK(GetTriangles(original.indices) == GetTriangles(mesh.indices));
+
+	// The meshlets tile the index buffer in order, so each triangle is in exactly one
+	uint32_t nextIndex = 0;
+	for (const auto& meshlet : meshlets)
+	{
+		CHECK_EQUAL(nextIndex, meshlet.startIndex);
+		nextIndex = meshlet.startIndex + meshlet.triangleCount * 3;
+
+		CHECK(meshlet.triangleCount > 0);
+		CHECK(meshlet.triangleCount <= kMaxMeshletTriangles);
+
+		set<uint16_t> vertices(mesh.indices.begin() + meshlet.startIndex, mesh.indices.begin() + nextIndex);
+		CHECK(vertices.size() <= kMaxMeshletVertices);
+		CHECK_EQUAL(vertices.size(), size_t(meshlet.vertexCount));
+
+		// The bounding sphere holds every vertex
+		for (uint16_t vertex : vertices)
+		{
+			CHECK(Distance(mesh.vertices[vertex].position, meshlet.center) <= meshlet.radius * 1.0001f + 1e-5f);
+		}
+	}
+	CHECK_EQUAL(mesh.indices.size(), size_t(nextIndex));
+}
+
+
+void TestLimitsAndCoverage()
+{
+	for (uint32_t size : { 1u, 7u, 40u })
+	{
+		const auto original = MakeGrid(size);
+		auto mesh = original;
+		const auto meshlets = Build(mesh);
+		CheckMeshlets(original, mesh, meshlets);
+
+		// A connected grid fills its meshlets, rather than leaving them half empty
+		if (size == 40)
+		{
+			const size_t triangleCount = mesh.indices.size() / 3;
+			CHECK(meshlets.size() <= 2 * (triangleCount / kMaxMeshletTriangles + 1));
+		}
+	}
+
+	const auto original = MakeSphere(24, 48);
+	auto mesh = original;
+	const auto meshlets = Build(mesh);
+	CheckMeshlets(original, mesh, meshlets);
+
+	// Nothing to build from an empty mesh
+	vector<uint16_t> noIndices;
+	CHECK(BuildMeshlets(noIndices.data(), 0, nullptr, sizeof(TestVertex), 0).empty());
+}
+
+
+MeshletCullView MakeView(const float cameraPosition[3], bool backfaceCulling)
+{
+	MeshletCullView view = {};
+	view.planeCount = 0;
+	view.cameraPosition[0] = cameraPosition[0];
+	view.cameraPosition[1] = cameraPosition[1];
+	view.cameraPosition[2] = cameraPosition[2];
+	view.backfaceCulling = backfaceCulling;
+	return view;
+}
+
+
+size_t CountCulled(const vector<Meshlet>& meshlets, const MeshletCullView& view)
+{
+	vector<MeshletIndexRange> ranges;
+	MeshletCullStats stats;
+	CullMeshlets(meshlets.data(), meshlets.size(), view, ranges, &stats);
+	return stats.backfaceCulledMeshlets;
+}
+
+
+void TestNormalCone()
+{
+	// Flat meshlets facing +z are rejected from anywhere below the plane, and kept from anywhere above it
+	auto grid = MakeGrid(40);
+	const auto gridMeshlets = Build(grid);
+
+	const float below[3] = { 20.0f, 20.0f, -10.0f };
+	const float above[3] = { 20.0f, 20.0f, 10.0f };
+	const float farBelow[3] = { -500.0f, 300.0f, -1.0f };
+	CHECK_EQUAL(gridMeshlets.size(), CountCulled(gridMeshlets, MakeView(below, true)));
+	CHECK_EQUAL(gridMeshlets.size(), CountCulled(gridMeshlets, MakeView(farBelow, true)));
+	CHECK_EQUAL(size_t(0), CountCulled(gridMeshlets, MakeView(above, true)));
+
+	// Unless backface culling is off, for two-sided materials
+	CHECK_EQUAL(size_t(0), CountCulled(gridMeshlets, MakeView(below, false)));
+
+	// On a sphere, a meshlet may only be rejected if every one of its triangles faces away from the camera,
+	// and the far side is rejected when seen from outside
+	auto sphere = MakeSphere(24, 48);
+	const auto sphereMeshlets = Build(sphere);
+
+	const float cameras[][3] = { { 0.0f, 0.0f, 3.0f }, { 4.0f, -2.0f, 1.0f }, { 0.0f, 1.5f, 0.0f }, { -10.0f, 0.0f, -10.0f } };
+	for (const auto& camera : cameras)
+	{
+		size_t culledCount = 0;
+		for (const auto& meshlet : sphereMeshlets)
+		{
+			vector<MeshletIndexRange> ranges;
+			MeshletCullStats stats;
+			CullMeshlets(&meshlet, 1, MakeView(camera, true), ranges, &stats);
+			if (stats.backfaceCulledMeshlets == 0)
+			{
+				continue;
+			}
+			++culledCount;
+
+			for (uint32_t i = 0; i < meshlet.triangleCount; ++i)
+			{
+				const uint16_t* triangle = &sphere.indices[meshlet.startIndex + i * 3];
+				const float* p0 = sphere.vertices[triangle[0]].position;
+				const float* p1 = sphere.vertices[triangle[1]].position;
+				const float* p2 = sphere.vertices[triangle[2]].position;
+
+				const float e1[3] = { p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2] };
+				const float e2[3] = { p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2] };
+				const float normal[3] = { e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2], e1[0] * e2[1] - e1[1] * e2[0] };
+				const float toTriangle[3] = { p0[0] - camera[0], p0[1] - camera[1], p0[2] - camera[2] };
+
+				// Back facing, or degenerate
+				CHECK(normal[0] * toTriangle[0] + normal[1] * toTriangle[1] + normal[2] * toTriangle[2] >= -1e-5f);
+			}
+		}
+
+		// Outside the sphere, some of the far side goes
+		const float distance = sqrtf(camera[0] * camera[0] + camera[1] * camera[1] + camera[2] * camera[2]);
+		if (distance > 1.0f)
+		{
+			CHECK(culledCount > 0);
+		}
+	}
+
+	// From the center every triangle faces away, so most of the sphere goes
+	const float center[3] = { 0.0f, 0.0f, 0.0f };
+	CHECK(CountCulled(sphereMeshlets, MakeView(center, true)) * 2 > sphereMeshlets.size());
+}
+
+
+void TestFrustumRanges()
+{
+	auto grid = MakeGrid(40);
+	const auto meshlets = Build(grid);
+
+	const float camera[3] = { 20.0f, 20.0f, 10.0f };
+	auto view = MakeView(camera, true);
+
+	// Everything inside: the meshlets are contiguous, so one range covers the whole mesh
+	vector<MeshletIndexRange> ranges;
+	MeshletCullStats stats;
+	CHECK_EQUAL(size_t(1), CullMeshlets(meshlets.data(), meshlets.size(), view, ranges, &stats));
+	CHECK_EQUAL(0u, ranges[0].startIndex);
+	CHECK_EQUAL(uint32_t(grid.indices.size()), ranges[0].indexCount);
+	CHECK_EQUAL(meshlets.size(), stats.meshletCount);
+	CHECK_EQUAL(grid.indices.size() / 3, stats.triangleCount);
+	CHECK_EQUAL(size_t(1), stats.rangeCount);
+
+	// Keep x >= 25, which cuts through the meshlets' rows.  The expected ranges are worked out meshlet by meshlet,
+	// merging neighbours.
+	view.planes[0][0] = 1.0f;
+	view.planes[0][1] = 0.0f;
+	view.planes[0][2] = 0.0f;
+	view.planes[0][3] = -25.0f;
+	view.planeCount = 1;
+
+	vector<MeshletIndexRange> expected;
+	size_t expectedCulled = 0;
+	for (const auto& meshlet : meshlets)
+	{
+		if (meshlet.center[0] - 25.0f < -meshlet.radius)
+		{
+			++expectedCulled;
+			continue;
+		}
+
+		if (!expected.empty() && expected.back().startIndex + expected.back().indexCount == meshlet.startIndex)
+		{
+			expected.back().indexCount += meshlet.triangleCount * 3;
+		}
+		else
+		{
+			expected.push_back({ meshlet.startIndex, meshlet.triangleCount * 3 });
+		}
+	}
+	CHECK(expectedCulled > 0);
+	CHECK(expectedCulled < meshlets.size());
+
+	// Ranges already in the list are left alone, and the new ones are appended after them
+	ranges.assign(1, MeshletIndexRange{ 1000, 3 });
+	MeshletCullStats planeStats;
+	const size_t rangeCount = CullMeshlets(meshlets.data(), meshlets.size(), view, ranges, &planeStats);
+	CHECK_EQUAL(expected.size(), rangeCount);
+	CHECK_EQUAL(expected.size() + 1, ranges.size());
+	CHECK_EQUAL(1000u, ranges[0].startIndex);
+	CHECK_EQUAL(expectedCulled, planeStats.frustumCulledMeshlets);
+
+	for (size_t i = 0; i < expected.size() && i + 1 < ranges.size(); ++i)
+	{
+		CHECK_EQUAL(expected[i].startIndex, ranges[i + 1].startIndex);
+		CHECK_EQUAL(expected[i].indexCount, ranges[i + 1].indexCount);
+	}
+
+	// The ranges are compacted: in order, and never touching, since touching ones would have been merged
+	for (size_t i = 2; i < ranges.size(); ++i)
+	{
+		CHECK(ranges[i - 1].startIndex + ranges[i - 1].indexCount < ranges[i].startIndex);
+	}
+
+	// Culling is conservative: every triangle reaching past the plane is drawn
+	vector<bool> drawn(grid.indices.size() / 3, false);
+	size_t drawnTriangles = 0;
+	for (size_t i = 1; i < ranges.size(); ++i)
+	{
+		for (uint32_t index = ranges[i].startIndex; index < ranges[i].startIndex + ranges[i].indexCount; index += 3)
+		{
+			drawn[index / 3] = true;
+			++drawnTriangles;
+		}
+	}
+	CHECK_EQUAL(planeStats.triangleCount - planeStats.frustumCulledTriangles, drawnTriangles);
+
+	for (size_t triangle = 0; triangle < drawn.size(); ++triangle)
+	{
+		for (uint32_t corner = 0; corner < 3; ++corner)
+		{
+			if (grid.vertices[grid.indices[triangle * 3 + corner]].position[0] > 25.0f)
+			{
+				CHECK(drawn[triangle]);
+			}
+		}
+	}
+
+	// All outside: nothing
+	view.planes[0][3] = -100.0f;
+	ranges.clear();
+	CHECK_EQUAL(size_t(0), CullMeshlets(meshlets.data(), meshlets.size(), view, ranges, nullptr));
+	CHECK(ranges.empty());
+
+	// Indirect draws offset the ranges into the pooled buffers
+	const MeshletIndexRange drawRanges[2] = { { 0, 36 }, { 120, 9 } };
+	DrawIndexedArguments arguments[2];
+	MakeDrawIndexedArguments(drawRanges, 2, 3000, 500, arguments);
+	CHECK_EQUAL(36u, arguments[0].indexCountPerInstance);
+	CHECK_EQUAL(3000u, arguments[0].startIndexLocation);
+	CHECK_EQUAL(9u, arguments[1].indexCountPerInstance);
+	CHECK_EQUAL(3120u, arguments[1].startIndexLocation);
+	CHECK_EQUAL(500, arguments[1].baseVertexLocation);
+	CHECK_EQUAL(1u, arguments[1].instanceCount);
+	CHECK_EQUAL(0u, arguments[1].startInstanceLocation);
+}
+
+
+void TestCullViewPlanes()
+{
+	// With an identity matrix the clip volume is -1 <= x, y <= 1 and 0 <= z <= 1
+	const float identity[4][4] = { { 1, 0, 0, 0 }, { 0, 1, 0, 0 }, { 0, 0, 1, 0 }, { 0, 0, 0, 1 } };
+	const float origin[3] = { 0.0f, 0.0f, 0.0f };
+	const auto view = MakeMeshletCullView(identity, origin);
+	CHECK_EQUAL(6u, view.planeCount);
+	CHECK(view.backfaceCulling);
+
+	auto isInside = [&view](float x, float y, float z)
+	{
+		for (uint32_t p = 0; p < view.planeCount; ++p)
+		{
+			if (view.planes[p][0] * x + view.planes[p][1] * y + view.planes[p][2] * z + view.planes[p][3] < 0.0f)
+			{
+				return false;
+			}
+		}
+		return true;
+	};
+
+	CHECK(isInside(0.0f, 0.0f, 0.5f));
+	CHECK(isInside(0.99f, -0.99f, 0.01f));
+	CHECK(!isInside(1.01f, 0.0f, 0.5f));
+	CHECK(!isInside(0.0f, -1.01f, 0.5f));
+	CHECK(!isInside(0.0f, 0.0f, -0.01f));
+	CHECK(!isInside(0.0f, 0.0f, 1.01f));
+
+	// Clip z equal to clip w has no far plane
+	const float infiniteFar[4][4] = { { 1, 0, 0, 0 }, { 0, 1, 0, 0 }, { 0, 0, 1, 1 }, { 0, 0, -0.1f, 0 } };
+	CHECK_EQUAL(5u, MakeMeshletCullView(infiniteFar, origin).planeCount);
+}
+
+} // anonymous namespace
+
+
+int main()
+{
+	TestLimitsAndCoverage();
+	TestNormalCone();
+	TestFrustumRanges();
+	TestCullViewPlanes();
+
+	return KodiakTest::FinishTest("MeshletTest");
+}
\ No newline at end of file
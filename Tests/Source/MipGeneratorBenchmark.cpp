@@ -0,0 +1,119 @@
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+// Author: David Elder
+//
+
+// Time taken by MipGenerator to build a full mip chain, in milliseconds per megapixel of the top level, on one
+// thread.  DDSMipGenerator splits each level's rows across threads, so this is the per-core cost.  Pass a
+// surface size to override the default 2048.
+//
+//   MipGeneratorBenchmark [size]
+
+#include "MipGenerator.h"
+
+#include "TestUtility.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <vector>
+
+
+using namespace Kodiak;
+using namespace std;
+using namespace std::chrono;
+
+
+namespace
+{
+
+const int kRepetitions = 3;
+
+
+double MeasureMillisecondsPerMegapixel(MipFormat format, MipFilter filter, const vector<uint8_t>& topLevel, uint32_t size)
+{
+	const size_t pixelBytes = GetMipFormatPixelBytes(format);
+
+	// Every level below the top, back to back
+	vector<uint8_t> chain(topLevel.size());
+	const uint32_t mipCount = GetFullMipCount(size, size);
+
+	const auto startTime = high_resolution_clock::now();
+
+	for (int repetition = 0; repetition < kRepetitions; ++repetition)
+	{
+		const uint8_t* src = topLevel.data();
+		uint8_t* dest = chain.data();
+		uint32_t width = size;
+		uint32_t height = size;
+
+		for (uint32_t mip = 1; mip < mipCount; ++mip)
+		{
+			const uint32_t destWidth = max(1u, width / 2);
+			const uint32_t destHeight = max(1u, height / 2);
+			GenerateMipRows(format, filter, src, width, height, width * pixelBytes, dest, destWidth * pixelBytes, 0, destHeight);
+
+			src = dest;
+			dest += destWidth * destHeight * pixelBytes;
+			width = destWidth;
+			height = destHeight;
+		}
+	}
+
+	const duration<double, milli> elapsed = high_resolution_clock::now() - startTime;
+	return elapsed.count() / kRepetitions / (static_cast<double>(size) * size / 1.0e6);
+}
+
+} // anonymous namespace
+
+
+int main(int argc, char* argv[])
+{
+	const uint32_t size = (argc > 1) ? max(1u, static_cast<uint32_t>(atoi(argv[1]))) : 2048;
+
+	const struct
+	{
+		MipFormat	format;
+		const char*	name;
+	} formats[] =
+	{
+		{ MipFormat::RGBA8, "RGBA8" },
+		{ MipFormat::RGBA8_sRGB, "RGBA8 sRGB" },
+		{ MipFormat::RGBA16F, "RGBA16F" },
+	};
+
+	printf("%ux%u, one thread\n", size, size);
+
+	uint32_t seed = 1;
+	for (const auto& format : formats)
+	{
+		vector<uint8_t> topLevel(size_t(size) * size * GetMipFormatPixelBytes(format.format));
+		for (auto& byte : topLevel)
+		{
+			seed = seed * 1664525u + 1013904223u;
+			byte = static_cast<uint8_t>(seed >> 24);
+		}
+
+		// Keep random halves away from NaNs and infinities, which would make the timings unrepresentative
+		if (format.format == MipFormat::RGBA16F)
+		{
+			for (size_t i = 1; i < topLevel.size(); i += 2)
+			{
+				topLevel[i] &= 0x3B;
+			}
+		}
+
+		const double box = MeasureMillisecondsPerMegapixel(format.format, MipFilter::Box, topLevel, size);
+		const double kaiser = MeasureMillisecondsPerMegapixel(format.format, MipFilter::Kaiser, topLevel, size);
+		printf("%s: box %.2f ms/MP, Kaiser %.2f ms/MP\n", format.name, box, kaiser);
+
+		CHECK(box > 0.0);
+		CHECK(kaiser > 0.0);
+	}
+
+	return KodiakTest::FinishTest("MipGeneratorBenchmark");
+}
\ No newline at end of file
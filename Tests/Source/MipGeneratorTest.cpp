@@ -0,0 +1,379 @@
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+// Author: David Elder
+//
+
+// Checks MipGenerator against scalar references: box rounding on odd sizes, sRGB filtering in linear space,
+// half float rounding to nearest even, and the Kaiser filter against a double precision 2D version of it
+
+#include "MipGenerator.h"
+
+#include "TestUtility.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+
+using namespace Kodiak;
+using namespace std;
+
+
+namespace
+{
+
+struct Image
+{
+	uint32_t		width;
+	uint32_t		height;
+	vector<uint8_t>	pixels;
+};
+
+
+uint32_t NextRandom(uint32_t& seed)
+{
+	seed = seed * 1664525u + 1013904223u;
+	return seed >> 8;
+}
+
+
+Image MakeRandomRGBA8(uint32_t width, uint32_t height, uint32_t seed)
+{
+	Image image{ width, height, vector<uint8_t>(size_t(width) * height * 4) };
+	for (auto& byte : image.pixels)
+	{
+		byte = static_cast<uint8_t>(NextRandom(seed));
+	}
+	return image;
+}
+
+
+Image GenerateMip(MipFormat format, MipFilter filter, const Image& src)
+{
+	const size_t pixelBytes = GetMipFormatPixelBytes(format);
+
+	Image dest{ max(1u, src.width / 2), max(1u, src.height / 2), vector<uint8_t>() };
+	dest.pixels.resize(size_t(dest.width) * dest.height * pixelBytes);
+	GenerateMipRows(format, filter, src.pixels.data(), src.width, src.height, src.width * pixelBytes,
+		dest.pixels.data(), dest.width * pixelBytes, 0, dest.height);
+	return dest;
+}
+
+
+// Decodes a half without relying on the code under test
+double HalfToDouble(uint16_t half)
+{
+	const double sign = (half & 0x8000) ? -1.0 : 1.0;
+	const int exponent = (half >> 10) & 0x1F;
+	const int mantissa = half & 0x3FF;
+
+	if (exponent == 0x1F)
+	{
+		return sign * HUGE_VAL;
+	}
+	if (exponent == 0)
+	{
+		return sign * ldexp(mantissa, -24);
+	}
+	return sign * ldexp(1024 + mantissa, exponent - 25);
+}
+
+
+// The half nearest to value, ties to even, as a double
+double RoundToHalf(double value)
+{
+	const double magnitude = fabs(value);
+	if (magnitude >= 65520.0)
+	{
+		return copysign(HUGE_VAL, value);
+	}
+
+	int exponent = 0;
+	frexp(magnitude, &exponent);
+	const double quantum = ldexp(1.0, max(exponent - 1, -14) - 10);
+
+	// Under the default rounding mode, nearbyint rounds ties to even
+	return copysign(nearbyint(magnitude / quantum) * quantum, value);
+}
+
+
+void TestBoxOddSizes()
+{
+	const uint32_t sizes[][2] = { { 7, 5 }, { 9, 1 }, { 1, 9 }, { 1, 1 }, { 17, 3 }, { 33, 33 }, { 2, 7 } };
+
+	uint32_t seed = 1;
+	for (const auto& size : sizes)
+	{
+		const Image src = MakeRandomRGBA8(size[0], size[1], ++seed);
+		const Image dest = GenerateMip(MipFormat::RGBA8, MipFilter::Box, src);
+
+		CHECK_EQUAL(max(1u, size[0] / 2), dest.width);
+		CHECK_EQUAL(max(1u, size[1] / 2), dest.height);
+
+		// Each texel averages a 2x2 footprint, clamped at the edges of 1 texel wide sources, rounding halves up
+		for (uint32_t y = 0; y < dest.height; ++y)
+		{
+			const uint32_t y0 = 2 * y;
+			const uint32_t y1 = min(y0 + 1, src.height - 1);
+			for (uint32_t x = 0; x < dest.width; ++x)
+			{
+				const uint32_t x0 = 2 * x;
+				const uint32_t x1 = min(x0 + 1, src.width - 1);
+				for (uint32_t c = 0; c < 4; ++c)
+				{
+					auto at = [&src, c](uint32_t sx, uint32_t sy) { return uint32_t(src.pixels[(sy * src.width + sx) * 4 + c]); };
+					const uint32_t expected = (at(x0, y0) + at(x1, y0) + at(x0, y1) + at(x1, y1) + 2) / 4;
+					CHECK_EQUAL(expected, uint32_t(dest.pixels[(y * dest.width + x) * 4 + c]));
+				}
+			}
+		}
+	}
+
+	// Exact halves round up
+	Image halves{ 2, 2, { 0, 1, 2, 3,  1, 2, 3, 4,  0, 1, 2, 3,  1, 2, 3, 4 } };
+	const Image rounded = GenerateMip(MipFormat::RGBA8, MipFilter::Box, halves);
+	const uint8_t expected[4] = { 1, 2, 3, 4 };
+	CHECK(memcmp(expected, rounded.pixels.data(), 4) == 0);
+}
+
+
+void TestRowRanges()
+{
+	// Generating rows in disjoint ranges, as the loader does across threads, matches generating them at once
+	for (MipFilter filter : { MipFilter::Box, MipFilter::Kaiser })
+	{
+		const Image src = MakeRandomRGBA8(45, 37, 7);
+		const Image whole = GenerateMip(MipFormat::RGBA8_sRGB, filter, src);
+
+		vector<uint8_t> pieces(whole.pixels.size());
+		for (uint32_t firstRow = 0; firstRow < whole.height; firstRow += 5)
+		{
+			GenerateMipRows(MipFormat::RGBA8_sRGB, filter, src.pixels.data(), src.width, src.height, src.width * 4,
+				pieces.data(), whole.width * 4, firstRow, 5);
+		}
+		CHECK(pieces == whole.pixels);
+	}
+}
+
+
+void TestSRGBCheckerboard()
+{
+	// Black and white average to half intensity in linear space, which is 188 in sRGB, not 128.  Alpha is linear.
+	Image checkerboard{ 8, 8, vector<uint8_t>(8 * 8 * 4) };
+	for (uint32_t y = 0; y < 8; ++y)
+	{
+		for (uint32_t x = 0; x < 8; ++x)
+		{
+			const uint8_t value = ((x + y) & 1) ? 255 : 0;
+			uint8_t* texel = &checkerboard.pixels[(y * 8 + x) * 4];
+			texel[0] = texel[1] = texel[2] = texel[3] = value;
+		}
+	}
+
+	const Image srgb = GenerateMip(MipFormat::RGBA8_sRGB, MipFilter::Box, checkerboard);
+	const Image linear = GenerateMip(MipFormat::RGBA8, MipFilter::Box, checkerboard);
+	for (uint32_t i = 0; i < 16; ++i)
+	{
+		CHECK_EQUAL(188, int(srgb.pixels[i * 4 + 0]));
+		CHECK_EQUAL(188, int(srgb.pixels[i * 4 + 2]));
+		CHECK_EQUAL(128, int(srgb.pixels[i * 4 + 3]));
+		CHECK_EQUAL(128, int(linear.pixels[i * 4 + 0]));
+	}
+
+	// Flat sRGB values survive the round trip through linear
+	for (uint32_t value = 0; value < 256; ++value)
+	{
+		Image flat{ 2, 2, vector<uint8_t>(16, static_cast<uint8_t>(value)) };
+		const Image reduced = GenerateMip(MipFormat::RGBA8_sRGB, MipFilter::Box, flat);
+		CHECK_EQUAL(value, uint32_t(reduced.pixels[0]));
+		CHECK_EQUAL(value, uint32_t(reduced.pixels[3]));
+	}
+}
+
+
+void TestHalfRounding()
+{
+	// A 2x2 image whose columns hold the halves a and b averages to (a + b) / 2, so neighbouring halves land on
+	// the tie between them, and random pairs land anywhere in between
+	uint32_t seed = 11;
+	uint32_t roundedCount = 0;
+	for (uint32_t i = 0; i < 200000; ++i)
+	{
+		uint16_t a = static_cast<uint16_t>(NextRandom(seed));
+		uint16_t b = (i & 1) ? static_cast<uint16_t>(a + 1) : static_cast<uint16_t>(NextRandom(seed));
+
+		// Keep to finite values of one sign, so the sum can't overflow
+		a &= 0xFBFF;
+		b = static_cast<uint16_t>((b & 0x7BFF) | (a & 0x8000));
+
+		Image src{ 2, 2, vector<uint8_t>(32) };
+		for (uint32_t texel = 0; texel < 4; ++texel)
+		{
+			const uint16_t half = (texel & 1) ? b : a;
+			for (uint32_t c = 0; c < 4; ++c)
+			{
+				memcpy(&src.pixels[texel * 8 + c * 2], &half, 2);
+			}
+		}
+
+		const Image dest = GenerateMip(MipFormat::RGBA16F, MipFilter::Box, src);
+
+		uint16_t result;
+		memcpy(&result, dest.pixels.data(), 2);
+
+		// The box filter's float arithmetic, which is exact unless a and b are far apart
+		const float top = static_cast<float>(HalfToDouble(a)) + static_cast<float>(HalfToDouble(b));
+		const double average = (top + top) * 0.25f;
+		const double expected = RoundToHalf(average);
+		CHECK_EQUAL(expected, HalfToDouble(result));
+		CHECK_EQUAL(signbit(expected), signbit(HalfToDouble(result)));
+
+		if (expected != average)
+		{
+			++roundedCount;
+		}
+
+		// Every channel converts the same way
+		CHECK(memcmp(dest.pixels.data(), dest.pixels.data() + 2, 2) == 0);
+		CHECK(memcmp(dest.pixels.data(), dest.pixels.data() + 6, 2) == 0);
+	}
+	CHECK(roundedCount > 1000);
+
+	// Halves that are already exact pass through, denormals and zeros included
+	const uint16_t exact[] = { 0x0000, 0x8000, 0x0001, 0x03FF, 0x0400, 0x3C00, 0xBC00, 0x7BFF, 0xFBFF, 0x3555 };
+	for (uint16_t half : exact)
+	{
+		Image src{ 2, 2, vector<uint8_t>(32) };
+		for (uint32_t i = 0; i < 16; ++i)
+		{
+			memcpy(&src.pixels[i * 2], &half, 2);
+		}
+
+		const Image dest = GenerateMip(MipFormat::RGBA16F, MipFilter::Box, src);
+		uint16_t result;
+		memcpy(&result, dest.pixels.data(), 2);
+		CHECK_EQUAL(half, result);
+	}
+}
+
+
+// The Kaiser filter as described in MipGenerator.cpp, in double precision and without the separable passes
+vector<double> MakeKaiserWeights()
+{
+	const double pi = 3.14159265358979323846;
+	const double alpha = 4.0;
+	const double width = 3.0;
+
+	auto besselI0 = [](double x)
+	{
+		double sum = 1.0;
+		double term = 1.0;
+		for (int k = 1; k < 64; ++k)
+		{
+			term *= (x / (2.0 * k)) * (x / (2.0 * k));
+			sum += term;
+		}
+		return sum;
+	};
+
+	vector<double> weights(12);
+	double sum = 0.0;
+	for (int k = 0; k < 12; ++k)
+	{
+		const double t = (k - 5 - 0.5) * 0.5;
+		const double window = t / width;
+		const double sinc = (t == 0.0) ? 1.0 : sin(pi * t) / (pi * t);
+		weights[k] = sinc * besselI0(alpha * sqrt(max(0.0, 1.0 - window * window))) / besselI0(alpha);
+		sum += weights[k];
+	}
+	for (auto& weight : weights)
+	{
+		weight /= sum;
+	}
+	return weights;
+}
+
+
+void TestKaiser()
+{
+	const auto weights = MakeKaiserWeights();
+
+	const uint32_t sizes[][2] = { { 32, 32 }, { 13, 27 }, { 4, 3 }, { 64, 2 } };
+	uint32_t seed = 3;
+	for (const auto& size : sizes)
+	{
+		const Image src = MakeRandomRGBA8(size[0], size[1], ++seed);
+		const Image dest = GenerateMip(MipFormat::RGBA8, MipFilter::Kaiser, src);
+
+		const int32_t lastX = static_cast<int32_t>(src.width) - 1;
+		const int32_t lastY = static_cast<int32_t>(src.height) - 1;
+
+		int32_t maxError = 0;
+		for (uint32_t y = 0; y < dest.height; ++y)
+		{
+			for (uint32_t x = 0; x < dest.width; ++x)
+			{
+				for (uint32_t c = 0; c < 4; ++c)
+				{
+					double sum = 0.0;
+					for (int32_t j = 0; j < 12; ++j)
+					{
+						const int32_t sy = min(max(2 * static_cast<int32_t>(y) - 5 + j, 0), lastY);
+						for (int32_t k = 0; k < 12; ++k)
+						{
+							const int32_t sx = min(max(2 * static_cast<int32_t>(x) - 5 + k, 0), lastX);
+							sum += weights[j] * weights[k] * src.pixels[(sy * src.width + sx) * 4 + c];
+						}
+					}
+
+					const int32_t expected = static_cast<int32_t>(floor(min(max(sum, 0.0), 255.0) + 0.5));
+					const int32_t actual = dest.pixels[(y * dest.width + x) * 4 + c];
+					maxError = max(maxError, abs(expected - actual));
+				}
+			}
+		}
+
+		// Only float rounding separates them
+		CHECK(maxError <= 1);
+	}
+
+	// The weights are normalized, so flat images stay flat
+	Image flat{ 16, 16, vector<uint8_t>(16 * 16 * 4, 77) };
+	const Image reduced = GenerateMip(MipFormat::RGBA8, MipFilter::Kaiser, flat);
+	for (uint8_t value : reduced.pixels)
+	{
+		CHECK_EQUAL(77, int(value));
+	}
+}
+
+
+void TestFullMipCount()
+{
+	CHECK_EQUAL(1u, GetFullMipCount(1, 1));
+	CHECK_EQUAL(2u, GetFullMipCount(2, 1));
+	CHECK_EQUAL(3u, GetFullMipCount(7, 5));
+	CHECK_EQUAL(11u, GetFullMipCount(1024, 1024));
+	CHECK_EQUAL(11u, GetFullMipCount(1024, 3));
+	CHECK_EQUAL(4u, GetMipFormatPixelBytes(MipFormat::RGBA8_sRGB));
+	CHECK_EQUAL(8u, GetMipFormatPixelBytes(MipFormat::RGBA16F));
+}
+
+} // anonymous namespace
+
+
+int main()
+{
+	TestBoxOddSizes();
+	TestRowRanges();
+	TestSRGBCheckerboard();
+	TestHalfRounding();
+	TestKaiser();
+	TestFullMipCount();
+
+	return KodiakTest::FinishTest("MipGeneratorTest");
+}
\ No newline at end of file
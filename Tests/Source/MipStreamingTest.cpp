@@ -0,0 +1,222 @@
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+// Author: David Elder
+//
+
+// Runs MipStreamingScheduler against a simulated memory budget
+
+#include "MipStreaming.h"
+
+#include "TestUtility.h"
+
+
+using namespace Kodiak;
+using namespace std;
+
+
+namespace
+{
+
+// A square RGBA8 texture with a full mip chain, starting at its coarsest stage
+MipStreamingState MakeState(uint64_t id, float priority, uint32_t width, uint32_t desiredMip, uint32_t minDetailMip)
+{
+	MipStreamingState state;
+	state.id = id;
+	state.priority = priority;
+	state.desiredMip = desiredMip;
+	state.minDetailMip = minDetailMip;
+	state.residentMip = minDetailMip;
+	state.residentBytes.fill(0);
+
+	uint32_t mipCount = 0;
+	for (uint32_t size = width; size > 0; size >>= 1)
+	{
+		++mipCount;
+	}
+
+	size_t total = 0;
+	for (uint32_t mip = mipCount; mip-- > 0;)
+	{
+		const size_t size = max<uint32_t>(1, width >> mip);
+		total += size * size * 4;
+		state.residentBytes[mip] = total;
+	}
+
+	return state;
+}
+
+
+const MipStreamingState* FindState(const vector<MipStreamingState>& states, uint64_t id)
+{
+	for (const auto& state : states)
+	{
+		if (state.id == id)
+		{
+			return &state;
+		}
+	}
+	return nullptr;
+}
+
+
+void TestDesiredMip()
+{
+	CHECK_EQUAL(0u, ComputeDesiredMip(5.0f, 10.0f, 11));
+	CHECK_EQUAL(0u, ComputeDesiredMip(10.0f, 10.0f, 11));
+	CHECK_EQUAL(1u, ComputeDesiredMip(20.0f, 10.0f, 11));
+	CHECK_EQUAL(1u, ComputeDesiredMip(39.0f, 10.0f, 11));
+	CHECK_EQUAL(2u, ComputeDesiredMip(40.0f, 10.0f, 11));
+	CHECK_EQUAL(10u, ComputeDesiredMip(1.0e6f, 10.0f, 11));
+	CHECK_EQUAL(0u, ComputeDesiredMip(100.0f, 10.0f, 1));
+	CHECK_EQUAL(0u, ComputeDesiredMip(100.0f, 0.0f, 11));
+}
+
+
+// Everything fits, so every texture converges on its desired mip, one stage per pass
+void TestConvergesWithinBudget()
+{
+	MipStreamingScheduler scheduler;
+	scheduler.SetMemoryBudget(64 * 1024 * 1024);
+	scheduler.SetMipsPerStage(2);
+	scheduler.SetMaxStreamsPerUpdate(2);
+
+	vector<MipStreamingState> states;
+	for (uint64_t id = 0; id < 4; ++id)
+	{
+		states.push_back(MakeState(id, 1.0f + id, 1024, 0, 8));
+	}
+
+	// Four textures, two streams per pass, four stages from mip 8 to mip 0
+	uint32_t passes = 0;
+	while (passes < 100)
+	{
+		auto decisions = scheduler.Schedule(states);
+		CHECK(decisions.size() <= 2);
+		CHECK(MipStreamingScheduler::ComputeResidentBytes(states) <= scheduler.GetMemoryBudget());
+		if (decisions.empty())
+		{
+			break;
+		}
+		++passes;
+	}
+
+	CHECK_EQUAL(8u, passes);
+	for (const auto& state : states)
+	{
+		CHECK_EQUAL(0u, state.residentMip);
+	}
+}
+
+
+// With room for only part of the detail, the high priority textures win and the budget is never exceeded
+void TestRespectsBudget()
+{
+	const size_t fullTexture = MakeState(0, 0.0f, 1024, 0, 10).residentBytes[0];
+
+	MipStreamingScheduler scheduler;
+	scheduler.SetMemoryBudget(fullTexture * 2 + fullTexture / 2);
+	scheduler.SetMaxStreamsPerUpdate(4);
+
+	vector<MipStreamingState> states;
+	for (uint64_t id = 0; id < 8; ++id)
+	{
+		states.push_back(MakeState(id, static_cast<float>(id), 1024, 0, 10));
+	}
+
+	for (uint32_t pass = 0; pass < 200; ++pass)
+	{
+		scheduler.Schedule(states);
+		CHECK(MipStreamingScheduler::ComputeResidentBytes(states) <= scheduler.GetMemoryBudget());
+	}
+
+	// The two highest priorities are fully resident, and nothing below them outranks what's left over
+	CHECK_EQUAL(0u, FindState(states, 7)->residentMip);
+	CHECK_EQUAL(0u, FindState(states, 6)->residentMip);
+	for (uint64_t id = 1; id < 6; ++id)
+	{
+		CHECK(FindState(states, id)->residentMip >= FindState(states, id + 1)->residentMip);
+	}
+}
+
+
+// A high priority texture takes memory from lower priority ones, but never from its equals or betters
+void TestEvictsLowerPriority()
+{
+	const size_t fullTexture = MakeState(0, 0.0f, 1024, 0, 10).residentBytes[0];
+
+	MipStreamingScheduler scheduler;
+	scheduler.SetMemoryBudget(fullTexture + fullTexture / 2);
+	scheduler.SetMipsPerStage(16);
+
+	vector<MipStreamingState> states;
+	states.push_back(MakeState(1, 1.0f, 1024, 0, 10));
+	states[0].residentMip = 0;
+	states.push_back(MakeState(2, 5.0f, 1024, 0, 10));
+
+	auto decisions = scheduler.Schedule(states);
+	CHECK_EQUAL(0u, FindState(states, 2)->residentMip);
+	CHECK(FindState(states, 1)->residentMip > 0);
+	CHECK(FindState(states, 1)->residentMip <= 10);
+	CHECK_EQUAL(size_t(2), decisions.size());
+	CHECK(MipStreamingScheduler::ComputeResidentBytes(states) <= scheduler.GetMemoryBudget());
+
+	// Raising the evicted texture to the same priority doesn't let it take the memory back
+	states[0].priority = 5.0f;
+	const uint32_t evictedMip = FindState(states, 1)->residentMip;
+	for (uint32_t pass = 0; pass < 10; ++pass)
+	{
+		scheduler.Schedule(states);
+	}
+	CHECK_EQUAL(0u, FindState(states, 2)->residentMip);
+	CHECK_EQUAL(evictedMip, FindState(states, 1)->residentMip);
+}
+
+
+// Shrinking the budget trims resident detail, down to but never past each texture's coarsest stage
+void TestBudgetShrink()
+{
+	MipStreamingScheduler scheduler;
+	scheduler.SetMemoryBudget(64 * 1024 * 1024);
+
+	vector<MipStreamingState> states;
+	for (uint64_t id = 0; id < 4; ++id)
+	{
+		states.push_back(MakeState(id, 1.0f + id, 1024, 0, 6));
+		states.back().residentMip = 0;
+	}
+
+	const size_t halfBudget = MipStreamingScheduler::ComputeResidentBytes(states) / 2;
+	scheduler.SetMemoryBudget(halfBudget);
+	scheduler.Schedule(states);
+	CHECK(MipStreamingScheduler::ComputeResidentBytes(states) <= halfBudget);
+
+	// The lowest priority gives up its detail first
+	CHECK(FindState(states, 0)->residentMip > 0);
+	CHECK_EQUAL(0u, FindState(states, 3)->residentMip);
+
+	// A budget below the coarsest stages can't be met, and the scheduler stops at minDetailMip
+	scheduler.SetMemoryBudget(1);
+	scheduler.Schedule(states);
+	for (const auto& state : states)
+	{
+		CHECK_EQUAL(6u, state.residentMip);
+	}
+}
+
+} // anonymous namespace
+
+
+int main()
+{
+	TestDesiredMip();
+	TestConvergesWithinBudget();
+	TestRespectsBudget();
+	TestEvictsLowerPriority();
+	TestBudgetShrink();
+
+	return KodiakTest::FinishTest("MipStreamingTest");
+}
\ No newline at end of file
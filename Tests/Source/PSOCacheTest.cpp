@@ -0,0 +1,307 @@
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+// Author: David Elder
+//
+
+// Round trips the PSO cache through its file format, and checks that files written on another adapter, driver
+// or format version, corrupted or truncated files are rejected, and that entries nobody asked for are dropped
+
+#include "PSOCache.h"
+
+#include "TestUtility.h"
+
+#include <cstring>
+#include <string>
+
+
+using namespace Kodiak;
+using namespace std;
+
+
+namespace
+{
+
+// Offsets into the file header
+const size_t kVersionOffset = 4;
+const size_t kEntryCountOffset = 24;
+const size_t kChecksumOffset = 32;
+const size_t kHeaderSize = 40;
+
+
+PSOCacheDeviceId MakeDeviceId()
+{
+	PSOCacheDeviceId deviceId;
+	deviceId.vendorId = 0x10DE;
+	deviceId.deviceId = 0x1B80;
+	deviceId.driverVersion = 0x0017001100000000ULL;
+	return deviceId;
+}
+
+
+vector<uint8_t> MakeBlob(uint8_t seed, size_t size)
+{
+	vector<uint8_t> blob(size);
+	for (size_t i = 0; i < size; ++i)
+	{
+		blob[i] = static_cast<uint8_t>(seed + i * 13);
+	}
+	return blob;
+}
+
+
+// A file holding three blobs, keyed 1 to 3
+vector<uint8_t> MakeCacheFile()
+{
+	PSOCache cache;
+	cache.SetDeviceId(MakeDeviceId());
+
+	for (uint8_t key = 1; key <= 3; ++key)
+	{
+		const auto blob = MakeBlob(key, 100 * key);
+		cache.Store(key, blob.data(), blob.size());
+	}
+
+	vector<uint8_t> data;
+	cache.Serialize(data);
+	return data;
+}
+
+
+bool Load(PSOCache& cache, const vector<uint8_t>& data)
+{
+	return cache.Deserialize(data.data(), data.size());
+}
+
+
+template <typename T>
+void Patch(vector<uint8_t>& data, size_t offset, T value)
+{
+	memcpy(data.data() + offset, &value, sizeof(T));
+}
+
+
+// Rewrites the checksum, so the test gets past it to the checks behind it
+void FixChecksum(vector<uint8_t>& data)
+{
+	Patch(data, kChecksumOffset, HashPSOBytes(data.data() + kHeaderSize, data.size() - kHeaderSize));
+}
+
+
+void TestHash()
+{
+	// FNV-1a test vectors, so cache keys don't change between builds
+	CHECK_EQUAL(kPSOHashSeed, HashPSOBytes(nullptr, 0));
+	CHECK_EQUAL(0xAF63DC4C8601EC8CULL, HashPSOBytes("a", 1));
+	CHECK_EQUAL(0x85944171F73967E8ULL, HashPSOBytes("foobar", 6));
+
+	// Hashing in pieces matches hashing in one go
+	const string text = "pipeline state";
+	CHECK_EQUAL(HashPSOBytes(text.data(), text.size()), HashPSOBytes(text.data() + 8, text.size() - 8, HashPSOBytes(text.data(), 8)));
+}
+
+
+void TestRoundTrip()
+{
+	const auto data = MakeCacheFile();
+
+	PSOCache cache;
+	cache.SetDeviceId(MakeDeviceId());
+	CHECK(Load(cache, data));
+	CHECK_EQUAL(size_t(3), cache.GetStats().loadedEntries);
+
+	for (uint8_t key = 1; key <= 3; ++key)
+	{
+		vector<uint8_t> blob;
+		CHECK(cache.Find(key, blob));
+		CHECK(blob == MakeBlob(key, 100 * key));
+	}
+
+	vector<uint8_t> blob;
+	CHECK(!cache.Find(4, blob));
+
+	const auto stats = cache.GetStats();
+	CHECK_EQUAL(3u, stats.hits);
+	CHECK_EQUAL(1u, stats.misses);
+
+	// Every entry was used and nothing was added, so there's nothing to save
+	CHECK(!cache.IsDirty());
+
+	// Saved again, it loads the same
+	vector<uint8_t> saved;
+	cache.Serialize(saved);
+	CHECK_EQUAL(data.size(), saved.size());
+
+	PSOCache reloaded;
+	reloaded.SetDeviceId(MakeDeviceId());
+	CHECK(Load(reloaded, saved));
+	CHECK(reloaded.Find(2, blob));
+	CHECK(blob == MakeBlob(2, 200));
+
+	// An empty cache round trips too
+	PSOCache empty;
+	empty.SetDeviceId(MakeDeviceId());
+	vector<uint8_t> emptyData;
+	empty.Serialize(emptyData);
+	CHECK_EQUAL(kHeaderSize, emptyData.size());
+	CHECK(Load(reloaded, emptyData));
+	CHECK_EQUAL(size_t(0), reloaded.GetStats().loadedEntries);
+}
+
+
+void TestDeviceMismatch()
+{
+	const auto data = MakeCacheFile();
+
+	PSOCacheDeviceId deviceIds[3] = { MakeDeviceId(), MakeDeviceId(), MakeDeviceId() };
+	deviceIds[0].vendorId = 0x1002;
+	deviceIds[1].deviceId = 0x1B81;
+	deviceIds[2].driverVersion += 1;
+
+	for (const auto& deviceId : deviceIds)
+	{
+		PSOCache cache;
+		cache.SetDeviceId(deviceId);
+		CHECK(!Load(cache, data));
+		CHECK_EQUAL(size_t(0), cache.GetStats().loadedEntries);
+
+		vector<uint8_t> blob;
+		CHECK(!cache.Find(1, blob));
+	}
+
+	// The same goes for a file stamped with another format version, or one that isn't a cache at all
+	auto otherVersion = data;
+	Patch(otherVersion, kVersionOffset, PSOCache::kFormatVersion + 1);
+
+	auto otherMagic = data;
+	Patch(otherMagic, 0, 0x12345678u);
+
+	for (const auto& file : { otherVersion, otherMagic })
+	{
+		PSOCache cache;
+		cache.SetDeviceId(MakeDeviceId());
+		CHECK(!Load(cache, file));
+	}
+
+	// Only the stamp differs, so patching it back makes the file load
+	auto restored = otherVersion;
+	Patch(restored, kVersionOffset, PSOCache::kFormatVersion);
+	PSOCache cache;
+	cache.SetDeviceId(MakeDeviceId());
+	CHECK(Load(cache, restored));
+}
+
+
+void TestCorruption()
+{
+	const auto data = MakeCacheFile();
+
+	auto expectRejected = [](const vector<uint8_t>& file)
+	{
+		PSOCache cache;
+		cache.SetDeviceId(MakeDeviceId());
+		CHECK(!cache.Deserialize(file.data(), file.size()));
+		CHECK_EQUAL(size_t(0), cache.GetStats().loadedEntries);
+
+		vector<uint8_t> blob;
+		CHECK(!cache.Find(1, blob));
+	};
+
+	// A flipped byte in a blob, or in the checksum itself
+	auto flippedBlob = data;
+	flippedBlob[data.size() - 10] ^= 0x40;
+	expectRejected(flippedBlob);
+
+	auto flippedChecksum = data;
+	flippedChecksum[kChecksumOffset] ^= 0x01;
+	expectRejected(flippedChecksum);
+
+	// Truncated anywhere: inside the header, right after it, or in the last blob
+	for (size_t size : { size_t(0), size_t(12), kHeaderSize - 1, kHeaderSize, data.size() - 1 })
+	{
+		expectRejected(vector<uint8_t>(data.begin(), data.begin() + size));
+	}
+
+	// Truncated with a checksum to match, so the entries themselves have to be bounds checked
+	for (size_t size : { kHeaderSize + 4, kHeaderSize + 16, data.size() - 1 })
+	{
+		vector<uint8_t> truncated(data.begin(), data.begin() + size);
+		FixChecksum(truncated);
+		expectRejected(truncated);
+	}
+
+	// Claiming more entries than the file holds
+	auto extraEntries = data;
+	Patch(extraEntries, kEntryCountOffset, uint64_t(4));
+	expectRejected(extraEntries);
+
+	// A blob size that runs past the end
+	auto hugeBlob = data;
+	Patch(hugeBlob, kHeaderSize + sizeof(uint64_t), ~0ULL);
+	FixChecksum(hugeBlob);
+	expectRejected(hugeBlob);
+
+	expectRejected(vector<uint8_t>());
+	PSOCache cache;
+	CHECK(!cache.Deserialize(nullptr, 0));
+}
+
+
+void TestUnusedEntriesDropped()
+{
+	PSOCache cache;
+	cache.SetDeviceId(MakeDeviceId());
+	CHECK(Load(cache, MakeCacheFile()));
+
+	// Entries loaded but never looked up would be pruned, so the file needs writing
+	CHECK(cache.IsDirty());
+
+	vector<uint8_t> blob;
+	CHECK(cache.Find(2, blob));
+
+	const auto stored = MakeBlob(9, 50);
+	cache.Store(9, stored.data(), stored.size());
+
+	vector<uint8_t> data;
+	cache.Serialize(data);
+
+	PSOCache reloaded;
+	reloaded.SetDeviceId(MakeDeviceId());
+	CHECK(Load(reloaded, data));
+	CHECK_EQUAL(size_t(2), reloaded.GetStats().loadedEntries);
+	CHECK(!reloaded.Find(1, blob));
+	CHECK(!reloaded.Find(3, blob));
+	CHECK(reloaded.Find(2, blob));
+	CHECK(blob == MakeBlob(2, 200));
+	CHECK(reloaded.Find(9, blob));
+	CHECK(blob == stored);
+
+	// A blob the driver refused is dropped too, until the recompiled one is stored
+	reloaded.Reject(9);
+	CHECK_EQUAL(1u, reloaded.GetStats().rejected);
+	CHECK(reloaded.IsDirty());
+
+	reloaded.Serialize(data);
+	PSOCache afterReject;
+	afterReject.SetDeviceId(MakeDeviceId());
+	CHECK(Load(afterReject, data));
+	CHECK_EQUAL(size_t(1), afterReject.GetStats().loadedEntries);
+	CHECK(!afterReject.Find(9, blob));
+}
+
+} // anonymous namespace
+
+
+int main()
+{
+	TestHash();
+	TestRoundTrip();
+	TestDeviceMismatch();
+	TestCorruption();
+	TestUnusedEntriesDropped();
+
+	return KodiakTest::FinishTest("PSOCacheTest");
+}
\ No newline at end of file
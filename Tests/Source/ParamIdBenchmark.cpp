@@ -0,0 +1,151 @@
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+// Author: David Elder
+//
+
+// Parameter lookups per second through ParamIdMap, against the string-keyed map it replaced, using the
+// names SSAO looks up every frame.  Also checks that literals and strings with the same name agree.
+
+#include "ParamId.h"
+
+#include "TestUtility.h"
+
+#include <chrono>
+#include <cstring>
+#include <map>
+#include <mutex>
+
+
+using namespace Kodiak;
+using namespace std;
+
+
+namespace
+{
+
+const int kIterations = 500000;
+
+static_assert(ParamId("DepthTex").GetHash() == ParamId::Hash("DepthTex", 8), "Literals are hashed at compile time");
+
+
+struct Parameter
+{
+	explicit Parameter(const string& name) : name(name) {}
+	string name;
+};
+
+
+// How ComputeKernel looked parameters up before ParamId
+class StringKeyedKernel
+{
+public:
+	shared_ptr<Parameter> GetParameter(const string& name)
+	{
+		lock_guard<mutex> CS(m_mutex);
+
+		auto it = m_parameters.find(name);
+		if (it != m_parameters.end())
+		{
+			return it->second;
+		}
+
+		auto parameter = make_shared<Parameter>(name);
+		m_parameters[name] = parameter;
+		return parameter;
+	}
+
+private:
+	mutex								m_mutex;
+	map<string, shared_ptr<Parameter>>	m_parameters;
+};
+
+
+class ParamIdKernel
+{
+public:
+	shared_ptr<Parameter> GetParameter(ParamId id)
+	{
+		lock_guard<mutex> CS(m_mutex);
+		return m_parameters.FindOrCreate(id);
+	}
+
+private:
+	mutex					m_mutex;
+	ParamIdMap<Parameter>	m_parameters;
+};
+
+
+template <typename TKernel>
+double MeasureLookupsPerSecond(TKernel& kernel)
+{
+	size_t sink = 0;
+
+	const auto startTime = chrono::high_resolution_clock::now();
+
+	for (int i = 0; i < kIterations; ++i)
+	{
+		sink += kernel.GetParameter("gInvThicknessTable")->name.size();
+		sink += kernel.GetParameter("gSampleWeightTable")->name.size();
+		sink += kernel.GetParameter("gInvSliceDimension")->name.size();
+		sink += kernel.GetParameter("gRejectFadeoff")->name.size();
+		sink += kernel.GetParameter("gRcpAccentuation")->name.size();
+		sink += kernel.GetParameter("DepthTex")->name.size();
+		sink += kernel.GetParameter("Occlusion")->name.size();
+		sink += kernel.GetParameter("InvLowResolution")->name.size();
+	}
+
+	const chrono::duration<double> elapsed = chrono::high_resolution_clock::now() - startTime;
+
+	// Every lookup returned its own name
+	CHECK_EQUAL(size_t(kIterations) * (18 + 18 + 18 + 14 + 16 + 8 + 9 + 16), sink);
+
+	return kIterations * 8 / elapsed.count();
+}
+
+
+void TestNames()
+{
+	// Strings are interned once, and agree with literals
+	const ParamId first(string("DynamicName"));
+	const ParamId second(string("DynamicName"));
+	CHECK(first.GetName() == second.GetName());
+	CHECK(first == ParamId("DynamicName"));
+	CHECK(strcmp(first.GetName(), "DynamicName") == 0);
+
+	// Only the characters before the null are part of the name
+	static const char padded[32] = "DepthTex";
+	CHECK(ParamId(padded) == ParamId("DepthTex"));
+
+	// A writable buffer is copied, so reusing it doesn't rename the ParamId
+	char buffer[32] = "Occlusion";
+	const ParamId fromBuffer(buffer);
+	strcpy(buffer, "Garbage");
+	CHECK(fromBuffer == ParamId("Occlusion"));
+	CHECK(strcmp(fromBuffer.GetName(), "Occlusion") == 0);
+
+	ParamIdKernel kernel;
+	CHECK(kernel.GetParameter("DepthTex") == kernel.GetParameter(string("DepthTex")));
+	CHECK(kernel.GetParameter("DepthTex") != kernel.GetParameter("Occlusion"));
+}
+
+} // anonymous namespace
+
+
+int main()
+{
+	TestNames();
+
+	StringKeyedKernel stringKeyed;
+	ParamIdKernel paramIdKeyed;
+	const double stringLookups = MeasureLookupsPerSecond(stringKeyed);
+	const double paramIdLookups = MeasureLookupsPerSecond(paramIdKeyed);
+
+	printf("String-keyed map: %.1f M lookups/s\n", stringLookups / 1.0e6);
+	printf("ParamIdMap: %.1f M lookups/s (%.1fx)\n", paramIdLookups / 1.0e6, paramIdLookups / stringLookups);
+
+	return KodiakTest::FinishTest("ParamIdBenchmark");
+}
\ No newline at end of file
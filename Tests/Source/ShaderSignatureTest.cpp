@@ -0,0 +1,388 @@
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+// Author: David Elder
+//
+
+// Round trips shader signatures through the .refl format, and checks that truncated files and files written
+// for other bytecode are rejected
+
+#include "ShaderSignature.h"
+
+#include "TestUtility.h"
+
+#include <cstring>
+
+
+using namespace Kodiak;
+using namespace ShaderReflection;
+using namespace std;
+
+
+namespace
+{
+
+const uint32_t kDxbcMagic = 0x43425844; // 'DXBC'
+
+// A name offset and length, then five more fields
+const size_t kCBVRecordSize = 7 * sizeof(uint32_t);
+
+
+// A DXBC container header with a made up checksum, followed by payload bytes that are never parsed
+vector<uint8_t> MakeByteCode(uint8_t seed, size_t payloadSize)
+{
+	vector<uint8_t> byteCode(sizeof(kDxbcMagic) + 16 + payloadSize);
+	memcpy(byteCode.data(), &kDxbcMagic, sizeof(kDxbcMagic));
+	for (size_t i = sizeof(kDxbcMagic); i < byteCode.size(); ++i)
+	{
+		byteCode[i] = static_cast<uint8_t>(seed + i * 37);
+	}
+	return byteCode;
+}
+
+
+CBVLayout MakeCBV(const char* name, uint32_t byteOffset, uint32_t sizeInBytes, uint32_t shaderRegister, uint32_t tableIndex,
+	uint32_t tableSlot)
+{
+	CBVLayout cbv;
+	cbv.name = name;
+	cbv.byteOffset = byteOffset;
+	cbv.sizeInBytes = sizeInBytes;
+	cbv.shaderRegister = shaderRegister;
+	cbv.binding.tableIndex = tableIndex;
+	cbv.binding.tableSlot = tableSlot;
+	return cbv;
+}
+
+
+// Fills every table, with values that differ between entries so swapped records would show up
+Signature MakeSignature()
+{
+	Signature signature;
+	signature.cbvPerViewData = MakeCBV("PerViewConstants", 0, 256, 0, kInvalid, kInvalid);
+	signature.cbvPerObjectData = MakeCBV("PerObjectConstants", 0, 128, 1, kInvalid, kInvalid);
+	signature.cbvTable.push_back(MakeCBV("MaterialConstants", 0, 64, 2, 0, 0));
+	signature.cbvTable.push_back(MakeCBV("LightingConstants", 64, 48, 3, 0, 1));
+
+	signature.srvTable.push_back(TableLayout{ 0, 3 });
+	signature.uavTable.push_back(TableLayout{ 0, 1 });
+	signature.samplerTable.push_back(TableLayout{ 0, 2 });
+	signature.samplerTable.push_back(TableLayout{ 4, 1 });
+
+	const char* parameterNames[] = { "diffuseColor", "specularPower", "" };
+	for (uint32_t i = 0; i < 3; ++i)
+	{
+		Parameter<1> parameter;
+		parameter.name = parameterNames[i];
+		parameter.type = static_cast<ShaderVariableType>(i + 1);
+		parameter.sizeInBytes = 4 * (i + 1);
+		parameter.numElements = i;
+		parameter.cbvShaderRegister[0] = 2;
+		parameter.byteOffset[0] = 16 * i;
+		signature.parameters.push_back(parameter);
+	}
+
+	const char* resourceNames[] = { "diffuseTexture", "normalTexture", "specularTexture" };
+	for (uint32_t i = 0; i < 3; ++i)
+	{
+		ResourceSRV<1> resource;
+		resource.name = resourceNames[i];
+		resource.type = static_cast<ShaderResourceType>(i);
+		resource.dimension = static_cast<ShaderResourceDimension>(i + 2);
+		resource.shaderRegister[0] = i;
+		resource.binding[0].tableIndex = 1;
+		resource.binding[0].tableSlot = i;
+		signature.resources.push_back(resource);
+	}
+
+	ResourceUAV<1> uav;
+	uav.name = "outputBuffer";
+	uav.type = static_cast<ShaderResourceType>(7);
+	uav.shaderRegister[0] = 0;
+	uav.binding[0].tableIndex = 2;
+	uav.binding[0].tableSlot = 0;
+	signature.uavs.push_back(uav);
+
+	const char* samplerNames[] = { "linearSampler", "pointSampler", "shadowSampler" };
+	const uint32_t samplerRegisters[] = { 0, 1, 4 };
+	for (uint32_t i = 0; i < 3; ++i)
+	{
+		Sampler<1> sampler;
+		sampler.name = samplerNames[i];
+		sampler.shaderRegister[0] = samplerRegisters[i];
+		sampler.binding[0].tableIndex = 3;
+		sampler.binding[0].tableSlot = i;
+		signature.samplers.push_back(sampler);
+	}
+
+	signature.numDescriptors = 8;
+	signature.numMaterialDescriptors = 5;
+	signature.numSamplers = 3;
+	signature.bindlessSrvRegister = 10;
+
+	return signature;
+}
+
+
+vector<InputElement> MakeInputElements()
+{
+	vector<InputElement> elements(3);
+	elements[0].semanticName = "POSITION";
+	elements[0].format = 6;		// DXGI_FORMAT_R32G32B32_FLOAT
+	elements[1].semanticName = "NORMAL";
+	elements[1].format = 10;	// DXGI_FORMAT_R16G16B16A16_FLOAT
+	elements[2].semanticName = "TEXCOORD";
+	elements[2].semanticIndex = 1;
+	elements[2].format = 34;	// DXGI_FORMAT_R16G16_FLOAT
+	return elements;
+}
+
+
+bool Equal(const CBVLayout& a, const CBVLayout& b)
+{
+	return a.name == b.name && a.byteOffset == b.byteOffset && a.sizeInBytes == b.sizeInBytes &&
+		a.shaderRegister == b.shaderRegister && a.binding.tableIndex == b.binding.tableIndex &&
+		a.binding.tableSlot == b.binding.tableSlot;
+}
+
+
+bool Equal(const TableLayout& a, const TableLayout& b)
+{
+	return a.shaderRegister == b.shaderRegister && a.numItems == b.numItems;
+}
+
+
+bool Equal(const Parameter<1>& a, const Parameter<1>& b)
+{
+	return a.name == b.name && a.type == b.type && a.sizeInBytes == b.sizeInBytes && a.numElements == b.numElements &&
+		a.cbvShaderRegister == b.cbvShaderRegister && a.byteOffset == b.byteOffset;
+}
+
+
+bool Equal(const ResourceSRV<1>& a, const ResourceSRV<1>& b)
+{
+	return a.name == b.name && a.type == b.type && a.dimension == b.dimension && a.shaderRegister == b.shaderRegister &&
+		a.binding[0].tableIndex == b.binding[0].tableIndex && a.binding[0].tableSlot == b.binding[0].tableSlot;
+}
+
+
+bool Equal(const ResourceUAV<1>& a, const ResourceUAV<1>& b)
+{
+	return a.name == b.name && a.type == b.type && a.shaderRegister == b.shaderRegister &&
+		a.binding[0].tableIndex == b.binding[0].tableIndex && a.binding[0].tableSlot == b.binding[0].tableSlot;
+}
+
+
+bool Equal(const Sampler<1>& a, const Sampler<1>& b)
+{
+	return a.name == b.name && a.shaderRegister == b.shaderRegister &&
+		a.binding[0].tableIndex == b.binding[0].tableIndex && a.binding[0].tableSlot == b.binding[0].tableSlot;
+}
+
+
+bool Equal(const InputElement& a, const InputElement& b)
+{
+	return a.semanticName == b.semanticName && a.semanticIndex == b.semanticIndex && a.format == b.format;
+}
+
+
+template <typename T>
+bool Equal(const vector<T>& a, const vector<T>& b)
+{
+	if (a.size() != b.size())
+	{
+		return false;
+	}
+
+	for (size_t i = 0; i < a.size(); ++i)
+	{
+		if (!Equal(a[i], b[i]))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+
+bool IsReset(const Signature& signature)
+{
+	return signature.cbvPerViewData.shaderRegister == kInvalid && signature.cbvPerObjectData.shaderRegister == kInvalid &&
+		signature.cbvTable.empty() && signature.srvTable.empty() && signature.parameters.empty() &&
+		signature.resources.empty() && signature.samplers.empty() && signature.numDescriptors == 0 &&
+		signature.bindlessSrvRegister == kInvalid;
+}
+
+
+void TestRoundTrip()
+{
+	const auto byteCode = MakeByteCode(1, 300);
+	const auto signature = MakeSignature();
+	const auto inputElements = MakeInputElements();
+
+	vector<uint8_t> data;
+	CHECK(SerializeSignature(byteCode.data(), byteCode.size(), signature, inputElements, data));
+
+	Signature loaded;
+	vector<InputElement> loadedElements;
+	CHECK(DeserializeSignature(data.data(), data.size(), byteCode.data(), byteCode.size(), loaded, loadedElements));
+
+	CHECK(Equal(signature.cbvPerViewData, loaded.cbvPerViewData));
+	CHECK(Equal(signature.cbvPerObjectData, loaded.cbvPerObjectData));
+	CHECK(Equal(signature.cbvTable, loaded.cbvTable));
+	CHECK(Equal(signature.srvTable, loaded.srvTable));
+	CHECK(Equal(signature.uavTable, loaded.uavTable));
+	CHECK(Equal(signature.samplerTable, loaded.samplerTable));
+	CHECK(Equal(signature.parameters, loaded.parameters));
+	CHECK(Equal(signature.resources, loaded.resources));
+	CHECK(Equal(signature.uavs, loaded.uavs));
+	CHECK(Equal(signature.samplers, loaded.samplers));
+	CHECK(Equal(inputElements, loadedElements));
+	CHECK_EQUAL(signature.numDescriptors, loaded.numDescriptors);
+	CHECK_EQUAL(signature.numMaterialDescriptors, loaded.numMaterialDescriptors);
+	CHECK_EQUAL(signature.numSamplers, loaded.numSamplers);
+	CHECK_EQUAL(signature.bindlessSrvRegister, loaded.bindlessSrvRegister);
+
+	// Serializing what was loaded gives the same bytes back
+	vector<uint8_t> reserialized;
+	CHECK(SerializeSignature(byteCode.data(), byteCode.size(), loaded, loadedElements, reserialized));
+	CHECK(data == reserialized);
+}
+
+
+void TestEmptySignature()
+{
+	const auto byteCode = MakeByteCode(2, 0);
+
+	Signature signature;
+	vector<uint8_t> data;
+	CHECK(SerializeSignature(byteCode.data(), byteCode.size(), signature, vector<InputElement>(), data));
+
+	// Stale contents are replaced
+	Signature loaded = MakeSignature();
+	vector<InputElement> loadedElements = MakeInputElements();
+	CHECK(DeserializeSignature(data.data(), data.size(), byteCode.data(), byteCode.size(), loaded, loadedElements));
+	CHECK(loaded.cbvTable.empty());
+	CHECK(loaded.parameters.empty());
+	CHECK(loaded.samplers.empty());
+	CHECK(loadedElements.empty());
+	CHECK_EQUAL(kInvalid, loaded.bindlessSrvRegister);
+}
+
+
+void TestTruncated()
+{
+	const auto byteCode = MakeByteCode(3, 120);
+
+	vector<uint8_t> data;
+	CHECK(SerializeSignature(byteCode.data(), byteCode.size(), MakeSignature(), MakeInputElements(), data));
+
+	// Every prefix is rejected, including ones that end inside the header, the records and the string table
+	size_t acceptedCount = 0;
+	for (size_t size = 0; size < data.size(); ++size)
+	{
+		Signature loaded;
+		vector<InputElement> loadedElements;
+		if (DeserializeSignature(data.data(), size, byteCode.data(), byteCode.size(), loaded, loadedElements))
+		{
+			++acceptedCount;
+		}
+	}
+	CHECK_EQUAL(0u, acceptedCount);
+
+	// So is trailing data
+	auto padded = data;
+	padded.push_back(0);
+	Signature loaded;
+	vector<InputElement> loadedElements;
+	CHECK(!DeserializeSignature(padded.data(), padded.size(), byteCode.data(), byteCode.size(), loaded, loadedElements));
+
+	CHECK(!DeserializeSignature(nullptr, 0, byteCode.data(), byteCode.size(), loaded, loadedElements));
+}
+
+
+void TestMismatchedByteCode()
+{
+	const auto byteCode = MakeByteCode(4, 200);
+
+	vector<uint8_t> data;
+	CHECK(SerializeSignature(byteCode.data(), byteCode.size(), MakeSignature(), MakeInputElements(), data));
+
+	Signature loaded;
+	vector<InputElement> loadedElements;
+
+	// A rebuilt shader has a different checksum
+	for (size_t i = 0; i < 16; ++i)
+	{
+		auto rebuilt = byteCode;
+		rebuilt[sizeof(kDxbcMagic) + i] ^= 0x01;
+		CHECK(!DeserializeSignature(data.data(), data.size(), rebuilt.data(), rebuilt.size(), loaded, loadedElements));
+	}
+
+	// Same checksum, different size
+	auto resized = byteCode;
+	resized.push_back(0);
+	CHECK(!DeserializeSignature(data.data(), data.size(), resized.data(), resized.size(), loaded, loadedElements));
+
+	// Not a DXBC container, so there's nothing to check against
+	auto notDxbc = byteCode;
+	notDxbc[0] = 'X';
+	CHECK(!DeserializeSignature(data.data(), data.size(), notDxbc.data(), notDxbc.size(), loaded, loadedElements));
+
+	vector<uint8_t> unserialized;
+	CHECK(!SerializeSignature(notDxbc.data(), notDxbc.size(), MakeSignature(), MakeInputElements(), unserialized));
+	CHECK(!SerializeSignature(byteCode.data(), 8, MakeSignature(), MakeInputElements(), unserialized));
+
+	// The original bytecode still matches
+	CHECK(DeserializeSignature(data.data(), data.size(), byteCode.data(), byteCode.size(), loaded, loadedElements));
+}
+
+
+void TestCorrupted()
+{
+	const auto byteCode = MakeByteCode(5, 64);
+
+	vector<uint8_t> data;
+	CHECK(SerializeSignature(byteCode.data(), byteCode.size(), MakeSignature(), MakeInputElements(), data));
+
+	Signature loaded;
+	vector<InputElement> loadedElements;
+
+	// Another format version
+	auto otherVersion = data;
+	otherVersion[4] ^= 0x80;
+	CHECK(!DeserializeSignature(otherVersion.data(), otherVersion.size(), byteCode.data(), byteCode.size(), loaded, loadedElements));
+
+	// An empty signature is just the header and the per-view and per-object CBV records, with no strings
+	vector<uint8_t> emptyData;
+	CHECK(SerializeSignature(byteCode.data(), byteCode.size(), Signature(), vector<InputElement>(), emptyData));
+	const size_t headerSize = emptyData.size() - 2 * kCBVRecordSize;
+
+	// The per-view CBV record comes first, starting with its name offset.  Pointing that past the string table
+	// fails the whole load, and leaves nothing half filled in.
+	auto badString = data;
+	const uint32_t badOffset = 0x7FFFFFFF;
+	memcpy(badString.data() + headerSize, &badOffset, sizeof(badOffset));
+	loaded = MakeSignature();
+	loadedElements = MakeInputElements();
+	CHECK(!DeserializeSignature(badString.data(), badString.size(), byteCode.data(), byteCode.size(), loaded, loadedElements));
+	CHECK(IsReset(loaded));
+	CHECK(loadedElements.empty());
+}
+
+} // anonymous namespace
+
+
+int main()
+{
+	TestRoundTrip();
+	TestEmptySignature();
+	TestTruncated();
+	TestMismatchedByteCode();
+	TestCorrupted();
+
+	return KodiakTest::FinishTest("ShaderSignatureTest");
+}
\ No newline at end of file
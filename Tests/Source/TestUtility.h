@@ -0,0 +1,55 @@
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+// Author: David Elder
+//
+
+#pragma once
+
+// Checks for the standalone unit tests.  A failed check is reported and the test keeps going, so one run
+// lists every failure, and the exit code from FinishTest says whether any failed.
+
+#include <cstdio>
+
+
+#define CHECK(expression) \
+	((expression) ? (void)0 : KodiakTest::ReportFailure(#expression, __FILE__, __LINE__))
+
+#define CHECK_EQUAL(expected, actual) \
+	(((expected) == (actual)) ? (void)0 : KodiakTest::ReportFailure(#expected " == " #actual, __FILE__, __LINE__))
+
+
+namespace KodiakTest
+{
+
+inline int& GetFailureCount()
+{
+	static int failureCount = 0;
+	return failureCount;
+}
+
+
+inline void ReportFailure(const char* expression, const char* file, int line)
+{
+	std::printf("%s(%d): check failed: %s\n", file, line, expression);
+	++GetFailureCount();
+}
+
+
+inline int FinishTest(const char* name)
+{
+	const int failureCount = GetFailureCount();
+	if (failureCount == 0)
+	{
+		std::printf("%s: passed\n", name);
+		return 0;
+	}
+
+	std::printf("%s: %d check(s) failed\n", name, failureCount);
+	return 1;
+}
+
+} // namespace KodiakTest
\ No newline at end of file
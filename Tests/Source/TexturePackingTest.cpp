@@ -0,0 +1,215 @@
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+// Author: David Elder
+//
+
+// Checks that the texture packer groups by format, size and mip count, splits groups at the slice limit, and
+// lays out the same inputs the same way every time, and that descriptor table updates are counted per change
+
+#include "TexturePacking.h"
+
+#include "TestUtility.h"
+
+#include <set>
+
+
+using namespace Kodiak;
+using namespace std;
+
+
+namespace
+{
+
+TexturePackInput MakeInput(uint32_t format, uint32_t size, uint32_t mipCount)
+{
+	TexturePackInput input;
+	input.format = format;
+	input.width = size;
+	input.height = size;
+	input.mipCount = mipCount;
+	return input;
+}
+
+
+// Every input is placed exactly once, in a slice of an array that matches it
+void CheckLayout(const vector<TexturePackInput>& inputs, const TexturePackLayout& layout, uint32_t maxSlices)
+{
+	CHECK_EQUAL(inputs.size(), layout.placements.size());
+
+	set<uint32_t> placed;
+	for (uint32_t arrayIndex = 0; arrayIndex < static_cast<uint32_t>(layout.arrays.size()); ++arrayIndex)
+	{
+		const auto& textureArray = layout.arrays[arrayIndex];
+		CHECK(!textureArray.inputs.empty());
+		CHECK(textureArray.inputs.size() <= maxSlices);
+
+		for (uint32_t slice = 0; slice < static_cast<uint32_t>(textureArray.inputs.size()); ++slice)
+		{
+			const uint32_t inputIndex = textureArray.inputs[slice];
+			const auto& input = inputs[inputIndex];
+			CHECK_EQUAL(textureArray.format, input.format);
+			CHECK_EQUAL(textureArray.width, input.width);
+			CHECK_EQUAL(textureArray.height, input.height);
+			CHECK_EQUAL(textureArray.mipCount, input.mipCount);
+
+			CHECK_EQUAL(arrayIndex, layout.placements[inputIndex].arrayIndex);
+			CHECK_EQUAL(slice, layout.placements[inputIndex].slice);
+
+			// Slices follow input order
+			if (slice > 0)
+			{
+				CHECK(textureArray.inputs[slice - 1] < inputIndex);
+			}
+
+			CHECK(placed.insert(inputIndex).second);
+		}
+	}
+	CHECK_EQUAL(inputs.size(), placed.size());
+}
+
+
+bool SameLayout(const TexturePackLayout& a, const TexturePackLayout& b)
+{
+	if (a.arrays.size() != b.arrays.size() || a.placements.size() != b.placements.size())
+	{
+		return false;
+	}
+
+	for (size_t i = 0; i < a.arrays.size(); ++i)
+	{
+		const auto& arrayA = a.arrays[i];
+		const auto& arrayB = b.arrays[i];
+		if (arrayA.format != arrayB.format || arrayA.width != arrayB.width || arrayA.height != arrayB.height ||
+			arrayA.mipCount != arrayB.mipCount || arrayA.inputs != arrayB.inputs)
+		{
+			return false;
+		}
+	}
+
+	for (size_t i = 0; i < a.placements.size(); ++i)
+	{
+		if (a.placements[i].arrayIndex != b.placements[i].arrayIndex || a.placements[i].slice != b.placements[i].slice)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+
+void TestGrouping()
+{
+	const vector<TexturePackInput> inputs =
+	{
+		MakeInput(71, 1024, 11),	// BC1 1024
+		MakeInput(77, 1024, 11),	// BC3 1024
+		MakeInput(71, 1024, 11),
+		MakeInput(71, 512, 10),		// Same format, other size
+		MakeInput(71, 1024, 10),	// Same format and size, truncated mip chain
+		MakeInput(77, 1024, 11),
+		MakeInput(71, 1024, 11),
+	};
+
+	const auto layout = PackTextureArrays(inputs);
+	CheckLayout(inputs, layout, kMaxTextureArraySlices);
+
+	// Arrays are ordered by the first input that lands in them
+	CHECK_EQUAL(size_t(4), layout.arrays.size());
+	CHECK(layout.arrays[0].inputs == vector<uint32_t>({ 0, 2, 6 }));
+	CHECK(layout.arrays[1].inputs == vector<uint32_t>({ 1, 5 }));
+	CHECK(layout.arrays[2].inputs == vector<uint32_t>({ 3 }));
+	CHECK(layout.arrays[3].inputs == vector<uint32_t>({ 4 }));
+
+	CHECK(PackTextureArrays(vector<TexturePackInput>()).arrays.empty());
+}
+
+
+void TestSliceLimit()
+{
+	vector<TexturePackInput> inputs;
+	for (uint32_t i = 0; i < 10; ++i)
+	{
+		inputs.push_back(MakeInput(i % 3 == 0 ? 98 : 71, 256, 9));
+	}
+
+	// Four BC7 and six BC1 textures, in arrays of at most three
+	const auto layout = PackTextureArrays(inputs, 3);
+	CheckLayout(inputs, layout, 3);
+	CHECK_EQUAL(size_t(4), layout.arrays.size());
+	CHECK(layout.arrays[0].inputs == vector<uint32_t>({ 0, 3, 6 }));
+	CHECK(layout.arrays[1].inputs == vector<uint32_t>({ 1, 2, 4 }));
+	CHECK(layout.arrays[2].inputs == vector<uint32_t>({ 5, 7, 8 }));
+	CHECK(layout.arrays[3].inputs == vector<uint32_t>({ 9 }));
+
+	// A limit past the hardware one is clamped to it
+	const vector<TexturePackInput> many(kMaxTextureArraySlices + 1, MakeInput(71, 4, 1));
+	const auto clamped = PackTextureArrays(many, kMaxTextureArraySlices * 2);
+	CheckLayout(many, clamped, kMaxTextureArraySlices);
+	CHECK_EQUAL(size_t(2), clamped.arrays.size());
+	CHECK_EQUAL(size_t(1), clamped.arrays[1].inputs.size());
+}
+
+
+void TestDeterminism()
+{
+	// A few hundred textures over a handful of formats and sizes, in a scrambled order
+	vector<TexturePackInput> inputs;
+	uint32_t seed = 12345;
+	for (uint32_t i = 0; i < 500; ++i)
+	{
+		seed = seed * 1664525u + 1013904223u;
+		const uint32_t format = (seed >> 28) % 3 == 0 ? 71 : 77;
+		const uint32_t size = 128u << ((seed >> 20) % 4);
+		inputs.push_back(MakeInput(format, size, 8 + (seed >> 20) % 4));
+	}
+
+	const auto layout = PackTextureArrays(inputs, 64);
+	CheckLayout(inputs, layout, 64);
+
+	// Packing again, from a copy, gives the same arrays in the same order
+	for (int repetition = 0; repetition < 3; ++repetition)
+	{
+		const auto inputsCopy = inputs;
+		CHECK(SameLayout(layout, PackTextureArrays(inputsCopy, 64)));
+	}
+
+	// Appending inputs leaves the existing placements alone, as long as no array was full
+	auto extended = inputs;
+	extended.push_back(MakeInput(99, 64, 7));
+	const auto extendedLayout = PackTextureArrays(extended);
+	const auto unlimitedLayout = PackTextureArrays(inputs);
+	for (size_t i = 0; i < inputs.size(); ++i)
+	{
+		CHECK_EQUAL(unlimitedLayout.placements[i].arrayIndex, extendedLayout.placements[i].arrayIndex);
+		CHECK_EQUAL(unlimitedLayout.placements[i].slice, extendedLayout.placements[i].slice);
+	}
+	CHECK_EQUAL(unlimitedLayout.arrays.size() + 1, extendedLayout.arrays.size());
+}
+
+
+void TestDescriptorTableUpdates()
+{
+	CHECK_EQUAL(size_t(0), CountDescriptorTableUpdates(vector<uint32_t>()));
+	CHECK_EQUAL(size_t(1), CountDescriptorTableUpdates({ 7 }));
+	CHECK_EQUAL(size_t(1), CountDescriptorTableUpdates({ 7, 7, 7 }));
+	CHECK_EQUAL(size_t(3), CountDescriptorTableUpdates({ 1, 1, 2, 2, 1 }));
+	CHECK_EQUAL(size_t(4), CountDescriptorTableUpdates({ 1, 2, 1, 2 }));
+}
+
+} // anonymous namespace
+
+
+int main()
+{
+	TestGrouping();
+	TestSliceLimit();
+	TestDeterminism();
+	TestDescriptorTableUpdates();
+
+	return KodiakTest::FinishTest("TexturePackingTest");
+}
\ No newline at end of file
@@ -0,0 +1,320 @@
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+// Author: David Elder
+//
+
+// Runs TextureResidencyPolicy against a simulated texture allocator, the way TextureStreamer::Update
+// drives it together with the MipStreamingScheduler
+
+#include "MipStreaming.h"
+#include "TextureResidency.h"
+
+#include "TestUtility.h"
+
+#include <unordered_map>
+
+
+using namespace Kodiak;
+using namespace std;
+
+
+namespace
+{
+
+const uint32_t kTextureWidth = 512;
+const uint32_t kMipCount = 10;
+
+
+// Footprint of a square RGBA8 texture for each most detailed resident mip
+array<size_t, kMaxStreamingMips> MakeResidentBytes(uint32_t width)
+{
+	array<size_t, kMaxStreamingMips> residentBytes{};
+
+	size_t total = 0;
+	for (uint32_t mip = kMipCount; mip-- > 0;)
+	{
+		const size_t size = max<uint32_t>(1, width >> mip);
+		total += size * size * 4;
+		residentBytes[mip] = total;
+	}
+	return residentBytes;
+}
+
+
+TextureResidencyState MakeState(uint64_t id, uint64_t lastUsedFrame, uint32_t residentMip)
+{
+	TextureResidencyState state;
+	state.id = id;
+	state.lastUsedFrame = lastUsedFrame;
+	state.residentMip = residentMip;
+	state.minDetailMip = kMipCount - 1;
+	state.residentBytes = MakeResidentBytes(kTextureWidth);
+	return state;
+}
+
+
+// Stands in for the GPU heap: tracks the bytes backing each texture, and applies the policy's decisions
+class SimulatedAllocator
+{
+public:
+	void Allocate(uint64_t id, size_t bytes)
+	{
+		m_totalBytes -= m_allocations[id];
+		m_allocations[id] = bytes;
+		m_totalBytes += bytes;
+	}
+
+	template <typename TDecision, typename TState>
+	void Apply(const vector<TDecision>& decisions, const vector<TState>& states)
+	{
+		for (const auto& decision : decisions)
+		{
+			Allocate(decision.id, states[decision.id].residentBytes[decision.newResidentMip]);
+		}
+	}
+
+	size_t GetTotalBytes() const { return m_totalBytes; }
+
+private:
+	unordered_map<uint64_t, size_t>	m_allocations;
+	size_t							m_totalBytes{ 0 };
+};
+
+
+const TextureResidencyDecision* FindDecision(const vector<TextureResidencyDecision>& decisions, uint64_t id)
+{
+	for (const auto& decision : decisions)
+	{
+		if (decision.id == id)
+		{
+			return &decision;
+		}
+	}
+	return nullptr;
+}
+
+
+void TestUnderBudget()
+{
+	TextureResidencyPolicy policy;
+
+	vector<TextureResidencyState> states = { MakeState(0, 1, 0), MakeState(1, 2, 0) };
+	policy.SetMemoryBudget(TextureResidencyPolicy::ComputeResidentBytes(states));
+
+	CHECK(policy.Enforce(states).empty());
+	CHECK_EQUAL(0u, states[0].residentMip);
+	CHECK_EQUAL(0u, states[1].residentMip);
+}
+
+
+// The least recently used texture gives up detail first, and only as much as is needed
+void TestLeastRecentlyUsedFirst()
+{
+	TextureResidencyPolicy policy;
+
+	vector<TextureResidencyState> states = { MakeState(0, 10, 0), MakeState(1, 5, 0), MakeState(2, 20, 0) };
+	const size_t fullBytes = states[0].residentBytes[0];
+	policy.SetMemoryBudget(3 * fullBytes - fullBytes / 2);
+
+	auto decisions = policy.Enforce(states);
+	CHECK_EQUAL(size_t(1), decisions.size());
+	CHECK(FindDecision(decisions, 1) != nullptr);
+	CHECK_EQUAL(1u, states[1].residentMip);
+	CHECK_EQUAL(0u, states[0].residentMip);
+	CHECK_EQUAL(0u, states[2].residentMip);
+	CHECK(TextureResidencyPolicy::ComputeResidentBytes(states) <= policy.GetMemoryBudget());
+
+	// Once the oldest is down to its coarsest stage, the next oldest is trimmed
+	policy.SetMemoryBudget(2 * fullBytes - fullBytes / 2);
+	decisions = policy.Enforce(states);
+	CHECK_EQUAL(states[1].minDetailMip, states[1].residentMip);
+	CHECK(states[0].residentMip > 0);
+	CHECK_EQUAL(0u, states[2].residentMip);
+	CHECK(TextureResidencyPolicy::ComputeResidentBytes(states) <= policy.GetMemoryBudget());
+}
+
+
+// Among textures last used in the same frame, the one holding the most memory goes first
+void TestTiesGoToLargest()
+{
+	TextureResidencyPolicy policy;
+
+	vector<TextureResidencyState> states = { MakeState(0, 7, 2), MakeState(1, 7, 0), MakeState(2, 7, 1) };
+	policy.SetMemoryBudget(TextureResidencyPolicy::ComputeResidentBytes(states) - 1);
+
+	auto decisions = policy.Enforce(states);
+	CHECK_EQUAL(size_t(1), decisions.size());
+	CHECK(FindDecision(decisions, 1) != nullptr);
+	CHECK_EQUAL(1u, states[1].residentMip);
+}
+
+
+// Pinned textures have a stream in flight and are skipped.  When nothing else can give, the policy stops at
+// each texture's coarsest stage and leaves the budget exceeded.
+void TestPinnedAndMinDetail()
+{
+	TextureResidencyPolicy policy;
+
+	vector<TextureResidencyState> states = { MakeState(0, 1, 0), MakeState(1, 2, 0) };
+	states[0].pinned = true;
+	policy.SetMemoryBudget(1);
+
+	auto decisions = policy.Enforce(states);
+	CHECK(FindDecision(decisions, 0) == nullptr);
+	CHECK_EQUAL(0u, states[0].residentMip);
+	CHECK_EQUAL(states[1].minDetailMip, states[1].residentMip);
+	CHECK(TextureResidencyPolicy::ComputeResidentBytes(states) > policy.GetMemoryBudget());
+
+	// Nothing more to give, so no decisions
+	CHECK(policy.Enforce(states).empty());
+}
+
+
+void TestIdle()
+{
+	TextureResidencyPolicy policy;
+	policy.SetIdleFrames(10);
+
+	const auto state = MakeState(0, 100, 0);
+	CHECK(!policy.IsIdle(state, 100));
+	CHECK(!policy.IsIdle(state, 110));
+	CHECK(policy.IsIdle(state, 111));
+}
+
+
+// A camera sweeps over a row of textures, drawing a window of them each frame.  Streaming pulls the visible
+// ones in, and halfway through the budget shrinks, as it would under memory pressure, so the residency policy
+// has to push detail out.  The simulated allocator has to stay within the budget every frame.
+void TestSimulatedFrames()
+{
+	const uint64_t numTextures = 64;
+	const uint64_t windowSize = 6;
+	const uint64_t numFrames = 400;
+	const size_t fullBytes = MakeResidentBytes(kTextureWidth)[0];
+
+	TextureResidencyPolicy policy;
+	policy.SetMemoryBudget(8 * fullBytes);
+	policy.SetIdleFrames(4);
+
+	MipStreamingScheduler scheduler;
+	scheduler.SetMemoryBudget(policy.GetMemoryBudget());
+	scheduler.SetMipsPerStage(3);
+	scheduler.SetMaxStreamsPerUpdate(4);
+
+	SimulatedAllocator allocator;
+
+	vector<TextureResidencyState> residency;
+	for (uint64_t id = 0; id < numTextures; ++id)
+	{
+		residency.push_back(MakeState(id, 0, kMipCount - 1));
+		allocator.Allocate(id, residency.back().residentBytes[kMipCount - 1]);
+	}
+
+	vector<MipStreamingState> streaming(numTextures);
+	size_t numEvictions = 0;
+
+	for (uint64_t frame = 1; frame <= numFrames; ++frame)
+	{
+		if (frame == numFrames / 2)
+		{
+			policy.SetMemoryBudget(3 * fullBytes);
+			scheduler.SetMemoryBudget(policy.GetMemoryBudget());
+		}
+
+		const uint64_t windowStart = (frame / 4) % numTextures;
+		auto isVisible = [=](uint64_t id)
+		{
+			return ((id + numTextures - windowStart) % numTextures) < windowSize;
+		};
+
+		for (auto& state : residency)
+		{
+			if (isVisible(state.id))
+			{
+				state.lastUsedFrame = frame;
+			}
+		}
+
+		// Evict, least recently used first
+		auto evictions = policy.Enforce(residency);
+		allocator.Apply(evictions, residency);
+		numEvictions += evictions.size();
+
+		CHECK(allocator.GetTotalBytes() <= policy.GetMemoryBudget());
+
+		// Textures drawn this frame only lose detail once every other texture is down to its coarsest stage
+		for (const auto& eviction : evictions)
+		{
+			if (isVisible(eviction.id))
+			{
+				for (const auto& state : residency)
+				{
+					CHECK(isVisible(state.id) || state.residentMip == state.minDetailMip);
+				}
+			}
+		}
+
+		// Stream in, visible textures first
+		for (uint64_t id = 0; id < numTextures; ++id)
+		{
+			auto& state = streaming[id];
+			state.id = id;
+			state.priority = isVisible(id) ? 1.0f : 0.0f;
+			state.residentMip = residency[id].residentMip;
+			state.minDetailMip = residency[id].minDetailMip;
+			state.desiredMip = isVisible(id) ? 0 : state.minDetailMip;
+			state.residentBytes = residency[id].residentBytes;
+
+			if (policy.IsIdle(residency[id], frame))
+			{
+				state.desiredMip = max(state.desiredMip, state.residentMip);
+			}
+		}
+
+		allocator.Apply(scheduler.Schedule(streaming), streaming);
+		for (uint64_t id = 0; id < numTextures; ++id)
+		{
+			residency[id].residentMip = streaming[id].residentMip;
+		}
+
+		CHECK(allocator.GetTotalBytes() <= policy.GetMemoryBudget());
+		CHECK_EQUAL(TextureResidencyPolicy::ComputeResidentBytes(residency), allocator.GetTotalBytes());
+	}
+
+	CHECK(numEvictions > 0);
+
+	// The memory went to what's on screen: no texture out of view has more detail than the ones that have been
+	// in view for a while
+	const uint64_t windowStart = (numFrames / 4) % numTextures;
+	uint32_t coarsestVisibleMip = 0;
+	for (uint64_t i = 0; i + 1 < windowSize; ++i)
+	{
+		coarsestVisibleMip = max(coarsestVisibleMip, residency[(windowStart + i) % numTextures].residentMip);
+	}
+	CHECK(residency[windowStart].residentMip == 0);
+
+	for (uint64_t i = windowSize; i < numTextures; ++i)
+	{
+		CHECK(residency[(windowStart + i) % numTextures].residentMip >= coarsestVisibleMip);
+	}
+}
+
+
+} // anonymous namespace
+
+
+int main()
+{
+	TestUnderBudget();
+	TestLeastRecentlyUsedFirst();
+	TestTiesGoToLargest();
+	TestPinnedAndMinDetail();
+	TestIdle();
+	TestSimulatedFrames();
+
+	return KodiakTest::FinishTest("TextureResidencyTest");
+}
\ No newline at end of file
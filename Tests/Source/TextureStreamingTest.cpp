@@ -0,0 +1,406 @@
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+// Author: David Elder
+//
+
+// Parses synthetic DDS files: legacy and DX10 headers, cube maps and arrays, block-compressed pitches, and
+// files cut short, then checks which mip streaming starts from
+
+#include "TextureStreaming.h"
+
+#include "TestUtility.h"
+
+#include <cstring>
+
+
+using namespace Kodiak;
+using namespace std;
+
+
+namespace
+{
+
+// DXGI_FORMAT values
+const uint32_t kR8UNorm = 61;
+const uint32_t kBC1UNorm = 71;
+const uint32_t kBC3UNorm = 77;
+const uint32_t kBC7UNorm = 98;
+const uint32_t kB8G8R8A8UNorm = 87;
+const uint32_t kR16G16B16A16Float = 10;
+const uint32_t kP8 = 113;
+
+// DDS header and pixel format flags
+const uint32_t kFlagHeight = 0x2;
+const uint32_t kFlagVolume = 0x00800000;
+const uint32_t kPixelFormatFourCC = 0x4;
+const uint32_t kPixelFormatRGBA = 0x41;
+const uint32_t kPixelFormatLuminance = 0x20000;
+const uint32_t kCubeMapAllFaces = 0xFE00;
+const uint32_t kCubeMapPositiveX = 0x600;
+const uint32_t kMiscTextureCube = 0x4;
+
+const size_t kLegacyHeaderBytes = 128;
+const size_t kDX10HeaderBytes = 148;
+
+
+uint32_t FourCC(const char* code)
+{
+	return uint32_t(uint8_t(code[0])) | (uint32_t(uint8_t(code[1])) << 8) | (uint32_t(uint8_t(code[2])) << 16) |
+		(uint32_t(uint8_t(code[3])) << 24);
+}
+
+
+struct PixelFormat
+{
+	uint32_t	flags{ kPixelFormatFourCC };
+	uint32_t	fourCC{ 0 };
+	uint32_t	bitCount{ 0 };
+	uint32_t	masks[4];
+};
+
+
+PixelFormat MakeFourCCFormat(const char* code)
+{
+	PixelFormat format;
+	format.fourCC = FourCC(code);
+	memset(format.masks, 0, sizeof(format.masks));
+	return format;
+}
+
+
+PixelFormat MakeMaskFormat(uint32_t flags, uint32_t bitCount, uint32_t r, uint32_t g, uint32_t b, uint32_t a)
+{
+	PixelFormat format;
+	format.flags = flags;
+	format.bitCount = bitCount;
+	format.masks[0] = r;
+	format.masks[1] = g;
+	format.masks[2] = b;
+	format.masks[3] = a;
+	return format;
+}
+
+
+// Magic number and DDS_HEADER.  WithData appends the texels.
+vector<uint8_t> MakeHeader(uint32_t width, uint32_t height, uint32_t mipCount, const PixelFormat& pixelFormat,
+	uint32_t flags = 0, uint32_t depth = 0, uint32_t caps2 = 0)
+{
+	uint32_t words[32] = {};
+	words[0] = 0x20534444;
+	words[1] = 124;
+	words[2] = flags;
+	words[3] = height;
+	words[4] = width;
+	words[6] = depth;
+	words[7] = mipCount;
+	words[19] = 32;
+	words[20] = pixelFormat.flags;
+	words[21] = pixelFormat.fourCC;
+	words[22] = pixelFormat.bitCount;
+	memcpy(&words[23], pixelFormat.masks, sizeof(pixelFormat.masks));
+	words[28] = caps2;
+
+	vector<uint8_t> file(sizeof(words));
+	memcpy(file.data(), words, sizeof(words));
+	return file;
+}
+
+
+vector<uint8_t> MakeDX10Header(uint32_t width, uint32_t height, uint32_t mipCount, uint32_t format, uint32_t dimension,
+	uint32_t arraySize, uint32_t miscFlag = 0, uint32_t flags = 0, uint32_t depth = 0)
+{
+	auto file = MakeHeader(width, height, mipCount, MakeFourCCFormat("DX10"), flags, depth);
+
+	const uint32_t words[5] = { format, dimension, miscFlag, arraySize, 0 };
+	const size_t offset = file.size();
+	file.resize(offset + sizeof(words));
+	memcpy(file.data() + offset, words, sizeof(words));
+	return file;
+}
+
+
+vector<uint8_t> WithData(vector<uint8_t> file, size_t dataBytes)
+{
+	file.resize(file.size() + dataBytes);
+	return file;
+}
+
+
+DDSParseResult Parse(const vector<uint8_t>& file, DDSLayout& layout)
+{
+	return ParseDDSLayout(file.data(), file.size(), layout);
+}
+
+
+void CheckSubresource(const DDSLayout& layout, uint32_t slice, uint32_t mip, uint32_t width, uint32_t height, size_t rowBytes,
+	size_t rowCount, size_t dataOffset)
+{
+	const auto& subresource = layout.GetSubresource(slice, mip);
+	CHECK_EQUAL(width, subresource.width);
+	CHECK_EQUAL(height, subresource.height);
+	CHECK_EQUAL(rowBytes, subresource.rowBytes);
+	CHECK_EQUAL(rowCount, subresource.rowCount);
+	CHECK_EQUAL(rowBytes * rowCount, subresource.sliceBytes);
+	CHECK_EQUAL(dataOffset, subresource.dataOffset);
+}
+
+
+void TestLegacyHeaders()
+{
+	DDSLayout layout;
+
+	// DXT1, 256x128 with its full chain: 16384 + 4096 + 1024 + 256 + 64 + 16 + 8 + 8 + 8 bytes
+	const auto dxt1 = WithData(MakeHeader(256, 128, 9, MakeFourCCFormat("DXT1")), 21864);
+	CHECK(Parse(dxt1, layout) == DDSParseResult::Success);
+	CHECK_EQUAL(kBC1UNorm, layout.format);
+	CHECK_EQUAL(kDDSDimensionTexture2D, layout.dimension);
+	CHECK_EQUAL(1u, layout.arraySize);
+	CHECK_EQUAL(1u, layout.depth);
+	CHECK_EQUAL(9u, layout.mipCount);
+	CHECK(!layout.isCubeMap);
+	CHECK_EQUAL(size_t(9), layout.subresources.size());
+	CheckSubresource(layout, 0, 0, 256, 128, 512, 32, kLegacyHeaderBytes);
+	CheckSubresource(layout, 0, 1, 128, 64, 256, 16, kLegacyHeaderBytes + 16384);
+	CheckSubresource(layout, 0, 8, 1, 1, 8, 1, kLegacyHeaderBytes + 21856);
+
+	// A mip count of zero means one mip
+	const auto dxt5 = WithData(MakeHeader(64, 64, 0, MakeFourCCFormat("DXT5")), 4096);
+	CHECK(Parse(dxt5, layout) == DDSParseResult::Success);
+	CHECK_EQUAL(kBC3UNorm, layout.format);
+	CHECK_EQUAL(1u, layout.mipCount);
+
+	// Formats described by masks, rows rounded to whole bytes
+	const auto bgra = WithData(MakeHeader(33, 7, 1, MakeMaskFormat(kPixelFormatRGBA, 32, 0x00ff0000, 0x0000ff00, 0x000000ff, 0xff000000)), 33 * 7 * 4);
+	CHECK(Parse(bgra, layout) == DDSParseResult::Success);
+	CHECK_EQUAL(kB8G8R8A8UNorm, layout.format);
+	CheckSubresource(layout, 0, 0, 33, 7, 132, 7, kLegacyHeaderBytes);
+
+	const auto luminance = WithData(MakeHeader(5, 3, 1, MakeMaskFormat(kPixelFormatLuminance, 8, 0xff, 0, 0, 0)), 15);
+	CHECK(Parse(luminance, layout) == DDSParseResult::Success);
+	CHECK_EQUAL(kR8UNorm, layout.format);
+	CheckSubresource(layout, 0, 0, 5, 3, 5, 3, kLegacyHeaderBytes);
+
+	// D3DFMT_A16B16G16R16F stored as the FourCC
+	PixelFormat halfFloat = MakeFourCCFormat("    ");
+	halfFloat.fourCC = 113;
+	const auto halfFile = WithData(MakeHeader(4, 4, 1, halfFloat), 128);
+	CHECK(Parse(halfFile, layout) == DDSParseResult::Success);
+	CHECK_EQUAL(kR16G16B16A16Float, layout.format);
+
+	// No DXGI format for 24-bit RGB or an unknown FourCC
+	const auto rgb24 = WithData(MakeHeader(4, 4, 1, MakeMaskFormat(0x40, 24, 0xff0000, 0xff00, 0xff, 0)), 48);
+	CHECK(Parse(rgb24, layout) == DDSParseResult::NotSupported);
+	CHECK(Parse(WithData(MakeHeader(4, 4, 1, MakeFourCCFormat("ABCD")), 64), layout) == DDSParseResult::NotSupported);
+
+	// A volume: 8x8x4 R8, then 4x4x2 and 2x2x1
+	const auto volume = WithData(MakeHeader(8, 8, 3, MakeMaskFormat(kPixelFormatLuminance, 8, 0xff, 0, 0, 0), kFlagVolume, 4), 256 + 32 + 4);
+	CHECK(Parse(volume, layout) == DDSParseResult::Success);
+	CHECK_EQUAL(kDDSDimensionTexture3D, layout.dimension);
+	CHECK_EQUAL(2u, layout.GetSubresource(0, 1).depth);
+	CHECK_EQUAL(kLegacyHeaderBytes + 256 + 32, layout.GetSubresource(0, 2).dataOffset);
+	CHECK_EQUAL(size_t(256 + 32 + 4), layout.GetResidentBytes(0));
+}
+
+
+void TestDX10Headers()
+{
+	DDSLayout layout;
+
+	// BC7 with sizes that aren't a multiple of the block size: 130x66 is 33x17 blocks, then 17x9 and 8x4
+	const size_t bc7Bytes = 33 * 17 * 16 + 17 * 9 * 16 + 8 * 4 * 16;
+	const auto bc7 = WithData(MakeDX10Header(130, 66, 3, kBC7UNorm, kDDSDimensionTexture2D, 1), bc7Bytes);
+	CHECK(Parse(bc7, layout) == DDSParseResult::Success);
+	CHECK_EQUAL(kBC7UNorm, layout.format);
+	CheckSubresource(layout, 0, 0, 130, 66, 528, 17, kDX10HeaderBytes);
+	CheckSubresource(layout, 0, 1, 65, 33, 272, 9, kDX10HeaderBytes + 33 * 17 * 16);
+	CheckSubresource(layout, 0, 2, 32, 16, 128, 4, kDX10HeaderBytes + 33 * 17 * 16 + 17 * 9 * 16);
+	CHECK_EQUAL(size_t(8 * 4 * 16), layout.GetMipBytes(2));
+	CHECK_EQUAL(bc7Bytes, layout.GetResidentBytes(0));
+
+	// 1D textures ignore height and depth, but D3DX always writes a height of 1
+	const auto texture1D = WithData(MakeDX10Header(64, 1, 1, kR8UNorm, kDDSDimensionTexture1D, 1, 0, kFlagHeight), 64);
+	CHECK(Parse(texture1D, layout) == DDSParseResult::Success);
+	CHECK_EQUAL(kDDSDimensionTexture1D, layout.dimension);
+	CHECK_EQUAL(1u, layout.height);
+
+	const auto tall1D = WithData(MakeDX10Header(64, 2, 1, kR8UNorm, kDDSDimensionTexture1D, 1, 0, kFlagHeight), 128);
+	CHECK(Parse(tall1D, layout) == DDSParseResult::InvalidData);
+
+	// A 3D texture needs the volume flag, and can't be an array
+	const auto volume = WithData(MakeDX10Header(4, 4, 1, kR8UNorm, kDDSDimensionTexture3D, 1, 0, kFlagVolume, 4), 64);
+	CHECK(Parse(volume, layout) == DDSParseResult::Success);
+	CHECK_EQUAL(4u, layout.depth);
+	CHECK(Parse(WithData(MakeDX10Header(4, 4, 1, kR8UNorm, kDDSDimensionTexture3D, 1, 0, 0, 4), 64), layout) == DDSParseResult::InvalidData);
+	CHECK(Parse(WithData(MakeDX10Header(4, 4, 1, kR8UNorm, kDDSDimensionTexture3D, 2, 0, kFlagVolume, 4), 128), layout) == DDSParseResult::NotSupported);
+
+	// Formats the loaders can't create, and unknown dimensions or empty arrays
+	CHECK(Parse(WithData(MakeDX10Header(4, 4, 1, kP8, kDDSDimensionTexture2D, 1), 16), layout) == DDSParseResult::NotSupported);
+	CHECK(Parse(WithData(MakeDX10Header(4, 4, 1, 0, kDDSDimensionTexture2D, 1), 16), layout) == DDSParseResult::NotSupported);
+	CHECK(Parse(WithData(MakeDX10Header(4, 4, 1, 250, kDDSDimensionTexture2D, 1), 16), layout) == DDSParseResult::NotSupported);
+	CHECK(Parse(WithData(MakeDX10Header(4, 4, 1, kR8UNorm, 5, 1), 16), layout) == DDSParseResult::NotSupported);
+	CHECK(Parse(WithData(MakeDX10Header(4, 4, 1, kR8UNorm, kDDSDimensionTexture2D, 0), 16), layout) == DDSParseResult::InvalidData);
+
+	// Beyond the hardware limits
+	CHECK(Parse(MakeDX10Header(16, 16, 16, kR8UNorm, kDDSDimensionTexture2D, 1), layout) == DDSParseResult::NotSupported);
+	CHECK(Parse(MakeDX10Header(16385, 1, 1, kR8UNorm, kDDSDimensionTexture2D, 1), layout) == DDSParseResult::NotSupported);
+	CHECK(Parse(MakeDX10Header(4, 4, 1, kR8UNorm, kDDSDimensionTexture2D, 2049), layout) == DDSParseResult::NotSupported);
+}
+
+
+void TestCubeMapsAndArrays()
+{
+	DDSLayout layout;
+
+	// Legacy cube maps need all six faces.  Each face is an array slice with its own chain.
+	const auto cube = WithData(MakeHeader(16, 16, 3, MakeFourCCFormat("DXT5"), 0, 0, kCubeMapAllFaces), 6 * (256 + 64 + 16));
+	CHECK(Parse(cube, layout) == DDSParseResult::Success);
+	CHECK(layout.isCubeMap);
+	CHECK_EQUAL(6u, layout.arraySize);
+	CHECK_EQUAL(size_t(18), layout.subresources.size());
+	CheckSubresource(layout, 1, 0, 16, 16, 64, 4, kLegacyHeaderBytes + 256 + 64 + 16);
+	CheckSubresource(layout, 5, 2, 4, 4, 16, 1, kLegacyHeaderBytes + 5 * (256 + 64 + 16) + 256 + 64);
+	CHECK_EQUAL(size_t(6 * 256), layout.GetMipBytes(0));
+
+	const auto oneFace = WithData(MakeHeader(16, 16, 1, MakeFourCCFormat("DXT5"), 0, 0, kCubeMapPositiveX), 256);
+	CHECK(Parse(oneFace, layout) == DDSParseResult::NotSupported);
+
+	// DX10 cube arrays count six slices per cube
+	const auto cubeArray = WithData(MakeDX10Header(8, 8, 2, kBC1UNorm, kDDSDimensionTexture2D, 2, kMiscTextureCube), 12 * (32 + 8));
+	CHECK(Parse(cubeArray, layout) == DDSParseResult::Success);
+	CHECK(layout.isCubeMap);
+	CHECK_EQUAL(12u, layout.arraySize);
+	CheckSubresource(layout, 11, 1, 4, 4, 8, 1, kDX10HeaderBytes + 11 * 40 + 32);
+
+	// A plain array of three BC1 slices
+	const auto textureArray = WithData(MakeDX10Header(8, 4, 1, kBC1UNorm, kDDSDimensionTexture2D, 3), 3 * 16);
+	CHECK(Parse(textureArray, layout) == DDSParseResult::Success);
+	CHECK(!layout.isCubeMap);
+	CHECK_EQUAL(3u, layout.arraySize);
+	CHECK_EQUAL(kDX10HeaderBytes + 32, layout.GetSubresource(2, 0).dataOffset);
+	CHECK_EQUAL(size_t(48), layout.GetMipBytes(0));
+}
+
+
+void TestBlockCompressedPitch()
+{
+	DDSLayout layout;
+
+	// Surfaces smaller than a block still take a whole one
+	const struct
+	{
+		uint32_t	width;
+		uint32_t	height;
+		size_t		bc1RowBytes;
+		size_t		rowCount;
+	} sizes[] =
+	{
+		{ 1, 1, 8, 1 },
+		{ 2, 3, 8, 1 },
+		{ 4, 4, 8, 1 },
+		{ 5, 3, 16, 1 },
+		{ 9, 13, 24, 4 },
+		{ 1024, 2, 2048, 1 },
+	};
+
+	for (const auto& size : sizes)
+	{
+		const size_t bc1Bytes = size.bc1RowBytes * size.rowCount;
+		CHECK(Parse(WithData(MakeDX10Header(size.width, size.height, 1, kBC1UNorm, kDDSDimensionTexture2D, 1), bc1Bytes), layout) == DDSParseResult::Success);
+		CheckSubresource(layout, 0, 0, size.width, size.height, size.bc1RowBytes, size.rowCount, kDX10HeaderBytes);
+
+		// 16-byte blocks double the pitch
+		CHECK(Parse(WithData(MakeDX10Header(size.width, size.height, 1, kBC3UNorm, kDDSDimensionTexture2D, 1), 2 * bc1Bytes), layout) == DDSParseResult::Success);
+		CheckSubresource(layout, 0, 0, size.width, size.height, 2 * size.bc1RowBytes, size.rowCount, kDX10HeaderBytes);
+	}
+
+	// The tail of a chain, from 16x16 down to 1x1, is one block per mip
+	CHECK(Parse(WithData(MakeDX10Header(16, 16, 5, kBC3UNorm, kDDSDimensionTexture2D, 1), 256 + 64 + 16 * 3), layout) == DDSParseResult::Success);
+	for (uint32_t mip = 2; mip < 5; ++mip)
+	{
+		CHECK_EQUAL(size_t(16), layout.GetMipBytes(mip));
+		CHECK_EQUAL(size_t(1), layout.GetSubresource(0, mip).rowCount);
+	}
+	CHECK_EQUAL(size_t(16 * 3), layout.GetResidentBytes(2));
+}
+
+
+void TestTruncation()
+{
+	DDSLayout layout;
+
+	const auto file = WithData(MakeDX10Header(64, 64, 7, kBC1UNorm, kDDSDimensionTexture2D, 1), 2048 + 512 + 128 + 32 + 8 + 8 + 8);
+	CHECK(Parse(file, layout) == DDSParseResult::Success);
+
+	// Missing even one byte of the last mip
+	CHECK(ParseDDSLayout(file.data(), file.size() - 1, layout) == DDSParseResult::Truncated);
+	CHECK(ParseDDSLayout(file.data(), kDX10HeaderBytes, layout) == DDSParseResult::Truncated);
+
+	// Parsing just the headers checks against the size of the whole file instead
+	CHECK(ParseDDSHeader(file.data(), kMaxDDSHeaderBytes, file.size(), layout) == DDSParseResult::Success);
+	CHECK_EQUAL(7u, layout.mipCount);
+	CHECK_EQUAL(file.size() - 8, layout.GetSubresource(0, 6).dataOffset);
+	CHECK(ParseDDSHeader(file.data(), kMaxDDSHeaderBytes, file.size() - 1, layout) == DDSParseResult::Truncated);
+	CHECK(ParseDDSHeader(file.data(), kMaxDDSHeaderBytes, kMaxDDSHeaderBytes + 2048, layout) == DDSParseResult::Truncated);
+
+	// Headers cut short, or the DX10 extension missing
+	CHECK(ParseDDSHeader(file.data(), kLegacyHeaderBytes - 1, file.size(), layout) == DDSParseResult::InvalidData);
+	CHECK(ParseDDSHeader(file.data(), kLegacyHeaderBytes, file.size(), layout) == DDSParseResult::InvalidData);
+	CHECK(ParseDDSLayout(nullptr, 0, layout) == DDSParseResult::InvalidData);
+
+	// Not a DDS file, or one whose structure sizes are wrong
+	auto badMagic = file;
+	badMagic[0] = 'X';
+	CHECK(Parse(badMagic, layout) == DDSParseResult::InvalidData);
+
+	auto badHeaderSize = file;
+	badHeaderSize[4] = 120;
+	CHECK(Parse(badHeaderSize, layout) == DDSParseResult::InvalidData);
+
+	auto badPixelFormatSize = file;
+	badPixelFormatSize[4 + 72] = 28;
+	CHECK(Parse(badPixelFormatSize, layout) == DDSParseResult::InvalidData);
+}
+
+
+void TestSelectFirstResidentMip()
+{
+	DDSLayout layout;
+
+	// 1024x256, with mips down to 1x1
+	CHECK(ParseDDSHeader(MakeDX10Header(1024, 256, 11, kBC1UNorm, kDDSDimensionTexture2D, 1).data(), kMaxDDSHeaderBytes, 1 << 20, layout) == DDSParseResult::Success);
+	CHECK_EQUAL(0u, SelectFirstResidentMip(layout, 1024));
+	CHECK_EQUAL(0u, SelectFirstResidentMip(layout, 4096));
+	CHECK_EQUAL(1u, SelectFirstResidentMip(layout, 1023));
+	CHECK_EQUAL(2u, SelectFirstResidentMip(layout, 256));
+	CHECK_EQUAL(10u, SelectFirstResidentMip(layout, 1));
+
+	// Both dimensions have to fit: 256x1024 is the same
+	CHECK(ParseDDSHeader(MakeDX10Header(256, 1024, 11, kBC1UNorm, kDDSDimensionTexture2D, 1).data(), kMaxDDSHeaderBytes, 1 << 20, layout) == DDSParseResult::Success);
+	CHECK_EQUAL(2u, SelectFirstResidentMip(layout, 256));
+
+	// A truncated chain starts at its smallest mip when none fit
+	CHECK(ParseDDSHeader(MakeDX10Header(1024, 1024, 3, kBC1UNorm, kDDSDimensionTexture2D, 1).data(), kMaxDDSHeaderBytes, 1 << 20, layout) == DDSParseResult::Success);
+	CHECK_EQUAL(2u, SelectFirstResidentMip(layout, 64));
+
+	CHECK(ParseDDSHeader(MakeDX10Header(1024, 1024, 1, kBC1UNorm, kDDSDimensionTexture2D, 1).data(), kMaxDDSHeaderBytes, 1 << 20, layout) == DDSParseResult::Success);
+	CHECK_EQUAL(0u, SelectFirstResidentMip(layout, 64));
+}
+
+} // anonymous namespace
+
+
+int main()
+{
+	TestLegacyHeaders();
+	TestDX10Headers();
+	TestCubeMapsAndArrays();
+	TestBlockCompressedPitch();
+	TestTruncation();
+	TestSelectFirstResidentMip();
+
+	return KodiakTest::FinishTest("TextureStreamingTest");
+}
\ No newline at end of file